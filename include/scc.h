@@ -19,7 +19,15 @@
 
 #include "scc/foundation.h"
 
+#include "scc/target.h"
+
+#include "scc/ir.h"
+#include "scc/ir/pass_manager.h"
+#include "scc/ir/passes.h"
+
 // REFACTOR(mtwilliams): Move under `scc/ir.h`.
 #include "scc/ir/parser.h"
 
+#include "scc/driver.h"
+
 #endif // _SCC_H_
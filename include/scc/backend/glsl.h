@@ -0,0 +1,51 @@
+//===-- scc/backend/glsl.h ------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Emits GLSL source.
+///
+/// The entry point becomes `main`. See `scc/backend/text.h` for how
+/// functions and control flow are emitted.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_BACKEND_GLSL_H_
+#define _SCC_BACKEND_GLSL_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_glsl_options {
+  // Written to `#version`. Explicit offsets of constants need 440 or later.
+  scc_uint32_t version;
+} scc_glsl_options_t;
+
+/// Emits `module` to `writer`, with default options if `options` is `NULL`.
+/// Returns false if `module` has no entry point.
+///
+/// Loose constants are gathered in a uniform block bound to the first slot
+/// not taken by another. Inputs and outputs that are structures are split
+/// into a variable per member, at consecutive locations.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_glsl_emit(const scc_ir_module_t *module,
+                           const scc_glsl_options_t *options,
+                           scc_writer_t *writer);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_BACKEND_GLSL_H_
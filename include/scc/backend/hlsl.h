@@ -0,0 +1,54 @@
+//===-- scc/backend/hlsl.h ------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Emits HLSL source.
+///
+/// Inputs and outputs are kept in static variables, copied in and out by a
+/// `main` that wraps the entry point, so that functions can refer to them as
+/// they do in other dialects. See `scc/backend/text.h` for how functions and
+/// control flow are emitted.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_BACKEND_HLSL_H_
+#define _SCC_BACKEND_HLSL_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_hlsl_options {
+  // Targeted shader model, times ten. 64-bit integers need 60 or later.
+  scc_uint32_t shader_model;
+} scc_hlsl_options_t;
+
+/// Emits `module` to `writer`, with default options if `options` is `NULL`.
+/// Returns false if `module` has no entry point, or needs more than the
+/// targeted shader model provides.
+///
+/// Constant buffers and loose constants are placed with `packoffset` at the
+/// offsets given, matrices being column major. Textures bound to `tN` are
+/// sampled with a sampler bound to `sN`.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_hlsl_emit(const scc_ir_module_t *module,
+                           const scc_hlsl_options_t *options,
+                           scc_writer_t *writer);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_BACKEND_HLSL_H_
@@ -0,0 +1,65 @@
+//===-- scc/backend/msl.h -------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Emits Metal Shading Language source.
+///
+/// Metal has no globals that functions can reach, so every function takes a
+/// `_Globals` first, which holds inputs and outputs, and points to argument
+/// buffers holding constants and textures. It's filled in by a `main0` that
+/// wraps the entry point, taking inputs as `[[stage_in]]` and returning
+/// outputs. See `scc/backend/text.h` for how functions and control flow are
+/// emitted.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_BACKEND_MSL_H_
+#define _SCC_BACKEND_MSL_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_msl_options {
+  // Targeted version of the language, times ten. Argument buffers need 20 or
+  // later, and 64-bit integers 23 or later.
+  scc_uint32_t version;
+
+  // Index of the buffer that the argument buffer of constants is bound to.
+  // That of textures is bound to the next. Vertex buffers feeding inputs
+  // must be bound elsewhere.
+  scc_uint32_t buffer;
+} scc_msl_options_t;
+
+/// Emits `module` to `writer`, with default options if `options` is `NULL`.
+/// Returns false if `module` has no entry point, uses 64-bit floats, which
+/// Metal has none of, or needs more than the targeted version provides.
+///
+/// Constant buffers and loose constants are pointed to by an argument buffer
+/// at ids of their bindings, the latter at the first not taken by another,
+/// and laid out at the offsets given, padding as needed. Textures are in
+/// another, at twice their binding, each followed by its sampler. Matrices
+/// are column major, so offsets must leave room for columns of three
+/// components to take four.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_msl_emit(const scc_ir_module_t *module,
+                          const scc_msl_options_t *options,
+                          scc_writer_t *writer);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_BACKEND_MSL_H_
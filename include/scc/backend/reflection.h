@@ -0,0 +1,207 @@
+//===-- scc/backend/reflection.h ------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Emits what a shader binds, and how, as a blob to be queried in place.
+///
+/// A blob is a header followed by arrays of fixed-size records, then names.
+/// Everything refers to everything else by index or by offset from the start
+/// of its section, never by pointer, so a blob can be mapped or read straight
+/// into memory and used as is. Nothing is decoded, nor allocated, to query it.
+///
+/// Every input, output, constant and texture is described by a resource, and
+/// every member of one that is a structure by a field, with structures nested
+/// in them having fields of their own. Names are interned, so each is written
+/// once however many times it's used. Resources can be found by name through
+/// a hash table of their own.
+///
+/// Words are written in the byte order of the compiler, which readers can
+/// tell by `scc_reflection_header_t::magic`.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_BACKEND_REFLECTION_H_
+#define _SCC_BACKEND_REFLECTION_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/layout.h"
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Spells `SCCR` when read in the right byte order.
+#define SCC_REFLECTION_MAGIC 0x52434353u
+
+/// Changes whenever the layout of blobs does.
+#define SCC_REFLECTION_VERSION 1
+
+/// Marks an absent binding, field, or bucket.
+#define SCC_REFLECTION_NONE 0xffffffffu
+
+/// Offset of a null-terminated name in the names of a blob. Zero refers to
+/// the empty string.
+typedef scc_uint32_t scc_reflection_name_t;
+
+/// Mirrors `scc_ir_type_t`, less what refers to the module.
+typedef struct scc_reflection_type {
+  // See `scc_ir_scalar_t`.
+  scc_uint8_t scalar;
+  scc_uint8_t rows;
+  scc_uint8_t columns;
+  scc_uint8_t reserved;
+} scc_reflection_type_t;
+
+typedef struct scc_reflection_field {
+  scc_reflection_name_t name;
+  scc_reflection_type_t type;
+
+  // Offset in bytes from the start of the enclosing structure for members of
+  // constants, or the location of members of inputs and outputs.
+  scc_uint32_t offset;
+
+  // Bytes taken in a constant buffer, and between columns of matrices.
+  scc_uint32_t size;
+  scc_uint32_t stride;
+
+  // Fields of structures, or `SCC_REFLECTION_NONE` and zero.
+  scc_uint32_t first_field;
+  scc_uint32_t num_of_fields;
+} scc_reflection_field_t;
+
+typedef struct scc_reflection_resource {
+  scc_reflection_name_t name;
+
+  // See `scc_ir_storage_t`.
+  scc_uint32_t storage;
+
+  // Type of value, or in the case of textures, the type of a texel.
+  scc_reflection_type_t type;
+
+  // Location of inputs and outputs, and slot of constant buffers and
+  // textures. Loose constants are given the slot of the constant buffer
+  // they're gathered in.
+  scc_uint32_t binding;
+
+  // Offset of loose constants in the buffer they're gathered in.
+  scc_uint32_t offset;
+
+  // Bytes taken in a constant buffer, and between columns of matrices.
+  scc_uint32_t size;
+  scc_uint32_t stride;
+
+  // See `scc_ir_builtin_t`.
+  scc_uint32_t builtin;
+
+  // Number of coordinates textures are sampled with.
+  scc_uint32_t dimensions;
+
+  // Fields of structures, or `SCC_REFLECTION_NONE` and zero.
+  scc_uint32_t first_field;
+  scc_uint32_t num_of_fields;
+} scc_reflection_resource_t;
+
+typedef struct scc_reflection_header {
+  scc_uint32_t magic;
+  scc_uint32_t version;
+
+  // Size of the blob in bytes, including this header.
+  scc_uint32_t size;
+
+  // See `scc_program_type_t` and `scc_ir_packing_t`.
+  scc_uint32_t type;
+  scc_uint32_t packing;
+
+  // Slot and size of the constant buffer that loose constants are gathered
+  // in, or `SCC_REFLECTION_NONE` and zero if there are none.
+  scc_uint32_t constants;
+  scc_uint32_t size_of_constants;
+
+  // Offsets in bytes from the start of the blob, and counts, of each section.
+  scc_uint32_t resources;
+  scc_uint32_t num_of_resources;
+
+  scc_uint32_t fields;
+  scc_uint32_t num_of_fields;
+
+  // Open-addressed hash table of resources by name, probed linearly. Empty
+  // buckets are `SCC_REFLECTION_NONE`. A power of two in size.
+  scc_uint32_t buckets;
+  scc_uint32_t num_of_buckets;
+
+  scc_uint32_t names;
+  scc_uint32_t size_of_names;
+} scc_reflection_header_t;
+
+/// Emits reflection of `module` to `writer`, with constant buffers laid out
+/// by `packing`, which is that of the target compiled to unless
+/// `scc_ir_pass_options_t::packing` said otherwise. Always succeeds.
+extern SCC_PUBLIC
+  scc_bool_t scc_reflection_emit(const scc_ir_module_t *module,
+                                 scc_ir_packing_t packing,
+                                 scc_writer_t *writer);
+
+/// Checks that the `size` bytes at `blob`, which must be aligned to four
+/// bytes, are a blob that can be queried safely. Returns its header if so,
+/// otherwise `NULL`.
+extern SCC_PUBLIC
+  const scc_reflection_header_t *scc_reflection_open(const void *blob,
+                                                     scc_size_t size);
+
+/// Hash of names, as used to place resources in buckets.
+static SCC_INLINE scc_uint32_t scc_reflection_hash(const char *name) {
+  scc_uint32_t hash = 2166136261u;
+
+  for (const char *character = name; *character; ++character) {
+    hash ^= (scc_uint8_t)*character;
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static SCC_INLINE const scc_reflection_resource_t *scc_reflection_resources(const scc_reflection_header_t *header) {
+  return (const scc_reflection_resource_t *)((const char *)header + header->resources);
+}
+
+static SCC_INLINE const scc_reflection_field_t *scc_reflection_fields(const scc_reflection_header_t *header) {
+  return (const scc_reflection_field_t *)((const char *)header + header->fields);
+}
+
+static SCC_INLINE const char *scc_reflection_string(const scc_reflection_header_t *header,
+                                                    scc_reflection_name_t name) {
+  return (const char *)header + header->names + name;
+}
+
+/// Finds the resource named `name`, or returns `NULL` if there's none.
+static SCC_INLINE const scc_reflection_resource_t *scc_reflection_find(const scc_reflection_header_t *header,
+                                                                       const char *name) {
+  const scc_uint32_t *buckets = (const scc_uint32_t *)((const char *)header + header->buckets);
+  const scc_reflection_resource_t *resources = scc_reflection_resources(header);
+
+  const scc_uint32_t mask = header->num_of_buckets - 1;
+
+  for (scc_uint32_t probe = scc_reflection_hash(name) & mask; buckets[probe] != SCC_REFLECTION_NONE; probe = (probe + 1) & mask) {
+    const scc_reflection_resource_t *resource = &resources[buckets[probe]];
+
+    if (strcmp(scc_reflection_string(header, resource->name), name) == 0)
+      return resource;
+  }
+
+  return NULL;
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_BACKEND_REFLECTION_H_
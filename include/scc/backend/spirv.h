@@ -0,0 +1,73 @@
+//===-- scc/backend/spirv.h -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Emits SPIR-V binaries for Vulkan.
+///
+/// Words are written straight from the IR, in one pass over functions. Types,
+/// constants and undefined values are hash-consed as they're first used, into
+/// a section of their own that is written ahead of functions.
+///
+/// Being in SSA form already, `phi`, `jmp` and `branch` map onto `OpPhi`,
+/// `OpBranch` and `OpBranchConditional`, with merges declared where control
+/// flow rejoins. Blocks are added where SPIR-V needs somewhere to rejoin that
+/// the IR doesn't have. Functions that can't be expressed that way, like
+/// those with loops that exit to several places, are emitted as a loop around
+/// an `OpSwitch` on the block being run instead, with values that cross
+/// blocks kept in variables.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_BACKEND_SPIRV_H_
+#define _SCC_BACKEND_SPIRV_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/layout.h"
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_spirv_options {
+  // Targeted version of SPIR-V, as `0x00MMmm00`. Interfaces list every global
+  // from 1.4 on.
+  scc_uint32_t version;
+
+  // Leaves out names of functions, globals and members.
+  scc_bool_t strip;
+
+  // Rules constant buffers are laid out by, which decides how columns of
+  // matrices are strided. Either `SCC_IR_PACKING_STD140`, assumed if zero, or
+  // `SCC_IR_PACKING_STD430`, given `VK_KHR_uniform_buffer_standard_layout`.
+  scc_ir_packing_t packing;
+} scc_spirv_options_t;
+
+/// Emits `module` to `writer`, with default options if `options` is `NULL`.
+/// Returns false if `module` has no entry point, or its entry point takes
+/// arguments or returns something.
+///
+/// Constant buffers and loose constants are bound in descriptor set 0, the
+/// latter to the first binding not taken by another, and textures in set 1 as
+/// combined image samplers. Inputs and outputs that are structures are split
+/// into a variable per member, at consecutive locations. Discarding demotes
+/// to a helper invocation, rather than terminating.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_spirv_emit(const scc_ir_module_t *module,
+                            const scc_spirv_options_t *options,
+                            scc_writer_t *writer);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_BACKEND_SPIRV_H_
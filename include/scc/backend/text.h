@@ -0,0 +1,324 @@
+//===-- scc/backend/text.h ------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Emits source for C-like shading languages.
+///
+/// Every value is named once, up front, and names are written by copying
+/// them, so emission does little beyond appending to a writer. Functions are
+/// emitted callees first, starting from the entry point. Anything not called
+/// from it, like `scc_ir_module_t::precompute`, is left out.
+///
+/// Control flow is recovered from the graph as `if` and `for (;;)` with
+/// `break` and `continue`. Functions that can't be expressed that way, like
+/// those with loops that exit to several places, are emitted as a loop around
+/// a `switch` on the block being run instead.
+///
+/// What differs between languages is described by a dialect: tables of how
+/// types, literals and operations are spelled, and hooks to declare globals
+/// and to write what has no common spelling, like sampling.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_BACKEND_TEXT_H_
+#define _SCC_BACKEND_TEXT_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/cfg.h"
+#include "scc/ir/dominators.h"
+#include "scc/ir/loops.h"
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Text interned in `scc_text_emitter_t::pool`.
+typedef struct scc_text_name {
+  scc_uint32_t offset;
+  scc_uint32_t length;
+} scc_text_name_t;
+
+/// Open-addressed set of names, to keep them unique.
+typedef struct scc_text_names {
+  scc_text_name_t *names;
+  scc_uint32_t capacity;
+  scc_uint32_t count;
+} scc_text_names_t;
+
+typedef struct scc_text_emitter scc_text_emitter_t;
+
+typedef struct scc_text_dialect {
+  // Identifiers that can't be used as is, sorted, and a prefix reserved too.
+  // Names that collide get an underscore appended.
+  const char *const *reserved;
+  scc_uint32_t num_of_reserved;
+  const char *reserved_prefix;
+
+  // Indexed by scalar. Spellings of scalars, and of vectors, followed by the
+  // number of components.
+  const char *scalars[SCC_IR_F64 + 1];
+  const char *vectors[SCC_IR_F64 + 1];
+
+  // Spellings of matrices of `f32` and `f64`, followed by their dimensions.
+  // Square matrices are abbreviated to one dimension if `abbreviate`.
+  const char *matrices[2];
+  scc_bool_t abbreviate;
+
+  // Spelled and constructed row by row, rather than column by column.
+  scc_bool_t row_major;
+
+  // Splats by casting rather than by constructing.
+  scc_bool_t casts;
+
+  // Indexed by scalar. Appended to literals.
+  const char *suffixes[SCC_IR_F64 + 1];
+
+  // Spell infinities and NaNs by their bits. Given 32 bits, and the low then
+  // high 32 of 64 bits, respectively.
+  const char *f32_from_bits;
+  const char *f64_from_bits;
+
+  // Indexed by operation. Called for operations that map to a function, and
+  // for `sat` and `fma` on floats if set.
+  const char *operations[SCC_IR_NUM_OF_OPERATIONS];
+
+  // Called for products involving matrices, or `NULL` to use `*`.
+  const char *product;
+
+  // Called to compare vectors, in order of `lt` through `gte`, or `NULL` to
+  // use operators.
+  const char *const *comparisons;
+
+  const char *discard;
+
+  // Indexed by builtin. Names of globals bound to builtins, or `NULL` to
+  // name them as any other.
+  const char *builtins[SCC_IR_BUILTIN_DEPTH + 1];
+
+  // Storage of structures that are split into a variable per member, as bits
+  // set by `1 << storage`.
+  scc_uint32_t flattened;
+
+  // Name of the entry point, or `NULL` to name it as any other function.
+  const char *entry;
+
+  // Parameter every function takes first, and what every call passes for it,
+  // for languages without globals that functions can reach otherwise. `NULL`
+  // if functions take nothing more than their arguments.
+  const char *context;
+  const char *context_argument;
+
+  // Writes whatever comes before structures.
+  void (*preamble)(scc_text_emitter_t *emitter);
+
+  // Declares globals.
+  void (*declarations)(scc_text_emitter_t *emitter);
+
+  // Writes what `member` of `global` is reached through, or `global` itself
+  // if `member` is `SCC_IR_NONE`. `NULL` to reach them by name.
+  void (*reference)(scc_text_emitter_t *emitter,
+                    scc_uint32_t global,
+                    scc_uint32_t member);
+
+  // Writes the value of `instruction`, if it has to be spelled specially.
+  // Returns false to use the common spelling.
+  scc_bool_t (*expression)(scc_text_emitter_t *emitter,
+                           const scc_ir_instruction_t *instruction);
+
+  // Writes whatever comes after functions.
+  void (*epilogue)(scc_text_emitter_t *emitter);
+} scc_text_dialect_t;
+
+struct scc_text_emitter {
+  const scc_ir_module_t *module;
+  const scc_text_dialect_t *dialect;
+
+  // Options specific to the dialect.
+  const void *options;
+
+  scc_writer_t *writer;
+
+  // Lives as long as emission, and as long as a function, respectively.
+  scc_arena_t *arena;
+  scc_arena_t *scratch;
+
+  // Names of everything, and the literal of every constant, written out once
+  // so that each use is a copy.
+  char *pool;
+  scc_uint32_t size_of_pool;
+  scc_uint32_t capacity_of_pool;
+
+  // Identifiers taken at module scope, and in the function being emitted.
+  scc_text_names_t taken;
+  scc_text_names_t local;
+
+  // Indexed by global, function, structure, and member.
+  scc_text_name_t *globals;
+  scc_text_name_t *functions;
+  scc_text_name_t *structures;
+  scc_text_name_t *members;
+
+  // Indexed by global, the first of the names in `fields` of a structure
+  // that's split into a variable per member, or `SCC_IR_NONE`.
+  scc_uint32_t *first_field;
+  scc_text_name_t *fields;
+
+  // Indexed by global. Number of coordinates textures are sampled with.
+  scc_uint32_t *dimensions;
+
+  // Indexed by structure. Whether it's used as the type of a value, rather
+  // than just to lay out an interface, so is declared.
+  scc_bool_t *declared;
+
+  // Functions called, directly or not, by the entry point, callees first.
+  scc_uint32_t *order;
+  scc_uint32_t num_of_functions;
+
+  // Function being emitted.
+  const scc_ir_function_t *function;
+
+  scc_text_name_t *arguments;
+  scc_text_name_t *instructions;
+  scc_text_name_t *constants;
+
+  // Indexed by instruction. Whether it's declared up front, as it's used
+  // outside its block or is a phi.
+  scc_bool_t *hoisted;
+
+  scc_ir_cfg_t *cfg;
+  scc_ir_dominators_t *dominators;
+  scc_ir_dominators_t *post_dominators;
+  scc_ir_loops_t *loops;
+
+  // Indexed by loop. Sole block it exits to, `SCC_IR_NONE` if it never
+  // exits, or `SCC_IR_NONE - 1` if it exits to several.
+  scc_uint32_t *exits;
+
+  // Indexed by block.
+  scc_bool_t *visited;
+
+  // Cleared while checking that a function can be structured.
+  scc_bool_t emitting;
+
+  scc_uint32_t depth;
+};
+
+/// Emits `module` to `writer` in `dialect`. Returns false if `module` has no
+/// entry point.
+extern SCC_PUBLIC
+  scc_bool_t scc_text_emit(const scc_ir_module_t *module,
+                           const scc_text_dialect_t *dialect,
+                           const void *options,
+                           scc_writer_t *writer);
+
+/// Interns `raw` as an identifier that can't collide with those generated,
+/// which all start with an underscore, with anything reserved, nor with any
+/// other in scope, which is the function being emitted, if any, otherwise
+/// the module.
+extern SCC_PUBLIC
+  scc_text_name_t scc_text_identifier(scc_text_emitter_t *emitter,
+                                      const char *raw);
+
+/// Interns `text` as is.
+extern SCC_PUBLIC
+  scc_text_name_t scc_text_intern(scc_text_emitter_t *emitter,
+                                  const char *text);
+
+extern SCC_PUBLIC
+  void scc_text_write(scc_text_emitter_t *emitter,
+                      const char *text);
+
+extern SCC_PUBLIC
+  void scc_text_name(scc_text_emitter_t *emitter,
+                     scc_text_name_t name);
+
+extern SCC_PUBLIC
+  void scc_text_type(scc_text_emitter_t *emitter,
+                     scc_ir_type_t type);
+
+/// Writes `type` so it can be applied to one value, which is splatted to
+/// every component, and which is written by the caller before
+/// `scc_text_splat_end`.
+extern SCC_PUBLIC
+  void scc_text_splat_begin(scc_text_emitter_t *emitter,
+                            scc_ir_type_t type);
+
+extern SCC_PUBLIC
+  void scc_text_splat_end(scc_text_emitter_t *emitter);
+
+extern SCC_PUBLIC
+  void scc_text_indent(scc_text_emitter_t *emitter);
+
+/// Writes `text` on a line of its own, indented.
+extern SCC_PUBLIC
+  void scc_text_line(scc_text_emitter_t *emitter,
+                     const char *text);
+
+/// Writes `value`. Undefined values are written as zeros of `type`.
+extern SCC_PUBLIC
+  void scc_text_value(scc_text_emitter_t *emitter,
+                      scc_ir_value_t value,
+                      scc_ir_type_t type);
+
+/// Writes `value` as `rows` components, splatting scalars.
+extern SCC_PUBLIC
+  void scc_text_operand(scc_text_emitter_t *emitter,
+                        scc_ir_value_t value,
+                        scc_uint32_t rows);
+
+/// Writes `name(a, b, ...)` of the operands of `instruction`, splatting them
+/// to `rows` components.
+extern SCC_PUBLIC
+  void scc_text_call(scc_text_emitter_t *emitter,
+                     const char *name,
+                     const scc_ir_instruction_t *instruction,
+                     scc_uint32_t rows);
+
+/// Writes `.x`, `.xy`, or `.xyz` to narrow a sampled texel to `rows`.
+extern SCC_PUBLIC
+  void scc_text_narrow(scc_text_emitter_t *emitter,
+                       scc_uint32_t rows);
+
+/// Determines if `type` needs 64-bit integers.
+extern SCC_PUBLIC
+  scc_bool_t scc_text_is_wide(scc_ir_type_t type);
+
+/// Determines if an input or output of `type` with `storage` has to be
+/// declared flat, as integers aren't interpolated between stages. Only the
+/// interpolated side is, which is inputs of pixel shaders and outputs of
+/// vertex shaders.
+extern SCC_PUBLIC
+  scc_bool_t scc_text_is_flat(const scc_text_emitter_t *emitter,
+                              scc_ir_storage_t storage,
+                              scc_ir_type_t type);
+
+/// Called for a variable holding an input or output at `location`, or bound
+/// to `builtin`.
+typedef void (*scc_text_interface_fn)(scc_text_emitter_t *emitter,
+                                      scc_ir_storage_t storage,
+                                      scc_ir_builtin_t builtin,
+                                      scc_uint32_t location,
+                                      scc_ir_type_t type,
+                                      scc_text_name_t name);
+
+/// Calls `visit` for every variable holding an input, if `storage` is
+/// `SCC_IR_INPUT`, or output, with the location it's at.
+extern SCC_PUBLIC
+  void scc_text_interface(scc_text_emitter_t *emitter,
+                          scc_ir_storage_t storage,
+                          scc_text_interface_fn visit);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_BACKEND_TEXT_H_
@@ -0,0 +1,155 @@
+//===-- scc/backend/writer.h ----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Buffers output of backends.
+///
+/// Output is appended to fixed-size chunks. Given a sink, a chunk is handed
+/// to it whenever it fills, so a single chunk is reused no matter how much is
+/// written. Otherwise chunks are chained, so output grows without ever being
+/// copied, and can be read back once done.
+///
+/// Chunks are recycled rather than released when flushed, so a writer that is
+/// reused, say for every shader in a batch, stops allocating once it has
+/// grown to fit the largest.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_BACKEND_WRITER_H_
+#define _SCC_BACKEND_WRITER_H_
+
+#include "scc/foundation.h"
+
+#include "scc/sink.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_writer_chunk {
+  struct scc_writer_chunk *next;
+
+  // Bytes written to this chunk, which immediately follow this header.
+  scc_size_t size;
+} scc_writer_chunk_t;
+
+typedef struct scc_writer {
+  // Or `NULL` to keep everything written.
+  scc_sink_t *sink;
+
+  // Usable bytes of each chunk.
+  scc_size_t granularity;
+
+  // Chunks written to, in order. The last is being written to.
+  scc_writer_chunk_t *first;
+  scc_writer_chunk_t *last;
+
+  // Chunks flushed, for reuse.
+  scc_writer_chunk_t *spare;
+
+  // Where the next byte goes, and the end of the last chunk.
+  char *cursor;
+  char *end;
+
+  // Bytes written to chunks before the last.
+  scc_size_t written;
+
+  // Set if a sink came up short.
+  scc_bool_t failed;
+} scc_writer_t;
+
+/// Creates a writer that hands chunks of `granularity` bytes to `sink`, or,
+/// if `sink` is `NULL`, keeps them.
+extern SCC_PUBLIC
+  scc_writer_t *scc_writer_create(scc_sink_t *sink,
+                                  scc_size_t granularity);
+
+extern SCC_PUBLIC
+  void scc_writer_destroy(scc_writer_t *writer);
+
+/// Starts a new chunk, handing the last to the sink if there is one.
+extern SCC_PUBLIC
+  void scc_writer_advance(scc_writer_t *writer);
+
+/// Hands everything written to the sink, if there is one, otherwise discards
+/// it. Returns false if the sink came up short at any point.
+extern SCC_PUBLIC
+  scc_bool_t scc_writer_flush(scc_writer_t *writer);
+
+/// Number of bytes written and kept.
+extern SCC_PUBLIC
+  scc_size_t scc_writer_size(const scc_writer_t *writer);
+
+/// Copies everything kept to `buffer`, which must hold `scc_writer_size`
+/// bytes.
+extern SCC_PUBLIC
+  void scc_writer_copy(const scc_writer_t *writer,
+                       char *buffer);
+
+static SCC_INLINE void scc_writer_write(scc_writer_t *writer,
+                                        const char *bytes,
+                                        scc_size_t count) {
+  while (count > (scc_size_t)(writer->end - writer->cursor)) {
+    const scc_size_t fits = (scc_size_t)(writer->end - writer->cursor);
+
+    memcpy(writer->cursor, bytes, fits);
+    writer->cursor += fits;
+
+    bytes += fits;
+    count -= fits;
+
+    scc_writer_advance(writer);
+  }
+
+  memcpy(writer->cursor, bytes, count);
+  writer->cursor += count;
+}
+
+static SCC_INLINE void scc_writer_put(scc_writer_t *writer,
+                                      char character) {
+  if (writer->cursor == writer->end)
+    scc_writer_advance(writer);
+
+  *writer->cursor++ = character;
+}
+
+static SCC_INLINE void scc_writer_string(scc_writer_t *writer,
+                                         const char *string) {
+  scc_writer_write(writer, string, strlen(string));
+}
+
+/// Writes `value` in decimal.
+static SCC_INLINE void scc_writer_unsigned(scc_writer_t *writer,
+                                           scc_uint64_t value) {
+  char digits[20];
+  scc_uint32_t n = 20;
+
+  do {
+    digits[--n] = (char)('0' + (value % 10));
+    value /= 10;
+  } while (value);
+
+  scc_writer_write(writer, &digits[n], 20 - n);
+}
+
+static SCC_INLINE void scc_writer_signed(scc_writer_t *writer,
+                                         scc_int64_t value) {
+  if (value < 0) {
+    scc_writer_put(writer, '-');
+    scc_writer_unsigned(writer, 0ull - (scc_uint64_t)value);
+  } else {
+    scc_writer_unsigned(writer, (scc_uint64_t)value);
+  }
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_BACKEND_WRITER_H_
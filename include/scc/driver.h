@@ -0,0 +1,98 @@
+//===-- scc/driver.h ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Drives compilation of shaders, and reports on the results.
+///
+/// A module is parsed and optimized once, then lowered and emitted for every
+/// target it's built for from there, rather than starting over per target.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_DRIVER_H_
+#define _SCC_DRIVER_H_
+
+#include "scc/foundation.h"
+#include "scc/target.h"
+
+#include "scc/ir.h"
+#include "scc/ir/liveness.h"
+#include "scc/ir/pass_manager.h"
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Metrics of a shader, to predict how well it runs on a target.
+typedef struct scc_driver_metrics {
+  // Counting only what remains live.
+  scc_uint32_t num_of_functions;
+  scc_uint32_t num_of_blocks;
+  scc_uint32_t num_of_instructions;
+
+  // Peak register pressure over functions, which is that of the shader once
+  // calls are inlined. Determines occupancy on targets that divide a fixed
+  // register file between threads.
+  scc_ir_pressure_t pressure;
+} scc_driver_metrics_t;
+
+/// Measures `module` as compiled so far.
+extern SCC_PUBLIC
+  void scc_driver_measure(const scc_ir_module_t *module,
+                          scc_driver_metrics_t *metrics);
+
+/// A target to emit a module for, and where to.
+typedef struct scc_driver_output {
+  scc_target_t target;
+
+  // Options of the backend of `target`, like `scc_glsl_options_t`, or `NULL`
+  // for its defaults.
+  const void *options;
+
+  scc_writer_t *writer;
+
+  // Lays out constant buffers anew, to take as little room as possible. See
+  // `SCC_IR_LAYOUT_PASS`.
+  scc_bool_t lay_out;
+
+  // Where reflection of what's emitted is written, or `NULL`. Constant
+  // buffers are laid out by the rules of `target`, or for SPIR-V, those of
+  // `scc_spirv_options_t::packing`.
+  scc_writer_t *reflection;
+
+  // Set if the module was emitted, or cleared if the backend refused it or
+  // there's none, as for `SCC_TARGET_HOST`.
+  scc_bool_t emitted;
+} scc_driver_output_t;
+
+/// Runs what optimizations don't depend on the target over `module`, once,
+/// however many targets it's then emitted for. Ignores `options->target`.
+extern SCC_PUBLIC
+  void scc_driver_optimize(scc_ir_module_t *module,
+                           const scc_ir_pass_options_t *options);
+
+/// Emits `module`, as optimized by `scc_driver_optimize`, for each of
+/// `outputs`, in parallel on up to `options->threads` threads.
+///
+/// Each target lowers a copy of its own, tailoring code to it, so `module`
+/// is only ever read and can be shared. Output doesn't depend on the number
+/// of threads. Returns true if every output was emitted.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_driver_emit(const scc_ir_module_t *module,
+                             const scc_ir_pass_options_t *options,
+                             scc_driver_output_t *outputs,
+                             scc_uint32_t num_of_outputs);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_DRIVER_H_
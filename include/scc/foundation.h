@@ -28,11 +28,15 @@
 #include "scc/foundation/support.h"
 #include "scc/foundation/utilities.h"
 #include "scc/foundation/atomics.h"
+#include "scc/foundation/clock.h"
 
 #include "scc/foundation/assert.h"
 
 #include "scc/foundation/allocator.h"
 #include "scc/foundation/global_heap_allocator.h"
+#include "scc/foundation/arena.h"
+
+#include "scc/foundation/jobs.h"
 
 #include "scc/foundation/ascii.h"
 #include "scc/foundation/unicode.h"
@@ -0,0 +1,74 @@
+//===-- scc/foundation/arena.h --------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Bump allocator for short-lived, scratch allocations.
+///
+/// Freeing an individual allocation does nothing. Everything is released at
+/// once by resetting the arena, which keeps the memory around for reuse. An
+/// arena is not thread-safe; give each thread its own.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_FOUNDATION_ARENA_H_
+#define _SCC_FOUNDATION_ARENA_H_
+
+#include "scc/config.h"
+#include "scc/linkage.h"
+
+#include "scc/foundation/types.h"
+#include "scc/foundation/allocator.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_arena_block {
+  struct scc_arena_block *next;
+
+  // Usable bytes, which immediately follow this header.
+  scc_size_t size;
+} scc_arena_block_t;
+
+typedef struct scc_arena {
+  // Must be first, so an arena can be used wherever an allocator can.
+  scc_allocator_t allocator;
+
+  // Where blocks come from.
+  scc_allocator_t *backing;
+
+  // Minimum size of blocks requested from `backing`.
+  scc_size_t granularity;
+
+  // Every block, in the order they're filled.
+  scc_arena_block_t *first;
+
+  // Block being allocated from and how much of it is used.
+  scc_arena_block_t *current;
+  scc_size_t offset;
+} scc_arena_t;
+
+/// Creates an arena that requests blocks of at least `granularity` bytes from
+/// `backing` as needed.
+extern SCC_LOCAL
+  scc_arena_t *scc_arena_create(scc_allocator_t *backing,
+                                scc_size_t granularity);
+
+extern SCC_LOCAL
+  void scc_arena_destroy(scc_arena_t *arena);
+
+/// Releases everything allocated from `arena`, but holds on to its memory.
+extern SCC_LOCAL
+  void scc_arena_reset(scc_arena_t *arena);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_FOUNDATION_ARENA_H_
@@ -0,0 +1,35 @@
+//===-- scc/foundation/clock.h --------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief High-resolution, monotonic time for profiling.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_FOUNDATION_CLOCK_H_
+#define _SCC_FOUNDATION_CLOCK_H_
+
+#include "scc/config.h"
+#include "scc/linkage.h"
+
+#include "scc/foundation/types.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Returns nanoseconds elapsed since an arbitrary, fixed point in time.
+extern SCC_LOCAL
+  scc_uint64_t scc_monotonic_time_in_ns(void);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_FOUNDATION_CLOCK_H_
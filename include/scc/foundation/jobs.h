@@ -0,0 +1,70 @@
+//===-- scc/foundation/jobs.h ---------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Spreads independent work over a fixed pool of threads.
+///
+/// Work is submitted as a batch of `count` jobs that are distributed to
+/// threads on demand, and the submitting thread participates until every job
+/// in the batch is finished. Each job is told which thread runs it, so that it
+/// can use per-thread resources without synchronization.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_FOUNDATION_JOBS_H_
+#define _SCC_FOUNDATION_JOBS_H_
+
+#include "scc/config.h"
+#include "scc/linkage.h"
+
+#include "scc/foundation/types.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_job_system scc_job_system_t;
+
+/// Runs job `index` of a batch on `thread`, where the submitting thread is
+/// always zero and workers are numbered from one.
+typedef void (*scc_job_fn)(void *context,
+                           scc_uint32_t index,
+                           scc_uint32_t thread);
+
+/// Returns the number of logical processors available.
+extern SCC_LOCAL
+  scc_uint32_t scc_num_of_cores(void);
+
+/// Creates a job system that runs jobs on `num_of_threads` threads, including
+/// the submitting thread. Zero means one per core.
+extern SCC_LOCAL
+  scc_job_system_t *scc_job_system_create(scc_uint32_t num_of_threads);
+
+extern SCC_LOCAL
+  void scc_job_system_destroy(scc_job_system_t *jobs);
+
+/// Returns the number of threads jobs run on, including the submitting thread.
+extern SCC_LOCAL
+  scc_uint32_t scc_job_system_num_of_threads(const scc_job_system_t *jobs);
+
+/// Runs `fn` for each index in `[0, count)` and waits for all to finish.
+///
+/// Batches submitted concurrently are run one after another. Jobs must not
+/// submit batches of their own.
+extern SCC_LOCAL
+  void scc_job_system_for_each(scc_job_system_t *jobs,
+                               scc_uint32_t count,
+                               scc_job_fn fn,
+                               void *context);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_FOUNDATION_JOBS_H_
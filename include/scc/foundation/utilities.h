@@ -76,6 +76,16 @@ static SCC_INLINE scc_uint32_t scc_ctzul(scc_uint32_t n) {
 #endif
 }
 
+/// Counts number of trailing zeros.
+static SCC_INLINE scc_uint32_t scc_ctzull(scc_uint64_t n) {
+#if defined(_MSC_VER)
+  unsigned long bit;
+  return _BitScanForward64(&bit, n) ? bit : 64;
+#elif defined(__clang__) || defined(__GNUC__)
+  return n ? __builtin_ctzll(n) : 64;
+#endif
+}
+
 #if defined(_MSC_VER)
   extern SCC_LOCAL const scc_uint8_t SCC_POPCNTUB_TABLE[256];
 #endif
@@ -0,0 +1,743 @@
+//===-- scc/ir.h ----------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief In-memory form of the intermediate representation.
+///
+/// Everything refers to everything else by index rather than by pointer, so
+/// that functions can be grown, copied, and processed independently without
+/// pointer chasing or fix-ups.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_H_
+#define _SCC_IR_H_
+
+#include "scc/foundation.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Sentinel used for any index that doesn't refer to anything.
+#define SCC_IR_NONE 0xffffffffu
+
+/// Number of inputs of operations that take any number of inputs.
+#define SCC_IR_VARIADIC 0xff
+
+typedef enum scc_program_type {
+  SCC_VERTEX_SHADER  = 1,
+  SCC_PIXEL_SHADER   = 2,
+  SCC_COMPUTE_SHADER = 3
+} scc_program_type_t;
+
+//===----------------------------------------------------------------------===//
+// Operations
+//===----------------------------------------------------------------------===//
+
+typedef enum scc_ir_operation_flags {
+  // Ends a basic block.
+  SCC_IR_TERMINATOR     = (1 << 0),
+
+  // Has effects beyond producing its result.
+  SCC_IR_SIDE_EFFECTS   = (1 << 1),
+
+  // Can be evaluated at compile time given constant inputs.
+  SCC_IR_FOLDABLE       = (1 << 2),
+
+  // Operates on each component independently, broadcasting scalar inputs.
+  // Multiplication involving a matrix is the exception, being a product.
+  SCC_IR_COMPONENT_WISE = (1 << 3),
+
+  // First two inputs can be exchanged without changing the result. Again,
+  // multiplication involving a matrix is the exception.
+  SCC_IR_COMMUTATIVE    = (1 << 4)
+} scc_ir_operation_flags_t;
+
+typedef enum scc_ir_operation {
+  #define OP(Mnemonic, Code, Inputs, Returns, Flags, Description) \
+    SCC_IR_OPERATION_##Code,
+
+    #include "scc/ir/operations.inl"
+
+  #undef OP
+
+  SCC_IR_NUM_OF_OPERATIONS
+} scc_ir_operation_t;
+
+typedef struct scc_ir_operation_info {
+  const char *mnemonic;
+
+  // Number of inputs, or `SCC_IR_VARIADIC`.
+  scc_uint32_t inputs;
+
+  // Zero or one.
+  scc_uint32_t returns;
+
+  // See `scc_ir_operation_flags_t`.
+  scc_uint32_t flags;
+
+  const char *description;
+} scc_ir_operation_info_t;
+
+/// Describes each operation; indexed by `scc_ir_operation_t`.
+extern SCC_PUBLIC
+  const scc_ir_operation_info_t SCC_IR_OPERATIONS[SCC_IR_NUM_OF_OPERATIONS];
+
+static SCC_INLINE scc_bool_t scc_ir_operation_is(scc_uint32_t op,
+                                                 scc_uint32_t flags) {
+  return (SCC_IR_OPERATIONS[op].flags & flags) == flags;
+}
+
+//===----------------------------------------------------------------------===//
+// Types
+//===----------------------------------------------------------------------===//
+
+typedef enum scc_ir_scalar {
+  SCC_IR_VOID      = 0,
+  SCC_IR_BOOL      = 1,
+  SCC_IR_I8        = 2,
+  SCC_IR_I16       = 3,
+  SCC_IR_I32       = 4,
+  SCC_IR_I64       = 5,
+  SCC_IR_U8        = 6,
+  SCC_IR_U16       = 7,
+  SCC_IR_U32       = 8,
+  SCC_IR_U64       = 9,
+  SCC_IR_F32       = 10,
+  SCC_IR_F64       = 11,
+
+  // User-defined aggregate. See `scc_ir_structure_t`.
+  SCC_IR_STRUCTURE = 12
+} scc_ir_scalar_t;
+
+/// A scalar, a vector (`rows` by one), a matrix, or a structure.
+typedef struct scc_ir_type {
+  scc_uint8_t scalar;
+  scc_uint8_t rows;
+  scc_uint8_t columns;
+  scc_uint8_t reserved;
+
+  // Index of structure if `scalar` is `SCC_IR_STRUCTURE`.
+  scc_uint32_t structure;
+} scc_ir_type_t;
+
+static SCC_INLINE scc_ir_type_t scc_ir_type(scc_uint32_t scalar,
+                                            scc_uint32_t rows,
+                                            scc_uint32_t columns) {
+  scc_ir_type_t type;
+  type.scalar = (scc_uint8_t)scalar;
+  type.rows = (scc_uint8_t)rows;
+  type.columns = (scc_uint8_t)columns;
+  type.reserved = 0;
+  type.structure = SCC_IR_NONE;
+  return type;
+}
+
+static SCC_INLINE scc_ir_type_t scc_ir_void(void) {
+  return scc_ir_type(SCC_IR_VOID, 0, 0);
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_void(scc_ir_type_t type) {
+  return (type.scalar == SCC_IR_VOID);
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_scalar(scc_ir_type_t type) {
+  return (type.scalar != SCC_IR_VOID)
+      && (type.scalar != SCC_IR_STRUCTURE)
+      && (type.rows == 1) && (type.columns == 1);
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_vector(scc_ir_type_t type) {
+  return (type.scalar != SCC_IR_STRUCTURE)
+      && (type.rows > 1) && (type.columns == 1);
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_matrix(scc_ir_type_t type) {
+  return (type.scalar != SCC_IR_STRUCTURE) && (type.columns > 1);
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_floating_point(scc_ir_type_t type) {
+  return (type.scalar == SCC_IR_F32) || (type.scalar == SCC_IR_F64);
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_signed(scc_ir_type_t type) {
+  return (type.scalar >= SCC_IR_I8) && (type.scalar <= SCC_IR_I64);
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_unsigned(scc_ir_type_t type) {
+  return (type.scalar >= SCC_IR_U8) && (type.scalar <= SCC_IR_U64);
+}
+
+static SCC_INLINE scc_uint32_t scc_ir_type_num_of_components(scc_ir_type_t type) {
+  return type.rows * type.columns;
+}
+
+static SCC_INLINE scc_bool_t scc_ir_type_is_equal(scc_ir_type_t a,
+                                                  scc_ir_type_t b) {
+  return (a.scalar == b.scalar)
+      && (a.rows == b.rows)
+      && (a.columns == b.columns)
+      && ((a.scalar != SCC_IR_STRUCTURE) || (a.structure == b.structure));
+}
+
+/// Same scalar type with a different shape.
+static SCC_INLINE scc_ir_type_t scc_ir_type_reshape(scc_ir_type_t type,
+                                                    scc_uint32_t rows,
+                                                    scc_uint32_t columns) {
+  return scc_ir_type(type.scalar, rows, columns);
+}
+
+/// Size of a scalar of `type` in bytes.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_scalar_size(scc_ir_type_t type);
+
+/// Name of `type` as used by the textual form, e.g. `f32<4x1>`.
+extern SCC_PUBLIC
+  const char *scc_ir_type_name(scc_ir_type_t type,
+                               char *buffer,
+                               scc_size_t size);
+
+//===----------------------------------------------------------------------===//
+// Values
+//===----------------------------------------------------------------------===//
+
+/// A tagged reference to something that can be an operand.
+///
+/// The upper four bits specify what is referred to, and the rest is an index
+/// into the appropriate table. See `scc_ir_value_kind_t`.
+///
+typedef scc_uint32_t scc_ir_value_t;
+
+typedef enum scc_ir_value_kind {
+  SCC_IR_VALUE_NONE        = 0,
+
+  // Result of an instruction in the same function.
+  SCC_IR_VALUE_INSTRUCTION = 1,
+
+  // Argument of the function.
+  SCC_IR_VALUE_ARGUMENT    = 2,
+
+  // Constant in the function's constant pool.
+  SCC_IR_VALUE_CONSTANT    = 3,
+
+  // An input, output, constant, or texture of the module.
+  SCC_IR_VALUE_GLOBAL      = 4,
+
+  // Member of a structure. Used to address through a global.
+  SCC_IR_VALUE_MEMBER      = 5,
+
+  // Basic block in the same function.
+  SCC_IR_VALUE_BLOCK       = 6,
+
+  // Function in the same module.
+  SCC_IR_VALUE_FUNCTION    = 7,
+
+  // An unsigned integer encoded inline, like a swizzle mask.
+  SCC_IR_VALUE_IMMEDIATE   = 8,
+
+  // An undefined value.
+  SCC_IR_VALUE_UNDEFINED   = 9
+} scc_ir_value_kind_t;
+
+#define SCC_IR_VALUE(Kind, Index) \
+  ((scc_ir_value_t)(((scc_uint32_t)(Kind) << 28) | ((scc_uint32_t)(Index) & 0x0fffffffu)))
+
+#define SCC_IR_VALUE_KIND(Value) \
+  ((scc_ir_value_kind_t)((scc_uint32_t)(Value) >> 28))
+
+#define SCC_IR_VALUE_INDEX(Value) \
+  ((scc_uint32_t)(Value) & 0x0fffffffu)
+
+#define SCC_IR_NO_VALUE \
+  SCC_IR_VALUE(SCC_IR_VALUE_NONE, 0)
+
+/// Packs up to four lane selectors, each in two bits, into a swizzle mask.
+/// The number of lanes selected is given by the type of the swizzle.
+#define SCC_IR_SWIZZLE(X, Y, Z, W) \
+  ((scc_uint32_t)(((X) & 3) | (((Y) & 3) << 2) | (((Z) & 3) << 4) | (((W) & 3) << 6)))
+
+#define SCC_IR_SWIZZLE_LANE(Mask, Lane) \
+  (((Mask) >> ((Lane) * 2)) & 3)
+
+/// Doesn't swizzle.
+#define SCC_IR_IDENTITY_SWIZZLE \
+  SCC_IR_SWIZZLE(0, 1, 2, 3)
+
+typedef union scc_ir_component {
+  scc_int64_t i;
+  scc_uint64_t u;
+  scc_float64_t f;
+} scc_ir_component_t;
+
+/// A literal scalar, vector, or matrix. Matrices are stored column by column.
+typedef struct scc_ir_constant {
+  scc_ir_type_t type;
+  scc_ir_component_t components[16];
+} scc_ir_constant_t;
+
+//===----------------------------------------------------------------------===//
+// Module
+//===----------------------------------------------------------------------===//
+
+/// Offset of a string in `scc_ir_module_t::strings`.
+/// Zero refers to the empty string.
+typedef scc_uint32_t scc_ir_string_t;
+
+typedef struct scc_ir_member {
+  scc_ir_string_t name;
+  scc_ir_type_t type;
+
+  // Offset from start of structure in bytes.
+  scc_uint32_t offset;
+} scc_ir_member_t;
+
+typedef struct scc_ir_structure {
+  scc_ir_string_t name;
+
+  // Members are stored contiguously in `scc_ir_module_t::members`.
+  scc_uint32_t first_member;
+  scc_uint32_t num_of_members;
+} scc_ir_structure_t;
+
+typedef enum scc_ir_storage {
+  SCC_IR_INPUT    = 1,
+  SCC_IR_OUTPUT   = 2,
+  SCC_IR_CONSTANT = 3,
+  SCC_IR_TEXTURE  = 4
+} scc_ir_storage_t;
+
+typedef enum scc_ir_builtin {
+  SCC_IR_BUILTIN_NONE     = 0,
+  SCC_IR_BUILTIN_POSITION = 1,
+  SCC_IR_BUILTIN_DEPTH    = 2
+} scc_ir_builtin_t;
+
+/// An input, output, constant, or texture.
+///
+/// Constants that are structures, like `constants @frame = 0 { ... }`, are
+/// constant buffers of their own bound to `binding`. Loose constants, like
+/// `constants { f32 @time = 0 }`, share a single implicit constant buffer and
+/// are placed at `offset`.
+///
+typedef struct scc_ir_global {
+  scc_ir_string_t name;
+  scc_ir_storage_t storage;
+
+  // Type of value, or in the case of textures, the type of a texel.
+  scc_ir_type_t type;
+
+  // Location of inputs and outputs, slot of constant buffers and textures,
+  // or `SCC_IR_NONE` for loose constants.
+  scc_uint32_t binding;
+
+  // Offset of loose constants in the implicit constant buffer.
+  scc_uint32_t offset;
+
+  // Outputs may be bound to a builtin rather than a location.
+  scc_ir_builtin_t builtin;
+
+  // Components of outputs that the next stage reads, one bit per component,
+  // or zero if not known, in which case all of them are assumed to be read.
+  scc_uint32_t consumed;
+} scc_ir_global_t;
+
+typedef struct scc_ir_module {
+  scc_program_type_t type;
+
+  // Interned, null-terminated strings.
+  char *strings;
+  scc_uint32_t num_of_strings;
+  scc_uint32_t size_of_strings;
+
+  // Open-addressed hash table of offsets into `strings`.
+  scc_ir_string_t *interned;
+  scc_uint32_t num_of_interned;
+  scc_uint32_t size_of_interned;
+
+  scc_ir_structure_t *structures;
+  scc_uint32_t num_of_structures;
+  scc_uint32_t size_of_structures;
+
+  scc_ir_member_t *members;
+  scc_uint32_t num_of_members;
+  scc_uint32_t size_of_members;
+
+  scc_ir_global_t *globals;
+  scc_uint32_t num_of_globals;
+  scc_uint32_t size_of_globals;
+
+  struct scc_ir_function **functions;
+  scc_uint32_t num_of_functions;
+  scc_uint32_t size_of_functions;
+
+  // Index of function that is the entry point.
+  scc_uint32_t entry;
+
+  // Index of function that derives constants from other constants, to be run
+  // once per draw or dispatch rather than per invocation, or `SCC_IR_NONE`.
+  // It takes no arguments and stores to constants. See
+  // `SCC_IR_HOIST_UNIFORMS_PASS`.
+  scc_uint32_t precompute;
+} scc_ir_module_t;
+
+//===----------------------------------------------------------------------===//
+// Functions
+//===----------------------------------------------------------------------===//
+
+typedef struct scc_ir_instruction {
+  // See `scc_ir_operation_t`.
+  scc_uint16_t op;
+
+  scc_uint16_t num_of_operands;
+
+  // Index of first operand in `scc_ir_function_t::operands`.
+  scc_uint32_t operands;
+
+  // Type of result, if any.
+  scc_ir_type_t type;
+
+  // Block this instruction belongs to, or `SCC_IR_NONE` if removed.
+  scc_uint32_t block;
+
+  // Siblings in block.
+  scc_uint32_t prev;
+  scc_uint32_t next;
+} scc_ir_instruction_t;
+
+typedef struct scc_ir_block {
+  scc_ir_string_t name;
+
+  // First and last instruction, or `SCC_IR_NONE` if empty.
+  scc_uint32_t first;
+  scc_uint32_t last;
+
+  // Indicates if this block has been removed.
+  scc_bool_t removed;
+} scc_ir_block_t;
+
+typedef struct scc_ir_argument {
+  scc_ir_string_t name;
+  scc_ir_type_t type;
+} scc_ir_argument_t;
+
+/// A function.
+///
+/// Blocks are laid out in order and the first block is the entry. Every block
+/// ends with a terminator. Operands of `phi` are pairs of a block and the
+/// value to choose when coming from that block.
+///
+typedef struct scc_ir_function {
+  scc_ir_module_t *module;
+
+  // Index in `scc_ir_module_t::functions`.
+  scc_uint32_t index;
+
+  scc_ir_string_t name;
+  scc_ir_type_t return_type;
+
+  // Indicates if this function has been removed.
+  scc_bool_t removed;
+
+  scc_ir_argument_t *arguments;
+  scc_uint32_t num_of_arguments;
+  scc_uint32_t size_of_arguments;
+
+  scc_ir_block_t *blocks;
+  scc_uint32_t num_of_blocks;
+  scc_uint32_t size_of_blocks;
+
+  scc_ir_instruction_t *instructions;
+  scc_uint32_t num_of_instructions;
+  scc_uint32_t size_of_instructions;
+
+  scc_ir_value_t *operands;
+  scc_uint32_t num_of_operands;
+  scc_uint32_t size_of_operands;
+
+  scc_ir_constant_t *constants;
+  scc_uint32_t num_of_constants;
+  scc_uint32_t size_of_constants;
+
+  // Open-addressed hash table of indices into `constants`.
+  scc_uint32_t *interned;
+  scc_uint32_t size_of_interned;
+} scc_ir_function_t;
+
+//===----------------------------------------------------------------------===//
+// Construction
+//===----------------------------------------------------------------------===//
+
+extern SCC_PUBLIC
+  scc_ir_module_t *scc_ir_module_create(scc_program_type_t type);
+
+extern SCC_PUBLIC
+  void scc_ir_module_destroy(scc_ir_module_t *module);
+
+/// Makes a deep copy of `module`, which can be changed without affecting the
+/// original, nor being affected by it. Indices of everything are the same.
+extern SCC_PUBLIC
+  scc_ir_module_t *scc_ir_module_clone(const scc_ir_module_t *module);
+
+/// Interns a null-terminated string.
+extern SCC_PUBLIC
+  scc_ir_string_t scc_ir_module_intern(scc_ir_module_t *module,
+                                       const char *string);
+
+/// Returns the null-terminated string that `string` refers to.
+///
+/// \warning Invalidated by interning.
+///
+static SCC_INLINE const char *scc_ir_module_string(const scc_ir_module_t *module,
+                                                   scc_ir_string_t string) {
+  return &module->strings[string];
+}
+
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_module_add_structure(scc_ir_module_t *module,
+                                           const char *name);
+
+/// Members must be added immediately after their structure.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_module_add_member(scc_ir_module_t *module,
+                                        scc_uint32_t structure,
+                                        const char *name,
+                                        scc_ir_type_t type,
+                                        scc_uint32_t offset);
+
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_module_add_global(scc_ir_module_t *module,
+                                        const char *name,
+                                        scc_ir_storage_t storage,
+                                        scc_ir_type_t type,
+                                        scc_uint32_t binding);
+
+extern SCC_PUBLIC
+  scc_ir_function_t *scc_ir_module_add_function(scc_ir_module_t *module,
+                                                const char *name,
+                                                scc_ir_type_t return_type);
+
+/// Finds a function by name, or returns `NULL`.
+extern SCC_PUBLIC
+  scc_ir_function_t *scc_ir_module_find_function(const scc_ir_module_t *module,
+                                                 const char *name);
+
+/// Size of `type` in bytes when tightly packed.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_type_size(const scc_ir_module_t *module,
+                                scc_ir_type_t type);
+
+/// Removes a function. Its storage is released but it keeps its index, so
+/// that references to other functions remain valid.
+///
+/// \warning Calls to it are left dangling.
+///
+extern SCC_PUBLIC
+  void scc_ir_module_remove_function(scc_ir_module_t *module,
+                                     scc_uint32_t function);
+
+/// Removes each global flagged in `removing`, indexed by global, then
+/// renumbers references to the remainder in every function.
+///
+/// \warning None of the globals removed may be referenced.
+///
+extern SCC_PUBLIC
+  void scc_ir_module_remove_globals(scc_ir_module_t *module,
+                                    const scc_bool_t *removing);
+
+/// Moves globals so that `order[position]` is at `position`, then renumbers
+/// references to them in every function. `order` must name every global once.
+extern SCC_PUBLIC
+  void scc_ir_module_reorder_globals(scc_ir_module_t *module,
+                                     const scc_uint32_t *order);
+
+/// Removes each member of `structure` flagged in `removing`, indexed by
+/// member, then renumbers references to the remainder in every function.
+/// Offsets of the remainder are left as they are.
+///
+/// \warning None of the members removed may be referenced.
+///
+extern SCC_PUBLIC
+  void scc_ir_module_remove_members(scc_ir_module_t *module,
+                                    scc_uint32_t structure,
+                                    const scc_bool_t *removing);
+
+/// Moves members of `structure` so that `order[position]`, indexed by member,
+/// is at `position`, then renumbers references to them in every function.
+/// Offsets are left as they are. `order` must name every member once.
+extern SCC_PUBLIC
+  void scc_ir_module_reorder_members(scc_ir_module_t *module,
+                                     scc_uint32_t structure,
+                                     const scc_uint32_t *order);
+
+extern SCC_PUBLIC
+  scc_ir_value_t scc_ir_function_add_argument(scc_ir_function_t *function,
+                                              const char *name,
+                                              scc_ir_type_t type);
+
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_function_add_block(scc_ir_function_t *function,
+                                         const char *name);
+
+/// Interns a constant, returning a reference to it.
+extern SCC_PUBLIC
+  scc_ir_value_t scc_ir_function_constant(scc_ir_function_t *function,
+                                          const scc_ir_constant_t *constant);
+
+/// Interns a constant with every component set to `value`.
+extern SCC_PUBLIC
+  scc_ir_value_t scc_ir_function_splat(scc_ir_function_t *function,
+                                       scc_ir_type_t type,
+                                       scc_float64_t value);
+
+/// Removes constants that aren't referenced by any instruction, renumbering
+/// those that are. Returns the number removed.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_function_remove_unused_constants(scc_ir_function_t *function);
+
+/// Appends an instruction to the end of `block`.
+extern SCC_PUBLIC
+  scc_ir_value_t scc_ir_function_append(scc_ir_function_t *function,
+                                        scc_uint32_t block,
+                                        scc_ir_operation_t op,
+                                        scc_ir_type_t type,
+                                        const scc_ir_value_t *operands,
+                                        scc_uint32_t num_of_operands);
+
+/// Inserts an instruction immediately before `before`.
+extern SCC_PUBLIC
+  scc_ir_value_t scc_ir_function_insert(scc_ir_function_t *function,
+                                        scc_uint32_t before,
+                                        scc_ir_operation_t op,
+                                        scc_ir_type_t type,
+                                        const scc_ir_value_t *operands,
+                                        scc_uint32_t num_of_operands);
+
+/// Replaces the operands of an instruction.
+extern SCC_PUBLIC
+  void scc_ir_function_set_operands(scc_ir_function_t *function,
+                                    scc_uint32_t instruction,
+                                    const scc_ir_value_t *operands,
+                                    scc_uint32_t num_of_operands);
+
+/// Unlinks an instruction from its block.
+extern SCC_PUBLIC
+  void scc_ir_function_unlink(scc_ir_function_t *function,
+                              scc_uint32_t instruction);
+
+/// Unlinks an instruction, then links it immediately before `before`, or to
+/// the end of `block` if `before` is `SCC_IR_NONE`.
+extern SCC_PUBLIC
+  void scc_ir_function_move(scc_ir_function_t *function,
+                            scc_uint32_t instruction,
+                            scc_uint32_t block,
+                            scc_uint32_t before);
+
+/// Removes an instruction. Any references to it are left dangling.
+extern SCC_PUBLIC
+  void scc_ir_function_remove(scc_ir_function_t *function,
+                              scc_uint32_t instruction);
+
+/// Removes a block and all of its instructions.
+extern SCC_PUBLIC
+  void scc_ir_function_remove_block(scc_ir_function_t *function,
+                                    scc_uint32_t block);
+
+/// Replaces every use of `value` with `replacement`.
+extern SCC_PUBLIC
+  void scc_ir_function_replace(scc_ir_function_t *function,
+                               scc_ir_value_t value,
+                               scc_ir_value_t replacement);
+
+/// Replaces every use of each instruction's result with the corresponding
+/// value in `forwarding`, unless that is `SCC_IR_NO_VALUE`, in one sweep.
+extern SCC_PUBLIC
+  void scc_ir_function_forward(scc_ir_function_t *function,
+                               const scc_ir_value_t *forwarding);
+
+/// Whether control can flow from block `from` to block `to`.
+typedef scc_bool_t (*scc_ir_edge_fn)(const void *user,
+                                     scc_uint32_t from,
+                                     scc_uint32_t to);
+
+/// Drops incoming values of phis from blocks that `flows` says can't flow
+/// into theirs, forwarding those left with one incoming value to it. Phis
+/// left with none are kept, as their blocks can't be reached anyway. Then
+/// forwards and removes every instruction with a value in `forwarding`,
+/// indexed by instruction, which may already hold some. Returns true if
+/// anything changed.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_function_prune_phis(scc_ir_function_t *function,
+                                        scc_ir_edge_fn flows,
+                                        const void *user,
+                                        scc_ir_value_t *forwarding);
+
+//===----------------------------------------------------------------------===//
+// Queries
+//===----------------------------------------------------------------------===//
+
+static SCC_INLINE scc_ir_value_t *scc_ir_operands(const scc_ir_function_t *function,
+                                                  const scc_ir_instruction_t *instruction) {
+  return &function->operands[instruction->operands];
+}
+
+static SCC_INLINE scc_ir_value_t scc_ir_operand(const scc_ir_function_t *function,
+                                                const scc_ir_instruction_t *instruction,
+                                                scc_uint32_t operand) {
+  return (operand < instruction->num_of_operands)
+       ? function->operands[instruction->operands + operand]
+       : SCC_IR_NO_VALUE;
+}
+
+static SCC_INLINE scc_bool_t scc_ir_instruction_is_live(const scc_ir_instruction_t *instruction) {
+  return (instruction->block != SCC_IR_NONE);
+}
+
+/// Type of any value that has one.
+extern SCC_PUBLIC
+  scc_ir_type_t scc_ir_value_type(const scc_ir_function_t *function,
+                                  scc_ir_value_t value);
+
+/// Returns the constant `value` refers to, or `NULL` if it isn't a constant.
+static SCC_INLINE const scc_ir_constant_t *scc_ir_value_constant(const scc_ir_function_t *function,
+                                                                 scc_ir_value_t value) {
+  if (SCC_IR_VALUE_KIND(value) != SCC_IR_VALUE_CONSTANT)
+    return NULL;
+  return &function->constants[SCC_IR_VALUE_INDEX(value)];
+}
+
+/// True if `instruction` operates on each component of its inputs
+/// independently. See `SCC_IR_COMPONENT_WISE`.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_instruction_is_component_wise(const scc_ir_function_t *function,
+                                                  const scc_ir_instruction_t *instruction);
+
+/// True if the first two operands of `instruction` can be exchanged. See
+/// `SCC_IR_COMMUTATIVE`.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_instruction_is_commutative(const scc_ir_function_t *function,
+                                               const scc_ir_instruction_t *instruction);
+
+/// Terminator of `block`, or `SCC_IR_NONE` if it doesn't end with one.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_block_terminator(const scc_ir_function_t *function,
+                                       scc_uint32_t block);
+
+/// Writes up to two successors of `block` to `successors`, returning how many
+/// there are.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_block_successors(const scc_ir_function_t *function,
+                                       scc_uint32_t block,
+                                       scc_uint32_t successors[2]);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_H_
@@ -0,0 +1,167 @@
+//===-- scc/ir/bytecode.h -------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Functions flattened into code for a register machine.
+///
+/// Every value a function refers to is given a slot in a frame, i.e. the
+/// offset, in words, of its components, laid out as `scc_ir_interpreter_t`
+/// expects. Instructions are encoded as an opcode followed by the slots of
+/// their result and operands, so running them doesn't involve decoding
+/// operands or looking at types. Common operations on common types have
+/// opcodes of their own, like `add.f32x4` or `dot.f32x3`, while anything else
+/// is encoded as `generic`, referring back to the instruction.
+///
+/// Blocks are laid out in reverse post-order, each ending with a terminator.
+/// Jumps and branches encode edges, each being the block entered followed by
+/// copies to its phis, i.e. `block, n, (destination, source, components) * n`.
+///
+/// Frames start with an image of the constants a function refers to, preceded
+/// by zeros that stand in for undefined values, and end with scratch space.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_BYTECODE_H_
+#define _SCC_IR_BYTECODE_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/interpreter.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef enum scc_ir_opcode {
+  #define OPCODE(Mnemonic, Code, Operands) \
+    SCC_IR_OPCODE_##Code,
+
+    #include "scc/ir/bytecode.inl"
+
+  #undef OPCODE
+
+  SCC_IR_NUM_OF_OPCODES
+} scc_ir_opcode_t;
+
+typedef struct scc_ir_opcode_info {
+  const char *mnemonic;
+
+  // Number of words following the opcode, or `SCC_IR_VARIADIC`.
+  scc_uint32_t operands;
+} scc_ir_opcode_info_t;
+
+/// Describes each opcode; indexed by `scc_ir_opcode_t`.
+extern SCC_PUBLIC
+  const scc_ir_opcode_info_t SCC_IR_OPCODES[SCC_IR_NUM_OF_OPCODES];
+
+/// Does what a run of opcodes does for every lane of `frame`.
+typedef void (*scc_ir_native_fn)(scc_ir_word_t *frame);
+
+typedef struct scc_ir_bytecode {
+  const scc_ir_function_t *function;
+
+  scc_uint32_t *code;
+  scc_uint32_t size_of_code;
+
+  // Indexed by block. Offset in `code` of each block, or `SCC_IR_NONE` if
+  // unreachable.
+  scc_uint32_t *blocks;
+
+  // Reachable blocks, in reverse post-order.
+  scc_uint32_t *order;
+  scc_uint32_t num_of_reachable;
+
+  // Slots of each instruction, argument, and constant, and of what's returned.
+  scc_uint32_t *instructions;
+  scc_uint32_t *arguments;
+  scc_uint32_t *constants;
+  scc_uint32_t returned;
+
+  // Where incoming values are staged before being copied to phis, and where
+  // scalars are splatted.
+  scc_uint32_t incoming;
+  scc_uint32_t scratch;
+
+  scc_uint32_t size_of_frame;
+
+  // Initial contents of the first words of every frame.
+  scc_ir_word_t *image;
+  scc_uint32_t size_of_image;
+
+  // Called by `native`, if any runs were compiled.
+  scc_ir_native_fn *natives;
+  scc_uint32_t num_of_natives;
+} scc_ir_bytecode_t;
+
+/// Determines if values of `type` can be given a slot, i.e. are void or have
+/// no more than sixteen components of 32 bits or less.
+static SCC_INLINE scc_bool_t scc_ir_bytecode_is_representable(scc_ir_type_t type) {
+  switch (type.scalar) {
+    case SCC_IR_VOID:
+      return SCC_TRUE;
+
+    case SCC_IR_BOOL:
+    case SCC_IR_I8: case SCC_IR_I16: case SCC_IR_I32:
+    case SCC_IR_U8: case SCC_IR_U16: case SCC_IR_U32:
+    case SCC_IR_F32:
+      return scc_ir_type_num_of_components(type) <= 16;
+  }
+
+  return SCC_FALSE;
+}
+
+/// Lowers `function`. Returns `NULL` if it refers to values that can't be
+/// given a slot.
+extern SCC_PUBLIC
+  scc_ir_bytecode_t *scc_ir_bytecode_lower(const scc_ir_function_t *function);
+
+extern SCC_PUBLIC
+  void scc_ir_bytecode_destroy(scc_ir_bytecode_t *bytecode);
+
+/// Returns the slot of `value`. Anything without one, like undefined values,
+/// reads zeros.
+static SCC_INLINE scc_uint32_t scc_ir_bytecode_slot(const scc_ir_bytecode_t *bytecode,
+                                                    scc_ir_value_t value) {
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      return bytecode->instructions[SCC_IR_VALUE_INDEX(value)];
+    case SCC_IR_VALUE_ARGUMENT:
+      return bytecode->arguments[SCC_IR_VALUE_INDEX(value)];
+    case SCC_IR_VALUE_CONSTANT:
+      return bytecode->constants[SCC_IR_VALUE_INDEX(value)];
+    default:
+      return 0;
+  }
+}
+
+/// Returns the number of words taken by the opcode at `pc`, including the
+/// opcode itself.
+static SCC_INLINE scc_uint32_t scc_ir_bytecode_length(const scc_uint32_t *pc) {
+  switch (pc[0]) {
+    case SCC_IR_OPCODE_SHUFFLE:
+      return 3 + pc[2];
+
+    case SCC_IR_OPCODE_JUMP:
+      return 3 + 3 * pc[2];
+
+    case SCC_IR_OPCODE_BRANCH: {
+      const scc_uint32_t first = 2 + 3 * pc[4];
+      return 3 + first + 2 + 3 * pc[3 + first + 1];
+    }
+  }
+
+  return 1 + SCC_IR_OPCODES[pc[0]].operands;
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_BYTECODE_H_
@@ -0,0 +1,218 @@
+// Mnemonic, Code, Operands
+
+OPCODE("generic",       GENERIC,         1)
+
+// Calls native code in place of the opcodes that follow, then skips them, if
+// every lane is running. See `scc_ir_jit_compile`.
+OPCODE("native",        NATIVE,          2)
+
+//
+// Data Movement
+//
+
+OPCODE("shuffle",       SHUFFLE,         SCC_IR_VARIADIC)
+
+OPCODE("splat.x2",      SPLAT_X2,        2)
+OPCODE("splat.x3",      SPLAT_X3,        2)
+OPCODE("splat.x4",      SPLAT_X4,        2)
+
+//
+// Arithmetic
+//
+
+OPCODE("add.f32x1",     ADD_F32X1,       3)
+OPCODE("add.f32x2",     ADD_F32X2,       3)
+OPCODE("add.f32x3",     ADD_F32X3,       3)
+OPCODE("add.f32x4",     ADD_F32X4,       3)
+
+OPCODE("sub.f32x1",     SUB_F32X1,       3)
+OPCODE("sub.f32x2",     SUB_F32X2,       3)
+OPCODE("sub.f32x3",     SUB_F32X3,       3)
+OPCODE("sub.f32x4",     SUB_F32X4,       3)
+
+OPCODE("mul.f32x1",     MUL_F32X1,       3)
+OPCODE("mul.f32x2",     MUL_F32X2,       3)
+OPCODE("mul.f32x3",     MUL_F32X3,       3)
+OPCODE("mul.f32x4",     MUL_F32X4,       3)
+
+OPCODE("div.f32x1",     DIV_F32X1,       3)
+OPCODE("div.f32x2",     DIV_F32X2,       3)
+OPCODE("div.f32x3",     DIV_F32X3,       3)
+OPCODE("div.f32x4",     DIV_F32X4,       3)
+
+OPCODE("min.f32x1",     MIN_F32X1,       3)
+OPCODE("min.f32x2",     MIN_F32X2,       3)
+OPCODE("min.f32x3",     MIN_F32X3,       3)
+OPCODE("min.f32x4",     MIN_F32X4,       3)
+
+OPCODE("max.f32x1",     MAX_F32X1,       3)
+OPCODE("max.f32x2",     MAX_F32X2,       3)
+OPCODE("max.f32x3",     MAX_F32X3,       3)
+OPCODE("max.f32x4",     MAX_F32X4,       3)
+
+OPCODE("fma.f32x1",     FMA_F32X1,       4)
+OPCODE("fma.f32x2",     FMA_F32X2,       4)
+OPCODE("fma.f32x3",     FMA_F32X3,       4)
+OPCODE("fma.f32x4",     FMA_F32X4,       4)
+
+OPCODE("clamp.f32x1",   CLAMP_F32X1,     4)
+OPCODE("clamp.f32x2",   CLAMP_F32X2,     4)
+OPCODE("clamp.f32x3",   CLAMP_F32X3,     4)
+OPCODE("clamp.f32x4",   CLAMP_F32X4,     4)
+
+OPCODE("abs.f32x1",     ABS_F32X1,       2)
+OPCODE("abs.f32x2",     ABS_F32X2,       2)
+OPCODE("abs.f32x3",     ABS_F32X3,       2)
+OPCODE("abs.f32x4",     ABS_F32X4,       2)
+
+OPCODE("floor.f32x1",   FLOOR_F32X1,     2)
+OPCODE("floor.f32x2",   FLOOR_F32X2,     2)
+OPCODE("floor.f32x3",   FLOOR_F32X3,     2)
+OPCODE("floor.f32x4",   FLOOR_F32X4,     2)
+
+OPCODE("ceil.f32x1",    CEIL_F32X1,      2)
+OPCODE("ceil.f32x2",    CEIL_F32X2,      2)
+OPCODE("ceil.f32x3",    CEIL_F32X3,      2)
+OPCODE("ceil.f32x4",    CEIL_F32X4,      2)
+
+OPCODE("sqrt.f32x1",    SQRT_F32X1,      2)
+OPCODE("sqrt.f32x2",    SQRT_F32X2,      2)
+OPCODE("sqrt.f32x3",    SQRT_F32X3,      2)
+OPCODE("sqrt.f32x4",    SQRT_F32X4,      2)
+
+OPCODE("rsqrt.f32x1",   RSQRT_F32X1,     2)
+OPCODE("rsqrt.f32x2",   RSQRT_F32X2,     2)
+OPCODE("rsqrt.f32x3",   RSQRT_F32X3,     2)
+OPCODE("rsqrt.f32x4",   RSQRT_F32X4,     2)
+
+OPCODE("sat.f32x1",     SAT_F32X1,       2)
+OPCODE("sat.f32x2",     SAT_F32X2,       2)
+OPCODE("sat.f32x3",     SAT_F32X3,       2)
+OPCODE("sat.f32x4",     SAT_F32X4,       2)
+
+//
+// Integer Arithmetic
+//
+
+// Wraps, so serves signed and unsigned integers alike.
+
+OPCODE("add.i32x1",     ADD_I32X1,       3)
+OPCODE("add.i32x2",     ADD_I32X2,       3)
+OPCODE("add.i32x3",     ADD_I32X3,       3)
+OPCODE("add.i32x4",     ADD_I32X4,       3)
+
+OPCODE("sub.i32x1",     SUB_I32X1,       3)
+OPCODE("sub.i32x2",     SUB_I32X2,       3)
+OPCODE("sub.i32x3",     SUB_I32X3,       3)
+OPCODE("sub.i32x4",     SUB_I32X4,       3)
+
+OPCODE("mul.i32x1",     MUL_I32X1,       3)
+OPCODE("mul.i32x2",     MUL_I32X2,       3)
+OPCODE("mul.i32x3",     MUL_I32X3,       3)
+OPCODE("mul.i32x4",     MUL_I32X4,       3)
+
+//
+// Comparisons
+//
+
+OPCODE("lt.f32x1",      LT_F32X1,        3)
+OPCODE("lt.f32x2",      LT_F32X2,        3)
+OPCODE("lt.f32x3",      LT_F32X3,        3)
+OPCODE("lt.f32x4",      LT_F32X4,        3)
+
+OPCODE("le.f32x1",      LE_F32X1,        3)
+OPCODE("le.f32x2",      LE_F32X2,        3)
+OPCODE("le.f32x3",      LE_F32X3,        3)
+OPCODE("le.f32x4",      LE_F32X4,        3)
+
+OPCODE("eq.f32x1",      EQ_F32X1,        3)
+OPCODE("eq.f32x2",      EQ_F32X2,        3)
+OPCODE("eq.f32x3",      EQ_F32X3,        3)
+OPCODE("eq.f32x4",      EQ_F32X4,        3)
+
+OPCODE("ne.f32x1",      NE_F32X1,        3)
+OPCODE("ne.f32x2",      NE_F32X2,        3)
+OPCODE("ne.f32x3",      NE_F32X3,        3)
+OPCODE("ne.f32x4",      NE_F32X4,        3)
+
+OPCODE("gt.f32x1",      GT_F32X1,        3)
+OPCODE("gt.f32x2",      GT_F32X2,        3)
+OPCODE("gt.f32x3",      GT_F32X3,        3)
+OPCODE("gt.f32x4",      GT_F32X4,        3)
+
+OPCODE("ge.f32x1",      GE_F32X1,        3)
+OPCODE("ge.f32x2",      GE_F32X2,        3)
+OPCODE("ge.f32x3",      GE_F32X3,        3)
+OPCODE("ge.f32x4",      GE_F32X4,        3)
+
+OPCODE("lt.i32x1",      LT_I32X1,        3)
+OPCODE("lt.i32x2",      LT_I32X2,        3)
+OPCODE("lt.i32x3",      LT_I32X3,        3)
+OPCODE("lt.i32x4",      LT_I32X4,        3)
+
+OPCODE("le.i32x1",      LE_I32X1,        3)
+OPCODE("le.i32x2",      LE_I32X2,        3)
+OPCODE("le.i32x3",      LE_I32X3,        3)
+OPCODE("le.i32x4",      LE_I32X4,        3)
+
+OPCODE("eq.i32x1",      EQ_I32X1,        3)
+OPCODE("eq.i32x2",      EQ_I32X2,        3)
+OPCODE("eq.i32x3",      EQ_I32X3,        3)
+OPCODE("eq.i32x4",      EQ_I32X4,        3)
+
+OPCODE("ne.i32x1",      NE_I32X1,        3)
+OPCODE("ne.i32x2",      NE_I32X2,        3)
+OPCODE("ne.i32x3",      NE_I32X3,        3)
+OPCODE("ne.i32x4",      NE_I32X4,        3)
+
+OPCODE("gt.i32x1",      GT_I32X1,        3)
+OPCODE("gt.i32x2",      GT_I32X2,        3)
+OPCODE("gt.i32x3",      GT_I32X3,        3)
+OPCODE("gt.i32x4",      GT_I32X4,        3)
+
+OPCODE("ge.i32x1",      GE_I32X1,        3)
+OPCODE("ge.i32x2",      GE_I32X2,        3)
+OPCODE("ge.i32x3",      GE_I32X3,        3)
+OPCODE("ge.i32x4",      GE_I32X4,        3)
+
+// Equality of unsigned integers is the same as that of signed integers.
+
+OPCODE("lt.u32x1",      LT_U32X1,        3)
+OPCODE("lt.u32x2",      LT_U32X2,        3)
+OPCODE("lt.u32x3",      LT_U32X3,        3)
+OPCODE("lt.u32x4",      LT_U32X4,        3)
+
+OPCODE("le.u32x1",      LE_U32X1,        3)
+OPCODE("le.u32x2",      LE_U32X2,        3)
+OPCODE("le.u32x3",      LE_U32X3,        3)
+OPCODE("le.u32x4",      LE_U32X4,        3)
+
+OPCODE("gt.u32x1",      GT_U32X1,        3)
+OPCODE("gt.u32x2",      GT_U32X2,        3)
+OPCODE("gt.u32x3",      GT_U32X3,        3)
+OPCODE("gt.u32x4",      GT_U32X4,        3)
+
+OPCODE("ge.u32x1",      GE_U32X1,        3)
+OPCODE("ge.u32x2",      GE_U32X2,        3)
+OPCODE("ge.u32x3",      GE_U32X3,        3)
+OPCODE("ge.u32x4",      GE_U32X4,        3)
+
+//
+// Geometry
+//
+
+OPCODE("dot.f32x2",     DOT_F32X2,       3)
+OPCODE("dot.f32x3",     DOT_F32X3,       3)
+OPCODE("dot.f32x4",     DOT_F32X4,       3)
+
+// Product of a 4x4 matrix and a column vector.
+OPCODE("mul.f32x4x4",   MUL_F32X4X4,     3)
+
+//
+// Control Flow
+//
+
+OPCODE("jmp",           JUMP,            SCC_IR_VARIADIC)
+OPCODE("br",            BRANCH,          SCC_IR_VARIADIC)
+OPCODE("ret",           RETURN,          2)
+OPCODE("discard",       DISCARD,         0)
@@ -0,0 +1,80 @@
+//===-- scc/ir/cfg.h ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Control-flow graph of a function, as implied by `jmp` and `branch`.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_CFG_H_
+#define _SCC_IR_CFG_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_cfg {
+  scc_uint32_t num_of_blocks;
+
+  // Edges are stored compressed. Successors of block `b` are
+  // `successors[first_successor[b]]` up to `successors[first_successor[b+1]]`,
+  // and similarly for predecessors.
+  scc_uint32_t *successors;
+  scc_uint32_t *first_successor;
+  scc_uint32_t *predecessors;
+  scc_uint32_t *first_predecessor;
+
+  // Blocks reachable from entry in reverse post-order.
+  scc_uint32_t *order;
+  scc_uint32_t num_of_reachable;
+
+  // Position of each block in `order`, or `SCC_IR_NONE` if unreachable.
+  scc_uint32_t *position;
+} scc_ir_cfg_t;
+
+extern SCC_PUBLIC
+  scc_ir_cfg_t *scc_ir_cfg_compute(const scc_ir_function_t *function);
+
+extern SCC_PUBLIC
+  void scc_ir_cfg_destroy(scc_ir_cfg_t *cfg);
+
+static SCC_INLINE scc_uint32_t scc_ir_cfg_num_of_successors(const scc_ir_cfg_t *cfg,
+                                                            scc_uint32_t block) {
+  return cfg->first_successor[block + 1] - cfg->first_successor[block];
+}
+
+static SCC_INLINE const scc_uint32_t *scc_ir_cfg_successors(const scc_ir_cfg_t *cfg,
+                                                            scc_uint32_t block) {
+  return &cfg->successors[cfg->first_successor[block]];
+}
+
+static SCC_INLINE scc_uint32_t scc_ir_cfg_num_of_predecessors(const scc_ir_cfg_t *cfg,
+                                                              scc_uint32_t block) {
+  return cfg->first_predecessor[block + 1] - cfg->first_predecessor[block];
+}
+
+static SCC_INLINE const scc_uint32_t *scc_ir_cfg_predecessors(const scc_ir_cfg_t *cfg,
+                                                              scc_uint32_t block) {
+  return &cfg->predecessors[cfg->first_predecessor[block]];
+}
+
+static SCC_INLINE scc_bool_t scc_ir_cfg_is_reachable(const scc_ir_cfg_t *cfg,
+                                                     scc_uint32_t block) {
+  return (cfg->position[block] != SCC_IR_NONE);
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_CFG_H_
@@ -0,0 +1,77 @@
+//===-- scc/ir/demanded.h -------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Components of the result of each instruction that anything with
+/// side effects ultimately depends on.
+///
+/// Demand flows backward from stores, calls, and terminators, which demand
+/// every component of their operands, bar stores to outputs, which demand
+/// those in `scc_ir_global_t::consumed` when it's known. Swizzles demand the
+/// components they select, compositions the components that end up in
+/// demanded lanes, and component-wise operations the same components of
+/// their inputs, or just the first of broadcast scalars. Anything else demands
+/// every component of its operands if any component of its result is demanded.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_DEMANDED_H_
+#define _SCC_IR_DEMANDED_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Set of components, one bit per component in column-major order.
+typedef scc_uint16_t scc_ir_components_t;
+
+#define SCC_IR_ALL_COMPONENTS \
+  ((scc_ir_components_t)0xffff)
+
+typedef struct scc_ir_demanded {
+  scc_uint32_t num_of_instructions;
+
+  // Components of the result of each instruction that are demanded.
+  scc_ir_components_t *components;
+} scc_ir_demanded_t;
+
+extern SCC_PUBLIC
+  scc_ir_demanded_t *scc_ir_demanded_compute(const scc_ir_function_t *function);
+
+extern SCC_PUBLIC
+  void scc_ir_demanded_destroy(scc_ir_demanded_t *demanded);
+
+/// Returns the components of `value` that are demanded. Anything but an
+/// instruction known to `demanded` is assumed to be demanded in full.
+static SCC_INLINE scc_ir_components_t scc_ir_demanded_components(const scc_ir_demanded_t *demanded,
+                                                                 scc_ir_value_t value) {
+  if (SCC_IR_VALUE_KIND(value) != SCC_IR_VALUE_INSTRUCTION)
+    return SCC_IR_ALL_COMPONENTS;
+  if (SCC_IR_VALUE_INDEX(value) >= demanded->num_of_instructions)
+    return SCC_IR_ALL_COMPONENTS;
+  return demanded->components[SCC_IR_VALUE_INDEX(value)];
+}
+
+/// Returns the number of leading components that cover `components`.
+static SCC_INLINE scc_uint32_t scc_ir_components_extent(scc_ir_components_t components) {
+  scc_uint32_t extent = 0;
+  while (components >> extent)
+    extent += 1;
+  return extent;
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_DEMANDED_H_
@@ -0,0 +1,91 @@
+//===-- scc/ir/dominators.h -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Dominator and post-dominator trees of a function.
+///
+/// Blocks are numbered in the order a depth-first walk of the tree enters and
+/// leaves them, so dominance is answered in constant time by comparing
+/// intervals rather than walking up the tree.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_DOMINATORS_H_
+#define _SCC_IR_DOMINATORS_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/cfg.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_dominators {
+  scc_uint32_t num_of_blocks;
+
+  // Immediate dominator of each block, or `SCC_IR_NONE` for roots and blocks
+  // not in the tree.
+  scc_uint32_t *idom;
+
+  // Children of each block in the tree, compressed like `scc_ir_cfg_t`.
+  scc_uint32_t *children;
+  scc_uint32_t *first_child;
+
+  // Blocks without an immediate dominator that are in the tree. Just the
+  // entry for dominators. For post-dominators, every block that is only
+  // post-dominated by leaving the function, which makes the tree a forest.
+  scc_uint32_t *roots;
+  scc_uint32_t num_of_roots;
+
+  // Order in which a depth-first walk of the tree enters and leaves each
+  // block, or `SCC_IR_NONE` for blocks not in the tree.
+  scc_uint32_t *pre;
+  scc_uint32_t *post;
+} scc_ir_dominators_t;
+
+/// Computes dominators with the iterative algorithm described by Cooper,
+/// Harvey, and Kennedy in "A Simple, Fast Dominance Algorithm."
+extern SCC_PUBLIC
+  scc_ir_dominators_t *scc_ir_dominators_compute(const scc_ir_function_t *function,
+                                                 const scc_ir_cfg_t *cfg);
+
+/// Computes post-dominators, i.e. dominators of the reversed graph rooted at a
+/// virtual exit that follows every block without successors. Blocks that
+/// never reach an exit, like those in an infinite loop, are left out.
+extern SCC_PUBLIC
+  scc_ir_dominators_t *scc_ir_post_dominators_compute(const scc_ir_function_t *function,
+                                                      const scc_ir_cfg_t *cfg);
+
+extern SCC_PUBLIC
+  void scc_ir_dominators_destroy(scc_ir_dominators_t *dominators);
+
+/// Returns true if `a` dominates `b`, or post-dominates if given
+/// post-dominators. Every block dominates itself.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_dominates(const scc_ir_dominators_t *dominators,
+                              scc_uint32_t a,
+                              scc_uint32_t b);
+
+static SCC_INLINE scc_uint32_t scc_ir_dominators_num_of_children(const scc_ir_dominators_t *dominators,
+                                                                 scc_uint32_t block) {
+  return dominators->first_child[block + 1] - dominators->first_child[block];
+}
+
+static SCC_INLINE const scc_uint32_t *scc_ir_dominators_children(const scc_ir_dominators_t *dominators,
+                                                                 scc_uint32_t block) {
+  return &dominators->children[dominators->first_child[block]];
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_DOMINATORS_H_
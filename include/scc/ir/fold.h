@@ -0,0 +1,56 @@
+//===-- scc/ir/fold.h -----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Evaluates operations on constants at compile time.
+///
+/// Arithmetic is done in double precision, or 64-bit integers, and results
+/// are then rounded or wrapped to the result type so that folding matches
+/// what would happen at runtime as closely as possible.
+///
+/// Operations are component-wise unless they say otherwise, and a scalar
+/// input is broadcast to the width of the result. Multiplication is the
+/// exception: a matrix by a vector or matrix, or a vector by a matrix, is a
+/// linear algebraic product.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_FOLD_H_
+#define _SCC_IR_FOLD_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Evaluates `instruction` given the value of each of its operands, storing
+/// the result in `result`. Operands that aren't values, like swizzle masks,
+/// are read from the instruction and their entry in `operands` is ignored.
+///
+/// Returns false if the operation isn't foldable or the result is undefined,
+/// like integer division by zero or the inverse of a singular matrix.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_fold(const scc_ir_function_t *function,
+                         const scc_ir_instruction_t *instruction,
+                         const scc_ir_constant_t * const *operands,
+                         scc_ir_constant_t *result);
+
+/// Returns true if any component of `constant` is non-zero.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_constant_is_true(const scc_ir_constant_t *constant);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_FOLD_H_
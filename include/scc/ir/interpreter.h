@@ -0,0 +1,142 @@
+//===-- scc/ir/interpreter.h ----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Runs programs on the host, many invocations at a time.
+///
+/// Invocations are run in batches of `SCC_IR_LANES`, with values laid out
+/// component by component, each component holding one word per lane, so that
+/// each operation is a loop over lanes the compiler can vectorize. Lanes that
+/// take different paths through a function are tracked with masks: blocks run
+/// in reverse post-order for whichever lanes are waiting to enter them, so
+/// lanes that diverge reconverge where paths meet.
+///
+/// Every component is a 32-bit word. Floats are single-precision, and smaller
+/// integers and booleans are widened to 32 bits. Functions that use 64-bit
+/// scalars, or structures other than through loads of their members, aren't
+/// supported.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_INTERPRETER_H_
+#define _SCC_IR_INTERPRETER_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Number of invocations run at once, matching the widest vector registers
+/// targeted by the build.
+#if defined(__AVX512F__)
+  #define SCC_IR_LANES 16
+#elif defined(__AVX__)
+  #define SCC_IR_LANES 8
+#else
+  #define SCC_IR_LANES 4
+#endif
+
+/// A component of a value in one lane.
+typedef union scc_ir_word {
+  scc_float32_t f;
+  scc_int32_t i;
+  scc_uint32_t u;
+} scc_ir_word_t;
+
+/// Samples `texture`, bound to a slot, for each lane set in `mask`.
+///
+/// Coordinates and texels are laid out like every other value, i.e.
+/// `SCC_IR_LANES` words of the first component, then of the second, and so
+/// on. Four components of texels are expected. When gathering, `component` is
+/// the component of each of the 2x2 texels to gather, otherwise `SCC_IR_NONE`.
+///
+typedef void (*scc_ir_sample_fn)(void *user,
+                                 scc_uint32_t texture,
+                                 scc_uint32_t component,
+                                 const scc_ir_word_t *coordinates,
+                                 scc_uint32_t num_of_coordinates,
+                                 scc_uint32_t mask,
+                                 scc_ir_word_t *texels);
+
+/// What a program reads from and writes to.
+typedef struct scc_ir_bindings {
+  // Indexed by global.
+  //
+  // Inputs and outputs point to every invocation's value of each component in
+  // turn, i.e. the first component of every invocation, then the second, and
+  // so on. Members of structures follow one another.
+  //
+  // Constants point to their constant buffer, laid out as described by member
+  // offsets, or, for loose constants, the implicit constant buffer they share.
+  //
+  // Textures are ignored.
+  void **globals;
+
+  // Used to sample textures. If `NULL`, texels are zero.
+  scc_ir_sample_fn sample;
+  void *user;
+
+  // Set for each invocation that discards, if not `NULL`.
+  scc_bool_t *discarded;
+} scc_ir_bindings_t;
+
+typedef struct scc_ir_interpreter scc_ir_interpreter_t;
+
+/// Prepares to run functions of `module`.
+///
+/// \warning `module` must outlive the interpreter, unchanged.
+///
+extern SCC_PUBLIC
+  scc_ir_interpreter_t *scc_ir_interpreter_create(const scc_ir_module_t *module);
+
+extern SCC_PUBLIC
+  void scc_ir_interpreter_destroy(scc_ir_interpreter_t *interpreter);
+
+/// Compiles what can be of every supported function to native code, which is
+/// run in place of bytecode where possible, using those of `features` this
+/// host supports. Pass `scc_ir_jit_features()` for all of them. Returns false
+/// if native code can't be generated for this host, in which case everything
+/// is interpreted.
+///
+/// \warning Must not be called while running anything.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_interpreter_compile(scc_ir_interpreter_t *interpreter,
+                                        scc_uint32_t features);
+
+/// Determines if `function` can be run, i.e. it and everything it calls only
+/// uses what's supported.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_interpreter_supports(const scc_ir_interpreter_t *interpreter,
+                                         scc_uint32_t function);
+
+/// Runs `function`, which must not take arguments, for `count` invocations.
+/// Returns false, without running anything, if it's not supported.
+///
+/// Stores to constants write the value of one invocation, so functions like
+/// `scc_ir_module_t::precompute` should be run once, for one invocation,
+/// before the entry point.
+///
+/// Safe to call from several threads at once, provided they don't write to
+/// the same bindings.
+///
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_interpreter_run(const scc_ir_interpreter_t *interpreter,
+                                    scc_uint32_t function,
+                                    const scc_ir_bindings_t *bindings,
+                                    scc_uint32_t count);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_INTERPRETER_H_
@@ -0,0 +1,69 @@
+//===-- scc/ir/jit.h ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Compiles bytecode to native code on x86-64 hosts with AVX.
+///
+/// Runs of opcodes on floats, like `add.f32x4`, `dot.f32x3`, or `shuffle`, are
+/// compiled to functions that do what the run does for every lane of a frame
+/// at once, holding components in vector registers assigned by linear scan.
+/// Results are written through to their slots, so anything can read them.
+///
+/// Each compiled run is preceded by `native`, which calls its function and
+/// skips the run if every lane is running, and otherwise falls through to it.
+/// Batches that diverge, and whatever isn't compiled, are interpreted.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_JIT_H_
+#define _SCC_IR_JIT_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir/bytecode.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_jit scc_ir_jit_t;
+
+/// Extensions to AVX that native code can use.
+typedef enum scc_ir_jit_features {
+  // Fused multiply-add, used for `fma` rather than interpreting it.
+  SCC_IR_JIT_FEATURE_FMA = (1 << 0)
+} scc_ir_jit_features_t;
+
+/// Determines if native code can be generated for, and run on, this host.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_jit_is_available(void);
+
+/// Extensions supported by this host, as `scc_ir_jit_features_t`.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_jit_features(void);
+
+/// Compiles what it can of `bytecode`, rewriting it to call native code that
+/// uses no more of `features` than this host supports. Returns `NULL` if
+/// nothing was compiled, leaving `bytecode` untouched.
+///
+/// \warning Frames may grow, so nothing must be running `bytecode`.
+///
+extern SCC_PUBLIC
+  scc_ir_jit_t *scc_ir_jit_compile(scc_ir_bytecode_t *bytecode,
+                                   scc_uint32_t features);
+
+/// Releases native code. Bytecode that calls it must not be run afterwards.
+extern SCC_PUBLIC
+  void scc_ir_jit_destroy(scc_ir_jit_t *jit);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_JIT_H_
@@ -0,0 +1,90 @@
+//===-- scc/ir/layout.h ---------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Rules that constant buffers are laid out by.
+///
+/// Offsets are given explicitly, so these only say where values may be
+/// placed, and how much room they take once there. Matrices are laid out
+/// column by column, as backends declare them.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_LAYOUT_H_
+#define _SCC_IR_LAYOUT_H_
+
+#include "scc/foundation.h"
+#include "scc/target.h"
+
+#include "scc/ir.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef enum scc_ir_packing {
+  // Whatever the target being compiled to lays constant buffers out by. See
+  // `scc_ir_packing_of`.
+  SCC_IR_PACKING_TARGET = 0,
+
+  // Aligned to scalars, as the host reads them.
+  SCC_IR_PACKING_TIGHT  = 1,
+
+  // GLSL's `std140`, which Vulkan's uniform buffers follow too. Columns of
+  // matrices and structures are aligned to 16 bytes.
+  SCC_IR_PACKING_STD140 = 2,
+
+  // GLSL's `std430`, i.e. `std140` without rounding up to 16 bytes. Only
+  // SPIR-V can lay out constant buffers this way, given
+  // `VK_KHR_uniform_buffer_standard_layout`.
+  SCC_IR_PACKING_STD430 = 3,
+
+  // HLSL's `cbuffer`, where nothing that fits in a 16-byte register straddles
+  // two, and columns of matrices and structures start registers of their own.
+  SCC_IR_PACKING_HLSL   = 4,
+
+  // Metal's, with vectors of three components packed.
+  SCC_IR_PACKING_MSL    = 5
+} scc_ir_packing_t;
+
+/// Returns the rules `target` lays constant buffers out by.
+extern SCC_PUBLIC
+  scc_ir_packing_t scc_ir_packing_of(scc_target_t target);
+
+/// Bytes a value of `type` takes in a constant buffer. Structures take up to
+/// the end of their last member, by offset, rounded up to their alignment.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_layout_size(const scc_ir_module_t *module,
+                                  scc_ir_packing_t packing,
+                                  scc_ir_type_t type);
+
+/// Bytes a value of `type` is aligned to in a constant buffer.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_layout_alignment(const scc_ir_module_t *module,
+                                       scc_ir_packing_t packing,
+                                       scc_ir_type_t type);
+
+/// Bytes between columns of a matrix of `type`, or zero if not a matrix.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_layout_stride(scc_ir_packing_t packing,
+                                    scc_ir_type_t type);
+
+/// Returns the first offset, from `offset` on, that a value of `type` can be
+/// placed at.
+extern SCC_PUBLIC
+  scc_uint32_t scc_ir_layout_place(const scc_ir_module_t *module,
+                                   scc_ir_packing_t packing,
+                                   scc_ir_type_t type,
+                                   scc_uint32_t offset);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_LAYOUT_H_
@@ -0,0 +1,118 @@
+//===-- scc/ir/liveness.h -------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Values live on entry to and exit from each block of a function, and
+/// estimates of register pressure derived from them.
+///
+/// Values are densely indexed: instructions by index, followed by arguments.
+/// Operands of a `phi` are live on exit from the block they're paired with
+/// rather than on entry to the block of the `phi`.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_LIVENESS_H_
+#define _SCC_IR_LIVENESS_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/cfg.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_liveness {
+  scc_uint32_t num_of_blocks;
+
+  // Number of values that can be live, i.e. instructions plus arguments.
+  scc_uint32_t num_of_values;
+
+  // Size of each set in words.
+  scc_uint32_t num_of_words;
+
+  // Sets of values live on entry to and exit from each block, one after
+  // another. Empty for unreachable blocks.
+  scc_uint64_t *live_in;
+  scc_uint64_t *live_out;
+} scc_ir_liveness_t;
+
+/// Most values live at the same time. Each is maximized independently, so
+/// they may be reached at different points.
+typedef struct scc_ir_pressure {
+  scc_uint32_t values;
+
+  // Counting 32-bit components, as allocated by scalar targets.
+  scc_uint32_t components;
+
+  // Counting four-component registers, as allocated by vector targets. Each
+  // column of a matrix takes a register.
+  scc_uint32_t registers;
+} scc_ir_pressure_t;
+
+/// Computes liveness with a worklist, visiting blocks in post-order so that
+/// most are visited only once or twice.
+extern SCC_PUBLIC
+  scc_ir_liveness_t *scc_ir_liveness_compute(const scc_ir_function_t *function,
+                                             const scc_ir_cfg_t *cfg);
+
+extern SCC_PUBLIC
+  void scc_ir_liveness_destroy(scc_ir_liveness_t *liveness);
+
+/// Estimates peak register pressure of `function` by walking each block
+/// backwards from the values live on exit from it. Results of instructions
+/// are counted even if unused, since they're written somewhere.
+extern SCC_PUBLIC
+  void scc_ir_liveness_pressure(const scc_ir_function_t *function,
+                                const scc_ir_cfg_t *cfg,
+                                const scc_ir_liveness_t *liveness,
+                                scc_ir_pressure_t *pressure);
+
+/// Determines how many components and registers a value of `type` occupies,
+/// as counted by `scc_ir_pressure_t`.
+extern SCC_PUBLIC
+  void scc_ir_liveness_weigh(scc_ir_type_t type,
+                             scc_uint32_t *components,
+                             scc_uint32_t *registers);
+
+/// Index of `value` in sets, or `SCC_IR_NONE` if it's never live, like a
+/// constant.
+static SCC_INLINE scc_uint32_t scc_ir_liveness_index(const scc_ir_function_t *function,
+                                                     scc_ir_value_t value) {
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      return SCC_IR_VALUE_INDEX(value);
+    case SCC_IR_VALUE_ARGUMENT:
+      return function->num_of_instructions + SCC_IR_VALUE_INDEX(value);
+    default:
+      return SCC_IR_NONE;
+  }
+}
+
+static SCC_INLINE const scc_uint64_t *scc_ir_live_in(const scc_ir_liveness_t *liveness,
+                                                     scc_uint32_t block) {
+  return &liveness->live_in[block * liveness->num_of_words];
+}
+
+static SCC_INLINE const scc_uint64_t *scc_ir_live_out(const scc_ir_liveness_t *liveness,
+                                                      scc_uint32_t block) {
+  return &liveness->live_out[block * liveness->num_of_words];
+}
+
+static SCC_INLINE scc_bool_t scc_ir_liveness_contains(const scc_uint64_t *set,
+                                                      scc_uint32_t index) {
+  return (set[index / 64] >> (index % 64)) & 1;
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_LIVENESS_H_
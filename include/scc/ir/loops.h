@@ -0,0 +1,109 @@
+//===-- scc/ir/loops.h ----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Natural loops of a function and how they nest.
+///
+/// A loop is identified by its header, which dominates every block in the
+/// loop, and is entered through back edges from latches. Back edges sharing a
+/// header form a single loop. Retreating edges to blocks that don't dominate
+/// them, which only arise in irreducible control flow, don't form loops.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_LOOPS_H_
+#define _SCC_IR_LOOPS_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/cfg.h"
+#include "scc/ir/dominators.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_loop {
+  scc_uint32_t header;
+
+  // Sole predecessor of the header from outside the loop, if it has no other
+  // successor, otherwise `SCC_IR_NONE`. Code hoisted out of the loop goes
+  // here.
+  scc_uint32_t preheader;
+
+  // Innermost loop enclosing this one, or `SCC_IR_NONE` if outermost.
+  scc_uint32_t parent;
+
+  // Number of loops enclosing this one, plus one.
+  scc_uint32_t depth;
+
+  // Blocks in the loop, including those of nested loops, as a range of
+  // `scc_ir_loops_t::blocks`. Header is first, and the rest are in reverse
+  // post-order.
+  scc_uint32_t first_block;
+  scc_uint32_t num_of_blocks;
+
+  // Blocks with back edges to the header, as a range of
+  // `scc_ir_loops_t::latches`.
+  scc_uint32_t first_latch;
+  scc_uint32_t num_of_latches;
+} scc_ir_loop_t;
+
+typedef struct scc_ir_loops {
+  scc_uint32_t num_of_blocks;
+
+  // Ordered by header in reverse post-order, so loops come before those
+  // nested in them.
+  scc_ir_loop_t *loops;
+  scc_uint32_t num_of_loops;
+
+  scc_uint32_t *blocks;
+  scc_uint32_t *latches;
+
+  // Innermost loop containing each block, or `SCC_IR_NONE`.
+  scc_uint32_t *innermost;
+} scc_ir_loops_t;
+
+extern SCC_PUBLIC
+  scc_ir_loops_t *scc_ir_loops_compute(const scc_ir_function_t *function,
+                                       const scc_ir_cfg_t *cfg,
+                                       const scc_ir_dominators_t *dominators);
+
+extern SCC_PUBLIC
+  void scc_ir_loops_destroy(scc_ir_loops_t *loops);
+
+/// Returns true if `block` is in `loop` or one nested in it.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_loop_contains(const scc_ir_loops_t *loops,
+                                  scc_uint32_t loop,
+                                  scc_uint32_t block);
+
+/// Returns number of loops containing `block`.
+static SCC_INLINE scc_uint32_t scc_ir_loop_depth(const scc_ir_loops_t *loops,
+                                                 scc_uint32_t block) {
+  const scc_uint32_t loop = loops->innermost[block];
+  return (loop != SCC_IR_NONE) ? loops->loops[loop].depth : 0;
+}
+
+static SCC_INLINE const scc_uint32_t *scc_ir_loop_blocks(const scc_ir_loops_t *loops,
+                                                         scc_uint32_t loop) {
+  return &loops->blocks[loops->loops[loop].first_block];
+}
+
+static SCC_INLINE const scc_uint32_t *scc_ir_loop_latches(const scc_ir_loops_t *loops,
+                                                          scc_uint32_t loop) {
+  return &loops->latches[loops->loops[loop].first_latch];
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_LOOPS_H_
@@ -23,6 +23,8 @@
 
 #include "scc/feed.h"
 
+#include "scc/ir.h"
+
 SCC_BEGIN_EXTERN_C
 
 typedef struct scc_ir_parse_options {
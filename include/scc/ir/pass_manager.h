@@ -0,0 +1,289 @@
+//===-- scc/ir/pass_manager.h ---------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Runs passes over a module, caching analyses between them.
+///
+/// Analyses are computed on demand and cached per function. A cached analysis
+/// is discarded only when a pass reports that it changed a function, and then
+/// only if the pass doesn't preserve it.
+///
+/// Consecutive function passes are run as a stage: each function is taken
+/// through every pass in the stage by one thread, and functions are spread
+/// over threads. Since a function pass only ever sees its function, output
+/// doesn't depend on the number of threads or how work happened to be
+/// distributed. Statistics are gathered per function and merged in order.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_PASS_MANAGER_H_
+#define _SCC_IR_PASS_MANAGER_H_
+
+#include "scc/foundation.h"
+#include "scc/target.h"
+
+#include "scc/ir.h"
+#include "scc/ir/cfg.h"
+#include "scc/ir/demanded.h"
+#include "scc/ir/dominators.h"
+#include "scc/ir/layout.h"
+#include "scc/ir/liveness.h"
+#include "scc/ir/loops.h"
+#include "scc/ir/uniformity.h"
+#include "scc/ir/uses.h"
+
+#include <stdio.h>
+
+SCC_BEGIN_EXTERN_C
+
+typedef enum scc_ir_analysis {
+  SCC_IR_ANALYSIS_CFG             = 0,
+  SCC_IR_ANALYSIS_DOMINATORS      = 1,
+  SCC_IR_ANALYSIS_POST_DOMINATORS = 2,
+  SCC_IR_ANALYSIS_LOOPS           = 3,
+  SCC_IR_ANALYSIS_USES            = 4,
+  SCC_IR_ANALYSIS_LIVENESS        = 5,
+  SCC_IR_ANALYSIS_UNIFORMITY      = 6,
+  SCC_IR_ANALYSIS_DEMANDED        = 7,
+
+  SCC_IR_NUM_OF_ANALYSES
+} scc_ir_analysis_t;
+
+/// Set of analyses, one bit per `scc_ir_analysis_t`.
+typedef scc_uint32_t scc_ir_analyses_t;
+
+#define SCC_IR_PRESERVES(Analysis) \
+  ((scc_ir_analyses_t)(1u << (Analysis)))
+
+#define SCC_IR_PRESERVES_NOTHING \
+  ((scc_ir_analyses_t)0)
+
+#define SCC_IR_PRESERVES_EVERYTHING \
+  ((scc_ir_analyses_t)((1u << SCC_IR_NUM_OF_ANALYSES) - 1))
+
+/// Analyses that only depend on the shape of the control-flow graph, and are
+/// thus preserved by passes that don't add, remove, or retarget branches.
+#define SCC_IR_PRESERVES_CONTROL_FLOW \
+  (SCC_IR_PRESERVES(SCC_IR_ANALYSIS_CFG) | \
+   SCC_IR_PRESERVES(SCC_IR_ANALYSIS_DOMINATORS) | \
+   SCC_IR_PRESERVES(SCC_IR_ANALYSIS_POST_DOMINATORS) | \
+   SCC_IR_PRESERVES(SCC_IR_ANALYSIS_LOOPS))
+
+/// Knobs that the pass manager and passes consult.
+typedef struct scc_ir_pass_options {
+  // What the module is being compiled to, for passes that tailor code to it.
+  scc_target_t target;
+
+  // Number of threads to run function passes on. Zero means one per core, and
+  // one runs everything on the calling thread.
+  scc_uint32_t threads;
+
+  // Permits transformations that may change results slightly, like dividing
+  // by multiplying with a reciprocal, in exchange for faster code.
+  scc_bool_t fast_math;
+
+  // Largest cost of inlining a call, roughly in instructions, at which it is
+  // still inlined. Zero means a default suited to targets that penalize calls.
+  scc_uint32_t inline_threshold;
+
+  // Most four-component registers that scheduling may keep live at once,
+  // unless a block already needed more. Zero means a default that keeps
+  // typical targets at full occupancy.
+  scc_uint32_t register_budget;
+
+  // Rules that `SCC_IR_LAYOUT_PASS` lays constant buffers out by. Zero means
+  // those of `target`.
+  scc_ir_packing_t packing;
+} scc_ir_pass_options_t;
+
+/// State private to each thread running passes.
+typedef struct scc_ir_pass_thread {
+  scc_arena_t *scratch;
+
+  // Number of times each analysis was computed and time spent doing so.
+  scc_uint64_t computations[SCC_IR_NUM_OF_ANALYSES];
+  scc_uint64_t computation_time[SCC_IR_NUM_OF_ANALYSES];
+} scc_ir_pass_thread_t;
+
+typedef struct scc_ir_pass_context {
+  struct scc_ir_pass_manager *manager;
+
+  scc_ir_module_t *module;
+
+  const scc_ir_pass_options_t *options;
+
+  // Memory for use during a single run of a pass. Everything allocated from
+  // it is released once the pass returns, so it need not be freed.
+  scc_allocator_t *scratch;
+
+  scc_ir_pass_thread_t *thread;
+} scc_ir_pass_context_t;
+
+typedef enum scc_ir_pass_kind {
+  // Runs on each function independently, possibly concurrently with other
+  // functions. Must only modify the function it's given, and must not modify
+  // the module, which rules out naming anything it adds.
+  SCC_IR_FUNCTION_PASS = 1,
+
+  // Runs on the module as a whole.
+  SCC_IR_MODULE_PASS   = 2
+} scc_ir_pass_kind_t;
+
+/// Returns true if `function` was changed.
+typedef scc_bool_t (*scc_ir_function_pass_fn)(scc_ir_pass_context_t *context,
+                                              scc_ir_function_t *function);
+
+/// Returns true if `module` was changed.
+typedef scc_bool_t (*scc_ir_module_pass_fn)(scc_ir_pass_context_t *context,
+                                            scc_ir_module_t *module);
+
+typedef struct scc_ir_pass {
+  const char *name;
+
+  scc_ir_pass_kind_t kind;
+
+  // Analyses that remain valid even when the pass reports a change.
+  scc_ir_analyses_t preserves;
+
+  scc_ir_function_pass_fn run_on_function;
+  scc_ir_module_pass_fn run_on_module;
+} scc_ir_pass_t;
+
+typedef struct scc_ir_pass_statistics {
+  const char *name;
+
+  // Number of times run, on a function or the module.
+  scc_uint64_t runs;
+
+  // Number of runs that changed something.
+  scc_uint64_t changes;
+
+  // Time spent in nanoseconds summed over runs, including computing analyses
+  // on demand. Exceeds wall time when function passes run concurrently.
+  scc_uint64_t time;
+} scc_ir_pass_statistics_t;
+
+typedef struct scc_ir_analysis_cache {
+  // Set of analyses that are cached and up to date.
+  scc_ir_analyses_t valid;
+
+  void *results[SCC_IR_NUM_OF_ANALYSES];
+} scc_ir_analysis_cache_t;
+
+typedef struct scc_ir_pass_manager {
+  scc_ir_pass_options_t options;
+
+  // Pipeline, in order.
+  const scc_ir_pass_t **passes;
+  scc_uint32_t num_of_passes;
+  scc_uint32_t size_of_passes;
+
+  // Indexed like `passes`.
+  scc_ir_pass_statistics_t *statistics;
+
+  // Number of times each analysis was computed and time spent doing so.
+  scc_uint64_t computations[SCC_IR_NUM_OF_ANALYSES];
+  scc_uint64_t computation_time[SCC_IR_NUM_OF_ANALYSES];
+
+  // Null when running on the calling thread alone.
+  scc_job_system_t *jobs;
+
+  // Indexed by thread, as numbered by `jobs`.
+  scc_ir_pass_thread_t *threads;
+  scc_uint32_t num_of_threads;
+
+  // Module that `caches` refer to.
+  scc_ir_module_t *module;
+
+  // Indexed by function.
+  scc_ir_analysis_cache_t *caches;
+  scc_uint32_t num_of_caches;
+} scc_ir_pass_manager_t;
+
+extern SCC_PUBLIC
+  scc_ir_pass_manager_t *scc_ir_pass_manager_create(const scc_ir_pass_options_t *options);
+
+extern SCC_PUBLIC
+  void scc_ir_pass_manager_destroy(scc_ir_pass_manager_t *manager);
+
+/// Appends `pass` to the pipeline.
+extern SCC_PUBLIC
+  void scc_ir_pass_manager_add(scc_ir_pass_manager_t *manager,
+                               const scc_ir_pass_t *pass);
+
+/// Runs the pipeline over `module`, returning true if anything changed.
+extern SCC_PUBLIC
+  scc_bool_t scc_ir_pass_manager_run(scc_ir_pass_manager_t *manager,
+                                     scc_ir_module_t *module);
+
+/// Prints statistics about passes and analyses to `stream`.
+extern SCC_PUBLIC
+  void scc_ir_pass_manager_report(const scc_ir_pass_manager_t *manager,
+                                  FILE *stream);
+
+/// Returns analysis of `function`, computing it if not cached.
+extern SCC_PUBLIC
+  const void *scc_ir_analysis(scc_ir_pass_context_t *context,
+                              scc_ir_function_t *function,
+                              scc_ir_analysis_t analysis);
+
+/// Discards analyses of `function` not in `preserved`. Passes call this when
+/// they need a fresh analysis after changing a function part way through.
+extern SCC_PUBLIC
+  void scc_ir_invalidate(scc_ir_pass_context_t *context,
+                         scc_ir_function_t *function,
+                         scc_ir_analyses_t preserved);
+
+static SCC_INLINE const scc_ir_cfg_t *scc_ir_get_cfg(scc_ir_pass_context_t *context,
+                                                     scc_ir_function_t *function) {
+  return (const scc_ir_cfg_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_CFG);
+}
+
+static SCC_INLINE const scc_ir_dominators_t *scc_ir_get_dominators(scc_ir_pass_context_t *context,
+                                                                   scc_ir_function_t *function) {
+  return (const scc_ir_dominators_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_DOMINATORS);
+}
+
+static SCC_INLINE const scc_ir_dominators_t *scc_ir_get_post_dominators(scc_ir_pass_context_t *context,
+                                                                        scc_ir_function_t *function) {
+  return (const scc_ir_dominators_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_POST_DOMINATORS);
+}
+
+static SCC_INLINE const scc_ir_loops_t *scc_ir_get_loops(scc_ir_pass_context_t *context,
+                                                         scc_ir_function_t *function) {
+  return (const scc_ir_loops_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_LOOPS);
+}
+
+static SCC_INLINE const scc_ir_uses_t *scc_ir_get_uses(scc_ir_pass_context_t *context,
+                                                       scc_ir_function_t *function) {
+  return (const scc_ir_uses_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_USES);
+}
+
+static SCC_INLINE const scc_ir_liveness_t *scc_ir_get_liveness(scc_ir_pass_context_t *context,
+                                                               scc_ir_function_t *function) {
+  return (const scc_ir_liveness_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_LIVENESS);
+}
+
+static SCC_INLINE const scc_ir_uniformity_t *scc_ir_get_uniformity(scc_ir_pass_context_t *context,
+                                                                   scc_ir_function_t *function) {
+  return (const scc_ir_uniformity_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_UNIFORMITY);
+}
+
+static SCC_INLINE const scc_ir_demanded_t *scc_ir_get_demanded(scc_ir_pass_context_t *context,
+                                                               scc_ir_function_t *function) {
+  return (const scc_ir_demanded_t *)scc_ir_analysis(context, function, SCC_IR_ANALYSIS_DEMANDED);
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_PASS_MANAGER_H_
@@ -0,0 +1,188 @@
+//===-- scc/ir/passes.h ---------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Transformations, for use with `scc_ir_pass_manager_t`.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_PASSES_H_
+#define _SCC_IR_PASSES_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/pass_manager.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Sparse conditional constant propagation.
+///
+/// Evaluates instructions with constant operands, propagates the results, and
+/// folds branches on constant conditions. Blocks that become unreachable are
+/// removed, and incoming values from them are dropped from phis.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_SCCP_PASS;
+
+/// Squashes swizzles.
+///
+/// Chains of swizzles are composed into one, identity swizzles are removed,
+/// and swizzles of constants are done at compile time. A swizzle of the sole
+/// use of a component-wise operation is pushed through to its inputs, when
+/// doing so doesn't add instructions, narrowing the operation as a result.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_SWIZZLE_PASS;
+
+/// Dead code elimination.
+///
+/// Keeps terminators and anything with effects, like stores, discards, and
+/// calls of functions that have effects, along with whatever they depend on.
+/// Everything else is removed, as are unreachable blocks, functions that can't
+/// be called from the entry point, unused constants, and any inputs, constants,
+/// or textures that are no longer referenced.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_DCE_PASS;
+
+/// Global value numbering.
+///
+/// Finds computations that are equivalent to one done in a dominating block,
+/// or earlier in the same block, and reuses the result instead. Operands of
+/// commutative operations are put in a canonical order first, so `add %a, %b`
+/// and `add %b, %a` are recognized as the same. Loads of anything but outputs,
+/// which can be stored to, are numbered as well.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_GVN_PASS;
+
+/// Strength reduction.
+///
+/// Replaces expensive operations with cheaper equivalents, like `pow %x, 2`
+/// with `mul %x, %x`. Reductions that may change results slightly, like
+/// multiplying by a reciprocal rather than dividing, are only done if
+/// `scc_ir_pass_options_t::fast_math` is set.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_STRENGTH_REDUCTION_PASS;
+
+/// Inlines calls.
+///
+/// Works bottom up over the call graph, so that callees are as small as they
+/// will get before being considered. A call is inlined if the callee is only
+/// called once, or if its size is within `scc_ir_pass_options_t::inline_threshold`
+/// after crediting what is saved by not calling, with extra credit for each
+/// constant argument. Recursive calls are never inlined. Callees that are no
+/// longer called are left for `SCC_IR_DCE_PASS` to remove.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_INLINE_PASS;
+
+/// Schedules instructions within each block.
+///
+/// A list scheduler that orders instructions by the longest latency-weighted
+/// path from each to the end of its block, so long-latency `fetch` and
+/// `gather` are hoisted as early as their operands allow while their uses
+/// sink until results are likely available. Candidates that would keep more
+/// registers live than `scc_ir_pass_options_t::register_budget`, or than the
+/// original order did if that's more, are deferred. Effects keep their order.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_SCHEDULE_PASS;
+
+/// \brief Selects target-specific instructions.
+///
+/// Rewrites small trees of instructions into single instructions that
+/// `scc_ir_pass_options_t::target` has a direct equivalent for, like
+/// `add (mul %a, %b), %c` into `fma %a, %b, %c` or `min (max %x, 0), 1` into
+/// `sat %x`. Patterns are listed per target. Subsumed instructions must have
+/// no other use. Fusing into `fma` is only done if
+/// `scc_ir_pass_options_t::fast_math` is set, as it rounds differently.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_SELECT_PASS;
+
+/// \brief Hoists loop-invariant code.
+///
+/// Moves computations whose operands are all defined outside a loop into its
+/// preheader, innermost loops first so they can continue outward. Loads of
+/// anything but outputs and samples of textures are hoisted too. Loops
+/// without a preheader are left alone.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_LICM_PASS;
+
+/// \brief Hoists computations on constants out of the shader.
+///
+/// Computations in the entry point that depend only on constants, like
+/// multiplying matrices from `@frame`, are the same for every invocation. They
+/// are moved into `scc_ir_module_t::precompute`, which stores each result to a
+/// new loose constant that the entry point loads instead. Those are placed
+/// after every other loose constant, and named after the first constant read
+/// and the operation that yields them, like `scale.add`. Only computations of
+/// at least two operations, or one on matrices, are moved.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_HOIST_UNIFORMS_PASS;
+
+/// \brief Splits vector operations into scalar operations.
+///
+/// Component-wise operations and swizzles on vectors wider than the
+/// `scc_target_info_t::vector_width` of `scc_ir_pass_options_t::target` are
+/// split into an operation per component, composed back into a vector for
+/// anything that still wants one. Components are traced through compositions
+/// and swizzles, so components that nothing uses are left for
+/// `SCC_IR_DCE_PASS` to remove.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_SCALARIZE_PASS;
+
+/// \brief Packs scalar operations into vector operations.
+///
+/// Compositions of the same component-wise operation on scalars, like those
+/// `SCC_IR_SCALARIZE_PASS` leaves, are replaced by that operation on vectors
+/// if the target operates on vectors that wide, working back through their
+/// operands. Scalars only used by the composition in the same block are
+/// packed, so work is never duplicated.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_VECTORIZE_PASS;
+
+/// \brief Narrows vector operations to the components demanded of them.
+///
+/// Component-wise operations, swizzles, and compositions whose trailing
+/// components aren't demanded are narrowed in place, per `scc_ir_demanded_t`.
+/// Operands and uses are reconciled with swizzles, which are left for
+/// `SCC_IR_SWIZZLE_PASS` to squash. Anything feeding a `phi` is left as is.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_SHRINK_PASS;
+
+/// \brief Drops what isn't demanded of inputs, constants, and outputs.
+///
+/// Members of input and constant structures that nothing loads are removed,
+/// and vectors that are only partially demanded, be they members or globals
+/// of their own, are narrowed to the components that are. Offsets are kept,
+/// so constant buffers keep their layout. Outputs are narrowed to the
+/// components in `scc_ir_global_t::consumed`, unless bound to a builtin or
+/// read back. Structures that are loaded whole, or are outputs, are kept.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_PRUNE_INTERFACE_PASS;
+
+/// \brief Lays out constant buffers anew, to take as little room as possible.
+///
+/// Members of constant buffers, and loose constants, are placed by the rules
+/// of `scc_ir_pass_options_t::packing`, most strictly aligned then largest
+/// first, each at the first offset it fits at, so smaller ones fill the gaps
+/// larger ones leave. They're then renumbered in order of offset, as some
+/// targets declare them. Structures referenced other than by loads of their
+/// members, like those loaded whole, nested in others, or used by inputs or
+/// outputs, keep their layout.
+///
+/// Offsets given are discarded, so this is only of use if whatever fills
+/// constant buffers finds out where things are by reflection. See
+/// `scc/backend/reflection.h`.
+///
+extern SCC_PUBLIC const scc_ir_pass_t SCC_IR_LAYOUT_PASS;
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_PASSES_H_
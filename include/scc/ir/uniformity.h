@@ -0,0 +1,70 @@
+//===-- scc/ir/uniformity.h -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Classification of values as uniform, i.e. the same for every
+/// invocation of a draw or dispatch, or varying.
+///
+/// Constants are uniform, and so is anything computed from uniform values
+/// alone, including loads of constants and samples at uniform coordinates.
+/// Inputs, outputs, and arguments vary. Calls are assumed to vary. Once any
+/// branch depends on a varying value, invocations may take different paths,
+/// so every `phi` varies too.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_UNIFORMITY_H_
+#define _SCC_IR_UNIFORMITY_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+#include "scc/ir/uses.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_uniformity {
+  scc_uint32_t num_of_instructions;
+
+  // Indicates if the result of each instruction varies.
+  scc_bool_t *varying;
+
+  // Indicates if any branch depends on a varying value.
+  scc_bool_t divergent;
+} scc_ir_uniformity_t;
+
+extern SCC_PUBLIC
+  scc_ir_uniformity_t *scc_ir_uniformity_compute(const scc_ir_function_t *function,
+                                                 const scc_ir_uses_t *uses);
+
+extern SCC_PUBLIC
+  void scc_ir_uniformity_destroy(scc_ir_uniformity_t *uniformity);
+
+/// Returns true if `value` is known to be the same for every invocation.
+/// Instructions added since `uniformity` was computed are assumed to vary.
+static SCC_INLINE scc_bool_t scc_ir_is_uniform(const scc_ir_uniformity_t *uniformity,
+                                               scc_ir_value_t value) {
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      return (SCC_IR_VALUE_INDEX(value) < uniformity->num_of_instructions)
+          && !uniformity->varying[SCC_IR_VALUE_INDEX(value)];
+    case SCC_IR_VALUE_ARGUMENT:
+      return SCC_FALSE;
+    default:
+      return SCC_TRUE;
+  }
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_UNIFORMITY_H_
@@ -0,0 +1,69 @@
+//===-- scc/ir/uses.h -----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Use counts and users of each value in a function.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_IR_USES_H_
+#define _SCC_IR_USES_H_
+
+#include "scc/foundation.h"
+
+#include "scc/ir.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_uses {
+  scc_uint32_t num_of_instructions;
+  scc_uint32_t num_of_arguments;
+
+  // Number of times each instruction's result is used by live instructions.
+  scc_uint32_t *counts;
+
+  // Number of times each argument is used by live instructions.
+  scc_uint32_t *arguments;
+
+  // Users of each instruction's result, compressed like `scc_ir_cfg_t`. An
+  // instruction that uses a value more than once is listed more than once.
+  scc_uint32_t *users;
+  scc_uint32_t *first_user;
+} scc_ir_uses_t;
+
+extern SCC_PUBLIC
+  scc_ir_uses_t *scc_ir_uses_compute(const scc_ir_function_t *function);
+
+extern SCC_PUBLIC
+  void scc_ir_uses_destroy(scc_ir_uses_t *uses);
+
+static SCC_INLINE scc_uint32_t scc_ir_num_of_uses(const scc_ir_uses_t *uses,
+                                                  scc_ir_value_t value) {
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      return uses->counts[SCC_IR_VALUE_INDEX(value)];
+    case SCC_IR_VALUE_ARGUMENT:
+      return uses->arguments[SCC_IR_VALUE_INDEX(value)];
+    default:
+      return 0;
+  }
+}
+
+static SCC_INLINE const scc_uint32_t *scc_ir_users(const scc_ir_uses_t *uses,
+                                                   scc_uint32_t instruction) {
+  return &uses->users[uses->first_user[instruction]];
+}
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_IR_USES_H_
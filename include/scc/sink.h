@@ -0,0 +1,53 @@
+//===-- scc/sink.h --------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Where output goes. The counterpart of `scc_feed_t`.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_SINK_H_
+#define _SCC_SINK_H_
+
+#include "scc/foundation.h"
+
+#include <stdio.h>
+
+SCC_BEGIN_EXTERN_C
+
+/// Writes `count` bytes. Returns the number written, which is less than
+/// `count` only on error.
+typedef scc_size_t (*scc_sink_write_fn)(struct scc_sink *sink,
+                                        const char *buffer,
+                                        scc_size_t count);
+
+typedef void (*scc_sink_close_fn)(struct scc_sink *sink);
+
+typedef struct scc_sink {
+  scc_sink_write_fn write;
+  scc_sink_close_fn close;
+} scc_sink_t;
+
+extern SCC_PUBLIC
+  scc_sink_t *scc_sink_to_path(const char *path);
+
+/// Writes to `file`, which is left open when the sink is closed.
+extern SCC_PUBLIC
+  scc_sink_t *scc_sink_to_file(FILE *file);
+
+extern SCC_PUBLIC
+  void scc_sink_close(scc_sink_t *sink);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_SINK_H_
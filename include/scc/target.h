@@ -0,0 +1,53 @@
+//===-- scc/target.h ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief What shaders are compiled to.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_TARGET_H_
+#define _SCC_TARGET_H_
+
+#include "scc/foundation.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef enum scc_target {
+  // Run on the host, by interpreting or compiling to machine code.
+  SCC_TARGET_HOST  = 0,
+
+  SCC_TARGET_GLSL  = 1,
+  SCC_TARGET_HLSL  = 2,
+  SCC_TARGET_SPIRV = 3,
+  SCC_TARGET_MSL   = 4,
+
+  SCC_NUM_OF_TARGETS
+} scc_target_t;
+
+typedef struct scc_target_info {
+  const char *name;
+
+  // Number of components the target operates on at once. Targets that
+  // operate on one at a time, like the host running invocations across SIMD
+  // lanes, prefer scalars, while the rest prefer vectors up to this width.
+  scc_uint32_t vector_width;
+} scc_target_info_t;
+
+/// Describes each target; indexed by `scc_target_t`.
+extern SCC_PUBLIC
+  const scc_target_info_t SCC_TARGETS[SCC_NUM_OF_TARGETS];
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_TARGET_H_
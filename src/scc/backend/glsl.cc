@@ -0,0 +1,390 @@
+//===-- scc/backend/glsl.cc -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/backend/glsl.h"
+#include "scc/backend/text.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_glsl_options_t SCC_GLSL_DEFAULT_OPTIONS = {
+  450
+};
+
+// Identifiers that can't be used as is, being keywords, reserved, or names of
+// built-in functions that would be hidden.
+static const char *const SCC_GLSL_RESERVED[] = {
+  "abs", "acos", "active", "all", "any", "asin", "asm", "atan", "atomic_uint",
+  "attribute", "bool", "break", "buffer", "bvec2", "bvec3", "bvec4", "case",
+  "cast", "ceil", "centroid", "clamp", "class", "coherent", "common", "const",
+  "continue", "cos", "cosh", "cross", "default", "degrees", "determinant",
+  "discard", "distance", "dmat2", "dmat2x2", "dmat2x3", "dmat2x4", "dmat3",
+  "dmat3x2", "dmat3x3", "dmat3x4", "dmat4", "dmat4x2", "dmat4x3", "dmat4x4",
+  "do", "dot", "double", "dvec2", "dvec3", "dvec4", "else", "enum", "equal",
+  "exp", "exp2", "extern", "external", "false", "filter", "fixed", "flat",
+  "float", "floor", "fma", "for", "fract", "fvec2", "fvec3", "fvec4", "goto",
+  "greaterThan", "greaterThanEqual", "half", "highp", "hvec2", "hvec3",
+  "hvec4", "i64vec2", "i64vec3", "i64vec4", "if", "in", "inline", "inout",
+  "input", "int", "int64_t", "interface", "invariant", "inverse",
+  "inversesqrt", "isampler1D", "isampler2D", "isampler3D", "isinf", "isnan",
+  "ivec2", "ivec3", "ivec4", "layout", "length", "lessThan", "lessThanEqual",
+  "log", "log2", "long", "lowp", "main", "mat2", "mat2x2", "mat2x3", "mat2x4",
+  "mat3", "mat3x2", "mat3x3", "mat3x4", "mat4", "mat4x2", "mat4x3", "mat4x4",
+  "max", "mediump", "min", "mix", "mod", "namespace", "noinline",
+  "noperspective", "normalize", "not", "notEqual", "out", "output",
+  "packDouble2x32", "partition", "patch", "pow", "precise", "precision",
+  "public", "radians", "readonly", "reflect", "refract", "resource",
+  "restrict", "return", "round", "sample", "sampler1D", "sampler2D",
+  "sampler3D", "samplerCube", "shared", "short", "sign", "sin", "sinh",
+  "sizeof", "smooth", "sqrt", "static", "step", "struct", "subroutine",
+  "superp", "switch", "tan", "tanh", "template", "texture", "textureGather",
+  "this", "transpose", "true", "trunc", "typedef", "u64vec2", "u64vec3",
+  "u64vec4", "uint", "uint64_t", "uintBitsToFloat", "uniform", "union",
+  "unsigned", "usampler1D", "usampler2D", "usampler3D", "using", "uvec2",
+  "uvec3", "uvec4", "varying", "vec2", "vec3", "vec4", "void", "volatile",
+  "while", "writeonly"
+};
+
+static const char *const SCC_GLSL_COMPARISONS[] = {
+  "lessThan", "lessThanEqual", "equal", "notEqual", "greaterThan", "greaterThanEqual"
+};
+
+static scc_bool_t scc_glsl_expression(scc_text_emitter_t *emitter,
+                                      const scc_ir_instruction_t *instruction) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_FETCH:
+      scc_text_write(emitter, "texture(");
+      scc_text_name(emitter, emitter->globals[SCC_IR_VALUE_INDEX(operands[0])]);
+      scc_text_write(emitter, ", ");
+      scc_text_value(emitter, operands[1], scc_ir_type(SCC_IR_F32, 2, 1));
+      scc_writer_put(emitter->writer, ')');
+      scc_text_narrow(emitter, instruction->type.rows);
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_GATHER:
+      scc_text_write(emitter, "textureGather(");
+      scc_text_name(emitter, emitter->globals[SCC_IR_VALUE_INDEX(operands[0])]);
+      scc_text_write(emitter, ", ");
+      scc_text_value(emitter, operands[1], scc_ir_type(SCC_IR_F32, 2, 1));
+      scc_text_write(emitter, ", int(");
+      scc_text_value(emitter, operands[2], scc_ir_type(SCC_IR_U32, 1, 1));
+      scc_text_write(emitter, "))");
+      scc_text_narrow(emitter, instruction->type.rows);
+      return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+static void scc_glsl_preamble(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  scc_text_write(emitter, "#version ");
+  scc_writer_unsigned(emitter->writer, ((const scc_glsl_options_t *)emitter->options)->version);
+  scc_text_write(emitter, "\n");
+
+  scc_bool_t wide = SCC_FALSE;
+
+  for (scc_uint32_t member = 0; member < module->num_of_members; ++member)
+    wide |= scc_text_is_wide(module->members[member].type);
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+    wide |= scc_text_is_wide(module->globals[global].type);
+
+  for (scc_uint32_t position = 0; position < emitter->num_of_functions; ++position) {
+    const scc_ir_function_t *function = module->functions[emitter->order[position]];
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+      wide |= scc_text_is_wide(function->instructions[i].type);
+  }
+
+  if (wide)
+    scc_text_write(emitter, "#extension GL_ARB_gpu_shader_int64 : require\n");
+
+  scc_text_write(emitter, "\n");
+}
+
+// Declares an input or output at `location`.
+static void scc_glsl_varying(scc_text_emitter_t *emitter,
+                             scc_ir_storage_t storage,
+                             scc_uint32_t location,
+                             scc_ir_type_t type,
+                             scc_text_name_t name) {
+  if (location != SCC_IR_NONE) {
+    scc_text_write(emitter, "layout(location = ");
+    scc_writer_unsigned(emitter->writer, location);
+    scc_text_write(emitter, ") ");
+  }
+
+  if (scc_text_is_flat(emitter, storage, type))
+    scc_text_write(emitter, "flat ");
+
+  scc_text_write(emitter, (storage == SCC_IR_INPUT) ? "in " : "out ");
+  scc_text_type(emitter, type);
+  scc_writer_put(emitter->writer, ' ');
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, ";\n");
+}
+
+// Declares a member of a uniform block at `offset`.
+static void scc_glsl_uniform(scc_text_emitter_t *emitter,
+                             scc_uint32_t offset,
+                             scc_ir_type_t type,
+                             scc_text_name_t name) {
+  scc_text_write(emitter, "  layout(offset = ");
+  scc_writer_unsigned(emitter->writer, offset);
+  scc_text_write(emitter, ") ");
+  scc_text_type(emitter, type);
+  scc_writer_put(emitter->writer, ' ');
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, ";\n");
+}
+
+static void scc_glsl_declarations(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  // Inputs and outputs.
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if ((global->storage != SCC_IR_INPUT) && (global->storage != SCC_IR_OUTPUT))
+      continue;
+
+    if (global->builtin != SCC_IR_BUILTIN_NONE)
+      continue;
+
+    if (emitter->first_field[index] == SCC_IR_NONE) {
+      scc_glsl_varying(emitter, global->storage, global->binding, global->type, emitter->globals[index]);
+      continue;
+    }
+
+    // Members take consecutive locations, a column each.
+    const scc_ir_structure_t *structure = &module->structures[global->type.structure];
+
+    scc_uint32_t location = global->binding;
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      const scc_ir_type_t type = module->members[structure->first_member + member].type;
+
+      scc_glsl_varying(emitter, global->storage, location, type, emitter->fields[emitter->first_field[index] + member]);
+
+      if (location != SCC_IR_NONE)
+        location += SCC_MAX((scc_uint32_t)type.columns, 1u);
+    }
+  }
+
+  scc_text_write(emitter, "\n");
+
+  // Constant buffers, then loose constants in a buffer of their own, bound to
+  // the first slot not otherwise taken.
+  scc_uint32_t slot = 0;
+  scc_bool_t loose = SCC_FALSE;
+
+  for (scc_bool_t taken = SCC_TRUE; taken; ) {
+    taken = SCC_FALSE;
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar == SCC_IR_STRUCTURE) && (global->binding == slot)) {
+        slot += 1;
+        taken = SCC_TRUE;
+      }
+    }
+  }
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if (global->storage != SCC_IR_CONSTANT)
+      continue;
+
+    if (global->type.scalar != SCC_IR_STRUCTURE) {
+      loose = SCC_TRUE;
+      continue;
+    }
+
+    const scc_ir_structure_t *structure = &module->structures[global->type.structure];
+
+    scc_text_write(emitter, "layout(std140, binding = ");
+    scc_writer_unsigned(emitter->writer, global->binding);
+    scc_text_write(emitter, ") uniform _B");
+    scc_text_name(emitter, emitter->globals[index]);
+    scc_text_write(emitter, " {\n");
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      const scc_ir_member_t *def = &module->members[structure->first_member + member];
+      scc_glsl_uniform(emitter, def->offset, def->type, emitter->members[structure->first_member + member]);
+    }
+
+    scc_text_write(emitter, "} ");
+    scc_text_name(emitter, emitter->globals[index]);
+    scc_text_write(emitter, ";\n\n");
+  }
+
+  if (loose) {
+    scc_text_write(emitter, "layout(std140, binding = ");
+    scc_writer_unsigned(emitter->writer, slot);
+    scc_text_write(emitter, ") uniform _constants {\n");
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar != SCC_IR_STRUCTURE))
+        scc_glsl_uniform(emitter, global->offset, global->type, emitter->globals[index]);
+    }
+
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  // Textures.
+  scc_bool_t textures = SCC_FALSE;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if (global->storage != SCC_IR_TEXTURE)
+      continue;
+
+    scc_text_write(emitter, "layout(binding = ");
+    scc_writer_unsigned(emitter->writer, global->binding);
+    scc_text_write(emitter, ") uniform ");
+
+    if (scc_ir_type_is_signed(global->type))
+      scc_writer_put(emitter->writer, 'i');
+    else if (scc_ir_type_is_unsigned(global->type))
+      scc_writer_put(emitter->writer, 'u');
+
+    scc_text_write(emitter, "sampler");
+    scc_writer_unsigned(emitter->writer, emitter->dimensions[index]);
+    scc_text_write(emitter, "D ");
+    scc_text_name(emitter, emitter->globals[index]);
+    scc_text_write(emitter, ";\n");
+
+    textures = SCC_TRUE;
+  }
+
+  if (textures)
+    scc_text_write(emitter, "\n");
+}
+
+static scc_text_dialect_t scc_glsl_dialect(void) {
+  scc_text_dialect_t dialect;
+
+  memset(&dialect, 0, sizeof(dialect));
+
+  dialect.reserved = SCC_GLSL_RESERVED;
+  dialect.num_of_reserved = sizeof(SCC_GLSL_RESERVED) / sizeof(SCC_GLSL_RESERVED[0]);
+  dialect.reserved_prefix = "gl_";
+
+  static const char *const SCALARS[] = {
+    "void", "bool",
+    "int", "int", "int", "int64_t",
+    "uint", "uint", "uint", "uint64_t",
+    "float", "double"
+  };
+
+  static const char *const VECTORS[] = {
+    "vec", "bvec",
+    "ivec", "ivec", "ivec", "i64vec",
+    "uvec", "uvec", "uvec", "u64vec",
+    "vec", "dvec"
+  };
+
+  static const char *const SUFFIXES[] = {
+    "", "",
+    "", "", "", "l",
+    "u", "u", "u", "ul",
+    "", "lf"
+  };
+
+  memcpy(dialect.scalars, SCALARS, sizeof(SCALARS));
+  memcpy(dialect.vectors, VECTORS, sizeof(VECTORS));
+  memcpy(dialect.suffixes, SUFFIXES, sizeof(SUFFIXES));
+
+  // Named by columns then rows.
+  dialect.matrices[0] = "mat";
+  dialect.matrices[1] = "dmat";
+  dialect.abbreviate = SCC_TRUE;
+
+  dialect.f32_from_bits = "uintBitsToFloat(0x%08xu)";
+  dialect.f64_from_bits = "packDouble2x32(uvec2(0x%08xu, 0x%08xu))";
+
+  #define SPELL(Operation, Spelling) \
+    dialect.operations[SCC_IR_OPERATION_##Operation] = Spelling;
+
+  SPELL(FMA,         "fma")
+  SPELL(SQRT,        "sqrt")
+  SPELL(RSQRT,       "inversesqrt")
+  SPELL(SIN,         "sin")
+  SPELL(COS,         "cos")
+  SPELL(TAN,         "tan")
+  SPELL(SINH,        "sinh")
+  SPELL(COSH,        "cosh")
+  SPELL(TANH,        "tanh")
+  SPELL(ASIN,        "asin")
+  SPELL(ACOS,        "acos")
+  SPELL(ATAN,        "atan")
+  SPELL(ATAN2,       "atan")
+  SPELL(POW,         "pow")
+  SPELL(EXP,         "exp")
+  SPELL(EXP2,        "exp2")
+  SPELL(LOG,         "log")
+  SPELL(LOG2,        "log2")
+  SPELL(MAGNITUDE,   "length")
+  SPELL(LENGTH,      "length")
+  SPELL(DOT,         "dot")
+  SPELL(CROSS,       "cross")
+  SPELL(NORMALIZE,   "normalize")
+  SPELL(DISTANCE,    "distance")
+  SPELL(REFLECT,     "reflect")
+  SPELL(REFRACT,     "refract")
+  SPELL(TRANSPOSE,   "transpose")
+  SPELL(INVERSE,     "inverse")
+  SPELL(DETERMINANT, "determinant")
+  SPELL(ABS,         "abs")
+  SPELL(FLOOR,       "floor")
+  SPELL(CEIL,        "ceil")
+  SPELL(MIN,         "min")
+  SPELL(MAX,         "max")
+  SPELL(CLAMP,       "clamp")
+
+  #undef SPELL
+
+  dialect.comparisons = SCC_GLSL_COMPARISONS;
+
+  dialect.discard = "discard;";
+
+  dialect.builtins[SCC_IR_BUILTIN_POSITION] = "gl_Position";
+  dialect.builtins[SCC_IR_BUILTIN_DEPTH] = "gl_FragDepth";
+
+  dialect.flattened = (1u << SCC_IR_INPUT) | (1u << SCC_IR_OUTPUT);
+
+  dialect.entry = "main";
+
+  dialect.preamble = &scc_glsl_preamble;
+  dialect.declarations = &scc_glsl_declarations;
+  dialect.expression = &scc_glsl_expression;
+
+  return dialect;
+}
+
+static const scc_text_dialect_t SCC_GLSL_DIALECT = scc_glsl_dialect();
+
+scc_bool_t scc_glsl_emit(const scc_ir_module_t *module,
+                         const scc_glsl_options_t *options,
+                         scc_writer_t *writer) {
+  return scc_text_emit(module, &SCC_GLSL_DIALECT, options ? options : &SCC_GLSL_DEFAULT_OPTIONS, writer);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,586 @@
+//===-- scc/backend/hlsl.cc -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/backend/hlsl.h"
+#include "scc/backend/text.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_hlsl_options_t SCC_HLSL_DEFAULT_OPTIONS = {
+  50
+};
+
+// Identifiers that can't be used as is, being keywords, reserved, or names of
+// intrinsics that would be hidden.
+static const char *const SCC_HLSL_RESERVED[] = {
+  "AppendStructuredBuffer", "BlendState", "Buffer", "ByteAddressBuffer",
+  "CompileShader", "ComputeShader", "ConsumeStructuredBuffer",
+  "DepthStencilState", "DepthStencilView", "DomainShader", "GeometryShader",
+  "HullShader", "InputPatch", "LineStream", "NULL", "OutputPatch",
+  "PixelShader", "PointStream", "RWBuffer", "RWByteAddressBuffer",
+  "RWStructuredBuffer", "RWTexture1D", "RWTexture2D", "RWTexture3D",
+  "RasterizerState", "RenderTargetView", "SamplerComparisonState",
+  "SamplerState", "StructuredBuffer", "Texture1D", "Texture2D", "Texture3D",
+  "TextureCube", "TriangleStream", "VertexShader", "abs", "acos", "all",
+  "any", "asdouble", "asfloat", "asin", "asint", "asm", "asuint", "atan",
+  "atan2", "bool", "break", "case", "cbuffer", "ceil", "centroid", "clamp",
+  "class", "column_major", "compile", "const", "continue", "cos", "cosh",
+  "cross", "default", "determinant", "discard", "distance", "do", "dot",
+  "double", "else", "exp", "exp2", "export", "extern", "false", "float",
+  "floor", "fma", "for", "frac", "groupshared", "half", "if", "in", "inline",
+  "inout", "int", "int64_t", "interface", "length", "lerp", "line",
+  "lineadj", "linear", "log", "log2", "mad", "main", "matrix", "max", "min",
+  "min16float", "min16int", "min16uint", "mul", "namespace",
+  "nointerpolation", "noperspective", "normalize", "out", "packoffset",
+  "pass", "point", "pow", "precise", "reflect", "refract", "register",
+  "return", "row_major", "rsqrt", "sample", "sampler", "saturate", "shared",
+  "sin", "sinh", "snorm", "sqrt", "static", "string", "struct", "switch",
+  "tan", "tanh", "tbuffer", "technique", "template", "texture", "transpose",
+  "triangle", "triangleadj", "true", "typedef", "uint", "uint64_t",
+  "uniform", "unorm", "unsigned", "vector", "void", "volatile", "while"
+};
+
+// Components of registers, by offset into them.
+static const char *const SCC_HLSL_COMPONENTS[] = {
+  "", ".y", ".z", ".w"
+};
+
+// Inverses, of matrices of `$`, as HLSL has none.
+static const char *const SCC_HLSL_INVERSES[] = {
+  "$2x2 _inverse@2($2x2 m) {\n"
+  "  return $2x2(m[1][1], -m[0][1], -m[1][0], m[0][0]) / determinant(m);\n"
+  "}\n\n",
+
+  "$3x3 _inverse@3($3x3 m) {\n"
+  "  $3x3 c;\n"
+  "  c[0] = cross(m[1], m[2]);\n"
+  "  c[1] = cross(m[2], m[0]);\n"
+  "  c[2] = cross(m[0], m[1]);\n"
+  "  return transpose(c) / dot(m[0], c[0]);\n"
+  "}\n\n",
+
+  "$4x4 _inverse@4($4x4 m) {\n"
+  "  $ b00 = m[0][0] * m[1][1] - m[0][1] * m[1][0];\n"
+  "  $ b01 = m[0][0] * m[1][2] - m[0][2] * m[1][0];\n"
+  "  $ b02 = m[0][0] * m[1][3] - m[0][3] * m[1][0];\n"
+  "  $ b03 = m[0][1] * m[1][2] - m[0][2] * m[1][1];\n"
+  "  $ b04 = m[0][1] * m[1][3] - m[0][3] * m[1][1];\n"
+  "  $ b05 = m[0][2] * m[1][3] - m[0][3] * m[1][2];\n"
+  "  $ b06 = m[2][0] * m[3][1] - m[2][1] * m[3][0];\n"
+  "  $ b07 = m[2][0] * m[3][2] - m[2][2] * m[3][0];\n"
+  "  $ b08 = m[2][0] * m[3][3] - m[2][3] * m[3][0];\n"
+  "  $ b09 = m[2][1] * m[3][2] - m[2][2] * m[3][1];\n"
+  "  $ b10 = m[2][1] * m[3][3] - m[2][3] * m[3][1];\n"
+  "  $ b11 = m[2][2] * m[3][3] - m[2][3] * m[3][2];\n"
+  "  $ d = b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;\n"
+  "  return $4x4(m[1][1] * b11 - m[1][2] * b10 + m[1][3] * b09,\n"
+  "              m[0][2] * b10 - m[0][1] * b11 - m[0][3] * b09,\n"
+  "              m[3][1] * b05 - m[3][2] * b04 + m[3][3] * b03,\n"
+  "              m[2][2] * b04 - m[2][1] * b05 - m[2][3] * b03,\n"
+  "              m[1][2] * b08 - m[1][0] * b11 - m[1][3] * b07,\n"
+  "              m[0][0] * b11 - m[0][2] * b08 + m[0][3] * b07,\n"
+  "              m[3][2] * b02 - m[3][0] * b05 - m[3][3] * b01,\n"
+  "              m[2][0] * b05 - m[2][2] * b02 + m[2][3] * b01,\n"
+  "              m[1][0] * b10 - m[1][1] * b08 + m[1][3] * b06,\n"
+  "              m[0][1] * b08 - m[0][0] * b10 - m[0][3] * b06,\n"
+  "              m[3][0] * b04 - m[3][1] * b02 + m[3][3] * b00,\n"
+  "              m[2][1] * b02 - m[2][0] * b04 - m[2][3] * b00,\n"
+  "              m[1][1] * b07 - m[1][0] * b09 - m[1][2] * b06,\n"
+  "              m[0][0] * b09 - m[0][1] * b07 + m[0][2] * b06,\n"
+  "              m[3][1] * b01 - m[3][0] * b03 - m[3][2] * b00,\n"
+  "              m[2][0] * b03 - m[2][1] * b01 + m[2][2] * b00) / d;\n"
+  "}\n\n"
+};
+
+static const char *const SCC_HLSL_GATHERS[] = {
+  "GatherRed", "GatherGreen", "GatherBlue", "GatherAlpha"
+};
+
+// Writes `texture.method(_Stexture, coordinates`.
+static void scc_hlsl_sample(scc_text_emitter_t *emitter,
+                            const scc_ir_instruction_t *instruction,
+                            const char *method) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  const scc_text_name_t texture = emitter->globals[SCC_IR_VALUE_INDEX(operands[0])];
+
+  scc_text_name(emitter, texture);
+  scc_writer_put(emitter->writer, '.');
+  scc_text_write(emitter, method);
+  scc_text_write(emitter, "(_S");
+  scc_text_name(emitter, texture);
+  scc_text_write(emitter, ", ");
+  scc_text_value(emitter, operands[1], scc_ir_type(SCC_IR_F32, 2, 1));
+}
+
+static scc_bool_t scc_hlsl_expression(scc_text_emitter_t *emitter,
+                                      const scc_ir_instruction_t *instruction) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_FETCH:
+      // Derivatives are only had when shading pixels.
+      if (emitter->module->type == SCC_PIXEL_SHADER) {
+        scc_hlsl_sample(emitter, instruction, "Sample");
+        scc_writer_put(emitter->writer, ')');
+      } else {
+        scc_hlsl_sample(emitter, instruction, "SampleLevel");
+        scc_text_write(emitter, ", 0)");
+      }
+
+      scc_text_narrow(emitter, instruction->type.rows);
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_GATHER: {
+      // Components can only be chosen statically.
+      const scc_uint32_t component = (SCC_IR_VALUE_KIND(operands[2]) == SCC_IR_VALUE_IMMEDIATE)
+                                   ? SCC_MIN(SCC_IR_VALUE_INDEX(operands[2]), 3u)
+                                   : 0;
+
+      scc_hlsl_sample(emitter, instruction, SCC_HLSL_GATHERS[component]);
+      scc_writer_put(emitter->writer, ')');
+      scc_text_narrow(emitter, instruction->type.rows);
+    } return SCC_TRUE;
+
+    case SCC_IR_OPERATION_INVERSE:
+      scc_text_write(emitter, (instruction->type.scalar == SCC_IR_F64) ? "_inversed" : "_inversef");
+      scc_writer_unsigned(emitter->writer, instruction->type.rows);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_value(emitter, operands[0], instruction->type);
+      scc_writer_put(emitter->writer, ')');
+      return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+// Defines the inverses used.
+static void scc_hlsl_preamble(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  // Indexed by precision then size.
+  scc_bool_t used[2][5] = { { SCC_FALSE } };
+
+  for (scc_uint32_t position = 0; position < emitter->num_of_functions; ++position) {
+    const scc_ir_function_t *function = module->functions[emitter->order[position]];
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if ((instruction->op == SCC_IR_OPERATION_INVERSE) && scc_ir_instruction_is_live(instruction))
+        used[instruction->type.scalar == SCC_IR_F64][SCC_MIN((scc_uint32_t)instruction->type.rows, 4u)] = SCC_TRUE;
+    }
+  }
+
+  for (scc_uint32_t precision = 0; precision < 2; ++precision) {
+    for (scc_uint32_t size = 2; size <= 4; ++size) {
+      if (!used[precision][size])
+        continue;
+
+      const char *scalar = precision ? "double" : "float";
+
+      for (const char *text = SCC_HLSL_INVERSES[size - 2]; *text; ++text) {
+        if (*text == '$')
+          scc_text_write(emitter, scalar);
+        else if (*text == '@')
+          scc_writer_put(emitter->writer, precision ? 'd' : 'f');
+        else
+          scc_writer_put(emitter->writer, *text);
+      }
+    }
+  }
+}
+
+// Writes the semantic of an input or output at `location`, or bound to
+// `builtin`.
+static void scc_hlsl_semantic(scc_text_emitter_t *emitter,
+                              scc_ir_storage_t storage,
+                              scc_ir_builtin_t builtin,
+                              scc_uint32_t location) {
+  scc_text_write(emitter, " : ");
+
+  if (builtin == SCC_IR_BUILTIN_POSITION)
+    return scc_text_write(emitter, "SV_Position");
+  if (builtin == SCC_IR_BUILTIN_DEPTH)
+    return scc_text_write(emitter, "SV_Depth");
+
+  if ((emitter->module->type == SCC_PIXEL_SHADER) && (storage == SCC_IR_OUTPUT))
+    scc_text_write(emitter, "SV_Target");
+  else
+    scc_text_write(emitter, "TEXCOORD");
+
+  scc_writer_unsigned(emitter->writer, location);
+}
+
+static void scc_hlsl_static(scc_text_emitter_t *emitter,
+                            scc_ir_storage_t storage,
+                            scc_ir_builtin_t builtin,
+                            scc_uint32_t location,
+                            scc_ir_type_t type,
+                            scc_text_name_t name) {
+  (void)storage;
+  (void)builtin;
+  (void)location;
+
+  scc_text_write(emitter, "static ");
+  scc_text_type(emitter, type);
+  scc_writer_put(emitter->writer, ' ');
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, ";\n");
+}
+
+static void scc_hlsl_field(scc_text_emitter_t *emitter,
+                           scc_ir_storage_t storage,
+                           scc_ir_builtin_t builtin,
+                           scc_uint32_t location,
+                           scc_ir_type_t type,
+                           scc_text_name_t name) {
+  scc_text_write(emitter, "  ");
+
+  if (scc_text_is_flat(emitter, storage, type))
+    scc_text_write(emitter, "nointerpolation ");
+
+  scc_text_type(emitter, type);
+  scc_writer_put(emitter->writer, ' ');
+  scc_text_name(emitter, name);
+  scc_hlsl_semantic(emitter, storage, builtin, location);
+  scc_text_write(emitter, ";\n");
+}
+
+static void scc_hlsl_copy_in(scc_text_emitter_t *emitter,
+                             scc_ir_storage_t storage,
+                             scc_ir_builtin_t builtin,
+                             scc_uint32_t location,
+                             scc_ir_type_t type,
+                             scc_text_name_t name) {
+  (void)storage;
+  (void)builtin;
+  (void)location;
+  (void)type;
+
+  scc_text_write(emitter, "  ");
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, " = _input.");
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, ";\n");
+}
+
+static void scc_hlsl_copy_out(scc_text_emitter_t *emitter,
+                              scc_ir_storage_t storage,
+                              scc_ir_builtin_t builtin,
+                              scc_uint32_t location,
+                              scc_ir_type_t type,
+                              scc_text_name_t name) {
+  (void)storage;
+  (void)builtin;
+  (void)location;
+  (void)type;
+
+  scc_text_write(emitter, "  _output.");
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, " = ");
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, ";\n");
+}
+
+// Declares a constant placed at `offset` bytes into its buffer.
+static void scc_hlsl_constant(scc_text_emitter_t *emitter,
+                              scc_uint32_t offset,
+                              scc_ir_type_t type,
+                              scc_text_name_t name) {
+  scc_text_write(emitter, scc_ir_type_is_matrix(type) ? "  column_major " : "  ");
+  scc_text_type(emitter, type);
+  scc_writer_put(emitter->writer, ' ');
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, " : packoffset(c");
+  scc_writer_unsigned(emitter->writer, offset / 16);
+  scc_text_write(emitter, SCC_HLSL_COMPONENTS[(offset % 16) / 4]);
+  scc_text_write(emitter, ");\n");
+}
+
+static void scc_hlsl_declarations(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  // Inputs and outputs.
+  scc_text_interface(emitter, SCC_IR_INPUT, &scc_hlsl_static);
+  scc_text_interface(emitter, SCC_IR_OUTPUT, &scc_hlsl_static);
+
+  scc_text_write(emitter, "\n");
+
+  // Constant buffers, then loose constants in a buffer of their own, bound to
+  // the first slot not otherwise taken.
+  scc_uint32_t slot = 0;
+  scc_bool_t loose = SCC_FALSE;
+
+  for (scc_bool_t taken = SCC_TRUE; taken; ) {
+    taken = SCC_FALSE;
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar == SCC_IR_STRUCTURE) && (global->binding == slot)) {
+        slot += 1;
+        taken = SCC_TRUE;
+      }
+    }
+  }
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if (global->storage != SCC_IR_CONSTANT)
+      continue;
+
+    if (global->type.scalar != SCC_IR_STRUCTURE) {
+      loose = SCC_TRUE;
+      continue;
+    }
+
+    const scc_ir_structure_t *structure = &module->structures[global->type.structure];
+
+    scc_text_write(emitter, "cbuffer _B");
+    scc_text_name(emitter, emitter->globals[index]);
+    scc_text_write(emitter, " : register(b");
+    scc_writer_unsigned(emitter->writer, global->binding);
+    scc_text_write(emitter, ") {\n");
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      const scc_ir_member_t *def = &module->members[structure->first_member + member];
+      scc_hlsl_constant(emitter, def->offset, def->type, emitter->fields[emitter->first_field[index] + member]);
+    }
+
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  if (loose) {
+    scc_text_write(emitter, "cbuffer _constants : register(b");
+    scc_writer_unsigned(emitter->writer, slot);
+    scc_text_write(emitter, ") {\n");
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar != SCC_IR_STRUCTURE))
+        scc_hlsl_constant(emitter, global->offset, global->type, emitter->globals[index]);
+    }
+
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  // Textures, each with a sampler of its own.
+  scc_bool_t textures = SCC_FALSE;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if (global->storage != SCC_IR_TEXTURE)
+      continue;
+
+    scc_text_write(emitter, "Texture");
+    scc_writer_unsigned(emitter->writer, emitter->dimensions[index]);
+    scc_text_write(emitter, "D<");
+    scc_text_type(emitter, scc_ir_type_reshape(global->type, 4, 1));
+    scc_text_write(emitter, "> ");
+    scc_text_name(emitter, emitter->globals[index]);
+    scc_text_write(emitter, " : register(t");
+    scc_writer_unsigned(emitter->writer, global->binding);
+    scc_text_write(emitter, ");\n");
+
+    scc_text_write(emitter, "SamplerState _S");
+    scc_text_name(emitter, emitter->globals[index]);
+    scc_text_write(emitter, " : register(s");
+    scc_writer_unsigned(emitter->writer, global->binding);
+    scc_text_write(emitter, ");\n");
+
+    textures = SCC_TRUE;
+  }
+
+  if (textures)
+    scc_text_write(emitter, "\n");
+}
+
+// Determines if anything is stored to with `storage`.
+static scc_bool_t scc_hlsl_has(const scc_text_emitter_t *emitter,
+                               scc_ir_storage_t storage) {
+  const scc_ir_module_t *module = emitter->module;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index)
+    if (module->globals[index].storage == storage)
+      return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+// Writes the real entry point, which copies inputs in, runs the entry point
+// of the module, then copies outputs out.
+static void scc_hlsl_epilogue(scc_text_emitter_t *emitter) {
+  const scc_bool_t inputs = scc_hlsl_has(emitter, SCC_IR_INPUT);
+  const scc_bool_t outputs = scc_hlsl_has(emitter, SCC_IR_OUTPUT);
+
+  if (inputs) {
+    scc_text_write(emitter, "struct _Input {\n");
+    scc_text_interface(emitter, SCC_IR_INPUT, &scc_hlsl_field);
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  if (outputs) {
+    scc_text_write(emitter, "struct _Output {\n");
+    scc_text_interface(emitter, SCC_IR_OUTPUT, &scc_hlsl_field);
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  scc_text_write(emitter, outputs ? "_Output main(" : "void main(");
+  scc_text_write(emitter, inputs ? "_Input _input) {\n" : ") {\n");
+
+  if (inputs)
+    scc_text_interface(emitter, SCC_IR_INPUT, &scc_hlsl_copy_in);
+
+  scc_text_write(emitter, "  ");
+  scc_text_name(emitter, emitter->functions[emitter->module->entry]);
+  scc_text_write(emitter, "();\n");
+
+  if (outputs) {
+    scc_text_write(emitter, "  _Output _output;\n");
+    scc_text_interface(emitter, SCC_IR_OUTPUT, &scc_hlsl_copy_out);
+    scc_text_write(emitter, "  return _output;\n");
+  }
+
+  scc_text_write(emitter, "}\n");
+}
+
+static scc_text_dialect_t scc_hlsl_dialect(void) {
+  scc_text_dialect_t dialect;
+
+  memset(&dialect, 0, sizeof(dialect));
+
+  dialect.reserved = SCC_HLSL_RESERVED;
+  dialect.num_of_reserved = sizeof(SCC_HLSL_RESERVED) / sizeof(SCC_HLSL_RESERVED[0]);
+  dialect.reserved_prefix = "SV_";
+
+  static const char *const SCALARS[] = {
+    "void", "bool",
+    "int", "int", "int", "int64_t",
+    "uint", "uint", "uint", "uint64_t",
+    "float", "double"
+  };
+
+  static const char *const SUFFIXES[] = {
+    "", "",
+    "", "", "", "ll",
+    "u", "u", "u", "ull",
+    "", "L"
+  };
+
+  memcpy(dialect.scalars, SCALARS, sizeof(SCALARS));
+  memcpy(dialect.vectors, SCALARS, sizeof(SCALARS));
+  memcpy(dialect.suffixes, SUFFIXES, sizeof(SUFFIXES));
+
+  // Named by rows then columns, and constructed row by row.
+  dialect.matrices[0] = "float";
+  dialect.matrices[1] = "double";
+  dialect.row_major = SCC_TRUE;
+
+  // Constructors don't splat.
+  dialect.casts = SCC_TRUE;
+
+  dialect.f32_from_bits = "asfloat(0x%08xu)";
+  dialect.f64_from_bits = "asdouble(0x%08xu, 0x%08xu)";
+
+  #define SPELL(Operation, Spelling) \
+    dialect.operations[SCC_IR_OPERATION_##Operation] = Spelling;
+
+  SPELL(FMA,         "mad")
+  SPELL(SQRT,        "sqrt")
+  SPELL(RSQRT,       "rsqrt")
+  SPELL(SIN,         "sin")
+  SPELL(COS,         "cos")
+  SPELL(TAN,         "tan")
+  SPELL(SINH,        "sinh")
+  SPELL(COSH,        "cosh")
+  SPELL(TANH,        "tanh")
+  SPELL(ASIN,        "asin")
+  SPELL(ACOS,        "acos")
+  SPELL(ATAN,        "atan")
+  SPELL(ATAN2,       "atan2")
+  SPELL(POW,         "pow")
+  SPELL(EXP,         "exp")
+  SPELL(EXP2,        "exp2")
+  SPELL(LOG,         "log")
+  SPELL(LOG2,        "log2")
+  SPELL(MAGNITUDE,   "length")
+  SPELL(LENGTH,      "length")
+  SPELL(DOT,         "dot")
+  SPELL(CROSS,       "cross")
+  SPELL(NORMALIZE,   "normalize")
+  SPELL(DISTANCE,    "distance")
+  SPELL(REFLECT,     "reflect")
+  SPELL(REFRACT,     "refract")
+  SPELL(TRANSPOSE,   "transpose")
+  SPELL(DETERMINANT, "determinant")
+  SPELL(ABS,         "abs")
+  SPELL(FLOOR,       "floor")
+  SPELL(CEIL,        "ceil")
+  SPELL(MIN,         "min")
+  SPELL(MAX,         "max")
+  SPELL(CLAMP,       "clamp")
+  SPELL(SATURATE,    "saturate")
+
+  #undef SPELL
+
+  dialect.product = "mul";
+
+  dialect.discard = "discard;";
+
+  dialect.flattened = (1u << SCC_IR_INPUT) | (1u << SCC_IR_OUTPUT) | (1u << SCC_IR_CONSTANT);
+
+  dialect.preamble = &scc_hlsl_preamble;
+  dialect.declarations = &scc_hlsl_declarations;
+  dialect.expression = &scc_hlsl_expression;
+  dialect.epilogue = &scc_hlsl_epilogue;
+
+  return dialect;
+}
+
+static const scc_text_dialect_t SCC_HLSL_DIALECT = scc_hlsl_dialect();
+
+scc_bool_t scc_hlsl_emit(const scc_ir_module_t *module,
+                         const scc_hlsl_options_t *options,
+                         scc_writer_t *writer) {
+  if (!options)
+    options = &SCC_HLSL_DEFAULT_OPTIONS;
+
+  if (options->shader_model < 60) {
+    for (scc_uint32_t member = 0; member < module->num_of_members; ++member)
+      if (scc_text_is_wide(module->members[member].type))
+        return SCC_FALSE;
+
+    for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+      if (scc_text_is_wide(module->globals[global].type))
+        return SCC_FALSE;
+
+    for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+      const scc_ir_function_t *function = module->functions[index];
+
+      if (function->removed)
+        continue;
+
+      for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+        if (scc_text_is_wide(function->instructions[i].type) && scc_ir_instruction_is_live(&function->instructions[i]))
+          return SCC_FALSE;
+    }
+  }
+
+  return scc_text_emit(module, &SCC_HLSL_DIALECT, options, writer);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,748 @@
+//===-- scc/backend/msl.cc ------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/backend/msl.h"
+#include "scc/backend/text.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_msl_options_t SCC_MSL_DEFAULT_OPTIONS = {
+  21, 0
+};
+
+// Identifiers that can't be used as is, being keywords of C++ or Metal,
+// names of types, or of functions in the standard library that would be
+// hidden.
+static const char *const SCC_MSL_RESERVED[] = {
+  "abs", "access", "acos", "acosh", "alignas", "alignof", "and", "and_eq",
+  "array", "as_type", "asin", "asinh", "asm", "atan", "atan2", "atanh", "auto",
+  "bias", "bitand", "bitor", "bool", "bool2", "bool3", "bool4", "break",
+  "case", "catch", "ceil", "char", "clamp", "class", "compl", "component",
+  "const", "const_cast", "constant", "constexpr", "continue", "cos", "cosh",
+  "cross", "decltype", "default", "delete", "depth2d", "determinant", "device",
+  "discard_fragment", "distance", "do", "dot", "double", "dynamic_cast",
+  "else", "enum", "exp", "exp10", "exp2", "explicit", "export", "extern",
+  "fabs", "false", "float", "float2", "float2x2", "float2x3", "float2x4",
+  "float3", "float3x2", "float3x3", "float3x4", "float4", "float4x2",
+  "float4x3", "float4x4", "floor", "fma", "fmax", "fmin", "fmod", "for",
+  "fract", "fragment", "friend", "goto", "half", "half2", "half3", "half4",
+  "if", "inline", "int", "int2", "int3", "int4", "kernel", "length", "level",
+  "log", "log10", "log2", "long", "main", "main0", "matrix", "max", "metal",
+  "min", "mix", "mutable", "namespace", "new", "noexcept", "normalize", "not",
+  "not_eq", "nullptr", "operator", "or", "or_eq", "packed_float2",
+  "packed_float3", "packed_float4", "pow", "powr", "private", "protected",
+  "ptrdiff_t", "public", "reflect", "refract", "register", "reinterpret_cast",
+  "return", "rint", "round", "rsqrt", "sampler", "saturate", "select", "short",
+  "sign", "signed", "sin", "sinh", "size_t", "sizeof", "smoothstep", "sqrt",
+  "static", "static_assert", "static_cast", "step", "struct", "switch", "tan",
+  "tanh", "template", "texture1d", "texture2d", "texture3d", "texturecube",
+  "this", "thread", "thread_local", "threadgroup", "throw", "transpose",
+  "true", "trunc", "try", "typedef", "typeid", "typename", "uchar", "uint",
+  "uint2", "uint3", "uint4", "ulong", "union", "unsigned", "ushort", "using",
+  "vec", "vertex", "virtual", "void", "volatile", "wchar_t", "while", "xor",
+  "xor_eq"
+};
+
+static const char *const SCC_MSL_COMPONENTS[] = {
+  "x", "y", "z", "w"
+};
+
+// Inverses, as Metal has none. These are written in terms of rows, but work
+// just as well on columns, as the inverse of a transpose is the transpose of
+// the inverse.
+static const char *const SCC_MSL_INVERSES[] = {
+  "float2x2 _inverse2(float2x2 m) {\n"
+  "  return float2x2(m[1][1], -m[0][1], -m[1][0], m[0][0]) / determinant(m);\n"
+  "}\n\n",
+
+  "float3x3 _inverse3(float3x3 m) {\n"
+  "  float3x3 c;\n"
+  "  c[0] = cross(m[1], m[2]);\n"
+  "  c[1] = cross(m[2], m[0]);\n"
+  "  c[2] = cross(m[0], m[1]);\n"
+  "  return transpose(c) / dot(m[0], c[0]);\n"
+  "}\n\n",
+
+  "float4x4 _inverse4(float4x4 m) {\n"
+  "  float b00 = m[0][0] * m[1][1] - m[0][1] * m[1][0];\n"
+  "  float b01 = m[0][0] * m[1][2] - m[0][2] * m[1][0];\n"
+  "  float b02 = m[0][0] * m[1][3] - m[0][3] * m[1][0];\n"
+  "  float b03 = m[0][1] * m[1][2] - m[0][2] * m[1][1];\n"
+  "  float b04 = m[0][1] * m[1][3] - m[0][3] * m[1][1];\n"
+  "  float b05 = m[0][2] * m[1][3] - m[0][3] * m[1][2];\n"
+  "  float b06 = m[2][0] * m[3][1] - m[2][1] * m[3][0];\n"
+  "  float b07 = m[2][0] * m[3][2] - m[2][2] * m[3][0];\n"
+  "  float b08 = m[2][0] * m[3][3] - m[2][3] * m[3][0];\n"
+  "  float b09 = m[2][1] * m[3][2] - m[2][2] * m[3][1];\n"
+  "  float b10 = m[2][1] * m[3][3] - m[2][3] * m[3][1];\n"
+  "  float b11 = m[2][2] * m[3][3] - m[2][3] * m[3][2];\n"
+  "  float d = b00 * b11 - b01 * b10 + b02 * b09 + b03 * b08 - b04 * b07 + b05 * b06;\n"
+  "  return float4x4(m[1][1] * b11 - m[1][2] * b10 + m[1][3] * b09,\n"
+  "                  m[0][2] * b10 - m[0][1] * b11 - m[0][3] * b09,\n"
+  "                  m[3][1] * b05 - m[3][2] * b04 + m[3][3] * b03,\n"
+  "                  m[2][2] * b04 - m[2][1] * b05 - m[2][3] * b03,\n"
+  "                  m[1][2] * b08 - m[1][0] * b11 - m[1][3] * b07,\n"
+  "                  m[0][0] * b11 - m[0][2] * b08 + m[0][3] * b07,\n"
+  "                  m[3][2] * b02 - m[3][0] * b05 - m[3][3] * b01,\n"
+  "                  m[2][0] * b05 - m[2][2] * b02 + m[2][3] * b01,\n"
+  "                  m[1][0] * b10 - m[1][1] * b08 + m[1][3] * b06,\n"
+  "                  m[0][1] * b08 - m[0][0] * b10 - m[0][3] * b06,\n"
+  "                  m[3][0] * b04 - m[3][1] * b02 + m[3][3] * b00,\n"
+  "                  m[2][1] * b02 - m[2][0] * b04 - m[2][3] * b00,\n"
+  "                  m[1][1] * b07 - m[1][0] * b09 - m[1][2] * b06,\n"
+  "                  m[0][0] * b09 - m[0][1] * b07 + m[0][2] * b06,\n"
+  "                  m[3][1] * b01 - m[3][0] * b03 - m[3][2] * b00,\n"
+  "                  m[2][0] * b03 - m[2][1] * b01 + m[2][2] * b00) / d;\n"
+  "}\n\n"
+};
+
+// Writes `_g._t->texture.method(_g._t->_Stexture, coordinates`.
+static void scc_msl_sample(scc_text_emitter_t *emitter,
+                           const scc_ir_instruction_t *instruction,
+                           const char *method) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(operands[0]);
+  const scc_text_name_t texture = emitter->globals[index];
+
+  scc_text_write(emitter, "_g._t->");
+  scc_text_name(emitter, texture);
+  scc_writer_put(emitter->writer, '.');
+  scc_text_write(emitter, method);
+  scc_text_write(emitter, "(_g._t->_S");
+  scc_text_name(emitter, texture);
+  scc_text_write(emitter, ", ");
+  scc_text_value(emitter, operands[1], scc_ir_type(SCC_IR_F32, emitter->dimensions[index], 1));
+}
+
+// Writes `value` as `matrix`, splatting scalars to every column.
+static void scc_msl_matrix(scc_text_emitter_t *emitter,
+                           scc_ir_value_t value,
+                           scc_ir_type_t matrix) {
+  const scc_ir_type_t type = scc_ir_value_type(emitter->function, value);
+
+  if (!scc_ir_type_is_scalar(type))
+    return scc_text_value(emitter, value, matrix);
+
+  scc_text_type(emitter, matrix);
+  scc_writer_put(emitter->writer, '(');
+
+  for (scc_uint32_t column = 0; column < matrix.columns; ++column) {
+    if (column > 0)
+      scc_text_write(emitter, ", ");
+    scc_text_splat_begin(emitter, scc_ir_type_reshape(matrix, matrix.rows, 1));
+    scc_text_value(emitter, value, type);
+    scc_text_splat_end(emitter);
+  }
+
+  scc_writer_put(emitter->writer, ')');
+}
+
+static scc_bool_t scc_msl_expression(scc_text_emitter_t *emitter,
+                                     const scc_ir_instruction_t *instruction) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_ADD:
+    case SCC_IR_OPERATION_SUB:
+      // Scalars can't be added to or subtracted from matrices as is.
+      if (!scc_ir_type_is_matrix(instruction->type))
+        return SCC_FALSE;
+
+      scc_msl_matrix(emitter, operands[0], instruction->type);
+      scc_text_write(emitter, (instruction->op == SCC_IR_OPERATION_ADD) ? " + " : " - ");
+      scc_msl_matrix(emitter, operands[1], instruction->type);
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_FETCH:
+      scc_msl_sample(emitter, instruction, "sample");
+
+      // Derivatives are only had when shading pixels, and one-dimensional
+      // textures have no levels to choose from.
+      if ((emitter->module->type == SCC_PIXEL_SHADER) || (emitter->dimensions[SCC_IR_VALUE_INDEX(operands[0])] == 1))
+        scc_writer_put(emitter->writer, ')');
+      else
+        scc_text_write(emitter, ", level(0.0))");
+
+      scc_text_narrow(emitter, instruction->type.rows);
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_GATHER: {
+      // Components can only be chosen statically.
+      const scc_uint32_t component = (SCC_IR_VALUE_KIND(operands[2]) == SCC_IR_VALUE_IMMEDIATE)
+                                   ? SCC_MIN(SCC_IR_VALUE_INDEX(operands[2]), 3u)
+                                   : 0;
+
+      scc_msl_sample(emitter, instruction, "gather");
+      scc_text_write(emitter, ", int2(0), component::");
+      scc_text_write(emitter, SCC_MSL_COMPONENTS[component]);
+      scc_writer_put(emitter->writer, ')');
+      scc_text_narrow(emitter, instruction->type.rows);
+    } return SCC_TRUE;
+
+    case SCC_IR_OPERATION_INVERSE:
+      scc_text_write(emitter, "_inverse");
+      scc_writer_unsigned(emitter->writer, instruction->type.rows);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_value(emitter, operands[0], instruction->type);
+      scc_writer_put(emitter->writer, ')');
+      return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+// Writes what `member` of `global` is reached through: inputs and outputs by
+// `_g`, and constants by the argument buffer it points to.
+static void scc_msl_reference(scc_text_emitter_t *emitter,
+                              scc_uint32_t global,
+                              scc_uint32_t member) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_ir_global_t *def = &module->globals[global];
+
+  switch (def->storage) {
+    case SCC_IR_INPUT:
+      scc_text_write(emitter, "_g._i.");
+      break;
+
+    case SCC_IR_OUTPUT:
+      scc_text_write(emitter, "_g._o.");
+      break;
+
+    case SCC_IR_CONSTANT:
+      if (def->type.scalar != SCC_IR_STRUCTURE) {
+        scc_text_write(emitter, "_g._b->_constants->");
+        return scc_text_name(emitter, emitter->globals[global]);
+      }
+
+      if (member == SCC_IR_NONE) {
+        scc_text_write(emitter, "(*_g._b->");
+        scc_text_name(emitter, emitter->globals[global]);
+        return scc_writer_put(emitter->writer, ')');
+      }
+
+      scc_text_write(emitter, "_g._b->");
+      scc_text_name(emitter, emitter->globals[global]);
+      scc_text_write(emitter, "->");
+      return scc_text_name(emitter, emitter->members[module->structures[def->type.structure].first_member + member]);
+
+    default:
+      return scc_text_name(emitter, emitter->globals[global]);
+  }
+
+  if ((member != SCC_IR_NONE) && (emitter->first_field[global] != SCC_IR_NONE))
+    scc_text_name(emitter, emitter->fields[emitter->first_field[global] + member]);
+  else
+    scc_text_name(emitter, emitter->globals[global]);
+}
+
+// Determines if `type` is of 64-bit floats.
+static scc_bool_t scc_msl_is_double(scc_ir_type_t type) {
+  return (type.scalar == SCC_IR_F64);
+}
+
+// Determines if anything in `module` has a type that `is`.
+static scc_bool_t scc_msl_uses(const scc_ir_module_t *module,
+                               scc_bool_t (*is)(scc_ir_type_t type)) {
+  for (scc_uint32_t member = 0; member < module->num_of_members; ++member)
+    if (is(module->members[member].type))
+      return SCC_TRUE;
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+    if (is(module->globals[global].type))
+      return SCC_TRUE;
+
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    const scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed)
+      continue;
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+      if (is(function->instructions[i].type) && scc_ir_instruction_is_live(&function->instructions[i]))
+        return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+// Includes the standard library, and defines the inverses used.
+static void scc_msl_preamble(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  scc_text_write(emitter, "#include <metal_stdlib>\n\nusing namespace metal;\n\n");
+
+  scc_bool_t used[5] = { SCC_FALSE };
+
+  for (scc_uint32_t position = 0; position < emitter->num_of_functions; ++position) {
+    const scc_ir_function_t *function = module->functions[emitter->order[position]];
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if ((instruction->op == SCC_IR_OPERATION_INVERSE) && scc_ir_instruction_is_live(instruction))
+        used[SCC_MIN((scc_uint32_t)instruction->type.rows, 4u)] = SCC_TRUE;
+    }
+  }
+
+  for (scc_uint32_t size = 2; size <= 4; ++size)
+    if (used[size])
+      scc_text_write(emitter, SCC_MSL_INVERSES[size - 2]);
+}
+
+// Writes the attribute of an input or output at `location`, or bound to
+// `builtin`.
+static void scc_msl_attribute(scc_text_emitter_t *emitter,
+                              scc_ir_storage_t storage,
+                              scc_ir_builtin_t builtin,
+                              scc_uint32_t location) {
+  const scc_program_type_t type = emitter->module->type;
+
+  if (builtin == SCC_IR_BUILTIN_POSITION)
+    return scc_text_write(emitter, "position");
+  if (builtin == SCC_IR_BUILTIN_DEPTH)
+    return scc_text_write(emitter, "depth(any)");
+
+  if ((type == SCC_VERTEX_SHADER) && (storage == SCC_IR_INPUT)) {
+    scc_text_write(emitter, "attribute(");
+  } else if ((type == SCC_PIXEL_SHADER) && (storage == SCC_IR_OUTPUT)) {
+    scc_text_write(emitter, "color(");
+  } else {
+    scc_text_write(emitter, "user(locn");
+  }
+
+  scc_writer_unsigned(emitter->writer, location);
+  scc_writer_put(emitter->writer, ')');
+}
+
+static void scc_msl_field(scc_text_emitter_t *emitter,
+                          scc_ir_storage_t storage,
+                          scc_ir_builtin_t builtin,
+                          scc_uint32_t location,
+                          scc_ir_type_t type,
+                          scc_text_name_t name) {
+  scc_text_write(emitter, "  ");
+  scc_text_type(emitter, type);
+  scc_writer_put(emitter->writer, ' ');
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, " [[");
+  scc_msl_attribute(emitter, storage, builtin, location);
+
+  // Only the receiving side says how it's interpolated.
+  if ((storage == SCC_IR_INPUT) && (builtin == SCC_IR_BUILTIN_NONE) && scc_text_is_flat(emitter, storage, type))
+    scc_text_write(emitter, ", flat");
+
+  scc_text_write(emitter, "]];\n");
+}
+
+// Size of a scalar of `type` in bytes, as Metal lays it out.
+static scc_uint32_t scc_msl_scalar_size(scc_ir_type_t type) {
+  return (type.scalar == SCC_IR_BOOL) ? 1 : scc_ir_scalar_size(type);
+}
+
+// Declares a constant placed at `offset` bytes into its buffer, padding from
+// `*end`, where the last ended, and moving it on. Vectors that Metal would
+// align differently are packed.
+static void scc_msl_constant(scc_text_emitter_t *emitter,
+                             scc_uint32_t *end,
+                             scc_uint32_t offset,
+                             scc_ir_type_t type,
+                             scc_text_name_t name) {
+  if (offset > *end) {
+    scc_text_write(emitter, "  char _p");
+    scc_writer_unsigned(emitter->writer, *end);
+    scc_writer_put(emitter->writer, '[');
+    scc_writer_unsigned(emitter->writer, offset - *end);
+    scc_text_write(emitter, "];\n");
+  }
+
+  const scc_uint32_t scalar = scc_msl_scalar_size(type);
+
+  scc_uint32_t size;
+  scc_bool_t packed = SCC_FALSE;
+
+  if (type.scalar == SCC_IR_STRUCTURE) {
+    size = (scc_ir_type_size(emitter->module, type) + 15) & ~15u;
+  } else if (scc_ir_type_is_matrix(type)) {
+    size = type.columns * scalar * ((type.rows == 2) ? 2 : 4);
+  } else if (scc_ir_type_is_vector(type)) {
+    const scc_uint32_t alignment = scalar * ((type.rows == 2) ? 2 : 4);
+    packed = (type.rows == 3) || (offset % alignment != 0);
+    size = packed ? (type.rows * scalar) : alignment;
+  } else {
+    size = scalar;
+  }
+
+  scc_text_write(emitter, packed ? "  packed_" : "  ");
+  scc_text_type(emitter, type);
+  scc_writer_put(emitter->writer, ' ');
+  scc_text_name(emitter, name);
+  scc_text_write(emitter, ";\n");
+
+  *end = SCC_MAX(*end, offset) + size;
+}
+
+// Determines if anything is stored to with `storage`.
+static scc_bool_t scc_msl_has(const scc_text_emitter_t *emitter,
+                              scc_ir_storage_t storage) {
+  const scc_ir_module_t *module = emitter->module;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index)
+    if (module->globals[index].storage == storage)
+      return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+static void scc_msl_declarations(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  // Inputs, as taken by `[[stage_in]]`, and outputs, as returned.
+  if (scc_msl_has(emitter, SCC_IR_INPUT)) {
+    scc_text_write(emitter, "struct _Input {\n");
+    scc_text_interface(emitter, SCC_IR_INPUT, &scc_msl_field);
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  if (scc_msl_has(emitter, SCC_IR_OUTPUT)) {
+    scc_text_write(emitter, "struct _Output {\n");
+    scc_text_interface(emitter, SCC_IR_OUTPUT, &scc_msl_field);
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  // Constant buffers, then loose constants in a buffer of their own, at the
+  // first id not otherwise taken.
+  scc_uint32_t slot = 0;
+  scc_uint32_t num_of_loose = 0;
+
+  for (scc_bool_t taken = SCC_TRUE; taken; ) {
+    taken = SCC_FALSE;
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar == SCC_IR_STRUCTURE) && (global->binding == slot)) {
+        slot += 1;
+        taken = SCC_TRUE;
+      }
+    }
+  }
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if (global->storage != SCC_IR_CONSTANT)
+      continue;
+
+    if (global->type.scalar != SCC_IR_STRUCTURE) {
+      num_of_loose += 1;
+      continue;
+    }
+
+    const scc_ir_structure_t *structure = &module->structures[global->type.structure];
+
+    scc_text_write(emitter, "struct _B");
+    scc_text_name(emitter, emitter->globals[index]);
+    scc_text_write(emitter, " {\n");
+
+    scc_uint32_t end = 0;
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      const scc_ir_member_t *def = &module->members[structure->first_member + member];
+      scc_msl_constant(emitter, &end, def->offset, def->type, emitter->members[structure->first_member + member]);
+    }
+
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  if (num_of_loose > 0) {
+    scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+    // Declared in order of offset, as padding only goes forward.
+    scc_uint32_t *loose = (scc_uint32_t *)allocator->allocate(allocator, num_of_loose * sizeof(scc_uint32_t), 16);
+    scc_uint32_t n = 0;
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage != SCC_IR_CONSTANT) || (global->type.scalar == SCC_IR_STRUCTURE))
+        continue;
+
+      scc_uint32_t position = n++;
+
+      for (; (position > 0) && (module->globals[loose[position - 1]].offset > global->offset); --position)
+        loose[position] = loose[position - 1];
+
+      loose[position] = index;
+    }
+
+    scc_text_write(emitter, "struct _Constants {\n");
+
+    scc_uint32_t end = 0;
+
+    for (scc_uint32_t position = 0; position < num_of_loose; ++position) {
+      const scc_ir_global_t *global = &module->globals[loose[position]];
+      scc_msl_constant(emitter, &end, global->offset, global->type, emitter->globals[loose[position]]);
+    }
+
+    scc_text_write(emitter, "};\n\n");
+
+    scc_arena_reset(emitter->scratch);
+  }
+
+  // Argument buffers.
+  const scc_bool_t constants = scc_msl_has(emitter, SCC_IR_CONSTANT);
+  const scc_bool_t textures = scc_msl_has(emitter, SCC_IR_TEXTURE);
+
+  if (constants) {
+    scc_text_write(emitter, "struct _Buffers {\n");
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage != SCC_IR_CONSTANT) || (global->type.scalar != SCC_IR_STRUCTURE))
+        continue;
+
+      scc_text_write(emitter, "  constant _B");
+      scc_text_name(emitter, emitter->globals[index]);
+      scc_text_write(emitter, " *");
+      scc_text_name(emitter, emitter->globals[index]);
+      scc_text_write(emitter, " [[id(");
+      scc_writer_unsigned(emitter->writer, global->binding);
+      scc_text_write(emitter, ")]];\n");
+    }
+
+    if (num_of_loose > 0) {
+      scc_text_write(emitter, "  constant _Constants *_constants [[id(");
+      scc_writer_unsigned(emitter->writer, slot);
+      scc_text_write(emitter, ")]];\n");
+    }
+
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  // Textures, each with a sampler of its own.
+  if (textures) {
+    scc_text_write(emitter, "struct _Textures {\n");
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if (global->storage != SCC_IR_TEXTURE)
+        continue;
+
+      scc_text_write(emitter, "  texture");
+      scc_writer_unsigned(emitter->writer, emitter->dimensions[index]);
+      scc_text_write(emitter, "d<");
+      scc_text_type(emitter, scc_ir_type_reshape(global->type, 1, 1));
+      scc_text_write(emitter, "> ");
+      scc_text_name(emitter, emitter->globals[index]);
+      scc_text_write(emitter, " [[id(");
+      scc_writer_unsigned(emitter->writer, 2 * global->binding);
+      scc_text_write(emitter, ")]];\n");
+
+      scc_text_write(emitter, "  sampler _S");
+      scc_text_name(emitter, emitter->globals[index]);
+      scc_text_write(emitter, " [[id(");
+      scc_writer_unsigned(emitter->writer, 2 * global->binding + 1);
+      scc_text_write(emitter, ")]];\n");
+    }
+
+    scc_text_write(emitter, "};\n\n");
+  }
+
+  // Whatever functions reach globals through.
+  scc_text_write(emitter, "struct _Globals {\n");
+
+  if (scc_msl_has(emitter, SCC_IR_INPUT))
+    scc_text_write(emitter, "  _Input _i;\n");
+  if (scc_msl_has(emitter, SCC_IR_OUTPUT))
+    scc_text_write(emitter, "  _Output _o;\n");
+  if (constants)
+    scc_text_write(emitter, "  constant _Buffers *_b;\n");
+  if (textures)
+    scc_text_write(emitter, "  constant _Textures *_t;\n");
+
+  scc_text_write(emitter, "};\n\n");
+}
+
+// Writes the real entry point, which gathers inputs and argument buffers,
+// runs the entry point of the module, then returns outputs.
+static void scc_msl_epilogue(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_msl_options_t *options = (const scc_msl_options_t *)emitter->options;
+
+  // Kernels take and return nothing through the stage.
+  const scc_bool_t kernel = (module->type == SCC_COMPUTE_SHADER);
+
+  const scc_bool_t inputs = !kernel && scc_msl_has(emitter, SCC_IR_INPUT);
+  const scc_bool_t outputs = !kernel && scc_msl_has(emitter, SCC_IR_OUTPUT);
+  const scc_bool_t constants = scc_msl_has(emitter, SCC_IR_CONSTANT);
+  const scc_bool_t textures = scc_msl_has(emitter, SCC_IR_TEXTURE);
+
+  scc_text_write(emitter, kernel ? "kernel " : (module->type == SCC_PIXEL_SHADER) ? "fragment " : "vertex ");
+  scc_text_write(emitter, outputs ? "_Output main0(" : "void main0(");
+
+  const char *separator = "";
+
+  if (inputs) {
+    scc_text_write(emitter, "_Input _input [[stage_in]]");
+    separator = ", ";
+  }
+
+  if (constants) {
+    scc_text_write(emitter, separator);
+    scc_text_write(emitter, "constant _Buffers &_buffers [[buffer(");
+    scc_writer_unsigned(emitter->writer, options->buffer);
+    scc_text_write(emitter, ")]]");
+    separator = ", ";
+  }
+
+  if (textures) {
+    scc_text_write(emitter, separator);
+    scc_text_write(emitter, "constant _Textures &_textures [[buffer(");
+    scc_writer_unsigned(emitter->writer, options->buffer + 1);
+    scc_text_write(emitter, ")]]");
+  }
+
+  scc_text_write(emitter, ") {\n  _Globals _g;\n");
+
+  if (inputs)
+    scc_text_write(emitter, "  _g._i = _input;\n");
+  if (constants)
+    scc_text_write(emitter, "  _g._b = &_buffers;\n");
+  if (textures)
+    scc_text_write(emitter, "  _g._t = &_textures;\n");
+
+  scc_text_write(emitter, "  ");
+  scc_text_name(emitter, emitter->functions[module->entry]);
+  scc_text_write(emitter, "(_g);\n");
+
+  if (outputs)
+    scc_text_write(emitter, "  return _g._o;\n");
+
+  scc_text_write(emitter, "}\n");
+}
+
+static scc_text_dialect_t scc_msl_dialect(void) {
+  scc_text_dialect_t dialect;
+
+  memset(&dialect, 0, sizeof(dialect));
+
+  dialect.reserved = SCC_MSL_RESERVED;
+  dialect.num_of_reserved = sizeof(SCC_MSL_RESERVED) / sizeof(SCC_MSL_RESERVED[0]);
+
+  // Doubles are refused before getting this far.
+  static const char *const SCALARS[] = {
+    "void", "bool",
+    "char", "short", "int", "long",
+    "uchar", "ushort", "uint", "ulong",
+    "float", "double"
+  };
+
+  static const char *const SUFFIXES[] = {
+    "", "",
+    "", "", "", "l",
+    "u", "u", "u", "ul",
+    "", ""
+  };
+
+  memcpy(dialect.scalars, SCALARS, sizeof(SCALARS));
+  memcpy(dialect.vectors, SCALARS, sizeof(SCALARS));
+  memcpy(dialect.suffixes, SUFFIXES, sizeof(SUFFIXES));
+
+  // Named by columns then rows, as in `float3x3`.
+  dialect.matrices[0] = "float";
+  dialect.matrices[1] = "double";
+
+  dialect.f32_from_bits = "as_type<float>(0x%08xu)";
+  dialect.f64_from_bits = "as_type<double>(uint2(0x%08xu, 0x%08xu))";
+
+  #define SPELL(Operation, Spelling) \
+    dialect.operations[SCC_IR_OPERATION_##Operation] = Spelling;
+
+  SPELL(FMA,         "fma")
+  SPELL(SQRT,        "sqrt")
+  SPELL(RSQRT,       "rsqrt")
+  SPELL(SIN,         "sin")
+  SPELL(COS,         "cos")
+  SPELL(TAN,         "tan")
+  SPELL(SINH,        "sinh")
+  SPELL(COSH,        "cosh")
+  SPELL(TANH,        "tanh")
+  SPELL(ASIN,        "asin")
+  SPELL(ACOS,        "acos")
+  SPELL(ATAN,        "atan")
+  SPELL(ATAN2,       "atan2")
+  SPELL(POW,         "pow")
+  SPELL(EXP,         "exp")
+  SPELL(EXP2,        "exp2")
+  SPELL(LOG,         "log")
+  SPELL(LOG2,        "log2")
+  SPELL(MAGNITUDE,   "length")
+  SPELL(LENGTH,      "length")
+  SPELL(DOT,         "dot")
+  SPELL(CROSS,       "cross")
+  SPELL(NORMALIZE,   "normalize")
+  SPELL(DISTANCE,    "distance")
+  SPELL(REFLECT,     "reflect")
+  SPELL(REFRACT,     "refract")
+  SPELL(TRANSPOSE,   "transpose")
+  SPELL(DETERMINANT, "determinant")
+  SPELL(ABS,         "abs")
+  SPELL(FLOOR,       "floor")
+  SPELL(CEIL,        "ceil")
+  SPELL(MIN,         "min")
+  SPELL(MAX,         "max")
+  SPELL(CLAMP,       "clamp")
+  SPELL(SATURATE,    "saturate")
+
+  #undef SPELL
+
+  dialect.discard = "discard_fragment();";
+
+  dialect.flattened = (1u << SCC_IR_INPUT) | (1u << SCC_IR_OUTPUT);
+
+  dialect.context = "thread _Globals &_g";
+  dialect.context_argument = "_g";
+
+  dialect.preamble = &scc_msl_preamble;
+  dialect.declarations = &scc_msl_declarations;
+  dialect.reference = &scc_msl_reference;
+  dialect.expression = &scc_msl_expression;
+  dialect.epilogue = &scc_msl_epilogue;
+
+  return dialect;
+}
+
+static const scc_text_dialect_t SCC_MSL_DIALECT = scc_msl_dialect();
+
+scc_bool_t scc_msl_emit(const scc_ir_module_t *module,
+                        const scc_msl_options_t *options,
+                        scc_writer_t *writer) {
+  if (!options)
+    options = &SCC_MSL_DEFAULT_OPTIONS;
+
+  if (options->version < 20)
+    return SCC_FALSE;
+
+  if (scc_msl_uses(module, &scc_msl_is_double))
+    return SCC_FALSE;
+
+  if ((options->version < 23) && scc_msl_uses(module, &scc_text_is_wide))
+    return SCC_FALSE;
+
+  return scc_text_emit(module, &SCC_MSL_DIALECT, options, writer);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,464 @@
+//===-- scc/backend/reflection.cc -----------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/backend/reflection.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_reflection_emitter {
+  const scc_ir_module_t *module;
+  scc_ir_packing_t packing;
+
+  scc_arena_t *arena;
+
+  scc_reflection_resource_t *resources;
+  scc_uint32_t num_of_resources;
+
+  scc_reflection_field_t *fields;
+  scc_uint32_t num_of_fields;
+
+  scc_uint32_t *buckets;
+  scc_uint32_t num_of_buckets;
+
+  char *names;
+  scc_uint32_t size_of_names;
+
+  // Indexed by string of the module. Where each is in `names`, or
+  // `SCC_REFLECTION_NONE` if not written yet.
+  scc_uint32_t *interned;
+} scc_reflection_emitter_t;
+
+//===----------------------------------------------------------------------===//
+// Names
+//===----------------------------------------------------------------------===//
+
+static scc_reflection_name_t scc_reflection_intern(scc_reflection_emitter_t *emitter,
+                                                   scc_ir_string_t string) {
+  if (emitter->interned[string] != SCC_REFLECTION_NONE)
+    return emitter->interned[string];
+
+  const char *characters = &emitter->module->strings[string];
+  const scc_uint32_t length = (scc_uint32_t)strlen(characters);
+
+  const scc_reflection_name_t name = emitter->size_of_names;
+
+  memcpy(&emitter->names[name], characters, length + 1);
+  emitter->size_of_names += length + 1;
+
+  emitter->interned[string] = name;
+
+  return name;
+}
+
+//===----------------------------------------------------------------------===//
+// Resources
+//===----------------------------------------------------------------------===//
+
+static scc_reflection_type_t scc_reflection_type(scc_ir_type_t type) {
+  scc_reflection_type_t reflected;
+
+  reflected.scalar = type.scalar;
+  reflected.rows = type.rows;
+  reflected.columns = type.columns;
+  reflected.reserved = 0;
+
+  return reflected;
+}
+
+// Number of fields describing `type`, including those of nested structures
+// if `nested`.
+static scc_uint32_t scc_reflection_count(const scc_ir_module_t *module,
+                                         scc_ir_type_t type,
+                                         scc_bool_t nested) {
+  if (type.scalar != SCC_IR_STRUCTURE)
+    return 0;
+
+  const scc_ir_structure_t *structure = &module->structures[type.structure];
+
+  scc_uint32_t count = structure->num_of_members;
+
+  if (nested)
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member)
+      count += scc_reflection_count(module, module->members[structure->first_member + member].type, SCC_TRUE);
+
+  return count;
+}
+
+// Describes members of `structure`, in a run of fields of their own, followed
+// by those of nested structures if `nested`. Members are placed by location,
+// from `location` on, rather than by offset, unless `location` is
+// `SCC_REFLECTION_NONE`.
+static void scc_reflection_describe(scc_reflection_emitter_t *emitter,
+                                    scc_uint32_t structure_index,
+                                    scc_bool_t nested,
+                                    scc_uint32_t location,
+                                    scc_uint32_t *first_field,
+                                    scc_uint32_t *num_of_fields) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_ir_structure_t *structure = &module->structures[structure_index];
+
+  const scc_uint32_t first = emitter->num_of_fields;
+
+  emitter->num_of_fields += structure->num_of_members;
+
+  *first_field = first;
+  *num_of_fields = structure->num_of_members;
+
+  for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+    const scc_ir_member_t *def = &module->members[structure->first_member + member];
+
+    scc_reflection_field_t *field = &emitter->fields[first + member];
+
+    field->name = scc_reflection_intern(emitter, def->name);
+    field->type = scc_reflection_type(def->type);
+    field->offset = def->offset;
+    field->size = scc_ir_layout_size(module, emitter->packing, def->type);
+    field->stride = scc_ir_layout_stride(emitter->packing, def->type);
+    field->first_field = SCC_REFLECTION_NONE;
+    field->num_of_fields = 0;
+
+    // Members take consecutive locations, a column each.
+    if (location != SCC_REFLECTION_NONE) {
+      field->offset = location;
+      field->size = 0;
+      field->stride = 0;
+      location += SCC_MAX((scc_uint32_t)def->type.columns, 1u);
+    }
+
+    if (nested && (def->type.scalar == SCC_IR_STRUCTURE))
+      scc_reflection_describe(emitter, def->type.structure, SCC_TRUE, SCC_REFLECTION_NONE,
+                              &field->first_field, &field->num_of_fields);
+  }
+}
+
+// Notes how many coordinates each texture is sampled with, as backends
+// declare them.
+static void scc_reflection_dimensions(scc_reflection_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    const scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed)
+      continue;
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (!scc_ir_instruction_is_live(instruction))
+        continue;
+
+      if ((instruction->op == SCC_IR_OPERATION_FETCH) || (instruction->op == SCC_IR_OPERATION_GATHER)) {
+        const scc_uint32_t texture = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+        const scc_ir_type_t coordinates = scc_ir_value_type(function, scc_ir_operand(function, instruction, 1));
+        emitter->resources[texture].dimensions = SCC_MIN(SCC_MAX((scc_uint32_t)coordinates.rows, 1u), 3u);
+      }
+    }
+  }
+}
+
+static void scc_reflection_globals(scc_reflection_emitter_t *emitter,
+                                   scc_uint32_t slot_of_constants) {
+  const scc_ir_module_t *module = emitter->module;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    scc_reflection_resource_t *resource = &emitter->resources[index];
+
+    resource->name = scc_reflection_intern(emitter, global->name);
+    resource->storage = global->storage;
+    resource->type = scc_reflection_type(global->type);
+    resource->binding = global->binding;
+    resource->offset = 0;
+    resource->size = 0;
+    resource->stride = 0;
+    resource->builtin = global->builtin;
+    resource->dimensions = (global->storage == SCC_IR_TEXTURE) ? 2 : 0;
+    resource->first_field = SCC_REFLECTION_NONE;
+    resource->num_of_fields = 0;
+
+    if (global->storage == SCC_IR_TEXTURE)
+      continue;
+
+    if (global->storage == SCC_IR_CONSTANT) {
+      resource->size = scc_ir_layout_size(module, emitter->packing, global->type);
+      resource->stride = scc_ir_layout_stride(emitter->packing, global->type);
+
+      if (global->type.scalar != SCC_IR_STRUCTURE) {
+        resource->binding = slot_of_constants;
+        resource->offset = global->offset;
+        continue;
+      }
+
+      scc_reflection_describe(emitter, global->type.structure, SCC_TRUE, SCC_REFLECTION_NONE,
+                              &resource->first_field, &resource->num_of_fields);
+    } else if (global->type.scalar == SCC_IR_STRUCTURE) {
+      const scc_uint32_t location = (global->binding == SCC_IR_NONE) ? SCC_REFLECTION_NONE : global->binding;
+
+      scc_reflection_describe(emitter, global->type.structure, SCC_FALSE, location,
+                              &resource->first_field, &resource->num_of_fields);
+    }
+  }
+
+  // Resources are hashed by name, with the first of any that collide taking
+  // precedence.
+  const scc_uint32_t mask = emitter->num_of_buckets - 1;
+
+  for (scc_uint32_t index = 0; index < emitter->num_of_resources; ++index) {
+    const char *name = &emitter->names[emitter->resources[index].name];
+
+    scc_uint32_t probe = scc_reflection_hash(name) & mask;
+
+    while (emitter->buckets[probe] != SCC_REFLECTION_NONE)
+      probe = (probe + 1) & mask;
+
+    emitter->buckets[probe] = index;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Module
+//===----------------------------------------------------------------------===//
+
+static void scc_reflection_write(scc_writer_t *writer,
+                                 const void *data,
+                                 scc_uint32_t size) {
+  scc_writer_write(writer, (const char *)data, size);
+
+  // Sections are aligned to words.
+  static const char padding[4] = { 0, 0, 0, 0 };
+  scc_writer_write(writer, padding, (4 - (size & 3)) & 3);
+}
+
+scc_bool_t scc_reflection_emit(const scc_ir_module_t *module,
+                               scc_ir_packing_t packing,
+                               scc_writer_t *writer) {
+  scc_assert_debug(packing != SCC_IR_PACKING_TARGET);
+
+  scc_reflection_emitter_t emitter;
+
+  memset(&emitter, 0, sizeof(emitter));
+
+  emitter.module = module;
+  emitter.packing = packing;
+
+  emitter.arena = scc_arena_create(scc_get_global_heap_allocator(), 16 * 1024);
+
+  scc_allocator_t *allocator = &emitter.arena->allocator;
+
+  // Loose constants are gathered in a buffer of their own, bound to the first
+  // slot not otherwise taken, as backends do.
+  scc_uint32_t slot_of_constants = 0;
+  scc_uint32_t size_of_constants = 0;
+  scc_bool_t loose = SCC_FALSE;
+
+  for (scc_bool_t taken = SCC_TRUE; taken; ) {
+    taken = SCC_FALSE;
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      const scc_ir_global_t *global = &module->globals[index];
+
+      if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar == SCC_IR_STRUCTURE) && (global->binding == slot_of_constants)) {
+        slot_of_constants += 1;
+        taken = SCC_TRUE;
+      }
+    }
+  }
+
+  // Sized up front, names by as much as they'd take if none were shared.
+  scc_uint32_t num_of_fields = 0;
+  scc_uint32_t size_of_names = 1;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar != SCC_IR_STRUCTURE)) {
+      loose = SCC_TRUE;
+      size_of_constants = SCC_MAX(size_of_constants, global->offset + scc_ir_layout_size(module, packing, global->type));
+    }
+
+    size_of_names += (scc_uint32_t)strlen(&module->strings[global->name]) + 1;
+
+    if (global->storage != SCC_IR_TEXTURE)
+      num_of_fields += scc_reflection_count(module, global->type, global->storage == SCC_IR_CONSTANT);
+  }
+
+  // Every field is named after a member.
+  for (scc_uint32_t member = 0; member < module->num_of_members; ++member)
+    size_of_names += (scc_uint32_t)strlen(&module->strings[module->members[member].name]) + 1;
+
+  // Buckets are never full, so lookups always end.
+  scc_uint32_t num_of_buckets = 1;
+
+  while (num_of_buckets < 2 * module->num_of_globals + 1)
+    num_of_buckets *= 2;
+
+  emitter.num_of_resources = module->num_of_globals;
+  emitter.num_of_buckets = num_of_buckets;
+
+  emitter.resources =
+    (scc_reflection_resource_t *)allocator->allocate(allocator, (emitter.num_of_resources + 1) * sizeof(scc_reflection_resource_t), 16);
+  emitter.fields =
+    (scc_reflection_field_t *)allocator->allocate(allocator, (num_of_fields + 1) * sizeof(scc_reflection_field_t), 16);
+  emitter.buckets =
+    (scc_uint32_t *)allocator->allocate(allocator, num_of_buckets * sizeof(scc_uint32_t), 16);
+  emitter.names =
+    (char *)allocator->allocate(allocator, size_of_names, 16);
+  emitter.interned =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_strings + 1) * sizeof(scc_uint32_t), 16);
+
+  memset(emitter.buckets, 0xff, num_of_buckets * sizeof(scc_uint32_t));
+  memset(emitter.interned, 0xff, (module->num_of_strings + 1) * sizeof(scc_uint32_t));
+
+  // The empty string is always first.
+  emitter.names[0] = '\0';
+  emitter.size_of_names = 1;
+  emitter.interned[0] = 0;
+
+  scc_reflection_globals(&emitter, loose ? slot_of_constants : SCC_REFLECTION_NONE);
+  scc_reflection_dimensions(&emitter);
+
+  scc_assert_debug(emitter.num_of_fields == num_of_fields);
+
+  scc_reflection_header_t header;
+
+  memset(&header, 0, sizeof(header));
+
+  header.magic = SCC_REFLECTION_MAGIC;
+  header.version = SCC_REFLECTION_VERSION;
+  header.type = module->type;
+  header.packing = packing;
+
+  header.constants = loose ? slot_of_constants : SCC_REFLECTION_NONE;
+  header.size_of_constants = (!loose || (packing == SCC_IR_PACKING_TIGHT)) ? size_of_constants : ((size_of_constants + 15) & ~15u);
+
+  header.resources = sizeof(scc_reflection_header_t);
+  header.num_of_resources = emitter.num_of_resources;
+
+  header.fields = header.resources + emitter.num_of_resources * sizeof(scc_reflection_resource_t);
+  header.num_of_fields = emitter.num_of_fields;
+
+  header.buckets = header.fields + emitter.num_of_fields * sizeof(scc_reflection_field_t);
+  header.num_of_buckets = emitter.num_of_buckets;
+
+  header.names = header.buckets + emitter.num_of_buckets * sizeof(scc_uint32_t);
+  header.size_of_names = emitter.size_of_names;
+
+  header.size = header.names + ((emitter.size_of_names + 3) & ~3u);
+
+  scc_reflection_write(writer, &header, sizeof(header));
+  scc_reflection_write(writer, emitter.resources, emitter.num_of_resources * sizeof(scc_reflection_resource_t));
+  scc_reflection_write(writer, emitter.fields, emitter.num_of_fields * sizeof(scc_reflection_field_t));
+  scc_reflection_write(writer, emitter.buckets, emitter.num_of_buckets * sizeof(scc_uint32_t));
+  scc_reflection_write(writer, emitter.names, emitter.size_of_names);
+
+  scc_arena_destroy(emitter.arena);
+
+  return SCC_TRUE;
+}
+
+//===----------------------------------------------------------------------===//
+// Querying
+//===----------------------------------------------------------------------===//
+
+// Determines if `count` records of `stride` bytes at `offset` lie within
+// `size` bytes, without overflowing.
+static scc_bool_t scc_reflection_within(scc_uint32_t offset,
+                                        scc_uint32_t count,
+                                        scc_uint32_t stride,
+                                        scc_uint32_t size) {
+  if ((offset & 3) != 0 || offset > size)
+    return SCC_FALSE;
+
+  return (scc_uint64_t)count * stride <= (scc_uint64_t)(size - offset);
+}
+
+// Determines if fields from `first` on, if any, are in the blob.
+static scc_bool_t scc_reflection_has_fields(const scc_reflection_header_t *header,
+                                            scc_uint32_t first,
+                                            scc_uint32_t count) {
+  if (count == 0)
+    return SCC_TRUE;
+
+  return (first < header->num_of_fields) && (count <= header->num_of_fields - first);
+}
+
+const scc_reflection_header_t *scc_reflection_open(const void *blob,
+                                                   scc_size_t size) {
+  if ((blob == NULL) || (((scc_uintptr_t)blob & 3) != 0) || (size < sizeof(scc_reflection_header_t)))
+    return NULL;
+
+  const scc_reflection_header_t *header = (const scc_reflection_header_t *)blob;
+
+  if ((header->magic != SCC_REFLECTION_MAGIC) || (header->version != SCC_REFLECTION_VERSION))
+    return NULL;
+
+  if (header->size > size)
+    return NULL;
+
+  if (!scc_reflection_within(header->resources, header->num_of_resources, sizeof(scc_reflection_resource_t), header->size)
+   || !scc_reflection_within(header->fields, header->num_of_fields, sizeof(scc_reflection_field_t), header->size)
+   || !scc_reflection_within(header->buckets, header->num_of_buckets, sizeof(scc_uint32_t), header->size)
+   || !scc_reflection_within(header->names, header->size_of_names, 1, header->size))
+    return NULL;
+
+  // Names must be terminated, and buckets a power of two with one left empty,
+  // for lookups to end.
+  if ((header->size_of_names == 0) || (scc_reflection_string(header, header->size_of_names - 1)[0] != '\0'))
+    return NULL;
+
+  if ((header->num_of_buckets == 0) || ((header->num_of_buckets & (header->num_of_buckets - 1)) != 0))
+    return NULL;
+
+  const scc_uint32_t *buckets = (const scc_uint32_t *)((const char *)header + header->buckets);
+
+  scc_bool_t empty = SCC_FALSE;
+
+  for (scc_uint32_t bucket = 0; bucket < header->num_of_buckets; ++bucket) {
+    if (buckets[bucket] == SCC_REFLECTION_NONE)
+      empty = SCC_TRUE;
+    else if (buckets[bucket] >= header->num_of_resources)
+      return NULL;
+  }
+
+  if (!empty)
+    return NULL;
+
+  const scc_reflection_resource_t *resources = scc_reflection_resources(header);
+  const scc_reflection_field_t *fields = scc_reflection_fields(header);
+
+  for (scc_uint32_t index = 0; index < header->num_of_resources; ++index) {
+    const scc_reflection_resource_t *resource = &resources[index];
+
+    if (resource->name >= header->size_of_names)
+      return NULL;
+
+    if (!scc_reflection_has_fields(header, resource->first_field, resource->num_of_fields))
+      return NULL;
+  }
+
+  for (scc_uint32_t index = 0; index < header->num_of_fields; ++index) {
+    const scc_reflection_field_t *field = &fields[index];
+
+    if (field->name >= header->size_of_names)
+      return NULL;
+
+    if (!scc_reflection_has_fields(header, field->first_field, field->num_of_fields))
+      return NULL;
+  }
+
+  return header;
+}
+
+SCC_END_EXTERN_C
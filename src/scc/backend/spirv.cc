@@ -0,0 +1,3011 @@
+//===-- scc/backend/spirv.cc ----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/backend/spirv.h"
+
+#include "scc/ir/cfg.h"
+#include "scc/ir/dominators.h"
+#include "scc/ir/loops.h"
+
+#include <math.h>
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_spirv_options_t SCC_SPIRV_DEFAULT_OPTIONS = {
+  0x00010000,
+  SCC_FALSE,
+  SCC_IR_PACKING_STD140
+};
+
+//===----------------------------------------------------------------------===//
+// Encoding
+//===----------------------------------------------------------------------===//
+
+#define SCC_SPIRV_MAGIC 0x07230203u
+
+typedef enum scc_spirv_op {
+  SCC_SPIRV_OP_UNDEF                     = 1,
+  SCC_SPIRV_OP_NAME                      = 5,
+  SCC_SPIRV_OP_MEMBER_NAME               = 6,
+  SCC_SPIRV_OP_EXTENSION                 = 10,
+  SCC_SPIRV_OP_EXT_INST_IMPORT           = 11,
+  SCC_SPIRV_OP_EXT_INST                  = 12,
+  SCC_SPIRV_OP_MEMORY_MODEL              = 14,
+  SCC_SPIRV_OP_ENTRY_POINT               = 15,
+  SCC_SPIRV_OP_EXECUTION_MODE            = 16,
+  SCC_SPIRV_OP_CAPABILITY                = 17,
+  SCC_SPIRV_OP_TYPE_VOID                 = 19,
+  SCC_SPIRV_OP_TYPE_BOOL                 = 20,
+  SCC_SPIRV_OP_TYPE_INT                  = 21,
+  SCC_SPIRV_OP_TYPE_FLOAT                = 22,
+  SCC_SPIRV_OP_TYPE_VECTOR               = 23,
+  SCC_SPIRV_OP_TYPE_MATRIX               = 24,
+  SCC_SPIRV_OP_TYPE_IMAGE                = 25,
+  SCC_SPIRV_OP_TYPE_SAMPLED_IMAGE        = 27,
+  SCC_SPIRV_OP_TYPE_STRUCT               = 30,
+  SCC_SPIRV_OP_TYPE_POINTER              = 32,
+  SCC_SPIRV_OP_TYPE_FUNCTION             = 33,
+  SCC_SPIRV_OP_CONSTANT_TRUE             = 41,
+  SCC_SPIRV_OP_CONSTANT_FALSE            = 42,
+  SCC_SPIRV_OP_CONSTANT                  = 43,
+  SCC_SPIRV_OP_CONSTANT_COMPOSITE        = 44,
+  SCC_SPIRV_OP_FUNCTION                  = 54,
+  SCC_SPIRV_OP_FUNCTION_PARAMETER        = 55,
+  SCC_SPIRV_OP_FUNCTION_END              = 56,
+  SCC_SPIRV_OP_FUNCTION_CALL             = 57,
+  SCC_SPIRV_OP_VARIABLE                  = 59,
+  SCC_SPIRV_OP_LOAD                      = 61,
+  SCC_SPIRV_OP_STORE                     = 62,
+  SCC_SPIRV_OP_ACCESS_CHAIN              = 65,
+  SCC_SPIRV_OP_DECORATE                  = 71,
+  SCC_SPIRV_OP_MEMBER_DECORATE           = 72,
+  SCC_SPIRV_OP_VECTOR_SHUFFLE            = 79,
+  SCC_SPIRV_OP_COMPOSITE_CONSTRUCT       = 80,
+  SCC_SPIRV_OP_COMPOSITE_EXTRACT         = 81,
+  SCC_SPIRV_OP_COPY_OBJECT               = 83,
+  SCC_SPIRV_OP_TRANSPOSE                 = 84,
+  SCC_SPIRV_OP_IMAGE_SAMPLE_IMPLICIT_LOD = 87,
+  SCC_SPIRV_OP_IMAGE_SAMPLE_EXPLICIT_LOD = 88,
+  SCC_SPIRV_OP_IMAGE_GATHER              = 96,
+  SCC_SPIRV_OP_U_CONVERT                 = 113,
+  SCC_SPIRV_OP_S_CONVERT                 = 114,
+  SCC_SPIRV_OP_F_CONVERT                 = 115,
+  SCC_SPIRV_OP_I_ADD                     = 128,
+  SCC_SPIRV_OP_F_ADD                     = 129,
+  SCC_SPIRV_OP_I_SUB                     = 130,
+  SCC_SPIRV_OP_F_SUB                     = 131,
+  SCC_SPIRV_OP_I_MUL                     = 132,
+  SCC_SPIRV_OP_F_MUL                     = 133,
+  SCC_SPIRV_OP_U_DIV                     = 134,
+  SCC_SPIRV_OP_S_DIV                     = 135,
+  SCC_SPIRV_OP_F_DIV                     = 136,
+  SCC_SPIRV_OP_MATRIX_TIMES_SCALAR       = 143,
+  SCC_SPIRV_OP_VECTOR_TIMES_MATRIX       = 144,
+  SCC_SPIRV_OP_MATRIX_TIMES_VECTOR       = 145,
+  SCC_SPIRV_OP_MATRIX_TIMES_MATRIX       = 146,
+  SCC_SPIRV_OP_DOT                       = 148,
+  SCC_SPIRV_OP_LOGICAL_EQUAL             = 164,
+  SCC_SPIRV_OP_LOGICAL_NOT_EQUAL         = 165,
+  SCC_SPIRV_OP_SELECT                    = 169,
+  SCC_SPIRV_OP_I_EQUAL                   = 170,
+  SCC_SPIRV_OP_I_NOT_EQUAL               = 171,
+  SCC_SPIRV_OP_U_GREATER_THAN            = 172,
+  SCC_SPIRV_OP_S_GREATER_THAN            = 173,
+  SCC_SPIRV_OP_U_GREATER_THAN_EQUAL      = 174,
+  SCC_SPIRV_OP_S_GREATER_THAN_EQUAL      = 175,
+  SCC_SPIRV_OP_U_LESS_THAN               = 176,
+  SCC_SPIRV_OP_S_LESS_THAN               = 177,
+  SCC_SPIRV_OP_U_LESS_THAN_EQUAL         = 178,
+  SCC_SPIRV_OP_S_LESS_THAN_EQUAL         = 179,
+  SCC_SPIRV_OP_F_ORD_EQUAL               = 180,
+  SCC_SPIRV_OP_F_UNORD_NOT_EQUAL         = 183,
+  SCC_SPIRV_OP_F_ORD_LESS_THAN           = 184,
+  SCC_SPIRV_OP_F_ORD_GREATER_THAN        = 186,
+  SCC_SPIRV_OP_F_ORD_LESS_THAN_EQUAL     = 188,
+  SCC_SPIRV_OP_F_ORD_GREATER_THAN_EQUAL  = 190,
+  SCC_SPIRV_OP_PHI                       = 245,
+  SCC_SPIRV_OP_LOOP_MERGE                = 246,
+  SCC_SPIRV_OP_SELECTION_MERGE           = 247,
+  SCC_SPIRV_OP_LABEL                     = 248,
+  SCC_SPIRV_OP_BRANCH                    = 249,
+  SCC_SPIRV_OP_BRANCH_CONDITIONAL        = 250,
+  SCC_SPIRV_OP_SWITCH                    = 251,
+  SCC_SPIRV_OP_RETURN                    = 253,
+  SCC_SPIRV_OP_RETURN_VALUE              = 254,
+  SCC_SPIRV_OP_UNREACHABLE               = 255,
+  SCC_SPIRV_OP_DEMOTE                    = 5380
+} scc_spirv_op_t;
+
+// Instructions of GLSL.std.450 used.
+typedef enum scc_spirv_extended {
+  SCC_SPIRV_FABS           = 4,
+  SCC_SPIRV_SABS           = 5,
+  SCC_SPIRV_FLOOR          = 8,
+  SCC_SPIRV_CEIL           = 9,
+  SCC_SPIRV_SIN            = 13,
+  SCC_SPIRV_COS            = 14,
+  SCC_SPIRV_TAN            = 15,
+  SCC_SPIRV_ASIN           = 16,
+  SCC_SPIRV_ACOS           = 17,
+  SCC_SPIRV_ATAN           = 18,
+  SCC_SPIRV_SINH           = 19,
+  SCC_SPIRV_COSH           = 20,
+  SCC_SPIRV_TANH           = 21,
+  SCC_SPIRV_ATAN2          = 25,
+  SCC_SPIRV_POW            = 26,
+  SCC_SPIRV_EXP            = 27,
+  SCC_SPIRV_LOG            = 28,
+  SCC_SPIRV_EXP2           = 29,
+  SCC_SPIRV_LOG2           = 30,
+  SCC_SPIRV_SQRT           = 31,
+  SCC_SPIRV_INVERSE_SQRT   = 32,
+  SCC_SPIRV_DETERMINANT    = 33,
+  SCC_SPIRV_MATRIX_INVERSE = 34,
+  SCC_SPIRV_FMIN           = 37,
+  SCC_SPIRV_UMIN           = 38,
+  SCC_SPIRV_SMIN           = 39,
+  SCC_SPIRV_FMAX           = 40,
+  SCC_SPIRV_UMAX           = 41,
+  SCC_SPIRV_SMAX           = 42,
+  SCC_SPIRV_FCLAMP         = 43,
+  SCC_SPIRV_UCLAMP         = 44,
+  SCC_SPIRV_SCLAMP         = 45,
+  SCC_SPIRV_FMA            = 50,
+  SCC_SPIRV_LENGTH         = 66,
+  SCC_SPIRV_DISTANCE       = 67,
+  SCC_SPIRV_CROSS          = 68,
+  SCC_SPIRV_NORMALIZE      = 69,
+  SCC_SPIRV_REFLECT        = 71,
+  SCC_SPIRV_REFRACT        = 72
+} scc_spirv_extended_t;
+
+typedef enum scc_spirv_storage {
+  SCC_SPIRV_UNIFORM_CONSTANT = 0,
+  SCC_SPIRV_INPUT            = 1,
+  SCC_SPIRV_UNIFORM          = 2,
+  SCC_SPIRV_OUTPUT           = 3,
+  SCC_SPIRV_FUNCTION         = 7
+} scc_spirv_storage_t;
+
+typedef enum scc_spirv_decoration {
+  SCC_SPIRV_BLOCK          = 2,
+  SCC_SPIRV_COLUMN_MAJOR   = 5,
+  SCC_SPIRV_MATRIX_STRIDE  = 7,
+  SCC_SPIRV_BUILTIN        = 11,
+  SCC_SPIRV_FLAT           = 14,
+  SCC_SPIRV_LOCATION       = 30,
+  SCC_SPIRV_BINDING        = 33,
+  SCC_SPIRV_DESCRIPTOR_SET = 34,
+  SCC_SPIRV_OFFSET         = 35
+} scc_spirv_decoration_t;
+
+// Capabilities needed beyond `Shader`, as bits.
+typedef enum scc_spirv_feature {
+  SCC_SPIRV_FLOAT64   = (1 << 0),
+  SCC_SPIRV_INT64     = (1 << 1),
+  SCC_SPIRV_INT16     = (1 << 2),
+  SCC_SPIRV_INT8      = (1 << 3),
+  SCC_SPIRV_SAMPLED1D = (1 << 4),
+  SCC_SPIRV_DEMOTE    = (1 << 5),
+
+  SCC_SPIRV_NUM_OF_FEATURES = 6
+} scc_spirv_feature_t;
+
+// Indexed by bit of `scc_spirv_feature_t`.
+static const scc_uint32_t SCC_SPIRV_CAPABILITIES[SCC_SPIRV_NUM_OF_FEATURES] = {
+  10, 11, 22, 39, 43, 5379
+};
+
+//===----------------------------------------------------------------------===//
+// Emitter
+//===----------------------------------------------------------------------===//
+
+typedef struct scc_spirv_section {
+  scc_uint32_t *words;
+  scc_uint32_t size;
+  scc_uint32_t capacity;
+} scc_spirv_section_t;
+
+// A block where control flow rejoins that the IR doesn't have, as SPIR-V
+// needs a block of its own to merge each construct at. Edges from blocks
+// dominated by `header` to `target` go through it instead, forwarding phis.
+typedef struct scc_spirv_join {
+  scc_uint32_t header;
+
+  // Block rejoined, or `SCC_IR_NONE` if it's never reached.
+  scc_uint32_t target;
+
+  scc_uint32_t label;
+
+  // First of the ids of phis forwarded to those of `target`, in order.
+  scc_uint32_t phis;
+
+  // Join passed through on the way to `target`, or `SCC_IR_NONE`.
+  scc_uint32_t parent;
+
+  // Next join with the same target, or `SCC_IR_NONE`.
+  scc_uint32_t next;
+} scc_spirv_join_t;
+
+typedef struct scc_spirv_emitter {
+  const scc_ir_module_t *module;
+  const scc_spirv_options_t *options;
+
+  // Lives as long as emission, and as long as a function, respectively.
+  scc_arena_t *arena;
+  scc_arena_t *scratch;
+
+  // Sections of the module after the header and capabilities, in order.
+  scc_spirv_section_t names;
+  scc_spirv_section_t decorations;
+  scc_spirv_section_t declarations;
+  scc_spirv_section_t code;
+
+  // Open-addressed hash table of types, constants and undefined values, as
+  // pairs of a hash and an offset into `declarations` plus one.
+  scc_uint32_t *declared;
+  scc_uint32_t capacity_of_declared;
+  scc_uint32_t num_of_declared;
+
+  // Next unused id.
+  scc_uint32_t bound;
+
+  // See `scc_spirv_feature_t`.
+  scc_uint32_t features;
+
+  // Imported GLSL.std.450.
+  scc_uint32_t extended;
+
+  // Indexed by function, structure, and global. Zero until declared.
+  scc_uint32_t *functions;
+  scc_uint32_t *structures;
+  scc_uint32_t *globals;
+
+  // Indexed by structure. Whether decorated as a block.
+  scc_bool_t *blocks;
+
+  // Indexed by global, the first of the variables in `fields` of a structure
+  // that's split into a variable per member, or `SCC_IR_NONE`.
+  scc_uint32_t *first_field;
+  scc_uint32_t *fields;
+
+  // Indexed by global. Member of loose constants in the block gathering them.
+  scc_uint32_t *loose;
+
+  // Indexed by global. Number of coordinates textures are sampled with.
+  scc_uint32_t *dimensions;
+
+  // Variables listed by the entry point.
+  scc_uint32_t *interface;
+  scc_uint32_t num_of_interface;
+
+  // Functions called, directly or not, by the entry point.
+  scc_uint32_t *order;
+  scc_uint32_t num_of_functions;
+
+  // Function being emitted.
+  const scc_ir_function_t *function;
+
+  // Indexed by instruction, argument, constant, and block.
+  scc_uint32_t *values;
+  scc_uint32_t *arguments;
+  scc_uint32_t *literals;
+  scc_uint32_t *labels;
+
+  scc_ir_cfg_t *cfg;
+  scc_ir_dominators_t *dominators;
+  scc_ir_dominators_t *post_dominators;
+  scc_ir_loops_t *loops;
+
+  // Indexed by loop. Sole block it exits to, or `SCC_IR_NONE` if it never
+  // exits, and its latch.
+  scc_uint32_t *exits;
+  scc_uint32_t *latches;
+
+  // Indexed by loop. Labels of the block split from its header after the
+  // `OpLoopMerge`, its continue target, and its merge.
+  scc_uint32_t *bodies;
+  scc_uint32_t *continues;
+  scc_uint32_t *merges;
+
+  // Indexed by block. Label of the merge declared before its branch, or zero.
+  scc_uint32_t *selections;
+
+  // Indexed by block. Whether it's the merge or continue target of a
+  // construct already.
+  scc_bool_t *claimed;
+
+  // Indexed by block, the first of the joins that target it, or
+  // `SCC_IR_NONE`.
+  scc_uint32_t *first_join;
+  scc_spirv_join_t *joins;
+  scc_uint32_t num_of_joins;
+
+  // Set if emitted as a loop around a switch, in which case every value used
+  // outside its block, and every phi, is kept in a variable.
+  scc_bool_t dispatched;
+
+  // Indexed by instruction. Variable it's kept in, or zero.
+  scc_uint32_t *variables;
+
+  // Block being emitted, where values defined are used as they are.
+  scc_uint32_t block;
+
+  // Variable holding the block being run.
+  scc_uint32_t selector;
+} scc_spirv_emitter_t;
+
+//===----------------------------------------------------------------------===//
+// Sections
+//===----------------------------------------------------------------------===//
+
+static void scc_spirv_reserve(scc_spirv_section_t *section,
+                              scc_uint32_t size) {
+  if (section->size + size <= section->capacity)
+    return;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_uint32_t capacity = section->capacity ? section->capacity : 1024;
+
+  while (capacity < section->size + size)
+    capacity *= 2;
+
+  scc_uint32_t *words = (scc_uint32_t *)heap->allocate(heap, capacity * sizeof(scc_uint32_t), 16);
+
+  if (section->words) {
+    memcpy(words, section->words, section->size * sizeof(scc_uint32_t));
+    heap->free(heap, (void *)section->words);
+  }
+
+  section->words = words;
+  section->capacity = capacity;
+}
+
+static void scc_spirv_release(scc_spirv_section_t *section) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (section->words)
+    heap->free(heap, (void *)section->words);
+}
+
+// Appends an instruction of `length` words, returning them with the first
+// filled in.
+static scc_uint32_t *scc_spirv_begin(scc_spirv_section_t *section,
+                                     scc_uint32_t op,
+                                     scc_uint32_t length) {
+  scc_spirv_reserve(section, length);
+
+  scc_uint32_t *words = &section->words[section->size];
+  words[0] = (length << 16) | op;
+
+  section->size += length;
+
+  return words;
+}
+
+static void scc_spirv_op(scc_spirv_section_t *section,
+                         scc_uint32_t op,
+                         const scc_uint32_t *operands,
+                         scc_uint32_t num_of_operands) {
+  scc_uint32_t *words = scc_spirv_begin(section, op, num_of_operands + 1);
+
+  if (num_of_operands)
+    memcpy(&words[1], operands, num_of_operands * sizeof(scc_uint32_t));
+}
+
+// Appends `op` with `operands` followed by `string`, null-terminated and
+// padded to a word.
+static void scc_spirv_string(scc_spirv_section_t *section,
+                             scc_uint32_t op,
+                             const scc_uint32_t *operands,
+                             scc_uint32_t num_of_operands,
+                             const char *string) {
+  const scc_uint32_t length = (scc_uint32_t)strlen(string);
+  const scc_uint32_t num_of_words = length / 4 + 1;
+
+  scc_uint32_t *words = scc_spirv_begin(section, op, 1 + num_of_operands + num_of_words);
+
+  if (num_of_operands)
+    memcpy(&words[1], operands, num_of_operands * sizeof(scc_uint32_t));
+
+  words[num_of_operands + num_of_words] = 0;
+  memcpy(&words[1 + num_of_operands], string, length);
+}
+
+static void scc_spirv_name(scc_spirv_emitter_t *emitter,
+                           scc_uint32_t id,
+                           const char *name) {
+  if (emitter->options->strip || !name[0])
+    return;
+
+  scc_spirv_string(&emitter->names, SCC_SPIRV_OP_NAME, &id, 1, name);
+}
+
+static void scc_spirv_decorate(scc_spirv_emitter_t *emitter,
+                               scc_uint32_t id,
+                               scc_uint32_t decoration,
+                               scc_uint32_t value) {
+  const scc_uint32_t operands[] = { id, decoration, value };
+  scc_spirv_op(&emitter->decorations, SCC_SPIRV_OP_DECORATE, operands, (decoration == SCC_SPIRV_BLOCK) || (decoration == SCC_SPIRV_FLAT) || (decoration == SCC_SPIRV_COLUMN_MAJOR) ? 2 : 3);
+}
+
+static void scc_spirv_decorate_member(scc_spirv_emitter_t *emitter,
+                                      scc_uint32_t id,
+                                      scc_uint32_t member,
+                                      scc_uint32_t decoration,
+                                      scc_uint32_t value) {
+  const scc_uint32_t operands[] = { id, member, decoration, value };
+  scc_spirv_op(&emitter->decorations, SCC_SPIRV_OP_MEMBER_DECORATE, operands, (decoration == SCC_SPIRV_COLUMN_MAJOR) ? 3 : 4);
+}
+
+//===----------------------------------------------------------------------===//
+// Declarations
+//===----------------------------------------------------------------------===//
+
+static scc_uint32_t scc_spirv_hash(scc_uint32_t op,
+                                   scc_uint32_t type,
+                                   const scc_uint32_t *operands,
+                                   scc_uint32_t num_of_operands) {
+  scc_uint32_t hash = 2166136261u;
+
+  hash = (hash ^ op) * 16777619u;
+  hash = (hash ^ type) * 16777619u;
+
+  for (scc_uint32_t operand = 0; operand < num_of_operands; ++operand)
+    hash = (hash ^ operands[operand]) * 16777619u;
+
+  return hash;
+}
+
+static void scc_spirv_remember(scc_spirv_emitter_t *emitter,
+                               scc_uint32_t hash,
+                               scc_uint32_t offset) {
+  const scc_uint32_t mask = emitter->capacity_of_declared - 1;
+
+  scc_uint32_t slot = hash & mask;
+
+  while (emitter->declared[2 * slot + 1])
+    slot = (slot + 1) & mask;
+
+  emitter->declared[2 * slot + 0] = hash;
+  emitter->declared[2 * slot + 1] = offset + 1;
+
+  emitter->num_of_declared += 1;
+}
+
+// Declares `op` with `operands`, or finds it declared already. Types have no
+// `type`, while constants and undefined values do. Returns its id.
+static scc_uint32_t scc_spirv_declare(scc_spirv_emitter_t *emitter,
+                                      scc_uint32_t op,
+                                      scc_uint32_t type,
+                                      const scc_uint32_t *operands,
+                                      scc_uint32_t num_of_operands) {
+  const scc_uint32_t hash = scc_spirv_hash(op, type, operands, num_of_operands);
+
+  const scc_uint32_t prefix = type ? 3 : 2;
+  const scc_uint32_t header = ((prefix + num_of_operands) << 16) | op;
+
+  if (emitter->capacity_of_declared) {
+    const scc_uint32_t mask = emitter->capacity_of_declared - 1;
+
+    for (scc_uint32_t slot = hash & mask; emitter->declared[2 * slot + 1]; slot = (slot + 1) & mask) {
+      if (emitter->declared[2 * slot + 0] != hash)
+        continue;
+
+      const scc_uint32_t *words = &emitter->declarations.words[emitter->declared[2 * slot + 1] - 1];
+
+      if (words[0] != header)
+        continue;
+      if (type && (words[1] != type))
+        continue;
+      if (num_of_operands && (memcmp(&words[prefix], operands, num_of_operands * sizeof(scc_uint32_t)) != 0))
+        continue;
+
+      return words[prefix - 1];
+    }
+  }
+
+  // Kept at most half full.
+  if (2 * (emitter->num_of_declared + 1) > emitter->capacity_of_declared) {
+    scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+    scc_uint32_t *old = emitter->declared;
+    const scc_uint32_t old_capacity = emitter->capacity_of_declared;
+
+    emitter->capacity_of_declared = old_capacity ? 2 * old_capacity : 256;
+    emitter->declared = (scc_uint32_t *)heap->allocate(heap, 2 * emitter->capacity_of_declared * sizeof(scc_uint32_t), 16);
+    emitter->num_of_declared = 0;
+
+    for (scc_uint32_t slot = 0; slot < old_capacity; ++slot)
+      if (old[2 * slot + 1])
+        scc_spirv_remember(emitter, old[2 * slot + 0], old[2 * slot + 1] - 1);
+
+    if (old)
+      heap->free(heap, (void *)old);
+  }
+
+  const scc_uint32_t offset = emitter->declarations.size;
+  const scc_uint32_t id = emitter->bound++;
+
+  scc_uint32_t *words = scc_spirv_begin(&emitter->declarations, op, prefix + num_of_operands);
+
+  if (type)
+    words[1] = type;
+
+  words[prefix - 1] = id;
+
+  if (num_of_operands)
+    memcpy(&words[prefix], operands, num_of_operands * sizeof(scc_uint32_t));
+
+  scc_spirv_remember(emitter, hash, offset);
+
+  return id;
+}
+
+static scc_uint32_t scc_spirv_structure(scc_spirv_emitter_t *emitter,
+                                        scc_uint32_t index);
+
+static scc_uint32_t scc_spirv_type(scc_spirv_emitter_t *emitter,
+                                   scc_ir_type_t type) {
+  if (type.scalar == SCC_IR_VOID)
+    return scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_VOID, 0, NULL, 0);
+
+  if (type.scalar == SCC_IR_STRUCTURE)
+    return scc_spirv_structure(emitter, type.structure);
+
+  scc_uint32_t scalar;
+
+  if (type.scalar == SCC_IR_BOOL) {
+    scalar = scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_BOOL, 0, NULL, 0);
+  } else {
+    const scc_uint32_t width = 8 * scc_ir_scalar_size(type);
+
+    if (scc_ir_type_is_floating_point(type)) {
+      scalar = scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_FLOAT, 0, &width, 1);
+    } else {
+      const scc_uint32_t operands[] = { width, scc_ir_type_is_signed(type) ? 1u : 0u };
+      scalar = scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_INT, 0, operands, 2);
+    }
+
+    switch (width) {
+      case 8: emitter->features |= SCC_SPIRV_INT8; break;
+      case 16: emitter->features |= SCC_SPIRV_INT16; break;
+      case 64: emitter->features |= scc_ir_type_is_floating_point(type) ? SCC_SPIRV_FLOAT64 : SCC_SPIRV_INT64; break;
+    }
+  }
+
+  if (type.rows <= 1 && type.columns <= 1)
+    return scalar;
+
+  const scc_uint32_t column[] = { scalar, type.rows };
+  const scc_uint32_t vector = scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_VECTOR, 0, column, 2);
+
+  if (type.columns <= 1)
+    return vector;
+
+  const scc_uint32_t matrix[] = { vector, type.columns };
+  return scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_MATRIX, 0, matrix, 2);
+}
+
+static scc_uint32_t scc_spirv_pointer(scc_spirv_emitter_t *emitter,
+                                      scc_uint32_t storage,
+                                      scc_uint32_t type) {
+  const scc_uint32_t operands[] = { storage, type };
+  return scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_POINTER, 0, operands, 2);
+}
+
+// Rules constant buffers are laid out by, which only matter to how columns
+// of matrices are strided, as offsets are given.
+static scc_ir_packing_t scc_spirv_packing(const scc_spirv_emitter_t *emitter) {
+  if (emitter->options->packing == SCC_IR_PACKING_STD430)
+    return SCC_IR_PACKING_STD430;
+
+  return SCC_IR_PACKING_STD140;
+}
+
+// Decorates `member` of `id` as placed at `offset`, with matrices column
+// major.
+static void scc_spirv_place(scc_spirv_emitter_t *emitter,
+                            scc_uint32_t id,
+                            scc_uint32_t member,
+                            scc_ir_type_t type,
+                            scc_uint32_t offset) {
+  scc_spirv_decorate_member(emitter, id, member, SCC_SPIRV_OFFSET, offset);
+
+  if (scc_ir_type_is_matrix(type)) {
+    scc_spirv_decorate_member(emitter, id, member, SCC_SPIRV_COLUMN_MAJOR, 0);
+    scc_spirv_decorate_member(emitter, id, member, SCC_SPIRV_MATRIX_STRIDE, scc_ir_layout_stride(scc_spirv_packing(emitter), type));
+  }
+}
+
+// Structures are declared once each, rather than hash-consed, so those alike
+// can be decorated differently.
+static scc_uint32_t scc_spirv_structure(scc_spirv_emitter_t *emitter,
+                                        scc_uint32_t index) {
+  if (emitter->structures[index])
+    return emitter->structures[index];
+
+  const scc_ir_module_t *module = emitter->module;
+  const scc_ir_structure_t *structure = &module->structures[index];
+
+  scc_allocator_t *allocator = &emitter->arena->allocator;
+
+  scc_uint32_t *members =
+    (scc_uint32_t *)allocator->allocate(allocator, (structure->num_of_members + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t member = 0; member < structure->num_of_members; ++member)
+    members[member] = scc_spirv_type(emitter, module->members[structure->first_member + member].type);
+
+  const scc_uint32_t id = emitter->bound++;
+
+  scc_uint32_t *words = scc_spirv_begin(&emitter->declarations, SCC_SPIRV_OP_TYPE_STRUCT, 2 + structure->num_of_members);
+  words[1] = id;
+  memcpy(&words[2], members, structure->num_of_members * sizeof(scc_uint32_t));
+
+  scc_spirv_name(emitter, id, scc_ir_module_string(module, structure->name));
+
+  for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+    const scc_ir_member_t *def = &module->members[structure->first_member + member];
+
+    if (!emitter->options->strip) {
+      const scc_uint32_t operands[] = { id, member };
+      scc_spirv_string(&emitter->names, SCC_SPIRV_OP_MEMBER_NAME, operands, 2, scc_ir_module_string(module, def->name));
+    }
+
+    scc_spirv_place(emitter, id, member, def->type, def->offset);
+  }
+
+  emitter->structures[index] = id;
+
+  return id;
+}
+
+static scc_uint32_t scc_spirv_scalar(scc_spirv_emitter_t *emitter,
+                                     scc_uint32_t scalar,
+                                     scc_ir_component_t component) {
+  const scc_ir_type_t type = scc_ir_type(scalar, 1, 1);
+  const scc_uint32_t id = scc_spirv_type(emitter, type);
+
+  scc_uint32_t words[2];
+  scc_uint32_t num_of_words = 1;
+
+  switch (scalar) {
+    case SCC_IR_BOOL:
+      return scc_spirv_declare(emitter, component.u ? SCC_SPIRV_OP_CONSTANT_TRUE : SCC_SPIRV_OP_CONSTANT_FALSE, id, NULL, 0);
+
+    // Narrower integers are held in the low bits, sign extended if signed.
+    case SCC_IR_I8: words[0] = (scc_uint32_t)(scc_int32_t)(scc_int8_t)component.i; break;
+    case SCC_IR_I16: words[0] = (scc_uint32_t)(scc_int32_t)(scc_int16_t)component.i; break;
+    case SCC_IR_I32: words[0] = (scc_uint32_t)(scc_int32_t)component.i; break;
+    case SCC_IR_U8: words[0] = (scc_uint32_t)(scc_uint8_t)component.u; break;
+    case SCC_IR_U16: words[0] = (scc_uint32_t)(scc_uint16_t)component.u; break;
+    case SCC_IR_U32: words[0] = (scc_uint32_t)component.u; break;
+
+    case SCC_IR_F32: {
+      const scc_float32_t value = (scc_float32_t)component.f;
+      memcpy(&words[0], &value, sizeof(value));
+    } break;
+
+    default:
+      // Low word first.
+      words[0] = (scc_uint32_t)(component.u & 0xffffffffu);
+      words[1] = (scc_uint32_t)(component.u >> 32);
+      num_of_words = 2;
+      break;
+  }
+
+  return scc_spirv_declare(emitter, SCC_SPIRV_OP_CONSTANT, id, words, num_of_words);
+}
+
+static scc_uint32_t scc_spirv_constant(scc_spirv_emitter_t *emitter,
+                                       const scc_ir_constant_t *constant) {
+  const scc_ir_type_t type = constant->type;
+
+  if (scc_ir_type_is_scalar(type))
+    return scc_spirv_scalar(emitter, type.scalar, constant->components[0]);
+
+  const scc_ir_type_t column = scc_ir_type_reshape(type, type.rows, 1);
+
+  scc_uint32_t columns[4];
+
+  for (scc_uint32_t c = 0; c < SCC_MAX((scc_uint32_t)type.columns, 1u); ++c) {
+    scc_uint32_t components[4];
+
+    for (scc_uint32_t r = 0; r < type.rows; ++r)
+      components[r] = scc_spirv_scalar(emitter, type.scalar, constant->components[c * type.rows + r]);
+
+    columns[c] = scc_spirv_declare(emitter, SCC_SPIRV_OP_CONSTANT_COMPOSITE, scc_spirv_type(emitter, column), components, type.rows);
+  }
+
+  if (type.columns <= 1)
+    return columns[0];
+
+  return scc_spirv_declare(emitter, SCC_SPIRV_OP_CONSTANT_COMPOSITE, scc_spirv_type(emitter, type), columns, type.columns);
+}
+
+// Constant of `type` with every component set to `value`.
+static scc_uint32_t scc_spirv_splat(scc_spirv_emitter_t *emitter,
+                                    scc_ir_type_t type,
+                                    scc_float64_t value) {
+  scc_ir_constant_t constant;
+  memset(&constant, 0, sizeof(constant));
+
+  constant.type = type;
+
+  for (scc_uint32_t component = 0; component < scc_ir_type_num_of_components(type); ++component) {
+    if (scc_ir_type_is_floating_point(type))
+      constant.components[component].f = value;
+    else if (scc_ir_type_is_signed(type))
+      constant.components[component].i = (scc_int64_t)value;
+    else
+      constant.components[component].u = (scc_uint64_t)value;
+  }
+
+  return scc_spirv_constant(emitter, &constant);
+}
+
+static scc_uint32_t scc_spirv_int(scc_spirv_emitter_t *emitter,
+                                  scc_uint32_t value) {
+  scc_ir_component_t component;
+  component.i = (scc_int64_t)value;
+  return scc_spirv_scalar(emitter, SCC_IR_I32, component);
+}
+
+static scc_uint32_t scc_spirv_uint(scc_spirv_emitter_t *emitter,
+                                   scc_uint32_t value) {
+  scc_ir_component_t component;
+  component.u = value;
+  return scc_spirv_scalar(emitter, SCC_IR_U32, component);
+}
+
+static scc_uint32_t scc_spirv_undefined(scc_spirv_emitter_t *emitter,
+                                        scc_ir_type_t type) {
+  return scc_spirv_declare(emitter, SCC_SPIRV_OP_UNDEF, scc_spirv_type(emitter, type), NULL, 0);
+}
+
+static scc_uint32_t scc_spirv_function_type(scc_spirv_emitter_t *emitter,
+                                            const scc_ir_function_t *function) {
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  scc_uint32_t *operands =
+    (scc_uint32_t *)allocator->allocate(allocator, (function->num_of_arguments + 1) * sizeof(scc_uint32_t), 16);
+
+  operands[0] = scc_spirv_type(emitter, function->return_type);
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument)
+    operands[1 + argument] = scc_spirv_type(emitter, function->arguments[argument].type);
+
+  return scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_FUNCTION, 0, operands, function->num_of_arguments + 1);
+}
+
+//===----------------------------------------------------------------------===//
+// Instructions
+//===----------------------------------------------------------------------===//
+
+// Writes `op` producing `result` of `type` to the function being emitted.
+static void scc_spirv_compute(scc_spirv_emitter_t *emitter,
+                              scc_uint32_t op,
+                              scc_uint32_t type,
+                              scc_uint32_t result,
+                              const scc_uint32_t *operands,
+                              scc_uint32_t num_of_operands) {
+  scc_uint32_t *words = scc_spirv_begin(&emitter->code, op, num_of_operands + 3);
+
+  words[1] = type;
+  words[2] = result;
+
+  if (num_of_operands)
+    memcpy(&words[3], operands, num_of_operands * sizeof(scc_uint32_t));
+}
+
+static void scc_spirv_unary(scc_spirv_emitter_t *emitter,
+                            scc_uint32_t op,
+                            scc_uint32_t type,
+                            scc_uint32_t result,
+                            scc_uint32_t a) {
+  scc_spirv_compute(emitter, op, type, result, &a, 1);
+}
+
+static void scc_spirv_binary(scc_spirv_emitter_t *emitter,
+                             scc_uint32_t op,
+                             scc_uint32_t type,
+                             scc_uint32_t result,
+                             scc_uint32_t a,
+                             scc_uint32_t b) {
+  const scc_uint32_t operands[] = { a, b };
+  scc_spirv_compute(emitter, op, type, result, operands, 2);
+}
+
+static void scc_spirv_call(scc_spirv_emitter_t *emitter,
+                           scc_uint32_t instruction,
+                           scc_uint32_t type,
+                           scc_uint32_t result,
+                           const scc_uint32_t *operands,
+                           scc_uint32_t num_of_operands) {
+  scc_uint32_t *words = scc_spirv_begin(&emitter->code, SCC_SPIRV_OP_EXT_INST, num_of_operands + 5);
+
+  words[1] = type;
+  words[2] = result;
+  words[3] = emitter->extended;
+  words[4] = instruction;
+
+  if (num_of_operands)
+    memcpy(&words[5], operands, num_of_operands * sizeof(scc_uint32_t));
+}
+
+// Calls `instruction` that only takes 16 and 32-bit floats, converting
+// doubles there and back.
+static void scc_spirv_call_narrowed(scc_spirv_emitter_t *emitter,
+                                    scc_uint32_t instruction,
+                                    scc_ir_type_t type,
+                                    scc_uint32_t result,
+                                    const scc_uint32_t *operands,
+                                    scc_uint32_t num_of_operands) {
+  if (type.scalar != SCC_IR_F64)
+    return scc_spirv_call(emitter, instruction, scc_spirv_type(emitter, type), result, operands, num_of_operands);
+
+  const scc_uint32_t narrow = scc_spirv_type(emitter, scc_ir_type(SCC_IR_F32, type.rows, type.columns));
+
+  scc_uint32_t narrowed[3];
+
+  for (scc_uint32_t operand = 0; operand < num_of_operands; ++operand)
+    scc_spirv_unary(emitter, SCC_SPIRV_OP_F_CONVERT, narrow, narrowed[operand] = emitter->bound++, operands[operand]);
+
+  const scc_uint32_t called = emitter->bound++;
+  scc_spirv_call(emitter, instruction, narrow, called, narrowed, num_of_operands);
+
+  scc_spirv_unary(emitter, SCC_SPIRV_OP_F_CONVERT, scc_spirv_type(emitter, type), result, called);
+}
+
+//===----------------------------------------------------------------------===//
+// Values
+//===----------------------------------------------------------------------===//
+
+// Whether instruction `index` is defined in `block` by the time it's used
+// there, so needn't be loaded. Phis are only ever stored.
+static scc_bool_t scc_spirv_is_local(const scc_ir_function_t *function,
+                                     scc_uint32_t index,
+                                     scc_uint32_t block) {
+  const scc_ir_instruction_t *instruction = &function->instructions[index];
+  return (instruction->block == block) && (instruction->op != SCC_IR_OPERATION_PHI);
+}
+
+// Id of `value`, of `type` if undefined.
+static scc_uint32_t scc_spirv_value(scc_spirv_emitter_t *emitter,
+                                    scc_ir_value_t value,
+                                    scc_ir_type_t type) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(value);
+
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      if (emitter->dispatched && emitter->variables[index] && !scc_spirv_is_local(function, index, emitter->block)) {
+        const scc_uint32_t loaded = emitter->bound++;
+        scc_spirv_unary(emitter, SCC_SPIRV_OP_LOAD, scc_spirv_type(emitter, function->instructions[index].type), loaded, emitter->variables[index]);
+        return loaded;
+      }
+      return emitter->values[index];
+
+    case SCC_IR_VALUE_ARGUMENT:
+      return emitter->arguments[index];
+
+    case SCC_IR_VALUE_CONSTANT:
+      if (!emitter->literals[index])
+        emitter->literals[index] = scc_spirv_constant(emitter, &function->constants[index]);
+      return emitter->literals[index];
+
+    default:
+      return scc_spirv_undefined(emitter, type);
+  }
+}
+
+static scc_ir_type_t scc_spirv_type_of(const scc_spirv_emitter_t *emitter,
+                                       scc_ir_value_t value,
+                                       scc_ir_type_t otherwise) {
+  if (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_UNDEFINED)
+    return otherwise;
+  return scc_ir_value_type(emitter->function, value);
+}
+
+// Id of `value` as `type`, splatting scalars to vectors and matrices.
+static scc_uint32_t scc_spirv_operand(scc_spirv_emitter_t *emitter,
+                                      scc_ir_value_t value,
+                                      scc_ir_type_t type) {
+  const scc_ir_type_t input = scc_spirv_type_of(emitter, value, type);
+
+  if (!scc_ir_type_is_scalar(input) || (type.scalar == SCC_IR_STRUCTURE) || scc_ir_type_is_scalar(type))
+    return scc_spirv_value(emitter, value, input);
+
+  const scc_ir_constant_t *constant = scc_ir_value_constant(emitter->function, value);
+
+  if (constant) {
+    scc_ir_constant_t splat;
+    splat.type = type;
+
+    for (scc_uint32_t component = 0; component < scc_ir_type_num_of_components(type); ++component)
+      splat.components[component] = constant->components[0];
+
+    return scc_spirv_constant(emitter, &splat);
+  }
+
+  const scc_uint32_t scalar = scc_spirv_value(emitter, value, input);
+
+  scc_uint32_t components[4] = { scalar, scalar, scalar, scalar };
+
+  const scc_uint32_t column = emitter->bound++;
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_CONSTRUCT, scc_spirv_type(emitter, scc_ir_type_reshape(type, type.rows, 1)), column, components, type.rows);
+
+  if (type.columns <= 1)
+    return column;
+
+  scc_uint32_t columns[4] = { column, column, column, column };
+
+  const scc_uint32_t matrix = emitter->bound++;
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_CONSTRUCT, scc_spirv_type(emitter, type), matrix, columns, type.columns);
+
+  return matrix;
+}
+
+// Id of a boolean that is true if `value` isn't zero.
+static scc_uint32_t scc_spirv_condition(scc_spirv_emitter_t *emitter,
+                                        scc_ir_value_t value) {
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t type = scc_spirv_type_of(emitter, value, boolean);
+
+  const scc_uint32_t id = scc_spirv_value(emitter, value, type);
+
+  if (type.scalar == SCC_IR_BOOL)
+    return id;
+
+  const scc_uint32_t result = emitter->bound++;
+
+  scc_spirv_binary(emitter, scc_ir_type_is_floating_point(type) ? SCC_SPIRV_OP_F_UNORD_NOT_EQUAL : SCC_SPIRV_OP_I_NOT_EQUAL,
+                   scc_spirv_type(emitter, boolean), result, id, scc_spirv_splat(emitter, type, 0.0));
+
+  return result;
+}
+
+//===----------------------------------------------------------------------===//
+// Operations
+//===----------------------------------------------------------------------===//
+
+// Comparisons of floats, signed and unsigned integers, indexed from `lt`.
+static const scc_uint32_t SCC_SPIRV_COMPARISONS[3][6] = {
+  { SCC_SPIRV_OP_F_ORD_LESS_THAN, SCC_SPIRV_OP_F_ORD_LESS_THAN_EQUAL, SCC_SPIRV_OP_F_ORD_EQUAL,
+    SCC_SPIRV_OP_F_UNORD_NOT_EQUAL, SCC_SPIRV_OP_F_ORD_GREATER_THAN, SCC_SPIRV_OP_F_ORD_GREATER_THAN_EQUAL },
+  { SCC_SPIRV_OP_S_LESS_THAN, SCC_SPIRV_OP_S_LESS_THAN_EQUAL, SCC_SPIRV_OP_I_EQUAL,
+    SCC_SPIRV_OP_I_NOT_EQUAL, SCC_SPIRV_OP_S_GREATER_THAN, SCC_SPIRV_OP_S_GREATER_THAN_EQUAL },
+  { SCC_SPIRV_OP_U_LESS_THAN, SCC_SPIRV_OP_U_LESS_THAN_EQUAL, SCC_SPIRV_OP_I_EQUAL,
+    SCC_SPIRV_OP_I_NOT_EQUAL, SCC_SPIRV_OP_U_GREATER_THAN, SCC_SPIRV_OP_U_GREATER_THAN_EQUAL }
+};
+
+// Picks between instructions for floats, signed and unsigned integers.
+static scc_uint32_t scc_spirv_pick(scc_ir_type_t type,
+                                   scc_uint32_t f,
+                                   scc_uint32_t s,
+                                   scc_uint32_t u) {
+  if (scc_ir_type_is_floating_point(type))
+    return f;
+  return scc_ir_type_is_signed(type) ? s : u;
+}
+
+// Applies `op` to `operands` of `input`, scalars or vectors, into `result` of
+// `type`, which differs from `input` only for comparisons.
+static void scc_spirv_component_wise(scc_spirv_emitter_t *emitter,
+                                     scc_uint32_t op,
+                                     scc_ir_type_t type,
+                                     scc_ir_type_t input,
+                                     const scc_uint32_t *operands,
+                                     scc_uint32_t result) {
+  const scc_uint32_t id = scc_spirv_type(emitter, type);
+  const scc_bool_t real = scc_ir_type_is_floating_point(input);
+
+  switch (op) {
+    case SCC_IR_OPERATION_ADD:
+      return scc_spirv_binary(emitter, real ? SCC_SPIRV_OP_F_ADD : SCC_SPIRV_OP_I_ADD, id, result, operands[0], operands[1]);
+    case SCC_IR_OPERATION_SUB:
+      return scc_spirv_binary(emitter, real ? SCC_SPIRV_OP_F_SUB : SCC_SPIRV_OP_I_SUB, id, result, operands[0], operands[1]);
+    case SCC_IR_OPERATION_MULTIPLY:
+      return scc_spirv_binary(emitter, real ? SCC_SPIRV_OP_F_MUL : SCC_SPIRV_OP_I_MUL, id, result, operands[0], operands[1]);
+    case SCC_IR_OPERATION_DIVIDE:
+      return scc_spirv_binary(emitter, scc_spirv_pick(input, SCC_SPIRV_OP_F_DIV, SCC_SPIRV_OP_S_DIV, SCC_SPIRV_OP_U_DIV), id, result, operands[0], operands[1]);
+
+    case SCC_IR_OPERATION_FMA: {
+      if (real)
+        return scc_spirv_call(emitter, SCC_SPIRV_FMA, id, result, operands, 3);
+
+      const scc_uint32_t product = emitter->bound++;
+      scc_spirv_binary(emitter, SCC_SPIRV_OP_I_MUL, id, product, operands[0], operands[1]);
+      return scc_spirv_binary(emitter, SCC_SPIRV_OP_I_ADD, id, result, product, operands[2]);
+    }
+
+    case SCC_IR_OPERATION_SQRT: return scc_spirv_call(emitter, SCC_SPIRV_SQRT, id, result, operands, 1);
+    case SCC_IR_OPERATION_RSQRT: return scc_spirv_call(emitter, SCC_SPIRV_INVERSE_SQRT, id, result, operands, 1);
+
+    case SCC_IR_OPERATION_SIN: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_SIN, type, result, operands, 1);
+    case SCC_IR_OPERATION_COS: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_COS, type, result, operands, 1);
+    case SCC_IR_OPERATION_TAN: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_TAN, type, result, operands, 1);
+    case SCC_IR_OPERATION_SINH: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_SINH, type, result, operands, 1);
+    case SCC_IR_OPERATION_COSH: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_COSH, type, result, operands, 1);
+    case SCC_IR_OPERATION_TANH: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_TANH, type, result, operands, 1);
+    case SCC_IR_OPERATION_ASIN: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_ASIN, type, result, operands, 1);
+    case SCC_IR_OPERATION_ACOS: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_ACOS, type, result, operands, 1);
+    case SCC_IR_OPERATION_ATAN: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_ATAN, type, result, operands, 1);
+    case SCC_IR_OPERATION_ATAN2: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_ATAN2, type, result, operands, 2);
+    case SCC_IR_OPERATION_POW: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_POW, type, result, operands, 2);
+    case SCC_IR_OPERATION_EXP: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_EXP, type, result, operands, 1);
+    case SCC_IR_OPERATION_EXP2: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_EXP2, type, result, operands, 1);
+    case SCC_IR_OPERATION_LOG2: return scc_spirv_call_narrowed(emitter, SCC_SPIRV_LOG2, type, result, operands, 1);
+
+    case SCC_IR_OPERATION_EXP10: {
+      // As 2 to the power of x log2(10).
+      const scc_uint32_t scaled = emitter->bound++;
+      scc_spirv_binary(emitter, SCC_SPIRV_OP_F_MUL, id, scaled, operands[0], scc_spirv_splat(emitter, type, 3.32192809488736234787));
+      return scc_spirv_call_narrowed(emitter, SCC_SPIRV_EXP2, type, result, &scaled, 1);
+    }
+
+    case SCC_IR_OPERATION_LOG: {
+      // Base is first.
+      const scc_uint32_t logs[] = { emitter->bound++, emitter->bound++ };
+      scc_spirv_call_narrowed(emitter, SCC_SPIRV_LOG2, type, logs[0], &operands[1], 1);
+      scc_spirv_call_narrowed(emitter, SCC_SPIRV_LOG2, type, logs[1], &operands[0], 1);
+      return scc_spirv_binary(emitter, SCC_SPIRV_OP_F_DIV, id, result, logs[0], logs[1]);
+    }
+
+    case SCC_IR_OPERATION_LOG10: {
+      // As log2(x) log10(2).
+      const scc_uint32_t log = emitter->bound++;
+      scc_spirv_call_narrowed(emitter, SCC_SPIRV_LOG2, type, log, operands, 1);
+      return scc_spirv_binary(emitter, SCC_SPIRV_OP_F_MUL, id, result, log, scc_spirv_splat(emitter, type, 0.30102999566398119521));
+    }
+
+    case SCC_IR_OPERATION_ABS:
+      if (scc_ir_type_is_unsigned(type))
+        return scc_spirv_unary(emitter, SCC_SPIRV_OP_COPY_OBJECT, id, result, operands[0]);
+      return scc_spirv_call(emitter, real ? SCC_SPIRV_FABS : SCC_SPIRV_SABS, id, result, operands, 1);
+
+    case SCC_IR_OPERATION_FLOOR:
+    case SCC_IR_OPERATION_CEIL:
+      if (!real)
+        return scc_spirv_unary(emitter, SCC_SPIRV_OP_COPY_OBJECT, id, result, operands[0]);
+      return scc_spirv_call(emitter, (op == SCC_IR_OPERATION_FLOOR) ? SCC_SPIRV_FLOOR : SCC_SPIRV_CEIL, id, result, operands, 1);
+
+    case SCC_IR_OPERATION_MIN:
+      return scc_spirv_call(emitter, scc_spirv_pick(type, SCC_SPIRV_FMIN, SCC_SPIRV_SMIN, SCC_SPIRV_UMIN), id, result, operands, 2);
+    case SCC_IR_OPERATION_MAX:
+      return scc_spirv_call(emitter, scc_spirv_pick(type, SCC_SPIRV_FMAX, SCC_SPIRV_SMAX, SCC_SPIRV_UMAX), id, result, operands, 2);
+    case SCC_IR_OPERATION_CLAMP:
+      return scc_spirv_call(emitter, scc_spirv_pick(type, SCC_SPIRV_FCLAMP, SCC_SPIRV_SCLAMP, SCC_SPIRV_UCLAMP), id, result, operands, 3);
+
+    case SCC_IR_OPERATION_SATURATE: {
+      const scc_uint32_t bounds[] = { operands[0], scc_spirv_splat(emitter, type, 0.0), scc_spirv_splat(emitter, type, 1.0) };
+      return scc_spirv_call(emitter, scc_spirv_pick(type, SCC_SPIRV_FCLAMP, SCC_SPIRV_SCLAMP, SCC_SPIRV_UCLAMP), id, result, bounds, 3);
+    }
+
+    case SCC_IR_OPERATION_LESS:
+    case SCC_IR_OPERATION_LESS_OR_EQUAL:
+    case SCC_IR_OPERATION_EQUAL:
+    case SCC_IR_OPERATION_NOT_EQUAL:
+    case SCC_IR_OPERATION_GREATER:
+    case SCC_IR_OPERATION_GREATER_OR_EQUAL: {
+      const scc_uint32_t comparison = op - SCC_IR_OPERATION_LESS;
+
+      if (input.scalar != SCC_IR_BOOL) {
+        const scc_uint32_t kind = real ? 0 : (scc_ir_type_is_signed(input) ? 1 : 2);
+        return scc_spirv_binary(emitter, SCC_SPIRV_COMPARISONS[kind][comparison], id, result, operands[0], operands[1]);
+      }
+
+      if (op == SCC_IR_OPERATION_EQUAL)
+        return scc_spirv_binary(emitter, SCC_SPIRV_OP_LOGICAL_EQUAL, id, result, operands[0], operands[1]);
+      if (op == SCC_IR_OPERATION_NOT_EQUAL)
+        return scc_spirv_binary(emitter, SCC_SPIRV_OP_LOGICAL_NOT_EQUAL, id, result, operands[0], operands[1]);
+
+      // Booleans are ordered as zero and one.
+      const scc_ir_type_t numeric = scc_ir_type(SCC_IR_U32, input.rows, 1);
+
+      scc_uint32_t converted[2];
+
+      for (scc_uint32_t operand = 0; operand < 2; ++operand) {
+        const scc_uint32_t select[] = { operands[operand], scc_spirv_splat(emitter, numeric, 1.0), scc_spirv_splat(emitter, numeric, 0.0) };
+        scc_spirv_compute(emitter, SCC_SPIRV_OP_SELECT, scc_spirv_type(emitter, numeric), converted[operand] = emitter->bound++, select, 3);
+      }
+
+      return scc_spirv_binary(emitter, SCC_SPIRV_COMPARISONS[2][comparison], id, result, converted[0], converted[1]);
+    }
+  }
+}
+
+// Applies a component-wise `instruction`, a column at a time to matrices.
+static void scc_spirv_arithmetic(scc_spirv_emitter_t *emitter,
+                                 const scc_ir_instruction_t *instruction,
+                                 scc_uint32_t result) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_ir_type_t type = instruction->type;
+
+  // Comparisons differ in type from their inputs.
+  scc_ir_type_t input = type;
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+    if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_UNDEFINED)
+      input = scc_ir_type_reshape(scc_ir_value_type(function, operands[operand]), type.rows, type.columns);
+
+  scc_uint32_t ids[3];
+
+  if (!scc_ir_type_is_matrix(type)) {
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+      ids[operand] = scc_spirv_operand(emitter, operands[operand], input);
+
+    return scc_spirv_component_wise(emitter, instruction->op, type, input, ids, result);
+  }
+
+  const scc_ir_type_t column = scc_ir_type_reshape(type, type.rows, 1);
+  const scc_ir_type_t input_column = scc_ir_type_reshape(input, type.rows, 1);
+
+  scc_bool_t whole[3];
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    whole[operand] = scc_ir_type_is_matrix(scc_spirv_type_of(emitter, operands[operand], input));
+    ids[operand] = scc_spirv_operand(emitter, operands[operand], whole[operand] ? input : input_column);
+  }
+
+  scc_uint32_t columns[4];
+
+  for (scc_uint32_t c = 0; c < type.columns; ++c) {
+    scc_uint32_t parts[3];
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (!whole[operand]) {
+        parts[operand] = ids[operand];
+        continue;
+      }
+
+      const scc_uint32_t extract[] = { ids[operand], c };
+      scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_EXTRACT, scc_spirv_type(emitter, input_column), parts[operand] = emitter->bound++, extract, 2);
+    }
+
+    scc_spirv_component_wise(emitter, instruction->op, column, input_column, parts, columns[c] = emitter->bound++);
+  }
+
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_CONSTRUCT, scc_spirv_type(emitter, type), result, columns, type.columns);
+}
+
+// Writes a product involving a matrix.
+static void scc_spirv_product(scc_spirv_emitter_t *emitter,
+                              const scc_ir_instruction_t *instruction,
+                              scc_uint32_t result) {
+  const scc_ir_function_t *function = emitter->function;
+
+  const scc_ir_value_t a = scc_ir_operand(function, instruction, 0);
+  const scc_ir_value_t b = scc_ir_operand(function, instruction, 1);
+
+  const scc_ir_type_t ta = scc_spirv_type_of(emitter, a, instruction->type);
+  const scc_ir_type_t tb = scc_spirv_type_of(emitter, b, instruction->type);
+
+  const scc_uint32_t type = scc_spirv_type(emitter, instruction->type);
+
+  const scc_uint32_t x = scc_spirv_value(emitter, a, ta);
+  const scc_uint32_t y = scc_spirv_value(emitter, b, tb);
+
+  if (scc_ir_type_is_matrix(ta) && scc_ir_type_is_matrix(tb))
+    return scc_spirv_binary(emitter, SCC_SPIRV_OP_MATRIX_TIMES_MATRIX, type, result, x, y);
+  if (scc_ir_type_is_matrix(ta) && scc_ir_type_is_vector(tb))
+    return scc_spirv_binary(emitter, SCC_SPIRV_OP_MATRIX_TIMES_VECTOR, type, result, x, y);
+  if (scc_ir_type_is_vector(ta) && scc_ir_type_is_matrix(tb))
+    return scc_spirv_binary(emitter, SCC_SPIRV_OP_VECTOR_TIMES_MATRIX, type, result, x, y);
+  if (scc_ir_type_is_matrix(ta))
+    return scc_spirv_binary(emitter, SCC_SPIRV_OP_MATRIX_TIMES_SCALAR, type, result, x, y);
+
+  scc_spirv_binary(emitter, SCC_SPIRV_OP_MATRIX_TIMES_SCALAR, type, result, y, x);
+}
+
+// Writes the dot product of `a` and `b`, of `input`, into `result`.
+static void scc_spirv_dot(scc_spirv_emitter_t *emitter,
+                          scc_ir_type_t input,
+                          scc_uint32_t a,
+                          scc_uint32_t b,
+                          scc_uint32_t result) {
+  const scc_bool_t real = scc_ir_type_is_floating_point(input);
+
+  const scc_uint32_t scalar = scc_spirv_type(emitter, scc_ir_type_reshape(input, 1, 1));
+
+  if (scc_ir_type_is_scalar(input))
+    return scc_spirv_binary(emitter, real ? SCC_SPIRV_OP_F_MUL : SCC_SPIRV_OP_I_MUL, scalar, result, a, b);
+
+  if (real)
+    return scc_spirv_binary(emitter, SCC_SPIRV_OP_DOT, scalar, result, a, b);
+
+  // Integers are multiplied then summed.
+  const scc_uint32_t product = emitter->bound++;
+  scc_spirv_binary(emitter, SCC_SPIRV_OP_I_MUL, scc_spirv_type(emitter, input), product, a, b);
+
+  scc_uint32_t sum = 0;
+
+  for (scc_uint32_t lane = 0; lane < input.rows; ++lane) {
+    const scc_uint32_t extract[] = { product, lane };
+    const scc_uint32_t component = emitter->bound++;
+
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_EXTRACT, scalar, component, extract, 2);
+
+    if (lane == 0) {
+      sum = component;
+      continue;
+    }
+
+    const scc_uint32_t next = (lane + 1 == input.rows) ? result : emitter->bound++;
+    scc_spirv_binary(emitter, SCC_SPIRV_OP_I_ADD, scalar, next, sum, component);
+    sum = next;
+  }
+}
+
+// Pointer to what `instruction` loads or stores, or zero for a structure
+// that's split into a variable per member, as a whole.
+static scc_uint32_t scc_spirv_location(scc_spirv_emitter_t *emitter,
+                                       const scc_ir_instruction_t *instruction) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(operands[0]);
+  const scc_ir_global_t *global = &module->globals[index];
+
+  const scc_bool_t addressed = (instruction->num_of_operands >= 2) && (SCC_IR_VALUE_KIND(operands[1]) == SCC_IR_VALUE_MEMBER);
+
+  if ((global->type.scalar == SCC_IR_STRUCTURE) && !addressed)
+    return (emitter->first_field[index] == SCC_IR_NONE) ? emitter->globals[index] : 0;
+
+  scc_uint32_t member;
+  scc_ir_type_t type;
+
+  if (global->type.scalar == SCC_IR_STRUCTURE) {
+    member = SCC_IR_VALUE_INDEX(operands[1]);
+
+    if (emitter->first_field[index] != SCC_IR_NONE)
+      return emitter->fields[emitter->first_field[index] + member];
+
+    type = module->members[module->structures[global->type.structure].first_member + member].type;
+  } else if (global->storage == SCC_IR_CONSTANT) {
+    member = emitter->loose[index];
+    type = global->type;
+  } else {
+    return emitter->globals[index];
+  }
+
+  const scc_uint32_t chain[] = { emitter->globals[index], scc_spirv_int(emitter, member) };
+  const scc_uint32_t pointer = emitter->bound++;
+
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_ACCESS_CHAIN, scc_spirv_pointer(emitter, SCC_SPIRV_UNIFORM, scc_spirv_type(emitter, type)), pointer, chain, 2);
+
+  return pointer;
+}
+
+static void scc_spirv_load(scc_spirv_emitter_t *emitter,
+                           const scc_ir_instruction_t *instruction,
+                           scc_uint32_t result) {
+  const scc_ir_module_t *module = emitter->module;
+
+  const scc_uint32_t type = scc_spirv_type(emitter, instruction->type);
+  const scc_uint32_t pointer = scc_spirv_location(emitter, instruction);
+
+  if (pointer)
+    return scc_spirv_unary(emitter, SCC_SPIRV_OP_LOAD, type, result, pointer);
+
+  // Gathered from a variable per member.
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(scc_ir_operand(emitter->function, instruction, 0));
+  const scc_ir_structure_t *structure = &module->structures[module->globals[index].type.structure];
+
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  scc_uint32_t *members =
+    (scc_uint32_t *)allocator->allocate(allocator, (structure->num_of_members + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t member = 0; member < structure->num_of_members; ++member)
+    scc_spirv_unary(emitter, SCC_SPIRV_OP_LOAD, scc_spirv_type(emitter, module->members[structure->first_member + member].type),
+                    members[member] = emitter->bound++, emitter->fields[emitter->first_field[index] + member]);
+
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_CONSTRUCT, type, result, members, structure->num_of_members);
+}
+
+static void scc_spirv_store(scc_spirv_emitter_t *emitter,
+                            const scc_ir_instruction_t *instruction) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_ir_function_t *function = emitter->function;
+
+  const scc_ir_value_t value = scc_ir_operand(function, instruction, instruction->num_of_operands - 1);
+  const scc_uint32_t pointer = scc_spirv_location(emitter, instruction);
+
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+  const scc_ir_global_t *global = &module->globals[index];
+
+  scc_ir_type_t type = global->type;
+
+  if ((instruction->num_of_operands >= 3) && (type.scalar == SCC_IR_STRUCTURE))
+    type = module->members[module->structures[type.structure].first_member + SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1))].type;
+
+  const scc_uint32_t id = scc_spirv_value(emitter, value, type);
+
+  if (pointer) {
+    const scc_uint32_t operands[] = { pointer, id };
+    return scc_spirv_op(&emitter->code, SCC_SPIRV_OP_STORE, operands, 2);
+  }
+
+  // Scattered to a variable per member.
+  const scc_ir_structure_t *structure = &module->structures[type.structure];
+
+  for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+    const scc_uint32_t extract[] = { id, member };
+    const scc_uint32_t extracted = emitter->bound++;
+
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_EXTRACT, scc_spirv_type(emitter, module->members[structure->first_member + member].type), extracted, extract, 2);
+
+    const scc_uint32_t operands[] = { emitter->fields[emitter->first_field[index] + member], extracted };
+    scc_spirv_op(&emitter->code, SCC_SPIRV_OP_STORE, operands, 2);
+  }
+}
+
+// Type of textures, sampled by `index`, as combined image samplers.
+static scc_uint32_t scc_spirv_texture(scc_spirv_emitter_t *emitter,
+                                      scc_uint32_t index) {
+  const scc_ir_global_t *global = &emitter->module->globals[index];
+
+  const scc_uint32_t dimensions = emitter->dimensions[index];
+
+  if (dimensions == 1)
+    emitter->features |= SCC_SPIRV_SAMPLED1D;
+
+  const scc_uint32_t image[] = {
+    scc_spirv_type(emitter, scc_ir_type_reshape(global->type, 1, 1)),
+    dimensions - 1, 0, 0, 0, 1, 0
+  };
+
+  const scc_uint32_t sampled = scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_IMAGE, 0, image, 7);
+
+  return scc_spirv_declare(emitter, SCC_SPIRV_OP_TYPE_SAMPLED_IMAGE, 0, &sampled, 1);
+}
+
+// Narrows the four components sampled, `texel`, to `type`.
+static void scc_spirv_narrow(scc_spirv_emitter_t *emitter,
+                             scc_ir_type_t type,
+                             scc_uint32_t texel,
+                             scc_uint32_t result) {
+  const scc_uint32_t id = scc_spirv_type(emitter, type);
+
+  if (type.rows == 4)
+    return scc_spirv_unary(emitter, SCC_SPIRV_OP_COPY_OBJECT, id, result, texel);
+
+  if (type.rows <= 1) {
+    const scc_uint32_t extract[] = { texel, 0 };
+    return scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_EXTRACT, id, result, extract, 2);
+  }
+
+  const scc_uint32_t shuffle[] = { texel, texel, 0, 1, 2 };
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_VECTOR_SHUFFLE, id, result, shuffle, 2 + type.rows);
+}
+
+static void scc_spirv_sample(scc_spirv_emitter_t *emitter,
+                             const scc_ir_instruction_t *instruction,
+                             scc_uint32_t result) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_ir_function_t *function = emitter->function;
+
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+  const scc_ir_global_t *global = &module->globals[index];
+
+  const scc_ir_value_t coordinates = scc_ir_operand(function, instruction, 1);
+
+  const scc_ir_type_t texel = scc_ir_type_reshape(global->type, 4, 1);
+  const scc_uint32_t type = scc_spirv_type(emitter, texel);
+
+  const scc_uint32_t image = emitter->bound++;
+  scc_spirv_unary(emitter, SCC_SPIRV_OP_LOAD, scc_spirv_texture(emitter, index), image, emitter->globals[index]);
+
+  const scc_uint32_t at = scc_spirv_value(emitter, coordinates, scc_ir_type(SCC_IR_F32, emitter->dimensions[index], 1));
+
+  const scc_uint32_t sampled = emitter->bound++;
+
+  if (instruction->op == SCC_IR_OPERATION_GATHER) {
+    const scc_ir_value_t component = scc_ir_operand(function, instruction, 2);
+    const scc_ir_constant_t *constant = scc_ir_value_constant(function, component);
+
+    scc_uint32_t selected;
+
+    if (constant) {
+      selected = scc_spirv_int(emitter, (scc_uint32_t)constant->components[0].u);
+    } else {
+      const scc_ir_type_t type_of_component = scc_spirv_type_of(emitter, component, scc_ir_type(SCC_IR_I32, 1, 1));
+
+      selected = scc_spirv_value(emitter, component, type_of_component);
+
+      if (scc_ir_scalar_size(type_of_component) != 4) {
+        const scc_ir_type_t word = scc_ir_type(scc_ir_type_is_signed(type_of_component) ? SCC_IR_I32 : SCC_IR_U32, 1, 1);
+        const scc_uint32_t converted = emitter->bound++;
+
+        scc_spirv_unary(emitter, scc_ir_type_is_signed(type_of_component) ? SCC_SPIRV_OP_S_CONVERT : SCC_SPIRV_OP_U_CONVERT,
+                        scc_spirv_type(emitter, word), converted, selected);
+
+        selected = converted;
+      }
+    }
+
+    const scc_uint32_t operands[] = { image, at, selected };
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_IMAGE_GATHER, type, sampled, operands, 3);
+  } else if (module->type == SCC_PIXEL_SHADER) {
+    const scc_uint32_t operands[] = { image, at };
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_IMAGE_SAMPLE_IMPLICIT_LOD, type, sampled, operands, 2);
+  } else {
+    // Only pixel shaders have derivatives to pick a level with.
+    const scc_uint32_t operands[] = { image, at, 0x2, scc_spirv_splat(emitter, scc_ir_type(SCC_IR_F32, 1, 1), 0.0) };
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_IMAGE_SAMPLE_EXPLICIT_LOD, type, sampled, operands, 4);
+  }
+
+  scc_spirv_narrow(emitter, instruction->type, sampled, result);
+}
+
+static void scc_spirv_swizzle(scc_spirv_emitter_t *emitter,
+                              const scc_ir_instruction_t *instruction,
+                              scc_uint32_t result) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  const scc_ir_type_t type = instruction->type;
+  const scc_ir_type_t input = scc_spirv_type_of(emitter, operands[0], type);
+
+  const scc_uint32_t mask = SCC_IR_VALUE_INDEX(operands[1]);
+  const scc_uint32_t id = scc_spirv_type(emitter, type);
+
+  if (scc_ir_type_is_scalar(input))
+    return scc_spirv_unary(emitter, SCC_SPIRV_OP_COPY_OBJECT, id, result, scc_spirv_operand(emitter, operands[0], type));
+
+  const scc_uint32_t vector = scc_spirv_value(emitter, operands[0], input);
+
+  if (type.rows <= 1) {
+    const scc_uint32_t extract[] = { vector, SCC_IR_SWIZZLE_LANE(mask, 0) };
+    return scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_EXTRACT, id, result, extract, 2);
+  }
+
+  scc_uint32_t shuffle[6] = { vector, vector };
+
+  for (scc_uint32_t lane = 0; lane < type.rows; ++lane)
+    shuffle[2 + lane] = SCC_IR_SWIZZLE_LANE(mask, lane);
+
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_VECTOR_SHUFFLE, id, result, shuffle, 2 + type.rows);
+}
+
+static void scc_spirv_compose(scc_spirv_emitter_t *emitter,
+                              const scc_ir_instruction_t *instruction,
+                              scc_uint32_t result) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  const scc_ir_type_t type = instruction->type;
+  const scc_ir_type_t scalar = scc_ir_type_reshape(type, 1, 1);
+
+  const scc_uint32_t id = scc_spirv_type(emitter, type);
+
+  if (!scc_ir_type_is_matrix(type)) {
+    scc_uint32_t constituents[4];
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+      constituents[operand] = scc_spirv_value(emitter, operands[operand], scalar);
+
+    if (instruction->num_of_operands == 1)
+      return scc_spirv_unary(emitter, SCC_SPIRV_OP_COPY_OBJECT, id, result, constituents[0]);
+
+    return scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_CONSTRUCT, id, result, constituents, instruction->num_of_operands);
+  }
+
+  // Matrices are constructed from columns, so components are gathered then
+  // regrouped.
+  scc_uint32_t components[16];
+  scc_uint32_t num_of_components = 0;
+
+  const scc_uint32_t scalar_id = scc_spirv_type(emitter, scalar);
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    const scc_ir_type_t input = scc_spirv_type_of(emitter, operands[operand], scalar);
+    const scc_uint32_t value = scc_spirv_value(emitter, operands[operand], input);
+
+    if (scc_ir_type_is_scalar(input)) {
+      components[num_of_components++] = value;
+      continue;
+    }
+
+    for (scc_uint32_t component = 0; component < scc_ir_type_num_of_components(input); ++component) {
+      const scc_uint32_t extract[] = { value, (input.columns > 1) ? component / input.rows : component, component % input.rows };
+      scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_EXTRACT, scalar_id, components[num_of_components++] = emitter->bound++, extract, (input.columns > 1) ? 3 : 2);
+    }
+  }
+
+  const scc_uint32_t column = scc_spirv_type(emitter, scc_ir_type_reshape(type, type.rows, 1));
+
+  scc_uint32_t columns[4];
+
+  for (scc_uint32_t c = 0; c < type.columns; ++c)
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_CONSTRUCT, column, columns[c] = emitter->bound++, &components[c * type.rows], type.rows);
+
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_COMPOSITE_CONSTRUCT, id, result, columns, type.columns);
+}
+
+static void scc_spirv_invoke(scc_spirv_emitter_t *emitter,
+                             const scc_ir_instruction_t *instruction,
+                             scc_uint32_t result) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(operands[0]);
+  const scc_ir_function_t *callee = emitter->module->functions[index];
+
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  scc_uint32_t *ids =
+    (scc_uint32_t *)allocator->allocate(allocator, instruction->num_of_operands * sizeof(scc_uint32_t), 16);
+
+  ids[0] = emitter->functions[index];
+
+  for (scc_uint32_t argument = 1; argument < instruction->num_of_operands; ++argument)
+    ids[argument] = scc_spirv_value(emitter, operands[argument], callee->arguments[argument - 1].type);
+
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_FUNCTION_CALL, scc_spirv_type(emitter, callee->return_type), result, ids, instruction->num_of_operands);
+}
+
+// Writes `instruction`, which is neither a phi nor a terminator.
+static void scc_spirv_statement(scc_spirv_emitter_t *emitter,
+                                scc_uint32_t i) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[i];
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_ir_type_t type = instruction->type;
+
+  const scc_ir_type_t input = (instruction->num_of_operands > 0)
+                            ? scc_spirv_type_of(emitter, operands[0], type)
+                            : type;
+
+  const scc_uint32_t result = emitter->values[i] ? emitter->values[i] : emitter->bound++;
+  const scc_uint32_t id = scc_spirv_type(emitter, type);
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_NOP:
+      return;
+
+    case SCC_IR_OPERATION_LOAD: scc_spirv_load(emitter, instruction, result); break;
+    case SCC_IR_OPERATION_STORE: scc_spirv_store(emitter, instruction); break;
+
+    case SCC_IR_OPERATION_SWIZZLE: scc_spirv_swizzle(emitter, instruction, result); break;
+    case SCC_IR_OPERATION_COMPOSE: scc_spirv_compose(emitter, instruction, result); break;
+
+    case SCC_IR_OPERATION_FETCH:
+    case SCC_IR_OPERATION_GATHER:
+      scc_spirv_sample(emitter, instruction, result);
+      break;
+
+    case SCC_IR_OPERATION_MULTIPLY:
+      if (scc_ir_type_is_matrix(input) || scc_ir_type_is_matrix(scc_spirv_type_of(emitter, operands[1], type)))
+        scc_spirv_product(emitter, instruction, result);
+      else
+        scc_spirv_arithmetic(emitter, instruction, result);
+      break;
+
+    case SCC_IR_OPERATION_DOT:
+      scc_spirv_dot(emitter, input, scc_spirv_value(emitter, operands[0], input), scc_spirv_operand(emitter, operands[1], input), result);
+      break;
+
+    case SCC_IR_OPERATION_LENGTH_SQUARED: {
+      const scc_uint32_t vector = scc_spirv_value(emitter, operands[0], input);
+      scc_spirv_dot(emitter, input, vector, vector, result);
+    } break;
+
+    case SCC_IR_OPERATION_MAGNITUDE:
+    case SCC_IR_OPERATION_LENGTH:
+    case SCC_IR_OPERATION_NORMALIZE:
+    case SCC_IR_OPERATION_INVERSE:
+    case SCC_IR_OPERATION_DETERMINANT: {
+      const scc_uint32_t operand = scc_spirv_value(emitter, operands[0], input);
+
+      const scc_uint32_t called = (instruction->op == SCC_IR_OPERATION_NORMALIZE) ? SCC_SPIRV_NORMALIZE
+                                : (instruction->op == SCC_IR_OPERATION_INVERSE) ? SCC_SPIRV_MATRIX_INVERSE
+                                : (instruction->op == SCC_IR_OPERATION_DETERMINANT) ? SCC_SPIRV_DETERMINANT
+                                : SCC_SPIRV_LENGTH;
+
+      scc_spirv_call(emitter, called, id, result, &operand, 1);
+    } break;
+
+    case SCC_IR_OPERATION_DISTANCE:
+    case SCC_IR_OPERATION_CROSS:
+    case SCC_IR_OPERATION_REFLECT:
+    case SCC_IR_OPERATION_REFRACT: {
+      const scc_uint32_t called = (instruction->op == SCC_IR_OPERATION_DISTANCE) ? SCC_SPIRV_DISTANCE
+                                : (instruction->op == SCC_IR_OPERATION_CROSS) ? SCC_SPIRV_CROSS
+                                : (instruction->op == SCC_IR_OPERATION_REFLECT) ? SCC_SPIRV_REFLECT
+                                : SCC_SPIRV_REFRACT;
+
+      // Ratio of indices of refraction is a scalar.
+      const scc_uint32_t ids[] = {
+        scc_spirv_operand(emitter, operands[0], input),
+        scc_spirv_operand(emitter, operands[1], input),
+        (instruction->num_of_operands > 2) ? scc_spirv_operand(emitter, operands[2], scc_ir_type_reshape(input, 1, 1)) : 0
+      };
+
+      scc_spirv_call(emitter, called, id, result, ids, instruction->num_of_operands);
+    } break;
+
+    case SCC_IR_OPERATION_TRANSPOSE:
+      scc_spirv_unary(emitter, SCC_SPIRV_OP_TRANSPOSE, id, result, scc_spirv_value(emitter, operands[0], input));
+      break;
+
+    case SCC_IR_OPERATION_CALL:
+      scc_spirv_invoke(emitter, instruction, result);
+      break;
+
+    case SCC_IR_OPERATION_DISCARD:
+      emitter->features |= SCC_SPIRV_DEMOTE;
+      scc_spirv_begin(&emitter->code, SCC_SPIRV_OP_DEMOTE, 1);
+      break;
+
+    default:
+      scc_spirv_arithmetic(emitter, instruction, result);
+      break;
+  }
+
+  if (emitter->dispatched && emitter->variables[i]) {
+    const scc_uint32_t store[] = { emitter->variables[i], result };
+    scc_spirv_op(&emitter->code, SCC_SPIRV_OP_STORE, store, 2);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Control Flow
+//===----------------------------------------------------------------------===//
+
+// Value `phi` takes when entered from `from`.
+static scc_ir_value_t scc_spirv_incoming(const scc_ir_function_t *function,
+                                         const scc_ir_instruction_t *phi,
+                                         scc_uint32_t from) {
+  const scc_ir_value_t *operands = scc_ir_operands(function, phi);
+
+  for (scc_uint32_t operand = 0; operand + 1 < phi->num_of_operands; operand += 2)
+    if (SCC_IR_VALUE_INDEX(operands[operand]) == from)
+      return operands[operand + 1];
+
+  return SCC_IR_VALUE(SCC_IR_VALUE_UNDEFINED, 0);
+}
+
+// Loop headed by `block`, or `SCC_IR_NONE`.
+static scc_uint32_t scc_spirv_headed(const scc_spirv_emitter_t *emitter,
+                                     scc_uint32_t block) {
+  const scc_ir_loops_t *loops = emitter->loops;
+  const scc_uint32_t loop = loops->innermost[block];
+
+  if ((loop != SCC_IR_NONE) && (loops->loops[loop].header == block))
+    return loop;
+
+  return SCC_IR_NONE;
+}
+
+// Label of the block edges from `block` leave, which is the one split from
+// it if it heads a loop.
+static scc_uint32_t scc_spirv_source(const scc_spirv_emitter_t *emitter,
+                                     scc_uint32_t block) {
+  const scc_uint32_t loop = scc_spirv_headed(emitter, block);
+
+  if (loop != SCC_IR_NONE)
+    return emitter->bodies[loop];
+
+  return emitter->labels[block];
+}
+
+// Join the edge from `from` to `to` goes through, or `SCC_IR_NONE`.
+static scc_uint32_t scc_spirv_join_of(const scc_spirv_emitter_t *emitter,
+                                      scc_uint32_t from,
+                                      scc_uint32_t to) {
+  const scc_ir_cfg_t *cfg = emitter->cfg;
+  const scc_ir_dominators_t *dominators = emitter->dominators;
+
+  // Back edges rejoin nothing.
+  if (cfg->position[to] <= cfg->position[from])
+    return SCC_IR_NONE;
+
+  scc_uint32_t deepest = SCC_IR_NONE;
+
+  for (scc_uint32_t join = emitter->first_join[to]; join != SCC_IR_NONE; join = emitter->joins[join].next) {
+    const scc_uint32_t header = emitter->joins[join].header;
+
+    if (!scc_ir_dominates(dominators, header, from))
+      continue;
+
+    if ((deepest == SCC_IR_NONE) || (dominators->pre[header] > dominators->pre[emitter->joins[deepest].header]))
+      deepest = join;
+  }
+
+  return deepest;
+}
+
+static scc_uint32_t scc_spirv_target(const scc_spirv_emitter_t *emitter,
+                                     scc_uint32_t from,
+                                     scc_uint32_t to) {
+  const scc_uint32_t join = scc_spirv_join_of(emitter, from, to);
+
+  if (join != SCC_IR_NONE)
+    return emitter->joins[join].label;
+
+  return emitter->labels[to];
+}
+
+// Adds a block where a construct headed by `header` rejoins at `target`,
+// returning its label.
+static scc_uint32_t scc_spirv_join(scc_spirv_emitter_t *emitter,
+                                   scc_uint32_t header,
+                                   scc_uint32_t target) {
+  const scc_ir_function_t *function = emitter->function;
+
+  scc_spirv_join_t *join = &emitter->joins[emitter->num_of_joins];
+
+  join->header = header;
+  join->target = target;
+  join->label = emitter->bound++;
+  join->phis = emitter->bound;
+  join->parent = SCC_IR_NONE;
+  join->next = SCC_IR_NONE;
+
+  if (target != SCC_IR_NONE) {
+    for (scc_uint32_t i = function->blocks[target].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+      if (function->instructions[i].op == SCC_IR_OPERATION_PHI)
+        emitter->bound += 1;
+
+    join->next = emitter->first_join[target];
+    emitter->first_join[target] = emitter->num_of_joins;
+  }
+
+  emitter->num_of_joins += 1;
+
+  return join->label;
+}
+
+// Whether a selection headed by `block` can merge at `merge`. Control has to
+// leave the blocks it dominates through `merge`, or by breaking out of or
+// continuing the loop it's in.
+static scc_bool_t scc_spirv_is_selection(scc_spirv_emitter_t *emitter,
+                                         scc_uint32_t block,
+                                         scc_uint32_t merge) {
+  const scc_ir_cfg_t *cfg = emitter->cfg;
+  const scc_ir_dominators_t *dominators = emitter->dominators;
+  const scc_ir_loops_t *loops = emitter->loops;
+
+  const scc_uint32_t loop = loops->innermost[block];
+
+  // Blocks past the merge aren't part of the selection.
+  const scc_uint32_t past = scc_ir_dominates(dominators, block, merge) ? merge : SCC_IR_NONE;
+
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  scc_uint32_t *stack =
+    (scc_uint32_t *)allocator->allocate(allocator, (cfg->num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t depth = 0;
+
+  stack[depth++] = block;
+
+  while (depth > 0) {
+    const scc_uint32_t from = stack[--depth];
+
+    const scc_uint32_t *successors = scc_ir_cfg_successors(cfg, from);
+    const scc_uint32_t num_of_successors = scc_ir_cfg_num_of_successors(cfg, from);
+
+    for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor) {
+      const scc_uint32_t to = successors[successor];
+
+      if (to == merge)
+        continue;
+
+      if (loop != SCC_IR_NONE) {
+        if (to == loops->loops[loop].header)
+          return SCC_FALSE;
+        if ((to == emitter->exits[loop]) || (to == emitter->latches[loop]))
+          continue;
+      }
+
+      if (!scc_ir_dominates(dominators, block, to))
+        return SCC_FALSE;
+      if ((past != SCC_IR_NONE) && scc_ir_dominates(dominators, past, to))
+        return SCC_FALSE;
+    }
+
+    const scc_uint32_t *children = scc_ir_dominators_children(dominators, from);
+    const scc_uint32_t num_of_children = scc_ir_dominators_num_of_children(dominators, from);
+
+    for (scc_uint32_t child = 0; child < num_of_children; ++child)
+      if (children[child] != past)
+        stack[depth++] = children[child];
+  }
+
+  return SCC_TRUE;
+}
+
+// Picks where the selection ending `block` merges, adding a block to do so if
+// need be. Returns false if there's nowhere it can.
+static scc_bool_t scc_spirv_select(scc_spirv_emitter_t *emitter,
+                                   scc_uint32_t block,
+                                   scc_uint32_t taken,
+                                   scc_uint32_t not_taken) {
+  const scc_ir_dominators_t *dominators = emitter->dominators;
+  const scc_ir_loops_t *loops = emitter->loops;
+
+  const scc_uint32_t loop = loops->innermost[block];
+
+  // Where every path rejoins, if it's within the loop.
+  const scc_uint32_t merge = emitter->post_dominators->idom[block];
+
+  const scc_bool_t inside = (merge != SCC_IR_NONE)
+                         && ((loop == SCC_IR_NONE) || (scc_ir_loop_contains(loops, loop, merge) && (merge != loops->loops[loop].header)));
+
+  if (inside && scc_spirv_is_selection(emitter, block, merge)) {
+    if (!emitter->claimed[merge] && scc_ir_dominates(dominators, block, merge)) {
+      emitter->selections[block] = emitter->labels[merge];
+      emitter->claimed[merge] = SCC_TRUE;
+    } else {
+      emitter->selections[block] = scc_spirv_join(emitter, block, merge);
+    }
+
+    return SCC_TRUE;
+  }
+
+  // Otherwise one arm can follow the other.
+  const scc_uint32_t arms[] = { not_taken, taken };
+
+  for (scc_uint32_t arm = 0; arm < 2; ++arm) {
+    const scc_uint32_t to = arms[arm];
+
+    if (emitter->claimed[to] || !scc_ir_dominates(dominators, block, to))
+      continue;
+    if ((loop != SCC_IR_NONE) && (to == loops->loops[loop].header))
+      continue;
+    if (!scc_spirv_is_selection(emitter, block, to))
+      continue;
+
+    emitter->selections[block] = emitter->labels[to];
+    emitter->claimed[to] = SCC_TRUE;
+
+    return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+// Works out merges and continue targets of the function being emitted.
+// Returns false if it can't be structured.
+static scc_bool_t scc_spirv_plan(scc_spirv_emitter_t *emitter) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_cfg_t *cfg = emitter->cfg;
+  const scc_ir_dominators_t *dominators = emitter->dominators;
+  const scc_ir_loops_t *loops = emitter->loops;
+
+  const scc_uint32_t entry = cfg->order[0];
+
+  for (scc_uint32_t predecessor = 0; predecessor < scc_ir_cfg_num_of_predecessors(cfg, entry); ++predecessor)
+    if (scc_ir_cfg_is_reachable(cfg, scc_ir_cfg_predecessors(cfg, entry)[predecessor]))
+      return SCC_FALSE;
+
+  for (scc_uint32_t loop = 0; loop < loops->num_of_loops; ++loop) {
+    const scc_ir_loop_t *def = &loops->loops[loop];
+
+    if (def->num_of_latches != 1)
+      return SCC_FALSE;
+
+    const scc_uint32_t latch = scc_ir_loop_latches(loops, loop)[0];
+
+    if ((latch != def->header) && (scc_spirv_headed(emitter, latch) != SCC_IR_NONE))
+      return SCC_FALSE;
+
+    emitter->latches[loop] = latch;
+
+    scc_uint32_t exit = SCC_IR_NONE;
+
+    const scc_uint32_t *blocks = scc_ir_loop_blocks(loops, loop);
+
+    for (scc_uint32_t block = 0; block < def->num_of_blocks; ++block) {
+      const scc_uint32_t *successors = scc_ir_cfg_successors(cfg, blocks[block]);
+      const scc_uint32_t num_of_successors = scc_ir_cfg_num_of_successors(cfg, blocks[block]);
+
+      for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor) {
+        if (scc_ir_loop_contains(loops, loop, successors[successor]))
+          continue;
+
+        if ((exit != SCC_IR_NONE) && (exit != successors[successor]))
+          return SCC_FALSE;
+
+        exit = successors[successor];
+      }
+    }
+
+    // Breaking out of several loops at once can't be expressed.
+    if ((exit != SCC_IR_NONE) && (def->parent != SCC_IR_NONE) && !scc_ir_loop_contains(loops, def->parent, exit))
+      return SCC_FALSE;
+
+    emitter->exits[loop] = exit;
+
+    const scc_uint32_t *successors = scc_ir_cfg_successors(cfg, latch);
+    const scc_uint32_t num_of_successors = scc_ir_cfg_num_of_successors(cfg, latch);
+
+    for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor)
+      if ((successors[successor] != def->header) && (successors[successor] != exit))
+        return SCC_FALSE;
+
+    emitter->claimed[latch] = SCC_TRUE;
+  }
+
+  // Edges back up the order have to be those of latches to their headers.
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    const scc_uint32_t *successors = scc_ir_cfg_successors(cfg, block);
+    const scc_uint32_t num_of_successors = scc_ir_cfg_num_of_successors(cfg, block);
+
+    for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor) {
+      if (cfg->position[successors[successor]] > position)
+        continue;
+
+      const scc_uint32_t loop = scc_spirv_headed(emitter, successors[successor]);
+
+      if ((loop == SCC_IR_NONE) || (emitter->latches[loop] != block))
+        return SCC_FALSE;
+    }
+  }
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+    const scc_uint32_t loop = scc_spirv_headed(emitter, block);
+
+    if (loop != SCC_IR_NONE) {
+      const scc_uint32_t latch = emitter->latches[loop];
+      const scc_uint32_t exit = emitter->exits[loop];
+
+      emitter->bodies[loop] = emitter->bound++;
+      emitter->continues[loop] = (latch == block) ? emitter->bodies[loop] : emitter->labels[latch];
+
+      if ((exit != SCC_IR_NONE) && !emitter->claimed[exit] && scc_ir_dominates(dominators, block, exit)) {
+        emitter->merges[loop] = emitter->labels[exit];
+        emitter->claimed[exit] = SCC_TRUE;
+      } else {
+        emitter->merges[loop] = scc_spirv_join(emitter, block, exit);
+      }
+    }
+
+    const scc_uint32_t terminator = scc_ir_block_terminator(function, block);
+
+    if ((terminator == SCC_IR_NONE) || (function->instructions[terminator].op != SCC_IR_OPERATION_BRANCH))
+      continue;
+
+    const scc_ir_instruction_t *instruction = &function->instructions[terminator];
+
+    const scc_uint32_t taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1));
+    const scc_uint32_t not_taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 2));
+
+    if (taken == not_taken)
+      continue;
+
+    // Breaking, continuing, and looping need no merge.
+    const scc_uint32_t innermost = loops->innermost[block];
+
+    if (innermost != SCC_IR_NONE) {
+      const scc_uint32_t latch = emitter->latches[innermost];
+      const scc_uint32_t exit = emitter->exits[innermost];
+
+      if ((block == latch) || (taken == latch) || (not_taken == latch) || (taken == exit) || (not_taken == exit))
+        continue;
+    }
+
+    if (!scc_spirv_select(emitter, block, taken, not_taken))
+      return SCC_FALSE;
+  }
+
+  // Joins nest, the deepest going through those enclosing them.
+  for (scc_uint32_t join = 0; join < emitter->num_of_joins; ++join) {
+    scc_spirv_join_t *def = &emitter->joins[join];
+
+    if (def->target == SCC_IR_NONE)
+      continue;
+
+    for (scc_uint32_t other = emitter->first_join[def->target]; other != SCC_IR_NONE; other = emitter->joins[other].next) {
+      const scc_uint32_t header = emitter->joins[other].header;
+
+      if ((header == def->header) || !scc_ir_dominates(dominators, header, def->header))
+        continue;
+
+      if ((def->parent == SCC_IR_NONE) || (dominators->pre[header] > dominators->pre[emitter->joins[def->parent].header]))
+        def->parent = other;
+    }
+  }
+
+  return SCC_TRUE;
+}
+
+// Writes phis of `block`, or those forwarding them in `join` unless it's
+// `SCC_IR_NONE`.
+static void scc_spirv_phis(scc_spirv_emitter_t *emitter,
+                           scc_uint32_t block,
+                           scc_uint32_t join) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_cfg_t *cfg = emitter->cfg;
+
+  const scc_uint32_t *predecessors = scc_ir_cfg_predecessors(cfg, block);
+  const scc_uint32_t num_of_predecessors = scc_ir_cfg_num_of_predecessors(cfg, block);
+
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  scc_uint32_t *pairs = NULL;
+
+  scc_uint32_t phi = 0;
+
+  for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (instruction->op != SCC_IR_OPERATION_PHI)
+      continue;
+
+    if (!pairs)
+      pairs = (scc_uint32_t *)allocator->allocate(allocator, 2 * (num_of_predecessors + emitter->num_of_joins + 1) * sizeof(scc_uint32_t), 16);
+
+    scc_uint32_t num_of_pairs = 0;
+
+    for (scc_uint32_t predecessor = 0; predecessor < num_of_predecessors; ++predecessor) {
+      const scc_uint32_t from = predecessors[predecessor];
+
+      if (!scc_ir_cfg_is_reachable(cfg, from))
+        continue;
+
+      scc_uint32_t through = scc_spirv_join_of(emitter, from, block);
+
+      scc_uint32_t value;
+      scc_uint32_t label;
+
+      if (through == join) {
+        value = scc_spirv_value(emitter, scc_spirv_incoming(function, instruction, from), instruction->type);
+        label = scc_spirv_source(emitter, from);
+      } else if (join == SCC_IR_NONE) {
+        // Comes through the outermost join.
+        while (emitter->joins[through].parent != SCC_IR_NONE)
+          through = emitter->joins[through].parent;
+
+        value = emitter->joins[through].phis + phi;
+        label = emitter->joins[through].label;
+      } else {
+        continue;
+      }
+
+      scc_bool_t seen = SCC_FALSE;
+
+      for (scc_uint32_t pair = 0; pair < num_of_pairs; ++pair)
+        seen |= (pairs[2 * pair + 1] == label);
+
+      if (seen)
+        continue;
+
+      pairs[2 * num_of_pairs + 0] = value;
+      pairs[2 * num_of_pairs + 1] = label;
+
+      num_of_pairs += 1;
+    }
+
+    if (join != SCC_IR_NONE) {
+      for (scc_uint32_t nested = emitter->first_join[block]; nested != SCC_IR_NONE; nested = emitter->joins[nested].next) {
+        if (emitter->joins[nested].parent != join)
+          continue;
+
+        pairs[2 * num_of_pairs + 0] = emitter->joins[nested].phis + phi;
+        pairs[2 * num_of_pairs + 1] = emitter->joins[nested].label;
+
+        num_of_pairs += 1;
+      }
+    }
+
+    const scc_uint32_t result = (join == SCC_IR_NONE) ? emitter->values[i] : emitter->joins[join].phis + phi;
+
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_PHI, scc_spirv_type(emitter, instruction->type), result, pairs, 2 * num_of_pairs);
+
+    phi += 1;
+  }
+}
+
+static void scc_spirv_label(scc_spirv_emitter_t *emitter,
+                            scc_uint32_t label) {
+  scc_spirv_op(&emitter->code, SCC_SPIRV_OP_LABEL, &label, 1);
+}
+
+static void scc_spirv_jump(scc_spirv_emitter_t *emitter,
+                           scc_uint32_t label) {
+  scc_spirv_op(&emitter->code, SCC_SPIRV_OP_BRANCH, &label, 1);
+}
+
+// Writes the return ending `block`, or the lack of a terminator, returning
+// false if it ends otherwise.
+static scc_bool_t scc_spirv_return(scc_spirv_emitter_t *emitter,
+                                   scc_uint32_t block) {
+  const scc_ir_function_t *function = emitter->function;
+
+  const scc_uint32_t terminator = (block != SCC_IR_NONE) ? scc_ir_block_terminator(function, block) : SCC_IR_NONE;
+
+  const scc_ir_instruction_t *instruction =
+    (terminator != SCC_IR_NONE) ? &function->instructions[terminator] : NULL;
+
+  if (instruction && (instruction->op != SCC_IR_OPERATION_RETURN))
+    return SCC_FALSE;
+
+  if (scc_ir_type_is_void(function->return_type)) {
+    scc_spirv_begin(&emitter->code, SCC_SPIRV_OP_RETURN, 1);
+    return SCC_TRUE;
+  }
+
+  const scc_ir_value_t value = (instruction && (instruction->num_of_operands > 0))
+                             ? scc_ir_operand(function, instruction, 0)
+                             : SCC_IR_VALUE(SCC_IR_VALUE_UNDEFINED, 0);
+
+  const scc_uint32_t id = scc_spirv_value(emitter, value, function->return_type);
+  scc_spirv_op(&emitter->code, SCC_SPIRV_OP_RETURN_VALUE, &id, 1);
+
+  return SCC_TRUE;
+}
+
+static void scc_spirv_terminate(scc_spirv_emitter_t *emitter,
+                                scc_uint32_t block) {
+  const scc_ir_function_t *function = emitter->function;
+
+  if (scc_spirv_return(emitter, block))
+    return;
+
+  const scc_ir_instruction_t *instruction = &function->instructions[scc_ir_block_terminator(function, block)];
+
+  if (instruction->op == SCC_IR_OPERATION_JUMP)
+    return scc_spirv_jump(emitter, scc_spirv_target(emitter, block, SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0))));
+
+  const scc_uint32_t taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1));
+  const scc_uint32_t not_taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 2));
+
+  if (taken == not_taken)
+    return scc_spirv_jump(emitter, scc_spirv_target(emitter, block, taken));
+
+  const scc_uint32_t condition = scc_spirv_condition(emitter, scc_ir_operand(function, instruction, 0));
+
+  if (emitter->selections[block]) {
+    const scc_uint32_t merge[] = { emitter->selections[block], 0 };
+    scc_spirv_op(&emitter->code, SCC_SPIRV_OP_SELECTION_MERGE, merge, 2);
+  }
+
+  const scc_uint32_t branch[] = {
+    condition,
+    scc_spirv_target(emitter, block, taken),
+    scc_spirv_target(emitter, block, not_taken)
+  };
+
+  scc_spirv_op(&emitter->code, SCC_SPIRV_OP_BRANCH_CONDITIONAL, branch, 3);
+}
+
+// Writes everything in `block` but phis and its terminator.
+static void scc_spirv_body(scc_spirv_emitter_t *emitter,
+                           scc_uint32_t block) {
+  const scc_ir_function_t *function = emitter->function;
+
+  for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if ((instruction->op == SCC_IR_OPERATION_PHI) || scc_ir_operation_is(instruction->op, SCC_IR_TERMINATOR))
+      continue;
+
+    scc_spirv_statement(emitter, i);
+  }
+}
+
+// Emits blocks in reverse post-order, each preceded by the joins that rejoin
+// at it, deepest first.
+static void scc_spirv_structured(scc_spirv_emitter_t *emitter) {
+  const scc_ir_cfg_t *cfg = emitter->cfg;
+  const scc_ir_dominators_t *dominators = emitter->dominators;
+
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  scc_uint32_t *nested =
+    (scc_uint32_t *)allocator->allocate(allocator, (emitter->num_of_joins + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    scc_uint32_t num_of_nested = 0;
+
+    for (scc_uint32_t join = emitter->first_join[block]; join != SCC_IR_NONE; join = emitter->joins[join].next) {
+      scc_uint32_t at = num_of_nested++;
+
+      for (; (at > 0) && (dominators->pre[emitter->joins[nested[at - 1]].header] < dominators->pre[emitter->joins[join].header]); --at)
+        nested[at] = nested[at - 1];
+
+      nested[at] = join;
+    }
+
+    for (scc_uint32_t join = 0; join < num_of_nested; ++join) {
+      const scc_spirv_join_t *def = &emitter->joins[nested[join]];
+
+      scc_spirv_label(emitter, def->label);
+      scc_spirv_phis(emitter, block, nested[join]);
+      scc_spirv_jump(emitter, (def->parent != SCC_IR_NONE) ? emitter->joins[def->parent].label : emitter->labels[block]);
+    }
+
+    scc_spirv_label(emitter, emitter->labels[block]);
+    scc_spirv_phis(emitter, block, SCC_IR_NONE);
+
+    const scc_uint32_t loop = scc_spirv_headed(emitter, block);
+
+    if (loop != SCC_IR_NONE) {
+      const scc_uint32_t merge[] = { emitter->merges[loop], emitter->continues[loop], 0 };
+      scc_spirv_op(&emitter->code, SCC_SPIRV_OP_LOOP_MERGE, merge, 3);
+
+      scc_spirv_jump(emitter, emitter->bodies[loop]);
+      scc_spirv_label(emitter, emitter->bodies[loop]);
+    }
+
+    scc_spirv_body(emitter, block);
+    scc_spirv_terminate(emitter, block);
+  }
+
+  // Merges of loops that never exit.
+  for (scc_uint32_t join = 0; join < emitter->num_of_joins; ++join) {
+    if (emitter->joins[join].target != SCC_IR_NONE)
+      continue;
+
+    scc_spirv_label(emitter, emitter->joins[join].label);
+    scc_spirv_begin(&emitter->code, SCC_SPIRV_OP_UNREACHABLE, 1);
+  }
+}
+
+// Stores what phis of `to` take when entered from `from`, into `pending`, as
+// pairs of a variable and a value. If `condition` is set, they're only taken
+// if it's `taken`.
+static scc_uint32_t scc_spirv_stage(scc_spirv_emitter_t *emitter,
+                                    scc_uint32_t from,
+                                    scc_uint32_t to,
+                                    scc_uint32_t condition,
+                                    scc_bool_t taken,
+                                    scc_uint32_t *pending) {
+  const scc_ir_function_t *function = emitter->function;
+
+  scc_uint32_t num_of_pending = 0;
+
+  for (scc_uint32_t i = function->blocks[to].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (instruction->op != SCC_IR_OPERATION_PHI)
+      continue;
+
+    const scc_uint32_t type = scc_spirv_type(emitter, instruction->type);
+
+    scc_uint32_t value = scc_spirv_value(emitter, scc_spirv_incoming(function, instruction, from), instruction->type);
+
+    if (condition) {
+      const scc_uint32_t current = emitter->bound++;
+      scc_spirv_unary(emitter, SCC_SPIRV_OP_LOAD, type, current, emitter->variables[i]);
+
+      const scc_uint32_t select[] = { condition, taken ? value : current, taken ? current : value };
+      scc_spirv_compute(emitter, SCC_SPIRV_OP_SELECT, type, value = emitter->bound++, select, 3);
+    }
+
+    pending[2 * num_of_pending + 0] = emitter->variables[i];
+    pending[2 * num_of_pending + 1] = value;
+
+    num_of_pending += 1;
+  }
+
+  return num_of_pending;
+}
+
+// Emits the function as a loop around a switch on the block to run, for
+// control flow that can't otherwise be expressed.
+static void scc_spirv_dispatch(scc_spirv_emitter_t *emitter) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_cfg_t *cfg = emitter->cfg;
+
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  emitter->dispatched = SCC_TRUE;
+
+  const scc_uint32_t index = scc_spirv_type(emitter, scc_ir_type(SCC_IR_U32, 1, 1));
+
+  const scc_uint32_t entry = emitter->bound++;
+  const scc_uint32_t loop = emitter->bound++;
+  const scc_uint32_t dispatch = emitter->bound++;
+  const scc_uint32_t next = emitter->bound++;
+  const scc_uint32_t latch = emitter->bound++;
+  const scc_uint32_t merge = emitter->bound++;
+
+  scc_spirv_label(emitter, entry);
+
+  const scc_uint32_t storage = SCC_SPIRV_FUNCTION;
+
+  emitter->selector = emitter->bound++;
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_VARIABLE, scc_spirv_pointer(emitter, SCC_SPIRV_FUNCTION, index), emitter->selector, &storage, 1);
+
+  // Values used outside their block, including by phis, which use them where
+  // they come from, and phis themselves, are kept in variables.
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    if (instruction->op == SCC_IR_OPERATION_PHI)
+      emitter->variables[i] = SCC_IR_NONE;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+        continue;
+
+      const scc_uint32_t used = SCC_IR_VALUE_INDEX(operands[operand]);
+
+      const scc_uint32_t where = (instruction->op == SCC_IR_OPERATION_PHI)
+                               ? SCC_IR_VALUE_INDEX(operands[operand - 1])
+                               : instruction->block;
+
+      if (function->instructions[used].block != where)
+        emitter->variables[used] = SCC_IR_NONE;
+    }
+  }
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    if (!emitter->variables[i])
+      continue;
+
+    emitter->variables[i] = emitter->bound++;
+
+    const scc_uint32_t pointer = scc_spirv_pointer(emitter, SCC_SPIRV_FUNCTION, scc_spirv_type(emitter, function->instructions[i].type));
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_VARIABLE, pointer, emitter->variables[i], &storage, 1);
+  }
+
+  const scc_uint32_t first[] = { emitter->selector, scc_spirv_uint(emitter, cfg->order[0]) };
+  scc_spirv_op(&emitter->code, SCC_SPIRV_OP_STORE, first, 2);
+
+  scc_spirv_jump(emitter, loop);
+
+  scc_spirv_label(emitter, loop);
+
+  const scc_uint32_t loop_merge[] = { merge, latch, 0 };
+  scc_spirv_op(&emitter->code, SCC_SPIRV_OP_LOOP_MERGE, loop_merge, 3);
+
+  scc_spirv_jump(emitter, dispatch);
+
+  scc_spirv_label(emitter, dispatch);
+
+  const scc_uint32_t selected = emitter->bound++;
+  scc_spirv_unary(emitter, SCC_SPIRV_OP_LOAD, index, selected, emitter->selector);
+
+  const scc_uint32_t selection_merge[] = { next, 0 };
+  scc_spirv_op(&emitter->code, SCC_SPIRV_OP_SELECTION_MERGE, selection_merge, 2);
+
+  scc_uint32_t *words = scc_spirv_begin(&emitter->code, SCC_SPIRV_OP_SWITCH, 3 + 2 * cfg->num_of_reachable);
+
+  words[1] = selected;
+  words[2] = next;
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    words[3 + 2 * position + 0] = cfg->order[position];
+    words[3 + 2 * position + 1] = emitter->labels[cfg->order[position]];
+  }
+
+  scc_uint32_t *pending =
+    (scc_uint32_t *)allocator->allocate(allocator, 2 * (2 * function->num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    emitter->block = block;
+
+    scc_spirv_label(emitter, emitter->labels[block]);
+    scc_spirv_body(emitter, block);
+
+    if (scc_spirv_return(emitter, block))
+      continue;
+
+    const scc_ir_instruction_t *instruction = &function->instructions[scc_ir_block_terminator(function, block)];
+
+    scc_uint32_t num_of_pending = 0;
+    scc_uint32_t successor;
+
+    if (instruction->op == SCC_IR_OPERATION_JUMP) {
+      const scc_uint32_t to = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+
+      num_of_pending = scc_spirv_stage(emitter, block, to, 0, SCC_TRUE, pending);
+      successor = scc_spirv_uint(emitter, to);
+    } else {
+      const scc_uint32_t taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1));
+      const scc_uint32_t not_taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 2));
+
+      const scc_uint32_t condition = scc_spirv_condition(emitter, scc_ir_operand(function, instruction, 0));
+
+      num_of_pending = scc_spirv_stage(emitter, block, taken, condition, SCC_TRUE, pending);
+
+      if (not_taken != taken)
+        num_of_pending += scc_spirv_stage(emitter, block, not_taken, condition, SCC_FALSE, &pending[2 * num_of_pending]);
+
+      const scc_uint32_t select[] = { condition, scc_spirv_uint(emitter, taken), scc_spirv_uint(emitter, not_taken) };
+      scc_spirv_compute(emitter, SCC_SPIRV_OP_SELECT, index, successor = emitter->bound++, select, 3);
+    }
+
+    // Stored once everything is loaded, as phis may take each other.
+    for (scc_uint32_t store = 0; store < num_of_pending; ++store)
+      scc_spirv_op(&emitter->code, SCC_SPIRV_OP_STORE, &pending[2 * store], 2);
+
+    const scc_uint32_t store[] = { emitter->selector, successor };
+    scc_spirv_op(&emitter->code, SCC_SPIRV_OP_STORE, store, 2);
+
+    scc_spirv_jump(emitter, next);
+  }
+
+  scc_spirv_label(emitter, next);
+  scc_spirv_jump(emitter, latch);
+
+  scc_spirv_label(emitter, latch);
+  scc_spirv_jump(emitter, loop);
+
+  scc_spirv_label(emitter, merge);
+  scc_spirv_begin(&emitter->code, SCC_SPIRV_OP_UNREACHABLE, 1);
+}
+
+//===----------------------------------------------------------------------===//
+// Functions
+//===----------------------------------------------------------------------===//
+
+static void scc_spirv_function(scc_spirv_emitter_t *emitter,
+                               const scc_ir_function_t *function) {
+  const scc_ir_module_t *module = emitter->module;
+
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  emitter->function = function;
+  emitter->dispatched = SCC_FALSE;
+
+  emitter->values =
+    (scc_uint32_t *)allocator->allocate(allocator, (function->num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  emitter->variables =
+    (scc_uint32_t *)allocator->allocate(allocator, (function->num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  emitter->arguments =
+    (scc_uint32_t *)allocator->allocate(allocator, (function->num_of_arguments + 1) * sizeof(scc_uint32_t), 16);
+  emitter->literals =
+    (scc_uint32_t *)allocator->allocate(allocator, (function->num_of_constants + 1) * sizeof(scc_uint32_t), 16);
+  emitter->labels =
+    (scc_uint32_t *)allocator->allocate(allocator, (function->num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+    if (scc_ir_instruction_is_live(&function->instructions[i]) && !scc_ir_type_is_void(function->instructions[i].type))
+      emitter->values[i] = emitter->bound++;
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block)
+    emitter->labels[block] = emitter->bound++;
+
+  const scc_uint32_t id = emitter->functions[function->index];
+
+  const scc_uint32_t signature[] = { id, 0, scc_spirv_function_type(emitter, function) };
+  scc_spirv_compute(emitter, SCC_SPIRV_OP_FUNCTION, scc_spirv_type(emitter, function->return_type), signature[0], &signature[1], 2);
+
+  scc_spirv_name(emitter, id, scc_ir_module_string(module, function->name));
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument) {
+    emitter->arguments[argument] = emitter->bound++;
+
+    scc_spirv_compute(emitter, SCC_SPIRV_OP_FUNCTION_PARAMETER, scc_spirv_type(emitter, function->arguments[argument].type),
+                      emitter->arguments[argument], NULL, 0);
+
+    scc_spirv_name(emitter, emitter->arguments[argument], scc_ir_module_string(module, function->arguments[argument].name));
+  }
+
+  if (function->num_of_blocks == 0) {
+    scc_spirv_label(emitter, emitter->bound++);
+    scc_spirv_return(emitter, SCC_IR_NONE);
+  } else {
+    emitter->cfg = scc_ir_cfg_compute(function);
+    emitter->dominators = scc_ir_dominators_compute(function, emitter->cfg);
+    emitter->post_dominators = scc_ir_post_dominators_compute(function, emitter->cfg);
+    emitter->loops = scc_ir_loops_compute(function, emitter->cfg, emitter->dominators);
+
+    const scc_uint32_t num_of_loops = emitter->loops->num_of_loops;
+    const scc_uint32_t num_of_blocks = function->num_of_blocks;
+
+    emitter->exits = (scc_uint32_t *)allocator->allocate(allocator, (num_of_loops + 1) * sizeof(scc_uint32_t), 16);
+    emitter->latches = (scc_uint32_t *)allocator->allocate(allocator, (num_of_loops + 1) * sizeof(scc_uint32_t), 16);
+    emitter->bodies = (scc_uint32_t *)allocator->allocate(allocator, (num_of_loops + 1) * sizeof(scc_uint32_t), 16);
+    emitter->continues = (scc_uint32_t *)allocator->allocate(allocator, (num_of_loops + 1) * sizeof(scc_uint32_t), 16);
+    emitter->merges = (scc_uint32_t *)allocator->allocate(allocator, (num_of_loops + 1) * sizeof(scc_uint32_t), 16);
+    emitter->selections = (scc_uint32_t *)allocator->allocate(allocator, (num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+    emitter->claimed = (scc_bool_t *)allocator->allocate(allocator, (num_of_blocks + 1) * sizeof(scc_bool_t), 16);
+    emitter->first_join = (scc_uint32_t *)allocator->allocate(allocator, (num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+
+    // At most one for each loop and each selection.
+    emitter->joins =
+      (scc_spirv_join_t *)allocator->allocate(allocator, (num_of_loops + num_of_blocks + 1) * sizeof(scc_spirv_join_t), 16);
+    emitter->num_of_joins = 0;
+
+    memset(emitter->first_join, 0xff, num_of_blocks * sizeof(scc_uint32_t));
+
+    // Ids handed out planning a function that can't be structured are left
+    // unused, which is harmless.
+    if (scc_spirv_plan(emitter)) {
+      scc_spirv_structured(emitter);
+    } else {
+      // Bodies of loops are only split when structured.
+      memset(emitter->bodies, 0, (num_of_loops + 1) * sizeof(scc_uint32_t));
+      emitter->num_of_joins = 0;
+      memset(emitter->first_join, 0xff, num_of_blocks * sizeof(scc_uint32_t));
+      scc_spirv_dispatch(emitter);
+    }
+
+    scc_ir_loops_destroy(emitter->loops);
+    scc_ir_dominators_destroy(emitter->post_dominators);
+    scc_ir_dominators_destroy(emitter->dominators);
+    scc_ir_cfg_destroy(emitter->cfg);
+  }
+
+  scc_spirv_begin(&emitter->code, SCC_SPIRV_OP_FUNCTION_END, 1);
+
+  emitter->function = NULL;
+
+  scc_arena_reset(emitter->scratch);
+}
+
+// Orders functions called by `function` before it.
+static void scc_spirv_order(scc_spirv_emitter_t *emitter,
+                            scc_uint32_t index,
+                            scc_bool_t *seen) {
+  if (seen[index])
+    return;
+
+  seen[index] = SCC_TRUE;
+
+  const scc_ir_function_t *function = emitter->module->functions[index];
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if ((instruction->op == SCC_IR_OPERATION_CALL) && scc_ir_instruction_is_live(instruction))
+      scc_spirv_order(emitter, SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0)), seen);
+  }
+
+  emitter->order[emitter->num_of_functions++] = index;
+}
+
+//===----------------------------------------------------------------------===//
+// Module
+//===----------------------------------------------------------------------===//
+
+// Orders functions, hands out their ids, and notes how textures are sampled
+// and which globals are split.
+static void scc_spirv_survey(scc_spirv_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  scc_allocator_t *allocator = &emitter->arena->allocator;
+
+  emitter->functions =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  emitter->structures =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_structures + 1) * sizeof(scc_uint32_t), 16);
+  emitter->blocks =
+    (scc_bool_t *)allocator->allocate(allocator, (module->num_of_structures + 1) * sizeof(scc_bool_t), 16);
+  emitter->globals =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  emitter->first_field =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  emitter->loose =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  emitter->dimensions =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  emitter->order =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t num_of_fields = 0;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    emitter->first_field[index] = SCC_IR_NONE;
+    emitter->dimensions[index] = 2;
+
+    const scc_bool_t interface = (global->storage == SCC_IR_INPUT) || (global->storage == SCC_IR_OUTPUT);
+
+    if ((global->type.scalar == SCC_IR_STRUCTURE) && interface) {
+      emitter->first_field[index] = num_of_fields;
+      num_of_fields += module->structures[global->type.structure].num_of_members;
+    }
+  }
+
+  emitter->fields =
+    (scc_uint32_t *)allocator->allocate(allocator, (num_of_fields + 1) * sizeof(scc_uint32_t), 16);
+
+  // Every global may be listed by the entry point.
+  emitter->interface =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_globals + num_of_fields + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_bool_t *seen =
+    (scc_bool_t *)allocator->allocate(allocator, (module->num_of_functions + 1) * sizeof(scc_bool_t), 16);
+
+  scc_spirv_order(emitter, module->entry, seen);
+
+  for (scc_uint32_t position = 0; position < emitter->num_of_functions; ++position) {
+    const scc_ir_function_t *function = module->functions[emitter->order[position]];
+
+    emitter->functions[function->index] = emitter->bound++;
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (!scc_ir_instruction_is_live(instruction))
+        continue;
+
+      if ((instruction->op == SCC_IR_OPERATION_FETCH) || (instruction->op == SCC_IR_OPERATION_GATHER)) {
+        const scc_uint32_t texture = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+        const scc_ir_type_t coordinates = scc_ir_value_type(function, scc_ir_operand(function, instruction, 1));
+        emitter->dimensions[texture] = SCC_MIN(SCC_MAX((scc_uint32_t)coordinates.rows, 1u), 3u);
+      }
+    }
+  }
+}
+
+static scc_uint32_t scc_spirv_variable(scc_spirv_emitter_t *emitter,
+                                       scc_uint32_t storage,
+                                       scc_uint32_t type) {
+  const scc_uint32_t pointer = scc_spirv_pointer(emitter, storage, type);
+  const scc_uint32_t id = emitter->bound++;
+
+  const scc_uint32_t operands[] = { pointer, id, storage };
+  scc_spirv_op(&emitter->declarations, SCC_SPIRV_OP_VARIABLE, operands, 3);
+
+  return id;
+}
+
+// Number of locations `type` takes.
+static scc_uint32_t scc_spirv_width(const scc_ir_module_t *module,
+                                    scc_ir_type_t type) {
+  if (type.scalar != SCC_IR_STRUCTURE)
+    return SCC_MAX((scc_uint32_t)type.columns, 1u);
+
+  const scc_ir_structure_t *structure = &module->structures[type.structure];
+
+  scc_uint32_t width = 0;
+
+  for (scc_uint32_t member = 0; member < structure->num_of_members; ++member)
+    width += scc_spirv_width(module, module->members[structure->first_member + member].type);
+
+  return width;
+}
+
+// Declares an input or output at `location`.
+static scc_uint32_t scc_spirv_interface(scc_spirv_emitter_t *emitter,
+                                        const scc_ir_global_t *global,
+                                        scc_ir_type_t type,
+                                        scc_uint32_t location) {
+  const scc_uint32_t storage = (global->storage == SCC_IR_INPUT) ? SCC_SPIRV_INPUT : SCC_SPIRV_OUTPUT;
+  const scc_uint32_t variable = scc_spirv_variable(emitter, storage, scc_spirv_type(emitter, type));
+
+  scc_spirv_decorate(emitter, variable, SCC_SPIRV_LOCATION, location);
+
+  // Only floats are interpolated.
+  if ((emitter->module->type == SCC_PIXEL_SHADER) && (global->storage == SCC_IR_INPUT))
+    if (!scc_ir_type_is_floating_point(type) || (type.scalar == SCC_IR_F64))
+      scc_spirv_decorate(emitter, variable, SCC_SPIRV_FLAT, 0);
+
+  emitter->interface[emitter->num_of_interface++] = variable;
+
+  return variable;
+}
+
+static void scc_spirv_globals(scc_spirv_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  // Those without a location follow those with one.
+  scc_uint32_t next[2] = { 0, 0 };
+
+  // Loose constants take the first slot not taken by a constant buffer.
+  scc_uint32_t slot = 0;
+  scc_uint32_t num_of_loose = 0;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if ((global->storage == SCC_IR_CONSTANT) && (global->type.scalar != SCC_IR_STRUCTURE))
+      emitter->loose[index] = num_of_loose++;
+
+    if ((global->storage == SCC_IR_CONSTANT) && (global->binding != SCC_IR_NONE))
+      slot = SCC_MAX(slot, global->binding + 1);
+
+    if ((global->storage != SCC_IR_INPUT) && (global->storage != SCC_IR_OUTPUT))
+      continue;
+
+    if ((global->builtin == SCC_IR_BUILTIN_NONE) && (global->binding != SCC_IR_NONE))
+      next[global->storage == SCC_IR_OUTPUT] =
+        SCC_MAX(next[global->storage == SCC_IR_OUTPUT], global->binding + scc_spirv_width(module, global->type));
+  }
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+    const char *name = scc_ir_module_string(module, global->name);
+
+    switch (global->storage) {
+      case SCC_IR_INPUT:
+      case SCC_IR_OUTPUT: {
+        if (global->builtin != SCC_IR_BUILTIN_NONE) {
+          const scc_uint32_t storage = (global->storage == SCC_IR_INPUT) ? SCC_SPIRV_INPUT : SCC_SPIRV_OUTPUT;
+
+          emitter->globals[index] = scc_spirv_variable(emitter, storage, scc_spirv_type(emitter, global->type));
+
+          // As `Position` and `FragDepth`.
+          scc_spirv_decorate(emitter, emitter->globals[index], SCC_SPIRV_BUILTIN, (global->builtin == SCC_IR_BUILTIN_POSITION) ? 0 : 22);
+          scc_spirv_name(emitter, emitter->globals[index], name);
+
+          emitter->interface[emitter->num_of_interface++] = emitter->globals[index];
+
+          break;
+        }
+
+        scc_uint32_t location = global->binding;
+
+        if (location == SCC_IR_NONE) {
+          location = next[global->storage == SCC_IR_OUTPUT];
+          next[global->storage == SCC_IR_OUTPUT] += scc_spirv_width(module, global->type);
+        }
+
+        if (emitter->first_field[index] == SCC_IR_NONE) {
+          emitter->globals[index] = scc_spirv_interface(emitter, global, global->type, location);
+          scc_spirv_name(emitter, emitter->globals[index], name);
+          break;
+        }
+
+        const scc_ir_structure_t *structure = &module->structures[global->type.structure];
+
+        for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+          const scc_ir_member_t *def = &module->members[structure->first_member + member];
+
+          const scc_uint32_t variable = scc_spirv_interface(emitter, global, def->type, location);
+          emitter->fields[emitter->first_field[index] + member] = variable;
+
+          location += scc_spirv_width(module, def->type);
+
+          if (!emitter->options->strip) {
+            char field[256];
+            snprintf(field, sizeof(field), "%s_%s", name, scc_ir_module_string(module, def->name));
+            scc_spirv_name(emitter, variable, field);
+          }
+        }
+      } break;
+
+      case SCC_IR_CONSTANT: {
+        if (global->type.scalar != SCC_IR_STRUCTURE)
+          break;
+
+        const scc_uint32_t type = scc_spirv_structure(emitter, global->type.structure);
+
+        if (!emitter->blocks[global->type.structure]) {
+          scc_spirv_decorate(emitter, type, SCC_SPIRV_BLOCK, 0);
+          emitter->blocks[global->type.structure] = SCC_TRUE;
+        }
+
+        emitter->globals[index] = scc_spirv_variable(emitter, SCC_SPIRV_UNIFORM, type);
+
+        scc_spirv_decorate(emitter, emitter->globals[index], SCC_SPIRV_DESCRIPTOR_SET, 0);
+        scc_spirv_decorate(emitter, emitter->globals[index], SCC_SPIRV_BINDING, global->binding);
+        scc_spirv_name(emitter, emitter->globals[index], name);
+
+        if (emitter->options->version >= 0x00010400)
+          emitter->interface[emitter->num_of_interface++] = emitter->globals[index];
+      } break;
+
+      case SCC_IR_TEXTURE: {
+        emitter->globals[index] = scc_spirv_variable(emitter, SCC_SPIRV_UNIFORM_CONSTANT, scc_spirv_texture(emitter, index));
+
+        scc_spirv_decorate(emitter, emitter->globals[index], SCC_SPIRV_DESCRIPTOR_SET, 1);
+        scc_spirv_decorate(emitter, emitter->globals[index], SCC_SPIRV_BINDING, global->binding);
+        scc_spirv_name(emitter, emitter->globals[index], name);
+
+        if (emitter->options->version >= 0x00010400)
+          emitter->interface[emitter->num_of_interface++] = emitter->globals[index];
+      } break;
+    }
+  }
+
+  if (num_of_loose == 0)
+    return;
+
+  // Loose constants are gathered into a block of their own.
+  scc_allocator_t *allocator = &emitter->arena->allocator;
+
+  scc_uint32_t *members =
+    (scc_uint32_t *)allocator->allocate(allocator, (num_of_loose + 2) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index)
+    if ((module->globals[index].storage == SCC_IR_CONSTANT) && (module->globals[index].type.scalar != SCC_IR_STRUCTURE))
+      members[1 + emitter->loose[index]] = scc_spirv_type(emitter, module->globals[index].type);
+
+  const scc_uint32_t block = members[0] = emitter->bound++;
+  scc_spirv_op(&emitter->declarations, SCC_SPIRV_OP_TYPE_STRUCT, members, num_of_loose + 1);
+
+  scc_spirv_decorate(emitter, block, SCC_SPIRV_BLOCK, 0);
+  scc_spirv_name(emitter, block, "_constants");
+
+  const scc_uint32_t variable = scc_spirv_variable(emitter, SCC_SPIRV_UNIFORM, block);
+
+  scc_spirv_decorate(emitter, variable, SCC_SPIRV_DESCRIPTOR_SET, 0);
+  scc_spirv_decorate(emitter, variable, SCC_SPIRV_BINDING, slot);
+
+  // Interfaces only list inputs and outputs before 1.4.
+  if (emitter->options->version >= 0x00010400)
+    emitter->interface[emitter->num_of_interface++] = variable;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if ((global->storage != SCC_IR_CONSTANT) || (global->type.scalar == SCC_IR_STRUCTURE))
+      continue;
+
+    emitter->globals[index] = variable;
+
+    scc_spirv_place(emitter, block, emitter->loose[index], global->type, global->offset);
+
+    if (!emitter->options->strip) {
+      const scc_uint32_t operands[] = { block, emitter->loose[index] };
+      scc_spirv_string(&emitter->names, SCC_SPIRV_OP_MEMBER_NAME, operands, 2, scc_ir_module_string(module, global->name));
+    }
+  }
+}
+
+// Writes everything up to names, which can only be once functions are, as
+// capabilities are picked up along the way.
+static void scc_spirv_preamble(scc_spirv_emitter_t *emitter,
+                               scc_spirv_section_t *section) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_spirv_options_t *options = emitter->options;
+
+  const scc_uint32_t header[] = { SCC_SPIRV_MAGIC, options->version, 0, emitter->bound, 0 };
+
+  scc_spirv_reserve(section, 5);
+  memcpy(section->words, header, sizeof(header));
+  section->size = 5;
+
+  const scc_uint32_t shader = 1;
+  scc_spirv_op(section, SCC_SPIRV_OP_CAPABILITY, &shader, 1);
+
+  for (scc_uint32_t feature = 0; feature < SCC_SPIRV_NUM_OF_FEATURES; ++feature)
+    if (emitter->features & (1u << feature))
+      scc_spirv_op(section, SCC_SPIRV_OP_CAPABILITY, &SCC_SPIRV_CAPABILITIES[feature], 1);
+
+  // Demotion is core from 1.6.
+  if ((emitter->features & SCC_SPIRV_DEMOTE) && (options->version < 0x00010600))
+    scc_spirv_string(section, SCC_SPIRV_OP_EXTENSION, NULL, 0, "SPV_EXT_demote_to_helper_invocation");
+
+  scc_spirv_string(section, SCC_SPIRV_OP_EXT_INST_IMPORT, &emitter->extended, 1, "GLSL.std.450");
+
+  // Logical addressing, and GLSL's memory model.
+  const scc_uint32_t model[] = { 0, 1 };
+  scc_spirv_op(section, SCC_SPIRV_OP_MEMORY_MODEL, model, 2);
+
+  const scc_uint32_t entry = emitter->functions[module->entry];
+
+  const scc_uint32_t execution = (module->type == SCC_VERTEX_SHADER) ? 0
+                               : (module->type == SCC_PIXEL_SHADER) ? 4
+                               : 5;
+
+  const scc_uint32_t num_of_interface = emitter->num_of_interface;
+
+  scc_uint32_t *words = scc_spirv_begin(section, SCC_SPIRV_OP_ENTRY_POINT, 5 + num_of_interface);
+
+  words[1] = execution;
+  words[2] = entry;
+  words[3] = words[4] = 0;
+
+  memcpy(&words[3], "main", 4);
+
+  if (num_of_interface)
+    memcpy(&words[5], emitter->interface, num_of_interface * sizeof(scc_uint32_t));
+
+  if (module->type == SCC_PIXEL_SHADER) {
+    const scc_uint32_t origin[] = { entry, 7 };
+    scc_spirv_op(section, SCC_SPIRV_OP_EXECUTION_MODE, origin, 2);
+
+    for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+      if (module->globals[index].builtin != SCC_IR_BUILTIN_DEPTH)
+        continue;
+
+      const scc_uint32_t replacing[] = { entry, 12 };
+      scc_spirv_op(section, SCC_SPIRV_OP_EXECUTION_MODE, replacing, 2);
+
+      break;
+    }
+  } else if (module->type == SCC_COMPUTE_SHADER) {
+    const scc_uint32_t size[] = { entry, 17, 1, 1, 1 };
+    scc_spirv_op(section, SCC_SPIRV_OP_EXECUTION_MODE, size, 5);
+  }
+}
+
+static void scc_spirv_flush(scc_writer_t *writer,
+                            const scc_spirv_section_t *section) {
+  scc_writer_write(writer, (const char *)section->words, section->size * sizeof(scc_uint32_t));
+}
+
+scc_bool_t scc_spirv_emit(const scc_ir_module_t *module,
+                          const scc_spirv_options_t *options,
+                          scc_writer_t *writer) {
+  if ((module->entry == SCC_IR_NONE) || (module->entry >= module->num_of_functions))
+    return SCC_FALSE;
+  if (module->functions[module->entry]->removed)
+    return SCC_FALSE;
+
+  const scc_ir_function_t *entry = module->functions[module->entry];
+
+  if ((entry->num_of_arguments > 0) || !scc_ir_type_is_void(entry->return_type))
+    return SCC_FALSE;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_spirv_emitter_t emitter;
+
+  memset(&emitter, 0, sizeof(emitter));
+
+  emitter.module = module;
+  emitter.options = options ? options : &SCC_SPIRV_DEFAULT_OPTIONS;
+
+  emitter.arena = scc_arena_create(heap, 64 * 1024);
+  emitter.scratch = scc_arena_create(heap, 64 * 1024);
+
+  // Ids start from one.
+  emitter.bound = 1;
+  emitter.extended = emitter.bound++;
+
+  // Sized up front from the IR, by a rough guess of words per instruction, so
+  // sections rarely grow.
+  scc_uint32_t num_of_instructions = 0;
+
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index)
+    if (!module->functions[index]->removed)
+      num_of_instructions += module->functions[index]->num_of_instructions;
+
+  scc_spirv_reserve(&emitter.code, 8 * num_of_instructions + 64);
+  scc_spirv_reserve(&emitter.declarations, 16 * (module->num_of_globals + module->num_of_members) + 256);
+  scc_spirv_reserve(&emitter.decorations, 12 * (module->num_of_globals + module->num_of_members) + 64);
+
+  if (!emitter.options->strip)
+    scc_spirv_reserve(&emitter.names, 8 * (module->num_of_globals + module->num_of_members + module->num_of_functions) + 64);
+
+  scc_spirv_survey(&emitter);
+  scc_spirv_globals(&emitter);
+
+  for (scc_uint32_t position = 0; position < emitter.num_of_functions; ++position)
+    scc_spirv_function(&emitter, module->functions[emitter.order[position]]);
+
+  scc_spirv_section_t preamble;
+
+  memset(&preamble, 0, sizeof(preamble));
+
+  scc_spirv_preamble(&emitter, &preamble);
+
+  scc_spirv_flush(writer, &preamble);
+  scc_spirv_flush(writer, &emitter.names);
+  scc_spirv_flush(writer, &emitter.decorations);
+  scc_spirv_flush(writer, &emitter.declarations);
+  scc_spirv_flush(writer, &emitter.code);
+
+  scc_spirv_release(&preamble);
+  scc_spirv_release(&emitter.names);
+  scc_spirv_release(&emitter.decorations);
+  scc_spirv_release(&emitter.declarations);
+  scc_spirv_release(&emitter.code);
+
+  if (emitter.declared)
+    heap->free(heap, (void *)emitter.declared);
+
+  scc_arena_destroy(emitter.scratch);
+  scc_arena_destroy(emitter.arena);
+
+  return SCC_TRUE;
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,1754 @@
+//===-- scc/backend/text.cc -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/backend/text.h"
+
+#include <math.h>
+#include <stdio.h>
+
+SCC_BEGIN_EXTERN_C
+
+// Marks loops that exit to more than one block.
+#define SCC_TEXT_UNSTRUCTURED (SCC_IR_NONE - 1)
+
+// Where control goes once a structured region is done with.
+typedef struct scc_text_region {
+  // Reached by falling out of the region, or `SCC_IR_NONE`.
+  scc_uint32_t merge;
+
+  // Innermost loop the region is in, or `SCC_IR_NONE`.
+  scc_uint32_t loop;
+} scc_text_region_t;
+
+//===----------------------------------------------------------------------===//
+// Interning
+//===----------------------------------------------------------------------===//
+
+static void scc_text_reserve(scc_text_emitter_t *emitter,
+                             scc_uint32_t size) {
+  if (emitter->size_of_pool + size <= emitter->capacity_of_pool)
+    return;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_uint32_t capacity = emitter->capacity_of_pool ? emitter->capacity_of_pool : 4096;
+
+  while (capacity < emitter->size_of_pool + size)
+    capacity *= 2;
+
+  char *pool = (char *)heap->allocate(heap, capacity, 16);
+
+  if (emitter->pool) {
+    memcpy(pool, emitter->pool, emitter->size_of_pool);
+    heap->free(heap, (void *)emitter->pool);
+  }
+
+  emitter->pool = pool;
+  emitter->capacity_of_pool = capacity;
+}
+
+static void scc_text_append(scc_text_emitter_t *emitter,
+                            const char *text,
+                            scc_uint32_t length) {
+  scc_text_reserve(emitter, length);
+  memcpy(&emitter->pool[emitter->size_of_pool], text, length);
+  emitter->size_of_pool += length;
+}
+
+// Names whatever was appended since `start`.
+static scc_text_name_t scc_text_since(const scc_text_emitter_t *emitter,
+                                      scc_uint32_t start) {
+  scc_text_name_t name = { start, emitter->size_of_pool - start };
+  return name;
+}
+
+static scc_bool_t scc_text_is_reserved(const scc_text_dialect_t *dialect,
+                                       const char *identifier) {
+  const char *prefix = dialect->reserved_prefix;
+
+  if (prefix && (strncmp(identifier, prefix, strlen(prefix)) == 0))
+    return SCC_TRUE;
+
+  scc_uint32_t lower = 0, upper = dialect->num_of_reserved;
+
+  while (lower < upper) {
+    const scc_uint32_t middle = (lower + upper) / 2;
+    const int order = strcmp(identifier, dialect->reserved[middle]);
+
+    if (order == 0)
+      return SCC_TRUE;
+
+    if (order < 0)
+      upper = middle;
+    else
+      lower = middle + 1;
+  }
+
+  return SCC_FALSE;
+}
+
+static scc_uint32_t scc_text_hash(const char *text,
+                                   scc_uint32_t length) {
+  scc_uint32_t hash = 2166136261u;
+
+  for (scc_uint32_t character = 0; character < length; ++character)
+    hash = (hash ^ (scc_uint8_t)text[character]) * 16777619u;
+
+  return hash;
+}
+
+static scc_bool_t scc_text_is_taken(const scc_text_emitter_t *emitter,
+                                    const scc_text_names_t *names,
+                                    const char *text,
+                                    scc_uint32_t length) {
+  if (!names->capacity)
+    return SCC_FALSE;
+
+  const scc_uint32_t mask = names->capacity - 1;
+
+  for (scc_uint32_t slot = scc_text_hash(text, length) & mask; names->names[slot].length; slot = (slot + 1) & mask)
+    if ((names->names[slot].length == length) && (memcmp(&emitter->pool[names->names[slot].offset], text, length) == 0))
+      return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+static void scc_text_take(const scc_text_emitter_t *emitter,
+                          scc_text_names_t *names,
+                          scc_text_name_t name) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  // Kept at most half full.
+  if (2 * (names->count + 1) > names->capacity) {
+    const scc_uint32_t capacity = names->capacity ? 2 * names->capacity : 256;
+
+    scc_text_name_t *old = names->names;
+    const scc_uint32_t old_capacity = names->capacity;
+
+    names->names = (scc_text_name_t *)heap->allocate(heap, capacity * sizeof(scc_text_name_t), 16);
+    names->capacity = capacity;
+    names->count = 0;
+
+    for (scc_uint32_t slot = 0; slot < old_capacity; ++slot)
+      if (old[slot].length)
+        scc_text_take(emitter, names, old[slot]);
+
+    if (old)
+      heap->free(heap, (void *)old);
+  }
+
+  const scc_uint32_t mask = names->capacity - 1;
+
+  scc_uint32_t slot = scc_text_hash(&emitter->pool[name.offset], name.length) & mask;
+
+  while (names->names[slot].length)
+    slot = (slot + 1) & mask;
+
+  names->names[slot] = name;
+  names->count += 1;
+}
+
+static void scc_text_forget(scc_text_names_t *names) {
+  if (names->names)
+    memset(names->names, 0, names->capacity * sizeof(scc_text_name_t));
+
+  names->count = 0;
+}
+
+static void scc_text_release(scc_text_names_t *names) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (names->names)
+    heap->free(heap, (void *)names->names);
+}
+
+// Interns `raw` as an identifier, made unique in scope if `unique`.
+static scc_text_name_t scc_text_identify(scc_text_emitter_t *emitter,
+                                         const char *raw,
+                                         scc_bool_t unique) {
+  char identifier[256];
+  scc_uint32_t length = 0;
+
+  if (!((raw[0] >= 'a' && raw[0] <= 'z') || (raw[0] >= 'A' && raw[0] <= 'Z')))
+    identifier[length++] = 'u';
+
+  for (const char *character = raw; *character && (length < sizeof(identifier) - 16); ++character) {
+    const char c = *character;
+
+    const scc_bool_t valid = (c >= 'a' && c <= 'z') || (c >= 'A' && c <= 'Z') || (c >= '0' && c <= '9');
+
+    // Double underscores are reserved too.
+    if (!valid && (length > 0) && (identifier[length - 1] == '_'))
+      continue;
+
+    identifier[length++] = valid ? c : '_';
+  }
+
+  identifier[length] = '\0';
+
+  if (scc_text_is_reserved(emitter->dialect, identifier) && (identifier[length - 1] != '_'))
+    identifier[length++] = '_';
+
+  if (unique) {
+    const scc_uint32_t stem = length;
+
+    // Numbered until unique.
+    for (scc_uint32_t n = 1; scc_text_is_taken(emitter, &emitter->taken, identifier, length)
+                          || scc_text_is_taken(emitter, &emitter->local, identifier, length); ++n) {
+      length = stem;
+
+      if (identifier[length - 1] != '_')
+        identifier[length++] = '_';
+
+      length += (scc_uint32_t)snprintf(&identifier[length], 16, "%u", n);
+    }
+  }
+
+  const scc_uint32_t start = emitter->size_of_pool;
+  scc_text_append(emitter, identifier, length);
+
+  const scc_text_name_t name = scc_text_since(emitter, start);
+
+  if (unique)
+    scc_text_take(emitter, emitter->function ? &emitter->local : &emitter->taken, name);
+
+  return name;
+}
+
+scc_text_name_t scc_text_identifier(scc_text_emitter_t *emitter,
+                                    const char *raw) {
+  return scc_text_identify(emitter, raw, SCC_TRUE);
+}
+
+scc_text_name_t scc_text_intern(scc_text_emitter_t *emitter,
+                                const char *text) {
+  const scc_uint32_t start = emitter->size_of_pool;
+  scc_text_append(emitter, text, (scc_uint32_t)strlen(text));
+  return scc_text_since(emitter, start);
+}
+
+//===----------------------------------------------------------------------===//
+// Spelling
+//===----------------------------------------------------------------------===//
+
+// Spells `type`, which isn't a structure, into `buffer`, which must hold at
+// least 64 characters. Returns the length.
+static scc_uint32_t scc_text_spell(const scc_text_dialect_t *dialect,
+                                   scc_ir_type_t type,
+                                   char *buffer) {
+  if ((type.rows <= 1) && (type.columns <= 1))
+    return (scc_uint32_t)snprintf(buffer, 64, "%s", dialect->scalars[type.scalar]);
+
+  if (type.columns <= 1)
+    return (scc_uint32_t)snprintf(buffer, 64, "%s%u", dialect->vectors[type.scalar], type.rows);
+
+  // Matrices are only ever of floats.
+  const char *prefix = dialect->matrices[(type.scalar == SCC_IR_F64) ? 1 : 0];
+
+  if ((type.rows == type.columns) && dialect->abbreviate)
+    return (scc_uint32_t)snprintf(buffer, 64, "%s%u", prefix, type.rows);
+
+  if (dialect->row_major)
+    return (scc_uint32_t)snprintf(buffer, 64, "%s%ux%u", prefix, type.rows, type.columns);
+
+  return (scc_uint32_t)snprintf(buffer, 64, "%s%ux%u", prefix, type.columns, type.rows);
+}
+
+// Spells a scalar literal into `buffer`, which must hold at least 96
+// characters. Returns the length.
+static scc_uint32_t scc_text_literal(const scc_text_dialect_t *dialect,
+                                     scc_uint32_t scalar,
+                                     scc_ir_component_t component,
+                                     char *buffer) {
+  const char *suffix = (scalar <= SCC_IR_F64) ? dialect->suffixes[scalar] : "";
+
+  switch (scalar) {
+    case SCC_IR_BOOL:
+      return (scc_uint32_t)snprintf(buffer, 96, "%s", component.u ? "true" : "false");
+
+    case SCC_IR_I8: case SCC_IR_I16: case SCC_IR_I32:
+      // The most negative can't be negated.
+      if ((scc_int32_t)component.i == (-2147483647 - 1))
+        return (scc_uint32_t)snprintf(buffer, 96, "(-2147483647%s - 1%s)", suffix, suffix);
+      return (scc_uint32_t)snprintf(buffer, 96, "%d%s", (int)component.i, suffix);
+
+    case SCC_IR_I64:
+      if (component.u == 0x8000000000000000ull)
+        return (scc_uint32_t)snprintf(buffer, 96, "(-9223372036854775807%s - 1%s)", suffix, suffix);
+      return (scc_uint32_t)snprintf(buffer, 96, "%lld%s", (long long)component.i, suffix);
+
+    case SCC_IR_U8: case SCC_IR_U16: case SCC_IR_U32:
+      return (scc_uint32_t)snprintf(buffer, 96, "%u%s", (unsigned)component.u, suffix);
+
+    case SCC_IR_U64:
+      return (scc_uint32_t)snprintf(buffer, 96, "%llu%s", (unsigned long long)component.u, suffix);
+
+    case SCC_IR_F32: {
+      const scc_float32_t value = (scc_float32_t)component.f;
+
+      // Infinities and NaNs have no literal, so are spelled by their bits.
+      if (!isfinite(value)) {
+        scc_uint32_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return (scc_uint32_t)snprintf(buffer, 96, dialect->f32_from_bits, bits);
+      }
+
+      scc_uint32_t length = (scc_uint32_t)snprintf(buffer, 96, "%.9g", (double)value);
+
+      if (!strpbrk(buffer, ".e"))
+        length += (scc_uint32_t)snprintf(&buffer[length], 96 - length, ".0");
+
+      length += (scc_uint32_t)snprintf(&buffer[length], 96 - length, "%s", suffix);
+
+      return length;
+    }
+
+    case SCC_IR_F64: {
+      const scc_float64_t value = component.f;
+
+      if (!isfinite(value)) {
+        scc_uint64_t bits;
+        memcpy(&bits, &value, sizeof(bits));
+        return (scc_uint32_t)snprintf(buffer, 96, dialect->f64_from_bits,
+                                      (unsigned)(bits & 0xffffffffu), (unsigned)(bits >> 32));
+      }
+
+      scc_uint32_t length = (scc_uint32_t)snprintf(buffer, 96, "%.17g", value);
+
+      if (!strpbrk(buffer, ".e"))
+        length += (scc_uint32_t)snprintf(&buffer[length], 96 - length, ".0");
+
+      length += (scc_uint32_t)snprintf(&buffer[length], 96 - length, "%s", suffix);
+
+      return length;
+    }
+  }
+
+  return (scc_uint32_t)snprintf(buffer, 96, "0");
+}
+
+static scc_text_name_t scc_text_intern_constant(scc_text_emitter_t *emitter,
+                                                const scc_ir_constant_t *constant) {
+  const scc_text_dialect_t *dialect = emitter->dialect;
+
+  const scc_uint32_t start = emitter->size_of_pool;
+
+  char buffer[96];
+
+  const scc_ir_type_t type = constant->type;
+  const scc_uint32_t n = scc_ir_type_num_of_components(type);
+
+  if (n <= 1) {
+    scc_text_append(emitter, buffer, scc_text_literal(dialect, type.scalar, constant->components[0], buffer));
+    return scc_text_since(emitter, start);
+  }
+
+  // Vectors with every component the same are spelled with just one, which
+  // for matrices would mean a diagonal.
+  scc_bool_t uniform = scc_ir_type_is_vector(type);
+
+  for (scc_uint32_t k = 1; uniform && (k < n); ++k)
+    uniform = (constant->components[k].u == constant->components[0].u);
+
+  const scc_uint32_t length = scc_text_spell(dialect, type, buffer);
+
+  if (uniform && dialect->casts) {
+    scc_text_append(emitter, "((", 2);
+    scc_text_append(emitter, buffer, length);
+    scc_text_append(emitter, ")(", 2);
+    scc_text_append(emitter, buffer, scc_text_literal(dialect, type.scalar, constant->components[0], buffer));
+    scc_text_append(emitter, "))", 2);
+    return scc_text_since(emitter, start);
+  }
+
+  scc_text_append(emitter, buffer, length);
+  scc_text_append(emitter, "(", 1);
+
+  const scc_uint32_t rows = SCC_MAX((scc_uint32_t)type.rows, 1u);
+  const scc_uint32_t columns = SCC_MAX((scc_uint32_t)type.columns, 1u);
+
+  for (scc_uint32_t k = 0; k < (uniform ? 1 : n); ++k) {
+    if (k > 0)
+      scc_text_append(emitter, ", ", 2);
+
+    // Components are kept column by column.
+    const scc_uint32_t component = dialect->row_major ? ((k % columns) * rows + (k / columns)) : k;
+
+    scc_text_append(emitter, buffer, scc_text_literal(dialect, type.scalar, constant->components[component], buffer));
+  }
+
+  scc_text_append(emitter, ")", 1);
+
+  return scc_text_since(emitter, start);
+}
+
+//===----------------------------------------------------------------------===//
+// Writing
+//===----------------------------------------------------------------------===//
+
+void scc_text_write(scc_text_emitter_t *emitter,
+                    const char *text) {
+  scc_writer_string(emitter->writer, text);
+}
+
+void scc_text_name(scc_text_emitter_t *emitter,
+                   scc_text_name_t name) {
+  scc_writer_write(emitter->writer, &emitter->pool[name.offset], name.length);
+}
+
+void scc_text_type(scc_text_emitter_t *emitter,
+                   scc_ir_type_t type) {
+  if (type.scalar == SCC_IR_STRUCTURE)
+    return scc_text_name(emitter, emitter->structures[type.structure]);
+
+  char buffer[64];
+  scc_writer_write(emitter->writer, buffer, scc_text_spell(emitter->dialect, type, buffer));
+}
+
+void scc_text_splat_begin(scc_text_emitter_t *emitter,
+                          scc_ir_type_t type) {
+  if (emitter->dialect->casts) {
+    scc_text_write(emitter, "((");
+    scc_text_type(emitter, type);
+    scc_text_write(emitter, ")(");
+  } else {
+    scc_text_type(emitter, type);
+    scc_writer_put(emitter->writer, '(');
+  }
+}
+
+void scc_text_splat_end(scc_text_emitter_t *emitter) {
+  scc_text_write(emitter, emitter->dialect->casts ? "))" : ")");
+}
+
+void scc_text_indent(scc_text_emitter_t *emitter) {
+  static const char SPACES[] = "                                                                ";
+
+  scc_uint32_t indentation = 2 * emitter->depth;
+
+  while (indentation > 0) {
+    const scc_uint32_t n = SCC_MIN(indentation, (scc_uint32_t)(sizeof(SPACES) - 1));
+    scc_writer_write(emitter->writer, SPACES, n);
+    indentation -= n;
+  }
+}
+
+void scc_text_line(scc_text_emitter_t *emitter,
+                   const char *text) {
+  scc_text_indent(emitter);
+  scc_text_write(emitter, text);
+  scc_writer_put(emitter->writer, '\n');
+}
+
+// Writes a zero of `type`.
+static void scc_text_zero(scc_text_emitter_t *emitter,
+                          scc_ir_type_t type) {
+  scc_text_splat_begin(emitter, type);
+  scc_writer_put(emitter->writer, '0');
+  scc_text_splat_end(emitter);
+}
+
+void scc_text_value(scc_text_emitter_t *emitter,
+                    scc_ir_value_t value,
+                    scc_ir_type_t type) {
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(value);
+
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      return scc_text_name(emitter, emitter->instructions[index]);
+    case SCC_IR_VALUE_ARGUMENT:
+      return scc_text_name(emitter, emitter->arguments[index]);
+    case SCC_IR_VALUE_CONSTANT:
+      return scc_text_name(emitter, emitter->constants[index]);
+    case SCC_IR_VALUE_IMMEDIATE:
+      scc_writer_unsigned(emitter->writer, index);
+      return scc_writer_put(emitter->writer, 'u');
+    default:
+      return scc_text_zero(emitter, type);
+  }
+}
+
+void scc_text_operand(scc_text_emitter_t *emitter,
+                      scc_ir_value_t value,
+                      scc_uint32_t rows) {
+  scc_ir_type_t type = scc_ir_value_type(emitter->function, value);
+
+  if (scc_ir_type_is_void(type))
+    type = scc_ir_type(SCC_IR_F32, rows, 1);
+
+  if ((rows > 1) && scc_ir_type_is_scalar(type)) {
+    scc_text_splat_begin(emitter, scc_ir_type_reshape(type, rows, 1));
+    scc_text_value(emitter, value, type);
+    scc_text_splat_end(emitter);
+  } else {
+    scc_text_value(emitter, value, type);
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Expressions
+//===----------------------------------------------------------------------===//
+
+// Writes what a load or store refers to.
+static void scc_text_location(scc_text_emitter_t *emitter,
+                              const scc_ir_instruction_t *instruction) {
+  const scc_ir_module_t *module = emitter->module;
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(operands[0]);
+  const scc_ir_global_t *global = &module->globals[index];
+
+  const scc_bool_t whole = (global->type.scalar != SCC_IR_STRUCTURE) || (instruction->num_of_operands < 2)
+                        || (SCC_IR_VALUE_KIND(operands[1]) != SCC_IR_VALUE_MEMBER);
+
+  const scc_uint32_t member = whole ? SCC_IR_NONE : SCC_IR_VALUE_INDEX(operands[1]);
+
+  if (emitter->dialect->reference)
+    return emitter->dialect->reference(emitter, index, member);
+
+  if (whole)
+    return scc_text_name(emitter, emitter->globals[index]);
+
+  if (emitter->first_field[index] != SCC_IR_NONE)
+    return scc_text_name(emitter, emitter->fields[emitter->first_field[index] + member]);
+
+  scc_text_name(emitter, emitter->globals[index]);
+  scc_writer_put(emitter->writer, '.');
+  scc_text_name(emitter, emitter->members[module->structures[global->type.structure].first_member + member]);
+}
+
+void scc_text_call(scc_text_emitter_t *emitter,
+                   const char *name,
+                   const scc_ir_instruction_t *instruction,
+                   scc_uint32_t rows) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  scc_text_write(emitter, name);
+  scc_writer_put(emitter->writer, '(');
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    if (operand > 0)
+      scc_text_write(emitter, ", ");
+    scc_text_operand(emitter, operands[operand], rows);
+  }
+
+  scc_writer_put(emitter->writer, ')');
+}
+
+static void scc_text_infix(scc_text_emitter_t *emitter,
+                           const scc_ir_instruction_t *instruction,
+                           const char *op) {
+  const scc_ir_value_t *operands = scc_ir_operands(emitter->function, instruction);
+
+  scc_text_value(emitter, operands[0], instruction->type);
+  scc_text_write(emitter, op);
+  scc_text_value(emitter, operands[1], instruction->type);
+}
+
+static const char *const SCC_TEXT_OPERATORS[] = {
+  " < ", " <= ", " == ", " != ", " > ", " >= "
+};
+
+// Writes the value of `instruction`.
+static void scc_text_expression(scc_text_emitter_t *emitter,
+                                const scc_ir_instruction_t *instruction) {
+  const scc_text_dialect_t *dialect = emitter->dialect;
+
+  if (dialect->expression && dialect->expression(emitter, instruction))
+    return;
+
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_ir_type_t type = instruction->type;
+  const scc_uint32_t rows = type.rows;
+
+  const scc_ir_type_t input = (instruction->num_of_operands > 0)
+                            ? scc_ir_value_type(function, operands[0])
+                            : type;
+
+  const scc_bool_t real = scc_ir_type_is_floating_point(type);
+
+  const char *spelling = dialect->operations[instruction->op];
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_LOAD:
+      return scc_text_location(emitter, instruction);
+
+    case SCC_IR_OPERATION_SWIZZLE: {
+      const scc_uint32_t mask = SCC_IR_VALUE_INDEX(operands[1]);
+
+      if (scc_ir_type_is_scalar(input))
+        return scc_text_operand(emitter, operands[0], rows);
+
+      scc_text_value(emitter, operands[0], input);
+
+      if ((rows == input.rows) && ((mask & ((1u << (2 * rows)) - 1)) == (SCC_IR_IDENTITY_SWIZZLE & ((1u << (2 * rows)) - 1))))
+        return;
+
+      scc_writer_put(emitter->writer, '.');
+
+      for (scc_uint32_t lane = 0; lane < rows; ++lane)
+        scc_writer_put(emitter->writer, "xyzw"[SCC_IR_SWIZZLE_LANE(mask, lane)]);
+    } return;
+
+    case SCC_IR_OPERATION_COMPOSE: {
+      if ((instruction->num_of_operands == 1) && scc_ir_type_is_equal(input, type))
+        return scc_text_value(emitter, operands[0], type);
+
+      // Components are given column by column, so matrices constructed row
+      // by row are constructed transposed, then transposed back.
+      const scc_bool_t transposed = dialect->row_major && scc_ir_type_is_matrix(type);
+
+      if (transposed) {
+        scc_text_write(emitter, dialect->operations[SCC_IR_OPERATION_TRANSPOSE]);
+        scc_writer_put(emitter->writer, '(');
+        scc_text_type(emitter, scc_ir_type(type.scalar, type.columns, type.rows));
+      } else {
+        scc_text_type(emitter, type);
+      }
+
+      scc_writer_put(emitter->writer, '(');
+
+      for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+        if (operand > 0)
+          scc_text_write(emitter, ", ");
+        scc_text_value(emitter, operands[operand], scc_ir_type_reshape(type, 1, 1));
+      }
+
+      scc_text_write(emitter, transposed ? "))" : ")");
+    } return;
+
+    case SCC_IR_OPERATION_ADD: return scc_text_infix(emitter, instruction, " + ");
+    case SCC_IR_OPERATION_SUB: return scc_text_infix(emitter, instruction, " - ");
+    case SCC_IR_OPERATION_DIVIDE: return scc_text_infix(emitter, instruction, " / ");
+
+    case SCC_IR_OPERATION_MULTIPLY:
+      if (dialect->product && (scc_ir_type_is_matrix(input) || scc_ir_type_is_matrix(scc_ir_value_type(function, operands[1]))))
+        return scc_text_call(emitter, dialect->product, instruction, 1);
+      return scc_text_infix(emitter, instruction, " * ");
+
+    case SCC_IR_OPERATION_FMA:
+      if (real && spelling)
+        return scc_text_call(emitter, spelling, instruction, rows);
+      scc_text_infix(emitter, instruction, " * ");
+      scc_text_write(emitter, " + ");
+      return scc_text_value(emitter, operands[2], type);
+
+    case SCC_IR_OPERATION_EXP10:
+      scc_text_write(emitter, dialect->operations[SCC_IR_OPERATION_POW]);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_splat_begin(emitter, type);
+      scc_text_write(emitter, "10.0");
+      scc_text_splat_end(emitter);
+      scc_text_write(emitter, ", ");
+      scc_text_operand(emitter, operands[0], rows);
+      return scc_writer_put(emitter->writer, ')');
+
+    case SCC_IR_OPERATION_LOG:
+      // Base is first.
+      scc_text_write(emitter, dialect->operations[SCC_IR_OPERATION_LOG]);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_operand(emitter, operands[1], rows);
+      scc_text_write(emitter, ") / ");
+      scc_text_write(emitter, dialect->operations[SCC_IR_OPERATION_LOG]);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_operand(emitter, operands[0], rows);
+      return scc_writer_put(emitter->writer, ')');
+
+    case SCC_IR_OPERATION_LOG10:
+      scc_text_write(emitter, dialect->operations[SCC_IR_OPERATION_LOG2]);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_operand(emitter, operands[0], rows);
+      return scc_text_write(emitter, ") * 0.301029996");
+
+    case SCC_IR_OPERATION_MAGNITUDE:
+    case SCC_IR_OPERATION_LENGTH:
+    case SCC_IR_OPERATION_DOT:
+    case SCC_IR_OPERATION_DISTANCE:
+      return scc_text_call(emitter, spelling, instruction, input.rows);
+
+    case SCC_IR_OPERATION_LENGTH_SQUARED:
+      scc_text_write(emitter, dialect->operations[SCC_IR_OPERATION_DOT]);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_value(emitter, operands[0], input);
+      scc_text_write(emitter, ", ");
+      scc_text_value(emitter, operands[0], input);
+      return scc_writer_put(emitter->writer, ')');
+
+    case SCC_IR_OPERATION_CROSS:
+      return scc_text_call(emitter, spelling, instruction, 3);
+
+    case SCC_IR_OPERATION_REFRACT:
+      scc_text_write(emitter, spelling);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_operand(emitter, operands[0], rows);
+      scc_text_write(emitter, ", ");
+      scc_text_operand(emitter, operands[1], rows);
+      scc_text_write(emitter, ", ");
+      scc_text_operand(emitter, operands[2], 1);
+      return scc_writer_put(emitter->writer, ')');
+
+    case SCC_IR_OPERATION_TRANSPOSE:
+    case SCC_IR_OPERATION_INVERSE:
+    case SCC_IR_OPERATION_DETERMINANT:
+      return scc_text_call(emitter, spelling, instruction, 1);
+
+    case SCC_IR_OPERATION_ABS:
+      if (scc_ir_type_is_unsigned(type))
+        return scc_text_value(emitter, operands[0], type);
+      return scc_text_call(emitter, spelling, instruction, rows);
+
+    case SCC_IR_OPERATION_FLOOR:
+    case SCC_IR_OPERATION_CEIL:
+      // Integers are already whole.
+      if (!real)
+        return scc_text_value(emitter, operands[0], type);
+      return scc_text_call(emitter, spelling, instruction, rows);
+
+    case SCC_IR_OPERATION_SATURATE:
+      if (real && spelling)
+        return scc_text_call(emitter, spelling, instruction, rows);
+
+      scc_text_write(emitter, dialect->operations[SCC_IR_OPERATION_CLAMP]);
+      scc_writer_put(emitter->writer, '(');
+      scc_text_operand(emitter, operands[0], rows);
+      scc_text_write(emitter, ", ");
+      scc_text_zero(emitter, type);
+      scc_text_write(emitter, ", ");
+      scc_text_splat_begin(emitter, type);
+      scc_writer_put(emitter->writer, '1');
+      scc_text_splat_end(emitter);
+      return scc_writer_put(emitter->writer, ')');
+
+    case SCC_IR_OPERATION_LESS:
+    case SCC_IR_OPERATION_LESS_OR_EQUAL:
+    case SCC_IR_OPERATION_EQUAL:
+    case SCC_IR_OPERATION_NOT_EQUAL:
+    case SCC_IR_OPERATION_GREATER:
+    case SCC_IR_OPERATION_GREATER_OR_EQUAL: {
+      const scc_uint32_t comparison = instruction->op - SCC_IR_OPERATION_LESS;
+
+      // Functions that compare vectors don't splat.
+      if ((rows > 1) && dialect->comparisons)
+        return scc_text_call(emitter, dialect->comparisons[comparison], instruction, rows);
+
+      scc_text_value(emitter, operands[0], input);
+      scc_text_write(emitter, SCC_TEXT_OPERATORS[comparison]);
+      return scc_text_value(emitter, operands[1], input);
+    }
+
+    case SCC_IR_OPERATION_CALL: {
+      scc_text_name(emitter, emitter->functions[SCC_IR_VALUE_INDEX(operands[0])]);
+      scc_writer_put(emitter->writer, '(');
+
+      if (dialect->context)
+        scc_text_write(emitter, dialect->context_argument);
+
+      const scc_ir_function_t *callee = emitter->module->functions[SCC_IR_VALUE_INDEX(operands[0])];
+
+      for (scc_uint32_t operand = 1; operand < instruction->num_of_operands; ++operand) {
+        if ((operand > 1) || dialect->context)
+          scc_text_write(emitter, ", ");
+        scc_text_value(emitter, operands[operand], callee->arguments[operand - 1].type);
+      }
+
+      scc_writer_put(emitter->writer, ')');
+    } return;
+  }
+
+  if (spelling)
+    return scc_text_call(emitter, spelling, instruction, rows);
+
+  // Nothing else has a value, short of what dialects spell themselves.
+  scc_text_zero(emitter, type);
+}
+
+// Writes `instruction` as a statement, unless it's a phi or terminator.
+static void scc_text_statement(scc_text_emitter_t *emitter,
+                               scc_uint32_t index) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[index];
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_NOP:
+    case SCC_IR_OPERATION_PHI:
+    case SCC_IR_OPERATION_JUMP:
+    case SCC_IR_OPERATION_BRANCH:
+    case SCC_IR_OPERATION_RETURN:
+      return;
+
+    case SCC_IR_OPERATION_DISCARD:
+      return scc_text_line(emitter, emitter->dialect->discard);
+
+    case SCC_IR_OPERATION_STORE: {
+      const scc_ir_value_t value = scc_ir_operand(function, instruction, instruction->num_of_operands - 1);
+
+      scc_text_indent(emitter);
+      scc_text_location(emitter, instruction);
+      scc_text_write(emitter, " = ");
+      scc_text_value(emitter, value, scc_ir_value_type(function, value));
+      scc_text_write(emitter, ";\n");
+    } return;
+  }
+
+  scc_text_indent(emitter);
+
+  if (!scc_ir_type_is_void(instruction->type)) {
+    if (!emitter->hoisted[index]) {
+      scc_text_type(emitter, instruction->type);
+      scc_writer_put(emitter->writer, ' ');
+    }
+
+    scc_text_name(emitter, emitter->instructions[index]);
+    scc_text_write(emitter, " = ");
+  }
+
+  scc_text_expression(emitter, instruction);
+  scc_text_write(emitter, ";\n");
+}
+
+//===----------------------------------------------------------------------===//
+// Control Flow
+//===----------------------------------------------------------------------===//
+
+// Finds the incoming value of `phi` from `block`.
+static scc_ir_value_t scc_text_incoming(const scc_ir_function_t *function,
+                                        const scc_ir_instruction_t *phi,
+                                        scc_uint32_t block) {
+  const scc_ir_value_t *operands = scc_ir_operands(function, phi);
+
+  for (scc_uint32_t operand = 0; operand + 1 < phi->num_of_operands; operand += 2)
+    if (SCC_IR_VALUE_INDEX(operands[operand]) == block)
+      return operands[operand + 1];
+
+  return SCC_IR_VALUE(SCC_IR_VALUE_UNDEFINED, 0);
+}
+
+// Determines if taking the edge from `from` to `to` copies anything to phis.
+static scc_bool_t scc_text_copies_anything(const scc_text_emitter_t *emitter,
+                                           scc_uint32_t from,
+                                           scc_uint32_t to) {
+  const scc_ir_function_t *function = emitter->function;
+
+  for (scc_uint32_t i = function->blocks[to].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *phi = &function->instructions[i];
+
+    if (phi->op != SCC_IR_OPERATION_PHI)
+      continue;
+
+    if (scc_text_incoming(function, phi, from) != SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, i))
+      return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+// Assigns phis of `to` their values coming from `from`. They're assigned all
+// at once, so values are staged first if a phi is read by another.
+static void scc_text_copies(scc_text_emitter_t *emitter,
+                            scc_uint32_t from,
+                            scc_uint32_t to) {
+  const scc_ir_function_t *function = emitter->function;
+
+  scc_bool_t staged = SCC_FALSE;
+
+  for (scc_uint32_t i = function->blocks[to].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *phi = &function->instructions[i];
+
+    if (phi->op != SCC_IR_OPERATION_PHI)
+      continue;
+
+    const scc_ir_value_t value = scc_text_incoming(function, phi, from);
+
+    if ((SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION)
+     && (SCC_IR_VALUE_INDEX(value) != i)
+     && (function->instructions[SCC_IR_VALUE_INDEX(value)].op == SCC_IR_OPERATION_PHI)
+     && (function->instructions[SCC_IR_VALUE_INDEX(value)].block == to))
+      staged = SCC_TRUE;
+  }
+
+  if (staged) {
+    scc_text_line(emitter, "{");
+    emitter->depth += 1;
+  }
+
+  for (scc_uint32_t pass = 0; pass < (staged ? 2u : 1u); ++pass) {
+    for (scc_uint32_t i = function->blocks[to].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      const scc_ir_instruction_t *phi = &function->instructions[i];
+
+      if (phi->op != SCC_IR_OPERATION_PHI)
+        continue;
+
+      const scc_ir_value_t value = scc_text_incoming(function, phi, from);
+
+      if (value == SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, i))
+        continue;
+
+      scc_text_indent(emitter);
+
+      if (staged && (pass == 0)) {
+        // Staged in `_p` followed by the index of the phi.
+        scc_text_type(emitter, phi->type);
+        scc_text_write(emitter, " _p");
+        scc_writer_unsigned(emitter->writer, i);
+        scc_text_write(emitter, " = ");
+        scc_text_value(emitter, value, phi->type);
+      } else {
+        scc_text_name(emitter, emitter->instructions[i]);
+        scc_text_write(emitter, " = ");
+
+        if (staged) {
+          scc_text_write(emitter, "_p");
+          scc_writer_unsigned(emitter->writer, i);
+        } else {
+          scc_text_value(emitter, value, phi->type);
+        }
+      }
+
+      scc_text_write(emitter, ";\n");
+    }
+  }
+
+  if (staged) {
+    emitter->depth -= 1;
+    scc_text_line(emitter, "}");
+  }
+}
+
+// Writes the condition of a branch, negated if `negate`.
+static void scc_text_condition(scc_text_emitter_t *emitter,
+                               scc_ir_value_t condition,
+                               scc_bool_t negate) {
+  const scc_ir_type_t type = scc_ir_value_type(emitter->function, condition);
+
+  if (type.scalar == SCC_IR_BOOL) {
+    if (negate)
+      scc_writer_put(emitter->writer, '!');
+    return scc_text_value(emitter, condition, type);
+  }
+
+  // Anything else is true if not zero.
+  scc_text_value(emitter, condition, type);
+  scc_text_write(emitter, negate ? " == " : " != ");
+  scc_text_zero(emitter, type);
+}
+
+static scc_uint32_t scc_text_loop_headed_by(const scc_text_emitter_t *emitter,
+                                            scc_uint32_t block) {
+  const scc_uint32_t loop = emitter->loops->innermost[block];
+
+  if ((loop != SCC_IR_NONE) && (emitter->loops->loops[loop].header == block))
+    return loop;
+
+  return SCC_IR_NONE;
+}
+
+// Determines where a branch rejoins. That's its immediate post-dominator,
+// unless a path leaves the function, in which case it's the block it
+// dominates that is entered from several places, if there's just one.
+static scc_uint32_t scc_text_merge_of(const scc_text_emitter_t *emitter,
+                                      scc_uint32_t block) {
+  const scc_uint32_t merge = emitter->post_dominators->idom[block];
+
+  if (merge != SCC_IR_NONE)
+    return merge;
+
+  const scc_uint32_t *children = scc_ir_dominators_children(emitter->dominators, block);
+  const scc_uint32_t num_of_children = scc_ir_dominators_num_of_children(emitter->dominators, block);
+
+  scc_uint32_t joined = SCC_IR_NONE;
+
+  for (scc_uint32_t child = 0; child < num_of_children; ++child) {
+    const scc_uint32_t candidate = children[child];
+
+    if (scc_ir_cfg_num_of_predecessors(emitter->cfg, candidate) < 2)
+      continue;
+    if (scc_text_loop_headed_by(emitter, candidate) != SCC_IR_NONE)
+      continue;
+
+    if (joined != SCC_IR_NONE)
+      return SCC_IR_NONE;
+
+    joined = candidate;
+  }
+
+  return joined;
+}
+
+static scc_bool_t scc_text_walk(scc_text_emitter_t *emitter,
+                                scc_uint32_t block,
+                                const scc_text_region_t *region);
+
+// Goes from `from` to `to`, once phis are assigned. Writes `continue` or
+// `break` if leaving the region that way, or sets `next` if `to` is emitted
+// next, in place. Returns false if `to` can't be reached by structured
+// control flow.
+static scc_bool_t scc_text_go(scc_text_emitter_t *emitter,
+                              scc_uint32_t from,
+                              scc_uint32_t to,
+                              const scc_text_region_t *region,
+                              scc_uint32_t *next) {
+  *next = SCC_IR_NONE;
+
+  if (to == region->merge)
+    return SCC_TRUE;
+
+  if (region->loop != SCC_IR_NONE) {
+    if (to == emitter->loops->loops[region->loop].header) {
+      if (emitter->emitting)
+        scc_text_line(emitter, "continue;");
+      return SCC_TRUE;
+    }
+
+    if (to == emitter->exits[region->loop]) {
+      if (emitter->emitting)
+        scc_text_line(emitter, "break;");
+      return SCC_TRUE;
+    }
+  }
+
+  if (!emitter->visited[to] && scc_ir_dominates(emitter->dominators, from, to)) {
+    *next = to;
+    return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+// Emits one arm of a branch from `from` to `to`.
+static scc_bool_t scc_text_arm(scc_text_emitter_t *emitter,
+                               scc_uint32_t from,
+                               scc_uint32_t to,
+                               const scc_text_region_t *region) {
+  emitter->depth += 1;
+
+  if (emitter->emitting)
+    scc_text_copies(emitter, from, to);
+
+  scc_uint32_t next;
+
+  if (!scc_text_go(emitter, from, to, region, &next))
+    return SCC_FALSE;
+
+  if ((next != SCC_IR_NONE) && !scc_text_walk(emitter, next, region))
+    return SCC_FALSE;
+
+  emitter->depth -= 1;
+
+  return SCC_TRUE;
+}
+
+// Emits `block` and whatever follows it in `region`.
+static scc_bool_t scc_text_walk(scc_text_emitter_t *emitter,
+                                scc_uint32_t block,
+                                const scc_text_region_t *region) {
+  const scc_ir_function_t *function = emitter->function;
+
+  while (block != SCC_IR_NONE) {
+    if (block == region->merge)
+      return SCC_TRUE;
+
+    if (emitter->visited[block])
+      return SCC_FALSE;
+
+    const scc_uint32_t loop = scc_text_loop_headed_by(emitter, block);
+
+    if ((loop != SCC_IR_NONE) && (loop != region->loop)) {
+      const scc_uint32_t exit = emitter->exits[loop];
+
+      if (exit == SCC_TEXT_UNSTRUCTURED)
+        return SCC_FALSE;
+
+      if (emitter->emitting)
+        scc_text_line(emitter, "for (;;) {");
+
+      emitter->depth += 1;
+
+      const scc_text_region_t body = { SCC_IR_NONE, loop };
+
+      if (!scc_text_walk(emitter, block, &body))
+        return SCC_FALSE;
+
+      emitter->depth -= 1;
+
+      if (emitter->emitting)
+        scc_text_line(emitter, "}");
+
+      if (exit == SCC_IR_NONE)
+        return SCC_TRUE;
+
+      if (!scc_text_go(emitter, block, exit, region, &block))
+        return SCC_FALSE;
+
+      continue;
+    }
+
+    emitter->visited[block] = SCC_TRUE;
+
+    if (emitter->emitting)
+      for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+        scc_text_statement(emitter, i);
+
+    const scc_uint32_t terminator = scc_ir_block_terminator(function, block);
+
+    const scc_ir_instruction_t *instruction =
+      (terminator != SCC_IR_NONE) ? &function->instructions[terminator] : NULL;
+
+    if (!instruction || (instruction->op == SCC_IR_OPERATION_RETURN)) {
+      if (emitter->emitting) {
+        scc_text_indent(emitter);
+        scc_text_write(emitter, "return");
+
+        if (instruction && (instruction->num_of_operands > 0)) {
+          scc_writer_put(emitter->writer, ' ');
+          scc_text_value(emitter, scc_ir_operand(function, instruction, 0), function->return_type);
+        }
+
+        scc_text_write(emitter, ";\n");
+      }
+
+      return SCC_TRUE;
+    }
+
+    if (instruction->op == SCC_IR_OPERATION_JUMP) {
+      const scc_uint32_t to = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+
+      if (emitter->emitting)
+        scc_text_copies(emitter, block, to);
+
+      if (!scc_text_go(emitter, block, to, region, &block))
+        return SCC_FALSE;
+
+      continue;
+    }
+
+    const scc_ir_value_t condition = scc_ir_operand(function, instruction, 0);
+    const scc_uint32_t taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1));
+    const scc_uint32_t not_taken = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 2));
+
+    const scc_uint32_t merge = scc_text_merge_of(emitter, block);
+
+    const scc_text_region_t arms = { merge, region->loop };
+
+    // Arms that go straight to where they rejoin, copying nothing, are left
+    // out.
+    const scc_bool_t empty[2] = {
+      (taken == merge) && !scc_text_copies_anything(emitter, block, taken),
+      (not_taken == merge) && !scc_text_copies_anything(emitter, block, not_taken)
+    };
+
+    const scc_bool_t negate = empty[0] && !empty[1];
+
+    if (emitter->emitting) {
+      scc_text_indent(emitter);
+      scc_text_write(emitter, "if (");
+      scc_text_condition(emitter, condition, negate);
+      scc_text_write(emitter, ") {\n");
+    }
+
+    if (!scc_text_arm(emitter, block, negate ? not_taken : taken, &arms))
+      return SCC_FALSE;
+
+    if (!empty[0] && !empty[1]) {
+      if (emitter->emitting)
+        scc_text_line(emitter, "} else {");
+
+      if (!scc_text_arm(emitter, block, not_taken, &arms))
+        return SCC_FALSE;
+    }
+
+    if (emitter->emitting)
+      scc_text_line(emitter, "}");
+
+    if (merge == SCC_IR_NONE)
+      return SCC_TRUE;
+
+    if (!scc_text_go(emitter, block, merge, region, &block))
+      return SCC_FALSE;
+  }
+
+  return SCC_TRUE;
+}
+
+// Emits the function as a loop around a switch on the block to run, for
+// control flow that can't otherwise be expressed.
+static void scc_text_dispatch(scc_text_emitter_t *emitter) {
+  const scc_ir_function_t *function = emitter->function;
+  const scc_ir_cfg_t *cfg = emitter->cfg;
+
+  scc_text_indent(emitter);
+  scc_text_write(emitter, "uint _b = ");
+  scc_writer_unsigned(emitter->writer, cfg->order[0]);
+  scc_text_write(emitter, "u;\n");
+
+  scc_text_line(emitter, "for (;;) {");
+  emitter->depth += 1;
+  scc_text_line(emitter, "switch (_b) {");
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    scc_text_indent(emitter);
+    scc_text_write(emitter, "case ");
+    scc_writer_unsigned(emitter->writer, block);
+    scc_text_write(emitter, "u: {\n");
+
+    emitter->depth += 1;
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+      scc_text_statement(emitter, i);
+
+    const scc_uint32_t terminator = scc_ir_block_terminator(function, block);
+
+    const scc_ir_instruction_t *instruction =
+      (terminator != SCC_IR_NONE) ? &function->instructions[terminator] : NULL;
+
+    scc_uint32_t successors[2];
+    const scc_uint32_t num_of_successors = scc_ir_block_successors(function, block, successors);
+
+    if (num_of_successors == 0) {
+      scc_text_indent(emitter);
+      scc_text_write(emitter, "return");
+
+      if (instruction && (instruction->op == SCC_IR_OPERATION_RETURN) && (instruction->num_of_operands > 0)) {
+        scc_writer_put(emitter->writer, ' ');
+        scc_text_value(emitter, scc_ir_operand(function, instruction, 0), function->return_type);
+      }
+
+      scc_text_write(emitter, ";\n");
+    } else {
+      for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor) {
+        if (num_of_successors > 1) {
+          scc_text_indent(emitter);
+
+          if (successor == 0) {
+            scc_text_write(emitter, "if (");
+            scc_text_condition(emitter, scc_ir_operand(function, instruction, 0), SCC_FALSE);
+            scc_text_write(emitter, ") {\n");
+          } else {
+            scc_text_write(emitter, "} else {\n");
+          }
+
+          emitter->depth += 1;
+        }
+
+        scc_text_copies(emitter, block, successors[successor]);
+
+        scc_text_indent(emitter);
+        scc_text_write(emitter, "_b = ");
+        scc_writer_unsigned(emitter->writer, successors[successor]);
+        scc_text_write(emitter, "u;\n");
+
+        if (num_of_successors > 1)
+          emitter->depth -= 1;
+      }
+
+      if (num_of_successors > 1)
+        scc_text_line(emitter, "}");
+
+      scc_text_line(emitter, "continue;");
+    }
+
+    emitter->depth -= 1;
+    scc_text_line(emitter, "}");
+  }
+
+  scc_text_line(emitter, "}");
+  emitter->depth -= 1;
+  scc_text_line(emitter, "}");
+}
+
+//===----------------------------------------------------------------------===//
+// Functions
+//===----------------------------------------------------------------------===//
+
+// Names values of `function`, and works out which are declared up front.
+static void scc_text_prepare(scc_text_emitter_t *emitter,
+                             const scc_ir_function_t *function) {
+  scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+  emitter->function = function;
+
+  scc_text_forget(&emitter->local);
+
+  emitter->arguments =
+    (scc_text_name_t *)allocator->allocate(allocator, (function->num_of_arguments + 1) * sizeof(scc_text_name_t), 16);
+  emitter->instructions =
+    (scc_text_name_t *)allocator->allocate(allocator, (function->num_of_instructions + 1) * sizeof(scc_text_name_t), 16);
+  emitter->constants =
+    (scc_text_name_t *)allocator->allocate(allocator, (function->num_of_constants + 1) * sizeof(scc_text_name_t), 16);
+  emitter->hoisted =
+    (scc_bool_t *)allocator->allocate(allocator, (function->num_of_instructions + 1) * sizeof(scc_bool_t), 16);
+  emitter->visited =
+    (scc_bool_t *)allocator->allocate(allocator, (function->num_of_blocks + 1) * sizeof(scc_bool_t), 16);
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument)
+    emitter->arguments[argument] =
+      scc_text_identifier(emitter, scc_ir_module_string(emitter->module, function->arguments[argument].name));
+
+  for (scc_uint32_t constant = 0; constant < function->num_of_constants; ++constant)
+    emitter->constants[constant] = scc_text_intern_constant(emitter, &function->constants[constant]);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction) || scc_ir_type_is_void(instruction->type))
+      continue;
+
+    char name[16];
+    const scc_uint32_t start = emitter->size_of_pool;
+    scc_text_append(emitter, name, (scc_uint32_t)snprintf(name, sizeof(name), "_%u", i));
+    emitter->instructions[i] = scc_text_since(emitter, start);
+
+    if (instruction->op == SCC_IR_OPERATION_PHI)
+      emitter->hoisted[i] = SCC_TRUE;
+  }
+
+  // Values used outside their block, including by phis, which use them where
+  // they come from, are declared up front, as blocks are scopes.
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+        continue;
+
+      const scc_uint32_t used = SCC_IR_VALUE_INDEX(operands[operand]);
+
+      const scc_uint32_t where = (instruction->op == SCC_IR_OPERATION_PHI)
+                               ? SCC_IR_VALUE_INDEX(operands[operand - 1])
+                               : instruction->block;
+
+      if (function->instructions[used].block != where)
+        emitter->hoisted[used] = SCC_TRUE;
+    }
+  }
+}
+
+static void scc_text_signature(scc_text_emitter_t *emitter,
+                               const scc_ir_function_t *function) {
+  scc_text_type(emitter, function->return_type);
+  scc_writer_put(emitter->writer, ' ');
+
+  scc_text_name(emitter, emitter->functions[function->index]);
+  scc_writer_put(emitter->writer, '(');
+
+  const char *context = emitter->dialect->context;
+
+  if (context)
+    scc_text_write(emitter, context);
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument) {
+    if ((argument > 0) || context)
+      scc_text_write(emitter, ", ");
+    scc_text_type(emitter, function->arguments[argument].type);
+    scc_writer_put(emitter->writer, ' ');
+    scc_text_name(emitter, emitter->arguments[argument]);
+  }
+
+  scc_text_write(emitter, ")");
+}
+
+static void scc_text_function(scc_text_emitter_t *emitter,
+                              const scc_ir_function_t *function) {
+  const scc_uint32_t watermark = emitter->size_of_pool;
+
+  scc_text_prepare(emitter, function);
+
+  scc_text_signature(emitter, function);
+  scc_text_write(emitter, " {\n");
+
+  emitter->depth = 1;
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    if (!emitter->hoisted[i] || !scc_ir_instruction_is_live(&function->instructions[i]))
+      continue;
+
+    scc_text_indent(emitter);
+    scc_text_type(emitter, function->instructions[i].type);
+    scc_writer_put(emitter->writer, ' ');
+    scc_text_name(emitter, emitter->instructions[i]);
+    scc_text_write(emitter, ";\n");
+  }
+
+  if (function->num_of_blocks > 0) {
+    emitter->cfg = scc_ir_cfg_compute(function);
+    emitter->dominators = scc_ir_dominators_compute(function, emitter->cfg);
+    emitter->post_dominators = scc_ir_post_dominators_compute(function, emitter->cfg);
+    emitter->loops = scc_ir_loops_compute(function, emitter->cfg, emitter->dominators);
+
+    const scc_ir_loops_t *loops = emitter->loops;
+
+    scc_allocator_t *allocator = &emitter->scratch->allocator;
+
+    emitter->exits =
+      (scc_uint32_t *)allocator->allocate(allocator, (loops->num_of_loops + 1) * sizeof(scc_uint32_t), 16);
+
+    for (scc_uint32_t loop = 0; loop < loops->num_of_loops; ++loop) {
+      const scc_uint32_t *blocks = scc_ir_loop_blocks(loops, loop);
+
+      scc_uint32_t exit = SCC_IR_NONE;
+
+      for (scc_uint32_t block = 0; block < loops->loops[loop].num_of_blocks; ++block) {
+        const scc_uint32_t *successors = scc_ir_cfg_successors(emitter->cfg, blocks[block]);
+        const scc_uint32_t num_of_successors = scc_ir_cfg_num_of_successors(emitter->cfg, blocks[block]);
+
+        for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor) {
+          if (scc_ir_loop_contains(loops, loop, successors[successor]))
+            continue;
+
+          if ((exit != SCC_IR_NONE) && (exit != successors[successor]))
+            exit = SCC_TEXT_UNSTRUCTURED;
+          else if (exit == SCC_IR_NONE)
+            exit = successors[successor];
+        }
+      }
+
+      emitter->exits[loop] = exit;
+    }
+
+    // Checked before anything is written, as there's no taking it back.
+    const scc_text_region_t region = { SCC_IR_NONE, SCC_IR_NONE };
+
+    emitter->emitting = SCC_FALSE;
+
+    const scc_bool_t structured = scc_text_walk(emitter, emitter->cfg->order[0], &region);
+
+    memset(emitter->visited, 0, function->num_of_blocks * sizeof(scc_bool_t));
+
+    emitter->emitting = SCC_TRUE;
+    emitter->depth = 1;
+
+    if (structured)
+      scc_text_walk(emitter, emitter->cfg->order[0], &region);
+    else
+      scc_text_dispatch(emitter);
+
+    scc_ir_loops_destroy(emitter->loops);
+    scc_ir_dominators_destroy(emitter->post_dominators);
+    scc_ir_dominators_destroy(emitter->dominators);
+    scc_ir_cfg_destroy(emitter->cfg);
+  }
+
+  scc_text_write(emitter, "}\n\n");
+
+  // Names of values aren't needed beyond the function.
+  emitter->size_of_pool = watermark;
+  emitter->function = NULL;
+
+  scc_arena_reset(emitter->scratch);
+}
+
+// Orders functions called by `function` before it.
+static void scc_text_order(scc_text_emitter_t *emitter,
+                           scc_uint32_t index,
+                           scc_bool_t *seen) {
+  if (seen[index])
+    return;
+
+  seen[index] = SCC_TRUE;
+
+  const scc_ir_function_t *function = emitter->module->functions[index];
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if ((instruction->op == SCC_IR_OPERATION_CALL) && scc_ir_instruction_is_live(instruction))
+      scc_text_order(emitter, SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0)), seen);
+  }
+
+  emitter->order[emitter->num_of_functions++] = index;
+}
+
+//===----------------------------------------------------------------------===//
+// Dialects
+//===----------------------------------------------------------------------===//
+
+void scc_text_narrow(scc_text_emitter_t *emitter,
+                     scc_uint32_t rows) {
+  if (rows < 4) {
+    scc_writer_put(emitter->writer, '.');
+    scc_writer_write(emitter->writer, "xyz", rows);
+  }
+}
+
+scc_bool_t scc_text_is_wide(scc_ir_type_t type) {
+  return (type.scalar == SCC_IR_I64) || (type.scalar == SCC_IR_U64);
+}
+
+scc_bool_t scc_text_is_flat(const scc_text_emitter_t *emitter,
+                            scc_ir_storage_t storage,
+                            scc_ir_type_t type) {
+  const scc_bool_t interpolated = (emitter->module->type == SCC_PIXEL_SHADER) ? (storage == SCC_IR_INPUT)
+                                : (emitter->module->type == SCC_VERTEX_SHADER) ? (storage == SCC_IR_OUTPUT)
+                                : SCC_FALSE;
+
+  return interpolated && !scc_ir_type_is_floating_point(type);
+}
+
+void scc_text_interface(scc_text_emitter_t *emitter,
+                        scc_ir_storage_t storage,
+                        scc_text_interface_fn visit) {
+  const scc_ir_module_t *module = emitter->module;
+
+  // Those without a location are placed after the last with one.
+  scc_uint32_t unplaced = 0;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if ((global->storage == storage) && (global->binding != SCC_IR_NONE)) {
+      const scc_uint32_t width = (global->type.scalar == SCC_IR_STRUCTURE)
+                               ? module->structures[global->type.structure].num_of_members * 4
+                               : SCC_MAX((scc_uint32_t)global->type.columns, 1u);
+      unplaced = SCC_MAX(unplaced, global->binding + width);
+    }
+  }
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    if (global->storage != storage)
+      continue;
+
+    scc_uint32_t location = (global->binding != SCC_IR_NONE) ? global->binding : unplaced;
+
+    if (emitter->first_field[index] == SCC_IR_NONE) {
+      visit(emitter, storage, global->builtin, location, global->type, emitter->globals[index]);
+
+      if (global->binding == SCC_IR_NONE)
+        unplaced += SCC_MAX((scc_uint32_t)global->type.columns, 1u);
+
+      continue;
+    }
+
+    // Members take consecutive locations, a column each.
+    const scc_ir_structure_t *structure = &module->structures[global->type.structure];
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      const scc_ir_type_t type = module->members[structure->first_member + member].type;
+
+      visit(emitter, storage, SCC_IR_BUILTIN_NONE, location, type, emitter->fields[emitter->first_field[index] + member]);
+
+      location += SCC_MAX((scc_uint32_t)type.columns, 1u);
+    }
+
+    if (global->binding == SCC_IR_NONE)
+      unplaced = location;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Module
+//===----------------------------------------------------------------------===//
+
+// Names everything in the module, and notes how textures are sampled and
+// which structures are used as values.
+static void scc_text_survey(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  scc_allocator_t *allocator = &emitter->arena->allocator;
+
+  emitter->globals =
+    (scc_text_name_t *)allocator->allocate(allocator, (module->num_of_globals + 1) * sizeof(scc_text_name_t), 16);
+  emitter->functions =
+    (scc_text_name_t *)allocator->allocate(allocator, (module->num_of_functions + 1) * sizeof(scc_text_name_t), 16);
+  emitter->structures =
+    (scc_text_name_t *)allocator->allocate(allocator, (module->num_of_structures + 1) * sizeof(scc_text_name_t), 16);
+  emitter->members =
+    (scc_text_name_t *)allocator->allocate(allocator, (module->num_of_members + 1) * sizeof(scc_text_name_t), 16);
+  emitter->first_field =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  emitter->dimensions =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  emitter->declared =
+    (scc_bool_t *)allocator->allocate(allocator, (module->num_of_structures + 1) * sizeof(scc_bool_t), 16);
+  emitter->order =
+    (scc_uint32_t *)allocator->allocate(allocator, (module->num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t member = 0; member < module->num_of_members; ++member) {
+    // Members are scoped by their structures.
+    emitter->members[member] = scc_text_identify(emitter, scc_ir_module_string(module, module->members[member].name), SCC_FALSE);
+
+    // Structures nested in others are declared.
+    if (module->members[member].type.scalar == SCC_IR_STRUCTURE)
+      emitter->declared[module->members[member].type.structure] = SCC_TRUE;
+  }
+
+  scc_uint32_t num_of_fields = 0;
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    const scc_ir_global_t *global = &module->globals[index];
+
+    emitter->first_field[index] = SCC_IR_NONE;
+    emitter->dimensions[index] = 2;
+
+    const char *builtin = emitter->dialect->builtins[global->builtin];
+
+    if (builtin)
+      emitter->globals[index] = scc_text_intern(emitter, builtin);
+    else
+      emitter->globals[index] = scc_text_identifier(emitter, scc_ir_module_string(module, global->name));
+
+    if ((global->type.scalar == SCC_IR_STRUCTURE) && (emitter->dialect->flattened & (1u << global->storage))) {
+      emitter->first_field[index] = num_of_fields;
+      num_of_fields += module->structures[global->type.structure].num_of_members;
+    }
+  }
+
+  emitter->fields =
+    (scc_text_name_t *)allocator->allocate(allocator, (num_of_fields + 1) * sizeof(scc_text_name_t), 16);
+
+  for (scc_uint32_t index = 0; index < module->num_of_globals; ++index) {
+    if (emitter->first_field[index] == SCC_IR_NONE)
+      continue;
+
+    const scc_ir_global_t *global = &module->globals[index];
+    const scc_ir_structure_t *structure = &module->structures[global->type.structure];
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      char raw[256];
+      snprintf(raw, sizeof(raw), "%s_%s",
+               scc_ir_module_string(module, global->name),
+               scc_ir_module_string(module, module->members[structure->first_member + member].name));
+      emitter->fields[emitter->first_field[index] + member] = scc_text_identifier(emitter, raw);
+    }
+  }
+
+  scc_bool_t *seen =
+    (scc_bool_t *)allocator->allocate(allocator, (module->num_of_functions + 1) * sizeof(scc_bool_t), 16);
+
+  scc_text_order(emitter, module->entry, seen);
+
+  for (scc_uint32_t position = 0; position < emitter->num_of_functions; ++position) {
+    const scc_ir_function_t *function = module->functions[emitter->order[position]];
+
+    if ((function->index == module->entry) && emitter->dialect->entry)
+      emitter->functions[function->index] = scc_text_intern(emitter, emitter->dialect->entry);
+    else
+      emitter->functions[function->index] = scc_text_identifier(emitter, scc_ir_module_string(module, function->name));
+
+    if (function->return_type.scalar == SCC_IR_STRUCTURE)
+      emitter->declared[function->return_type.structure] = SCC_TRUE;
+
+    for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument)
+      if (function->arguments[argument].type.scalar == SCC_IR_STRUCTURE)
+        emitter->declared[function->arguments[argument].type.structure] = SCC_TRUE;
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (!scc_ir_instruction_is_live(instruction))
+        continue;
+
+      if (instruction->type.scalar == SCC_IR_STRUCTURE)
+        emitter->declared[instruction->type.structure] = SCC_TRUE;
+
+      if ((instruction->op == SCC_IR_OPERATION_FETCH) || (instruction->op == SCC_IR_OPERATION_GATHER)) {
+        const scc_uint32_t texture = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+        const scc_ir_type_t coordinates = scc_ir_value_type(function, scc_ir_operand(function, instruction, 1));
+        emitter->dimensions[texture] = SCC_MIN(SCC_MAX((scc_uint32_t)coordinates.rows, 1u), 3u);
+      }
+    }
+  }
+
+  // Named last, so globals and functions keep their names. Those that aren't
+  // declared only lend their names to generated ones.
+  for (scc_uint32_t structure = 0; structure < module->num_of_structures; ++structure)
+    emitter->structures[structure] =
+      scc_text_identify(emitter, scc_ir_module_string(module, module->structures[structure].name), emitter->declared[structure]);
+}
+
+static void scc_text_structures(scc_text_emitter_t *emitter) {
+  const scc_ir_module_t *module = emitter->module;
+
+  for (scc_uint32_t index = 0; index < module->num_of_structures; ++index) {
+    if (!emitter->declared[index])
+      continue;
+
+    const scc_ir_structure_t *structure = &module->structures[index];
+
+    scc_text_write(emitter, "struct ");
+    scc_text_name(emitter, emitter->structures[index]);
+    scc_text_write(emitter, " {\n");
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      scc_text_write(emitter, "  ");
+      scc_text_type(emitter, module->members[structure->first_member + member].type);
+      scc_writer_put(emitter->writer, ' ');
+      scc_text_name(emitter, emitter->members[structure->first_member + member]);
+      scc_text_write(emitter, ";\n");
+    }
+
+    scc_text_write(emitter, "};\n\n");
+  }
+}
+
+scc_bool_t scc_text_emit(const scc_ir_module_t *module,
+                         const scc_text_dialect_t *dialect,
+                         const void *options,
+                         scc_writer_t *writer) {
+  if ((module->entry == SCC_IR_NONE) || (module->entry >= module->num_of_functions))
+    return SCC_FALSE;
+  if (module->functions[module->entry]->removed)
+    return SCC_FALSE;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_text_emitter_t emitter;
+
+  memset(&emitter, 0, sizeof(emitter));
+
+  emitter.module = module;
+  emitter.dialect = dialect;
+  emitter.options = options;
+  emitter.writer = writer;
+
+  emitter.arena = scc_arena_create(heap, 64 * 1024);
+  emitter.scratch = scc_arena_create(heap, 64 * 1024);
+
+  scc_text_survey(&emitter);
+
+  if (dialect->preamble)
+    dialect->preamble(&emitter);
+
+  scc_text_structures(&emitter);
+
+  if (dialect->declarations)
+    dialect->declarations(&emitter);
+
+  for (scc_uint32_t position = 0; position < emitter.num_of_functions; ++position)
+    scc_text_function(&emitter, module->functions[emitter.order[position]]);
+
+  if (dialect->epilogue)
+    dialect->epilogue(&emitter);
+
+  if (emitter.pool)
+    heap->free(heap, (void *)emitter.pool);
+
+  scc_text_release(&emitter.taken);
+  scc_text_release(&emitter.local);
+
+  scc_arena_destroy(emitter.scratch);
+  scc_arena_destroy(emitter.arena);
+
+  return SCC_TRUE;
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,141 @@
+//===-- scc/backend/writer.cc ---------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/backend/writer.h"
+
+SCC_BEGIN_EXTERN_C
+
+static char *scc_writer_chunk_bytes(scc_writer_chunk_t *chunk) {
+  return (char *)(chunk + 1);
+}
+
+// Takes a spare chunk, or allocates one.
+static scc_writer_chunk_t *scc_writer_chunk(scc_writer_t *writer) {
+  scc_writer_chunk_t *chunk = writer->spare;
+
+  if (chunk) {
+    writer->spare = chunk->next;
+  } else {
+    scc_allocator_t *heap = scc_get_global_heap_allocator();
+    chunk = (scc_writer_chunk_t *)heap->allocate(heap, sizeof(scc_writer_chunk_t) + writer->granularity, 16);
+  }
+
+  chunk->next = NULL;
+  chunk->size = 0;
+
+  return chunk;
+}
+
+static void scc_writer_start(scc_writer_t *writer,
+                             scc_writer_chunk_t *chunk) {
+  writer->cursor = scc_writer_chunk_bytes(chunk);
+  writer->end = writer->cursor + writer->granularity;
+}
+
+static void scc_writer_hand_off(scc_writer_t *writer,
+                                const char *bytes,
+                                scc_size_t count) {
+  if (count && (writer->sink->write(writer->sink, bytes, count) != count))
+    writer->failed = SCC_TRUE;
+}
+
+scc_writer_t *scc_writer_create(scc_sink_t *sink,
+                                scc_size_t granularity) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_writer_t *writer = (scc_writer_t *)heap->allocate(heap, sizeof(scc_writer_t), 16);
+
+  writer->sink = sink;
+  writer->granularity = SCC_MAX(granularity, (scc_size_t)256);
+
+  writer->first = writer->last = scc_writer_chunk(writer);
+
+  scc_writer_start(writer, writer->first);
+
+  return writer;
+}
+
+void scc_writer_destroy(scc_writer_t *writer) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_writer_chunk_t *lists[2] = { writer->first, writer->spare };
+
+  for (scc_uint32_t list = 0; list < 2; ++list) {
+    for (scc_writer_chunk_t *chunk = lists[list]; chunk; ) {
+      scc_writer_chunk_t *next = chunk->next;
+      heap->free(heap, (void *)chunk);
+      chunk = next;
+    }
+  }
+
+  heap->free(heap, (void *)writer);
+}
+
+void scc_writer_advance(scc_writer_t *writer) {
+  scc_writer_chunk_t *last = writer->last;
+
+  last->size = (scc_size_t)(writer->cursor - scc_writer_chunk_bytes(last));
+
+  if (writer->sink) {
+    // Only ever one chunk is needed.
+    scc_writer_hand_off(writer, scc_writer_chunk_bytes(last), last->size);
+    last->size = 0;
+  } else {
+    writer->written += last->size;
+    writer->last = last->next = scc_writer_chunk(writer);
+  }
+
+  scc_writer_start(writer, writer->last);
+}
+
+scc_bool_t scc_writer_flush(scc_writer_t *writer) {
+  writer->last->size = (scc_size_t)(writer->cursor - scc_writer_chunk_bytes(writer->last));
+
+  for (scc_writer_chunk_t *chunk = writer->first; chunk; chunk = chunk->next)
+    if (writer->sink)
+      scc_writer_hand_off(writer, scc_writer_chunk_bytes(chunk), chunk->size);
+
+  // Everything but the first chunk is kept for later.
+  writer->last->next = writer->spare;
+  writer->spare = writer->first->next;
+
+  writer->first->next = NULL;
+  writer->first->size = 0;
+  writer->last = writer->first;
+  writer->written = 0;
+
+  scc_writer_start(writer, writer->first);
+
+  const scc_bool_t failed = writer->failed;
+  writer->failed = SCC_FALSE;
+
+  return !failed;
+}
+
+scc_size_t scc_writer_size(const scc_writer_t *writer) {
+  return writer->written + (scc_size_t)(writer->cursor - scc_writer_chunk_bytes(writer->last));
+}
+
+void scc_writer_copy(const scc_writer_t *writer,
+                     char *buffer) {
+  for (scc_writer_chunk_t *chunk = writer->first; chunk != writer->last; chunk = chunk->next) {
+    memcpy(buffer, scc_writer_chunk_bytes(chunk), chunk->size);
+    buffer += chunk->size;
+  }
+
+  const scc_size_t size = (scc_size_t)(writer->cursor - scc_writer_chunk_bytes(writer->last));
+
+  memcpy(buffer, scc_writer_chunk_bytes(writer->last), size);
+}
+
+SCC_END_EXTERN_C
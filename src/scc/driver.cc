@@ -12,3 +12,207 @@
 //===----------------------------------------------------------------------===//
 
 #include "scc/driver.h"
+
+#include "scc/foundation/jobs.h"
+
+#include "scc/ir/cfg.h"
+#include "scc/ir/liveness.h"
+#include "scc/ir/passes.h"
+
+#include "scc/backend/glsl.h"
+#include "scc/backend/hlsl.h"
+#include "scc/backend/msl.h"
+#include "scc/backend/spirv.h"
+#include "scc/backend/reflection.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Optimizations that don't depend on the target, in order.
+static const scc_ir_pass_t *const SCC_DRIVER_OPTIMIZATIONS[] = {
+  &SCC_IR_SCCP_PASS,
+  &SCC_IR_INLINE_PASS,
+  &SCC_IR_SCCP_PASS,
+  &SCC_IR_SWIZZLE_PASS,
+  &SCC_IR_STRENGTH_REDUCTION_PASS,
+  &SCC_IR_GVN_PASS,
+  &SCC_IR_LICM_PASS,
+  &SCC_IR_SHRINK_PASS,
+  &SCC_IR_SWIZZLE_PASS,
+  &SCC_IR_DCE_PASS,
+  &SCC_IR_PRUNE_INTERFACE_PASS
+};
+
+// Optionally run ahead of lowering.
+static const scc_ir_pass_t *const SCC_DRIVER_LAYOUT = &SCC_IR_LAYOUT_PASS;
+
+// Lowering that tailors code to a target, in order.
+static const scc_ir_pass_t *const SCC_DRIVER_LOWERINGS[] = {
+  &SCC_IR_SCALARIZE_PASS,
+  &SCC_IR_VECTORIZE_PASS,
+  &SCC_IR_SELECT_PASS,
+  &SCC_IR_SWIZZLE_PASS,
+  &SCC_IR_DCE_PASS,
+  &SCC_IR_SCHEDULE_PASS
+};
+
+static void scc_driver_run(scc_ir_module_t *module,
+                           const scc_ir_pass_options_t *options,
+                           const scc_ir_pass_t *const *passes,
+                           scc_uint32_t num_of_passes) {
+  scc_ir_pass_manager_t *manager = scc_ir_pass_manager_create(options);
+
+  for (scc_uint32_t pass = 0; pass < num_of_passes; ++pass)
+    scc_ir_pass_manager_add(manager, passes[pass]);
+
+  scc_ir_pass_manager_run(manager, module);
+  scc_ir_pass_manager_destroy(manager);
+}
+
+void scc_driver_optimize(scc_ir_module_t *module,
+                         const scc_ir_pass_options_t *options) {
+  scc_driver_run(module, options, SCC_DRIVER_OPTIMIZATIONS,
+                 sizeof(SCC_DRIVER_OPTIMIZATIONS) / sizeof(SCC_DRIVER_OPTIMIZATIONS[0]));
+}
+
+// What targets are fanned out to.
+typedef struct scc_driver_fan_out {
+  const scc_ir_module_t *module;
+  const scc_ir_pass_options_t *options;
+  scc_driver_output_t *outputs;
+} scc_driver_fan_out_t;
+
+static scc_bool_t scc_driver_emit_to(const scc_ir_module_t *module,
+                                     const scc_driver_output_t *output) {
+  switch (output->target) {
+    case SCC_TARGET_GLSL:
+      return scc_glsl_emit(module, (const scc_glsl_options_t *)output->options, output->writer);
+    case SCC_TARGET_HLSL:
+      return scc_hlsl_emit(module, (const scc_hlsl_options_t *)output->options, output->writer);
+    case SCC_TARGET_SPIRV:
+      return scc_spirv_emit(module, (const scc_spirv_options_t *)output->options, output->writer);
+    case SCC_TARGET_MSL:
+      return scc_msl_emit(module, (const scc_msl_options_t *)output->options, output->writer);
+    default:
+      // Nothing to emit for the host.
+      return SCC_FALSE;
+  }
+}
+
+// Rules constant buffers are laid out by for `output`.
+static scc_ir_packing_t scc_driver_packing(const scc_driver_output_t *output) {
+  if ((output->target == SCC_TARGET_SPIRV) && output->options) {
+    const scc_spirv_options_t *options = (const scc_spirv_options_t *)output->options;
+
+    if (options->packing == SCC_IR_PACKING_STD430)
+      return SCC_IR_PACKING_STD430;
+  }
+
+  return scc_ir_packing_of(output->target);
+}
+
+// Lowers a copy of the module for output `index`, then emits it.
+static void scc_driver_fan_out_to(void *context,
+                                  scc_uint32_t index,
+                                  scc_uint32_t thread) {
+  const scc_driver_fan_out_t *fan_out = (const scc_driver_fan_out_t *)context;
+
+  // Each output is lowered on a copy of its own, so nothing is per thread.
+  (void)thread;
+
+  scc_driver_output_t *output = &fan_out->outputs[index];
+
+  output->emitted = SCC_FALSE;
+
+  if ((output->target == SCC_TARGET_HOST) || (output->target >= SCC_NUM_OF_TARGETS))
+    return;
+
+  scc_ir_pass_options_t options = *fan_out->options;
+
+  options.target = output->target;
+
+  // Jobs can't submit batches of their own, so passes run on this thread.
+  options.threads = 1;
+
+  options.packing = scc_driver_packing(output);
+
+  scc_ir_module_t *module = scc_ir_module_clone(fan_out->module);
+
+  if (output->lay_out)
+    scc_driver_run(module, &options, &SCC_DRIVER_LAYOUT, 1);
+
+  scc_driver_run(module, &options, SCC_DRIVER_LOWERINGS,
+                 sizeof(SCC_DRIVER_LOWERINGS) / sizeof(SCC_DRIVER_LOWERINGS[0]));
+
+  output->emitted = scc_driver_emit_to(module, output);
+
+  if (output->emitted && output->reflection)
+    scc_reflection_emit(module, options.packing, output->reflection);
+
+  scc_ir_module_destroy(module);
+}
+
+scc_bool_t scc_driver_emit(const scc_ir_module_t *module,
+                           const scc_ir_pass_options_t *options,
+                           scc_driver_output_t *outputs,
+                           scc_uint32_t num_of_outputs) {
+  scc_driver_fan_out_t fan_out = { module, options, outputs };
+
+  const scc_uint32_t threads =
+    SCC_MIN(options->threads ? options->threads : scc_num_of_cores(), num_of_outputs);
+
+  if (threads > 1) {
+    scc_job_system_t *jobs = scc_job_system_create(threads);
+    scc_job_system_for_each(jobs, num_of_outputs, &scc_driver_fan_out_to, (void *)&fan_out);
+    scc_job_system_destroy(jobs);
+  } else {
+    for (scc_uint32_t output = 0; output < num_of_outputs; ++output)
+      scc_driver_fan_out_to((void *)&fan_out, output, 0);
+  }
+
+  scc_bool_t emitted = SCC_TRUE;
+
+  for (scc_uint32_t output = 0; output < num_of_outputs; ++output)
+    emitted &= outputs[output].emitted;
+
+  return emitted;
+}
+
+void scc_driver_measure(const scc_ir_module_t *module,
+                        scc_driver_metrics_t *metrics) {
+  memset(metrics, 0, sizeof(scc_driver_metrics_t));
+
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    const scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed)
+      continue;
+
+    metrics->num_of_functions += 1;
+
+    for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block)
+      if (!function->blocks[block].removed)
+        metrics->num_of_blocks += 1;
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+      if (scc_ir_instruction_is_live(&function->instructions[i]))
+        metrics->num_of_instructions += 1;
+
+    if (function->num_of_blocks == 0)
+      continue;
+
+    scc_ir_cfg_t *cfg = scc_ir_cfg_compute(function);
+    scc_ir_liveness_t *liveness = scc_ir_liveness_compute(function, cfg);
+
+    scc_ir_pressure_t pressure;
+    scc_ir_liveness_pressure(function, cfg, liveness, &pressure);
+
+    metrics->pressure.values = SCC_MAX(metrics->pressure.values, pressure.values);
+    metrics->pressure.components = SCC_MAX(metrics->pressure.components, pressure.components);
+    metrics->pressure.registers = SCC_MAX(metrics->pressure.registers, pressure.registers);
+
+    scc_ir_liveness_destroy(liveness);
+    scc_ir_cfg_destroy(cfg);
+  }
+}
+
+SCC_END_EXTERN_C
@@ -33,6 +33,19 @@ SCC_BEGIN_EXTERN_C
   // completed. We need both to prevent mutations when paused.
   static scc_uint64_t ops_in_progress_ = 0;
   static scc_uint64_t ops_ = 0;
+
+  // Held while linking or unlinking, as allocators are registered and
+  // deregistered from many threads at once.
+  static scc_uint32_t linking_ = 0;
+
+  static void lock_allocators_(void) {
+    while (scc_atomic_cmp_and_xchg_u32(&linking_, 0, 1) != 0);
+  }
+
+  static void unlock_allocators_(void) {
+    // Exchanged rather than stored, to fence writes to the list.
+    scc_atomic_cmp_and_xchg_u32(&linking_, 1, 0);
+  }
 #endif
 
 scc_bool_t scc_allocators_should_block(void) {
@@ -78,6 +91,8 @@ void scc_allocator_register(scc_allocator_t *allocator) {
 
   while (scc_allocators_should_block());
 
+  lock_allocators_();
+
   scc_allocator_t **head = &allocators_;
 
   if (*head)
@@ -88,6 +103,8 @@ void scc_allocator_register(scc_allocator_t *allocator) {
 
   *head = allocator;
 
+  unlock_allocators_();
+
   scc_atomic_increment_u64(&ops_);
 #endif
 }
@@ -98,11 +115,17 @@ void scc_allocator_deregister(scc_allocator_t *allocator) {
 
   while (scc_allocators_should_block());
 
+  lock_allocators_();
+
   if (allocator->prev)
     allocator->prev->next = allocator->next;
+  else
+    allocators_ = allocator->next;
   if (allocator->next)
     allocator->next->prev = allocator->prev;
 
+  unlock_allocators_();
+
   scc_atomic_increment_u64(&ops_);
 #endif
 }
@@ -0,0 +1,160 @@
+//===-- scc/foundation/arena.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/foundation/arena.h"
+
+#include "scc/foundation/assert.h"
+#include "scc/foundation/utilities.h"
+
+// REFACTOR(mtwilliams): Wrap `memset` et al.
+#include <string.h>
+
+SCC_BEGIN_EXTERN_C
+
+static scc_uintptr_t scc_arena_block_base(scc_arena_block_t *block) {
+  return (scc_uintptr_t)(block + 1);
+}
+
+// Returns offset into `block` that an allocation would start at, or `~0` if
+// it doesn't fit.
+static scc_size_t scc_arena_block_fit(scc_arena_block_t *block,
+                                      scc_size_t offset,
+                                      scc_size_t size,
+                                      scc_size_t alignment) {
+  const scc_uintptr_t base = scc_arena_block_base(block);
+  const scc_uintptr_t aligned = SCC_ALIGN_TO_BOUNDARY(base + offset, alignment);
+
+  if (aligned - base + size > block->size)
+    return ~(scc_size_t)0;
+
+  return (scc_size_t)(aligned - base);
+}
+
+static void *allocate_from_arena_(scc_allocator_t *allocator,
+                                  scc_size_t size,
+                                  scc_size_t alignment) {
+  scc_arena_t *arena = (scc_arena_t *)allocator;
+
+  scc_size_t start = scc_arena_block_fit(arena->current, arena->offset, size, alignment);
+
+  // Reuse blocks left over from before a reset before asking for more.
+  while (start == ~(scc_size_t)0 && arena->current->next) {
+    arena->current = arena->current->next;
+    arena->offset = 0;
+    start = scc_arena_block_fit(arena->current, 0, size, alignment);
+  }
+
+  if (start == ~(scc_size_t)0) {
+    const scc_size_t needed = SCC_MAX(arena->granularity, size + alignment);
+
+    scc_arena_block_t *block =
+      (scc_arena_block_t *)arena->backing->allocate(arena->backing, sizeof(scc_arena_block_t) + needed, 16);
+
+    block->next = NULL;
+    block->size = needed;
+
+    arena->current->next = block;
+    arena->current = block;
+    arena->offset = 0;
+
+  #if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
+    arena->allocator.info.reserved += needed;
+  #endif
+
+    start = scc_arena_block_fit(block, 0, size, alignment);
+  }
+
+  void *ptr = (void *)(scc_arena_block_base(arena->current) + start);
+
+  arena->offset = start + size;
+
+#if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
+  arena->allocator.info.committed += size;
+  arena->allocator.info.allocated += size;
+  arena->allocator.info.allocations += 1;
+#endif
+
+  // We always zero memory, as it prevents an entire class of errors.
+  memset(ptr, 0, size);
+
+  return ptr;
+}
+
+static void free_from_arena_(scc_allocator_t *allocator,
+                             void *ptr) {
+  // Released en masse by `scc_arena_reset`.
+  (void)allocator;
+  (void)ptr;
+
+#if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
+  allocator->info.frees += 1;
+#endif
+}
+
+scc_arena_t *scc_arena_create(scc_allocator_t *backing,
+                              scc_size_t granularity) {
+  scc_assert_paranoid(backing != NULL);
+  scc_assert_paranoid(granularity > 0);
+
+  scc_arena_t *arena =
+    (scc_arena_t *)backing->allocate(backing, sizeof(scc_arena_t), 16);
+
+#if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
+  strcpy(arena->allocator.info.name, "arena");
+  arena->allocator.info.reserved = granularity;
+#endif
+
+  arena->allocator.allocate = &allocate_from_arena_;
+  arena->allocator.free = &free_from_arena_;
+
+  arena->backing = backing;
+  arena->granularity = granularity;
+
+  arena->first =
+    (scc_arena_block_t *)backing->allocate(backing, sizeof(scc_arena_block_t) + granularity, 16);
+
+  arena->first->next = NULL;
+  arena->first->size = granularity;
+
+  arena->current = arena->first;
+  arena->offset = 0;
+
+  scc_allocator_register(&arena->allocator);
+
+  return arena;
+}
+
+void scc_arena_destroy(scc_arena_t *arena) {
+  scc_allocator_deregister(&arena->allocator);
+
+  scc_allocator_t *backing = arena->backing;
+
+  for (scc_arena_block_t *block = arena->first, *next; block; block = next) {
+    next = block->next;
+    backing->free(backing, (void *)block);
+  }
+
+  backing->free(backing, (void *)arena);
+}
+
+void scc_arena_reset(scc_arena_t *arena) {
+#if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
+  arena->allocator.info.freed += arena->allocator.info.committed;
+  arena->allocator.info.committed = 0;
+#endif
+
+  arena->current = arena->first;
+  arena->offset = 0;
+}
+
+SCC_END_EXTERN_C
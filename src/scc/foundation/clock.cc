@@ -0,0 +1,47 @@
+//===-- scc/foundation/clock.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/foundation/clock.h"
+
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  #include <windows.h>
+#elif SCC_PLATFORM == SCC_PLATFORM_MAC
+  #include <mach/mach_time.h>
+#elif SCC_PLATFORM == SCC_PLATFORM_LINUX
+  #include <time.h>
+#endif
+
+SCC_BEGIN_EXTERN_C
+
+scc_uint64_t scc_monotonic_time_in_ns(void) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  LARGE_INTEGER frequency, counter;
+  ::QueryPerformanceFrequency(&frequency);
+  ::QueryPerformanceCounter(&counter);
+  // Split to avoid overflow.
+  const scc_uint64_t seconds = counter.QuadPart / frequency.QuadPart;
+  const scc_uint64_t remainder = counter.QuadPart % frequency.QuadPart;
+  return seconds * 1000000000ull + (remainder * 1000000000ull) / frequency.QuadPart;
+#elif SCC_PLATFORM == SCC_PLATFORM_MAC
+  static mach_timebase_info_data_t timebase = { 0, 0 };
+  if (timebase.denom == 0)
+    mach_timebase_info(&timebase);
+  return (mach_absolute_time() * timebase.numer) / timebase.denom;
+#elif SCC_PLATFORM == SCC_PLATFORM_LINUX
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (scc_uint64_t)ts.tv_sec * 1000000000ull + (scc_uint64_t)ts.tv_nsec;
+#endif
+}
+
+SCC_END_EXTERN_C
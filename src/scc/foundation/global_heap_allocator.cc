@@ -15,6 +15,9 @@
 
 #include "scc/foundation/atomics.h"
 #include "scc/foundation/assert.h"
+#include "scc/foundation/utilities.h"
+
+#include <stdlib.h>
 
 // REFACTOR(mtwilliams): Wrap `memset` et al.
 #include <string.h>
@@ -28,6 +31,17 @@ SCC_BEGIN_EXTERN_C
 static scc_allocator_t global_heap_allocator_;
 static scc_uint32_t initialized_ = 0;
 
+#if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
+  // Statistics are updated atomically, as the heap is shared by threads.
+  static void tally_(scc_size_t *statistic, scc_size_t amount) {
+  #if SCC_ARCHITECTURE == SCC_ARCHITECTURE_X86
+    scc_atomic_add_u32((volatile scc_uint32_t *)statistic, (scc_uint32_t)amount);
+  #elif SCC_ARCHITECTURE == SCC_ARCHITECTURE_X86_64
+    scc_atomic_add_u64((volatile scc_uint64_t *)statistic, (scc_uint64_t)amount);
+  #endif
+  }
+#endif
+
 
 static void *allocate_from_global_heap_(scc_allocator_t *global_heap_allocator,
                                         scc_size_t size,
@@ -35,13 +49,17 @@ static void *allocate_from_global_heap_(scc_allocator_t *global_heap_allocator,
 #if SCC_COMPILER == SCC_COMPILER_MSVC
   void *ptr = _aligned_malloc(size, alignment);
 #else
+  // Alignment must be at least that of a pointer.
+  void *ptr = NULL;
+  if (posix_memalign(&ptr, SCC_MAX(alignment, sizeof(void *)), size) != 0)
+    ptr = NULL;
 #endif
 
 #if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
-  global_heap_allocator->info.reserved += size;
-  global_heap_allocator->info.committed += size;
-  global_heap_allocator->info.allocated += size;
-  global_heap_allocator->info.allocations += 1;
+  tally_(&global_heap_allocator->info.reserved, size);
+  tally_(&global_heap_allocator->info.committed, size);
+  tally_(&global_heap_allocator->info.allocated, size);
+  tally_(&global_heap_allocator->info.allocations, 1);
 #endif
 
   // Will return `NULL` if out of memory.
@@ -60,6 +78,7 @@ static void free_from_global_heap_(scc_allocator_t *global_heap_allocator,
 #if SCC_COMPILER == SCC_COMPILER_MSVC
   _aligned_free(ptr);
 #else
+  free(ptr);
 #endif
 
 #if SCC_CONFIGURATION == SCC_CONFIGURATION_DEBUG
@@ -69,7 +88,7 @@ static void free_from_global_heap_(scc_allocator_t *global_heap_allocator,
   global_heap_allocator->info.committed -= size;
   global_heap_allocator->info.freed += size;
 #endif
-  global_heap_allocator->info.frees += 1;
+  tally_(&global_heap_allocator->info.frees, 1);
 #endif
 }
 
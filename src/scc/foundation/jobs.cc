@@ -0,0 +1,342 @@
+//===-- scc/foundation/jobs.cc --------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/foundation/jobs.h"
+
+#include "scc/foundation/atomics.h"
+#include "scc/foundation/assert.h"
+#include "scc/foundation/global_heap_allocator.h"
+
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  #include <windows.h>
+#elif (SCC_PLATFORM == SCC_PLATFORM_MAC) || \
+      (SCC_PLATFORM == SCC_PLATFORM_LINUX)
+  #include <pthread.h>
+  #include <unistd.h>
+#endif
+
+SCC_BEGIN_EXTERN_C
+
+// PERF(mtwilliams): Spin briefly before sleeping? Batches tend to be submitted
+// back to back, so workers often go to sleep just before they're needed.
+
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  typedef HANDLE scc_job_thread_t;
+  typedef CRITICAL_SECTION scc_job_lock_t;
+  typedef CONDITION_VARIABLE scc_job_condition_t;
+#elif (SCC_PLATFORM == SCC_PLATFORM_MAC) || \
+      (SCC_PLATFORM == SCC_PLATFORM_LINUX)
+  typedef pthread_t scc_job_thread_t;
+  typedef pthread_mutex_t scc_job_lock_t;
+  typedef pthread_cond_t scc_job_condition_t;
+#endif
+
+typedef struct scc_job_worker {
+  struct scc_job_system *jobs;
+  scc_uint32_t thread;
+  scc_job_thread_t handle;
+} scc_job_worker_t;
+
+struct scc_job_system {
+  scc_uint32_t num_of_threads;
+
+  // One less than `num_of_threads`, as the submitting thread does its share.
+  scc_job_worker_t *workers;
+
+  // Serializes submission of batches.
+  scc_job_lock_t submission;
+
+  // Guards everything below.
+  scc_job_lock_t lock;
+
+  // Signaled when a batch is submitted, or when workers should quit.
+  scc_job_condition_t wake;
+
+  // Signaled when the last worker finishes its share of a batch.
+  scc_job_condition_t done;
+
+  // Batch being run.
+  scc_job_fn fn;
+  void *context;
+  scc_uint32_t count;
+
+  // Next job to hand out. Incremented without holding `lock`.
+  volatile scc_uint32_t next;
+
+  // Incremented for each batch, so workers can tell a new batch apart from
+  // spurious wakeups.
+  scc_uint32_t generation;
+
+  // Number of workers still working on the batch.
+  scc_uint32_t pending;
+
+  scc_bool_t quit;
+};
+
+static void scc_job_lock_init(scc_job_lock_t *lock) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::InitializeCriticalSection(lock);
+#else
+  pthread_mutex_init(lock, NULL);
+#endif
+}
+
+static void scc_job_lock_destroy(scc_job_lock_t *lock) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::DeleteCriticalSection(lock);
+#else
+  pthread_mutex_destroy(lock);
+#endif
+}
+
+static void scc_job_lock(scc_job_lock_t *lock) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::EnterCriticalSection(lock);
+#else
+  pthread_mutex_lock(lock);
+#endif
+}
+
+static void scc_job_unlock(scc_job_lock_t *lock) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::LeaveCriticalSection(lock);
+#else
+  pthread_mutex_unlock(lock);
+#endif
+}
+
+static void scc_job_condition_init(scc_job_condition_t *condition) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::InitializeConditionVariable(condition);
+#else
+  pthread_cond_init(condition, NULL);
+#endif
+}
+
+static void scc_job_condition_destroy(scc_job_condition_t *condition) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  // Nothing to do.
+#else
+  pthread_cond_destroy(condition);
+#endif
+}
+
+static void scc_job_wait(scc_job_condition_t *condition,
+                         scc_job_lock_t *lock) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::SleepConditionVariableCS(condition, lock, INFINITE);
+#else
+  pthread_cond_wait(condition, lock);
+#endif
+}
+
+static void scc_job_signal(scc_job_condition_t *condition) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::WakeConditionVariable(condition);
+#else
+  pthread_cond_signal(condition);
+#endif
+}
+
+static void scc_job_broadcast(scc_job_condition_t *condition) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  ::WakeAllConditionVariable(condition);
+#else
+  pthread_cond_broadcast(condition);
+#endif
+}
+
+// Runs jobs from the current batch until there are none left to hand out.
+static void scc_job_system_drain(scc_job_system_t *jobs,
+                                 scc_uint32_t thread) {
+  for (;;) {
+    const scc_uint32_t index = scc_atomic_increment_u32(&jobs->next);
+
+    if (index >= jobs->count)
+      break;
+
+    jobs->fn(jobs->context, index, thread);
+  }
+}
+
+static void scc_job_worker_main(scc_job_worker_t *worker) {
+  scc_job_system_t *jobs = worker->jobs;
+
+  scc_uint32_t generation = 0;
+
+  for (;;) {
+    scc_job_lock(&jobs->lock);
+
+    while (!jobs->quit && jobs->generation == generation)
+      scc_job_wait(&jobs->wake, &jobs->lock);
+
+    if (jobs->quit) {
+      scc_job_unlock(&jobs->lock);
+      return;
+    }
+
+    generation = jobs->generation;
+
+    scc_job_unlock(&jobs->lock);
+
+    scc_job_system_drain(jobs, worker->thread);
+
+    scc_job_lock(&jobs->lock);
+
+    if (--jobs->pending == 0)
+      scc_job_signal(&jobs->done);
+
+    scc_job_unlock(&jobs->lock);
+  }
+}
+
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  static DWORD WINAPI scc_job_worker_entry(LPVOID worker) {
+    scc_job_worker_main((scc_job_worker_t *)worker);
+    return 0;
+  }
+#else
+  static void *scc_job_worker_entry(void *worker) {
+    scc_job_worker_main((scc_job_worker_t *)worker);
+    return NULL;
+  }
+#endif
+
+scc_uint32_t scc_num_of_cores(void) {
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  SYSTEM_INFO info;
+  ::GetSystemInfo(&info);
+  return (scc_uint32_t)info.dwNumberOfProcessors;
+#else
+  const long cores = sysconf(_SC_NPROCESSORS_ONLN);
+  return (cores > 0) ? (scc_uint32_t)cores : 1;
+#endif
+}
+
+scc_job_system_t *scc_job_system_create(scc_uint32_t num_of_threads) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (num_of_threads == 0)
+    num_of_threads = scc_num_of_cores();
+
+  scc_job_system_t *jobs =
+    (scc_job_system_t *)heap->allocate(heap, sizeof(scc_job_system_t), 16);
+
+  jobs->num_of_threads = num_of_threads;
+
+  scc_job_lock_init(&jobs->submission);
+  scc_job_lock_init(&jobs->lock);
+  scc_job_condition_init(&jobs->wake);
+  scc_job_condition_init(&jobs->done);
+
+  const scc_uint32_t num_of_workers = num_of_threads - 1;
+
+  if (num_of_workers == 0)
+    return jobs;
+
+  jobs->workers =
+    (scc_job_worker_t *)heap->allocate(heap, num_of_workers * sizeof(scc_job_worker_t), 16);
+
+  for (scc_uint32_t worker = 0; worker < num_of_workers; ++worker) {
+    jobs->workers[worker].jobs = jobs;
+    jobs->workers[worker].thread = worker + 1;
+
+  #if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+    jobs->workers[worker].handle =
+      ::CreateThread(NULL, 0, &scc_job_worker_entry, (LPVOID)&jobs->workers[worker], 0, NULL);
+    scc_assert_paranoid(jobs->workers[worker].handle != NULL);
+  #else
+    const int failed =
+      pthread_create(&jobs->workers[worker].handle, NULL, &scc_job_worker_entry, (void *)&jobs->workers[worker]);
+    scc_assert_paranoid(failed == 0);
+  #endif
+  }
+
+  return jobs;
+}
+
+void scc_job_system_destroy(scc_job_system_t *jobs) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_job_lock(&jobs->lock);
+  jobs->quit = SCC_TRUE;
+  scc_job_broadcast(&jobs->wake);
+  scc_job_unlock(&jobs->lock);
+
+  for (scc_uint32_t worker = 0; worker < jobs->num_of_threads - 1; ++worker) {
+  #if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+    ::WaitForSingleObject(jobs->workers[worker].handle, INFINITE);
+    ::CloseHandle(jobs->workers[worker].handle);
+  #else
+    pthread_join(jobs->workers[worker].handle, NULL);
+  #endif
+  }
+
+  scc_job_condition_destroy(&jobs->done);
+  scc_job_condition_destroy(&jobs->wake);
+  scc_job_lock_destroy(&jobs->lock);
+  scc_job_lock_destroy(&jobs->submission);
+
+  if (jobs->workers)
+    heap->free(heap, (void *)jobs->workers);
+
+  heap->free(heap, (void *)jobs);
+}
+
+scc_uint32_t scc_job_system_num_of_threads(const scc_job_system_t *jobs) {
+  return jobs->num_of_threads;
+}
+
+void scc_job_system_for_each(scc_job_system_t *jobs,
+                             scc_uint32_t count,
+                             scc_job_fn fn,
+                             void *context) {
+  // Taken even when running inline, as the submitting thread borrows the
+  // identity of thread zero and its resources.
+  scc_job_lock(&jobs->submission);
+
+  // Not worth waking anyone.
+  if (jobs->num_of_threads == 1 || count <= 1) {
+    for (scc_uint32_t index = 0; index < count; ++index)
+      fn(context, index, 0);
+    scc_job_unlock(&jobs->submission);
+    return;
+  }
+
+  scc_job_lock(&jobs->lock);
+
+  jobs->fn = fn;
+  jobs->context = context;
+  jobs->count = count;
+  jobs->next = 0;
+  jobs->pending = jobs->num_of_threads - 1;
+  jobs->generation += 1;
+
+  scc_job_broadcast(&jobs->wake);
+
+  scc_job_unlock(&jobs->lock);
+
+  scc_job_system_drain(jobs, 0);
+
+  // Wait for stragglers, as they may still be running jobs.
+  scc_job_lock(&jobs->lock);
+
+  while (jobs->pending > 0)
+    scc_job_wait(&jobs->done, &jobs->lock);
+
+  scc_job_unlock(&jobs->lock);
+
+  scc_job_unlock(&jobs->submission);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,1282 @@
+//===-- scc/ir.cc ---------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir.h"
+
+// REFACTOR(mtwilliams): Move into header.
+#include <stdio.h>
+
+SCC_BEGIN_EXTERN_C
+
+const scc_ir_operation_info_t SCC_IR_OPERATIONS[SCC_IR_NUM_OF_OPERATIONS] = {
+  #define OP(Mnemonic, Code, Inputs, Returns, Flags, Description) \
+    { #Mnemonic, Inputs, Returns, Flags, Description },
+
+    #include "scc/ir/operations.inl"
+
+  #undef OP
+};
+
+// Grows `array` so it can hold at least `needed` elements of `stride` bytes.
+static void *scc_ir_grow(void *array,
+                         scc_uint32_t *size,
+                         scc_uint32_t needed,
+                         scc_size_t stride) {
+  if (needed <= *size)
+    return array;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_uint32_t grown = *size ? *size : 16;
+  while (grown < needed)
+    grown *= 2;
+
+  void *reallocated = heap->allocate(heap, grown * stride, 16);
+
+  if (array) {
+    memcpy(reallocated, array, *size * stride);
+    heap->free(heap, array);
+  }
+
+  *size = grown;
+
+  return reallocated;
+}
+
+// PERF(mtwilliams): Use a better hash than FNV-1a.
+static scc_uint32_t scc_ir_hash(const void *data, scc_size_t length) {
+  const scc_uint8_t *bytes = (const scc_uint8_t *)data;
+
+  scc_uint32_t hash = 2166136261u;
+
+  for (scc_size_t byte = 0; byte < length; ++byte) {
+    hash ^= bytes[byte];
+    hash *= 16777619u;
+  }
+
+  return hash;
+}
+
+static void scc_ir_free(void *ptr) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (ptr)
+    heap->free(heap, ptr);
+}
+
+//===----------------------------------------------------------------------===//
+// Types
+//===----------------------------------------------------------------------===//
+
+scc_uint32_t scc_ir_scalar_size(scc_ir_type_t type) {
+  switch (type.scalar) {
+    case SCC_IR_BOOL: return 4;
+    case SCC_IR_I8: case SCC_IR_U8: return 1;
+    case SCC_IR_I16: case SCC_IR_U16: return 2;
+    case SCC_IR_I32: case SCC_IR_U32: case SCC_IR_F32: return 4;
+    case SCC_IR_I64: case SCC_IR_U64: case SCC_IR_F64: return 8;
+  }
+
+  return 0;
+}
+
+static const char *SCALARS[] = {
+  "void", "bool",
+  "i8", "i16", "i32", "i64",
+  "u8", "u16", "u32", "u64",
+  "f32", "f64"
+};
+
+const char *scc_ir_type_name(scc_ir_type_t type,
+                             char *buffer,
+                             scc_size_t size) {
+  scc_assert_paranoid(buffer != NULL);
+
+  if (type.scalar == SCC_IR_STRUCTURE)
+    snprintf(buffer, size, "struct#%u", type.structure);
+  else if ((type.rows <= 1) && (type.columns <= 1))
+    snprintf(buffer, size, "%s", SCALARS[type.scalar]);
+  else
+    snprintf(buffer, size, "%s<%ux%u>", SCALARS[type.scalar], type.rows, type.columns);
+
+  return buffer;
+}
+
+scc_uint32_t scc_ir_type_size(const scc_ir_module_t *module,
+                              scc_ir_type_t type) {
+  if (type.scalar != SCC_IR_STRUCTURE)
+    return scc_ir_scalar_size(type) * scc_ir_type_num_of_components(type);
+
+  const scc_ir_structure_t *structure = &module->structures[type.structure];
+
+  scc_uint32_t size = 0;
+
+  for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+    const scc_ir_member_t *def = &module->members[structure->first_member + member];
+    size = SCC_MAX(size, def->offset + scc_ir_type_size(module, def->type));
+  }
+
+  return size;
+}
+
+//===----------------------------------------------------------------------===//
+// Module
+//===----------------------------------------------------------------------===//
+
+scc_ir_module_t *scc_ir_module_create(scc_program_type_t type) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_module_t *module =
+    (scc_ir_module_t *)heap->allocate(heap, sizeof(scc_ir_module_t), 16);
+
+  module->type = type;
+
+  // Offset zero is reserved for the empty string.
+  module->strings = (char *)scc_ir_grow(NULL, &module->size_of_strings, 256, 1);
+  module->strings[0] = '\0';
+  module->num_of_strings = 1;
+
+  module->entry = SCC_IR_NONE;
+  module->precompute = SCC_IR_NONE;
+
+  return module;
+}
+
+static void scc_ir_function_destroy(scc_ir_function_t *function) {
+  scc_ir_free(function->arguments);
+  scc_ir_free(function->blocks);
+  scc_ir_free(function->instructions);
+  scc_ir_free(function->operands);
+  scc_ir_free(function->constants);
+  scc_ir_free(function->interned);
+  scc_ir_free(function);
+}
+
+void scc_ir_module_destroy(scc_ir_module_t *module) {
+  scc_assert_paranoid(module != NULL);
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function)
+    scc_ir_function_destroy(module->functions[function]);
+
+  scc_ir_free(module->strings);
+  scc_ir_free(module->interned);
+  scc_ir_free(module->structures);
+  scc_ir_free(module->members);
+  scc_ir_free(module->globals);
+  scc_ir_free(module->functions);
+  scc_ir_free(module);
+}
+
+// Copies `count` elements of `stride` bytes from `array`, or returns `NULL`
+// if there are none.
+static void *scc_ir_copy(const void *array,
+                         scc_uint32_t count,
+                         scc_size_t stride) {
+  if (!array || (count == 0))
+    return NULL;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  void *copy = heap->allocate(heap, count * stride, 16);
+  memcpy(copy, array, count * stride);
+
+  return copy;
+}
+
+static scc_ir_function_t *scc_ir_function_clone(const scc_ir_function_t *function,
+                                                scc_ir_module_t *module) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_function_t *clone =
+    (scc_ir_function_t *)heap->allocate(heap, sizeof(scc_ir_function_t), 16);
+
+  *clone = *function;
+
+  clone->module = module;
+
+  // Arrays are sized to fit, and grow as usual if added to.
+  clone->arguments = (scc_ir_argument_t *)scc_ir_copy(function->arguments, function->num_of_arguments, sizeof(scc_ir_argument_t));
+  clone->size_of_arguments = clone->arguments ? function->num_of_arguments : 0;
+
+  clone->blocks = (scc_ir_block_t *)scc_ir_copy(function->blocks, function->num_of_blocks, sizeof(scc_ir_block_t));
+  clone->size_of_blocks = clone->blocks ? function->num_of_blocks : 0;
+
+  clone->instructions = (scc_ir_instruction_t *)scc_ir_copy(function->instructions, function->num_of_instructions, sizeof(scc_ir_instruction_t));
+  clone->size_of_instructions = clone->instructions ? function->num_of_instructions : 0;
+
+  clone->operands = (scc_ir_value_t *)scc_ir_copy(function->operands, function->num_of_operands, sizeof(scc_ir_value_t));
+  clone->size_of_operands = clone->operands ? function->num_of_operands : 0;
+
+  clone->constants = (scc_ir_constant_t *)scc_ir_copy(function->constants, function->num_of_constants, sizeof(scc_ir_constant_t));
+  clone->size_of_constants = clone->constants ? function->num_of_constants : 0;
+
+  // Hashed by size, so copied whole.
+  clone->interned = (scc_uint32_t *)scc_ir_copy(function->interned, function->size_of_interned, sizeof(scc_uint32_t));
+  clone->size_of_interned = clone->interned ? function->size_of_interned : 0;
+
+  return clone;
+}
+
+scc_ir_module_t *scc_ir_module_clone(const scc_ir_module_t *module) {
+  scc_assert_paranoid(module != NULL);
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_module_t *clone =
+    (scc_ir_module_t *)heap->allocate(heap, sizeof(scc_ir_module_t), 16);
+
+  *clone = *module;
+
+  clone->strings = (char *)scc_ir_copy(module->strings, module->num_of_strings, 1);
+  clone->size_of_strings = module->num_of_strings;
+
+  clone->interned = (scc_ir_string_t *)scc_ir_copy(module->interned, module->size_of_interned, sizeof(scc_ir_string_t));
+  clone->size_of_interned = clone->interned ? module->size_of_interned : 0;
+
+  clone->structures = (scc_ir_structure_t *)scc_ir_copy(module->structures, module->num_of_structures, sizeof(scc_ir_structure_t));
+  clone->size_of_structures = clone->structures ? module->num_of_structures : 0;
+
+  clone->members = (scc_ir_member_t *)scc_ir_copy(module->members, module->num_of_members, sizeof(scc_ir_member_t));
+  clone->size_of_members = clone->members ? module->num_of_members : 0;
+
+  clone->globals = (scc_ir_global_t *)scc_ir_copy(module->globals, module->num_of_globals, sizeof(scc_ir_global_t));
+  clone->size_of_globals = clone->globals ? module->num_of_globals : 0;
+
+  clone->functions = (scc_ir_function_t **)scc_ir_copy(module->functions, module->num_of_functions, sizeof(scc_ir_function_t *));
+  clone->size_of_functions = clone->functions ? module->num_of_functions : 0;
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function)
+    clone->functions[function] = scc_ir_function_clone(module->functions[function], clone);
+
+  return clone;
+}
+
+static void scc_ir_module_rehash_strings(scc_ir_module_t *module) {
+  const scc_uint32_t size = module->size_of_interned ? module->size_of_interned * 2 : 64;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_string_t *interned =
+    (scc_ir_string_t *)heap->allocate(heap, size * sizeof(scc_ir_string_t), 16);
+
+  for (scc_uint32_t slot = 0; slot < module->size_of_interned; ++slot) {
+    const scc_ir_string_t string = module->interned[slot];
+
+    if (string == 0)
+      continue;
+
+    const char *characters = &module->strings[string];
+    scc_uint32_t probe = scc_ir_hash(characters, strlen(characters)) & (size - 1);
+
+    while (interned[probe])
+      probe = (probe + 1) & (size - 1);
+
+    interned[probe] = string;
+  }
+
+  scc_ir_free(module->interned);
+
+  module->interned = interned;
+  module->size_of_interned = size;
+}
+
+scc_ir_string_t scc_ir_module_intern(scc_ir_module_t *module,
+                                     const char *string) {
+  scc_assert_paranoid(module != NULL);
+
+  if (!string || (string[0] == '\0'))
+    return 0;
+
+  // Keep load factor under a half.
+  if ((module->num_of_interned + 1) * 2 > module->size_of_interned)
+    scc_ir_module_rehash_strings(module);
+
+  const scc_size_t length = strlen(string);
+  const scc_uint32_t mask = module->size_of_interned - 1;
+
+  scc_uint32_t probe = scc_ir_hash(string, length) & mask;
+
+  while (const scc_ir_string_t candidate = module->interned[probe]) {
+    if (strcmp(&module->strings[candidate], string) == 0)
+      return candidate;
+    probe = (probe + 1) & mask;
+  }
+
+  const scc_ir_string_t offset = module->num_of_strings;
+
+  module->strings = (char *)scc_ir_grow(module->strings,
+                                        &module->size_of_strings,
+                                        offset + (scc_uint32_t)length + 1,
+                                        1);
+
+  memcpy(&module->strings[offset], string, length + 1);
+
+  module->num_of_strings += (scc_uint32_t)length + 1;
+
+  module->interned[probe] = offset;
+  module->num_of_interned += 1;
+
+  return offset;
+}
+
+scc_uint32_t scc_ir_module_add_structure(scc_ir_module_t *module,
+                                         const char *name) {
+  module->structures = (scc_ir_structure_t *)scc_ir_grow(module->structures,
+                                                         &module->size_of_structures,
+                                                         module->num_of_structures + 1,
+                                                         sizeof(scc_ir_structure_t));
+
+  const scc_uint32_t index = module->num_of_structures++;
+
+  scc_ir_structure_t *structure = &module->structures[index];
+
+  structure->name = scc_ir_module_intern(module, name);
+  structure->first_member = module->num_of_members;
+  structure->num_of_members = 0;
+
+  return index;
+}
+
+scc_uint32_t scc_ir_module_add_member(scc_ir_module_t *module,
+                                      scc_uint32_t structure,
+                                      const char *name,
+                                      scc_ir_type_t type,
+                                      scc_uint32_t offset) {
+  scc_assert_paranoid(structure < module->num_of_structures);
+
+  // Members are stored contiguously.
+  scc_assert_debug(module->structures[structure].first_member
+                 + module->structures[structure].num_of_members
+                == module->num_of_members);
+
+  module->members = (scc_ir_member_t *)scc_ir_grow(module->members,
+                                                   &module->size_of_members,
+                                                   module->num_of_members + 1,
+                                                   sizeof(scc_ir_member_t));
+
+  const scc_uint32_t index = module->num_of_members++;
+
+  scc_ir_member_t *member = &module->members[index];
+
+  member->name = scc_ir_module_intern(module, name);
+  member->type = type;
+  member->offset = offset;
+
+  module->structures[structure].num_of_members += 1;
+
+  return index - module->structures[structure].first_member;
+}
+
+scc_uint32_t scc_ir_module_add_global(scc_ir_module_t *module,
+                                      const char *name,
+                                      scc_ir_storage_t storage,
+                                      scc_ir_type_t type,
+                                      scc_uint32_t binding) {
+  module->globals = (scc_ir_global_t *)scc_ir_grow(module->globals,
+                                                   &module->size_of_globals,
+                                                   module->num_of_globals + 1,
+                                                   sizeof(scc_ir_global_t));
+
+  const scc_uint32_t index = module->num_of_globals++;
+
+  scc_ir_global_t *global = &module->globals[index];
+
+  global->name = scc_ir_module_intern(module, name);
+  global->storage = storage;
+  global->type = type;
+  global->binding = binding;
+  global->offset = 0;
+  global->builtin = SCC_IR_BUILTIN_NONE;
+  global->consumed = 0;
+
+  return index;
+}
+
+scc_ir_function_t *scc_ir_module_add_function(scc_ir_module_t *module,
+                                              const char *name,
+                                              scc_ir_type_t return_type) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  module->functions = (scc_ir_function_t **)scc_ir_grow(module->functions,
+                                                        &module->size_of_functions,
+                                                        module->num_of_functions + 1,
+                                                        sizeof(scc_ir_function_t *));
+
+  scc_ir_function_t *function =
+    (scc_ir_function_t *)heap->allocate(heap, sizeof(scc_ir_function_t), 16);
+
+  function->module = module;
+  function->index = module->num_of_functions;
+  function->name = scc_ir_module_intern(module, name);
+  function->return_type = return_type;
+  function->removed = SCC_FALSE;
+
+  module->functions[module->num_of_functions++] = function;
+
+  return function;
+}
+
+scc_ir_function_t *scc_ir_module_find_function(const scc_ir_module_t *module,
+                                               const char *name) {
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function) {
+    scc_ir_function_t *candidate = module->functions[function];
+
+    if (candidate->removed)
+      continue;
+
+    if (strcmp(&module->strings[candidate->name], name) == 0)
+      return candidate;
+  }
+
+  return NULL;
+}
+
+void scc_ir_module_remove_function(scc_ir_module_t *module,
+                                   scc_uint32_t function) {
+  scc_assert_paranoid(function < module->num_of_functions);
+
+  // Entry point can't be removed, nor can what precomputes for it.
+  scc_assert_debug(function != module->entry);
+  scc_assert_debug(function != module->precompute);
+
+  scc_ir_function_t *removing = module->functions[function];
+
+  const scc_ir_string_t name = removing->name;
+
+  scc_ir_free(removing->arguments);
+  scc_ir_free(removing->blocks);
+  scc_ir_free(removing->instructions);
+  scc_ir_free(removing->operands);
+  scc_ir_free(removing->constants);
+  scc_ir_free(removing->interned);
+
+  // Keep the husk so indices of other functions remain stable.
+  memset(removing, 0, sizeof(scc_ir_function_t));
+
+  removing->module = module;
+  removing->index = function;
+  removing->name = name;
+  removing->removed = SCC_TRUE;
+}
+
+// Renumbers references to globals in every function, per `renumbering`.
+static void scc_ir_module_renumber_globals(scc_ir_module_t *module,
+                                           const scc_uint32_t *renumbering) {
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed)
+      continue;
+
+    for (scc_uint32_t instruction = 0; instruction < function->num_of_instructions; ++instruction) {
+      const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+      if (!scc_ir_instruction_is_live(user))
+        continue;
+
+      scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+      for (scc_uint32_t operand = 0; operand < user->num_of_operands; ++operand) {
+        if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_GLOBAL)
+          continue;
+
+        const scc_uint32_t renumbered = renumbering[SCC_IR_VALUE_INDEX(operands[operand])];
+
+        // Removed while still referenced?
+        scc_assert_debug(renumbered != SCC_IR_NONE);
+
+        operands[operand] = SCC_IR_VALUE(SCC_IR_VALUE_GLOBAL, renumbered);
+      }
+    }
+  }
+}
+
+// Renumbers references to members of `structure` in every function, per
+// `renumbering`.
+static void scc_ir_module_renumber_members(scc_ir_module_t *module,
+                                           scc_uint32_t structure,
+                                           const scc_uint32_t *renumbering) {
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed)
+      continue;
+
+    for (scc_uint32_t instruction = 0; instruction < function->num_of_instructions; ++instruction) {
+      const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+      if (!scc_ir_instruction_is_live(user) || (user->num_of_operands < 2))
+        continue;
+
+      scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+      if ((SCC_IR_VALUE_KIND(operands[0]) != SCC_IR_VALUE_GLOBAL)
+       || (SCC_IR_VALUE_KIND(operands[1]) != SCC_IR_VALUE_MEMBER))
+        continue;
+
+      const scc_ir_type_t type = module->globals[SCC_IR_VALUE_INDEX(operands[0])].type;
+
+      if ((type.scalar != SCC_IR_STRUCTURE) || (type.structure != structure))
+        continue;
+
+      const scc_uint32_t renumbered = renumbering[SCC_IR_VALUE_INDEX(operands[1])];
+
+      // Removed while still referenced?
+      scc_assert_debug(renumbered != SCC_IR_NONE);
+
+      operands[1] = SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, renumbered);
+    }
+  }
+}
+
+void scc_ir_module_remove_globals(scc_ir_module_t *module,
+                                  const scc_bool_t *removing) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_uint32_t *renumbering =
+    (scc_uint32_t *)heap->allocate(heap, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t num_of_globals = 0;
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global) {
+    if (removing[global]) {
+      renumbering[global] = SCC_IR_NONE;
+      continue;
+    }
+
+    renumbering[global] = num_of_globals;
+    module->globals[num_of_globals++] = module->globals[global];
+  }
+
+  module->num_of_globals = num_of_globals;
+
+  scc_ir_module_renumber_globals(module, renumbering);
+
+  heap->free(heap, renumbering);
+}
+
+void scc_ir_module_reorder_globals(scc_ir_module_t *module,
+                                   const scc_uint32_t *order) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t count = module->num_of_globals;
+
+  scc_uint32_t *renumbering =
+    (scc_uint32_t *)heap->allocate(heap, (count + 1) * sizeof(scc_uint32_t), 16);
+  scc_ir_global_t *globals =
+    (scc_ir_global_t *)heap->allocate(heap, (count + 1) * sizeof(scc_ir_global_t), 16);
+
+  for (scc_uint32_t position = 0; position < count; ++position) {
+    renumbering[order[position]] = position;
+    globals[position] = module->globals[order[position]];
+  }
+
+  memcpy(module->globals, globals, count * sizeof(scc_ir_global_t));
+
+  scc_ir_module_renumber_globals(module, renumbering);
+
+  heap->free(heap, globals);
+  heap->free(heap, renumbering);
+}
+
+void scc_ir_module_remove_members(scc_ir_module_t *module,
+                                  scc_uint32_t structure,
+                                  const scc_bool_t *removing) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_assert_paranoid(structure < module->num_of_structures);
+
+  const scc_uint32_t first = module->structures[structure].first_member;
+  const scc_uint32_t count = module->structures[structure].num_of_members;
+
+  scc_uint32_t *renumbering =
+    (scc_uint32_t *)heap->allocate(heap, (count + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t num_of_members = 0;
+
+  for (scc_uint32_t member = 0; member < count; ++member) {
+    if (removing[member]) {
+      renumbering[member] = SCC_IR_NONE;
+      continue;
+    }
+
+    renumbering[member] = num_of_members;
+    module->members[first + num_of_members++] = module->members[first + member];
+  }
+
+  const scc_uint32_t removed = count - num_of_members;
+
+  // Members of later structures move down to keep them contiguous.
+  memmove(&module->members[first + num_of_members],
+          &module->members[first + count],
+          (module->num_of_members - first - count) * sizeof(scc_ir_member_t));
+
+  module->num_of_members -= removed;
+  module->structures[structure].num_of_members = num_of_members;
+
+  for (scc_uint32_t other = 0; other < module->num_of_structures; ++other)
+    if ((other != structure) && (module->structures[other].first_member >= first + count))
+      module->structures[other].first_member -= removed;
+
+  scc_ir_module_renumber_members(module, structure, renumbering);
+
+  heap->free(heap, renumbering);
+}
+
+void scc_ir_module_reorder_members(scc_ir_module_t *module,
+                                   scc_uint32_t structure,
+                                   const scc_uint32_t *order) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_assert_paranoid(structure < module->num_of_structures);
+
+  const scc_uint32_t first = module->structures[structure].first_member;
+  const scc_uint32_t count = module->structures[structure].num_of_members;
+
+  scc_uint32_t *renumbering =
+    (scc_uint32_t *)heap->allocate(heap, (count + 1) * sizeof(scc_uint32_t), 16);
+  scc_ir_member_t *members =
+    (scc_ir_member_t *)heap->allocate(heap, (count + 1) * sizeof(scc_ir_member_t), 16);
+
+  for (scc_uint32_t position = 0; position < count; ++position) {
+    renumbering[order[position]] = position;
+    members[position] = module->members[first + order[position]];
+  }
+
+  memcpy(&module->members[first], members, count * sizeof(scc_ir_member_t));
+
+  scc_ir_module_renumber_members(module, structure, renumbering);
+
+  heap->free(heap, members);
+  heap->free(heap, renumbering);
+}
+
+//===----------------------------------------------------------------------===//
+// Functions
+//===----------------------------------------------------------------------===//
+
+scc_ir_value_t scc_ir_function_add_argument(scc_ir_function_t *function,
+                                            const char *name,
+                                            scc_ir_type_t type) {
+  function->arguments = (scc_ir_argument_t *)scc_ir_grow(function->arguments,
+                                                         &function->size_of_arguments,
+                                                         function->num_of_arguments + 1,
+                                                         sizeof(scc_ir_argument_t));
+
+  const scc_uint32_t index = function->num_of_arguments++;
+
+  function->arguments[index].name = scc_ir_module_intern(function->module, name);
+  function->arguments[index].type = type;
+
+  return SCC_IR_VALUE(SCC_IR_VALUE_ARGUMENT, index);
+}
+
+scc_uint32_t scc_ir_function_add_block(scc_ir_function_t *function,
+                                       const char *name) {
+  function->blocks = (scc_ir_block_t *)scc_ir_grow(function->blocks,
+                                                   &function->size_of_blocks,
+                                                   function->num_of_blocks + 1,
+                                                   sizeof(scc_ir_block_t));
+
+  const scc_uint32_t index = function->num_of_blocks++;
+
+  scc_ir_block_t *block = &function->blocks[index];
+
+  block->name = scc_ir_module_intern(function->module, name);
+  block->first = SCC_IR_NONE;
+  block->last = SCC_IR_NONE;
+  block->removed = SCC_FALSE;
+
+  return index;
+}
+
+static scc_uint32_t scc_ir_constant_hash(const scc_ir_constant_t *constant) {
+  const scc_uint32_t components = scc_ir_type_num_of_components(constant->type);
+
+  scc_uint32_t hash = scc_ir_hash(&constant->type, 4);
+  hash ^= scc_ir_hash(&constant->components[0], components * sizeof(scc_ir_component_t));
+
+  return hash;
+}
+
+static scc_bool_t scc_ir_constant_is_equal(const scc_ir_constant_t *a,
+                                           const scc_ir_constant_t *b) {
+  if (!scc_ir_type_is_equal(a->type, b->type))
+    return SCC_FALSE;
+
+  const scc_uint32_t components = scc_ir_type_num_of_components(a->type);
+
+  return memcmp(&a->components[0],
+                &b->components[0],
+                components * sizeof(scc_ir_component_t)) == 0;
+}
+
+static void scc_ir_function_rehash_constants(scc_ir_function_t *function,
+                                             scc_uint32_t size) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_uint32_t *interned =
+    (scc_uint32_t *)heap->allocate(heap, size * sizeof(scc_uint32_t), 16);
+
+  memset(interned, 0xff, size * sizeof(scc_uint32_t));
+
+  for (scc_uint32_t constant = 0; constant < function->num_of_constants; ++constant) {
+    scc_uint32_t probe = scc_ir_constant_hash(&function->constants[constant]) & (size - 1);
+
+    while (interned[probe] != SCC_IR_NONE)
+      probe = (probe + 1) & (size - 1);
+
+    interned[probe] = constant;
+  }
+
+  scc_ir_free(function->interned);
+
+  function->interned = interned;
+  function->size_of_interned = size;
+}
+
+scc_ir_value_t scc_ir_function_constant(scc_ir_function_t *function,
+                                        const scc_ir_constant_t *constant) {
+  scc_assert_paranoid(constant != NULL);
+
+  // Normalize so unused components don't affect interning.
+  scc_ir_constant_t normalized;
+  memset(&normalized, 0, sizeof(normalized));
+  normalized.type = scc_ir_type(constant->type.scalar,
+                                constant->type.rows,
+                                constant->type.columns);
+  memcpy(&normalized.components[0],
+         &constant->components[0],
+         scc_ir_type_num_of_components(normalized.type) * sizeof(scc_ir_component_t));
+
+  // Keep load factor under a half.
+  if ((function->num_of_constants + 1) * 2 > function->size_of_interned)
+    scc_ir_function_rehash_constants(function, function->size_of_interned ? function->size_of_interned * 2 : 64);
+
+  const scc_uint32_t mask = function->size_of_interned - 1;
+
+  scc_uint32_t probe = scc_ir_constant_hash(&normalized) & mask;
+
+  while (function->interned[probe] != SCC_IR_NONE) {
+    const scc_uint32_t candidate = function->interned[probe];
+    if (scc_ir_constant_is_equal(&function->constants[candidate], &normalized))
+      return SCC_IR_VALUE(SCC_IR_VALUE_CONSTANT, candidate);
+    probe = (probe + 1) & mask;
+  }
+
+  function->constants = (scc_ir_constant_t *)scc_ir_grow(function->constants,
+                                                         &function->size_of_constants,
+                                                         function->num_of_constants + 1,
+                                                         sizeof(scc_ir_constant_t));
+
+  const scc_uint32_t index = function->num_of_constants++;
+
+  function->constants[index] = normalized;
+  function->interned[probe] = index;
+
+  return SCC_IR_VALUE(SCC_IR_VALUE_CONSTANT, index);
+}
+
+scc_ir_value_t scc_ir_function_splat(scc_ir_function_t *function,
+                                     scc_ir_type_t type,
+                                     scc_float64_t value) {
+  scc_ir_constant_t constant;
+  memset(&constant, 0, sizeof(constant));
+
+  constant.type = type;
+
+  const scc_uint32_t components = scc_ir_type_num_of_components(type);
+
+  for (scc_uint32_t component = 0; component < components; ++component) {
+    if (scc_ir_type_is_floating_point(type))
+      constant.components[component].f = value;
+    else if (scc_ir_type_is_signed(type))
+      constant.components[component].i = (scc_int64_t)value;
+    else
+      constant.components[component].u = (scc_uint64_t)value;
+  }
+
+  return scc_ir_function_constant(function, &constant);
+}
+
+scc_uint32_t scc_ir_function_remove_unused_constants(scc_ir_function_t *function) {
+  if (function->num_of_constants == 0)
+    return 0;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  // Zeroed, so nothing is used until proven otherwise.
+  scc_uint32_t *renumbering =
+    (scc_uint32_t *)heap->allocate(heap, function->num_of_constants * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t instruction = 0; instruction < function->num_of_instructions; ++instruction) {
+    const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+    if (!scc_ir_instruction_is_live(user))
+      continue;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+    for (scc_uint32_t operand = 0; operand < user->num_of_operands; ++operand)
+      if (SCC_IR_VALUE_KIND(operands[operand]) == SCC_IR_VALUE_CONSTANT)
+        renumbering[SCC_IR_VALUE_INDEX(operands[operand])] = 1;
+  }
+
+  scc_uint32_t num_of_constants = 0;
+
+  for (scc_uint32_t constant = 0; constant < function->num_of_constants; ++constant) {
+    if (!renumbering[constant])
+      continue;
+
+    renumbering[constant] = num_of_constants;
+    function->constants[num_of_constants++] = function->constants[constant];
+  }
+
+  const scc_uint32_t removed = function->num_of_constants - num_of_constants;
+
+  if (removed) {
+    for (scc_uint32_t instruction = 0; instruction < function->num_of_instructions; ++instruction) {
+      const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+      if (!scc_ir_instruction_is_live(user))
+        continue;
+
+      scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+      for (scc_uint32_t operand = 0; operand < user->num_of_operands; ++operand)
+        if (SCC_IR_VALUE_KIND(operands[operand]) == SCC_IR_VALUE_CONSTANT)
+          operands[operand] = SCC_IR_VALUE(SCC_IR_VALUE_CONSTANT, renumbering[SCC_IR_VALUE_INDEX(operands[operand])]);
+    }
+
+    function->num_of_constants = num_of_constants;
+
+    // Indices changed, so the table has to be rebuilt.
+    scc_ir_function_rehash_constants(function, function->size_of_interned);
+  }
+
+  heap->free(heap, renumbering);
+
+  return removed;
+}
+
+static scc_uint32_t scc_ir_function_allocate_operands(scc_ir_function_t *function,
+                                                      const scc_ir_value_t *operands,
+                                                      scc_uint32_t num_of_operands) {
+  // May refer to existing operands, which move if grown.
+  const scc_bool_t aliases = (operands >= function->operands)
+                          && (operands < function->operands + function->num_of_operands);
+
+  const scc_size_t offset = aliases ? (scc_size_t)(operands - function->operands) : 0;
+
+  function->operands = (scc_ir_value_t *)scc_ir_grow(function->operands,
+                                                     &function->size_of_operands,
+                                                     function->num_of_operands + num_of_operands,
+                                                     sizeof(scc_ir_value_t));
+
+  if (aliases)
+    operands = &function->operands[offset];
+
+  const scc_uint32_t first = function->num_of_operands;
+
+  if (num_of_operands)
+    memcpy(&function->operands[first], operands, num_of_operands * sizeof(scc_ir_value_t));
+
+  function->num_of_operands += num_of_operands;
+
+  return first;
+}
+
+static scc_uint32_t scc_ir_function_create_instruction(scc_ir_function_t *function,
+                                                       scc_ir_operation_t op,
+                                                       scc_ir_type_t type,
+                                                       const scc_ir_value_t *operands,
+                                                       scc_uint32_t num_of_operands) {
+  scc_assert_paranoid(op < SCC_IR_NUM_OF_OPERATIONS);
+
+  scc_assert_debug((SCC_IR_OPERATIONS[op].inputs == SCC_IR_VARIADIC)
+                || (num_of_operands <= SCC_IR_OPERATIONS[op].inputs));
+
+  const scc_uint32_t first = scc_ir_function_allocate_operands(function, operands, num_of_operands);
+
+  function->instructions = (scc_ir_instruction_t *)scc_ir_grow(function->instructions,
+                                                               &function->size_of_instructions,
+                                                               function->num_of_instructions + 1,
+                                                               sizeof(scc_ir_instruction_t));
+
+  const scc_uint32_t index = function->num_of_instructions++;
+
+  scc_ir_instruction_t *instruction = &function->instructions[index];
+
+  instruction->op = (scc_uint16_t)op;
+  instruction->num_of_operands = (scc_uint16_t)num_of_operands;
+  instruction->operands = first;
+  instruction->type = type;
+  instruction->block = SCC_IR_NONE;
+  instruction->prev = SCC_IR_NONE;
+  instruction->next = SCC_IR_NONE;
+
+  return index;
+}
+
+static void scc_ir_function_link(scc_ir_function_t *function,
+                                 scc_uint32_t instruction,
+                                 scc_uint32_t block,
+                                 scc_uint32_t before) {
+  scc_ir_instruction_t *linking = &function->instructions[instruction];
+  scc_ir_block_t *parent = &function->blocks[block];
+
+  linking->block = block;
+
+  if (before == SCC_IR_NONE) {
+    linking->prev = parent->last;
+    linking->next = SCC_IR_NONE;
+
+    if (parent->last != SCC_IR_NONE)
+      function->instructions[parent->last].next = instruction;
+    else
+      parent->first = instruction;
+
+    parent->last = instruction;
+  } else {
+    scc_ir_instruction_t *successor = &function->instructions[before];
+
+    scc_assert_paranoid(successor->block == block);
+
+    linking->prev = successor->prev;
+    linking->next = before;
+
+    if (successor->prev != SCC_IR_NONE)
+      function->instructions[successor->prev].next = instruction;
+    else
+      parent->first = instruction;
+
+    successor->prev = instruction;
+  }
+}
+
+scc_ir_value_t scc_ir_function_append(scc_ir_function_t *function,
+                                      scc_uint32_t block,
+                                      scc_ir_operation_t op,
+                                      scc_ir_type_t type,
+                                      const scc_ir_value_t *operands,
+                                      scc_uint32_t num_of_operands) {
+  scc_assert_paranoid(block < function->num_of_blocks);
+
+  const scc_uint32_t instruction =
+    scc_ir_function_create_instruction(function, op, type, operands, num_of_operands);
+
+  scc_ir_function_link(function, instruction, block, SCC_IR_NONE);
+
+  return SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, instruction);
+}
+
+scc_ir_value_t scc_ir_function_insert(scc_ir_function_t *function,
+                                      scc_uint32_t before,
+                                      scc_ir_operation_t op,
+                                      scc_ir_type_t type,
+                                      const scc_ir_value_t *operands,
+                                      scc_uint32_t num_of_operands) {
+  scc_assert_paranoid(before < function->num_of_instructions);
+
+  const scc_uint32_t instruction =
+    scc_ir_function_create_instruction(function, op, type, operands, num_of_operands);
+
+  scc_ir_function_link(function,
+                       instruction,
+                       function->instructions[before].block,
+                       before);
+
+  return SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, instruction);
+}
+
+void scc_ir_function_set_operands(scc_ir_function_t *function,
+                                  scc_uint32_t instruction,
+                                  const scc_ir_value_t *operands,
+                                  scc_uint32_t num_of_operands) {
+  scc_ir_instruction_t *modifying = &function->instructions[instruction];
+
+  if (num_of_operands <= modifying->num_of_operands) {
+    // Fits in place. Moved as `operands` may alias.
+    memmove(&function->operands[modifying->operands], operands, num_of_operands * sizeof(scc_ir_value_t));
+  } else {
+    modifying->operands = scc_ir_function_allocate_operands(function, operands, num_of_operands);
+  }
+
+  modifying->num_of_operands = (scc_uint16_t)num_of_operands;
+}
+
+void scc_ir_function_unlink(scc_ir_function_t *function,
+                            scc_uint32_t instruction) {
+  scc_ir_instruction_t *unlinking = &function->instructions[instruction];
+
+  if (unlinking->block == SCC_IR_NONE)
+    return;
+
+  scc_ir_block_t *parent = &function->blocks[unlinking->block];
+
+  if (unlinking->prev != SCC_IR_NONE)
+    function->instructions[unlinking->prev].next = unlinking->next;
+  else
+    parent->first = unlinking->next;
+
+  if (unlinking->next != SCC_IR_NONE)
+    function->instructions[unlinking->next].prev = unlinking->prev;
+  else
+    parent->last = unlinking->prev;
+
+  unlinking->block = SCC_IR_NONE;
+  unlinking->prev = SCC_IR_NONE;
+  unlinking->next = SCC_IR_NONE;
+}
+
+void scc_ir_function_move(scc_ir_function_t *function,
+                          scc_uint32_t instruction,
+                          scc_uint32_t block,
+                          scc_uint32_t before) {
+  scc_ir_function_unlink(function, instruction);
+
+  if (before != SCC_IR_NONE)
+    block = function->instructions[before].block;
+
+  scc_ir_function_link(function, instruction, block, before);
+}
+
+void scc_ir_function_remove(scc_ir_function_t *function,
+                            scc_uint32_t instruction) {
+  scc_ir_function_unlink(function, instruction);
+
+  function->instructions[instruction].op = SCC_IR_OPERATION_NOP;
+  function->instructions[instruction].num_of_operands = 0;
+}
+
+void scc_ir_function_remove_block(scc_ir_function_t *function,
+                                  scc_uint32_t block) {
+  scc_assert_paranoid(block < function->num_of_blocks);
+
+  // Entry block can't be removed.
+  scc_assert_debug(block != 0);
+
+  while (function->blocks[block].first != SCC_IR_NONE)
+    scc_ir_function_remove(function, function->blocks[block].first);
+
+  function->blocks[block].removed = SCC_TRUE;
+}
+
+void scc_ir_function_replace(scc_ir_function_t *function,
+                             scc_ir_value_t value,
+                             scc_ir_value_t replacement) {
+  for (scc_uint32_t instruction = 0; instruction < function->num_of_instructions; ++instruction) {
+    const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+    if (!scc_ir_instruction_is_live(user))
+      continue;
+
+    scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+    for (scc_uint32_t operand = 0; operand < user->num_of_operands; ++operand)
+      if (operands[operand] == value)
+        operands[operand] = replacement;
+  }
+}
+
+void scc_ir_function_forward(scc_ir_function_t *function,
+                             const scc_ir_value_t *forwarding) {
+  for (scc_uint32_t instruction = 0; instruction < function->num_of_instructions; ++instruction) {
+    const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+    if (!scc_ir_instruction_is_live(user))
+      continue;
+
+    scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+    for (scc_uint32_t operand = 0; operand < user->num_of_operands; ++operand) {
+      scc_ir_value_t value = operands[operand];
+
+      // Follow chains, bounded to guard against cycles.
+      for (scc_uint32_t hops = 0; hops < function->num_of_instructions; ++hops) {
+        if (SCC_IR_VALUE_KIND(value) != SCC_IR_VALUE_INSTRUCTION)
+          break;
+
+        const scc_ir_value_t forwarded = forwarding[SCC_IR_VALUE_INDEX(value)];
+
+        if (forwarded == SCC_IR_NO_VALUE)
+          break;
+
+        value = forwarded;
+      }
+
+      operands[operand] = value;
+    }
+  }
+}
+
+scc_bool_t scc_ir_function_prune_phis(scc_ir_function_t *function,
+                                      scc_ir_edge_fn flows,
+                                      const void *user,
+                                      scc_ir_value_t *forwarding) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_value_t *pruned =
+    (scc_ir_value_t *)heap->allocate(heap, (function->num_of_operands + 1) * sizeof(scc_ir_value_t), 16);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    if (function->blocks[block].removed)
+      continue;
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      const scc_ir_instruction_t *phi = &function->instructions[i];
+
+      // Phis are always first.
+      if (phi->op != SCC_IR_OPERATION_PHI)
+        break;
+
+      if (forwarding[i] != SCC_IR_NO_VALUE)
+        continue;
+
+      const scc_ir_value_t *operands = scc_ir_operands(function, phi);
+      scc_uint32_t num_of_pruned = 0;
+
+      for (scc_uint32_t operand = 0; operand + 1 < phi->num_of_operands; operand += 2) {
+        if (!flows(user, SCC_IR_VALUE_INDEX(operands[operand]), block))
+          continue;
+
+        pruned[num_of_pruned++] = operands[operand];
+        pruned[num_of_pruned++] = operands[operand + 1];
+      }
+
+      if ((num_of_pruned == 0) || (num_of_pruned == phi->num_of_operands))
+        continue;
+
+      if (num_of_pruned == 2)
+        forwarding[i] = pruned[1];
+      else
+        scc_ir_function_set_operands(function, i, pruned, num_of_pruned);
+
+      changed = SCC_TRUE;
+    }
+  }
+
+  heap->free(heap, pruned);
+
+  scc_ir_function_forward(function, forwarding);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    if (forwarding[i] != SCC_IR_NO_VALUE) {
+      scc_ir_function_remove(function, i);
+      changed = SCC_TRUE;
+    }
+  }
+
+  return changed;
+}
+
+//===----------------------------------------------------------------------===//
+// Queries
+//===----------------------------------------------------------------------===//
+
+scc_ir_type_t scc_ir_value_type(const scc_ir_function_t *function,
+                                scc_ir_value_t value) {
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(value);
+
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      return function->instructions[index].type;
+    case SCC_IR_VALUE_ARGUMENT:
+      return function->arguments[index].type;
+    case SCC_IR_VALUE_CONSTANT:
+      return function->constants[index].type;
+    case SCC_IR_VALUE_GLOBAL:
+      return function->module->globals[index].type;
+    case SCC_IR_VALUE_FUNCTION:
+      return function->module->functions[index]->return_type;
+    case SCC_IR_VALUE_IMMEDIATE:
+      return scc_ir_type(SCC_IR_U32, 1, 1);
+    default:
+      return scc_ir_void();
+  }
+}
+
+scc_bool_t scc_ir_instruction_is_component_wise(const scc_ir_function_t *function,
+                                                const scc_ir_instruction_t *instruction) {
+  if (!scc_ir_operation_is(instruction->op, SCC_IR_COMPONENT_WISE))
+    return SCC_FALSE;
+
+  if (instruction->op != SCC_IR_OPERATION_MULTIPLY)
+    return SCC_TRUE;
+
+  // Products of matrices with vectors or matrices are not.
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+    if (scc_ir_type_is_matrix(scc_ir_value_type(function, scc_ir_operand(function, instruction, operand))))
+      return SCC_FALSE;
+
+  return SCC_TRUE;
+}
+
+scc_bool_t scc_ir_instruction_is_commutative(const scc_ir_function_t *function,
+                                             const scc_ir_instruction_t *instruction) {
+  if (!scc_ir_operation_is(instruction->op, SCC_IR_COMMUTATIVE))
+    return SCC_FALSE;
+
+  if (instruction->op != SCC_IR_OPERATION_MULTIPLY)
+    return SCC_TRUE;
+
+  const scc_ir_type_t a = scc_ir_value_type(function, scc_ir_operand(function, instruction, 0));
+  const scc_ir_type_t b = scc_ir_value_type(function, scc_ir_operand(function, instruction, 1));
+
+  // Scaling commutes, but products involving matrices don't.
+  if (scc_ir_type_is_scalar(a) || scc_ir_type_is_scalar(b))
+    return SCC_TRUE;
+
+  return !scc_ir_type_is_matrix(a) && !scc_ir_type_is_matrix(b);
+}
+
+scc_uint32_t scc_ir_block_terminator(const scc_ir_function_t *function,
+                                     scc_uint32_t block) {
+  const scc_uint32_t last = function->blocks[block].last;
+
+  if (last == SCC_IR_NONE)
+    return SCC_IR_NONE;
+
+  if (!scc_ir_operation_is(function->instructions[last].op, SCC_IR_TERMINATOR))
+    return SCC_IR_NONE;
+
+  return last;
+}
+
+scc_uint32_t scc_ir_block_successors(const scc_ir_function_t *function,
+                                     scc_uint32_t block,
+                                     scc_uint32_t successors[2]) {
+  const scc_uint32_t terminator = scc_ir_block_terminator(function, block);
+
+  if (terminator == SCC_IR_NONE)
+    return 0;
+
+  const scc_ir_instruction_t *instruction = &function->instructions[terminator];
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_JUMP:
+      successors[0] = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+      return 1;
+
+    case SCC_IR_OPERATION_BRANCH:
+      successors[0] = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1));
+      successors[1] = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 2));
+      return (successors[0] == successors[1]) ? 1 : 2;
+  }
+
+  return 0;
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,135 @@
+//===-- scc/ir/analyses/cfg.cc --------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/cfg.h"
+
+SCC_BEGIN_EXTERN_C
+
+scc_ir_cfg_t *scc_ir_cfg_compute(const scc_ir_function_t *function) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = function->num_of_blocks;
+
+  scc_ir_cfg_t *cfg =
+    (scc_ir_cfg_t *)heap->allocate(heap, sizeof(scc_ir_cfg_t), 16);
+
+  cfg->num_of_blocks = n;
+
+  // Everything is sized generously, as there are at most two successors.
+  const scc_size_t edges = 2 * SCC_MAX(n, 1) * sizeof(scc_uint32_t);
+  const scc_size_t blocks = (n + 1) * sizeof(scc_uint32_t);
+
+  cfg->successors = (scc_uint32_t *)heap->allocate(heap, edges, 16);
+  cfg->first_successor = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  cfg->predecessors = (scc_uint32_t *)heap->allocate(heap, edges, 16);
+  cfg->first_predecessor = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  cfg->order = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  cfg->position = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+
+  // Successors, and count of predecessors.
+  scc_uint32_t num_of_edges = 0;
+
+  for (scc_uint32_t block = 0; block < n; ++block) {
+    cfg->first_successor[block] = num_of_edges;
+
+    if (function->blocks[block].removed)
+      continue;
+
+    scc_uint32_t successors[2];
+    const scc_uint32_t count = scc_ir_block_successors(function, block, successors);
+
+    for (scc_uint32_t successor = 0; successor < count; ++successor) {
+      cfg->successors[num_of_edges++] = successors[successor];
+      cfg->first_predecessor[successors[successor] + 1] += 1;
+    }
+  }
+
+  cfg->first_successor[n] = num_of_edges;
+
+  // Predecessors, by prefix sum then scatter.
+  for (scc_uint32_t block = 0; block < n; ++block)
+    cfg->first_predecessor[block + 1] += cfg->first_predecessor[block];
+
+  scc_uint32_t *cursor = cfg->position;
+  memcpy(cursor, cfg->first_predecessor, n * sizeof(scc_uint32_t));
+
+  for (scc_uint32_t block = 0; block < n; ++block)
+    for (scc_uint32_t edge = cfg->first_successor[block]; edge < cfg->first_successor[block + 1]; ++edge)
+      cfg->predecessors[cursor[cfg->successors[edge]]++] = block;
+
+  // Reverse post-order by iterative depth-first search.
+  scc_uint32_t *stack = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  scc_uint32_t *visited = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  scc_uint32_t *next_edge = visited;
+
+  for (scc_uint32_t block = 0; block < n; ++block) {
+    cfg->position[block] = SCC_IR_NONE;
+    next_edge[block] = SCC_IR_NONE;
+  }
+
+  scc_uint32_t num_of_postordered = 0;
+
+  if (n > 0) {
+    scc_uint32_t depth = 0;
+
+    stack[depth++] = 0;
+    next_edge[0] = cfg->first_successor[0];
+
+    while (depth > 0) {
+      const scc_uint32_t block = stack[depth - 1];
+
+      if (next_edge[block] < cfg->first_successor[block + 1]) {
+        const scc_uint32_t successor = cfg->successors[next_edge[block]++];
+
+        if (next_edge[successor] == SCC_IR_NONE) {
+          next_edge[successor] = cfg->first_successor[successor];
+          stack[depth++] = successor;
+        }
+      } else {
+        // Post-order; reversed below.
+        cfg->order[num_of_postordered++] = block;
+        depth -= 1;
+      }
+    }
+  }
+
+  cfg->num_of_reachable = num_of_postordered;
+
+  for (scc_uint32_t i = 0, j = num_of_postordered; i < j / 2; ++i) {
+    const scc_uint32_t swap = cfg->order[i];
+    cfg->order[i] = cfg->order[j - i - 1];
+    cfg->order[j - i - 1] = swap;
+  }
+
+  for (scc_uint32_t position = 0; position < num_of_postordered; ++position)
+    cfg->position[cfg->order[position]] = position;
+
+  heap->free(heap, (void *)stack);
+  heap->free(heap, (void *)visited);
+
+  return cfg;
+}
+
+void scc_ir_cfg_destroy(scc_ir_cfg_t *cfg) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  heap->free(heap, (void *)cfg->successors);
+  heap->free(heap, (void *)cfg->first_successor);
+  heap->free(heap, (void *)cfg->predecessors);
+  heap->free(heap, (void *)cfg->first_predecessor);
+  heap->free(heap, (void *)cfg->order);
+  heap->free(heap, (void *)cfg->position);
+  heap->free(heap, (void *)cfg);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,174 @@
+//===-- scc/ir/analyses/demanded.cc ---------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/demanded.h"
+
+SCC_BEGIN_EXTERN_C
+
+static scc_bool_t scc_ir_demanded_is_root(const scc_ir_instruction_t *instruction) {
+  return scc_ir_operation_is(instruction->op, SCC_IR_SIDE_EFFECTS)
+      || scc_ir_operation_is(instruction->op, SCC_IR_TERMINATOR);
+}
+
+static scc_ir_components_t scc_ir_demanded_all_of(scc_ir_type_t type) {
+  const scc_uint32_t n = scc_ir_type_num_of_components(type);
+  return (n >= 16) ? SCC_IR_ALL_COMPONENTS : (scc_ir_components_t)((1u << n) - 1);
+}
+
+// Returns the components of `operand` of `instruction` demanded when
+// `components` of its result are.
+static scc_ir_components_t scc_ir_demanded_of_operand(const scc_ir_function_t *function,
+                                                      const scc_ir_instruction_t *instruction,
+                                                      scc_uint32_t operand,
+                                                      scc_ir_components_t components) {
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+  const scc_ir_type_t type = scc_ir_value_type(function, operands[operand]);
+
+  if (components == 0)
+    return 0;
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_PHI:
+      return components;
+
+    case SCC_IR_OPERATION_STORE: {
+      // Outputs demand what the next stage reads, if that's known.
+      if (SCC_IR_VALUE_KIND(operands[0]) != SCC_IR_VALUE_GLOBAL)
+        break;
+
+      const scc_ir_global_t *global = &function->module->globals[SCC_IR_VALUE_INDEX(operands[0])];
+
+      if ((global->storage == SCC_IR_OUTPUT) && (global->consumed != 0))
+        return (scc_ir_components_t)global->consumed & scc_ir_demanded_all_of(type);
+
+      break;
+    }
+
+    case SCC_IR_OPERATION_SWIZZLE: {
+      if (operand != 0)
+        return 0;
+
+      const scc_uint32_t mask = SCC_IR_VALUE_INDEX(operands[1]);
+
+      scc_ir_components_t selected = 0;
+
+      for (scc_uint32_t lane = 0; lane < SCC_MIN(instruction->type.rows, 4); ++lane)
+        if (components & (1u << lane))
+          selected |= (scc_ir_components_t)(1u << SCC_IR_SWIZZLE_LANE(mask, lane));
+
+      return selected;
+    }
+
+    case SCC_IR_OPERATION_COMPOSE: {
+      scc_uint32_t first = 0;
+
+      for (scc_uint32_t preceding = 0; preceding < operand; ++preceding)
+        first += scc_ir_type_num_of_components(scc_ir_value_type(function, operands[preceding]));
+
+      return (scc_ir_components_t)(components >> SCC_MIN(first, 16)) & scc_ir_demanded_all_of(type);
+    }
+  }
+
+  if (scc_ir_instruction_is_component_wise(function, instruction)) {
+    // Scalars are broadcast.
+    if (scc_ir_type_num_of_components(type) == 1)
+      return 1;
+    return components & scc_ir_demanded_all_of(type);
+  }
+
+  return scc_ir_demanded_all_of(type);
+}
+
+scc_ir_demanded_t *scc_ir_demanded_compute(const scc_ir_function_t *function) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = function->num_of_instructions;
+
+  scc_ir_demanded_t *demanded =
+    (scc_ir_demanded_t *)heap->allocate(heap, sizeof(scc_ir_demanded_t), 16);
+
+  demanded->num_of_instructions = n;
+  demanded->components =
+    (scc_ir_components_t *)heap->allocate(heap, (n + 1) * sizeof(scc_ir_components_t), 16);
+
+  // An instruction is queued whenever more of it is demanded, unless it
+  // already is, so the worklist never holds more than every instruction.
+  scc_uint32_t *worklist = (scc_uint32_t *)heap->allocate(heap, (n + 1) * sizeof(scc_uint32_t), 16);
+  scc_bool_t *queued = (scc_bool_t *)heap->allocate(heap, (n + 1) * sizeof(scc_bool_t), 16);
+
+  scc_uint32_t num_of_queued = 0;
+
+  // Nothing is demanded until shown otherwise, other than by instructions
+  // with effects.
+  for (scc_uint32_t i = 0; i < n; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    if (!scc_ir_demanded_is_root(instruction))
+      continue;
+
+    worklist[num_of_queued++] = i;
+    queued[i] = SCC_TRUE;
+  }
+
+  while (num_of_queued) {
+    const scc_uint32_t i = worklist[--num_of_queued];
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    queued[i] = SCC_FALSE;
+
+    // Whatever has effects depends on every component of its operands.
+    const scc_ir_components_t components =
+      scc_ir_demanded_is_root(instruction)
+        ? SCC_IR_ALL_COMPONENTS
+        : demanded->components[i];
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+        continue;
+
+      const scc_uint32_t index = SCC_IR_VALUE_INDEX(operands[operand]);
+
+      const scc_ir_components_t merged = demanded->components[index]
+                                       | scc_ir_demanded_of_operand(function, instruction, operand, components);
+
+      if (merged == demanded->components[index])
+        continue;
+
+      demanded->components[index] = merged;
+
+      if (!queued[index]) {
+        worklist[num_of_queued++] = index;
+        queued[index] = SCC_TRUE;
+      }
+    }
+  }
+
+  heap->free(heap, (void *)queued);
+  heap->free(heap, (void *)worklist);
+
+  return demanded;
+}
+
+void scc_ir_demanded_destroy(scc_ir_demanded_t *demanded) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  heap->free(heap, (void *)demanded->components);
+  heap->free(heap, (void *)demanded);
+}
+
+SCC_END_EXTERN_C
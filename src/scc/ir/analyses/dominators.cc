@@ -0,0 +1,389 @@
+//===-- scc/ir/analyses/dominators.cc -------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/dominators.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Dominators and post-dominators are computed the same way, the latter over
+// the reversed graph. Nodes are blocks, plus, for post-dominators, a virtual
+// exit that every block without successors flows into.
+typedef struct scc_ir_dominators_graph {
+  scc_uint32_t num_of_nodes;
+
+  // Nodes reachable from the root in reverse post-order, and the position of
+  // each in it, or `SCC_IR_NONE` if unreachable.
+  const scc_uint32_t *order;
+  scc_uint32_t num_of_reachable;
+  const scc_uint32_t *position;
+
+  // Compressed like `scc_ir_cfg_t`.
+  const scc_uint32_t *predecessors;
+  const scc_uint32_t *first_predecessor;
+} scc_ir_dominators_graph_t;
+
+// Walks up from `a` and `b` until they meet. Positions are in reverse
+// post-order, so the node further from the root always has the greater
+// position.
+static scc_uint32_t scc_ir_dominators_intersect(const scc_ir_dominators_graph_t *graph,
+                                                const scc_uint32_t *idom,
+                                                scc_uint32_t a,
+                                                scc_uint32_t b) {
+  while (a != b) {
+    while (graph->position[a] > graph->position[b])
+      a = idom[a];
+    while (graph->position[b] > graph->position[a])
+      b = idom[b];
+  }
+
+  return a;
+}
+
+// Iterative algorithm of Cooper, Harvey, and Kennedy. Converges in a couple
+// of iterations on reducible graphs, since nodes are visited in reverse
+// post-order.
+static void scc_ir_dominators_solve(const scc_ir_dominators_graph_t *graph,
+                                    scc_uint32_t *idom) {
+  for (scc_uint32_t node = 0; node < graph->num_of_nodes; ++node)
+    idom[node] = SCC_IR_NONE;
+
+  if (graph->num_of_reachable == 0)
+    return;
+
+  // Root is temporarily its own dominator, to terminate intersection.
+  const scc_uint32_t root = graph->order[0];
+  idom[root] = root;
+
+  for (scc_bool_t changed = SCC_TRUE; changed; ) {
+    changed = SCC_FALSE;
+
+    for (scc_uint32_t position = 1; position < graph->num_of_reachable; ++position) {
+      const scc_uint32_t node = graph->order[position];
+
+      scc_uint32_t candidate = SCC_IR_NONE;
+
+      for (scc_uint32_t edge = graph->first_predecessor[node]; edge < graph->first_predecessor[node + 1]; ++edge) {
+        const scc_uint32_t p = graph->predecessors[edge];
+
+        if (idom[p] == SCC_IR_NONE)
+          // Not processed yet, or unreachable.
+          continue;
+
+        if (candidate == SCC_IR_NONE)
+          candidate = p;
+        else
+          candidate = scc_ir_dominators_intersect(graph, idom, p, candidate);
+      }
+
+      if (idom[node] != candidate) {
+        idom[node] = candidate;
+        changed = SCC_TRUE;
+      }
+    }
+  }
+
+  idom[root] = SCC_IR_NONE;
+}
+
+// Derives children, roots, and numbering from `dominators->idom` once solved
+// over `graph`. Nodes beyond blocks are virtual, so blocks they immediately
+// dominate become roots.
+static void scc_ir_dominators_build(scc_ir_dominators_t *dominators,
+                                    const scc_ir_dominators_graph_t *graph) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = dominators->num_of_blocks;
+
+  scc_uint32_t *idom = dominators->idom;
+
+  for (scc_uint32_t block = 0; block < n; ++block)
+    if (idom[block] >= n)
+      idom[block] = SCC_IR_NONE;
+
+  // Roots, in reverse post-order.
+  for (scc_uint32_t position = 0; position < graph->num_of_reachable; ++position) {
+    const scc_uint32_t node = graph->order[position];
+    if ((node < n) && (idom[node] == SCC_IR_NONE))
+      dominators->roots[dominators->num_of_roots++] = node;
+  }
+
+  // Children, by counting then scattering.
+  for (scc_uint32_t block = 0; block < n; ++block)
+    if (idom[block] != SCC_IR_NONE)
+      dominators->first_child[idom[block] + 1] += 1;
+
+  for (scc_uint32_t block = 0; block < n; ++block)
+    dominators->first_child[block + 1] += dominators->first_child[block];
+
+  const scc_size_t blocks = (n + 1) * sizeof(scc_uint32_t);
+
+  scc_uint32_t *cursor = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  memcpy(cursor, dominators->first_child, n * sizeof(scc_uint32_t));
+
+  // Children are visited in reverse post-order, so are stored that way.
+  for (scc_uint32_t position = 0; position < graph->num_of_reachable; ++position) {
+    const scc_uint32_t node = graph->order[position];
+    if ((node < n) && (idom[node] != SCC_IR_NONE))
+      dominators->children[cursor[idom[node]]++] = node;
+  }
+
+  heap->free(heap, (void *)cursor);
+
+  // Number blocks as a depth-first walk of the tree enters and leaves them,
+  // so that `a` dominates `b` exactly when the interval of `a` encloses that
+  // of `b`. Each block is pushed twice: once to enter it, and again, beneath
+  // its children, to leave it.
+  for (scc_uint32_t block = 0; block < n; ++block) {
+    dominators->pre[block] = SCC_IR_NONE;
+    dominators->post[block] = SCC_IR_NONE;
+  }
+
+  scc_uint32_t *stack = (scc_uint32_t *)heap->allocate(heap, 2 * blocks, 16);
+
+  scc_uint32_t entered = 0;
+  scc_uint32_t left = 0;
+
+  for (scc_uint32_t root = 0; root < dominators->num_of_roots; ++root) {
+    scc_uint32_t depth = 0;
+
+    stack[depth++] = dominators->roots[root];
+
+    while (depth > 0) {
+      const scc_uint32_t block = stack[--depth];
+
+      if (dominators->pre[block] != SCC_IR_NONE) {
+        dominators->post[block] = left++;
+        continue;
+      }
+
+      dominators->pre[block] = entered++;
+
+      stack[depth++] = block;
+
+      const scc_uint32_t *children = scc_ir_dominators_children(dominators, block);
+      const scc_uint32_t num_of_children = scc_ir_dominators_num_of_children(dominators, block);
+
+      for (scc_uint32_t child = 0; child < num_of_children; ++child)
+        stack[depth++] = children[child];
+    }
+  }
+
+  heap->free(heap, (void *)stack);
+}
+
+static scc_ir_dominators_t *scc_ir_dominators_allocate(scc_uint32_t n,
+                                                       scc_uint32_t num_of_nodes) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_dominators_t *dominators =
+    (scc_ir_dominators_t *)heap->allocate(heap, sizeof(scc_ir_dominators_t), 16);
+
+  dominators->num_of_blocks = n;
+
+  const scc_size_t blocks = (n + 1) * sizeof(scc_uint32_t);
+
+  // Solved over every node, including virtual ones.
+  dominators->idom = (scc_uint32_t *)heap->allocate(heap, (num_of_nodes + 1) * sizeof(scc_uint32_t), 16);
+
+  dominators->children = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  dominators->first_child = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+
+  dominators->roots = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  dominators->num_of_roots = 0;
+
+  dominators->pre = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  dominators->post = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+
+  return dominators;
+}
+
+scc_ir_dominators_t *scc_ir_dominators_compute(const scc_ir_function_t *function,
+                                               const scc_ir_cfg_t *cfg) {
+  (void)function;
+
+  scc_ir_dominators_graph_t graph;
+
+  graph.num_of_nodes = cfg->num_of_blocks;
+  graph.order = cfg->order;
+  graph.num_of_reachable = cfg->num_of_reachable;
+  graph.position = cfg->position;
+  graph.predecessors = cfg->predecessors;
+  graph.first_predecessor = cfg->first_predecessor;
+
+  scc_ir_dominators_t *dominators =
+    scc_ir_dominators_allocate(cfg->num_of_blocks, graph.num_of_nodes);
+
+  scc_ir_dominators_solve(&graph, dominators->idom);
+  scc_ir_dominators_build(dominators, &graph);
+
+  return dominators;
+}
+
+scc_ir_dominators_t *scc_ir_post_dominators_compute(const scc_ir_function_t *function,
+                                                    const scc_ir_cfg_t *cfg) {
+  (void)function;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = cfg->num_of_blocks;
+
+  // Virtual exit.
+  const scc_uint32_t exit = n;
+
+  const scc_uint32_t num_of_nodes = n + 1;
+
+  const scc_size_t nodes = (num_of_nodes + 1) * sizeof(scc_uint32_t);
+
+  // Only blocks reachable from the entry take part, and of those, only ones
+  // that reach an exit end up in the tree. Edges are reversed: successors of
+  // a node are its predecessors in the function, and vice versa.
+  scc_uint32_t num_of_edges = 0;
+
+  for (scc_uint32_t block = 0; block < n; ++block)
+    if (scc_ir_cfg_is_reachable(cfg, block))
+      num_of_edges += scc_ir_cfg_num_of_successors(cfg, block) + 1;
+
+  const scc_size_t edges = (num_of_edges + 1) * sizeof(scc_uint32_t);
+
+  scc_uint32_t *successors = (scc_uint32_t *)heap->allocate(heap, edges, 16);
+  scc_uint32_t *first_successor = (scc_uint32_t *)heap->allocate(heap, nodes, 16);
+  scc_uint32_t *predecessors = (scc_uint32_t *)heap->allocate(heap, edges, 16);
+  scc_uint32_t *first_predecessor = (scc_uint32_t *)heap->allocate(heap, nodes, 16);
+
+  for (scc_uint32_t block = 0; block < n; ++block) {
+    first_successor[block + 1] = first_successor[block];
+    first_predecessor[block + 1] = first_predecessor[block];
+
+    if (!scc_ir_cfg_is_reachable(cfg, block))
+      continue;
+
+    const scc_uint32_t *forward = scc_ir_cfg_predecessors(cfg, block);
+    const scc_uint32_t num_of_forward = scc_ir_cfg_num_of_predecessors(cfg, block);
+
+    for (scc_uint32_t edge = 0; edge < num_of_forward; ++edge)
+      if (scc_ir_cfg_is_reachable(cfg, forward[edge]))
+        successors[first_successor[block + 1]++] = forward[edge];
+
+    const scc_uint32_t *backward = scc_ir_cfg_successors(cfg, block);
+    const scc_uint32_t num_of_backward = scc_ir_cfg_num_of_successors(cfg, block);
+
+    for (scc_uint32_t edge = 0; edge < num_of_backward; ++edge)
+      predecessors[first_predecessor[block + 1]++] = backward[edge];
+
+    if (num_of_backward == 0)
+      predecessors[first_predecessor[block + 1]++] = exit;
+  }
+
+  // Virtual exit flows into every block without successors.
+  first_successor[exit + 1] = first_successor[exit];
+  first_predecessor[exit + 1] = first_predecessor[exit];
+
+  for (scc_uint32_t block = 0; block < n; ++block)
+    if (scc_ir_cfg_is_reachable(cfg, block) && (scc_ir_cfg_num_of_successors(cfg, block) == 0))
+      successors[first_successor[exit + 1]++] = block;
+
+  // Reverse post-order by iterative depth-first search from the exit.
+  scc_uint32_t *order = (scc_uint32_t *)heap->allocate(heap, nodes, 16);
+  scc_uint32_t *position = (scc_uint32_t *)heap->allocate(heap, nodes, 16);
+  scc_uint32_t *stack = (scc_uint32_t *)heap->allocate(heap, nodes, 16);
+  scc_uint32_t *next_edge = (scc_uint32_t *)heap->allocate(heap, nodes, 16);
+
+  for (scc_uint32_t node = 0; node < num_of_nodes; ++node) {
+    position[node] = SCC_IR_NONE;
+    next_edge[node] = SCC_IR_NONE;
+  }
+
+  scc_uint32_t num_of_postordered = 0;
+  scc_uint32_t depth = 0;
+
+  stack[depth++] = exit;
+  next_edge[exit] = first_successor[exit];
+
+  while (depth > 0) {
+    const scc_uint32_t node = stack[depth - 1];
+
+    if (next_edge[node] < first_successor[node + 1]) {
+      const scc_uint32_t successor = successors[next_edge[node]++];
+
+      if (next_edge[successor] == SCC_IR_NONE) {
+        next_edge[successor] = first_successor[successor];
+        stack[depth++] = successor;
+      }
+    } else {
+      // Post-order; reversed below.
+      order[num_of_postordered++] = node;
+      depth -= 1;
+    }
+  }
+
+  for (scc_uint32_t i = 0, j = num_of_postordered; i < j / 2; ++i) {
+    const scc_uint32_t swap = order[i];
+    order[i] = order[j - i - 1];
+    order[j - i - 1] = swap;
+  }
+
+  for (scc_uint32_t i = 0; i < num_of_postordered; ++i)
+    position[order[i]] = i;
+
+  scc_ir_dominators_graph_t graph;
+
+  graph.num_of_nodes = num_of_nodes;
+  graph.order = order;
+  graph.num_of_reachable = num_of_postordered;
+  graph.position = position;
+  graph.predecessors = predecessors;
+  graph.first_predecessor = first_predecessor;
+
+  scc_ir_dominators_t *dominators = scc_ir_dominators_allocate(n, num_of_nodes);
+
+  scc_ir_dominators_solve(&graph, dominators->idom);
+  scc_ir_dominators_build(dominators, &graph);
+
+  heap->free(heap, (void *)successors);
+  heap->free(heap, (void *)first_successor);
+  heap->free(heap, (void *)predecessors);
+  heap->free(heap, (void *)first_predecessor);
+  heap->free(heap, (void *)order);
+  heap->free(heap, (void *)position);
+  heap->free(heap, (void *)stack);
+  heap->free(heap, (void *)next_edge);
+
+  return dominators;
+}
+
+void scc_ir_dominators_destroy(scc_ir_dominators_t *dominators) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  heap->free(heap, (void *)dominators->idom);
+  heap->free(heap, (void *)dominators->children);
+  heap->free(heap, (void *)dominators->first_child);
+  heap->free(heap, (void *)dominators->roots);
+  heap->free(heap, (void *)dominators->pre);
+  heap->free(heap, (void *)dominators->post);
+  heap->free(heap, (void *)dominators);
+}
+
+scc_bool_t scc_ir_dominates(const scc_ir_dominators_t *dominators,
+                            scc_uint32_t a,
+                            scc_uint32_t b) {
+  if (a == b)
+    return SCC_TRUE;
+
+  if ((dominators->pre[a] == SCC_IR_NONE) || (dominators->pre[b] == SCC_IR_NONE))
+    return SCC_FALSE;
+
+  return (dominators->pre[a] <= dominators->pre[b])
+      && (dominators->post[b] <= dominators->post[a]);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,322 @@
+//===-- scc/ir/analyses/liveness.cc ---------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/liveness.h"
+
+SCC_BEGIN_EXTERN_C
+
+static SCC_INLINE void scc_ir_liveness_insert(scc_uint64_t *set,
+                                              scc_uint32_t index) {
+  set[index / 64] |= (scc_uint64_t)1 << (index % 64);
+}
+
+static SCC_INLINE void scc_ir_liveness_erase(scc_uint64_t *set,
+                                             scc_uint32_t index) {
+  set[index / 64] &= ~((scc_uint64_t)1 << (index % 64));
+}
+
+scc_ir_liveness_t *scc_ir_liveness_compute(const scc_ir_function_t *function,
+                                           const scc_ir_cfg_t *cfg) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = cfg->num_of_blocks;
+
+  scc_ir_liveness_t *liveness =
+    (scc_ir_liveness_t *)heap->allocate(heap, sizeof(scc_ir_liveness_t), 16);
+
+  liveness->num_of_blocks = n;
+  liveness->num_of_values = function->num_of_instructions + function->num_of_arguments;
+  liveness->num_of_words = (liveness->num_of_values + 63) / 64;
+
+  const scc_uint32_t words = liveness->num_of_words;
+
+  const scc_size_t sets = ((scc_size_t)n * words + 1) * sizeof(scc_uint64_t);
+
+  liveness->live_in = (scc_uint64_t *)heap->allocate(heap, sets, 16);
+  liveness->live_out = (scc_uint64_t *)heap->allocate(heap, sets, 16);
+
+  // Values used before being defined in each block, and defined in it. Uses
+  // by a `phi` are instead gathered per predecessor, since they're live on
+  // exit from it, but not necessarily on exit from its other successors.
+  scc_uint64_t *gen = (scc_uint64_t *)heap->allocate(heap, sets, 16);
+  scc_uint64_t *kill = (scc_uint64_t *)heap->allocate(heap, sets, 16);
+  scc_uint64_t *phis = (scc_uint64_t *)heap->allocate(heap, sets, 16);
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    scc_uint64_t *gen_of_block = &gen[block * words];
+    scc_uint64_t *kill_of_block = &kill[block * words];
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+      const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+      if (instruction->op == SCC_IR_OPERATION_PHI) {
+        for (scc_uint32_t pair = 0; pair + 1 < instruction->num_of_operands; pair += 2) {
+          const scc_uint32_t predecessor = SCC_IR_VALUE_INDEX(operands[pair]);
+          const scc_uint32_t index = scc_ir_liveness_index(function, operands[pair + 1]);
+
+          if (index != SCC_IR_NONE)
+            scc_ir_liveness_insert(&phis[predecessor * words], index);
+        }
+      } else {
+        for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+          const scc_uint32_t index = scc_ir_liveness_index(function, operands[operand]);
+
+          if (index == SCC_IR_NONE)
+            continue;
+
+          if (!scc_ir_liveness_contains(kill_of_block, index))
+            scc_ir_liveness_insert(gen_of_block, index);
+        }
+      }
+
+      if (!scc_ir_type_is_void(instruction->type))
+        scc_ir_liveness_insert(kill_of_block, i);
+    }
+  }
+
+  // Seeded in post-order, so successors are mostly solved before their
+  // predecessors, and only loops need revisiting.
+  scc_uint32_t *queue = (scc_uint32_t *)heap->allocate(heap, (n + 1) * sizeof(scc_uint32_t), 16);
+  scc_bool_t *queued = (scc_bool_t *)heap->allocate(heap, (n + 1) * sizeof(scc_bool_t), 16);
+
+  const scc_uint32_t capacity = n + 1;
+
+  scc_uint32_t head = 0;
+  scc_uint32_t num_of_queued = 0;
+
+  for (scc_uint32_t position = cfg->num_of_reachable; position-- > 0; ) {
+    const scc_uint32_t block = cfg->order[position];
+    queue[num_of_queued++] = block;
+    queued[block] = SCC_TRUE;
+  }
+
+  while (num_of_queued) {
+    const scc_uint32_t block = queue[head];
+
+    head = (head + 1) % capacity;
+    num_of_queued -= 1;
+
+    queued[block] = SCC_FALSE;
+
+    scc_uint64_t *in = &liveness->live_in[block * words];
+    scc_uint64_t *out = &liveness->live_out[block * words];
+
+    memcpy(out, &phis[block * words], words * sizeof(scc_uint64_t));
+
+    const scc_uint32_t *successors = scc_ir_cfg_successors(cfg, block);
+    const scc_uint32_t num_of_successors = scc_ir_cfg_num_of_successors(cfg, block);
+
+    for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor) {
+      const scc_uint64_t *in_of_successor = &liveness->live_in[successors[successor] * words];
+
+      for (scc_uint32_t word = 0; word < words; ++word)
+        out[word] |= in_of_successor[word];
+    }
+
+    const scc_uint64_t *gen_of_block = &gen[block * words];
+    const scc_uint64_t *kill_of_block = &kill[block * words];
+
+    scc_bool_t changed = SCC_FALSE;
+
+    for (scc_uint32_t word = 0; word < words; ++word) {
+      const scc_uint64_t live = gen_of_block[word] | (out[word] & ~kill_of_block[word]);
+      changed |= (live != in[word]);
+      in[word] = live;
+    }
+
+    if (!changed)
+      continue;
+
+    const scc_uint32_t *predecessors = scc_ir_cfg_predecessors(cfg, block);
+    const scc_uint32_t num_of_predecessors = scc_ir_cfg_num_of_predecessors(cfg, block);
+
+    for (scc_uint32_t predecessor = 0; predecessor < num_of_predecessors; ++predecessor) {
+      const scc_uint32_t p = predecessors[predecessor];
+
+      if (queued[p] || !scc_ir_cfg_is_reachable(cfg, p))
+        continue;
+
+      queue[(head + num_of_queued) % capacity] = p;
+      num_of_queued += 1;
+      queued[p] = SCC_TRUE;
+    }
+  }
+
+  heap->free(heap, (void *)gen);
+  heap->free(heap, (void *)kill);
+  heap->free(heap, (void *)phis);
+  heap->free(heap, (void *)queue);
+  heap->free(heap, (void *)queued);
+
+  return liveness;
+}
+
+void scc_ir_liveness_destroy(scc_ir_liveness_t *liveness) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  heap->free(heap, (void *)liveness->live_in);
+  heap->free(heap, (void *)liveness->live_out);
+  heap->free(heap, (void *)liveness);
+}
+
+// Running totals of a set of live values, weighted by what each occupies.
+typedef struct scc_ir_liveness_tally {
+  scc_uint64_t *live;
+
+  const scc_uint32_t *components;
+  const scc_uint32_t *registers;
+
+  scc_ir_pressure_t current;
+  scc_ir_pressure_t *peak;
+} scc_ir_liveness_tally_t;
+
+static void scc_ir_liveness_tally_insert(scc_ir_liveness_tally_t *tally,
+                                         scc_uint32_t index) {
+  if (scc_ir_liveness_contains(tally->live, index))
+    return;
+
+  scc_ir_liveness_insert(tally->live, index);
+
+  tally->current.values += 1;
+  tally->current.components += tally->components[index];
+  tally->current.registers += tally->registers[index];
+}
+
+static void scc_ir_liveness_tally_erase(scc_ir_liveness_tally_t *tally,
+                                        scc_uint32_t index) {
+  if (!scc_ir_liveness_contains(tally->live, index))
+    return;
+
+  scc_ir_liveness_erase(tally->live, index);
+
+  tally->current.values -= 1;
+  tally->current.components -= tally->components[index];
+  tally->current.registers -= tally->registers[index];
+}
+
+static void scc_ir_liveness_tally_measure(scc_ir_liveness_tally_t *tally) {
+  if (tally->current.values > tally->peak->values)
+    tally->peak->values = tally->current.values;
+  if (tally->current.components > tally->peak->components)
+    tally->peak->components = tally->current.components;
+  if (tally->current.registers > tally->peak->registers)
+    tally->peak->registers = tally->current.registers;
+}
+
+void scc_ir_liveness_weigh(scc_ir_type_t type,
+                           scc_uint32_t *components,
+                           scc_uint32_t *registers) {
+  if (scc_ir_type_is_void(type)) {
+    *components = *registers = 0;
+    return;
+  }
+
+  // PERF(mtwilliams): Assume a structure fills a register, rather than
+  // weighing members. Only loads of whole structures produce them.
+  if (type.scalar == SCC_IR_STRUCTURE) {
+    *components = 4;
+    *registers = 1;
+    return;
+  }
+
+  // Wider scalars take two slots.
+  const scc_uint32_t slots = (scc_ir_scalar_size(type) > 4) ? 2 : 1;
+
+  *components = type.rows * type.columns * slots;
+  *registers = type.columns * ((type.rows * slots + 3) / 4);
+}
+
+void scc_ir_liveness_pressure(const scc_ir_function_t *function,
+                              const scc_ir_cfg_t *cfg,
+                              const scc_ir_liveness_t *liveness,
+                              scc_ir_pressure_t *pressure) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  memset(pressure, 0, sizeof(scc_ir_pressure_t));
+
+  const scc_uint32_t words = liveness->num_of_words;
+  const scc_uint32_t values = liveness->num_of_values;
+
+  scc_uint32_t *components = (scc_uint32_t *)heap->allocate(heap, (values + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t *registers = (scc_uint32_t *)heap->allocate(heap, (values + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+    scc_ir_liveness_weigh(function->instructions[i].type, &components[i], &registers[i]);
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument) {
+    const scc_uint32_t index = function->num_of_instructions + argument;
+    scc_ir_liveness_weigh(function->arguments[argument].type, &components[index], &registers[index]);
+  }
+
+  scc_ir_liveness_tally_t tally;
+
+  tally.live = (scc_uint64_t *)heap->allocate(heap, (words + 1) * sizeof(scc_uint64_t), 16);
+  tally.components = components;
+  tally.registers = registers;
+  tally.peak = pressure;
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    memset(tally.live, 0, words * sizeof(scc_uint64_t));
+    memset(&tally.current, 0, sizeof(scc_ir_pressure_t));
+
+    const scc_uint64_t *out = scc_ir_live_out(liveness, block);
+
+    for (scc_uint32_t word = 0; word < words; ++word)
+      for (scc_uint64_t bits = out[word]; bits; bits &= bits - 1)
+        scc_ir_liveness_tally_insert(&tally, word * 64 + scc_ctzull(bits));
+
+    scc_ir_liveness_tally_measure(&tally);
+
+    scc_uint32_t i = function->blocks[block].last;
+
+    for (; i != SCC_IR_NONE; i = function->instructions[i].prev) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (instruction->op == SCC_IR_OPERATION_PHI)
+        break;
+
+      if (!scc_ir_type_is_void(instruction->type)) {
+        scc_ir_liveness_tally_insert(&tally, i);
+        scc_ir_liveness_tally_measure(&tally);
+        scc_ir_liveness_tally_erase(&tally, i);
+      }
+
+      const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+      for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+        const scc_uint32_t index = scc_ir_liveness_index(function, operands[operand]);
+        if (index != SCC_IR_NONE)
+          scc_ir_liveness_tally_insert(&tally, index);
+      }
+
+      scc_ir_liveness_tally_measure(&tally);
+    }
+
+    // Results of every `phi` are written on entry, together.
+    for (; i != SCC_IR_NONE; i = function->instructions[i].prev)
+      scc_ir_liveness_tally_insert(&tally, i);
+
+    scc_ir_liveness_tally_measure(&tally);
+  }
+
+  heap->free(heap, (void *)components);
+  heap->free(heap, (void *)registers);
+  heap->free(heap, (void *)tally.live);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,247 @@
+//===-- scc/ir/analyses/loops.cc ------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/loops.h"
+
+#include <stdlib.h>
+
+SCC_BEGIN_EXTERN_C
+
+static int scc_ir_loops_compare_positions(const void *a, const void *b) {
+  const scc_uint32_t lhs = *(const scc_uint32_t *)a;
+  const scc_uint32_t rhs = *(const scc_uint32_t *)b;
+  return (lhs > rhs) - (lhs < rhs);
+}
+
+// Makes room for at least `needed` more blocks.
+static void scc_ir_loops_reserve(scc_ir_loops_t *loops,
+                                 scc_uint32_t *size,
+                                 scc_uint32_t used,
+                                 scc_uint32_t needed) {
+  if (used + needed <= *size)
+    return;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_uint32_t grown = *size * 2;
+  while (grown < used + needed)
+    grown *= 2;
+
+  scc_uint32_t *blocks = (scc_uint32_t *)heap->allocate(heap, grown * sizeof(scc_uint32_t), 16);
+  memcpy(blocks, loops->blocks, used * sizeof(scc_uint32_t));
+  heap->free(heap, (void *)loops->blocks);
+
+  loops->blocks = blocks;
+  *size = grown;
+}
+
+scc_ir_loops_t *scc_ir_loops_compute(const scc_ir_function_t *function,
+                                     const scc_ir_cfg_t *cfg,
+                                     const scc_ir_dominators_t *dominators) {
+  // Everything needed is in the graph, but analyses all take the function.
+  (void)function;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = cfg->num_of_blocks;
+
+  scc_ir_loops_t *loops =
+    (scc_ir_loops_t *)heap->allocate(heap, sizeof(scc_ir_loops_t), 16);
+
+  loops->num_of_blocks = n;
+
+  const scc_size_t blocks = (n + 1) * sizeof(scc_uint32_t);
+  const scc_size_t edges = (cfg->first_successor[n] + 1) * sizeof(scc_uint32_t);
+
+  loops->loops = (scc_ir_loop_t *)heap->allocate(heap, (n + 1) * sizeof(scc_ir_loop_t), 16);
+  loops->latches = (scc_uint32_t *)heap->allocate(heap, edges, 16);
+  loops->innermost = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+
+  // Grown as needed, since blocks of nested loops are repeated.
+  scc_uint32_t size_of_blocks = n + 1;
+  scc_uint32_t num_of_blocks = 0;
+  loops->blocks = (scc_uint32_t *)heap->allocate(heap, size_of_blocks * sizeof(scc_uint32_t), 16);
+
+  // Headers are found in reverse post-order, which puts enclosing loops
+  // first, since their headers dominate those nested in them.
+  scc_uint32_t num_of_latches = 0;
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t header = cfg->order[position];
+
+    const scc_uint32_t *predecessors = scc_ir_cfg_predecessors(cfg, header);
+    const scc_uint32_t num_of_predecessors = scc_ir_cfg_num_of_predecessors(cfg, header);
+
+    const scc_uint32_t first_latch = num_of_latches;
+
+    for (scc_uint32_t predecessor = 0; predecessor < num_of_predecessors; ++predecessor)
+      if (scc_ir_dominates(dominators, header, predecessors[predecessor]))
+        loops->latches[num_of_latches++] = predecessors[predecessor];
+
+    if (num_of_latches == first_latch)
+      continue;
+
+    scc_ir_loop_t *loop = &loops->loops[loops->num_of_loops++];
+
+    loop->header = header;
+    loop->preheader = SCC_IR_NONE;
+    loop->parent = SCC_IR_NONE;
+    loop->first_latch = first_latch;
+    loop->num_of_latches = num_of_latches - first_latch;
+  }
+
+  for (scc_uint32_t block = 0; block < n; ++block)
+    loops->innermost[block] = SCC_IR_NONE;
+
+  // Loop each block was last found in.
+  scc_uint32_t *marks = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+  scc_uint32_t *pending = (scc_uint32_t *)heap->allocate(heap, blocks, 16);
+
+  for (scc_uint32_t block = 0; block < n; ++block)
+    marks[block] = SCC_IR_NONE;
+
+  // Bodies are found innermost first, walking backwards from latches until
+  // the header, so the first loop to find a block is the innermost one.
+  for (scc_uint32_t index = loops->num_of_loops; index-- > 0; ) {
+    scc_ir_loop_t *loop = &loops->loops[index];
+
+    const scc_uint32_t header = loop->header;
+
+    marks[header] = index;
+
+    scc_ir_loops_reserve(loops, &size_of_blocks, num_of_blocks, 1);
+
+    loop->first_block = num_of_blocks;
+    loops->blocks[num_of_blocks++] = header;
+
+    // Positions, rather than blocks, are collected to sort them after.
+    const scc_uint32_t first_body = num_of_blocks;
+
+    scc_uint32_t num_of_pending = 0;
+
+    for (scc_uint32_t latch = 0; latch < loop->num_of_latches; ++latch) {
+      const scc_uint32_t block = loops->latches[loop->first_latch + latch];
+
+      if (marks[block] != index) {
+        marks[block] = index;
+        pending[num_of_pending++] = block;
+      }
+    }
+
+    while (num_of_pending) {
+      const scc_uint32_t block = pending[--num_of_pending];
+
+      scc_ir_loops_reserve(loops, &size_of_blocks, num_of_blocks, 1);
+      loops->blocks[num_of_blocks++] = cfg->position[block];
+
+      const scc_uint32_t *predecessors = scc_ir_cfg_predecessors(cfg, block);
+      const scc_uint32_t num_of_predecessors = scc_ir_cfg_num_of_predecessors(cfg, block);
+
+      for (scc_uint32_t predecessor = 0; predecessor < num_of_predecessors; ++predecessor) {
+        const scc_uint32_t p = predecessors[predecessor];
+
+        if (!scc_ir_cfg_is_reachable(cfg, p))
+          continue;
+
+        if (marks[p] != index) {
+          marks[p] = index;
+          pending[num_of_pending++] = p;
+        }
+      }
+    }
+
+    qsort(&loops->blocks[first_body], num_of_blocks - first_body, sizeof(scc_uint32_t), &scc_ir_loops_compare_positions);
+
+    for (scc_uint32_t body = first_body; body < num_of_blocks; ++body)
+      loops->blocks[body] = cfg->order[loops->blocks[body]];
+
+    loop->num_of_blocks = num_of_blocks - loop->first_block;
+
+    // Blocks not yet claimed are innermost in this loop. Those that are, and
+    // head a loop without a parent, make this the parent of that loop.
+    for (scc_uint32_t body = loop->first_block; body < num_of_blocks; ++body) {
+      const scc_uint32_t block = loops->blocks[body];
+      const scc_uint32_t innermost = loops->innermost[block];
+
+      if (innermost == SCC_IR_NONE)
+        loops->innermost[block] = index;
+      else if ((innermost != index)
+            && (loops->loops[innermost].header == block)
+            && (loops->loops[innermost].parent == SCC_IR_NONE))
+        loops->loops[innermost].parent = index;
+    }
+
+    // Preheader, if entered from a single block that only leads here.
+    const scc_uint32_t *predecessors = scc_ir_cfg_predecessors(cfg, header);
+    const scc_uint32_t num_of_predecessors = scc_ir_cfg_num_of_predecessors(cfg, header);
+
+    scc_uint32_t entering = SCC_IR_NONE;
+    scc_uint32_t num_of_entering = 0;
+
+    for (scc_uint32_t predecessor = 0; predecessor < num_of_predecessors; ++predecessor) {
+      const scc_uint32_t p = predecessors[predecessor];
+
+      if (!scc_ir_cfg_is_reachable(cfg, p) || (marks[p] == index))
+        continue;
+
+      entering = p;
+      num_of_entering += 1;
+    }
+
+    if ((num_of_entering == 1) && (scc_ir_cfg_num_of_successors(cfg, entering) == 1))
+      loop->preheader = entering;
+  }
+
+  // Parents always precede children.
+  for (scc_uint32_t index = 0; index < loops->num_of_loops; ++index) {
+    scc_ir_loop_t *loop = &loops->loops[index];
+
+    if (loop->parent == SCC_IR_NONE)
+      loop->depth = 1;
+    else
+      loop->depth = loops->loops[loop->parent].depth + 1;
+  }
+
+  heap->free(heap, (void *)marks);
+  heap->free(heap, (void *)pending);
+
+  return loops;
+}
+
+void scc_ir_loops_destroy(scc_ir_loops_t *loops) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  heap->free(heap, (void *)loops->loops);
+  heap->free(heap, (void *)loops->blocks);
+  heap->free(heap, (void *)loops->latches);
+  heap->free(heap, (void *)loops->innermost);
+  heap->free(heap, (void *)loops);
+}
+
+scc_bool_t scc_ir_loop_contains(const scc_ir_loops_t *loops,
+                                scc_uint32_t loop,
+                                scc_uint32_t block) {
+  // Loops nest strictly deeper than those enclosing them.
+  const scc_uint32_t depth = loops->loops[loop].depth;
+
+  for (scc_uint32_t innermost = loops->innermost[block]; innermost != SCC_IR_NONE; innermost = loops->loops[innermost].parent) {
+    if (innermost == loop)
+      return SCC_TRUE;
+    if (loops->loops[innermost].depth <= depth)
+      return SCC_FALSE;
+  }
+
+  return SCC_FALSE;
+}
+
+SCC_END_EXTERN_C
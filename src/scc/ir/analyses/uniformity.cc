@@ -0,0 +1,130 @@
+//===-- scc/ir/analyses/uniformity.cc -------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/uniformity.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Determines if `instruction` varies regardless of its operands.
+static scc_bool_t scc_ir_uniformity_is_source(const scc_ir_function_t *function,
+                                              const scc_ir_instruction_t *instruction) {
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_LOAD: {
+      const scc_ir_value_t pointer = scc_ir_operand(function, instruction, 0);
+
+      if (SCC_IR_VALUE_KIND(pointer) != SCC_IR_VALUE_GLOBAL)
+        return SCC_TRUE;
+
+      return (function->module->globals[SCC_IR_VALUE_INDEX(pointer)].storage != SCC_IR_CONSTANT);
+    }
+
+    case SCC_IR_OPERATION_CALL:
+      return SCC_TRUE;
+  }
+
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+    if (SCC_IR_VALUE_KIND(operands[operand]) == SCC_IR_VALUE_ARGUMENT)
+      return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+// Each instruction is pushed at most once, when it's first found to vary, so
+// the worklist never holds more than every instruction.
+typedef struct scc_ir_uniformity_worklist {
+  const scc_ir_function_t *function;
+  scc_ir_uniformity_t *uniformity;
+
+  scc_uint32_t *instructions;
+  scc_uint32_t num_of_instructions;
+} scc_ir_uniformity_worklist_t;
+
+static void scc_ir_uniformity_mark(scc_ir_uniformity_worklist_t *worklist,
+                                   scc_uint32_t instruction) {
+  const scc_ir_function_t *function = worklist->function;
+  scc_ir_uniformity_t *uniformity = worklist->uniformity;
+
+  if (uniformity->varying[instruction])
+    return;
+
+  uniformity->varying[instruction] = SCC_TRUE;
+  worklist->instructions[worklist->num_of_instructions++] = instruction;
+
+  if ((function->instructions[instruction].op != SCC_IR_OPERATION_BRANCH) || uniformity->divergent)
+    return;
+
+  // Invocations can now disagree on which path they took, and thus on what
+  // any `phi` chooses.
+  uniformity->divergent = SCC_TRUE;
+
+  for (scc_uint32_t i = 0; i < uniformity->num_of_instructions; ++i)
+    if (function->instructions[i].op == SCC_IR_OPERATION_PHI)
+      if (scc_ir_instruction_is_live(&function->instructions[i]))
+        scc_ir_uniformity_mark(worklist, i);
+}
+
+scc_ir_uniformity_t *scc_ir_uniformity_compute(const scc_ir_function_t *function,
+                                               const scc_ir_uses_t *uses) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = function->num_of_instructions;
+
+  scc_ir_uniformity_t *uniformity =
+    (scc_ir_uniformity_t *)heap->allocate(heap, sizeof(scc_ir_uniformity_t), 16);
+
+  uniformity->num_of_instructions = n;
+  uniformity->varying = (scc_bool_t *)heap->allocate(heap, (n + 1) * sizeof(scc_bool_t), 16);
+
+  // Everything is assumed uniform until shown otherwise.
+  scc_ir_uniformity_worklist_t worklist;
+
+  worklist.function = function;
+  worklist.uniformity = uniformity;
+  worklist.instructions = (scc_uint32_t *)heap->allocate(heap, (n + 1) * sizeof(scc_uint32_t), 16);
+  worklist.num_of_instructions = 0;
+
+  for (scc_uint32_t i = 0; i < n; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    if (scc_ir_uniformity_is_source(function, instruction))
+      scc_ir_uniformity_mark(&worklist, i);
+  }
+
+  while (worklist.num_of_instructions) {
+    const scc_uint32_t i = worklist.instructions[--worklist.num_of_instructions];
+
+    const scc_uint32_t *users = scc_ir_users(uses, i);
+    const scc_uint32_t num_of_users = uses->counts[i];
+
+    for (scc_uint32_t user = 0; user < num_of_users; ++user)
+      scc_ir_uniformity_mark(&worklist, users[user]);
+  }
+
+  heap->free(heap, (void *)worklist.instructions);
+
+  return uniformity;
+}
+
+void scc_ir_uniformity_destroy(scc_ir_uniformity_t *uniformity) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  heap->free(heap, (void *)uniformity->varying);
+  heap->free(heap, (void *)uniformity);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,91 @@
+//===-- scc/ir/analyses/uses.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/uses.h"
+
+SCC_BEGIN_EXTERN_C
+
+scc_ir_uses_t *scc_ir_uses_compute(const scc_ir_function_t *function) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_uint32_t n = function->num_of_instructions;
+
+  scc_ir_uses_t *uses =
+    (scc_ir_uses_t *)heap->allocate(heap, sizeof(scc_ir_uses_t), 16);
+
+  uses->num_of_instructions = n;
+  uses->num_of_arguments = function->num_of_arguments;
+
+  uses->counts = (scc_uint32_t *)heap->allocate(heap, (n + 1) * sizeof(scc_uint32_t), 16);
+  uses->arguments = (scc_uint32_t *)heap->allocate(heap, (function->num_of_arguments + 1) * sizeof(scc_uint32_t), 16);
+  uses->first_user = (scc_uint32_t *)heap->allocate(heap, (n + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t total = 0;
+
+  for (scc_uint32_t instruction = 0; instruction < n; ++instruction) {
+    const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+    if (!scc_ir_instruction_is_live(user))
+      continue;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+    for (scc_uint32_t operand = 0; operand < user->num_of_operands; ++operand) {
+      const scc_ir_value_t value = operands[operand];
+
+      if (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION) {
+        uses->counts[SCC_IR_VALUE_INDEX(value)] += 1;
+        total += 1;
+      } else if (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_ARGUMENT) {
+        uses->arguments[SCC_IR_VALUE_INDEX(value)] += 1;
+      }
+    }
+  }
+
+  for (scc_uint32_t instruction = 0; instruction < n; ++instruction)
+    uses->first_user[instruction + 1] = uses->first_user[instruction] + uses->counts[instruction];
+
+  uses->users = (scc_uint32_t *)heap->allocate(heap, (total + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t *cursor = (scc_uint32_t *)heap->allocate(heap, (n + 1) * sizeof(scc_uint32_t), 16);
+  memcpy(cursor, uses->first_user, n * sizeof(scc_uint32_t));
+
+  for (scc_uint32_t instruction = 0; instruction < n; ++instruction) {
+    const scc_ir_instruction_t *user = &function->instructions[instruction];
+
+    if (!scc_ir_instruction_is_live(user))
+      continue;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, user);
+
+    for (scc_uint32_t operand = 0; operand < user->num_of_operands; ++operand)
+      if (SCC_IR_VALUE_KIND(operands[operand]) == SCC_IR_VALUE_INSTRUCTION)
+        uses->users[cursor[SCC_IR_VALUE_INDEX(operands[operand])]++] = instruction;
+  }
+
+  heap->free(heap, (void *)cursor);
+
+  return uses;
+}
+
+void scc_ir_uses_destroy(scc_ir_uses_t *uses) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  heap->free(heap, (void *)uses->counts);
+  heap->free(heap, (void *)uses->arguments);
+  heap->free(heap, (void *)uses->users);
+  heap->free(heap, (void *)uses->first_user);
+  heap->free(heap, (void *)uses);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,548 @@
+//===-- scc/ir/bytecode.cc ------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/bytecode.h"
+#include "scc/ir/cfg.h"
+
+SCC_BEGIN_EXTERN_C
+
+const scc_ir_opcode_info_t SCC_IR_OPCODES[SCC_IR_NUM_OF_OPCODES] = {
+  #define OPCODE(Mnemonic, Code, Operands) \
+    { Mnemonic, Operands },
+
+    #include "scc/ir/bytecode.inl"
+
+  #undef OPCODE
+};
+
+typedef struct scc_ir_lowering {
+  const scc_ir_function_t *function;
+
+  scc_ir_bytecode_t *bytecode;
+
+  // Number of words `scc_ir_bytecode_t::code` can hold.
+  scc_uint32_t capacity;
+} scc_ir_lowering_t;
+
+static void scc_ir_lowering_emit(scc_ir_lowering_t *lowering,
+                                 scc_uint32_t word) {
+  scc_ir_bytecode_t *bytecode = lowering->bytecode;
+
+  if (bytecode->size_of_code == lowering->capacity) {
+    scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+    const scc_uint32_t capacity = lowering->capacity ? lowering->capacity * 2 : 256;
+
+    scc_uint32_t *code = (scc_uint32_t *)heap->allocate(heap, capacity * sizeof(scc_uint32_t), 16);
+
+    if (bytecode->code) {
+      memcpy(code, bytecode->code, bytecode->size_of_code * sizeof(scc_uint32_t));
+      heap->free(heap, (void *)bytecode->code);
+    }
+
+    bytecode->code = code;
+    lowering->capacity = capacity;
+  }
+
+  bytecode->code[bytecode->size_of_code++] = word;
+}
+
+static scc_uint32_t scc_ir_lowering_words(scc_ir_type_t type) {
+  return scc_ir_type_num_of_components(type) * SCC_IR_LANES;
+}
+
+// Returns the first of the opcodes specialised for `op` on vectors of
+// `scalar`, one per width, or `SCC_IR_OPCODE_GENERIC` if there are none.
+static scc_uint32_t scc_ir_lowering_family(scc_uint32_t op,
+                                           scc_uint32_t scalar) {
+  if (scalar == SCC_IR_F32) {
+    switch (op) {
+      case SCC_IR_OPERATION_ADD: return SCC_IR_OPCODE_ADD_F32X1;
+      case SCC_IR_OPERATION_SUB: return SCC_IR_OPCODE_SUB_F32X1;
+      case SCC_IR_OPERATION_MULTIPLY: return SCC_IR_OPCODE_MUL_F32X1;
+      case SCC_IR_OPERATION_DIVIDE: return SCC_IR_OPCODE_DIV_F32X1;
+      case SCC_IR_OPERATION_MIN: return SCC_IR_OPCODE_MIN_F32X1;
+      case SCC_IR_OPERATION_MAX: return SCC_IR_OPCODE_MAX_F32X1;
+      case SCC_IR_OPERATION_FMA: return SCC_IR_OPCODE_FMA_F32X1;
+      case SCC_IR_OPERATION_CLAMP: return SCC_IR_OPCODE_CLAMP_F32X1;
+      case SCC_IR_OPERATION_ABS: return SCC_IR_OPCODE_ABS_F32X1;
+      case SCC_IR_OPERATION_FLOOR: return SCC_IR_OPCODE_FLOOR_F32X1;
+      case SCC_IR_OPERATION_CEIL: return SCC_IR_OPCODE_CEIL_F32X1;
+      case SCC_IR_OPERATION_SQRT: return SCC_IR_OPCODE_SQRT_F32X1;
+      case SCC_IR_OPERATION_RSQRT: return SCC_IR_OPCODE_RSQRT_F32X1;
+      case SCC_IR_OPERATION_SATURATE: return SCC_IR_OPCODE_SAT_F32X1;
+      case SCC_IR_OPERATION_LESS: return SCC_IR_OPCODE_LT_F32X1;
+      case SCC_IR_OPERATION_LESS_OR_EQUAL: return SCC_IR_OPCODE_LE_F32X1;
+      case SCC_IR_OPERATION_EQUAL: return SCC_IR_OPCODE_EQ_F32X1;
+      case SCC_IR_OPERATION_NOT_EQUAL: return SCC_IR_OPCODE_NE_F32X1;
+      case SCC_IR_OPERATION_GREATER: return SCC_IR_OPCODE_GT_F32X1;
+      case SCC_IR_OPERATION_GREATER_OR_EQUAL: return SCC_IR_OPCODE_GE_F32X1;
+    }
+  }
+
+  if ((scalar == SCC_IR_I32) || (scalar == SCC_IR_U32)) {
+    switch (op) {
+      case SCC_IR_OPERATION_ADD: return SCC_IR_OPCODE_ADD_I32X1;
+      case SCC_IR_OPERATION_SUB: return SCC_IR_OPCODE_SUB_I32X1;
+      case SCC_IR_OPERATION_MULTIPLY: return SCC_IR_OPCODE_MUL_I32X1;
+      case SCC_IR_OPERATION_EQUAL: return SCC_IR_OPCODE_EQ_I32X1;
+      case SCC_IR_OPERATION_NOT_EQUAL: return SCC_IR_OPCODE_NE_I32X1;
+    }
+  }
+
+  if (scalar == SCC_IR_I32) {
+    switch (op) {
+      case SCC_IR_OPERATION_LESS: return SCC_IR_OPCODE_LT_I32X1;
+      case SCC_IR_OPERATION_LESS_OR_EQUAL: return SCC_IR_OPCODE_LE_I32X1;
+      case SCC_IR_OPERATION_GREATER: return SCC_IR_OPCODE_GT_I32X1;
+      case SCC_IR_OPERATION_GREATER_OR_EQUAL: return SCC_IR_OPCODE_GE_I32X1;
+    }
+  }
+
+  if (scalar == SCC_IR_U32) {
+    switch (op) {
+      case SCC_IR_OPERATION_LESS: return SCC_IR_OPCODE_LT_U32X1;
+      case SCC_IR_OPERATION_LESS_OR_EQUAL: return SCC_IR_OPCODE_LE_U32X1;
+      case SCC_IR_OPERATION_GREATER: return SCC_IR_OPCODE_GT_U32X1;
+      case SCC_IR_OPERATION_GREATER_OR_EQUAL: return SCC_IR_OPCODE_GE_U32X1;
+    }
+  }
+
+  return SCC_IR_OPCODE_GENERIC;
+}
+
+// Lowers a component-wise operation to an opcode specialised for its width,
+// splatting scalars as needed. Returns false if there is no such opcode.
+static scc_bool_t scc_ir_lowering_component_wise(scc_ir_lowering_t *lowering,
+                                                 scc_uint32_t index) {
+  const scc_ir_function_t *function = lowering->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[index];
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  scc_ir_bytecode_t *bytecode = lowering->bytecode;
+
+  if (!scc_ir_instruction_is_component_wise(function, instruction))
+    return SCC_FALSE;
+
+  if (instruction->num_of_operands != SCC_IR_OPERATIONS[instruction->op].inputs)
+    return SCC_FALSE;
+
+  const scc_ir_type_t type = instruction->type;
+  const scc_ir_type_t input = scc_ir_value_type(function, operands[0]);
+
+  const scc_uint32_t family = scc_ir_lowering_family(instruction->op, input.scalar);
+
+  if (family == SCC_IR_OPCODE_GENERIC)
+    return SCC_FALSE;
+
+  if ((type.columns != 1) || (type.rows > 4))
+    return SCC_FALSE;
+
+  const scc_bool_t comparison = (family >= SCC_IR_OPCODE_LT_F32X1);
+
+  // Comparisons yield one or zero, as words, which floats are not.
+  if (comparison ? (type.scalar == SCC_IR_F32) : (type.scalar != input.scalar))
+    return SCC_FALSE;
+
+  const scc_uint32_t n = type.rows;
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    const scc_ir_type_t operand_type = scc_ir_value_type(function, operands[operand]);
+
+    if (operand_type.scalar != input.scalar)
+      return SCC_FALSE;
+
+    const scc_uint32_t width = scc_ir_type_num_of_components(operand_type);
+
+    if ((width != n) && (width != 1))
+      return SCC_FALSE;
+  }
+
+  scc_uint32_t slots[3];
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    slots[operand] = scc_ir_bytecode_slot(bytecode, operands[operand]);
+
+    if ((n == 1) || (scc_ir_value_type(function, operands[operand]).rows != 1))
+      continue;
+
+    // Broadcast scalars are splatted to scratch.
+    const scc_uint32_t splatted = bytecode->scratch + operand * 4 * SCC_IR_LANES;
+
+    scc_ir_lowering_emit(lowering, SCC_IR_OPCODE_SPLAT_X2 + (n - 2));
+    scc_ir_lowering_emit(lowering, splatted);
+    scc_ir_lowering_emit(lowering, slots[operand]);
+
+    slots[operand] = splatted;
+  }
+
+  scc_ir_lowering_emit(lowering, family + (n - 1));
+  scc_ir_lowering_emit(lowering, bytecode->instructions[index]);
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+    scc_ir_lowering_emit(lowering, slots[operand]);
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_lowering_geometric(scc_ir_lowering_t *lowering,
+                                            scc_uint32_t index) {
+  const scc_ir_function_t *function = lowering->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[index];
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  scc_ir_bytecode_t *bytecode = lowering->bytecode;
+
+  if (instruction->num_of_operands != 2)
+    return SCC_FALSE;
+
+  const scc_ir_type_t left = scc_ir_value_type(function, operands[0]);
+  const scc_ir_type_t right = scc_ir_value_type(function, operands[1]);
+
+  if ((left.scalar != SCC_IR_F32) || (right.scalar != SCC_IR_F32))
+    return SCC_FALSE;
+
+  scc_uint32_t opcode = SCC_IR_OPCODE_GENERIC;
+
+  if (instruction->op == SCC_IR_OPERATION_DOT) {
+    if (scc_ir_type_is_vector(left) && (left.rows == right.rows) && (right.columns == 1))
+      opcode = SCC_IR_OPCODE_DOT_F32X2 + (left.rows - 2);
+  } else if (instruction->op == SCC_IR_OPERATION_MULTIPLY) {
+    if ((left.rows == 4) && (left.columns == 4) && (right.rows == 4) && (right.columns == 1))
+      opcode = SCC_IR_OPCODE_MUL_F32X4X4;
+  }
+
+  if (opcode == SCC_IR_OPCODE_GENERIC)
+    return SCC_FALSE;
+
+  scc_ir_lowering_emit(lowering, opcode);
+  scc_ir_lowering_emit(lowering, bytecode->instructions[index]);
+  scc_ir_lowering_emit(lowering, scc_ir_bytecode_slot(bytecode, operands[0]));
+  scc_ir_lowering_emit(lowering, scc_ir_bytecode_slot(bytecode, operands[1]));
+
+  return SCC_TRUE;
+}
+
+// Swizzles and compositions become a copy of each component, from wherever
+// it is.
+static void scc_ir_lowering_shuffle(scc_ir_lowering_t *lowering,
+                                    scc_uint32_t index) {
+  const scc_ir_function_t *function = lowering->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[index];
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  scc_ir_bytecode_t *bytecode = lowering->bytecode;
+
+  scc_ir_lowering_emit(lowering, SCC_IR_OPCODE_SHUFFLE);
+  scc_ir_lowering_emit(lowering, bytecode->instructions[index]);
+  scc_ir_lowering_emit(lowering, scc_ir_type_num_of_components(instruction->type));
+
+  if (instruction->op == SCC_IR_OPERATION_SWIZZLE) {
+    const scc_uint32_t input = scc_ir_bytecode_slot(bytecode, operands[0]);
+    const scc_uint32_t swizzle = SCC_IR_VALUE_INDEX(operands[1]);
+
+    for (scc_uint32_t lane = 0; lane < instruction->type.rows; ++lane)
+      scc_ir_lowering_emit(lowering, input + SCC_IR_SWIZZLE_LANE(swizzle, lane) * SCC_IR_LANES);
+
+    return;
+  }
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    const scc_uint32_t input = scc_ir_bytecode_slot(bytecode, operands[operand]);
+    const scc_uint32_t n = scc_ir_type_num_of_components(scc_ir_value_type(function, operands[operand]));
+
+    for (scc_uint32_t component = 0; component < n; ++component)
+      scc_ir_lowering_emit(lowering, input + component * SCC_IR_LANES);
+  }
+}
+
+// Emits the edge from `from` to `to`, copying incoming values to phis.
+static void scc_ir_lowering_edge(scc_ir_lowering_t *lowering,
+                                 scc_uint32_t from,
+                                 scc_uint32_t to) {
+  const scc_ir_function_t *function = lowering->function;
+
+  scc_ir_bytecode_t *bytecode = lowering->bytecode;
+
+  scc_ir_lowering_emit(lowering, to);
+
+  const scc_uint32_t copies = bytecode->size_of_code;
+  scc_ir_lowering_emit(lowering, 0);
+
+  for (scc_uint32_t i = function->blocks[to].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *phi = &function->instructions[i];
+
+    if (phi->op != SCC_IR_OPERATION_PHI)
+      break;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, phi);
+
+    for (scc_uint32_t operand = 0; operand + 1 < phi->num_of_operands; operand += 2) {
+      if (operands[operand] != SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, from))
+        continue;
+
+      scc_ir_lowering_emit(lowering, bytecode->instructions[i]);
+      scc_ir_lowering_emit(lowering, scc_ir_bytecode_slot(bytecode, operands[operand + 1]));
+      scc_ir_lowering_emit(lowering, scc_ir_type_num_of_components(phi->type));
+
+      bytecode->code[copies] += 1;
+
+      break;
+    }
+  }
+}
+
+static void scc_ir_lowering_instruction(scc_ir_lowering_t *lowering,
+                                        scc_uint32_t block,
+                                        scc_uint32_t index) {
+  const scc_ir_function_t *function = lowering->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[index];
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  scc_ir_bytecode_t *bytecode = lowering->bytecode;
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_NOP:
+    case SCC_IR_OPERATION_PHI:
+      return;
+
+    case SCC_IR_OPERATION_SWIZZLE:
+    case SCC_IR_OPERATION_COMPOSE:
+      return scc_ir_lowering_shuffle(lowering, index);
+
+    case SCC_IR_OPERATION_JUMP:
+      scc_ir_lowering_emit(lowering, SCC_IR_OPCODE_JUMP);
+      scc_ir_lowering_edge(lowering, block, SCC_IR_VALUE_INDEX(operands[0]));
+      return;
+
+    case SCC_IR_OPERATION_BRANCH:
+      scc_ir_lowering_emit(lowering, SCC_IR_OPCODE_BRANCH);
+      scc_ir_lowering_emit(lowering, scc_ir_bytecode_slot(bytecode, operands[0]));
+      scc_ir_lowering_emit(lowering, scc_ir_value_type(function, operands[0]).scalar == SCC_IR_F32);
+      scc_ir_lowering_edge(lowering, block, SCC_IR_VALUE_INDEX(operands[1]));
+      scc_ir_lowering_edge(lowering, block, SCC_IR_VALUE_INDEX(operands[2]));
+      return;
+
+    case SCC_IR_OPERATION_RETURN:
+      scc_ir_lowering_emit(lowering, SCC_IR_OPCODE_RETURN);
+      if (instruction->num_of_operands > 0) {
+        scc_ir_lowering_emit(lowering, scc_ir_bytecode_slot(bytecode, operands[0]));
+        scc_ir_lowering_emit(lowering, scc_ir_type_num_of_components(scc_ir_value_type(function, operands[0])));
+      } else {
+        scc_ir_lowering_emit(lowering, 0);
+        scc_ir_lowering_emit(lowering, 0);
+      }
+      return;
+
+    case SCC_IR_OPERATION_DISCARD:
+      scc_ir_lowering_emit(lowering, SCC_IR_OPCODE_DISCARD);
+      return;
+
+    case SCC_IR_OPERATION_DOT:
+    case SCC_IR_OPERATION_MULTIPLY:
+      if (scc_ir_lowering_geometric(lowering, index))
+        return;
+      break;
+  }
+
+  if (scc_ir_lowering_component_wise(lowering, index))
+    return;
+
+  scc_ir_lowering_emit(lowering, SCC_IR_OPCODE_GENERIC);
+  scc_ir_lowering_emit(lowering, index);
+}
+
+// Assigns slots to everything, and builds the image of constants.
+static scc_bool_t scc_ir_lowering_layout(scc_ir_lowering_t *lowering) {
+  const scc_ir_function_t *function = lowering->function;
+
+  scc_ir_bytecode_t *bytecode = lowering->bytecode;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (!scc_ir_bytecode_is_representable(function->return_type))
+    return SCC_FALSE;
+
+  // Enough zeros for any value.
+  scc_uint32_t size = 16 * SCC_IR_LANES;
+
+  for (scc_uint32_t constant = 0; constant < function->num_of_constants; ++constant) {
+    const scc_ir_type_t type = function->constants[constant].type;
+
+    bytecode->constants[constant] = size;
+
+    // Constants are only unrepresentable if unused, so remain zero.
+    if (scc_ir_bytecode_is_representable(type))
+      size += scc_ir_lowering_words(type);
+  }
+
+  bytecode->size_of_image = size;
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    bytecode->instructions[i] = size;
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    if (!scc_ir_bytecode_is_representable(instruction->type))
+      return SCC_FALSE;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+      if (SCC_IR_VALUE_KIND(operands[operand]) == SCC_IR_VALUE_CONSTANT)
+        if (!scc_ir_bytecode_is_representable(scc_ir_value_type(function, operands[operand])))
+          return SCC_FALSE;
+
+    size += scc_ir_lowering_words(instruction->type);
+  }
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument) {
+    const scc_ir_type_t type = function->arguments[argument].type;
+
+    if (!scc_ir_bytecode_is_representable(type))
+      return SCC_FALSE;
+
+    bytecode->arguments[argument] = size;
+    size += scc_ir_lowering_words(type);
+  }
+
+  bytecode->returned = size;
+  size += scc_ir_lowering_words(function->return_type);
+
+  // Incoming values are staged before any are copied, in case one `phi`
+  // refers to another of the same block.
+  scc_uint32_t incoming = 0;
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    scc_uint32_t needed = 0;
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      if (function->instructions[i].op != SCC_IR_OPERATION_PHI)
+        break;
+      needed += scc_ir_lowering_words(function->instructions[i].type);
+    }
+
+    incoming = SCC_MAX(incoming, needed);
+  }
+
+  bytecode->incoming = size;
+  size += incoming;
+
+  // Room to splat each of three operands.
+  bytecode->scratch = size;
+  size += 3 * 4 * SCC_IR_LANES;
+
+  bytecode->size_of_frame = size;
+
+  bytecode->image =
+    (scc_ir_word_t *)heap->allocate(heap, bytecode->size_of_image * sizeof(scc_ir_word_t), 64);
+
+  for (scc_uint32_t constant = 0; constant < function->num_of_constants; ++constant) {
+    const scc_ir_constant_t *value = &function->constants[constant];
+
+    if (!scc_ir_bytecode_is_representable(value->type))
+      continue;
+
+    scc_ir_word_t *words = &bytecode->image[bytecode->constants[constant]];
+
+    for (scc_uint32_t k = 0; k < scc_ir_type_num_of_components(value->type); ++k) {
+      scc_ir_word_t word;
+
+      switch (value->type.scalar) {
+        case SCC_IR_F32: word.f = (scc_float32_t)value->components[k].f; break;
+        case SCC_IR_I8: case SCC_IR_I16: case SCC_IR_I32: word.i = (scc_int32_t)value->components[k].i; break;
+        default: word.u = (scc_uint32_t)value->components[k].u; break;
+      }
+
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        words[k * SCC_IR_LANES + lane] = word;
+    }
+  }
+
+  return SCC_TRUE;
+}
+
+scc_ir_bytecode_t *scc_ir_bytecode_lower(const scc_ir_function_t *function) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_bytecode_t *bytecode =
+    (scc_ir_bytecode_t *)heap->allocate(heap, sizeof(scc_ir_bytecode_t), 16);
+
+  bytecode->function = function;
+
+  bytecode->blocks =
+    (scc_uint32_t *)heap->allocate(heap, (function->num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+  bytecode->order =
+    (scc_uint32_t *)heap->allocate(heap, (function->num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+  bytecode->instructions =
+    (scc_uint32_t *)heap->allocate(heap, (function->num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  bytecode->arguments =
+    (scc_uint32_t *)heap->allocate(heap, (function->num_of_arguments + 1) * sizeof(scc_uint32_t), 16);
+  bytecode->constants =
+    (scc_uint32_t *)heap->allocate(heap, (function->num_of_constants + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_ir_lowering_t lowering;
+
+  lowering.function = function;
+  lowering.bytecode = bytecode;
+  lowering.capacity = 0;
+
+  if (!scc_ir_lowering_layout(&lowering)) {
+    scc_ir_bytecode_destroy(bytecode);
+    return NULL;
+  }
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block)
+    bytecode->blocks[block] = SCC_IR_NONE;
+
+  scc_ir_cfg_t *cfg = scc_ir_cfg_compute(function);
+
+  bytecode->num_of_reachable = cfg->num_of_reachable;
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    bytecode->order[position] = block;
+    bytecode->blocks[block] = bytecode->size_of_code;
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+      scc_ir_lowering_instruction(&lowering, block, i);
+  }
+
+  scc_ir_cfg_destroy(cfg);
+
+  return bytecode;
+}
+
+void scc_ir_bytecode_destroy(scc_ir_bytecode_t *bytecode) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (bytecode->code)
+    heap->free(heap, (void *)bytecode->code);
+  if (bytecode->image)
+    heap->free(heap, (void *)bytecode->image);
+  if (bytecode->natives)
+    heap->free(heap, (void *)bytecode->natives);
+
+  heap->free(heap, (void *)bytecode->blocks);
+  heap->free(heap, (void *)bytecode->order);
+  heap->free(heap, (void *)bytecode->instructions);
+  heap->free(heap, (void *)bytecode->arguments);
+  heap->free(heap, (void *)bytecode->constants);
+  heap->free(heap, (void *)bytecode);
+}
+
+SCC_END_EXTERN_C
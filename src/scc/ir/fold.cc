@@ -0,0 +1,646 @@
+//===-- scc/ir/fold.cc ----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/fold.h"
+
+#include <math.h>
+
+SCC_BEGIN_EXTERN_C
+
+typedef enum scc_ir_fold_domain {
+  SCC_IR_FOLD_NOT_ARITHMETIC = 0,
+  SCC_IR_FOLD_FLOAT          = 1,
+  SCC_IR_FOLD_SIGNED         = 2,
+  SCC_IR_FOLD_UNSIGNED       = 3
+} scc_ir_fold_domain_t;
+
+static scc_ir_fold_domain_t scc_ir_fold_domain_of(scc_ir_type_t type) {
+  if (scc_ir_type_is_floating_point(type))
+    return SCC_IR_FOLD_FLOAT;
+  if (scc_ir_type_is_signed(type))
+    return SCC_IR_FOLD_SIGNED;
+  if (scc_ir_type_is_unsigned(type) || (type.scalar == SCC_IR_BOOL))
+    return SCC_IR_FOLD_UNSIGNED;
+  return SCC_IR_FOLD_NOT_ARITHMETIC;
+}
+
+// Component `k` of `constant`, broadcasting scalars.
+static const scc_ir_component_t *scc_ir_fold_lane(const scc_ir_constant_t *constant,
+                                                  scc_uint32_t k) {
+  if (scc_ir_type_num_of_components(constant->type) == 1)
+    return &constant->components[0];
+  return &constant->components[k];
+}
+
+// Rounds or wraps each component to the width of its type.
+static void scc_ir_fold_normalize(scc_ir_constant_t *constant) {
+  const scc_uint32_t n = scc_ir_type_num_of_components(constant->type);
+
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    scc_ir_component_t *c = &constant->components[k];
+
+    switch (constant->type.scalar) {
+      case SCC_IR_BOOL: c->u = (c->u != 0) ? 1 : 0; break;
+      case SCC_IR_I8:   c->i = (scc_int8_t)c->i; break;
+      case SCC_IR_I16:  c->i = (scc_int16_t)c->i; break;
+      case SCC_IR_I32:  c->i = (scc_int32_t)c->i; break;
+      case SCC_IR_U8:   c->u = (scc_uint8_t)c->u; break;
+      case SCC_IR_U16:  c->u = (scc_uint16_t)c->u; break;
+      case SCC_IR_U32:  c->u = (scc_uint32_t)c->u; break;
+      case SCC_IR_F32:  c->f = (scc_float64_t)(scc_float32_t)c->f; break;
+    }
+  }
+}
+
+static void scc_ir_fold_set_truth(scc_ir_constant_t *result,
+                                  scc_uint32_t k,
+                                  scc_bool_t truth) {
+  switch (scc_ir_fold_domain_of(result->type)) {
+    case SCC_IR_FOLD_FLOAT: result->components[k].f = truth ? 1.0 : 0.0; break;
+    case SCC_IR_FOLD_SIGNED: result->components[k].i = truth ? 1 : 0; break;
+    default: result->components[k].u = truth ? 1 : 0; break;
+  }
+}
+
+static scc_bool_t scc_ir_fold_float(scc_uint32_t op,
+                                    const scc_float64_t *x,
+                                    scc_float64_t *r) {
+  switch (op) {
+    case SCC_IR_OPERATION_ADD: *r = x[0] + x[1]; return SCC_TRUE;
+    case SCC_IR_OPERATION_SUB: *r = x[0] - x[1]; return SCC_TRUE;
+    case SCC_IR_OPERATION_MULTIPLY: *r = x[0] * x[1]; return SCC_TRUE;
+    case SCC_IR_OPERATION_DIVIDE: *r = x[0] / x[1]; return SCC_TRUE;
+    case SCC_IR_OPERATION_FMA: *r = fma(x[0], x[1], x[2]); return SCC_TRUE;
+
+    case SCC_IR_OPERATION_SQRT: *r = sqrt(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_RSQRT: *r = 1.0 / sqrt(x[0]); return SCC_TRUE;
+
+    case SCC_IR_OPERATION_SIN: *r = sin(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_COS: *r = cos(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_TAN: *r = tan(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_SINH: *r = sinh(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_COSH: *r = cosh(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_TANH: *r = tanh(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_ASIN: *r = asin(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_ACOS: *r = acos(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_ATAN: *r = atan(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_ATAN2: *r = atan2(x[0], x[1]); return SCC_TRUE;
+
+    case SCC_IR_OPERATION_POW: *r = pow(x[0], x[1]); return SCC_TRUE;
+    case SCC_IR_OPERATION_EXP: *r = exp(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_EXP2: *r = exp2(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_EXP10: *r = pow(10.0, x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_LOG: *r = log(x[1]) / log(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_LOG2: *r = log2(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_LOG10: *r = log10(x[0]); return SCC_TRUE;
+
+    case SCC_IR_OPERATION_ABS: *r = fabs(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_FLOOR: *r = floor(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_CEIL: *r = ceil(x[0]); return SCC_TRUE;
+    case SCC_IR_OPERATION_MIN: *r = fmin(x[0], x[1]); return SCC_TRUE;
+    case SCC_IR_OPERATION_MAX: *r = fmax(x[0], x[1]); return SCC_TRUE;
+    case SCC_IR_OPERATION_CLAMP: *r = fmin(fmax(x[0], x[1]), x[2]); return SCC_TRUE;
+    case SCC_IR_OPERATION_SATURATE: *r = fmin(fmax(x[0], 0.0), 1.0); return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+// Arithmetic is done on unsigned integers so overflow wraps rather than
+// being undefined.
+static scc_bool_t scc_ir_fold_signed(scc_uint32_t op,
+                                     const scc_int64_t *x,
+                                     scc_int64_t *r) {
+  const scc_uint64_t a = (scc_uint64_t)x[0],
+                     b = (scc_uint64_t)x[1],
+                     c = (scc_uint64_t)x[2];
+
+  switch (op) {
+    case SCC_IR_OPERATION_ADD: *r = (scc_int64_t)(a + b); return SCC_TRUE;
+    case SCC_IR_OPERATION_SUB: *r = (scc_int64_t)(a - b); return SCC_TRUE;
+    case SCC_IR_OPERATION_MULTIPLY: *r = (scc_int64_t)(a * b); return SCC_TRUE;
+    case SCC_IR_OPERATION_FMA: *r = (scc_int64_t)(a * b + c); return SCC_TRUE;
+
+    case SCC_IR_OPERATION_DIVIDE:
+      if ((x[1] == 0) || ((x[1] == -1) && (a == ((scc_uint64_t)1 << 63))))
+        return SCC_FALSE;
+      *r = x[0] / x[1];
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_ABS: *r = (scc_int64_t)((x[0] < 0) ? (0 - a) : a); return SCC_TRUE;
+    case SCC_IR_OPERATION_FLOOR: *r = x[0]; return SCC_TRUE;
+    case SCC_IR_OPERATION_CEIL: *r = x[0]; return SCC_TRUE;
+    case SCC_IR_OPERATION_MIN: *r = SCC_MIN(x[0], x[1]); return SCC_TRUE;
+    case SCC_IR_OPERATION_MAX: *r = SCC_MAX(x[0], x[1]); return SCC_TRUE;
+    case SCC_IR_OPERATION_CLAMP: *r = SCC_MIN(SCC_MAX(x[0], x[1]), x[2]); return SCC_TRUE;
+    case SCC_IR_OPERATION_SATURATE: *r = SCC_MIN(SCC_MAX(x[0], 0), 1); return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+static scc_bool_t scc_ir_fold_unsigned(scc_uint32_t op,
+                                       const scc_uint64_t *x,
+                                       scc_uint64_t *r) {
+  switch (op) {
+    case SCC_IR_OPERATION_ADD: *r = x[0] + x[1]; return SCC_TRUE;
+    case SCC_IR_OPERATION_SUB: *r = x[0] - x[1]; return SCC_TRUE;
+    case SCC_IR_OPERATION_MULTIPLY: *r = x[0] * x[1]; return SCC_TRUE;
+    case SCC_IR_OPERATION_FMA: *r = x[0] * x[1] + x[2]; return SCC_TRUE;
+
+    case SCC_IR_OPERATION_DIVIDE:
+      if (x[1] == 0)
+        return SCC_FALSE;
+      *r = x[0] / x[1];
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_ABS: *r = x[0]; return SCC_TRUE;
+    case SCC_IR_OPERATION_FLOOR: *r = x[0]; return SCC_TRUE;
+    case SCC_IR_OPERATION_CEIL: *r = x[0]; return SCC_TRUE;
+    case SCC_IR_OPERATION_MIN: *r = SCC_MIN(x[0], x[1]); return SCC_TRUE;
+    case SCC_IR_OPERATION_MAX: *r = SCC_MAX(x[0], x[1]); return SCC_TRUE;
+    case SCC_IR_OPERATION_CLAMP: *r = SCC_MIN(SCC_MAX(x[0], x[1]), x[2]); return SCC_TRUE;
+    case SCC_IR_OPERATION_SATURATE: *r = SCC_MIN(x[0], 1); return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+static scc_bool_t scc_ir_fold_is_comparison(scc_uint32_t op) {
+  return (op >= SCC_IR_OPERATION_LESS) && (op <= SCC_IR_OPERATION_GREATER_OR_EQUAL);
+}
+
+// Comparisons involving NaN are false, except for `neq`.
+#define SCC_IR_FOLD_COMPARE(Op, A, B)                            \
+  (((Op) == SCC_IR_OPERATION_LESS) ? ((A) < (B)) :               \
+   ((Op) == SCC_IR_OPERATION_LESS_OR_EQUAL) ? ((A) <= (B)) :     \
+   ((Op) == SCC_IR_OPERATION_EQUAL) ? ((A) == (B)) :             \
+   ((Op) == SCC_IR_OPERATION_NOT_EQUAL) ? ((A) != (B)) :         \
+   ((Op) == SCC_IR_OPERATION_GREATER) ? ((A) > (B)) :            \
+                                        ((A) >= (B)))
+
+static scc_bool_t scc_ir_fold_component_wise(scc_uint32_t op,
+                                             scc_uint32_t num_of_inputs,
+                                             const scc_ir_constant_t * const *inputs,
+                                             scc_ir_constant_t *result) {
+  const scc_uint32_t n = scc_ir_type_num_of_components(result->type);
+
+  const scc_ir_fold_domain_t domain = scc_ir_fold_domain_of(inputs[0]->type);
+
+  if (domain == SCC_IR_FOLD_NOT_ARITHMETIC)
+    return SCC_FALSE;
+
+  for (scc_uint32_t input = 0; input < num_of_inputs; ++input) {
+    if (scc_ir_fold_domain_of(inputs[input]->type) != domain)
+      return SCC_FALSE;
+
+    const scc_uint32_t width = scc_ir_type_num_of_components(inputs[input]->type);
+
+    if ((width != 1) && (width != n))
+      return SCC_FALSE;
+  }
+
+  const scc_bool_t comparison = scc_ir_fold_is_comparison(op);
+
+  if (!comparison && (scc_ir_fold_domain_of(result->type) != domain))
+    return SCC_FALSE;
+
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    scc_ir_component_t x[3];
+
+    for (scc_uint32_t input = 0; input < 3; ++input)
+      x[input].u = (input < num_of_inputs) ? scc_ir_fold_lane(inputs[input], k)->u : 0;
+
+    if (comparison) {
+      scc_bool_t truth;
+
+      switch (domain) {
+        case SCC_IR_FOLD_FLOAT: truth = SCC_IR_FOLD_COMPARE(op, x[0].f, x[1].f); break;
+        case SCC_IR_FOLD_SIGNED: truth = SCC_IR_FOLD_COMPARE(op, x[0].i, x[1].i); break;
+        default: truth = SCC_IR_FOLD_COMPARE(op, x[0].u, x[1].u); break;
+      }
+
+      scc_ir_fold_set_truth(result, k, truth);
+
+      continue;
+    }
+
+    scc_float64_t f[3] = { x[0].f, x[1].f, x[2].f };
+    scc_int64_t i[3] = { x[0].i, x[1].i, x[2].i };
+    scc_uint64_t u[3] = { x[0].u, x[1].u, x[2].u };
+
+    scc_bool_t folded;
+
+    switch (domain) {
+      case SCC_IR_FOLD_FLOAT: folded = scc_ir_fold_float(op, f, &result->components[k].f); break;
+      case SCC_IR_FOLD_SIGNED: folded = scc_ir_fold_signed(op, i, &result->components[k].i); break;
+      default: folded = scc_ir_fold_unsigned(op, u, &result->components[k].u); break;
+    }
+
+    if (!folded)
+      return SCC_FALSE;
+  }
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_fold_swizzle(const scc_ir_function_t *function,
+                                      const scc_ir_instruction_t *instruction,
+                                      const scc_ir_constant_t *input,
+                                      scc_ir_constant_t *result) {
+  const scc_uint32_t mask = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1));
+  const scc_uint32_t width = scc_ir_type_num_of_components(input->type);
+
+  if (input->type.scalar != result->type.scalar)
+    return SCC_FALSE;
+
+  if ((result->type.columns != 1) || (result->type.rows > 4) || (input->type.columns != 1))
+    return SCC_FALSE;
+
+  for (scc_uint32_t lane = 0; lane < result->type.rows; ++lane) {
+    const scc_uint32_t selected = SCC_IR_SWIZZLE_LANE(mask, lane);
+
+    if (selected >= width)
+      return SCC_FALSE;
+
+    result->components[lane] = input->components[selected];
+  }
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_fold_compose(scc_uint32_t num_of_inputs,
+                                      const scc_ir_constant_t * const *inputs,
+                                      scc_ir_constant_t *result) {
+  const scc_uint32_t width = scc_ir_type_num_of_components(result->type);
+
+  scc_uint32_t lane = 0;
+
+  for (scc_uint32_t input = 0; input < num_of_inputs; ++input) {
+    if (inputs[input]->type.scalar != result->type.scalar)
+      return SCC_FALSE;
+
+    const scc_uint32_t n = scc_ir_type_num_of_components(inputs[input]->type);
+
+    if (lane + n > width)
+      return SCC_FALSE;
+
+    memcpy(&result->components[lane], inputs[input]->components, n * sizeof(scc_ir_component_t));
+
+    lane += n;
+  }
+
+  return (lane == width);
+}
+
+static scc_bool_t scc_ir_fold_is_product(const scc_ir_constant_t *a,
+                                         const scc_ir_constant_t *b) {
+  return (scc_ir_type_is_matrix(a->type) && (scc_ir_type_is_vector(b->type) || scc_ir_type_is_matrix(b->type)))
+      || (scc_ir_type_is_vector(a->type) && scc_ir_type_is_matrix(b->type));
+}
+
+// PERF(mtwilliams): Products of integer matrices aren't folded.
+static scc_bool_t scc_ir_fold_product(const scc_ir_constant_t *a,
+                                      const scc_ir_constant_t *b,
+                                      scc_ir_constant_t *result) {
+  if (!scc_ir_type_is_floating_point(a->type) || !scc_ir_type_is_floating_point(b->type))
+    return SCC_FALSE;
+
+  // A vector on the left is treated as a row vector, i.e. a `1 x n` matrix.
+  const scc_bool_t row = scc_ir_type_is_vector(a->type);
+
+  const scc_uint32_t m = row ? 1 : a->type.rows;
+  const scc_uint32_t inner = row ? a->type.rows : a->type.columns;
+  const scc_uint32_t p = b->type.columns;
+
+  if (b->type.rows != inner)
+    return SCC_FALSE;
+
+  if (scc_ir_type_num_of_components(result->type) != m * p)
+    return SCC_FALSE;
+
+  for (scc_uint32_t column = 0; column < p; ++column) {
+    for (scc_uint32_t r = 0; r < m; ++r) {
+      scc_float64_t sum = 0.0;
+
+      for (scc_uint32_t k = 0; k < inner; ++k)
+        sum += a->components[k * m + r].f * b->components[column * inner + k].f;
+
+      result->components[column * m + r].f = sum;
+    }
+  }
+
+  return SCC_TRUE;
+}
+
+static scc_float64_t scc_ir_fold_dot(const scc_ir_constant_t *a,
+                                     const scc_ir_constant_t *b) {
+  scc_float64_t sum = 0.0;
+
+  for (scc_uint32_t k = 0; k < a->type.rows; ++k)
+    sum += a->components[k].f * b->components[k].f;
+
+  return sum;
+}
+
+static scc_bool_t scc_ir_fold_geometric(scc_uint32_t op,
+                                        scc_uint32_t num_of_inputs,
+                                        const scc_ir_constant_t * const *inputs,
+                                        scc_ir_constant_t *result) {
+  const scc_ir_constant_t *a = inputs[0];
+  const scc_ir_constant_t *b = (num_of_inputs > 1) ? inputs[1] : inputs[0];
+
+  if (!scc_ir_type_is_floating_point(a->type) || !scc_ir_type_is_floating_point(b->type))
+    return SCC_FALSE;
+
+  if ((a->type.columns != 1) || (b->type.columns != 1) || (a->type.rows != b->type.rows))
+    return SCC_FALSE;
+
+  const scc_uint32_t width = a->type.rows;
+
+  if (!scc_ir_type_is_floating_point(result->type) || (result->type.columns != 1))
+    return SCC_FALSE;
+
+  switch (op) {
+    case SCC_IR_OPERATION_DOT:
+      result->components[0].f = scc_ir_fold_dot(a, b);
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_MAGNITUDE:
+    case SCC_IR_OPERATION_LENGTH:
+      result->components[0].f = sqrt(scc_ir_fold_dot(a, a));
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_LENGTH_SQUARED:
+      result->components[0].f = scc_ir_fold_dot(a, a);
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_DISTANCE: {
+      scc_float64_t sum = 0.0;
+      for (scc_uint32_t k = 0; k < width; ++k)
+        sum += (a->components[k].f - b->components[k].f) * (a->components[k].f - b->components[k].f);
+      result->components[0].f = sqrt(sum);
+    } return SCC_TRUE;
+
+    case SCC_IR_OPERATION_NORMALIZE: {
+      const scc_float64_t length = sqrt(scc_ir_fold_dot(a, a));
+      // Undefined for zero-length vectors.
+      if ((length == 0.0) || (result->type.rows != width))
+        return SCC_FALSE;
+      for (scc_uint32_t k = 0; k < width; ++k)
+        result->components[k].f = a->components[k].f / length;
+    } return SCC_TRUE;
+
+    case SCC_IR_OPERATION_CROSS: {
+      if ((width != 3) || (result->type.rows != 3))
+        return SCC_FALSE;
+      const scc_ir_component_t *x = &a->components[0], *y = &b->components[0];
+      result->components[0].f = x[1].f * y[2].f - x[2].f * y[1].f;
+      result->components[1].f = x[2].f * y[0].f - x[0].f * y[2].f;
+      result->components[2].f = x[0].f * y[1].f - x[1].f * y[0].f;
+    } return SCC_TRUE;
+
+    case SCC_IR_OPERATION_REFLECT: {
+      if (result->type.rows != width)
+        return SCC_FALSE;
+      // I - 2 * dot(N, I) * N
+      const scc_float64_t d = scc_ir_fold_dot(a, b);
+      for (scc_uint32_t k = 0; k < width; ++k)
+        result->components[k].f = a->components[k].f - 2.0 * d * b->components[k].f;
+    } return SCC_TRUE;
+
+    case SCC_IR_OPERATION_REFRACT: {
+      if ((result->type.rows != width) || !scc_ir_type_is_scalar(inputs[2]->type))
+        return SCC_FALSE;
+      const scc_float64_t eta = inputs[2]->components[0].f;
+      const scc_float64_t d = scc_ir_fold_dot(a, b);
+      const scc_float64_t k = 1.0 - eta * eta * (1.0 - d * d);
+      // Total internal reflection yields a zero vector.
+      for (scc_uint32_t lane = 0; lane < width; ++lane)
+        result->components[lane].f =
+          (k < 0.0) ? 0.0 : (eta * a->components[lane].f - (eta * d + sqrt(k)) * b->components[lane].f);
+    } return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+static scc_bool_t scc_ir_fold_transpose(const scc_ir_constant_t *input,
+                                        scc_ir_constant_t *result) {
+  const scc_uint32_t rows = input->type.rows,
+                     columns = input->type.columns;
+
+  if ((result->type.rows != columns) || (result->type.columns != rows))
+    return SCC_FALSE;
+
+  for (scc_uint32_t r = 0; r < rows; ++r)
+    for (scc_uint32_t c = 0; c < columns; ++c)
+      result->components[r * columns + c] = input->components[c * rows + r];
+
+  return SCC_TRUE;
+}
+
+// Reduces `matrix` by Gauss-Jordan elimination with partial pivoting,
+// applying the same row operations to `inverse` if given. Returns the
+// determinant.
+static scc_float64_t scc_ir_fold_eliminate(scc_float64_t matrix[4][4],
+                                           scc_float64_t inverse[4][4],
+                                           scc_uint32_t n) {
+  scc_float64_t determinant = 1.0;
+
+  for (scc_uint32_t column = 0; column < n; ++column) {
+    scc_uint32_t pivot = column;
+
+    for (scc_uint32_t r = column + 1; r < n; ++r)
+      if (fabs(matrix[r][column]) > fabs(matrix[pivot][column]))
+        pivot = r;
+
+    if (matrix[pivot][column] == 0.0)
+      return 0.0;
+
+    if (pivot != column) {
+      for (scc_uint32_t c = 0; c < n; ++c) {
+        scc_float64_t t = matrix[column][c]; matrix[column][c] = matrix[pivot][c]; matrix[pivot][c] = t;
+        if (inverse) { t = inverse[column][c]; inverse[column][c] = inverse[pivot][c]; inverse[pivot][c] = t; }
+      }
+
+      determinant = -determinant;
+    }
+
+    const scc_float64_t scale = matrix[column][column];
+
+    determinant *= scale;
+
+    for (scc_uint32_t c = 0; c < n; ++c) {
+      matrix[column][c] /= scale;
+      if (inverse) inverse[column][c] /= scale;
+    }
+
+    for (scc_uint32_t r = 0; r < n; ++r) {
+      if (r == column)
+        continue;
+
+      const scc_float64_t factor = matrix[r][column];
+
+      for (scc_uint32_t c = 0; c < n; ++c) {
+        matrix[r][c] -= factor * matrix[column][c];
+        if (inverse) inverse[r][c] -= factor * inverse[column][c];
+      }
+    }
+  }
+
+  return determinant;
+}
+
+static scc_bool_t scc_ir_fold_matrix(scc_uint32_t op,
+                                     const scc_ir_constant_t *input,
+                                     scc_ir_constant_t *result) {
+  const scc_uint32_t n = input->type.rows;
+
+  if (!scc_ir_type_is_floating_point(input->type) || (n != input->type.columns) || (n < 2) || (n > 4))
+    return SCC_FALSE;
+
+  scc_float64_t matrix[4][4], inverse[4][4];
+
+  for (scc_uint32_t r = 0; r < n; ++r) {
+    for (scc_uint32_t c = 0; c < n; ++c) {
+      matrix[r][c] = input->components[c * n + r].f;
+      inverse[r][c] = (r == c) ? 1.0 : 0.0;
+    }
+  }
+
+  if (op == SCC_IR_OPERATION_DETERMINANT) {
+    if (!scc_ir_type_is_scalar(result->type))
+      return SCC_FALSE;
+    result->components[0].f = scc_ir_fold_eliminate(matrix, NULL, n);
+    return SCC_TRUE;
+  }
+
+  if ((result->type.rows != n) || (result->type.columns != n))
+    return SCC_FALSE;
+
+  // Singular matrices have no inverse.
+  if (scc_ir_fold_eliminate(matrix, inverse, n) == 0.0)
+    return SCC_FALSE;
+
+  for (scc_uint32_t r = 0; r < n; ++r)
+    for (scc_uint32_t c = 0; c < n; ++c)
+      result->components[c * n + r].f = inverse[r][c];
+
+  return SCC_TRUE;
+}
+
+scc_bool_t scc_ir_fold(const scc_ir_function_t *function,
+                       const scc_ir_instruction_t *instruction,
+                       const scc_ir_constant_t * const *operands,
+                       scc_ir_constant_t *result) {
+  const scc_uint32_t op = instruction->op;
+
+  if (!scc_ir_operation_is(op, SCC_IR_FOLDABLE))
+    return SCC_FALSE;
+
+  memset(result, 0, sizeof(scc_ir_constant_t));
+
+  result->type = scc_ir_type(instruction->type.scalar,
+                             instruction->type.rows,
+                             instruction->type.columns);
+
+  if (scc_ir_fold_domain_of(result->type) == SCC_IR_FOLD_NOT_ARITHMETIC)
+    return SCC_FALSE;
+
+  if (scc_ir_type_num_of_components(result->type) > 16)
+    return SCC_FALSE;
+
+  // Swizzles have a mask rather than a second value, and compositions take
+  // any number of values.
+  const scc_uint32_t num_of_inputs =
+    (op == SCC_IR_OPERATION_SWIZZLE) ? 1 :
+    (op == SCC_IR_OPERATION_COMPOSE) ? instruction->num_of_operands :
+                                       SCC_IR_OPERATIONS[op].inputs;
+
+  if (instruction->num_of_operands < num_of_inputs)
+    return SCC_FALSE;
+
+  for (scc_uint32_t input = 0; input < num_of_inputs; ++input)
+    if (!operands[input])
+      return SCC_FALSE;
+
+  scc_bool_t folded;
+
+  switch (op) {
+    case SCC_IR_OPERATION_SWIZZLE:
+      folded = scc_ir_fold_swizzle(function, instruction, operands[0], result);
+      break;
+
+    case SCC_IR_OPERATION_COMPOSE:
+      folded = scc_ir_fold_compose(num_of_inputs, operands, result);
+      break;
+
+    case SCC_IR_OPERATION_MAGNITUDE:
+    case SCC_IR_OPERATION_LENGTH:
+    case SCC_IR_OPERATION_LENGTH_SQUARED:
+    case SCC_IR_OPERATION_DOT:
+    case SCC_IR_OPERATION_CROSS:
+    case SCC_IR_OPERATION_NORMALIZE:
+    case SCC_IR_OPERATION_DISTANCE:
+    case SCC_IR_OPERATION_REFLECT:
+    case SCC_IR_OPERATION_REFRACT:
+      folded = scc_ir_fold_geometric(op, num_of_inputs, operands, result);
+      break;
+
+    case SCC_IR_OPERATION_TRANSPOSE:
+      folded = scc_ir_fold_transpose(operands[0], result);
+      break;
+
+    case SCC_IR_OPERATION_INVERSE:
+    case SCC_IR_OPERATION_DETERMINANT:
+      folded = scc_ir_fold_matrix(op, operands[0], result);
+      break;
+
+    case SCC_IR_OPERATION_MULTIPLY:
+      if (scc_ir_fold_is_product(operands[0], operands[1])) {
+        folded = scc_ir_fold_product(operands[0], operands[1], result);
+        break;
+      }
+
+      // Otherwise component-wise.
+      // Fall through.
+    default:
+      folded = scc_ir_fold_component_wise(op, num_of_inputs, operands, result);
+      break;
+  }
+
+  if (!folded)
+    return SCC_FALSE;
+
+  scc_ir_fold_normalize(result);
+
+  return SCC_TRUE;
+}
+
+scc_bool_t scc_ir_constant_is_true(const scc_ir_constant_t *constant) {
+  const scc_uint32_t n = scc_ir_type_num_of_components(constant->type);
+
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    if (scc_ir_type_is_floating_point(constant->type)) {
+      if (constant->components[k].f != 0.0)
+        return SCC_TRUE;
+    } else if (constant->components[k].u != 0) {
+      return SCC_TRUE;
+    }
+  }
+
+  return SCC_FALSE;
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,1477 @@
+//===-- scc/ir/interpreter.cc ---------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/interpreter.h"
+#include "scc/ir/bytecode.h"
+#include "scc/ir/jit.h"
+
+#include "scc/foundation/arena.h"
+
+#include <math.h>
+
+SCC_BEGIN_EXTERN_C
+
+#define SCC_IR_ALL_LANES \
+  ((scc_uint32_t)((1u << SCC_IR_LANES) - 1))
+
+typedef enum scc_ir_interpreter_domain {
+  SCC_IR_INTERPRETER_UNSUPPORTED = 0,
+  SCC_IR_INTERPRETER_FLOAT       = 1,
+  SCC_IR_INTERPRETER_SIGNED      = 2,
+  SCC_IR_INTERPRETER_UNSIGNED    = 3
+} scc_ir_interpreter_domain_t;
+
+static scc_ir_interpreter_domain_t scc_ir_interpreter_domain_of(scc_ir_type_t type) {
+  switch (type.scalar) {
+    case SCC_IR_F32:
+      return SCC_IR_INTERPRETER_FLOAT;
+    case SCC_IR_I8: case SCC_IR_I16: case SCC_IR_I32:
+      return SCC_IR_INTERPRETER_SIGNED;
+    case SCC_IR_BOOL: case SCC_IR_U8: case SCC_IR_U16: case SCC_IR_U32:
+      return SCC_IR_INTERPRETER_UNSIGNED;
+  }
+
+  return SCC_IR_INTERPRETER_UNSUPPORTED;
+}
+
+typedef struct scc_ir_interpreter_function {
+  scc_bool_t supported;
+
+  // Or `NULL` if it couldn't be lowered.
+  scc_ir_bytecode_t *bytecode;
+
+  // Or `NULL` if nothing was compiled.
+  scc_ir_jit_t *jit;
+} scc_ir_interpreter_function_t;
+
+struct scc_ir_interpreter {
+  const scc_ir_module_t *module;
+
+  // Indexed by function.
+  scc_ir_interpreter_function_t *functions;
+
+  // Indexed by member, in `scc_ir_module_t::members`. Number of components
+  // preceding each member in its structure.
+  scc_uint32_t *components_of_members;
+};
+
+typedef struct scc_ir_execution {
+  const scc_ir_interpreter_t *interpreter;
+  const scc_ir_bindings_t *bindings;
+
+  scc_uint32_t count;
+
+  // First invocation of the batch being run.
+  scc_uint32_t base;
+
+  // Lanes that have discarded.
+  scc_uint32_t discarded;
+
+  // Frames and such of calls, released after each batch.
+  scc_allocator_t *scratch;
+} scc_ir_execution_t;
+
+typedef struct scc_ir_frame {
+  const scc_ir_function_t *function;
+  const scc_ir_bytecode_t *bytecode;
+
+  scc_ir_word_t *words;
+
+  // Indexed by block. Lanes waiting to enter each block.
+  scc_uint32_t *pending;
+} scc_ir_frame_t;
+
+//===----------------------------------------------------------------------===//
+// Preparation
+//===----------------------------------------------------------------------===//
+
+// Operations that are done on integers as well as floats.
+static scc_bool_t scc_ir_interpreter_is_integral(scc_uint32_t op) {
+  switch (op) {
+    case SCC_IR_OPERATION_ADD:
+    case SCC_IR_OPERATION_SUB:
+    case SCC_IR_OPERATION_MULTIPLY:
+    case SCC_IR_OPERATION_DIVIDE:
+    case SCC_IR_OPERATION_FMA:
+    case SCC_IR_OPERATION_ABS:
+    case SCC_IR_OPERATION_FLOOR:
+    case SCC_IR_OPERATION_CEIL:
+    case SCC_IR_OPERATION_MIN:
+    case SCC_IR_OPERATION_MAX:
+    case SCC_IR_OPERATION_CLAMP:
+    case SCC_IR_OPERATION_SATURATE:
+    case SCC_IR_OPERATION_LESS:
+    case SCC_IR_OPERATION_LESS_OR_EQUAL:
+    case SCC_IR_OPERATION_EQUAL:
+    case SCC_IR_OPERATION_NOT_EQUAL:
+    case SCC_IR_OPERATION_GREATER:
+    case SCC_IR_OPERATION_GREATER_OR_EQUAL:
+      return SCC_TRUE;
+  }
+
+  return SCC_FALSE;
+}
+
+static scc_bool_t scc_ir_interpreter_is_product(const scc_ir_function_t *function,
+                                                const scc_ir_instruction_t *instruction) {
+  return (instruction->op == SCC_IR_OPERATION_MULTIPLY)
+      && !scc_ir_instruction_is_component_wise(function, instruction);
+}
+
+static scc_bool_t scc_ir_interpreter_is_supported(const scc_ir_function_t *function,
+                                                  const scc_ir_instruction_t *instruction) {
+  const scc_ir_module_t *module = function->module;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  if (!scc_ir_bytecode_is_representable(instruction->type))
+    return SCC_FALSE;
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    switch (SCC_IR_VALUE_KIND(operands[operand])) {
+      case SCC_IR_VALUE_INSTRUCTION:
+      case SCC_IR_VALUE_ARGUMENT:
+      case SCC_IR_VALUE_CONSTANT:
+        if (!scc_ir_bytecode_is_representable(scc_ir_value_type(function, operands[operand])))
+          return SCC_FALSE;
+        break;
+
+      default:
+        break;
+    }
+  }
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_NOP:
+    case SCC_IR_OPERATION_PHI:
+    case SCC_IR_OPERATION_SWIZZLE:
+    case SCC_IR_OPERATION_COMPOSE:
+    case SCC_IR_OPERATION_JUMP:
+    case SCC_IR_OPERATION_BRANCH:
+    case SCC_IR_OPERATION_RETURN:
+    case SCC_IR_OPERATION_DISCARD:
+      return SCC_TRUE;
+
+    case SCC_IR_OPERATION_LOAD:
+    case SCC_IR_OPERATION_STORE: {
+      if (SCC_IR_VALUE_KIND(operands[0]) != SCC_IR_VALUE_GLOBAL)
+        return SCC_FALSE;
+
+      const scc_ir_global_t *global = &module->globals[SCC_IR_VALUE_INDEX(operands[0])];
+
+      if (global->storage == SCC_IR_TEXTURE)
+        return SCC_FALSE;
+
+      if (instruction->op == SCC_IR_OPERATION_STORE)
+        return (global->storage != SCC_IR_INPUT) && (global->type.scalar != SCC_IR_STRUCTURE);
+
+      // Only members of structures are loaded.
+      if (global->type.scalar == SCC_IR_STRUCTURE)
+        return (instruction->num_of_operands >= 2) && (SCC_IR_VALUE_KIND(operands[1]) == SCC_IR_VALUE_MEMBER);
+
+      return SCC_TRUE;
+    }
+
+    case SCC_IR_OPERATION_FETCH:
+    case SCC_IR_OPERATION_GATHER:
+      if (SCC_IR_VALUE_KIND(operands[0]) != SCC_IR_VALUE_GLOBAL)
+        return SCC_FALSE;
+      return (module->globals[SCC_IR_VALUE_INDEX(operands[0])].storage == SCC_IR_TEXTURE)
+          && (instruction->type.columns == 1)
+          && (instruction->type.rows <= 4);
+
+    case SCC_IR_OPERATION_CALL:
+      return (SCC_IR_VALUE_KIND(operands[0]) == SCC_IR_VALUE_FUNCTION);
+  }
+
+  if (!scc_ir_operation_is(instruction->op, SCC_IR_FOLDABLE))
+    return SCC_FALSE;
+
+  const scc_ir_interpreter_domain_t domain =
+    scc_ir_interpreter_domain_of(scc_ir_value_type(function, operands[0]));
+
+  if (domain == SCC_IR_INTERPRETER_FLOAT)
+    return SCC_TRUE;
+
+  // Geometry and matrices are only done on floats.
+  if (!scc_ir_instruction_is_component_wise(function, instruction))
+    return SCC_FALSE;
+
+  return scc_ir_interpreter_is_integral(instruction->op);
+}
+
+static void scc_ir_interpreter_prepare(scc_ir_interpreter_function_t *prepared,
+                                       const scc_ir_function_t *function) {
+  prepared->bytecode = scc_ir_bytecode_lower(function);
+  prepared->supported = (prepared->bytecode != NULL) && (function->num_of_blocks > 0);
+
+  for (scc_uint32_t i = 0; prepared->supported && (i < function->num_of_instructions); ++i)
+    if (scc_ir_instruction_is_live(&function->instructions[i]))
+      prepared->supported = scc_ir_interpreter_is_supported(function, &function->instructions[i]);
+}
+
+scc_ir_interpreter_t *scc_ir_interpreter_create(const scc_ir_module_t *module) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_interpreter_t *interpreter =
+    (scc_ir_interpreter_t *)heap->allocate(heap, sizeof(scc_ir_interpreter_t), 16);
+
+  interpreter->module = module;
+
+  interpreter->functions =
+    (scc_ir_interpreter_function_t *)heap->allocate(heap, (module->num_of_functions + 1) * sizeof(scc_ir_interpreter_function_t), 16);
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function)
+    if (!module->functions[function]->removed)
+      scc_ir_interpreter_prepare(&interpreter->functions[function], module->functions[function]);
+
+  // Functions calling those that aren't supported aren't either, which takes
+  // as many rounds as calls are deep.
+  for (scc_bool_t changed = SCC_TRUE; changed; ) {
+    changed = SCC_FALSE;
+
+    for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+      const scc_ir_function_t *function = module->functions[index];
+
+      if (function->removed || !interpreter->functions[index].supported)
+        continue;
+
+      for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+        const scc_ir_instruction_t *call = &function->instructions[i];
+
+        if ((call->op != SCC_IR_OPERATION_CALL) || !scc_ir_instruction_is_live(call))
+          continue;
+
+        const scc_uint32_t callee = SCC_IR_VALUE_INDEX(scc_ir_operand(function, call, 0));
+
+        if ((callee < module->num_of_functions)
+         && !module->functions[callee]->removed
+         && interpreter->functions[callee].supported)
+          continue;
+
+        interpreter->functions[index].supported = SCC_FALSE;
+        changed = SCC_TRUE;
+
+        break;
+      }
+    }
+  }
+
+  interpreter->components_of_members =
+    (scc_uint32_t *)heap->allocate(heap, (module->num_of_members + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t structure = 0; structure < module->num_of_structures; ++structure) {
+    const scc_uint32_t first = module->structures[structure].first_member;
+
+    scc_uint32_t preceding = 0;
+
+    for (scc_uint32_t member = 0; member < module->structures[structure].num_of_members; ++member) {
+      interpreter->components_of_members[first + member] = preceding;
+      preceding += scc_ir_type_num_of_components(module->members[first + member].type);
+    }
+  }
+
+  return interpreter;
+}
+
+void scc_ir_interpreter_destroy(scc_ir_interpreter_t *interpreter) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_ir_module_t *module = interpreter->module;
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function) {
+    scc_ir_interpreter_function_t *prepared = &interpreter->functions[function];
+
+    if (prepared->bytecode)
+      scc_ir_bytecode_destroy(prepared->bytecode);
+    if (prepared->jit)
+      scc_ir_jit_destroy(prepared->jit);
+  }
+
+  heap->free(heap, (void *)interpreter->functions);
+  heap->free(heap, (void *)interpreter->components_of_members);
+  heap->free(heap, (void *)interpreter);
+}
+
+scc_bool_t scc_ir_interpreter_compile(scc_ir_interpreter_t *interpreter,
+                                      scc_uint32_t features) {
+  if (!scc_ir_jit_is_available())
+    return SCC_FALSE;
+
+  const scc_ir_module_t *module = interpreter->module;
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function) {
+    scc_ir_interpreter_function_t *prepared = &interpreter->functions[function];
+
+    if (prepared->supported && !prepared->jit)
+      prepared->jit = scc_ir_jit_compile(prepared->bytecode, features);
+  }
+
+  return SCC_TRUE;
+}
+
+scc_bool_t scc_ir_interpreter_supports(const scc_ir_interpreter_t *interpreter,
+                                       scc_uint32_t function) {
+  if (function >= interpreter->module->num_of_functions)
+    return SCC_FALSE;
+  if (interpreter->module->functions[function]->removed)
+    return SCC_FALSE;
+  return interpreter->functions[function].supported;
+}
+
+//===----------------------------------------------------------------------===//
+// Values
+//===----------------------------------------------------------------------===//
+
+static scc_uint32_t scc_ir_interpreter_width(const scc_ir_function_t *function,
+                                             scc_ir_value_t value) {
+  return scc_ir_type_num_of_components(scc_ir_value_type(function, value));
+}
+
+static const scc_ir_word_t *scc_ir_interpreter_value(const scc_ir_frame_t *frame,
+                                                     scc_ir_value_t value) {
+  return &frame->words[scc_ir_bytecode_slot(frame->bytecode, value)];
+}
+
+// Copies `n` components to `destination` for lanes in `mask`.
+static void scc_ir_interpreter_assign(scc_ir_word_t *destination,
+                                      const scc_ir_word_t *source,
+                                      scc_uint32_t n,
+                                      scc_uint32_t mask) {
+  if (mask == SCC_IR_ALL_LANES) {
+    memcpy(destination, source, n * SCC_IR_LANES * sizeof(scc_ir_word_t));
+    return;
+  }
+
+  for (scc_uint32_t k = 0; k < n; ++k)
+    for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+      if (mask & (1u << lane))
+        destination[k * SCC_IR_LANES + lane] = source[k * SCC_IR_LANES + lane];
+}
+
+// Returns the lanes in `mask` for which `condition` is true, be it a float
+// if `real`, or otherwise an integer.
+static scc_uint32_t scc_ir_interpreter_truth(const scc_ir_word_t *condition,
+                                             scc_bool_t real,
+                                             scc_uint32_t mask) {
+  scc_uint32_t truth = 0;
+
+  for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+    if (real ? (condition[lane].f != 0.0f) : (condition[lane].u != 0))
+      truth |= (1u << lane);
+
+  return truth & mask;
+}
+
+// Wraps components to the width of smaller integers.
+static void scc_ir_interpreter_normalize(scc_ir_word_t *result,
+                                         scc_ir_type_t type) {
+  const scc_uint32_t n = scc_ir_type_num_of_components(type) * SCC_IR_LANES;
+
+  switch (type.scalar) {
+    case SCC_IR_BOOL: for (scc_uint32_t w = 0; w < n; ++w) result[w].u = (result[w].u != 0); break;
+    case SCC_IR_I8:   for (scc_uint32_t w = 0; w < n; ++w) result[w].i = (scc_int8_t)result[w].i; break;
+    case SCC_IR_I16:  for (scc_uint32_t w = 0; w < n; ++w) result[w].i = (scc_int16_t)result[w].i; break;
+    case SCC_IR_U8:   for (scc_uint32_t w = 0; w < n; ++w) result[w].u = (scc_uint8_t)result[w].u; break;
+    case SCC_IR_U16:  for (scc_uint32_t w = 0; w < n; ++w) result[w].u = (scc_uint16_t)result[w].u; break;
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Arithmetic
+//===----------------------------------------------------------------------===//
+
+// Applies `Expression` to every lane of component `k`, where `x`, `y`, and
+// `z` are the inputs in that lane and `r` the result.
+#define SCC_IR_EACH_LANE(Expression)                                  \
+  for (scc_uint32_t l = 0; l < SCC_IR_LANES; ++l) {                   \
+    const scc_ir_word_t x = a[l], y = b[l], z = c[l];                 \
+    scc_ir_word_t *r = &result[k * SCC_IR_LANES + l];                 \
+    (void)x; (void)y; (void)z;                                        \
+    Expression;                                                       \
+  }
+
+static void scc_ir_interpreter_float(scc_uint32_t op,
+                                     scc_uint32_t n,
+                                     const scc_ir_word_t * const *inputs,
+                                     const scc_uint32_t *strides,
+                                     scc_ir_word_t *result) {
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    const scc_ir_word_t *a = inputs[0] + k * strides[0];
+    const scc_ir_word_t *b = inputs[1] + k * strides[1];
+    const scc_ir_word_t *c = inputs[2] + k * strides[2];
+
+    switch (op) {
+      case SCC_IR_OPERATION_ADD: SCC_IR_EACH_LANE(r->f = x.f + y.f); break;
+      case SCC_IR_OPERATION_SUB: SCC_IR_EACH_LANE(r->f = x.f - y.f); break;
+      case SCC_IR_OPERATION_MULTIPLY: SCC_IR_EACH_LANE(r->f = x.f * y.f); break;
+      case SCC_IR_OPERATION_DIVIDE: SCC_IR_EACH_LANE(r->f = x.f / y.f); break;
+      case SCC_IR_OPERATION_FMA: SCC_IR_EACH_LANE(r->f = fmaf(x.f, y.f, z.f)); break;
+
+      case SCC_IR_OPERATION_SQRT: SCC_IR_EACH_LANE(r->f = sqrtf(x.f)); break;
+      case SCC_IR_OPERATION_RSQRT: SCC_IR_EACH_LANE(r->f = 1.0f / sqrtf(x.f)); break;
+
+      case SCC_IR_OPERATION_SIN: SCC_IR_EACH_LANE(r->f = sinf(x.f)); break;
+      case SCC_IR_OPERATION_COS: SCC_IR_EACH_LANE(r->f = cosf(x.f)); break;
+      case SCC_IR_OPERATION_TAN: SCC_IR_EACH_LANE(r->f = tanf(x.f)); break;
+      case SCC_IR_OPERATION_SINH: SCC_IR_EACH_LANE(r->f = sinhf(x.f)); break;
+      case SCC_IR_OPERATION_COSH: SCC_IR_EACH_LANE(r->f = coshf(x.f)); break;
+      case SCC_IR_OPERATION_TANH: SCC_IR_EACH_LANE(r->f = tanhf(x.f)); break;
+      case SCC_IR_OPERATION_ASIN: SCC_IR_EACH_LANE(r->f = asinf(x.f)); break;
+      case SCC_IR_OPERATION_ACOS: SCC_IR_EACH_LANE(r->f = acosf(x.f)); break;
+      case SCC_IR_OPERATION_ATAN: SCC_IR_EACH_LANE(r->f = atanf(x.f)); break;
+      case SCC_IR_OPERATION_ATAN2: SCC_IR_EACH_LANE(r->f = atan2f(x.f, y.f)); break;
+
+      case SCC_IR_OPERATION_POW: SCC_IR_EACH_LANE(r->f = powf(x.f, y.f)); break;
+      case SCC_IR_OPERATION_EXP: SCC_IR_EACH_LANE(r->f = expf(x.f)); break;
+      case SCC_IR_OPERATION_EXP2: SCC_IR_EACH_LANE(r->f = exp2f(x.f)); break;
+      case SCC_IR_OPERATION_EXP10: SCC_IR_EACH_LANE(r->f = powf(10.0f, x.f)); break;
+      case SCC_IR_OPERATION_LOG: SCC_IR_EACH_LANE(r->f = logf(y.f) / logf(x.f)); break;
+      case SCC_IR_OPERATION_LOG2: SCC_IR_EACH_LANE(r->f = log2f(x.f)); break;
+      case SCC_IR_OPERATION_LOG10: SCC_IR_EACH_LANE(r->f = log10f(x.f)); break;
+
+      case SCC_IR_OPERATION_ABS: SCC_IR_EACH_LANE(r->f = fabsf(x.f)); break;
+      case SCC_IR_OPERATION_FLOOR: SCC_IR_EACH_LANE(r->f = floorf(x.f)); break;
+      case SCC_IR_OPERATION_CEIL: SCC_IR_EACH_LANE(r->f = ceilf(x.f)); break;
+      case SCC_IR_OPERATION_MIN: SCC_IR_EACH_LANE(r->f = fminf(x.f, y.f)); break;
+      case SCC_IR_OPERATION_MAX: SCC_IR_EACH_LANE(r->f = fmaxf(x.f, y.f)); break;
+      case SCC_IR_OPERATION_CLAMP: SCC_IR_EACH_LANE(r->f = fminf(fmaxf(x.f, y.f), z.f)); break;
+      case SCC_IR_OPERATION_SATURATE: SCC_IR_EACH_LANE(r->f = fminf(fmaxf(x.f, 0.0f), 1.0f)); break;
+    }
+  }
+}
+
+// Arithmetic is done on unsigned integers so that overflow wraps, and
+// division by zero yields zero rather than trapping.
+static void scc_ir_interpreter_signed(scc_uint32_t op,
+                                      scc_uint32_t n,
+                                      const scc_ir_word_t * const *inputs,
+                                      const scc_uint32_t *strides,
+                                      scc_ir_word_t *result) {
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    const scc_ir_word_t *a = inputs[0] + k * strides[0];
+    const scc_ir_word_t *b = inputs[1] + k * strides[1];
+    const scc_ir_word_t *c = inputs[2] + k * strides[2];
+
+    switch (op) {
+      case SCC_IR_OPERATION_ADD: SCC_IR_EACH_LANE(r->u = x.u + y.u); break;
+      case SCC_IR_OPERATION_SUB: SCC_IR_EACH_LANE(r->u = x.u - y.u); break;
+      case SCC_IR_OPERATION_MULTIPLY: SCC_IR_EACH_LANE(r->u = x.u * y.u); break;
+      case SCC_IR_OPERATION_FMA: SCC_IR_EACH_LANE(r->u = x.u * y.u + z.u); break;
+
+      case SCC_IR_OPERATION_DIVIDE:
+        SCC_IR_EACH_LANE(r->i = (y.i == 0) ? 0 : ((y.i == -1) ? (scc_int32_t)(0u - x.u) : (x.i / y.i)));
+        break;
+
+      case SCC_IR_OPERATION_ABS: SCC_IR_EACH_LANE(r->u = (x.i < 0) ? (0u - x.u) : x.u); break;
+      case SCC_IR_OPERATION_FLOOR: SCC_IR_EACH_LANE(*r = x); break;
+      case SCC_IR_OPERATION_CEIL: SCC_IR_EACH_LANE(*r = x); break;
+      case SCC_IR_OPERATION_MIN: SCC_IR_EACH_LANE(r->i = SCC_MIN(x.i, y.i)); break;
+      case SCC_IR_OPERATION_MAX: SCC_IR_EACH_LANE(r->i = SCC_MAX(x.i, y.i)); break;
+      case SCC_IR_OPERATION_CLAMP: SCC_IR_EACH_LANE(r->i = SCC_MIN(SCC_MAX(x.i, y.i), z.i)); break;
+      case SCC_IR_OPERATION_SATURATE: SCC_IR_EACH_LANE(r->i = SCC_MIN(SCC_MAX(x.i, 0), 1)); break;
+    }
+  }
+}
+
+static void scc_ir_interpreter_unsigned(scc_uint32_t op,
+                                        scc_uint32_t n,
+                                        const scc_ir_word_t * const *inputs,
+                                        const scc_uint32_t *strides,
+                                        scc_ir_word_t *result) {
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    const scc_ir_word_t *a = inputs[0] + k * strides[0];
+    const scc_ir_word_t *b = inputs[1] + k * strides[1];
+    const scc_ir_word_t *c = inputs[2] + k * strides[2];
+
+    switch (op) {
+      case SCC_IR_OPERATION_ADD: SCC_IR_EACH_LANE(r->u = x.u + y.u); break;
+      case SCC_IR_OPERATION_SUB: SCC_IR_EACH_LANE(r->u = x.u - y.u); break;
+      case SCC_IR_OPERATION_MULTIPLY: SCC_IR_EACH_LANE(r->u = x.u * y.u); break;
+      case SCC_IR_OPERATION_DIVIDE: SCC_IR_EACH_LANE(r->u = (y.u == 0) ? 0 : (x.u / y.u)); break;
+      case SCC_IR_OPERATION_FMA: SCC_IR_EACH_LANE(r->u = x.u * y.u + z.u); break;
+
+      case SCC_IR_OPERATION_ABS: SCC_IR_EACH_LANE(*r = x); break;
+      case SCC_IR_OPERATION_FLOOR: SCC_IR_EACH_LANE(*r = x); break;
+      case SCC_IR_OPERATION_CEIL: SCC_IR_EACH_LANE(*r = x); break;
+      case SCC_IR_OPERATION_MIN: SCC_IR_EACH_LANE(r->u = SCC_MIN(x.u, y.u)); break;
+      case SCC_IR_OPERATION_MAX: SCC_IR_EACH_LANE(r->u = SCC_MAX(x.u, y.u)); break;
+      case SCC_IR_OPERATION_CLAMP: SCC_IR_EACH_LANE(r->u = SCC_MIN(SCC_MAX(x.u, y.u), z.u)); break;
+      case SCC_IR_OPERATION_SATURATE: SCC_IR_EACH_LANE(r->u = SCC_MIN(x.u, 1u)); break;
+    }
+  }
+}
+
+// Comparisons involving NaN are false, except for `neq`.
+#define SCC_IR_INTERPRETER_COMPARE(Op, A, B)                     \
+  (((Op) == SCC_IR_OPERATION_LESS) ? ((A) < (B)) :               \
+   ((Op) == SCC_IR_OPERATION_LESS_OR_EQUAL) ? ((A) <= (B)) :     \
+   ((Op) == SCC_IR_OPERATION_EQUAL) ? ((A) == (B)) :             \
+   ((Op) == SCC_IR_OPERATION_NOT_EQUAL) ? ((A) != (B)) :         \
+   ((Op) == SCC_IR_OPERATION_GREATER) ? ((A) > (B)) :            \
+                                        ((A) >= (B)))
+
+static void scc_ir_interpreter_compare(scc_uint32_t op,
+                                       scc_ir_interpreter_domain_t domain,
+                                       scc_uint32_t n,
+                                       const scc_ir_word_t * const *inputs,
+                                       const scc_uint32_t *strides,
+                                       scc_ir_type_t type,
+                                       scc_ir_word_t *result) {
+  // Truth is one, in whatever type is expected.
+  scc_ir_word_t one;
+
+  if (scc_ir_interpreter_domain_of(type) == SCC_IR_INTERPRETER_FLOAT)
+    one.f = 1.0f;
+  else
+    one.u = 1;
+
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    const scc_ir_word_t *a = inputs[0] + k * strides[0];
+    const scc_ir_word_t *b = inputs[1] + k * strides[1];
+    const scc_ir_word_t *c = inputs[2] + k * strides[2];
+
+    switch (domain) {
+      case SCC_IR_INTERPRETER_FLOAT:
+        SCC_IR_EACH_LANE(r->u = SCC_IR_INTERPRETER_COMPARE(op, x.f, y.f) ? one.u : 0);
+        break;
+      case SCC_IR_INTERPRETER_SIGNED:
+        SCC_IR_EACH_LANE(r->u = SCC_IR_INTERPRETER_COMPARE(op, x.i, y.i) ? one.u : 0);
+        break;
+      default:
+        SCC_IR_EACH_LANE(r->u = SCC_IR_INTERPRETER_COMPARE(op, x.u, y.u) ? one.u : 0);
+        break;
+    }
+  }
+}
+
+#undef SCC_IR_EACH_LANE
+
+static void scc_ir_interpreter_component_wise(const scc_ir_frame_t *frame,
+                                              const scc_ir_instruction_t *instruction,
+                                              scc_ir_word_t *result) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_uint32_t n = scc_ir_type_num_of_components(instruction->type);
+
+  // Missing inputs read zeros, and scalars are broadcast.
+  const scc_ir_word_t *inputs[3] = { frame->words, frame->words, frame->words };
+  scc_uint32_t strides[3] = { 0, 0, 0 };
+
+  for (scc_uint32_t operand = 0; operand < SCC_MIN(instruction->num_of_operands, 3); ++operand) {
+    inputs[operand] = scc_ir_interpreter_value(frame, operands[operand]);
+    strides[operand] = (scc_ir_interpreter_width(function, operands[operand]) == 1) ? 0 : SCC_IR_LANES;
+  }
+
+  const scc_ir_interpreter_domain_t domain =
+    scc_ir_interpreter_domain_of(scc_ir_value_type(function, operands[0]));
+
+  if ((instruction->op >= SCC_IR_OPERATION_LESS) && (instruction->op <= SCC_IR_OPERATION_GREATER_OR_EQUAL))
+    return scc_ir_interpreter_compare(instruction->op, domain, n, inputs, strides, instruction->type, result);
+
+  switch (domain) {
+    case SCC_IR_INTERPRETER_FLOAT:
+      scc_ir_interpreter_float(instruction->op, n, inputs, strides, result);
+      break;
+    case SCC_IR_INTERPRETER_SIGNED:
+      scc_ir_interpreter_signed(instruction->op, n, inputs, strides, result);
+      break;
+    default:
+      scc_ir_interpreter_unsigned(instruction->op, n, inputs, strides, result);
+      break;
+  }
+
+  scc_ir_interpreter_normalize(result, instruction->type);
+}
+
+//===----------------------------------------------------------------------===//
+// Vectors and Matrices
+//===----------------------------------------------------------------------===//
+
+// Sums products of `n` components of `a` and `b` in every lane.
+static void scc_ir_interpreter_dot(const scc_ir_word_t *a,
+                                   const scc_ir_word_t *b,
+                                   scc_uint32_t n,
+                                   scc_float32_t *sums) {
+  for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+    sums[lane] = 0.0f;
+
+  for (scc_uint32_t k = 0; k < n; ++k)
+    for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+      sums[lane] += a[k * SCC_IR_LANES + lane].f * b[k * SCC_IR_LANES + lane].f;
+}
+
+static void scc_ir_interpreter_geometric(const scc_ir_frame_t *frame,
+                                         const scc_ir_instruction_t *instruction,
+                                         scc_ir_word_t *result) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_ir_word_t *a = scc_ir_interpreter_value(frame, operands[0]);
+  const scc_ir_word_t *b = (instruction->num_of_operands > 1) ? scc_ir_interpreter_value(frame, operands[1]) : a;
+
+  const scc_uint32_t n = scc_ir_interpreter_width(function, operands[0]);
+
+  scc_float32_t d[SCC_IR_LANES];
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_DOT:
+      scc_ir_interpreter_dot(a, b, n, d);
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        result[lane].f = d[lane];
+      return;
+
+    case SCC_IR_OPERATION_MAGNITUDE:
+    case SCC_IR_OPERATION_LENGTH:
+      scc_ir_interpreter_dot(a, a, n, d);
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        result[lane].f = sqrtf(d[lane]);
+      return;
+
+    case SCC_IR_OPERATION_LENGTH_SQUARED:
+      scc_ir_interpreter_dot(a, a, n, d);
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        result[lane].f = d[lane];
+      return;
+
+    case SCC_IR_OPERATION_DISTANCE: {
+      scc_ir_word_t difference[16 * SCC_IR_LANES];
+      for (scc_uint32_t w = 0; w < n * SCC_IR_LANES; ++w)
+        difference[w].f = a[w].f - b[w].f;
+      scc_ir_interpreter_dot(difference, difference, n, d);
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        result[lane].f = sqrtf(d[lane]);
+    } return;
+
+    case SCC_IR_OPERATION_NORMALIZE:
+      scc_ir_interpreter_dot(a, a, n, d);
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        d[lane] = 1.0f / sqrtf(d[lane]);
+      for (scc_uint32_t k = 0; k < n; ++k)
+        for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+          result[k * SCC_IR_LANES + lane].f = a[k * SCC_IR_LANES + lane].f * d[lane];
+      return;
+
+    case SCC_IR_OPERATION_CROSS:
+      for (scc_uint32_t k = 0; k < 3; ++k) {
+        const scc_uint32_t u = ((k + 1) % 3) * SCC_IR_LANES, v = ((k + 2) % 3) * SCC_IR_LANES;
+        for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+          result[k * SCC_IR_LANES + lane].f = a[u + lane].f * b[v + lane].f - a[v + lane].f * b[u + lane].f;
+      }
+      return;
+
+    case SCC_IR_OPERATION_REFLECT:
+      // I - 2 * dot(N, I) * N
+      scc_ir_interpreter_dot(a, b, n, d);
+      for (scc_uint32_t k = 0; k < n; ++k)
+        for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+          result[k * SCC_IR_LANES + lane].f =
+            a[k * SCC_IR_LANES + lane].f - 2.0f * d[lane] * b[k * SCC_IR_LANES + lane].f;
+      return;
+
+    case SCC_IR_OPERATION_REFRACT: {
+      const scc_ir_word_t *eta = scc_ir_interpreter_value(frame, operands[2]);
+      scc_ir_interpreter_dot(a, b, n, d);
+      // Total internal reflection yields a zero vector.
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane) {
+        const scc_float32_t e = eta[lane].f;
+        const scc_float32_t k = 1.0f - e * e * (1.0f - d[lane] * d[lane]);
+        for (scc_uint32_t component = 0; component < n; ++component)
+          result[component * SCC_IR_LANES + lane].f =
+            (k < 0.0f) ? 0.0f : (e * a[component * SCC_IR_LANES + lane].f
+                                  - (e * d[lane] + sqrtf(k)) * b[component * SCC_IR_LANES + lane].f);
+      }
+    } return;
+  }
+}
+
+// Multiplies matrices, or a matrix and a vector. A vector on the left is
+// treated as a row vector.
+static void scc_ir_interpreter_product(const scc_ir_frame_t *frame,
+                                       const scc_ir_instruction_t *instruction,
+                                       scc_ir_word_t *result) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_ir_type_t left = scc_ir_value_type(function, operands[0]);
+  const scc_ir_type_t right = scc_ir_value_type(function, operands[1]);
+
+  const scc_ir_word_t *a = scc_ir_interpreter_value(frame, operands[0]);
+  const scc_ir_word_t *b = scc_ir_interpreter_value(frame, operands[1]);
+
+  const scc_bool_t row = scc_ir_type_is_vector(left);
+
+  const scc_uint32_t m = row ? 1 : left.rows;
+  const scc_uint32_t inner = row ? left.rows : left.columns;
+  const scc_uint32_t p = right.columns;
+
+  for (scc_uint32_t column = 0; column < p; ++column) {
+    for (scc_uint32_t r = 0; r < m; ++r) {
+      scc_ir_word_t *sums = &result[(column * m + r) * SCC_IR_LANES];
+
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        sums[lane].f = 0.0f;
+
+      for (scc_uint32_t k = 0; k < inner; ++k) {
+        const scc_ir_word_t *x = &a[(k * m + r) * SCC_IR_LANES];
+        const scc_ir_word_t *y = &b[(column * inner + k) * SCC_IR_LANES];
+
+        for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+          sums[lane].f += x[lane].f * y[lane].f;
+      }
+    }
+  }
+}
+
+// Reduces `matrix` by Gauss-Jordan elimination with partial pivoting,
+// applying the same row operations to `inverse`. Returns the determinant.
+static scc_float32_t scc_ir_interpreter_eliminate(scc_float32_t matrix[4][4],
+                                                  scc_float32_t inverse[4][4],
+                                                  scc_uint32_t n) {
+  scc_float32_t determinant = 1.0f;
+
+  for (scc_uint32_t column = 0; column < n; ++column) {
+    scc_uint32_t pivot = column;
+
+    for (scc_uint32_t r = column + 1; r < n; ++r)
+      if (fabsf(matrix[r][column]) > fabsf(matrix[pivot][column]))
+        pivot = r;
+
+    if (matrix[pivot][column] == 0.0f)
+      return 0.0f;
+
+    if (pivot != column) {
+      for (scc_uint32_t c = 0; c < n; ++c) {
+        scc_float32_t t = matrix[column][c]; matrix[column][c] = matrix[pivot][c]; matrix[pivot][c] = t;
+        t = inverse[column][c]; inverse[column][c] = inverse[pivot][c]; inverse[pivot][c] = t;
+      }
+
+      determinant = -determinant;
+    }
+
+    const scc_float32_t scale = matrix[column][column];
+
+    determinant *= scale;
+
+    for (scc_uint32_t c = 0; c < n; ++c) {
+      matrix[column][c] /= scale;
+      inverse[column][c] /= scale;
+    }
+
+    for (scc_uint32_t r = 0; r < n; ++r) {
+      if (r == column)
+        continue;
+
+      const scc_float32_t factor = matrix[r][column];
+
+      for (scc_uint32_t c = 0; c < n; ++c) {
+        matrix[r][c] -= factor * matrix[column][c];
+        inverse[r][c] -= factor * inverse[column][c];
+      }
+    }
+  }
+
+  return determinant;
+}
+
+static void scc_ir_interpreter_matrix(const scc_ir_frame_t *frame,
+                                      const scc_ir_instruction_t *instruction,
+                                      scc_ir_word_t *result) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_value_t input = scc_ir_operand(function, instruction, 0);
+  const scc_ir_type_t type = scc_ir_value_type(function, input);
+
+  const scc_ir_word_t *a = scc_ir_interpreter_value(frame, input);
+
+  const scc_uint32_t rows = type.rows, columns = type.columns;
+
+  if (instruction->op == SCC_IR_OPERATION_TRANSPOSE) {
+    for (scc_uint32_t r = 0; r < rows; ++r)
+      for (scc_uint32_t c = 0; c < columns; ++c)
+        memcpy(&result[(r * columns + c) * SCC_IR_LANES],
+               &a[(c * rows + r) * SCC_IR_LANES],
+               SCC_IR_LANES * sizeof(scc_ir_word_t));
+    return;
+  }
+
+  // Anything but square matrices of up to four columns yields zero.
+  if ((rows != columns) || (rows > 4)) {
+    memset(result, 0, scc_ir_type_num_of_components(instruction->type) * SCC_IR_LANES * sizeof(scc_ir_word_t));
+    return;
+  }
+
+  const scc_uint32_t n = rows;
+
+  for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane) {
+    scc_float32_t matrix[4][4], inverse[4][4];
+
+    for (scc_uint32_t r = 0; r < n; ++r) {
+      for (scc_uint32_t c = 0; c < n; ++c) {
+        matrix[r][c] = a[(c * n + r) * SCC_IR_LANES + lane].f;
+        inverse[r][c] = (r == c) ? 1.0f : 0.0f;
+      }
+    }
+
+    const scc_float32_t determinant = scc_ir_interpreter_eliminate(matrix, inverse, n);
+
+    if (instruction->op == SCC_IR_OPERATION_DETERMINANT) {
+      result[lane].f = determinant;
+      continue;
+    }
+
+    // Singular matrices have no inverse, so yield zero.
+    for (scc_uint32_t r = 0; r < n; ++r)
+      for (scc_uint32_t c = 0; c < n; ++c)
+        result[(c * n + r) * SCC_IR_LANES + lane].f = (determinant == 0.0f) ? 0.0f : inverse[r][c];
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Memory
+//===----------------------------------------------------------------------===//
+
+// Finds where `instruction`, a load or store, refers to. Returns the global,
+// and sets `first` to the first component referred to, counting from the
+// start of the global, and `offset` to its offset in bytes when constant.
+static scc_uint32_t scc_ir_interpreter_locate(const scc_ir_execution_t *execution,
+                                              const scc_ir_function_t *function,
+                                              const scc_ir_instruction_t *instruction,
+                                              scc_uint32_t *first,
+                                              scc_uint32_t *offset) {
+  const scc_ir_module_t *module = function->module;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_uint32_t index = SCC_IR_VALUE_INDEX(operands[0]);
+  const scc_ir_global_t *global = &module->globals[index];
+
+  if (global->type.scalar != SCC_IR_STRUCTURE) {
+    *first = 0;
+    *offset = global->offset;
+    return index;
+  }
+
+  const scc_uint32_t member = module->structures[global->type.structure].first_member
+                            + SCC_IR_VALUE_INDEX(operands[1]);
+
+  *first = execution->interpreter->components_of_members[member];
+  *offset = module->members[member].offset;
+
+  return index;
+}
+
+static void scc_ir_interpreter_load(const scc_ir_execution_t *execution,
+                                    const scc_ir_frame_t *frame,
+                                    const scc_ir_instruction_t *instruction,
+                                    scc_ir_word_t *result) {
+  const scc_ir_module_t *module = frame->function->module;
+
+  scc_uint32_t first, offset;
+  const scc_uint32_t global = scc_ir_interpreter_locate(execution, frame->function, instruction, &first, &offset);
+
+  const scc_uint32_t n = scc_ir_type_num_of_components(instruction->type);
+
+  const void *data = execution->bindings->globals[global];
+
+  memset(result, 0, n * SCC_IR_LANES * sizeof(scc_ir_word_t));
+
+  if (!data)
+    return;
+
+  if (module->globals[global].storage == SCC_IR_CONSTANT) {
+    // Constants are the same for every lane.
+    for (scc_uint32_t k = 0; k < n; ++k) {
+      scc_ir_word_t word;
+      memcpy(&word, (const scc_uint8_t *)data + offset + k * sizeof(scc_ir_word_t), sizeof(word));
+
+      for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+        result[k * SCC_IR_LANES + lane] = word;
+    }
+
+    return;
+  }
+
+  const scc_uint32_t lanes = SCC_MIN(SCC_IR_LANES, execution->count - execution->base);
+
+  for (scc_uint32_t k = 0; k < n; ++k)
+    memcpy(&result[k * SCC_IR_LANES],
+           (const scc_ir_word_t *)data + (first + k) * execution->count + execution->base,
+           lanes * sizeof(scc_ir_word_t));
+}
+
+static void scc_ir_interpreter_store(const scc_ir_execution_t *execution,
+                                     const scc_ir_frame_t *frame,
+                                     const scc_ir_instruction_t *instruction,
+                                     scc_uint32_t mask) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_module_t *module = function->module;
+
+  scc_uint32_t first, offset;
+  const scc_uint32_t global = scc_ir_interpreter_locate(execution, function, instruction, &first, &offset);
+
+  const scc_ir_value_t stored = scc_ir_operand(function, instruction, 1);
+  const scc_ir_word_t *value = scc_ir_interpreter_value(frame, stored);
+
+  const scc_uint32_t n = scc_ir_interpreter_width(function, stored);
+
+  void *data = execution->bindings->globals[global];
+
+  if (!data)
+    return;
+
+  if (module->globals[global].storage == SCC_IR_CONSTANT) {
+    // Any lane will do, as constants are meant to be the same for all.
+    scc_uint32_t lane = 0;
+    while (!(mask & (1u << lane)))
+      lane += 1;
+
+    for (scc_uint32_t k = 0; k < n; ++k)
+      memcpy((scc_uint8_t *)data + offset + k * sizeof(scc_ir_word_t), &value[k * SCC_IR_LANES + lane], sizeof(scc_ir_word_t));
+
+    return;
+  }
+
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    scc_ir_word_t *words = (scc_ir_word_t *)data + (first + k) * execution->count + execution->base;
+
+    for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane)
+      if (mask & (1u << lane))
+        words[lane] = value[k * SCC_IR_LANES + lane];
+  }
+}
+
+static void scc_ir_interpreter_sample(const scc_ir_execution_t *execution,
+                                      const scc_ir_frame_t *frame,
+                                      const scc_ir_instruction_t *instruction,
+                                      scc_uint32_t mask,
+                                      scc_ir_word_t *result) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  const scc_ir_bindings_t *bindings = execution->bindings;
+
+  scc_ir_word_t texels[4 * SCC_IR_LANES];
+
+  memset(texels, 0, sizeof(texels));
+
+  if (bindings->sample) {
+    const scc_ir_global_t *texture = &function->module->globals[SCC_IR_VALUE_INDEX(operands[0])];
+
+    // Components to gather are expected to be constant.
+    scc_uint32_t component = SCC_IR_NONE;
+
+    if (instruction->op == SCC_IR_OPERATION_GATHER)
+      component = (SCC_IR_VALUE_KIND(operands[2]) == SCC_IR_VALUE_IMMEDIATE)
+                ? SCC_IR_VALUE_INDEX(operands[2])
+                : scc_ir_interpreter_value(frame, operands[2])[0].u;
+
+    bindings->sample(bindings->user,
+                     texture->binding,
+                     component,
+                     scc_ir_interpreter_value(frame, operands[1]),
+                     scc_ir_interpreter_width(function, operands[1]),
+                     mask,
+                     texels);
+  }
+
+  memcpy(result, texels, instruction->type.rows * SCC_IR_LANES * sizeof(scc_ir_word_t));
+}
+
+//===----------------------------------------------------------------------===//
+// Control Flow
+//===----------------------------------------------------------------------===//
+
+static void scc_ir_interpreter_execute(scc_ir_execution_t *execution,
+                                       scc_ir_frame_t *frame,
+                                       scc_uint32_t mask);
+
+// Allocates a frame for `function` from `allocator`, starting with the image
+// of its constants.
+static void scc_ir_interpreter_frame(scc_ir_frame_t *frame,
+                                     const scc_ir_interpreter_t *interpreter,
+                                     scc_uint32_t function,
+                                     scc_allocator_t *allocator) {
+  frame->function = interpreter->module->functions[function];
+  frame->bytecode = interpreter->functions[function].bytecode;
+
+  frame->words =
+    (scc_ir_word_t *)allocator->allocate(allocator, frame->bytecode->size_of_frame * sizeof(scc_ir_word_t), 64);
+  frame->pending =
+    (scc_uint32_t *)allocator->allocate(allocator, (frame->function->num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+
+  memcpy(frame->words, frame->bytecode->image, frame->bytecode->size_of_image * sizeof(scc_ir_word_t));
+}
+
+// Sends lanes in `mask` along `edge`, copying incoming values to the phis of
+// the block entered. Returns whatever follows the edge.
+static const scc_uint32_t *scc_ir_interpreter_enter(scc_ir_frame_t *frame,
+                                                    const scc_uint32_t *edge,
+                                                    scc_uint32_t mask) {
+  const scc_uint32_t copies = edge[1];
+  const scc_uint32_t *end = &edge[2 + 3 * copies];
+
+  if (mask == 0)
+    return end;
+
+  frame->pending[edge[0]] |= mask;
+
+  scc_ir_word_t *words = frame->words;
+
+  if (copies == 1) {
+    scc_ir_interpreter_assign(&words[edge[2]], &words[edge[3]], edge[4], mask);
+    return end;
+  }
+
+  // Staged, in case one `phi` refers to another.
+  scc_ir_word_t *staged = &words[frame->bytecode->incoming];
+
+  scc_uint32_t used = 0;
+
+  for (const scc_uint32_t *copy = &edge[2]; copy != end; copy += 3) {
+    memcpy(&staged[used], &words[copy[1]], copy[2] * SCC_IR_LANES * sizeof(scc_ir_word_t));
+    used += copy[2] * SCC_IR_LANES;
+  }
+
+  used = 0;
+
+  for (const scc_uint32_t *copy = &edge[2]; copy != end; copy += 3) {
+    scc_ir_interpreter_assign(&words[copy[0]], &staged[used], copy[2], mask);
+    used += copy[2] * SCC_IR_LANES;
+  }
+
+  return end;
+}
+
+static void scc_ir_interpreter_call(scc_ir_execution_t *execution,
+                                    const scc_ir_frame_t *frame,
+                                    const scc_ir_instruction_t *instruction,
+                                    scc_uint32_t mask,
+                                    scc_ir_word_t *result) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  scc_ir_frame_t callee;
+
+  scc_ir_interpreter_frame(&callee,
+                           execution->interpreter,
+                           SCC_IR_VALUE_INDEX(operands[0]),
+                           execution->scratch);
+
+  for (scc_uint32_t argument = 0; argument < callee.function->num_of_arguments; ++argument) {
+    const scc_uint32_t n = scc_ir_type_num_of_components(callee.function->arguments[argument].type);
+
+    if (argument + 1 < instruction->num_of_operands)
+      memcpy(&callee.words[callee.bytecode->arguments[argument]],
+             scc_ir_interpreter_value(frame, operands[argument + 1]),
+             n * SCC_IR_LANES * sizeof(scc_ir_word_t));
+  }
+
+  scc_ir_interpreter_execute(execution, &callee, mask);
+
+  memcpy(result,
+         &callee.words[callee.bytecode->returned],
+         scc_ir_type_num_of_components(instruction->type) * SCC_IR_LANES * sizeof(scc_ir_word_t));
+}
+
+// Evaluates an instruction lowered to `generic`, for lanes in `mask`. Returns
+// the lanes that carry on.
+static scc_uint32_t scc_ir_interpreter_evaluate(scc_ir_execution_t *execution,
+                                                scc_ir_frame_t *frame,
+                                                scc_uint32_t index,
+                                                scc_uint32_t mask) {
+  const scc_ir_function_t *function = frame->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[index];
+
+  // Large enough for any value.
+  scc_ir_word_t result[16 * SCC_IR_LANES];
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_LOAD:
+      scc_ir_interpreter_load(execution, frame, instruction, result);
+      break;
+
+    case SCC_IR_OPERATION_STORE:
+      scc_ir_interpreter_store(execution, frame, instruction, mask);
+      return mask;
+
+    case SCC_IR_OPERATION_FETCH:
+    case SCC_IR_OPERATION_GATHER:
+      scc_ir_interpreter_sample(execution, frame, instruction, mask, result);
+      break;
+
+    case SCC_IR_OPERATION_MAGNITUDE:
+    case SCC_IR_OPERATION_LENGTH:
+    case SCC_IR_OPERATION_LENGTH_SQUARED:
+    case SCC_IR_OPERATION_DOT:
+    case SCC_IR_OPERATION_CROSS:
+    case SCC_IR_OPERATION_NORMALIZE:
+    case SCC_IR_OPERATION_DISTANCE:
+    case SCC_IR_OPERATION_REFLECT:
+    case SCC_IR_OPERATION_REFRACT:
+      scc_ir_interpreter_geometric(frame, instruction, result);
+      break;
+
+    case SCC_IR_OPERATION_TRANSPOSE:
+    case SCC_IR_OPERATION_INVERSE:
+    case SCC_IR_OPERATION_DETERMINANT:
+      scc_ir_interpreter_matrix(frame, instruction, result);
+      break;
+
+    case SCC_IR_OPERATION_CALL:
+      scc_ir_interpreter_call(execution, frame, instruction, mask, result);
+      // Discarded lanes go no further.
+      mask &= ~execution->discarded;
+      break;
+
+    case SCC_IR_OPERATION_MULTIPLY:
+      if (scc_ir_interpreter_is_product(function, instruction)) {
+        scc_ir_interpreter_product(frame, instruction, result);
+        break;
+      }
+
+      // Otherwise component-wise.
+      // Fall through.
+    default:
+      scc_ir_interpreter_component_wise(frame, instruction, result);
+      break;
+  }
+
+  if (mask)
+    scc_ir_interpreter_assign(&frame->words[frame->bytecode->instructions[index]],
+                              result,
+                              scc_ir_type_num_of_components(instruction->type),
+                              mask);
+
+  return mask;
+}
+
+// Where the compiler can take the address of a label, each handler jumps
+// straight to the next rather than back through a switch, which predicts
+// far better.
+#if defined(__GNUC__) || defined(__clang__)
+  #define SCC_IR_INTERPRETER_THREADED 1
+#else
+  #define SCC_IR_INTERPRETER_THREADED 0
+#endif
+
+#if SCC_IR_INTERPRETER_THREADED
+  #define SCC_IR_HANDLER(Code) handle_##Code:
+  #define SCC_IR_DISPATCH() goto *handlers[*pc]
+#else
+  #define SCC_IR_HANDLER(Code) case SCC_IR_OPCODE_##Code:
+  #define SCC_IR_DISPATCH() goto dispatch
+#endif
+
+// Results are written in place when every lane is running, otherwise to a
+// temporary that is blended in, so lanes not running keep their values.
+#define SCC_IR_DESTINATION(Slot) \
+  (full ? &words[Slot] : temporary)
+
+#define SCC_IR_COMMIT(Slot, N) \
+  if (!full) scc_ir_interpreter_assign(&words[Slot], temporary, N, mask)
+
+// Handles an opcode that applies `Expression` to each of `N` components of
+// `Arity` operands, in every lane, where `r[w]` is the result and `a[w]`,
+// `b[w]`, and `c[w]` the operands.
+#define SCC_IR_LANE_WISE(Code, N, Arity, Expression)                      \
+  SCC_IR_HANDLER(Code) {                                                  \
+    scc_ir_word_t *r = SCC_IR_DESTINATION(pc[1]);                         \
+    const scc_ir_word_t *a = &words[pc[2]];                               \
+    const scc_ir_word_t *b = &words[pc[((Arity) > 1) ? 3 : 2]];           \
+    const scc_ir_word_t *c = &words[pc[((Arity) > 2) ? 4 : 2]];           \
+    (void)b; (void)c;                                                     \
+    for (scc_uint32_t w = 0; w < (N) * SCC_IR_LANES; ++w) {               \
+      Expression;                                                         \
+    }                                                                     \
+    SCC_IR_COMMIT(pc[1], N);                                              \
+    pc += 2 + (Arity);                                                    \
+  } SCC_IR_DISPATCH();
+
+#define SCC_IR_LANE_WISE_X4(Code, Arity, Expression)                      \
+  SCC_IR_LANE_WISE(Code##X1, 1, Arity, Expression)                        \
+  SCC_IR_LANE_WISE(Code##X2, 2, Arity, Expression)                        \
+  SCC_IR_LANE_WISE(Code##X3, 3, Arity, Expression)                        \
+  SCC_IR_LANE_WISE(Code##X4, 4, Arity, Expression)
+
+#define SCC_IR_SPLAT(Code, N)                                             \
+  SCC_IR_HANDLER(Code) {                                                  \
+    for (scc_uint32_t k = 0; k < (N); ++k)                                \
+      memcpy(&words[pc[1] + k * SCC_IR_LANES],                            \
+             &words[pc[2]],                                               \
+             SCC_IR_LANES * sizeof(scc_ir_word_t));                       \
+    pc += 3;                                                              \
+  } SCC_IR_DISPATCH();
+
+#define SCC_IR_DOT(Code, N)                                               \
+  SCC_IR_HANDLER(Code) {                                                  \
+    scc_ir_word_t *r = SCC_IR_DESTINATION(pc[1]);                         \
+    const scc_ir_word_t *a = &words[pc[2]];                               \
+    const scc_ir_word_t *b = &words[pc[3]];                               \
+    for (scc_uint32_t l = 0; l < SCC_IR_LANES; ++l)                       \
+      r[l].f = a[l].f * b[l].f;                                           \
+    for (scc_uint32_t k = 1; k < (N); ++k)                                \
+      for (scc_uint32_t l = 0; l < SCC_IR_LANES; ++l)                     \
+        r[l].f += a[k * SCC_IR_LANES + l].f * b[k * SCC_IR_LANES + l].f;  \
+    SCC_IR_COMMIT(pc[1], 1);                                              \
+    pc += 4;                                                              \
+  } SCC_IR_DISPATCH();
+
+// Runs `block` for lanes in `mask`, sending them on to wherever its
+// terminator goes.
+static void scc_ir_interpreter_run_block(scc_ir_execution_t *execution,
+                                         scc_ir_frame_t *frame,
+                                         scc_uint32_t block,
+                                         scc_uint32_t mask) {
+  const scc_ir_bytecode_t *bytecode = frame->bytecode;
+
+  const scc_uint32_t *pc = &bytecode->code[bytecode->blocks[block]];
+
+  scc_ir_word_t *words = frame->words;
+
+  scc_ir_word_t temporary[16 * SCC_IR_LANES];
+
+  scc_bool_t full = (mask == SCC_IR_ALL_LANES);
+
+#if SCC_IR_INTERPRETER_THREADED
+  static const void *handlers[SCC_IR_NUM_OF_OPCODES] = {
+    #define OPCODE(Mnemonic, Code, Operands) \
+      &&handle_##Code,
+
+      #include "scc/ir/bytecode.inl"
+
+    #undef OPCODE
+  };
+
+  SCC_IR_DISPATCH();
+#else
+dispatch:
+  switch (*pc) {
+#endif
+
+  SCC_IR_HANDLER(GENERIC) {
+    mask = scc_ir_interpreter_evaluate(execution, frame, pc[1], mask);
+
+    if (mask == 0)
+      return;
+
+    full = (mask == SCC_IR_ALL_LANES);
+
+    pc += 2;
+  } SCC_IR_DISPATCH();
+
+  SCC_IR_HANDLER(NATIVE) {
+    // Native code doesn't mask writes, so is only called when it needn't.
+    if (full) {
+      bytecode->natives[pc[1]](words);
+      pc += 3 + pc[2];
+    } else {
+      pc += 3;
+    }
+  } SCC_IR_DISPATCH();
+
+  SCC_IR_HANDLER(SHUFFLE) {
+    scc_ir_word_t *r = SCC_IR_DESTINATION(pc[1]);
+
+    const scc_uint32_t n = pc[2];
+
+    for (scc_uint32_t k = 0; k < n; ++k)
+      memcpy(&r[k * SCC_IR_LANES], &words[pc[3 + k]], SCC_IR_LANES * sizeof(scc_ir_word_t));
+
+    SCC_IR_COMMIT(pc[1], n);
+
+    pc += 3 + n;
+  } SCC_IR_DISPATCH();
+
+  SCC_IR_SPLAT(SPLAT_X2, 2)
+  SCC_IR_SPLAT(SPLAT_X3, 3)
+  SCC_IR_SPLAT(SPLAT_X4, 4)
+
+  SCC_IR_LANE_WISE_X4(ADD_F32, 2, r[w].f = a[w].f + b[w].f)
+  SCC_IR_LANE_WISE_X4(SUB_F32, 2, r[w].f = a[w].f - b[w].f)
+  SCC_IR_LANE_WISE_X4(MUL_F32, 2, r[w].f = a[w].f * b[w].f)
+  SCC_IR_LANE_WISE_X4(DIV_F32, 2, r[w].f = a[w].f / b[w].f)
+  SCC_IR_LANE_WISE_X4(MIN_F32, 2, r[w].f = fminf(a[w].f, b[w].f))
+  SCC_IR_LANE_WISE_X4(MAX_F32, 2, r[w].f = fmaxf(a[w].f, b[w].f))
+
+  SCC_IR_LANE_WISE_X4(FMA_F32, 3, r[w].f = fmaf(a[w].f, b[w].f, c[w].f))
+  SCC_IR_LANE_WISE_X4(CLAMP_F32, 3, r[w].f = fminf(fmaxf(a[w].f, b[w].f), c[w].f))
+
+  SCC_IR_LANE_WISE_X4(ABS_F32, 1, r[w].f = fabsf(a[w].f))
+  SCC_IR_LANE_WISE_X4(FLOOR_F32, 1, r[w].f = floorf(a[w].f))
+  SCC_IR_LANE_WISE_X4(CEIL_F32, 1, r[w].f = ceilf(a[w].f))
+  SCC_IR_LANE_WISE_X4(SQRT_F32, 1, r[w].f = sqrtf(a[w].f))
+  SCC_IR_LANE_WISE_X4(RSQRT_F32, 1, r[w].f = 1.0f / sqrtf(a[w].f))
+  SCC_IR_LANE_WISE_X4(SAT_F32, 1, r[w].f = fminf(fmaxf(a[w].f, 0.0f), 1.0f))
+
+  SCC_IR_LANE_WISE_X4(ADD_I32, 2, r[w].u = a[w].u + b[w].u)
+  SCC_IR_LANE_WISE_X4(SUB_I32, 2, r[w].u = a[w].u - b[w].u)
+  SCC_IR_LANE_WISE_X4(MUL_I32, 2, r[w].u = a[w].u * b[w].u)
+
+  SCC_IR_LANE_WISE_X4(LT_F32, 2, r[w].u = (a[w].f < b[w].f))
+  SCC_IR_LANE_WISE_X4(LE_F32, 2, r[w].u = (a[w].f <= b[w].f))
+  SCC_IR_LANE_WISE_X4(EQ_F32, 2, r[w].u = (a[w].f == b[w].f))
+  SCC_IR_LANE_WISE_X4(NE_F32, 2, r[w].u = (a[w].f != b[w].f))
+  SCC_IR_LANE_WISE_X4(GT_F32, 2, r[w].u = (a[w].f > b[w].f))
+  SCC_IR_LANE_WISE_X4(GE_F32, 2, r[w].u = (a[w].f >= b[w].f))
+
+  SCC_IR_LANE_WISE_X4(LT_I32, 2, r[w].u = (a[w].i < b[w].i))
+  SCC_IR_LANE_WISE_X4(LE_I32, 2, r[w].u = (a[w].i <= b[w].i))
+  SCC_IR_LANE_WISE_X4(EQ_I32, 2, r[w].u = (a[w].u == b[w].u))
+  SCC_IR_LANE_WISE_X4(NE_I32, 2, r[w].u = (a[w].u != b[w].u))
+  SCC_IR_LANE_WISE_X4(GT_I32, 2, r[w].u = (a[w].i > b[w].i))
+  SCC_IR_LANE_WISE_X4(GE_I32, 2, r[w].u = (a[w].i >= b[w].i))
+
+  SCC_IR_LANE_WISE_X4(LT_U32, 2, r[w].u = (a[w].u < b[w].u))
+  SCC_IR_LANE_WISE_X4(LE_U32, 2, r[w].u = (a[w].u <= b[w].u))
+  SCC_IR_LANE_WISE_X4(GT_U32, 2, r[w].u = (a[w].u > b[w].u))
+  SCC_IR_LANE_WISE_X4(GE_U32, 2, r[w].u = (a[w].u >= b[w].u))
+
+  SCC_IR_DOT(DOT_F32X2, 2)
+  SCC_IR_DOT(DOT_F32X3, 3)
+  SCC_IR_DOT(DOT_F32X4, 4)
+
+  SCC_IR_HANDLER(MUL_F32X4X4) {
+    scc_ir_word_t *r = SCC_IR_DESTINATION(pc[1]);
+
+    const scc_ir_word_t *m = &words[pc[2]];
+    const scc_ir_word_t *v = &words[pc[3]];
+
+    for (scc_uint32_t row = 0; row < 4; ++row) {
+      for (scc_uint32_t l = 0; l < SCC_IR_LANES; ++l)
+        r[row * SCC_IR_LANES + l].f = m[row * SCC_IR_LANES + l].f * v[l].f;
+
+      for (scc_uint32_t k = 1; k < 4; ++k)
+        for (scc_uint32_t l = 0; l < SCC_IR_LANES; ++l)
+          r[row * SCC_IR_LANES + l].f += m[(k * 4 + row) * SCC_IR_LANES + l].f * v[k * SCC_IR_LANES + l].f;
+    }
+
+    SCC_IR_COMMIT(pc[1], 4);
+
+    pc += 4;
+  } SCC_IR_DISPATCH();
+
+  SCC_IR_HANDLER(JUMP) {
+    scc_ir_interpreter_enter(frame, &pc[1], mask);
+  } return;
+
+  SCC_IR_HANDLER(BRANCH) {
+    const scc_uint32_t taken = scc_ir_interpreter_truth(&words[pc[1]], pc[2], mask);
+
+    const scc_uint32_t *otherwise = scc_ir_interpreter_enter(frame, &pc[3], taken);
+
+    scc_ir_interpreter_enter(frame, otherwise, mask & ~taken);
+  } return;
+
+  SCC_IR_HANDLER(RETURN) {
+    if (pc[2])
+      scc_ir_interpreter_assign(&words[bytecode->returned], &words[pc[1]], pc[2], mask);
+  } return;
+
+  SCC_IR_HANDLER(DISCARD) {
+    execution->discarded |= mask;
+  } return;
+
+#if !SCC_IR_INTERPRETER_THREADED
+  }
+#endif
+}
+
+#undef SCC_IR_DOT
+#undef SCC_IR_SPLAT
+#undef SCC_IR_LANE_WISE_X4
+#undef SCC_IR_LANE_WISE
+#undef SCC_IR_COMMIT
+#undef SCC_IR_DESTINATION
+#undef SCC_IR_DISPATCH
+#undef SCC_IR_HANDLER
+
+static void scc_ir_interpreter_execute(scc_ir_execution_t *execution,
+                                       scc_ir_frame_t *frame,
+                                       scc_uint32_t mask) {
+  const scc_ir_bytecode_t *bytecode = frame->bytecode;
+
+  frame->pending[bytecode->order[0]] = mask;
+
+  // Always runs the earliest block in reverse post-order that lanes are
+  // waiting on, so every path into a block that doesn't loop back is taken
+  // before it runs, and lanes that diverged reconverge.
+  for (;;) {
+    scc_uint32_t position = 0;
+
+    while ((position < bytecode->num_of_reachable) && !frame->pending[bytecode->order[position]])
+      position += 1;
+
+    if (position == bytecode->num_of_reachable)
+      return;
+
+    const scc_uint32_t block = bytecode->order[position];
+    const scc_uint32_t entering = frame->pending[block] & ~execution->discarded;
+
+    frame->pending[block] = 0;
+
+    if (entering)
+      scc_ir_interpreter_run_block(execution, frame, block, entering);
+  }
+}
+
+scc_bool_t scc_ir_interpreter_run(const scc_ir_interpreter_t *interpreter,
+                                  scc_uint32_t function,
+                                  const scc_ir_bindings_t *bindings,
+                                  scc_uint32_t count) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (!scc_ir_interpreter_supports(interpreter, function))
+    return SCC_FALSE;
+
+  const scc_ir_module_t *module = interpreter->module;
+
+  if (module->functions[function]->num_of_arguments > 0)
+    return SCC_FALSE;
+
+  scc_arena_t *arena = scc_arena_create(heap, 64 * 1024);
+
+  scc_ir_execution_t execution;
+
+  execution.interpreter = interpreter;
+  execution.bindings = bindings;
+  execution.count = count;
+  execution.scratch = &arena->allocator;
+
+  // Reused by every batch, as lanes never read what they haven't written.
+  scc_ir_frame_t frame;
+
+  scc_ir_interpreter_frame(&frame, interpreter, function, heap);
+
+  for (scc_uint32_t base = 0; base < count; base += SCC_IR_LANES) {
+    const scc_uint32_t lanes = SCC_MIN(SCC_IR_LANES, count - base);
+
+    execution.base = base;
+    execution.discarded = 0;
+
+    scc_ir_interpreter_execute(&execution, &frame, SCC_IR_ALL_LANES >> (SCC_IR_LANES - lanes));
+
+    if (bindings->discarded)
+      for (scc_uint32_t lane = 0; lane < lanes; ++lane)
+        bindings->discarded[base + lane] = (execution.discarded >> lane) & 1;
+
+    scc_arena_reset(arena);
+  }
+
+  heap->free(heap, (void *)frame.pending);
+  heap->free(heap, (void *)frame.words);
+
+  scc_arena_destroy(arena);
+
+  return SCC_TRUE;
+}
+
+SCC_END_EXTERN_C
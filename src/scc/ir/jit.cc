@@ -0,0 +1,965 @@
+//===-- scc/ir/jit.cc -----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/jit.h"
+
+#include "scc/foundation/arena.h"
+
+// Native code follows the System V calling convention, so is only generated
+// where that's used.
+#if (SCC_ARCHITECTURE == SCC_ARCHITECTURE_X86_64) && \
+    ((SCC_PLATFORM == SCC_PLATFORM_MAC) || (SCC_PLATFORM == SCC_PLATFORM_LINUX)) && \
+    ((SCC_IR_LANES == 4) || (SCC_IR_LANES == 8))
+  #define SCC_IR_JIT 1
+#else
+  #define SCC_IR_JIT 0
+#endif
+
+#if SCC_IR_JIT
+  #include <sys/mman.h>
+  #include <unistd.h>
+#endif
+
+SCC_BEGIN_EXTERN_C
+
+struct scc_ir_jit {
+  void *code;
+  scc_size_t size_of_code;
+};
+
+#if SCC_IR_JIT
+
+//===----------------------------------------------------------------------===//
+// Assembler
+//===----------------------------------------------------------------------===//
+
+// Constants referred to by native code, each a vector, placed before code.
+typedef enum scc_ir_jit_constant {
+  SCC_IR_JIT_ABSOLUTE = 0,
+  SCC_IR_JIT_TRUE     = 1,
+  SCC_IR_JIT_ONE      = 2,
+  SCC_IR_JIT_ZERO     = 3,
+
+  SCC_IR_JIT_NUM_OF_CONSTANTS
+} scc_ir_jit_constant_t;
+
+#define SCC_IR_JIT_SIZE_OF_CONSTANT 32
+
+typedef struct scc_ir_jit_assembler {
+  scc_uint8_t *bytes;
+  scc_uint32_t size;
+  scc_uint32_t capacity;
+} scc_ir_jit_assembler_t;
+
+static void scc_ir_jit_emit(scc_ir_jit_assembler_t *assembler,
+                            scc_uint8_t byte) {
+  if (assembler->size == assembler->capacity) {
+    scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+    const scc_uint32_t capacity = assembler->capacity ? assembler->capacity * 2 : 4096;
+
+    scc_uint8_t *bytes = (scc_uint8_t *)heap->allocate(heap, capacity, 16);
+
+    if (assembler->bytes) {
+      memcpy(bytes, assembler->bytes, assembler->size);
+      heap->free(heap, (void *)assembler->bytes);
+    }
+
+    assembler->bytes = bytes;
+    assembler->capacity = capacity;
+  }
+
+  assembler->bytes[assembler->size++] = byte;
+}
+
+static void scc_ir_jit_emit32(scc_ir_jit_assembler_t *assembler,
+                              scc_uint32_t word) {
+  for (scc_uint32_t byte = 0; byte < 4; ++byte)
+    scc_ir_jit_emit(assembler, (scc_uint8_t)(word >> (8 * byte)));
+}
+
+// Operands encoded in ModRM, be they a register, a word of the frame, which
+// is pointed to by `rdi`, or a constant.
+typedef enum scc_ir_jit_addressing {
+  SCC_IR_JIT_REGISTER = 0,
+  SCC_IR_JIT_FRAME    = 1,
+  SCC_IR_JIT_CONSTANT = 2
+} scc_ir_jit_addressing_t;
+
+typedef struct scc_ir_jit_operand {
+  scc_ir_jit_addressing_t addressing;
+
+  // Register, offset of word in frame, or constant.
+  scc_uint32_t value;
+} scc_ir_jit_operand_t;
+
+static scc_ir_jit_operand_t scc_ir_jit_register(scc_uint32_t reg) {
+  scc_ir_jit_operand_t operand = { SCC_IR_JIT_REGISTER, reg };
+  return operand;
+}
+
+static scc_ir_jit_operand_t scc_ir_jit_word(scc_uint32_t offset) {
+  scc_ir_jit_operand_t operand = { SCC_IR_JIT_FRAME, offset };
+  return operand;
+}
+
+static scc_ir_jit_operand_t scc_ir_jit_constant(scc_ir_jit_constant_t constant) {
+  scc_ir_jit_operand_t operand = { SCC_IR_JIT_CONSTANT, constant };
+  return operand;
+}
+
+// Opcode maps and prefixes implied by VEX.
+#define SCC_IR_JIT_0F   1
+#define SCC_IR_JIT_0F38 2
+#define SCC_IR_JIT_0F3A 3
+
+#define SCC_IR_JIT_NP   0
+#define SCC_IR_JIT_66   1
+
+// Emits an instruction with a three-byte VEX prefix. Vectors are as wide as
+// lanes. An unused `vvvv` is given as zero.
+static void scc_ir_jit_vex(scc_ir_jit_assembler_t *assembler,
+                           scc_uint32_t map,
+                           scc_uint32_t prefix,
+                           scc_uint8_t opcode,
+                           scc_uint32_t reg,
+                           scc_uint32_t vvvv,
+                           scc_ir_jit_operand_t rm,
+                           scc_bool_t immediate,
+                           scc_uint8_t imm8) {
+  const scc_uint32_t b = (rm.addressing == SCC_IR_JIT_REGISTER) ? ((rm.value >> 3) & 1) : 0;
+  const scc_uint32_t l = (SCC_IR_LANES == 8) ? 1 : 0;
+
+  scc_ir_jit_emit(assembler, 0xC4);
+  scc_ir_jit_emit(assembler, (scc_uint8_t)((((~reg >> 3) & 1) << 7) | (1 << 6) | ((b ^ 1) << 5) | map));
+  scc_ir_jit_emit(assembler, (scc_uint8_t)(((~vvvv & 15) << 3) | (l << 2) | prefix));
+  scc_ir_jit_emit(assembler, opcode);
+
+  switch (rm.addressing) {
+    case SCC_IR_JIT_REGISTER:
+      scc_ir_jit_emit(assembler, (scc_uint8_t)(0xC0 | ((reg & 7) << 3) | (rm.value & 7)));
+      break;
+
+    case SCC_IR_JIT_FRAME:
+      // [rdi + disp32]
+      scc_ir_jit_emit(assembler, (scc_uint8_t)(0x80 | ((reg & 7) << 3) | 7));
+      scc_ir_jit_emit32(assembler, rm.value * sizeof(scc_ir_word_t));
+      break;
+
+    case SCC_IR_JIT_CONSTANT: {
+      // [rip + disp32], relative to the end of the instruction.
+      scc_ir_jit_emit(assembler, (scc_uint8_t)(0x05 | ((reg & 7) << 3)));
+      const scc_uint32_t end = assembler->size + 4 + (immediate ? 1 : 0);
+      scc_ir_jit_emit32(assembler, rm.value * SCC_IR_JIT_SIZE_OF_CONSTANT - end);
+    } break;
+  }
+
+  if (immediate)
+    scc_ir_jit_emit(assembler, imm8);
+}
+
+static void scc_ir_jit_load(scc_ir_jit_assembler_t *assembler,
+                            scc_uint32_t reg,
+                            scc_ir_jit_operand_t source) {
+  // vmovups reg, source
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F, SCC_IR_JIT_NP, 0x10, reg, 0, source, SCC_FALSE, 0);
+}
+
+static void scc_ir_jit_store(scc_ir_jit_assembler_t *assembler,
+                             scc_uint32_t offset,
+                             scc_uint32_t reg) {
+  // vmovups [rdi + offset], reg
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F, SCC_IR_JIT_NP, 0x11, reg, 0, scc_ir_jit_word(offset), SCC_FALSE, 0);
+}
+
+// Emits `opcode destination, left, right` for packed singles.
+static void scc_ir_jit_arithmetic(scc_ir_jit_assembler_t *assembler,
+                                  scc_uint8_t opcode,
+                                  scc_uint32_t destination,
+                                  scc_uint32_t left,
+                                  scc_ir_jit_operand_t right) {
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F, SCC_IR_JIT_NP, opcode, destination, left, right, SCC_FALSE, 0);
+}
+
+#define SCC_IR_JIT_VSQRTPS 0x51
+#define SCC_IR_JIT_VANDPS  0x54
+#define SCC_IR_JIT_VADDPS  0x58
+#define SCC_IR_JIT_VMULPS  0x59
+#define SCC_IR_JIT_VSUBPS  0x5C
+#define SCC_IR_JIT_VMINPS  0x5D
+#define SCC_IR_JIT_VDIVPS  0x5E
+#define SCC_IR_JIT_VMAXPS  0x5F
+
+static void scc_ir_jit_compare(scc_ir_jit_assembler_t *assembler,
+                               scc_uint32_t destination,
+                               scc_uint32_t left,
+                               scc_uint32_t right,
+                               scc_uint8_t predicate) {
+  // vcmpps destination, left, right, predicate
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F, SCC_IR_JIT_NP, 0xC2, destination, left, scc_ir_jit_register(right), SCC_TRUE, predicate);
+}
+
+static void scc_ir_jit_round(scc_ir_jit_assembler_t *assembler,
+                             scc_uint32_t destination,
+                             scc_uint32_t source,
+                             scc_uint8_t mode) {
+  // vroundps destination, source, mode
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F3A, SCC_IR_JIT_66, 0x08, destination, 0, scc_ir_jit_register(source), SCC_TRUE, mode);
+}
+
+static void scc_ir_jit_blend(scc_ir_jit_assembler_t *assembler,
+                             scc_uint32_t destination,
+                             scc_uint32_t unselected,
+                             scc_uint32_t selected,
+                             scc_uint32_t mask) {
+  // vblendvps destination, unselected, selected, mask
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F3A, SCC_IR_JIT_66, 0x4A, destination, unselected, scc_ir_jit_register(selected), SCC_TRUE, (scc_uint8_t)(mask << 4));
+}
+
+static void scc_ir_jit_move(scc_ir_jit_assembler_t *assembler,
+                            scc_uint32_t destination,
+                            scc_uint32_t source) {
+  // vmovaps destination, source
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F, SCC_IR_JIT_NP, 0x28, destination, 0, scc_ir_jit_register(source), SCC_FALSE, 0);
+}
+
+static void scc_ir_jit_fma(scc_ir_jit_assembler_t *assembler,
+                           scc_uint32_t accumulator,
+                           scc_uint32_t multiplier,
+                           scc_uint32_t addend) {
+  // vfmadd213ps accumulator, multiplier, addend
+  scc_ir_jit_vex(assembler, SCC_IR_JIT_0F38, SCC_IR_JIT_66, 0xA8, accumulator, multiplier, scc_ir_jit_register(addend), SCC_FALSE, 0);
+}
+
+//===----------------------------------------------------------------------===//
+// Runs
+//===----------------------------------------------------------------------===//
+
+// Each run is translated to operations on virtual registers, one per
+// component, before registers are allocated.
+typedef enum scc_ir_jit_operation {
+  SCC_IR_JIT_ADD,
+  SCC_IR_JIT_SUB,
+  SCC_IR_JIT_MUL,
+  SCC_IR_JIT_DIV,
+  SCC_IR_JIT_MIN,
+  SCC_IR_JIT_MAX,
+  SCC_IR_JIT_SQRT,
+  SCC_IR_JIT_FLOOR,
+  SCC_IR_JIT_CEIL,
+  SCC_IR_JIT_ABS,
+  SCC_IR_JIT_FMA,
+  SCC_IR_JIT_COMPARE,
+
+  // Writes `a` to the word at `imm`, for shuffles.
+  SCC_IR_JIT_STORE
+} scc_ir_jit_operation_t;
+
+typedef struct scc_ir_jit_op {
+  scc_ir_jit_operation_t operation;
+  scc_uint32_t imm;
+  scc_uint32_t d, a, b, c;
+} scc_ir_jit_op_t;
+
+// Virtual registers are homed in their slot, in the constants, or, for those
+// that only hold intermediate results, in spill slots appended to frames.
+typedef enum scc_ir_jit_home {
+  SCC_IR_JIT_HOME_SLOT,
+  SCC_IR_JIT_HOME_CONSTANT,
+  SCC_IR_JIT_HOME_SPILL
+} scc_ir_jit_home_t;
+
+typedef struct scc_ir_jit_vreg {
+  scc_ir_jit_home_t home;
+  scc_uint32_t offset;
+
+  // Position of last use.
+  scc_uint32_t end;
+
+  // Physical register, or `SCC_IR_NONE`.
+  scc_uint32_t reg;
+
+  // Whether the home holds its value.
+  scc_bool_t homed;
+} scc_ir_jit_vreg_t;
+
+// Registers `ymm0` through `ymm11` are allocated. The rest are scratch, with
+// `ymm12` through `ymm14` holding operands that aren't in a register, and
+// `ymm15` results that aren't given one.
+#define SCC_IR_JIT_NUM_OF_REGISTERS 12
+#define SCC_IR_JIT_SCRATCH 12
+#define SCC_IR_JIT_RESULT 15
+
+typedef struct scc_ir_jit_run {
+  scc_ir_jit_op_t *ops;
+  scc_uint32_t num_of_ops;
+
+  scc_ir_jit_vreg_t *vregs;
+  scc_uint32_t num_of_vregs;
+
+  // Indexed by component of frame. Virtual register currently holding it.
+  scc_uint32_t *components;
+
+  // Virtual registers holding constants, created on demand.
+  scc_uint32_t constants[SCC_IR_JIT_NUM_OF_CONSTANTS];
+
+  // Where spill slots start, and how many are used.
+  scc_uint32_t spills;
+  scc_uint32_t num_of_spills;
+
+  // Indexed by physical register. Virtual register held.
+  scc_uint32_t owners[SCC_IR_JIT_NUM_OF_REGISTERS];
+} scc_ir_jit_run_t;
+
+static scc_uint32_t scc_ir_jit_vreg(scc_ir_jit_run_t *run,
+                                    scc_ir_jit_home_t home,
+                                    scc_uint32_t offset,
+                                    scc_bool_t homed) {
+  scc_ir_jit_vreg_t *vreg = &run->vregs[run->num_of_vregs];
+
+  vreg->home = home;
+  vreg->offset = offset;
+  vreg->end = run->num_of_ops;
+  vreg->reg = SCC_IR_NONE;
+  vreg->homed = homed;
+
+  return run->num_of_vregs++;
+}
+
+// Returns the virtual register holding the word at `offset`.
+static scc_uint32_t scc_ir_jit_read(scc_ir_jit_run_t *run,
+                                    scc_uint32_t offset) {
+  scc_uint32_t *vreg = &run->components[offset / SCC_IR_LANES];
+
+  if (*vreg == SCC_IR_NONE)
+    *vreg = scc_ir_jit_vreg(run, SCC_IR_JIT_HOME_SLOT, offset, SCC_TRUE);
+
+  return *vreg;
+}
+
+static scc_uint32_t scc_ir_jit_write(scc_ir_jit_run_t *run,
+                                     scc_uint32_t offset) {
+  return run->components[offset / SCC_IR_LANES] =
+    scc_ir_jit_vreg(run, SCC_IR_JIT_HOME_SLOT, offset, SCC_FALSE);
+}
+
+static scc_uint32_t scc_ir_jit_temporary(scc_ir_jit_run_t *run) {
+  return scc_ir_jit_vreg(run, SCC_IR_JIT_HOME_SPILL, run->spills + (run->num_of_spills++) * SCC_IR_LANES, SCC_FALSE);
+}
+
+static scc_uint32_t scc_ir_jit_splat(scc_ir_jit_run_t *run,
+                                     scc_ir_jit_constant_t constant) {
+  if (run->constants[constant] == SCC_IR_NONE)
+    run->constants[constant] = scc_ir_jit_vreg(run, SCC_IR_JIT_HOME_CONSTANT, constant, SCC_TRUE);
+  return run->constants[constant];
+}
+
+static void scc_ir_jit_op(scc_ir_jit_run_t *run,
+                          scc_ir_jit_operation_t operation,
+                          scc_uint32_t imm,
+                          scc_uint32_t d,
+                          scc_uint32_t a,
+                          scc_uint32_t b,
+                          scc_uint32_t c) {
+  const scc_uint32_t position = run->num_of_ops++;
+
+  scc_ir_jit_op_t *op = &run->ops[position];
+
+  op->operation = operation;
+  op->imm = imm;
+  op->d = d;
+  op->a = a;
+  op->b = b;
+  op->c = c;
+
+  const scc_uint32_t operands[3] = { a, b, c };
+
+  for (scc_uint32_t operand = 0; operand < 3; ++operand)
+    if (operands[operand] != SCC_IR_NONE)
+      run->vregs[operands[operand]].end = position;
+}
+
+// Determines if `opcode` can be compiled.
+static scc_bool_t scc_ir_jit_is_compilable(scc_uint32_t opcode,
+                                           scc_bool_t fma) {
+  if ((opcode >= SCC_IR_OPCODE_FMA_F32X1) && (opcode <= SCC_IR_OPCODE_FMA_F32X4))
+    return fma;
+
+  if ((opcode >= SCC_IR_OPCODE_SHUFFLE) && (opcode <= SCC_IR_OPCODE_SAT_F32X4))
+    return SCC_TRUE;
+  if ((opcode >= SCC_IR_OPCODE_LT_F32X1) && (opcode <= SCC_IR_OPCODE_GE_F32X4))
+    return SCC_TRUE;
+  if ((opcode >= SCC_IR_OPCODE_DOT_F32X2) && (opcode <= SCC_IR_OPCODE_MUL_F32X4X4))
+    return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+// Translates the opcode at `pc`, which must be compilable.
+static void scc_ir_jit_translate(scc_ir_jit_run_t *run,
+                                 const scc_uint32_t *pc) {
+  const scc_uint32_t opcode = pc[0];
+
+  #define SCC_IR_JIT_COMPONENT(Operand, K) \
+    scc_ir_jit_read(run, pc[Operand] + (K) * SCC_IR_LANES)
+
+  if (opcode == SCC_IR_OPCODE_SHUFFLE) {
+    scc_uint32_t sources[16];
+
+    for (scc_uint32_t k = 0; k < pc[2]; ++k)
+      sources[k] = scc_ir_jit_read(run, pc[3 + k]);
+
+    for (scc_uint32_t k = 0; k < pc[2]; ++k) {
+      run->components[(pc[1] / SCC_IR_LANES) + k] = sources[k];
+      scc_ir_jit_op(run, SCC_IR_JIT_STORE, pc[1] + k * SCC_IR_LANES, SCC_IR_NONE, sources[k], SCC_IR_NONE, SCC_IR_NONE);
+    }
+
+    return;
+  }
+
+  if ((opcode >= SCC_IR_OPCODE_SPLAT_X2) && (opcode <= SCC_IR_OPCODE_SPLAT_X4)) {
+    // Splatted components are the same register. They're still written, as
+    // whatever follows the run may read them.
+    const scc_uint32_t source = scc_ir_jit_read(run, pc[2]);
+
+    for (scc_uint32_t k = 0; k < 2 + (opcode - SCC_IR_OPCODE_SPLAT_X2); ++k) {
+      run->components[(pc[1] / SCC_IR_LANES) + k] = source;
+      scc_ir_jit_op(run, SCC_IR_JIT_STORE, pc[1] + k * SCC_IR_LANES, SCC_IR_NONE, source, SCC_IR_NONE, SCC_IR_NONE);
+    }
+
+    return;
+  }
+
+  if ((opcode >= SCC_IR_OPCODE_DOT_F32X2) && (opcode <= SCC_IR_OPCODE_DOT_F32X4)) {
+    const scc_uint32_t n = 2 + (opcode - SCC_IR_OPCODE_DOT_F32X2);
+
+    // Summed in the same order as interpreted.
+    scc_uint32_t sum = scc_ir_jit_temporary(run);
+    scc_ir_jit_op(run, SCC_IR_JIT_MUL, 0, sum, SCC_IR_JIT_COMPONENT(2, 0), SCC_IR_JIT_COMPONENT(3, 0), SCC_IR_NONE);
+
+    for (scc_uint32_t k = 1; k < n; ++k) {
+      const scc_uint32_t product = scc_ir_jit_temporary(run);
+      scc_ir_jit_op(run, SCC_IR_JIT_MUL, 0, product, SCC_IR_JIT_COMPONENT(2, k), SCC_IR_JIT_COMPONENT(3, k), SCC_IR_NONE);
+
+      const scc_uint32_t summed = (k == n - 1) ? scc_ir_jit_write(run, pc[1]) : scc_ir_jit_temporary(run);
+      scc_ir_jit_op(run, SCC_IR_JIT_ADD, 0, summed, sum, product, SCC_IR_NONE);
+
+      sum = summed;
+    }
+
+    return;
+  }
+
+  if (opcode == SCC_IR_OPCODE_MUL_F32X4X4) {
+    scc_uint32_t matrix[16], vector[4];
+
+    for (scc_uint32_t k = 0; k < 16; ++k)
+      matrix[k] = SCC_IR_JIT_COMPONENT(2, k);
+    for (scc_uint32_t k = 0; k < 4; ++k)
+      vector[k] = SCC_IR_JIT_COMPONENT(3, k);
+
+    for (scc_uint32_t row = 0; row < 4; ++row) {
+      scc_uint32_t sum = scc_ir_jit_temporary(run);
+      scc_ir_jit_op(run, SCC_IR_JIT_MUL, 0, sum, matrix[row], vector[0], SCC_IR_NONE);
+
+      for (scc_uint32_t k = 1; k < 4; ++k) {
+        const scc_uint32_t product = scc_ir_jit_temporary(run);
+        scc_ir_jit_op(run, SCC_IR_JIT_MUL, 0, product, matrix[k * 4 + row], vector[k], SCC_IR_NONE);
+
+        const scc_uint32_t summed = (k == 3) ? scc_ir_jit_write(run, pc[1] + row * SCC_IR_LANES) : scc_ir_jit_temporary(run);
+        scc_ir_jit_op(run, SCC_IR_JIT_ADD, 0, summed, sum, product, SCC_IR_NONE);
+
+        sum = summed;
+      }
+    }
+
+    return;
+  }
+
+  // Everything else is component-wise, in families of four widths.
+  scc_uint32_t family, n;
+
+  if ((opcode >= SCC_IR_OPCODE_LT_F32X1) && (opcode <= SCC_IR_OPCODE_GE_F32X4)) {
+    family = SCC_IR_OPCODE_LT_F32X1 + ((opcode - SCC_IR_OPCODE_LT_F32X1) / 4) * 4;
+    n = 1 + (opcode - SCC_IR_OPCODE_LT_F32X1) % 4;
+  } else {
+    family = SCC_IR_OPCODE_ADD_F32X1 + ((opcode - SCC_IR_OPCODE_ADD_F32X1) / 4) * 4;
+    n = 1 + (opcode - SCC_IR_OPCODE_ADD_F32X1) % 4;
+  }
+
+  for (scc_uint32_t k = 0; k < n; ++k) {
+    const scc_uint32_t a = SCC_IR_JIT_COMPONENT(2, k);
+
+    #define SCC_IR_JIT_BINARY(Operation, Imm) \
+      scc_ir_jit_op(run, Operation, Imm, scc_ir_jit_write(run, pc[1] + k * SCC_IR_LANES), a, SCC_IR_JIT_COMPONENT(3, k), SCC_IR_NONE)
+
+    #define SCC_IR_JIT_UNARY(Operation) \
+      scc_ir_jit_op(run, Operation, 0, scc_ir_jit_write(run, pc[1] + k * SCC_IR_LANES), a, SCC_IR_NONE, SCC_IR_NONE)
+
+    switch (family) {
+      case SCC_IR_OPCODE_ADD_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_ADD, 0); break;
+      case SCC_IR_OPCODE_SUB_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_SUB, 0); break;
+      case SCC_IR_OPCODE_MUL_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_MUL, 0); break;
+      case SCC_IR_OPCODE_DIV_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_DIV, 0); break;
+      case SCC_IR_OPCODE_MIN_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_MIN, 0); break;
+      case SCC_IR_OPCODE_MAX_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_MAX, 0); break;
+
+      // Predicates are ordered and signalling, bar `neq`, which is unordered,
+      // so comparisons involving NaN are false, bar `neq`, as in C.
+      case SCC_IR_OPCODE_LT_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_COMPARE, 0x01); break;
+      case SCC_IR_OPCODE_LE_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_COMPARE, 0x02); break;
+      case SCC_IR_OPCODE_EQ_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_COMPARE, 0x00); break;
+      case SCC_IR_OPCODE_NE_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_COMPARE, 0x04); break;
+      case SCC_IR_OPCODE_GT_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_COMPARE, 0x0E); break;
+      case SCC_IR_OPCODE_GE_F32X1: SCC_IR_JIT_BINARY(SCC_IR_JIT_COMPARE, 0x0D); break;
+
+      case SCC_IR_OPCODE_ABS_F32X1: SCC_IR_JIT_UNARY(SCC_IR_JIT_ABS); break;
+      case SCC_IR_OPCODE_FLOOR_F32X1: SCC_IR_JIT_UNARY(SCC_IR_JIT_FLOOR); break;
+      case SCC_IR_OPCODE_CEIL_F32X1: SCC_IR_JIT_UNARY(SCC_IR_JIT_CEIL); break;
+      case SCC_IR_OPCODE_SQRT_F32X1: SCC_IR_JIT_UNARY(SCC_IR_JIT_SQRT); break;
+
+      case SCC_IR_OPCODE_RSQRT_F32X1: {
+        const scc_uint32_t root = scc_ir_jit_temporary(run);
+        scc_ir_jit_op(run, SCC_IR_JIT_SQRT, 0, root, a, SCC_IR_NONE, SCC_IR_NONE);
+        scc_ir_jit_op(run, SCC_IR_JIT_DIV, 0, scc_ir_jit_write(run, pc[1] + k * SCC_IR_LANES),
+                      scc_ir_jit_splat(run, SCC_IR_JIT_ONE), root, SCC_IR_NONE);
+      } break;
+
+      case SCC_IR_OPCODE_SAT_F32X1: {
+        const scc_uint32_t lower = scc_ir_jit_temporary(run);
+        scc_ir_jit_op(run, SCC_IR_JIT_MAX, 0, lower, a, scc_ir_jit_splat(run, SCC_IR_JIT_ZERO), SCC_IR_NONE);
+        scc_ir_jit_op(run, SCC_IR_JIT_MIN, 0, scc_ir_jit_write(run, pc[1] + k * SCC_IR_LANES),
+                      lower, scc_ir_jit_splat(run, SCC_IR_JIT_ONE), SCC_IR_NONE);
+      } break;
+
+      case SCC_IR_OPCODE_CLAMP_F32X1: {
+        const scc_uint32_t lower = scc_ir_jit_temporary(run);
+        scc_ir_jit_op(run, SCC_IR_JIT_MAX, 0, lower, a, SCC_IR_JIT_COMPONENT(3, k), SCC_IR_NONE);
+        scc_ir_jit_op(run, SCC_IR_JIT_MIN, 0, scc_ir_jit_write(run, pc[1] + k * SCC_IR_LANES),
+                      lower, SCC_IR_JIT_COMPONENT(4, k), SCC_IR_NONE);
+      } break;
+
+      case SCC_IR_OPCODE_FMA_F32X1: {
+        const scc_uint32_t b = SCC_IR_JIT_COMPONENT(3, k), c = SCC_IR_JIT_COMPONENT(4, k);
+        scc_ir_jit_op(run, SCC_IR_JIT_FMA, 0, scc_ir_jit_write(run, pc[1] + k * SCC_IR_LANES), a, b, c);
+      } break;
+    }
+
+    #undef SCC_IR_JIT_UNARY
+    #undef SCC_IR_JIT_BINARY
+  }
+
+  #undef SCC_IR_JIT_COMPONENT
+}
+
+// Gives `vreg`, used or defined at `position` by `op`, a register if one is
+// free or can be taken from a virtual register that isn't used for longer.
+// Returns `SCC_IR_NONE` if neither.
+static scc_uint32_t scc_ir_jit_allocate(scc_ir_jit_run_t *run,
+                                        scc_ir_jit_assembler_t *assembler,
+                                        const scc_ir_jit_op_t *op,
+                                        scc_uint32_t vreg) {
+  scc_uint32_t victim = SCC_IR_NONE;
+
+  for (scc_uint32_t reg = 0; reg < SCC_IR_JIT_NUM_OF_REGISTERS; ++reg) {
+    const scc_uint32_t owner = run->owners[reg];
+
+    if (owner == SCC_IR_NONE) {
+      run->owners[reg] = vreg;
+      return reg;
+    }
+
+    if ((owner == op->a) || (owner == op->b) || (owner == op->c))
+      continue;
+
+    if ((victim == SCC_IR_NONE) || (run->vregs[owner].end > run->vregs[run->owners[victim]].end))
+      victim = reg;
+  }
+
+  if (victim == SCC_IR_NONE)
+    return SCC_IR_NONE;
+
+  scc_ir_jit_vreg_t *spilled = &run->vregs[run->owners[victim]];
+
+  if (spilled->end <= run->vregs[vreg].end)
+    return SCC_IR_NONE;
+
+  if (!spilled->homed) {
+    scc_ir_jit_store(assembler, spilled->offset, victim);
+    spilled->homed = SCC_TRUE;
+  }
+
+  spilled->reg = SCC_IR_NONE;
+
+  run->owners[victim] = vreg;
+
+  return victim;
+}
+
+static scc_ir_jit_operand_t scc_ir_jit_home_of(const scc_ir_jit_vreg_t *vreg) {
+  if (vreg->home == SCC_IR_JIT_HOME_CONSTANT)
+    return scc_ir_jit_constant((scc_ir_jit_constant_t)vreg->offset);
+  return scc_ir_jit_word(vreg->offset);
+}
+
+// Allocates registers and emits code for the translated run.
+static void scc_ir_jit_generate(scc_ir_jit_run_t *run,
+                                scc_ir_jit_assembler_t *assembler) {
+  for (scc_uint32_t reg = 0; reg < SCC_IR_JIT_NUM_OF_REGISTERS; ++reg)
+    run->owners[reg] = SCC_IR_NONE;
+
+  for (scc_uint32_t position = 0; position < run->num_of_ops; ++position) {
+    const scc_ir_jit_op_t *op = &run->ops[position];
+
+    // Registers of virtual registers no longer used are freed.
+    for (scc_uint32_t reg = 0; reg < SCC_IR_JIT_NUM_OF_REGISTERS; ++reg) {
+      const scc_uint32_t owner = run->owners[reg];
+
+      if ((owner != SCC_IR_NONE) && (run->vregs[owner].end < position)) {
+        run->vregs[owner].reg = SCC_IR_NONE;
+        run->owners[reg] = SCC_IR_NONE;
+      }
+    }
+
+    const scc_uint32_t operands[3] = { op->a, op->b, op->c };
+
+    scc_uint32_t regs[3] = { SCC_IR_NONE, SCC_IR_NONE, SCC_IR_NONE };
+
+    for (scc_uint32_t operand = 0; operand < 3; ++operand) {
+      if (operands[operand] == SCC_IR_NONE)
+        continue;
+
+      scc_ir_jit_vreg_t *vreg = &run->vregs[operands[operand]];
+
+      if (vreg->reg == SCC_IR_NONE) {
+        vreg->reg = scc_ir_jit_allocate(run, assembler, op, operands[operand]);
+
+        // Operands that can't be given a register are loaded into scratch.
+        regs[operand] = (vreg->reg != SCC_IR_NONE) ? vreg->reg : (SCC_IR_JIT_SCRATCH + operand);
+
+        scc_ir_jit_load(assembler, regs[operand], scc_ir_jit_home_of(vreg));
+      } else {
+        regs[operand] = vreg->reg;
+      }
+    }
+
+    if (op->operation == SCC_IR_JIT_STORE) {
+      scc_ir_jit_store(assembler, op->imm, regs[0]);
+      continue;
+    }
+
+    scc_ir_jit_vreg_t *result = &run->vregs[op->d];
+
+    // Results never share a register with operands, so sequences below can
+    // write them before they're done reading operands.
+    result->reg = scc_ir_jit_allocate(run, assembler, op, op->d);
+
+    const scc_uint32_t d = (result->reg != SCC_IR_NONE) ? result->reg : SCC_IR_JIT_RESULT;
+    const scc_uint32_t a = regs[0], b = regs[1], c = regs[2];
+
+    switch (op->operation) {
+      case SCC_IR_JIT_ADD: scc_ir_jit_arithmetic(assembler, SCC_IR_JIT_VADDPS, d, a, scc_ir_jit_register(b)); break;
+      case SCC_IR_JIT_SUB: scc_ir_jit_arithmetic(assembler, SCC_IR_JIT_VSUBPS, d, a, scc_ir_jit_register(b)); break;
+      case SCC_IR_JIT_MUL: scc_ir_jit_arithmetic(assembler, SCC_IR_JIT_VMULPS, d, a, scc_ir_jit_register(b)); break;
+      case SCC_IR_JIT_DIV: scc_ir_jit_arithmetic(assembler, SCC_IR_JIT_VDIVPS, d, a, scc_ir_jit_register(b)); break;
+
+      case SCC_IR_JIT_MIN:
+      case SCC_IR_JIT_MAX:
+        // Yields the second operand if either is NaN, whereas `fminf` and
+        // `fmaxf` yield whichever isn't, so the first is blended in where
+        // the second is NaN.
+        scc_ir_jit_compare(assembler, SCC_IR_JIT_SCRATCH + 2, b, b, 0x03);
+        scc_ir_jit_arithmetic(assembler, (op->operation == SCC_IR_JIT_MIN) ? SCC_IR_JIT_VMINPS : SCC_IR_JIT_VMAXPS,
+                              d, a, scc_ir_jit_register(b));
+        scc_ir_jit_blend(assembler, d, d, a, SCC_IR_JIT_SCRATCH + 2);
+        break;
+
+      case SCC_IR_JIT_SQRT:
+        scc_ir_jit_vex(assembler, SCC_IR_JIT_0F, SCC_IR_JIT_NP, SCC_IR_JIT_VSQRTPS, d, 0, scc_ir_jit_register(a), SCC_FALSE, 0);
+        break;
+
+      case SCC_IR_JIT_FLOOR: scc_ir_jit_round(assembler, d, a, 0x09); break;
+      case SCC_IR_JIT_CEIL: scc_ir_jit_round(assembler, d, a, 0x0A); break;
+
+      case SCC_IR_JIT_ABS:
+        scc_ir_jit_arithmetic(assembler, SCC_IR_JIT_VANDPS, d, a, scc_ir_jit_constant(SCC_IR_JIT_ABSOLUTE));
+        break;
+
+      case SCC_IR_JIT_FMA:
+        scc_ir_jit_move(assembler, d, a);
+        scc_ir_jit_fma(assembler, d, b, c);
+        break;
+
+      case SCC_IR_JIT_COMPARE:
+        // Masks are narrowed to one or zero.
+        scc_ir_jit_compare(assembler, d, a, b, (scc_uint8_t)op->imm);
+        scc_ir_jit_arithmetic(assembler, SCC_IR_JIT_VANDPS, d, d, scc_ir_jit_constant(SCC_IR_JIT_TRUE));
+        break;
+
+      case SCC_IR_JIT_STORE:
+        break;
+    }
+
+    // Results are written through to slots. Intermediate results are only
+    // written to spill slots if they have to be.
+    if ((result->home == SCC_IR_JIT_HOME_SLOT) || (result->reg == SCC_IR_NONE)) {
+      scc_ir_jit_store(assembler, result->offset, d);
+      result->homed = SCC_TRUE;
+    }
+  }
+}
+
+//===----------------------------------------------------------------------===//
+// Compilation
+//===----------------------------------------------------------------------===//
+
+static scc_bool_t scc_ir_jit_is_terminator(scc_uint32_t opcode) {
+  return (opcode == SCC_IR_OPCODE_JUMP)
+      || (opcode == SCC_IR_OPCODE_BRANCH)
+      || (opcode == SCC_IR_OPCODE_RETURN)
+      || (opcode == SCC_IR_OPCODE_DISCARD);
+}
+
+// Finds the run starting at `pc`, returning the number of words it spans and
+// setting `num_of_opcodes`.
+static scc_uint32_t scc_ir_jit_span(const scc_uint32_t *pc,
+                                    scc_bool_t fma,
+                                    scc_uint32_t *num_of_opcodes) {
+  scc_uint32_t words = 0;
+
+  *num_of_opcodes = 0;
+
+  while (scc_ir_jit_is_compilable(pc[words], fma)) {
+    words += scc_ir_bytecode_length(&pc[words]);
+    *num_of_opcodes += 1;
+  }
+
+  return words;
+}
+
+#endif // SCC_IR_JIT
+
+scc_bool_t scc_ir_jit_is_available(void) {
+#if SCC_IR_JIT
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("avx");
+#else
+  return SCC_FALSE;
+#endif
+}
+
+scc_uint32_t scc_ir_jit_features(void) {
+#if SCC_IR_JIT
+  __builtin_cpu_init();
+  return __builtin_cpu_supports("fma") ? SCC_IR_JIT_FEATURE_FMA : 0;
+#else
+  return 0;
+#endif
+}
+
+scc_ir_jit_t *scc_ir_jit_compile(scc_ir_bytecode_t *bytecode,
+                                 scc_uint32_t features) {
+#if SCC_IR_JIT
+  if (!scc_ir_jit_is_available())
+    return NULL;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  const scc_bool_t fma = ((features & scc_ir_jit_features() & SCC_IR_JIT_FEATURE_FMA) != 0);
+
+  const scc_uint32_t *code = bytecode->code;
+
+  // Runs worth calling out to, i.e. of more than one opcode, as offsets in
+  // code followed by the words they span.
+  scc_uint32_t *runs =
+    (scc_uint32_t *)heap->allocate(heap, (bytecode->size_of_code + 2) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t num_of_runs = 0;
+  scc_uint32_t longest = 0;
+
+  for (scc_uint32_t position = 0; position < bytecode->num_of_reachable; ++position) {
+    const scc_uint32_t *pc = &code[bytecode->blocks[bytecode->order[position]]];
+
+    for (;;) {
+      scc_uint32_t num_of_opcodes;
+      const scc_uint32_t words = scc_ir_jit_span(pc, fma, &num_of_opcodes);
+
+      if (num_of_opcodes > 1) {
+        runs[2 * num_of_runs + 0] = (scc_uint32_t)(pc - code);
+        runs[2 * num_of_runs + 1] = words;
+        num_of_runs += 1;
+        longest = SCC_MAX(longest, words);
+      }
+
+      pc += words;
+
+      if (scc_ir_jit_is_terminator(pc[0]))
+        break;
+
+      pc += scc_ir_bytecode_length(pc);
+    }
+  }
+
+  if (num_of_runs == 0) {
+    heap->free(heap, (void *)runs);
+    return NULL;
+  }
+
+  // No opcode translates to more than eight operations per word, nor does
+  // any operation introduce more than four virtual registers.
+  scc_arena_t *arena = scc_arena_create(heap, 64 * 1024);
+  scc_allocator_t *allocator = &arena->allocator;
+
+  scc_ir_jit_run_t run;
+
+  run.ops = (scc_ir_jit_op_t *)allocator->allocate(allocator, (8 * longest + 16) * sizeof(scc_ir_jit_op_t), 16);
+  run.vregs = (scc_ir_jit_vreg_t *)allocator->allocate(allocator, 4 * (8 * longest + 16) * sizeof(scc_ir_jit_vreg_t), 16);
+  run.components = (scc_uint32_t *)allocator->allocate(allocator, (bytecode->size_of_frame / SCC_IR_LANES + 1) * sizeof(scc_uint32_t), 16);
+  run.spills = bytecode->size_of_frame;
+
+  scc_uint32_t num_of_spills = 0;
+
+  scc_ir_jit_assembler_t assembler = { NULL, 0, 0 };
+
+  static const scc_uint32_t constants[SCC_IR_JIT_NUM_OF_CONSTANTS] = {
+    0x7fffffffu, 0x00000001u, 0x3f800000u, 0x00000000u
+  };
+
+  for (scc_uint32_t constant = 0; constant < SCC_IR_JIT_NUM_OF_CONSTANTS; ++constant)
+    for (scc_uint32_t lane = 0; lane < SCC_IR_JIT_SIZE_OF_CONSTANT / 4; ++lane)
+      scc_ir_jit_emit32(&assembler, constants[constant]);
+
+  scc_uint32_t *entries = (scc_uint32_t *)allocator->allocate(allocator, num_of_runs * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t index = 0; index < num_of_runs; ++index) {
+    const scc_uint32_t *pc = &code[runs[2 * index]];
+    const scc_uint32_t *end = pc + runs[2 * index + 1];
+
+    run.num_of_ops = 0;
+    run.num_of_vregs = 0;
+    run.num_of_spills = 0;
+
+    for (scc_uint32_t component = 0; component < bytecode->size_of_frame / SCC_IR_LANES; ++component)
+      run.components[component] = SCC_IR_NONE;
+    for (scc_uint32_t constant = 0; constant < SCC_IR_JIT_NUM_OF_CONSTANTS; ++constant)
+      run.constants[constant] = SCC_IR_NONE;
+
+    for (; pc != end; pc += scc_ir_bytecode_length(pc))
+      scc_ir_jit_translate(&run, pc);
+
+    // Functions are aligned, as are any branch targets.
+    while (assembler.size % 16)
+      scc_ir_jit_emit(&assembler, 0xCC);
+
+    entries[index] = assembler.size;
+
+    scc_ir_jit_generate(&run, &assembler);
+
+    // vzeroupper; ret
+    scc_ir_jit_emit(&assembler, 0xC5);
+    scc_ir_jit_emit(&assembler, 0xF8);
+    scc_ir_jit_emit(&assembler, 0x77);
+    scc_ir_jit_emit(&assembler, 0xC3);
+
+    num_of_spills = SCC_MAX(num_of_spills, run.num_of_spills);
+  }
+
+  const scc_size_t page = (scc_size_t)sysconf(_SC_PAGESIZE);
+  const scc_size_t size = SCC_ALIGN_TO_BOUNDARY((scc_size_t)assembler.size, page);
+
+  void *executable = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+
+  if (executable == MAP_FAILED) {
+    heap->free(heap, (void *)assembler.bytes);
+    heap->free(heap, (void *)runs);
+    scc_arena_destroy(arena);
+    return NULL;
+  }
+
+  memcpy(executable, assembler.bytes, assembler.size);
+  mprotect(executable, size, PROT_READ | PROT_EXEC);
+
+  heap->free(heap, (void *)assembler.bytes);
+
+  // Bytecode is rewritten with `native` before each run.
+  scc_uint32_t *rewritten =
+    (scc_uint32_t *)heap->allocate(heap, (bytecode->size_of_code + 3 * num_of_runs) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t *remapped =
+    (scc_uint32_t *)allocator->allocate(allocator, (bytecode->size_of_code + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t size_of_code = 0;
+
+  for (scc_uint32_t offset = 0, index = 0; offset < bytecode->size_of_code; ) {
+    // Blocks that start with a run start with its `native`.
+    remapped[offset] = size_of_code;
+
+    if ((index < num_of_runs) && (runs[2 * index] == offset)) {
+      rewritten[size_of_code++] = SCC_IR_OPCODE_NATIVE;
+      rewritten[size_of_code++] = index;
+      rewritten[size_of_code++] = runs[2 * index + 1];
+      index += 1;
+    }
+
+    const scc_uint32_t length = scc_ir_bytecode_length(&code[offset]);
+
+    memcpy(&rewritten[size_of_code], &code[offset], length * sizeof(scc_uint32_t));
+
+    size_of_code += length;
+    offset += length;
+  }
+
+  for (scc_uint32_t position = 0; position < bytecode->num_of_reachable; ++position) {
+    const scc_uint32_t block = bytecode->order[position];
+    bytecode->blocks[block] = remapped[bytecode->blocks[block]];
+  }
+
+  heap->free(heap, (void *)bytecode->code);
+
+  bytecode->code = rewritten;
+  bytecode->size_of_code = size_of_code;
+
+  bytecode->natives =
+    (scc_ir_native_fn *)heap->allocate(heap, num_of_runs * sizeof(scc_ir_native_fn), 16);
+  bytecode->num_of_natives = num_of_runs;
+
+  for (scc_uint32_t index = 0; index < num_of_runs; ++index)
+    bytecode->natives[index] = (scc_ir_native_fn)((scc_uint8_t *)executable + entries[index]);
+
+  bytecode->size_of_frame += num_of_spills * SCC_IR_LANES;
+
+  heap->free(heap, (void *)runs);
+  scc_arena_destroy(arena);
+
+  scc_ir_jit_t *jit = (scc_ir_jit_t *)heap->allocate(heap, sizeof(scc_ir_jit_t), 16);
+
+  jit->code = executable;
+  jit->size_of_code = size;
+
+  return jit;
+#else
+  return NULL;
+#endif
+}
+
+void scc_ir_jit_destroy(scc_ir_jit_t *jit) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+#if SCC_IR_JIT
+  munmap(jit->code, jit->size_of_code);
+#endif
+
+  heap->free(heap, (void *)jit);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,168 @@
+//===-- scc/ir/layout.cc --------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/layout.h"
+
+SCC_BEGIN_EXTERN_C
+
+scc_ir_packing_t scc_ir_packing_of(scc_target_t target) {
+  switch (target) {
+    case SCC_TARGET_HOST: return SCC_IR_PACKING_TIGHT;
+    case SCC_TARGET_GLSL: return SCC_IR_PACKING_STD140;
+    case SCC_TARGET_HLSL: return SCC_IR_PACKING_HLSL;
+    case SCC_TARGET_SPIRV: return SCC_IR_PACKING_STD140;
+    case SCC_TARGET_MSL: return SCC_IR_PACKING_MSL;
+    default: break;
+  }
+
+  return SCC_IR_PACKING_TIGHT;
+}
+
+static scc_uint32_t scc_ir_layout_round(scc_uint32_t value,
+                                        scc_uint32_t alignment) {
+  return (value + alignment - 1) / alignment * alignment;
+}
+
+// Size of a scalar of `type`. Metal's booleans are bytes.
+static scc_uint32_t scc_ir_layout_scalar(scc_ir_packing_t packing,
+                                         scc_ir_type_t type) {
+  if ((type.scalar == SCC_IR_BOOL) && (packing == SCC_IR_PACKING_MSL))
+    return 1;
+
+  return scc_ir_scalar_size(type);
+}
+
+// Alignment of a column of `rows`, or of a vector, as laid out naturally.
+static scc_uint32_t scc_ir_layout_column(scc_uint32_t scalar,
+                                         scc_uint32_t rows) {
+  return scalar * ((rows <= 2) ? rows : 4);
+}
+
+scc_uint32_t scc_ir_layout_alignment(const scc_ir_module_t *module,
+                                     scc_ir_packing_t packing,
+                                     scc_ir_type_t type) {
+  scc_assert_paranoid(packing != SCC_IR_PACKING_TARGET);
+
+  if (type.scalar == SCC_IR_STRUCTURE) {
+    if ((packing == SCC_IR_PACKING_STD140) || (packing == SCC_IR_PACKING_HLSL) || (packing == SCC_IR_PACKING_MSL))
+      return 16;
+
+    const scc_ir_structure_t *structure = &module->structures[type.structure];
+
+    scc_uint32_t alignment = 1;
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member)
+      alignment = SCC_MAX(alignment, scc_ir_layout_alignment(module, packing, module->members[structure->first_member + member].type));
+
+    return alignment;
+  }
+
+  const scc_uint32_t scalar = scc_ir_layout_scalar(packing, type);
+
+  if (scc_ir_type_is_matrix(type)) {
+    if (packing == SCC_IR_PACKING_TIGHT)
+      return scalar;
+
+    return scc_ir_layout_stride(packing, type);
+  }
+
+  switch (packing) {
+    case SCC_IR_PACKING_TIGHT:
+    case SCC_IR_PACKING_HLSL:
+      return scalar;
+
+    case SCC_IR_PACKING_MSL:
+      return (type.rows == 3) ? scalar : scc_ir_layout_column(scalar, SCC_MAX((scc_uint32_t)type.rows, 1u));
+
+    default:
+      return scc_ir_layout_column(scalar, SCC_MAX((scc_uint32_t)type.rows, 1u));
+  }
+}
+
+scc_uint32_t scc_ir_layout_stride(scc_ir_packing_t packing,
+                                  scc_ir_type_t type) {
+  scc_assert_paranoid(packing != SCC_IR_PACKING_TARGET);
+
+  if (!scc_ir_type_is_matrix(type))
+    return 0;
+
+  const scc_uint32_t scalar = scc_ir_layout_scalar(packing, type);
+
+  switch (packing) {
+    case SCC_IR_PACKING_TIGHT:
+      return scalar * type.rows;
+
+    case SCC_IR_PACKING_STD430:
+    case SCC_IR_PACKING_MSL:
+      return scc_ir_layout_column(scalar, type.rows);
+
+    case SCC_IR_PACKING_HLSL:
+      return scc_ir_layout_round(scalar * type.rows, 16);
+
+    default:
+      return scc_ir_layout_round(scc_ir_layout_column(scalar, type.rows), 16);
+  }
+}
+
+scc_uint32_t scc_ir_layout_size(const scc_ir_module_t *module,
+                                scc_ir_packing_t packing,
+                                scc_ir_type_t type) {
+  scc_assert_paranoid(packing != SCC_IR_PACKING_TARGET);
+
+  if (type.scalar == SCC_IR_STRUCTURE) {
+    const scc_ir_structure_t *structure = &module->structures[type.structure];
+
+    scc_uint32_t size = 0;
+
+    for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+      const scc_ir_member_t *def = &module->members[structure->first_member + member];
+      size = SCC_MAX(size, def->offset + scc_ir_layout_size(module, packing, def->type));
+    }
+
+    // What follows a structure in HLSL can share its last register.
+    if (packing == SCC_IR_PACKING_HLSL)
+      return size;
+
+    return scc_ir_layout_round(size, scc_ir_layout_alignment(module, packing, type));
+  }
+
+  const scc_uint32_t scalar = scc_ir_layout_scalar(packing, type);
+
+  if (!scc_ir_type_is_matrix(type))
+    return scalar * SCC_MAX((scc_uint32_t)type.rows, 1u);
+
+  const scc_uint32_t stride = scc_ir_layout_stride(packing, type);
+
+  // Nor is the last column padded.
+  if (packing == SCC_IR_PACKING_HLSL)
+    return (type.columns - 1) * stride + scalar * type.rows;
+
+  return type.columns * stride;
+}
+
+scc_uint32_t scc_ir_layout_place(const scc_ir_module_t *module,
+                                 scc_ir_packing_t packing,
+                                 scc_ir_type_t type,
+                                 scc_uint32_t offset) {
+  offset = scc_ir_layout_round(offset, scc_ir_layout_alignment(module, packing, type));
+
+  if (packing == SCC_IR_PACKING_HLSL) {
+    // Anything that would straddle registers starts a register of its own.
+    if ((offset & 15) + scc_ir_layout_size(module, packing, type) > 16)
+      offset = scc_ir_layout_round(offset, 16);
+  }
+
+  return offset;
+}
+
+SCC_END_EXTERN_C
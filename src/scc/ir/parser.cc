@@ -179,23 +179,13 @@ static const scc_ir_type_def_t TYPES[] = {
 static const scc_uint32_t NUM_OF_TYPES =
   sizeof(TYPES) / sizeof(TYPES[0]);
 
-// REFACTOR(mtwilliams): Move into header.
-typedef enum scc_ir_operation {
-  #define OP(Mnemonic, Code, Inputs, Returns, Description) \
-    SCC_IR_OPERATION_##Code,
-
-    #include "scc/ir/operations.inl"
-
-  #undef OP
-} scc_ir_operation_t;
-
 typedef struct scc_ir_operation_def {
   const char *mnemonic;
   scc_ir_operation_t op;
 } scc_ir_operation_def_t;
 
 static const scc_ir_operation_def_t OPERATIONS[] = {
-  #define OP(Mnemonic, Code, Inputs, Returns, Description) \
+  #define OP(Mnemonic, Code, Inputs, Returns, Flags, Description) \
     { #Mnemonic, SCC_IR_OPERATION_##Code },
 
     #include "scc/ir/operations.inl"
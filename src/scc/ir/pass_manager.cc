@@ -0,0 +1,528 @@
+//===-- scc/ir/pass_manager.cc --------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/pass_manager.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef void *(*scc_ir_analysis_compute_fn)(scc_ir_pass_context_t *context,
+                                            scc_ir_function_t *function);
+
+typedef void (*scc_ir_analysis_destroy_fn)(void *result);
+
+typedef struct scc_ir_analysis_def {
+  const char *name;
+
+  // Analyses this is derived from, and thus invalidated with.
+  scc_ir_analyses_t depends;
+
+  scc_ir_analysis_compute_fn compute;
+  scc_ir_analysis_destroy_fn destroy;
+} scc_ir_analysis_def_t;
+
+static void *scc_ir_compute_cfg(scc_ir_pass_context_t *context,
+                                scc_ir_function_t *function) {
+  (void)context;
+  return (void *)scc_ir_cfg_compute(function);
+}
+
+static void *scc_ir_compute_dominators(scc_ir_pass_context_t *context,
+                                       scc_ir_function_t *function) {
+  return (void *)scc_ir_dominators_compute(function, scc_ir_get_cfg(context, function));
+}
+
+static void *scc_ir_compute_post_dominators(scc_ir_pass_context_t *context,
+                                            scc_ir_function_t *function) {
+  return (void *)scc_ir_post_dominators_compute(function, scc_ir_get_cfg(context, function));
+}
+
+static void *scc_ir_compute_loops(scc_ir_pass_context_t *context,
+                                  scc_ir_function_t *function) {
+  return (void *)scc_ir_loops_compute(function,
+                                      scc_ir_get_cfg(context, function),
+                                      scc_ir_get_dominators(context, function));
+}
+
+static void *scc_ir_compute_uses(scc_ir_pass_context_t *context,
+                                 scc_ir_function_t *function) {
+  (void)context;
+  return (void *)scc_ir_uses_compute(function);
+}
+
+static void *scc_ir_compute_liveness(scc_ir_pass_context_t *context,
+                                     scc_ir_function_t *function) {
+  return (void *)scc_ir_liveness_compute(function, scc_ir_get_cfg(context, function));
+}
+
+static void *scc_ir_compute_uniformity(scc_ir_pass_context_t *context,
+                                       scc_ir_function_t *function) {
+  return (void *)scc_ir_uniformity_compute(function, scc_ir_get_uses(context, function));
+}
+
+static void *scc_ir_compute_demanded(scc_ir_pass_context_t *context,
+                                     scc_ir_function_t *function) {
+  (void)context;
+  return (void *)scc_ir_demanded_compute(function);
+}
+
+static const scc_ir_analysis_def_t ANALYSES[SCC_IR_NUM_OF_ANALYSES] = {
+  { "cfg",
+    SCC_IR_PRESERVES_NOTHING,
+    &scc_ir_compute_cfg,
+    (scc_ir_analysis_destroy_fn)&scc_ir_cfg_destroy },
+
+  { "dominators",
+    SCC_IR_PRESERVES(SCC_IR_ANALYSIS_CFG),
+    &scc_ir_compute_dominators,
+    (scc_ir_analysis_destroy_fn)&scc_ir_dominators_destroy },
+
+  { "post-dominators",
+    SCC_IR_PRESERVES(SCC_IR_ANALYSIS_CFG),
+    &scc_ir_compute_post_dominators,
+    (scc_ir_analysis_destroy_fn)&scc_ir_dominators_destroy },
+
+  { "loops",
+    SCC_IR_PRESERVES(SCC_IR_ANALYSIS_CFG) | SCC_IR_PRESERVES(SCC_IR_ANALYSIS_DOMINATORS),
+    &scc_ir_compute_loops,
+    (scc_ir_analysis_destroy_fn)&scc_ir_loops_destroy },
+
+  { "uses",
+    SCC_IR_PRESERVES_NOTHING,
+    &scc_ir_compute_uses,
+    (scc_ir_analysis_destroy_fn)&scc_ir_uses_destroy },
+
+  { "liveness",
+    SCC_IR_PRESERVES(SCC_IR_ANALYSIS_CFG),
+    &scc_ir_compute_liveness,
+    (scc_ir_analysis_destroy_fn)&scc_ir_liveness_destroy },
+
+  { "uniformity",
+    SCC_IR_PRESERVES(SCC_IR_ANALYSIS_USES),
+    &scc_ir_compute_uniformity,
+    (scc_ir_analysis_destroy_fn)&scc_ir_uniformity_destroy },
+
+  { "demanded",
+    SCC_IR_PRESERVES_NOTHING,
+    &scc_ir_compute_demanded,
+    (scc_ir_analysis_destroy_fn)&scc_ir_demanded_destroy }
+};
+
+scc_ir_pass_manager_t *scc_ir_pass_manager_create(const scc_ir_pass_options_t *options) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_assert_paranoid(options != NULL);
+
+  scc_ir_pass_manager_t *manager =
+    (scc_ir_pass_manager_t *)heap->allocate(heap, sizeof(scc_ir_pass_manager_t), 16);
+
+  manager->options = *options;
+
+  manager->num_of_threads = options->threads ? options->threads : scc_num_of_cores();
+
+  if (manager->num_of_threads > 1)
+    manager->jobs = scc_job_system_create(manager->num_of_threads);
+
+  manager->threads =
+    (scc_ir_pass_thread_t *)heap->allocate(heap, manager->num_of_threads * sizeof(scc_ir_pass_thread_t), 16);
+
+  for (scc_uint32_t thread = 0; thread < manager->num_of_threads; ++thread)
+    manager->threads[thread].scratch = scc_arena_create(heap, 64 * 1024);
+
+  return manager;
+}
+
+static void scc_ir_pass_manager_flush(scc_ir_pass_manager_t *manager) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  for (scc_uint32_t function = 0; function < manager->num_of_caches; ++function) {
+    scc_ir_analysis_cache_t *cache = &manager->caches[function];
+
+    for (scc_uint32_t analysis = 0; analysis < SCC_IR_NUM_OF_ANALYSES; ++analysis)
+      if (cache->results[analysis])
+        ANALYSES[analysis].destroy(cache->results[analysis]);
+  }
+
+  if (manager->caches)
+    heap->free(heap, (void *)manager->caches);
+
+  manager->caches = NULL;
+  manager->num_of_caches = 0;
+  manager->module = NULL;
+}
+
+void scc_ir_pass_manager_destroy(scc_ir_pass_manager_t *manager) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_pass_manager_flush(manager);
+
+  if (manager->jobs)
+    scc_job_system_destroy(manager->jobs);
+
+  for (scc_uint32_t thread = 0; thread < manager->num_of_threads; ++thread)
+    scc_arena_destroy(manager->threads[thread].scratch);
+
+  heap->free(heap, (void *)manager->threads);
+
+  if (manager->passes)
+    heap->free(heap, (void *)manager->passes);
+  if (manager->statistics)
+    heap->free(heap, (void *)manager->statistics);
+
+  heap->free(heap, (void *)manager);
+}
+
+void scc_ir_pass_manager_add(scc_ir_pass_manager_t *manager,
+                             const scc_ir_pass_t *pass) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_assert_paranoid(pass != NULL);
+  scc_assert_paranoid(((pass->kind == SCC_IR_FUNCTION_PASS) && pass->run_on_function)
+                   || ((pass->kind == SCC_IR_MODULE_PASS) && pass->run_on_module));
+
+  if (manager->num_of_passes == manager->size_of_passes) {
+    const scc_uint32_t size = manager->size_of_passes ? manager->size_of_passes * 2 : 16;
+
+    const scc_ir_pass_t **passes =
+      (const scc_ir_pass_t **)heap->allocate(heap, size * sizeof(scc_ir_pass_t *), 16);
+    scc_ir_pass_statistics_t *statistics =
+      (scc_ir_pass_statistics_t *)heap->allocate(heap, size * sizeof(scc_ir_pass_statistics_t), 16);
+
+    if (manager->passes) {
+      memcpy((void *)passes, (const void *)manager->passes, manager->num_of_passes * sizeof(scc_ir_pass_t *));
+      memcpy(statistics, manager->statistics, manager->num_of_passes * sizeof(scc_ir_pass_statistics_t));
+      heap->free(heap, (void *)manager->passes);
+      heap->free(heap, (void *)manager->statistics);
+    }
+
+    manager->passes = passes;
+    manager->statistics = statistics;
+    manager->size_of_passes = size;
+  }
+
+  manager->passes[manager->num_of_passes] = pass;
+  manager->statistics[manager->num_of_passes].name = pass->name;
+
+  manager->num_of_passes += 1;
+}
+
+// Makes sure there is a cache for every function in `module`.
+static void scc_ir_pass_manager_prepare(scc_ir_pass_manager_t *manager,
+                                        scc_ir_module_t *module) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  if (manager->module != module)
+    scc_ir_pass_manager_flush(manager);
+
+  manager->module = module;
+
+  if (manager->num_of_caches >= module->num_of_functions)
+    return;
+
+  scc_ir_analysis_cache_t *caches =
+    (scc_ir_analysis_cache_t *)heap->allocate(heap, module->num_of_functions * sizeof(scc_ir_analysis_cache_t), 16);
+
+  if (manager->caches) {
+    memcpy(caches, manager->caches, manager->num_of_caches * sizeof(scc_ir_analysis_cache_t));
+    heap->free(heap, (void *)manager->caches);
+  }
+
+  manager->caches = caches;
+  manager->num_of_caches = module->num_of_functions;
+}
+
+// Expands a set of invalidated analyses to include those derived from them.
+static scc_ir_analyses_t scc_ir_analyses_derived_from(scc_ir_analyses_t invalidated) {
+  for (scc_bool_t expanded = SCC_TRUE; expanded; ) {
+    expanded = SCC_FALSE;
+
+    for (scc_uint32_t analysis = 0; analysis < SCC_IR_NUM_OF_ANALYSES; ++analysis) {
+      if (invalidated & SCC_IR_PRESERVES(analysis))
+        continue;
+
+      if (ANALYSES[analysis].depends & invalidated) {
+        invalidated |= SCC_IR_PRESERVES(analysis);
+        expanded = SCC_TRUE;
+      }
+    }
+  }
+
+  return invalidated;
+}
+
+void scc_ir_invalidate(scc_ir_pass_context_t *context,
+                       scc_ir_function_t *function,
+                       scc_ir_analyses_t preserved) {
+  scc_ir_pass_manager_t *manager = context->manager;
+
+  scc_assert_paranoid(function->index < manager->num_of_caches);
+
+  scc_ir_analysis_cache_t *cache = &manager->caches[function->index];
+
+  const scc_ir_analyses_t invalidated =
+    scc_ir_analyses_derived_from(SCC_IR_PRESERVES_EVERYTHING & ~preserved);
+
+  for (scc_uint32_t analysis = 0; analysis < SCC_IR_NUM_OF_ANALYSES; ++analysis) {
+    if (!(invalidated & SCC_IR_PRESERVES(analysis)))
+      continue;
+
+    if (cache->results[analysis]) {
+      ANALYSES[analysis].destroy(cache->results[analysis]);
+      cache->results[analysis] = NULL;
+    }
+  }
+
+  cache->valid &= ~invalidated;
+}
+
+const void *scc_ir_analysis(scc_ir_pass_context_t *context,
+                            scc_ir_function_t *function,
+                            scc_ir_analysis_t analysis) {
+  scc_ir_pass_manager_t *manager = context->manager;
+
+  scc_assert_paranoid(analysis < SCC_IR_NUM_OF_ANALYSES);
+  scc_assert_paranoid(function->index < manager->num_of_caches);
+
+  scc_ir_analysis_cache_t *cache = &manager->caches[function->index];
+
+  if (cache->valid & SCC_IR_PRESERVES(analysis))
+    return cache->results[analysis];
+
+  const scc_uint64_t started = scc_monotonic_time_in_ns();
+
+  void *result = ANALYSES[analysis].compute(context, function);
+
+  // Tallied per thread and merged after, to avoid contention.
+  context->thread->computations[analysis] += 1;
+  context->thread->computation_time[analysis] += scc_monotonic_time_in_ns() - started;
+
+  cache->results[analysis] = result;
+  cache->valid |= SCC_IR_PRESERVES(analysis);
+
+  return result;
+}
+
+// Outcome of running a pass on a function.
+typedef struct scc_ir_pass_outcome {
+  scc_bool_t ran;
+  scc_bool_t changed;
+  scc_uint64_t time;
+} scc_ir_pass_outcome_t;
+
+// Consecutive function passes, run over every function as a batch of jobs.
+typedef struct scc_ir_pass_stage {
+  scc_ir_pass_manager_t *manager;
+  scc_ir_module_t *module;
+
+  // Range of passes in the pipeline.
+  scc_uint32_t first;
+  scc_uint32_t last;
+
+  // Indexed by function then pass. Each function's outcomes are written by
+  // whichever thread runs it, and read only after the batch is done.
+  scc_ir_pass_outcome_t *outcomes;
+} scc_ir_pass_stage_t;
+
+static void scc_ir_pass_context_init(scc_ir_pass_context_t *context,
+                                     scc_ir_pass_manager_t *manager,
+                                     scc_ir_module_t *module,
+                                     scc_uint32_t thread) {
+  context->manager = manager;
+  context->module = module;
+  context->options = &manager->options;
+  context->scratch = &manager->threads[thread].scratch->allocator;
+  context->thread = &manager->threads[thread];
+}
+
+// Takes a function through every pass in a stage.
+static void scc_ir_pass_stage_run_on(void *context,
+                                     scc_uint32_t function,
+                                     scc_uint32_t thread) {
+  scc_ir_pass_stage_t *stage = (scc_ir_pass_stage_t *)context;
+  scc_ir_pass_manager_t *manager = stage->manager;
+
+  scc_ir_function_t *running_on = stage->module->functions[function];
+
+  if (running_on->removed)
+    return;
+
+  scc_ir_pass_context_t pass_context;
+  scc_ir_pass_context_init(&pass_context, manager, stage->module, thread);
+
+  scc_ir_pass_outcome_t *outcomes =
+    &stage->outcomes[function * (stage->last - stage->first)];
+
+  for (scc_uint32_t index = stage->first; index < stage->last; ++index) {
+    const scc_ir_pass_t *pass = manager->passes[index];
+    scc_ir_pass_outcome_t *outcome = &outcomes[index - stage->first];
+
+    const scc_uint64_t started = scc_monotonic_time_in_ns();
+
+    const scc_bool_t changed = pass->run_on_function(&pass_context, running_on);
+
+    if (changed)
+      scc_ir_invalidate(&pass_context, running_on, pass->preserves);
+
+    scc_arena_reset(manager->threads[thread].scratch);
+
+    outcome->ran = SCC_TRUE;
+    outcome->changed = changed;
+    outcome->time = scc_monotonic_time_in_ns() - started;
+  }
+}
+
+// Runs passes `[first, last)`, which must all be function passes.
+static scc_bool_t scc_ir_pass_manager_run_stage(scc_ir_pass_manager_t *manager,
+                                                scc_ir_module_t *module,
+                                                scc_uint32_t first,
+                                                scc_uint32_t last) {
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_ir_pass_stage_t stage;
+
+  stage.manager = manager;
+  stage.module = module;
+  stage.first = first;
+  stage.last = last;
+
+  const scc_uint32_t num_of_outcomes = module->num_of_functions * (last - first);
+
+  stage.outcomes =
+    (scc_ir_pass_outcome_t *)heap->allocate(heap, (num_of_outcomes + 1) * sizeof(scc_ir_pass_outcome_t), 16);
+
+  if (manager->jobs)
+    scc_job_system_for_each(manager->jobs, module->num_of_functions, &scc_ir_pass_stage_run_on, (void *)&stage);
+  else
+    for (scc_uint32_t function = 0; function < module->num_of_functions; ++function)
+      scc_ir_pass_stage_run_on((void *)&stage, function, 0);
+
+  scc_bool_t changed_anything = SCC_FALSE;
+
+  // Merge in order, so statistics don't depend on scheduling.
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function) {
+    for (scc_uint32_t index = first; index < last; ++index) {
+      const scc_ir_pass_outcome_t *outcome =
+        &stage.outcomes[function * (last - first) + (index - first)];
+
+      if (!outcome->ran)
+        continue;
+
+      scc_ir_pass_statistics_t *statistics = &manager->statistics[index];
+
+      statistics->runs += 1;
+      statistics->changes += outcome->changed ? 1 : 0;
+      statistics->time += outcome->time;
+
+      changed_anything |= outcome->changed;
+    }
+  }
+
+  heap->free(heap, (void *)stage.outcomes);
+
+  return changed_anything;
+}
+
+static scc_bool_t scc_ir_pass_manager_run_module_pass(scc_ir_pass_manager_t *manager,
+                                                      scc_ir_module_t *module,
+                                                      scc_uint32_t index) {
+  const scc_ir_pass_t *pass = manager->passes[index];
+  scc_ir_pass_statistics_t *statistics = &manager->statistics[index];
+
+  scc_ir_pass_context_t context;
+  scc_ir_pass_context_init(&context, manager, module, 0);
+
+  const scc_uint64_t started = scc_monotonic_time_in_ns();
+
+  const scc_bool_t changed = pass->run_on_module(&context, module);
+
+  scc_arena_reset(manager->threads[0].scratch);
+
+  // Module passes may add functions.
+  scc_ir_pass_manager_prepare(manager, module);
+
+  if (changed)
+    for (scc_uint32_t function = 0; function < module->num_of_functions; ++function)
+      scc_ir_invalidate(&context, module->functions[function], pass->preserves);
+
+  statistics->runs += 1;
+  statistics->changes += changed ? 1 : 0;
+  statistics->time += scc_monotonic_time_in_ns() - started;
+
+  return changed;
+}
+
+scc_bool_t scc_ir_pass_manager_run(scc_ir_pass_manager_t *manager,
+                                   scc_ir_module_t *module) {
+  scc_assert_paranoid(module != NULL);
+
+  scc_ir_pass_manager_prepare(manager, module);
+
+  scc_bool_t changed_anything = SCC_FALSE;
+
+  for (scc_uint32_t index = 0; index < manager->num_of_passes; ) {
+    if (manager->passes[index]->kind == SCC_IR_MODULE_PASS) {
+      changed_anything |= scc_ir_pass_manager_run_module_pass(manager, module, index);
+      index += 1;
+      continue;
+    }
+
+    scc_uint32_t last = index + 1;
+
+    while (last < manager->num_of_passes && manager->passes[last]->kind == SCC_IR_FUNCTION_PASS)
+      last += 1;
+
+    changed_anything |= scc_ir_pass_manager_run_stage(manager, module, index, last);
+
+    index = last;
+  }
+
+  // Fold per-thread tallies into the totals.
+  for (scc_uint32_t thread = 0; thread < manager->num_of_threads; ++thread) {
+    scc_ir_pass_thread_t *tallies = &manager->threads[thread];
+
+    for (scc_uint32_t analysis = 0; analysis < SCC_IR_NUM_OF_ANALYSES; ++analysis) {
+      manager->computations[analysis] += tallies->computations[analysis];
+      manager->computation_time[analysis] += tallies->computation_time[analysis];
+    }
+
+    memset(tallies->computations, 0, sizeof(tallies->computations));
+    memset(tallies->computation_time, 0, sizeof(tallies->computation_time));
+  }
+
+  return changed_anything;
+}
+
+void scc_ir_pass_manager_report(const scc_ir_pass_manager_t *manager,
+                                FILE *stream) {
+  fprintf(stream, "%-24s %10s %10s %14s\n", "pass", "runs", "changes", "time (us)");
+
+  for (scc_uint32_t index = 0; index < manager->num_of_passes; ++index) {
+    const scc_ir_pass_statistics_t *statistics = &manager->statistics[index];
+
+    fprintf(stream, "%-24s %10llu %10llu %14.3f\n",
+            statistics->name,
+            (unsigned long long)statistics->runs,
+            (unsigned long long)statistics->changes,
+            statistics->time / 1000.0);
+  }
+
+  fprintf(stream, "\n%-24s %10s %14s\n", "analysis", "computed", "time (us)");
+
+  for (scc_uint32_t analysis = 0; analysis < SCC_IR_NUM_OF_ANALYSES; ++analysis) {
+    fprintf(stream, "%-24s %10llu %14.3f\n",
+            ANALYSES[analysis].name,
+            (unsigned long long)manager->computations[analysis],
+            manager->computation_time[analysis] / 1000.0);
+  }
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,342 @@
+//===-- scc/ir/passes/dce.cc ----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_dce {
+  scc_ir_module_t *module;
+
+  scc_allocator_t *scratch;
+
+  // Indexed by function. Calls to a function that has effects, directly or
+  // through calls of its own, have to be kept even if the result isn't used.
+  scc_bool_t *effectful;
+} scc_ir_dce_t;
+
+static scc_bool_t scc_ir_dce_is_effectful_call(const scc_ir_dce_t *dce,
+                                               const scc_ir_function_t *function,
+                                               const scc_ir_instruction_t *call) {
+  const scc_ir_value_t callee = scc_ir_operand(function, call, 0);
+
+  // Assume the worst of anything unexpected.
+  if (SCC_IR_VALUE_KIND(callee) != SCC_IR_VALUE_FUNCTION)
+    return SCC_TRUE;
+  if (SCC_IR_VALUE_INDEX(callee) >= dce->module->num_of_functions)
+    return SCC_TRUE;
+
+  return dce->effectful[SCC_IR_VALUE_INDEX(callee)];
+}
+
+// Determines if `instruction` has to be kept regardless of its result being
+// used, i.e. it ends a block or has effects beyond producing its result.
+static scc_bool_t scc_ir_dce_is_root(const scc_ir_dce_t *dce,
+                                     const scc_ir_function_t *function,
+                                     const scc_ir_instruction_t *instruction) {
+  if (scc_ir_operation_is(instruction->op, SCC_IR_TERMINATOR))
+    return SCC_TRUE;
+
+  if (instruction->op == SCC_IR_OPERATION_CALL)
+    return scc_ir_dce_is_effectful_call(dce, function, instruction);
+
+  return scc_ir_operation_is(instruction->op, SCC_IR_SIDE_EFFECTS);
+}
+
+// Finds functions with effects, iterating to a fixed point so that effects
+// propagate up through (possibly recursive) calls.
+static void scc_ir_dce_find_effectful(scc_ir_dce_t *dce) {
+  scc_ir_module_t *module = dce->module;
+
+  for (scc_bool_t changed = SCC_TRUE; changed; ) {
+    changed = SCC_FALSE;
+
+    for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+      const scc_ir_function_t *function = module->functions[index];
+
+      if (function->removed || dce->effectful[index])
+        continue;
+
+      for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+        const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+        if (!scc_ir_instruction_is_live(instruction))
+          continue;
+
+        if (scc_ir_operation_is(instruction->op, SCC_IR_TERMINATOR))
+          continue;
+
+        if (scc_ir_dce_is_root(dce, function, instruction)) {
+          dce->effectful[index] = SCC_TRUE;
+          changed = SCC_TRUE;
+          break;
+        }
+      }
+    }
+  }
+}
+
+static scc_bool_t scc_ir_dce_reachable(const void *user,
+                                       scc_uint32_t from,
+                                       scc_uint32_t to) {
+  // Everything reachable flows everywhere it branches to.
+  (void)to;
+  return scc_ir_cfg_is_reachable((const scc_ir_cfg_t *)user, from);
+}
+
+// Removes blocks that can't be reached and incoming values from them.
+static scc_bool_t scc_ir_dce_remove_unreachable(scc_ir_dce_t *dce,
+                                                scc_ir_pass_context_t *context,
+                                                scc_ir_function_t *function) {
+  const scc_ir_cfg_t *cfg = scc_ir_get_cfg(context, function);
+
+  if (cfg->num_of_reachable == function->num_of_blocks)
+    return SCC_FALSE;
+
+  scc_allocator_t *scratch = dce->scratch;
+
+  // Zero is `SCC_IR_NO_VALUE`, i.e. not forwarded.
+  scc_ir_value_t *forwarding =
+    (scc_ir_value_t *)scratch->allocate(scratch, (function->num_of_instructions + 1) * sizeof(scc_ir_value_t), 16);
+
+  scc_bool_t changed = scc_ir_function_prune_phis(function, &scc_ir_dce_reachable, cfg, forwarding);
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    if (function->blocks[block].removed || scc_ir_cfg_is_reachable(cfg, block))
+      continue;
+
+    scc_ir_function_remove_block(function, block);
+
+    changed = SCC_TRUE;
+  }
+
+  return changed;
+}
+
+// Marks everything that roots depend on, then removes everything else.
+static scc_bool_t scc_ir_dce_sweep(scc_ir_dce_t *dce,
+                                   scc_ir_function_t *function) {
+  scc_allocator_t *scratch = dce->scratch;
+
+  const scc_uint32_t num_of_instructions = function->num_of_instructions;
+
+  scc_bool_t *marked =
+    (scc_bool_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_bool_t), 16);
+
+  // Each instruction is pushed at most once, when marked.
+  scc_uint32_t *worklist =
+    (scc_uint32_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t num_of_worklist = 0;
+
+  for (scc_uint32_t i = 0; i < num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    if (scc_ir_dce_is_root(dce, function, instruction)) {
+      marked[i] = SCC_TRUE;
+      worklist[num_of_worklist++] = i;
+    }
+  }
+
+  while (num_of_worklist) {
+    const scc_ir_instruction_t *instruction = &function->instructions[worklist[--num_of_worklist]];
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+        continue;
+
+      const scc_uint32_t used = SCC_IR_VALUE_INDEX(operands[operand]);
+
+      if (marked[used])
+        continue;
+
+      marked[used] = SCC_TRUE;
+      worklist[num_of_worklist++] = used;
+    }
+  }
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t i = 0; i < num_of_instructions; ++i) {
+    if (marked[i] || !scc_ir_instruction_is_live(&function->instructions[i]))
+      continue;
+
+    scc_ir_function_remove(function, i);
+
+    changed = SCC_TRUE;
+  }
+
+  return changed;
+}
+
+// Marks functions reachable from the entry point, or what precomputes for it,
+// through calls.
+static void scc_ir_dce_mark_called(const scc_ir_dce_t *dce,
+                                   scc_bool_t *called) {
+  const scc_ir_module_t *module = dce->module;
+
+  scc_uint32_t *worklist =
+    (scc_uint32_t *)dce->scratch->allocate(dce->scratch, (module->num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t num_of_worklist = 0;
+
+  called[module->entry] = SCC_TRUE;
+  worklist[num_of_worklist++] = module->entry;
+
+  // Run by the host rather than called.
+  if (module->precompute != SCC_IR_NONE) {
+    called[module->precompute] = SCC_TRUE;
+    worklist[num_of_worklist++] = module->precompute;
+  }
+
+  while (num_of_worklist) {
+    const scc_ir_function_t *function = module->functions[worklist[--num_of_worklist]];
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (!scc_ir_instruction_is_live(instruction))
+        continue;
+
+      const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+      for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+        if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_FUNCTION)
+          continue;
+
+        const scc_uint32_t callee = SCC_IR_VALUE_INDEX(operands[operand]);
+
+        if (called[callee] || module->functions[callee]->removed)
+          continue;
+
+        called[callee] = SCC_TRUE;
+        worklist[num_of_worklist++] = callee;
+      }
+    }
+  }
+}
+
+// Removes functions that can't be called. Without an entry point, every
+// function is assumed to be callable.
+static scc_bool_t scc_ir_dce_remove_uncalled(scc_ir_dce_t *dce) {
+  scc_ir_module_t *module = dce->module;
+
+  if (module->entry == SCC_IR_NONE)
+    return SCC_FALSE;
+
+  scc_bool_t *called =
+    (scc_bool_t *)dce->scratch->allocate(dce->scratch, (module->num_of_functions + 1) * sizeof(scc_bool_t), 16);
+
+  scc_ir_dce_mark_called(dce, called);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function) {
+    if (called[function] || module->functions[function]->removed)
+      continue;
+
+    scc_ir_module_remove_function(module, function);
+
+    changed = SCC_TRUE;
+  }
+
+  return changed;
+}
+
+// Removes inputs, constants, and textures that aren't referenced. Outputs are
+// part of the interface regardless, so they're kept.
+static scc_bool_t scc_ir_dce_remove_unreferenced(scc_ir_dce_t *dce) {
+  scc_ir_module_t *module = dce->module;
+
+  if (module->num_of_globals == 0)
+    return SCC_FALSE;
+
+  scc_bool_t *removing =
+    (scc_bool_t *)dce->scratch->allocate(dce->scratch, module->num_of_globals * sizeof(scc_bool_t), 16);
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+    removing[global] = (module->globals[global].storage != SCC_IR_OUTPUT);
+
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    const scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed)
+      continue;
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (!scc_ir_instruction_is_live(instruction))
+        continue;
+
+      const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+      for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+        if (SCC_IR_VALUE_KIND(operands[operand]) == SCC_IR_VALUE_GLOBAL)
+          removing[SCC_IR_VALUE_INDEX(operands[operand])] = SCC_FALSE;
+    }
+  }
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+    changed |= removing[global];
+
+  if (changed)
+    scc_ir_module_remove_globals(module, removing);
+
+  return changed;
+}
+
+static scc_bool_t scc_ir_dce_run(scc_ir_pass_context_t *context,
+                                 scc_ir_module_t *module) {
+  scc_ir_dce_t dce;
+
+  dce.module = module;
+  dce.scratch = context->scratch;
+  dce.effectful =
+    (scc_bool_t *)dce.scratch->allocate(dce.scratch, (module->num_of_functions + 1) * sizeof(scc_bool_t), 16);
+
+  scc_ir_dce_find_effectful(&dce);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed || function->num_of_blocks == 0)
+      continue;
+
+    changed |= scc_ir_dce_remove_unreachable(&dce, context, function);
+    changed |= scc_ir_dce_sweep(&dce, function);
+    changed |= (scc_ir_function_remove_unused_constants(function) != 0);
+  }
+
+  // Only now that dead calls are gone.
+  changed |= scc_ir_dce_remove_uncalled(&dce);
+  changed |= scc_ir_dce_remove_unreferenced(&dce);
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_DCE_PASS = {
+  "dce",
+  SCC_IR_MODULE_PASS,
+  SCC_IR_PRESERVES_NOTHING,
+  NULL,
+  &scc_ir_dce_run
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,270 @@
+//===-- scc/ir/passes/gvn.cc ----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Values are numbered walking the dominator tree, with a hash table scoped to
+// it: everything available in a block was computed by one of its dominators,
+// so an equivalent computation can reuse it. Entries are chained through
+// `next` and pushed onto the front of their bucket, so leaving a block just
+// pops what it added in reverse.
+typedef struct scc_ir_gvn {
+  const scc_ir_module_t *module;
+  scc_ir_function_t *function;
+
+  // Indexed by hash masked by `mask`.
+  scc_uint32_t *buckets;
+  scc_uint32_t mask;
+
+  // Indexed by instruction.
+  scc_uint32_t *hashes;
+  scc_uint32_t *next;
+  scc_ir_value_t *forwarding;
+
+  // Instructions added to the table, in order, to be popped when leaving the
+  // blocks that added them.
+  scc_uint32_t *available;
+  scc_uint32_t num_of_available;
+} scc_ir_gvn_t;
+
+static scc_ir_value_t scc_ir_gvn_resolve(const scc_ir_gvn_t *gvn,
+                                         scc_ir_value_t value) {
+  while ((SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION)
+      && (gvn->forwarding[SCC_IR_VALUE_INDEX(value)] != SCC_IR_NO_VALUE))
+    value = gvn->forwarding[SCC_IR_VALUE_INDEX(value)];
+  return value;
+}
+
+// Determines if `instruction` always produces the same result given the
+// same operands, and thus can be numbered.
+static scc_bool_t scc_ir_gvn_is_numberable(const scc_ir_gvn_t *gvn,
+                                           const scc_ir_instruction_t *instruction) {
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_LOAD: {
+      // Outputs can be stored to in between.
+      const scc_ir_value_t pointer = scc_ir_operand(gvn->function, instruction, 0);
+
+      if (SCC_IR_VALUE_KIND(pointer) != SCC_IR_VALUE_GLOBAL)
+        return SCC_FALSE;
+
+      return (gvn->module->globals[SCC_IR_VALUE_INDEX(pointer)].storage != SCC_IR_OUTPUT);
+    }
+
+    // Textures are read-only.
+    case SCC_IR_OPERATION_FETCH:
+    case SCC_IR_OPERATION_GATHER:
+      return SCC_TRUE;
+  }
+
+  return scc_ir_operation_is(instruction->op, SCC_IR_FOLDABLE);
+}
+
+// Operands of `instruction` in canonical order, i.e. with commutative
+// operands sorted.
+static void scc_ir_gvn_operands(const scc_ir_gvn_t *gvn,
+                                const scc_ir_instruction_t *instruction,
+                                scc_ir_value_t *operands) {
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+    operands[operand] = scc_ir_gvn_resolve(gvn, scc_ir_operand(gvn->function, instruction, operand));
+
+  if ((instruction->num_of_operands < 2) || (operands[0] <= operands[1]))
+    return;
+
+  if (scc_ir_instruction_is_commutative(gvn->function, instruction)) {
+    const scc_ir_value_t swapped = operands[0];
+    operands[0] = operands[1];
+    operands[1] = swapped;
+  }
+}
+
+static scc_uint32_t scc_ir_gvn_hash(const scc_ir_instruction_t *instruction,
+                                    const scc_ir_value_t *operands) {
+  scc_uint32_t hash = 2166136261u;
+
+  hash = (hash ^ instruction->op) * 16777619u;
+  hash = (hash ^ instruction->type.scalar) * 16777619u;
+  hash = (hash ^ instruction->type.rows) * 16777619u;
+  hash = (hash ^ instruction->type.columns) * 16777619u;
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+    hash = (hash ^ operands[operand]) * 16777619u;
+
+  return hash;
+}
+
+// Finds an available instruction equivalent to `instruction`.
+static scc_uint32_t scc_ir_gvn_lookup(const scc_ir_gvn_t *gvn,
+                                     const scc_ir_instruction_t *instruction,
+                                     const scc_ir_value_t *operands,
+                                     scc_uint32_t hash) {
+  const scc_ir_function_t *function = gvn->function;
+
+  scc_ir_value_t candidate_operands[16];
+
+  for (scc_uint32_t candidate = gvn->buckets[hash & gvn->mask]; candidate != SCC_IR_NONE; candidate = gvn->next[candidate]) {
+    const scc_ir_instruction_t *available = &function->instructions[candidate];
+
+    if (gvn->hashes[candidate] != hash)
+      continue;
+
+    if (available->op != instruction->op)
+      continue;
+    if (!scc_ir_type_is_equal(available->type, instruction->type))
+      continue;
+    if (available->num_of_operands != instruction->num_of_operands)
+      continue;
+
+    scc_ir_gvn_operands(gvn, available, candidate_operands);
+
+    if (memcmp(candidate_operands, operands, instruction->num_of_operands * sizeof(scc_ir_value_t)) == 0)
+      return candidate;
+  }
+
+  return SCC_IR_NONE;
+}
+
+static void scc_ir_gvn_number(scc_ir_gvn_t *gvn,
+                              scc_uint32_t block) {
+  const scc_ir_function_t *function = gvn->function;
+
+  for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_gvn_is_numberable(gvn, instruction))
+      continue;
+
+    // Everything numbered has a handful of operands at most.
+    if ((instruction->num_of_operands == 0) || (instruction->num_of_operands > 16))
+      continue;
+
+    scc_ir_value_t operands[16];
+
+    scc_ir_gvn_operands(gvn, instruction, operands);
+
+    const scc_uint32_t hash = scc_ir_gvn_hash(instruction, operands);
+    const scc_uint32_t available = scc_ir_gvn_lookup(gvn, instruction, operands, hash);
+
+    if (available != SCC_IR_NONE) {
+      gvn->forwarding[i] = SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, available);
+      continue;
+    }
+
+    gvn->hashes[i] = hash;
+    gvn->next[i] = gvn->buckets[hash & gvn->mask];
+    gvn->buckets[hash & gvn->mask] = i;
+
+    gvn->available[gvn->num_of_available++] = i;
+  }
+}
+
+// Pops everything made available after `mark`.
+static void scc_ir_gvn_unwind(scc_ir_gvn_t *gvn,
+                              scc_uint32_t mark) {
+  while (gvn->num_of_available > mark) {
+    const scc_uint32_t instruction = gvn->available[--gvn->num_of_available];
+    gvn->buckets[gvn->hashes[instruction] & gvn->mask] = gvn->next[instruction];
+  }
+}
+
+static scc_bool_t scc_ir_gvn_run(scc_ir_pass_context_t *context,
+                                 scc_ir_function_t *function) {
+  if (function->num_of_blocks == 0)
+    return SCC_FALSE;
+
+  const scc_ir_dominators_t *dominators = scc_ir_get_dominators(context, function);
+
+  scc_allocator_t *scratch = context->scratch;
+
+  const scc_uint32_t num_of_instructions = function->num_of_instructions;
+  const scc_uint32_t num_of_blocks = function->num_of_blocks;
+
+  scc_uint32_t num_of_buckets = 16;
+  while (num_of_buckets < num_of_instructions * 2)
+    num_of_buckets *= 2;
+
+  scc_ir_gvn_t gvn;
+
+  gvn.module = function->module;
+  gvn.function = function;
+
+  gvn.buckets = (scc_uint32_t *)scratch->allocate(scratch, num_of_buckets * sizeof(scc_uint32_t), 16);
+  gvn.mask = num_of_buckets - 1;
+
+  memset(gvn.buckets, 0xff, num_of_buckets * sizeof(scc_uint32_t));
+
+  gvn.hashes = (scc_uint32_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  gvn.next = (scc_uint32_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  gvn.forwarding = (scc_ir_value_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_ir_value_t), 16);
+
+  gvn.available = (scc_uint32_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  gvn.num_of_available = 0;
+
+  // Walk the tree depth first. Each block is pushed twice: once to enter it,
+  // and again, beneath its children, to leave it.
+  scc_uint32_t *blocks = (scc_uint32_t *)scratch->allocate(scratch, 2 * (num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t *marks = (scc_uint32_t *)scratch->allocate(scratch, (num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+  scc_bool_t *entered = (scc_bool_t *)scratch->allocate(scratch, (num_of_blocks + 1) * sizeof(scc_bool_t), 16);
+
+  scc_uint32_t num_of_pending = 0;
+  blocks[num_of_pending++] = 0;
+
+  while (num_of_pending) {
+    const scc_uint32_t block = blocks[--num_of_pending];
+
+    if (entered[block]) {
+      scc_ir_gvn_unwind(&gvn, marks[block]);
+      continue;
+    }
+
+    entered[block] = SCC_TRUE;
+    marks[block] = gvn.num_of_available;
+
+    scc_ir_gvn_number(&gvn, block);
+
+    blocks[num_of_pending++] = block;
+
+    const scc_uint32_t *children = scc_ir_dominators_children(dominators, block);
+    const scc_uint32_t num_of_children = scc_ir_dominators_num_of_children(dominators, block);
+
+    for (scc_uint32_t child = 0; child < num_of_children; ++child)
+      blocks[num_of_pending++] = children[child];
+  }
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t i = 0; i < num_of_instructions; ++i)
+    changed |= (gvn.forwarding[i] != SCC_IR_NO_VALUE);
+
+  if (!changed)
+    return SCC_FALSE;
+
+  scc_ir_function_forward(function, gvn.forwarding);
+
+  for (scc_uint32_t i = 0; i < num_of_instructions; ++i)
+    if (gvn.forwarding[i] != SCC_IR_NO_VALUE)
+      scc_ir_function_remove(function, i);
+
+  return SCC_TRUE;
+}
+
+const scc_ir_pass_t SCC_IR_GVN_PASS = {
+  "gvn",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  &scc_ir_gvn_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,446 @@
+//===-- scc/ir/passes/hoist_uniforms.cc -----------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+#include <stdio.h>
+
+SCC_BEGIN_EXTERN_C
+
+// Computations that read constants and nothing else are moved out of the
+// entry point into `scc_ir_module_t::precompute`, which stores each result
+// to a new loose constant for the entry point to load instead.
+typedef struct scc_ir_hoister {
+  scc_ir_module_t *module;
+  scc_ir_function_t *function;
+
+  const scc_ir_uniformity_t *uniformity;
+  const scc_ir_uses_t *uses;
+
+  // Indexed by instruction.
+  scc_bool_t *extractable;
+  scc_bool_t *reads;
+  scc_uint8_t *work;
+  scc_bool_t *needed;
+  scc_ir_value_t *clones;
+
+  // Instructions in an order where definitions precede uses.
+  scc_uint32_t *order;
+  scc_uint32_t num_of_ordered;
+
+  scc_ir_function_t *precompute;
+
+  // Instruction that clones are inserted before, or `SCC_IR_NONE` to append.
+  scc_uint32_t before;
+} scc_ir_hoister_t;
+
+// Number of operations a computation must save to be worth a load.
+static const scc_uint8_t SCC_IR_HOIST_UNIFORMS_MINIMUM_WORK = 2;
+
+// Determines if `instruction` can be computed by the host, given its
+// operands can be.
+static scc_bool_t scc_ir_hoister_is_computable(const scc_ir_hoister_t *hoister,
+                                               const scc_ir_instruction_t *instruction) {
+  const scc_ir_function_t *function = hoister->function;
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_LOAD: {
+      const scc_ir_value_t pointer = scc_ir_operand(function, instruction, 0);
+
+      if (SCC_IR_VALUE_KIND(pointer) != SCC_IR_VALUE_GLOBAL)
+        return SCC_FALSE;
+
+      return (hoister->module->globals[SCC_IR_VALUE_INDEX(pointer)].storage == SCC_IR_CONSTANT);
+    }
+
+    // The shader may never have divided by zero.
+    case SCC_IR_OPERATION_DIVIDE:
+      if (!scc_ir_type_is_floating_point(instruction->type))
+        return SCC_FALSE;
+      break;
+  }
+
+  // Textures can't be sampled ahead of time, even at uniform coordinates.
+  return scc_ir_operation_is(instruction->op, SCC_IR_FOLDABLE);
+}
+
+static void scc_ir_hoister_classify(scc_ir_hoister_t *hoister,
+                                    scc_uint32_t i) {
+  const scc_ir_function_t *function = hoister->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+  if (!scc_ir_is_uniform(hoister->uniformity, SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, i)))
+    return;
+
+  if (!scc_ir_hoister_is_computable(hoister, instruction))
+    return;
+
+  const scc_bool_t load = (instruction->op == SCC_IR_OPERATION_LOAD);
+
+  scc_bool_t reads = load;
+  scc_uint32_t work = load ? 0 : 1;
+
+  // Operations on matrices are as good as several on vectors.
+  if (!load && scc_ir_type_is_matrix(instruction->type))
+    work = SCC_IR_HOIST_UNIFORMS_MINIMUM_WORK;
+
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    const scc_ir_value_t value = operands[operand];
+
+    switch (SCC_IR_VALUE_KIND(value)) {
+      case SCC_IR_VALUE_INSTRUCTION:
+        if (!hoister->extractable[SCC_IR_VALUE_INDEX(value)])
+          return;
+        reads |= hoister->reads[SCC_IR_VALUE_INDEX(value)];
+        work += hoister->work[SCC_IR_VALUE_INDEX(value)];
+        break;
+
+      case SCC_IR_VALUE_CONSTANT:
+        if (!load && scc_ir_type_is_matrix(scc_ir_value_constant(function, value)->type))
+          work = SCC_IR_HOIST_UNIFORMS_MINIMUM_WORK;
+        break;
+
+      case SCC_IR_VALUE_GLOBAL:
+      case SCC_IR_VALUE_MEMBER:
+      case SCC_IR_VALUE_IMMEDIATE:
+      case SCC_IR_VALUE_UNDEFINED:
+        break;
+
+      default:
+        return;
+    }
+  }
+
+  hoister->extractable[i] = SCC_TRUE;
+  hoister->reads[i] = reads;
+  hoister->work[i] = (scc_uint8_t)((work < SCC_IR_HOIST_UNIFORMS_MINIMUM_WORK) ? work : SCC_IR_HOIST_UNIFORMS_MINIMUM_WORK);
+}
+
+// Determines if `i` is the result of a computation worth hoisting that's
+// used by something that can't be hoisted along with it.
+static scc_bool_t scc_ir_hoister_is_root(const scc_ir_hoister_t *hoister,
+                                         scc_uint32_t i) {
+  const scc_ir_instruction_t *instruction = &hoister->function->instructions[i];
+
+  if (!hoister->extractable[i] || !hoister->reads[i])
+    return SCC_FALSE;
+
+  if (hoister->work[i] < SCC_IR_HOIST_UNIFORMS_MINIMUM_WORK)
+    return SCC_FALSE;
+
+  if (instruction->type.scalar == SCC_IR_STRUCTURE)
+    return SCC_FALSE;
+
+  const scc_uint32_t *users = scc_ir_users(hoister->uses, i);
+  const scc_uint32_t num_of_users = hoister->uses->counts[i];
+
+  for (scc_uint32_t user = 0; user < num_of_users; ++user)
+    if (!hoister->extractable[users[user]])
+      return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+// Marks everything `root` is computed from as needed.
+static void scc_ir_hoister_need(scc_ir_hoister_t *hoister,
+                                scc_uint32_t root,
+                                scc_uint32_t *worklist) {
+  const scc_ir_function_t *function = hoister->function;
+
+  scc_uint32_t num_of_worklist = 0;
+
+  if (hoister->needed[root])
+    return;
+
+  hoister->needed[root] = SCC_TRUE;
+  worklist[num_of_worklist++] = root;
+
+  while (num_of_worklist) {
+    const scc_ir_instruction_t *instruction = &function->instructions[worklist[--num_of_worklist]];
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+        continue;
+
+      const scc_uint32_t used = SCC_IR_VALUE_INDEX(operands[operand]);
+
+      if (hoister->needed[used])
+        continue;
+
+      hoister->needed[used] = SCC_TRUE;
+      worklist[num_of_worklist++] = used;
+    }
+  }
+}
+
+static scc_ir_value_t scc_ir_hoister_emit(scc_ir_hoister_t *hoister,
+                                          scc_ir_operation_t op,
+                                          scc_ir_type_t type,
+                                          const scc_ir_value_t *operands,
+                                          scc_uint32_t num_of_operands) {
+  if (hoister->before == SCC_IR_NONE)
+    return scc_ir_function_append(hoister->precompute, 0, op, type, operands, num_of_operands);
+  else
+    return scc_ir_function_insert(hoister->precompute, hoister->before, op, type, operands, num_of_operands);
+}
+
+// Finds or creates the function to hoist into, and where in it.
+static void scc_ir_hoister_prepare(scc_ir_hoister_t *hoister) {
+  scc_ir_module_t *module = hoister->module;
+
+  if (module->precompute != SCC_IR_NONE) {
+    hoister->precompute = module->functions[module->precompute];
+    hoister->before = hoister->precompute->blocks[0].last;
+    return;
+  }
+
+  char name[256];
+  snprintf(name, sizeof(name), "%s.precompute", scc_ir_module_string(module, hoister->function->name));
+
+  hoister->precompute = scc_ir_module_add_function(module, name, scc_ir_void());
+  hoister->before = SCC_IR_NONE;
+
+  scc_ir_function_add_block(hoister->precompute, "entry");
+
+  module->precompute = hoister->precompute->index;
+}
+
+static scc_ir_value_t scc_ir_hoister_clone_operand(scc_ir_hoister_t *hoister,
+                                                   scc_ir_value_t value) {
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION:
+      return hoister->clones[SCC_IR_VALUE_INDEX(value)];
+
+    case SCC_IR_VALUE_CONSTANT:
+      return scc_ir_function_constant(hoister->precompute, scc_ir_value_constant(hoister->function, value));
+
+    default:
+      return value;
+  }
+}
+
+static void scc_ir_hoister_clone(scc_ir_hoister_t *hoister,
+                                 scc_uint32_t i) {
+  const scc_ir_function_t *function = hoister->function;
+  const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+  scc_ir_value_t operands[16];
+
+  scc_assert_debug(instruction->num_of_operands <= 16);
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand)
+    operands[operand] = scc_ir_hoister_clone_operand(hoister, scc_ir_operand(function, instruction, operand));
+
+  hoister->clones[i] = scc_ir_hoister_emit(hoister,
+                                           (scc_ir_operation_t)instruction->op,
+                                           instruction->type,
+                                           operands,
+                                           instruction->num_of_operands);
+}
+
+static scc_bool_t scc_ir_hoister_is_taken(const scc_ir_module_t *module,
+                                          const char *name) {
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+    if (strcmp(scc_ir_module_string(module, module->globals[global].name), name) == 0)
+      return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+// Names what's derived from `root` after the first constant it reads and
+// what's done with it, like `scale.add`, made unique among globals.
+static void scc_ir_hoister_name(const scc_ir_hoister_t *hoister,
+                                scc_uint32_t root,
+                                char *name,
+                                scc_size_t size) {
+  const scc_ir_module_t *module = hoister->module;
+  const scc_ir_function_t *function = hoister->function;
+
+  // Follow whatever reads constants down to a load of one.
+  scc_uint32_t i = root;
+
+  while (function->instructions[i].op != SCC_IR_OPERATION_LOAD) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+        continue;
+
+      if (hoister->reads[SCC_IR_VALUE_INDEX(operands[operand])]) {
+        i = SCC_IR_VALUE_INDEX(operands[operand]);
+        break;
+      }
+    }
+  }
+
+  const scc_ir_instruction_t *load = &function->instructions[i];
+
+  const scc_ir_value_t pointer = scc_ir_operand(function, load, 0);
+  const scc_ir_value_t member = scc_ir_operand(function, load, 1);
+
+  const scc_ir_string_t read = (SCC_IR_VALUE_KIND(member) == SCC_IR_VALUE_MEMBER)
+                             ? module->members[SCC_IR_VALUE_INDEX(member)].name
+                             : module->globals[SCC_IR_VALUE_INDEX(pointer)].name;
+
+  const int length = snprintf(name, size, "%s.%s",
+                              scc_ir_module_string(module, read),
+                              SCC_IR_OPERATIONS[function->instructions[root].op].mnemonic);
+
+  const scc_size_t stem = SCC_MIN((scc_size_t)length, size - 16);
+
+  for (scc_uint32_t n = 2; scc_ir_hoister_is_taken(module, name); ++n)
+    snprintf(&name[stem], size - stem, ".%u", n);
+}
+
+// Returns where the implicit constant buffer that loose constants share ends.
+static scc_uint32_t scc_ir_hoister_end_of_loose(const scc_ir_module_t *module,
+                                                scc_ir_packing_t packing) {
+  scc_uint32_t end = 0;
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global) {
+    const scc_ir_global_t *g = &module->globals[global];
+
+    if ((g->storage != SCC_IR_CONSTANT) || (g->type.scalar == SCC_IR_STRUCTURE))
+      continue;
+
+    end = SCC_MAX(end, g->offset + scc_ir_layout_size(module, packing, g->type));
+  }
+
+  return end;
+}
+
+static scc_bool_t scc_ir_hoist_uniforms_run(scc_ir_pass_context_t *context,
+                                            scc_ir_module_t *module) {
+  if (module->entry == SCC_IR_NONE)
+    return SCC_FALSE;
+
+  scc_ir_function_t *function = module->functions[module->entry];
+
+  if (function->num_of_blocks == 0)
+    return SCC_FALSE;
+
+  scc_allocator_t *scratch = context->scratch;
+
+  const scc_ir_cfg_t *cfg = scc_ir_get_cfg(context, function);
+
+  scc_ir_hoister_t hoister;
+
+  hoister.module = module;
+  hoister.function = function;
+  hoister.uniformity = scc_ir_get_uniformity(context, function);
+  hoister.uses = scc_ir_get_uses(context, function);
+
+  const scc_uint32_t n = function->num_of_instructions;
+
+  hoister.extractable = (scc_bool_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_bool_t), 16);
+  hoister.reads = (scc_bool_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_bool_t), 16);
+  hoister.work = (scc_uint8_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint8_t), 16);
+  hoister.needed = (scc_bool_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_bool_t), 16);
+  hoister.clones = (scc_ir_value_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_ir_value_t), 16);
+
+  hoister.order = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  hoister.num_of_ordered = 0;
+
+  // Definitions dominate uses, other than through a `phi`, which is never
+  // hoisted.
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      hoister.order[hoister.num_of_ordered++] = i;
+      scc_ir_hoister_classify(&hoister, i);
+    }
+  }
+
+  scc_uint32_t *roots = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t num_of_roots = 0;
+
+  for (scc_uint32_t position = 0; position < hoister.num_of_ordered; ++position)
+    if (scc_ir_hoister_is_root(&hoister, hoister.order[position]))
+      roots[num_of_roots++] = hoister.order[position];
+
+  if (num_of_roots == 0)
+    return SCC_FALSE;
+
+  scc_uint32_t *worklist = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t root = 0; root < num_of_roots; ++root)
+    scc_ir_hoister_need(&hoister, roots[root], worklist);
+
+  scc_ir_hoister_prepare(&hoister);
+
+  for (scc_uint32_t position = 0; position < hoister.num_of_ordered; ++position)
+    if (hoister.needed[hoister.order[position]])
+      scc_ir_hoister_clone(&hoister, hoister.order[position]);
+
+  scc_ir_value_t *loads = (scc_ir_value_t *)scratch->allocate(scratch, (num_of_roots + 1) * sizeof(scc_ir_value_t), 16);
+
+  scc_ir_packing_t packing = context->options->packing;
+
+  if (packing == SCC_IR_PACKING_TARGET)
+    packing = scc_ir_packing_of(context->options->target);
+
+  // Derived constants are placed after every other loose constant.
+  scc_uint32_t end = scc_ir_hoister_end_of_loose(module, packing);
+
+  for (scc_uint32_t root = 0; root < num_of_roots; ++root) {
+    const scc_ir_type_t type = function->instructions[roots[root]].type;
+
+    char name[256];
+    scc_ir_hoister_name(&hoister, roots[root], name, sizeof(name));
+
+    const scc_uint32_t global = scc_ir_module_add_global(module, name, SCC_IR_CONSTANT, type, SCC_IR_NONE);
+
+    module->globals[global].offset = scc_ir_layout_place(module, packing, type, end);
+    end = module->globals[global].offset + scc_ir_layout_size(module, packing, type);
+
+    const scc_ir_value_t derived = SCC_IR_VALUE(SCC_IR_VALUE_GLOBAL, global);
+
+    const scc_ir_value_t stored[2] = { derived, hoister.clones[roots[root]] };
+    scc_ir_hoister_emit(&hoister, SCC_IR_OPERATION_STORE, scc_ir_void(), stored, 2);
+
+    loads[root] = scc_ir_function_insert(function, roots[root], SCC_IR_OPERATION_LOAD, type, &derived, 1);
+  }
+
+  if (hoister.before == SCC_IR_NONE)
+    scc_ir_function_append(hoister.precompute, 0, SCC_IR_OPERATION_RETURN, scc_ir_void(), NULL, 0);
+
+  // Sized after inserting loads, since every instruction is visited.
+  scc_ir_value_t *forwarding =
+    (scc_ir_value_t *)scratch->allocate(scratch, (function->num_of_instructions + 1) * sizeof(scc_ir_value_t), 16);
+
+  for (scc_uint32_t root = 0; root < num_of_roots; ++root)
+    forwarding[roots[root]] = loads[root];
+
+  scc_ir_function_forward(function, forwarding);
+
+  // What roots were computed from is left for `SCC_IR_DCE_PASS`.
+  for (scc_uint32_t root = 0; root < num_of_roots; ++root)
+    scc_ir_function_remove(function, roots[root]);
+
+  return SCC_TRUE;
+}
+
+const scc_ir_pass_t SCC_IR_HOIST_UNIFORMS_PASS = {
+  "hoist-uniforms",
+  SCC_IR_MODULE_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  NULL,
+  &scc_ir_hoist_uniforms_run
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,444 @@
+//===-- scc/ir/passes/inline.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Used when `scc_ir_pass_options_t::inline_threshold` is zero.
+static const scc_uint32_t SCC_IR_DEFAULT_INLINE_THRESHOLD = 64;
+
+// Credited for each argument that is a constant, as that likely lets much of
+// the inlined body be folded.
+static const scc_uint32_t SCC_IR_CONSTANT_ARGUMENT_BONUS = 8;
+
+typedef struct scc_ir_inliner {
+  scc_ir_module_t *module;
+
+  scc_allocator_t *scratch;
+
+  scc_uint32_t threshold;
+
+  // Indexed by function.
+  scc_uint32_t *sizes;
+  scc_uint32_t *call_sites;
+
+  // Strongly connected component of the call graph each function belongs to.
+  // Calls within a component are recursive, so aren't inlined.
+  scc_uint32_t *components;
+
+  // Functions in the order their components were completed, which puts
+  // callees before their callers.
+  scc_uint32_t *order;
+  scc_uint32_t num_of_ordered;
+
+  // State for Tarjan's algorithm.
+  scc_uint32_t *indices;
+  scc_uint32_t *lowest;
+  scc_bool_t *on_stack;
+  scc_uint32_t *stack;
+  scc_uint32_t num_of_stacked;
+  scc_uint32_t num_of_indices;
+  scc_uint32_t num_of_components;
+} scc_ir_inliner_t;
+
+// Returns the function called by `instruction`, or `SCC_IR_NONE` if it isn't
+// a direct call of a function with a body.
+static scc_uint32_t scc_ir_inliner_callee(const scc_ir_inliner_t *inliner,
+                                          const scc_ir_function_t *function,
+                                          const scc_ir_instruction_t *instruction) {
+  if (instruction->op != SCC_IR_OPERATION_CALL)
+    return SCC_IR_NONE;
+
+  const scc_ir_value_t callee = scc_ir_operand(function, instruction, 0);
+
+  if (SCC_IR_VALUE_KIND(callee) != SCC_IR_VALUE_FUNCTION)
+    return SCC_IR_NONE;
+
+  const scc_ir_function_t *called = inliner->module->functions[SCC_IR_VALUE_INDEX(callee)];
+
+  if (called->removed || (called->num_of_blocks == 0))
+    return SCC_IR_NONE;
+
+  return SCC_IR_VALUE_INDEX(callee);
+}
+
+static void scc_ir_inliner_measure(scc_ir_inliner_t *inliner) {
+  const scc_ir_module_t *module = inliner->module;
+
+  for (scc_uint32_t index = 0; index < module->num_of_functions; ++index) {
+    const scc_ir_function_t *function = module->functions[index];
+
+    if (function->removed)
+      continue;
+
+    for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (!scc_ir_instruction_is_live(instruction))
+        continue;
+
+      inliner->sizes[index] += 1;
+
+      const scc_uint32_t callee = scc_ir_inliner_callee(inliner, function, instruction);
+
+      if (callee != SCC_IR_NONE)
+        inliner->call_sites[callee] += 1;
+    }
+  }
+}
+
+static void scc_ir_inliner_connect(scc_ir_inliner_t *inliner,
+                                   scc_uint32_t index) {
+  const scc_ir_function_t *function = inliner->module->functions[index];
+
+  inliner->indices[index] = inliner->lowest[index] = inliner->num_of_indices++;
+
+  inliner->stack[inliner->num_of_stacked++] = index;
+  inliner->on_stack[index] = SCC_TRUE;
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    const scc_uint32_t callee = scc_ir_inliner_callee(inliner, function, instruction);
+
+    if (callee == SCC_IR_NONE)
+      continue;
+
+    if (inliner->indices[callee] == SCC_IR_NONE) {
+      scc_ir_inliner_connect(inliner, callee);
+      inliner->lowest[index] = SCC_MIN(inliner->lowest[index], inliner->lowest[callee]);
+    } else if (inliner->on_stack[callee]) {
+      inliner->lowest[index] = SCC_MIN(inliner->lowest[index], inliner->indices[callee]);
+    }
+  }
+
+  if (inliner->lowest[index] != inliner->indices[index])
+    return;
+
+  // Root of a component, so pop it.
+  const scc_uint32_t component = inliner->num_of_components++;
+
+  for (;;) {
+    const scc_uint32_t member = inliner->stack[--inliner->num_of_stacked];
+
+    inliner->on_stack[member] = SCC_FALSE;
+    inliner->components[member] = component;
+    inliner->order[inliner->num_of_ordered++] = member;
+
+    if (member == index)
+      break;
+  }
+}
+
+static scc_bool_t scc_ir_inliner_is_worthwhile(const scc_ir_inliner_t *inliner,
+                                               const scc_ir_function_t *caller,
+                                               scc_uint32_t call,
+                                               scc_uint32_t callee) {
+  // Everything is cloned into the only caller, after which the original is
+  // dead, so nothing is gained by keeping it.
+  if ((inliner->call_sites[callee] == 1) && (callee != inliner->module->entry))
+    return SCC_TRUE;
+
+  const scc_ir_instruction_t *instruction = &caller->instructions[call];
+
+  // The call itself, and passing each argument.
+  scc_uint32_t benefit = instruction->num_of_operands;
+
+  for (scc_uint32_t operand = 1; operand < instruction->num_of_operands; ++operand)
+    if (SCC_IR_VALUE_KIND(scc_ir_operand(caller, instruction, operand)) == SCC_IR_VALUE_CONSTANT)
+      benefit += SCC_IR_CONSTANT_ARGUMENT_BONUS;
+
+  return (inliner->sizes[callee] <= inliner->threshold + benefit);
+}
+
+// Replaces `block` as the predecessor of its successors, as seen by phis,
+// with `replacement`.
+static void scc_ir_inliner_repair_phis(scc_ir_function_t *function,
+                                       scc_uint32_t block,
+                                       scc_uint32_t replacement) {
+  scc_uint32_t successors[2];
+  const scc_uint32_t num_of_successors = scc_ir_block_successors(function, replacement, successors);
+
+  for (scc_uint32_t successor = 0; successor < num_of_successors; ++successor) {
+    for (scc_uint32_t i = function->blocks[successors[successor]].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      const scc_ir_instruction_t *phi = &function->instructions[i];
+
+      if (phi->op != SCC_IR_OPERATION_PHI)
+        break;
+
+      scc_ir_value_t *operands = scc_ir_operands(function, phi);
+
+      for (scc_uint32_t operand = 0; operand + 1 < phi->num_of_operands; operand += 2)
+        if (operands[operand] == SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, block))
+          operands[operand] = SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, replacement);
+    }
+  }
+}
+
+// Clones the body of the function called by `call` into `caller` in place of
+// the call.
+static void scc_ir_inliner_inline(scc_ir_inliner_t *inliner,
+                                  scc_ir_function_t *caller,
+                                  scc_uint32_t call,
+                                  scc_uint32_t index) {
+  const scc_ir_function_t *callee = inliner->module->functions[index];
+
+  scc_allocator_t *scratch = inliner->scratch;
+
+  const scc_uint32_t block = caller->instructions[call].block;
+
+  // Arguments, as operands move when instructions are added.
+  const scc_uint32_t num_of_arguments = caller->instructions[call].num_of_operands - 1;
+
+  scc_ir_value_t *arguments =
+    (scc_ir_value_t *)scratch->allocate(scratch, (num_of_arguments + 1) * sizeof(scc_ir_value_t), 16);
+
+  memcpy(arguments, &scc_ir_operands(caller, &caller->instructions[call])[1], num_of_arguments * sizeof(scc_ir_value_t));
+
+  // Split the block after the call, so that the body can be put in between.
+  const scc_uint32_t continuation = scc_ir_function_add_block(caller, "");
+
+  while (caller->instructions[call].next != SCC_IR_NONE)
+    scc_ir_function_move(caller, caller->instructions[call].next, continuation, SCC_IR_NONE);
+
+  scc_ir_inliner_repair_phis(caller, block, continuation);
+
+  // Indexed by callee block.
+  scc_uint32_t *blocks =
+    (scc_uint32_t *)scratch->allocate(scratch, (callee->num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t original = 0; original < callee->num_of_blocks; ++original)
+    blocks[original] = callee->blocks[original].removed ? SCC_IR_NONE : scc_ir_function_add_block(caller, "");
+
+  // Indexed by callee instruction and constant respectively. Zero is
+  // `SCC_IR_NO_VALUE`, i.e. not yet cloned or interned.
+  scc_ir_value_t *values =
+    (scc_ir_value_t *)scratch->allocate(scratch, (callee->num_of_instructions + 1) * sizeof(scc_ir_value_t), 16);
+  scc_ir_value_t *constants =
+    (scc_ir_value_t *)scratch->allocate(scratch, (callee->num_of_constants + 1) * sizeof(scc_ir_value_t), 16);
+
+  // Incoming blocks and values to return, as pairs.
+  scc_ir_value_t *returns =
+    (scc_ir_value_t *)scratch->allocate(scratch, 2 * (callee->num_of_blocks + 1) * sizeof(scc_ir_value_t), 16);
+  scc_uint32_t num_of_returns = 0;
+
+  // Clone first, as operands can refer to instructions cloned later, like
+  // phis do, then rename operands.
+  for (scc_uint32_t original = 0; original < callee->num_of_blocks; ++original) {
+    if (blocks[original] == SCC_IR_NONE)
+      continue;
+
+    for (scc_uint32_t i = callee->blocks[original].first; i != SCC_IR_NONE; i = callee->instructions[i].next) {
+      const scc_ir_instruction_t *instruction = &callee->instructions[i];
+
+      if (instruction->op == SCC_IR_OPERATION_RETURN) {
+        if (instruction->num_of_operands) {
+          returns[num_of_returns++] = SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, blocks[original]);
+          returns[num_of_returns++] = scc_ir_operand(callee, instruction, 0);
+        }
+
+        const scc_ir_value_t target = SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, continuation);
+        scc_ir_function_append(caller, blocks[original], SCC_IR_OPERATION_JUMP, scc_ir_void(), &target, 1);
+
+        continue;
+      }
+
+      values[i] = scc_ir_function_append(caller,
+                                         blocks[original],
+                                         (scc_ir_operation_t)instruction->op,
+                                         instruction->type,
+                                         scc_ir_operands(callee, instruction),
+                                         instruction->num_of_operands);
+    }
+  }
+
+  // Operands refer to the callee, so rename them to refer to clones. This
+  // also covers values returned.
+  for (scc_uint32_t i = 0; i <= callee->num_of_instructions; ++i) {
+    scc_ir_value_t *operands;
+    scc_uint32_t num_of_operands;
+
+    if (i < callee->num_of_instructions) {
+      if (values[i] == SCC_IR_NO_VALUE)
+        continue;
+      const scc_ir_instruction_t *clone = &caller->instructions[SCC_IR_VALUE_INDEX(values[i])];
+      operands = scc_ir_operands(caller, clone);
+      num_of_operands = clone->num_of_operands;
+    } else {
+      operands = returns;
+      num_of_operands = num_of_returns;
+    }
+
+    for (scc_uint32_t operand = 0; operand < num_of_operands; ++operand) {
+      const scc_ir_value_t value = operands[operand];
+      const scc_uint32_t referred = SCC_IR_VALUE_INDEX(value);
+
+      switch (SCC_IR_VALUE_KIND(value)) {
+        case SCC_IR_VALUE_INSTRUCTION:
+          operands[operand] = values[referred];
+          break;
+
+        case SCC_IR_VALUE_ARGUMENT:
+          operands[operand] = (referred < num_of_arguments) ? arguments[referred] : SCC_IR_VALUE(SCC_IR_VALUE_UNDEFINED, 0);
+          break;
+
+        case SCC_IR_VALUE_CONSTANT:
+          if (constants[referred] == SCC_IR_NO_VALUE)
+            constants[referred] = scc_ir_function_constant(caller, &callee->constants[referred]);
+          operands[operand] = constants[referred];
+          break;
+
+        case SCC_IR_VALUE_BLOCK:
+          // Blocks returned from are already renamed.
+          if (i < callee->num_of_instructions)
+            operands[operand] = SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, blocks[referred]);
+          break;
+
+        default:
+          break;
+      }
+    }
+  }
+
+  // Merge values returned.
+  if (num_of_returns == 2) {
+    scc_ir_function_replace(caller, SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, call), returns[1]);
+  } else if (num_of_returns > 2) {
+    const scc_ir_type_t type = caller->instructions[call].type;
+
+    // Continues with at least the terminator of the block split.
+    const scc_ir_value_t merged =
+      scc_ir_function_insert(caller, caller->blocks[continuation].first, SCC_IR_OPERATION_PHI, type, returns, num_of_returns);
+
+    scc_ir_function_replace(caller, SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, call), merged);
+  }
+
+  scc_ir_function_remove(caller, call);
+
+  const scc_ir_value_t entry = SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, blocks[0]);
+  scc_ir_function_append(caller, block, SCC_IR_OPERATION_JUMP, scc_ir_void(), &entry, 1);
+}
+
+// Inlines calls made by `index` that are worthwhile. Returns true if any were.
+static scc_bool_t scc_ir_inliner_run_on(scc_ir_inliner_t *inliner,
+                                        scc_uint32_t index) {
+  scc_ir_function_t *caller = inliner->module->functions[index];
+
+  // Calls are collected up front, as inlining adds instructions, including
+  // calls that weren't worth inlining into the callee.
+  const scc_uint32_t num_of_instructions = caller->num_of_instructions;
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t call = 0; call < num_of_instructions; ++call) {
+    const scc_ir_instruction_t *instruction = &caller->instructions[call];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    const scc_uint32_t callee = scc_ir_inliner_callee(inliner, caller, instruction);
+
+    if (callee == SCC_IR_NONE)
+      continue;
+
+    if (inliner->components[callee] == inliner->components[index])
+      continue;
+
+    if (!scc_ir_inliner_is_worthwhile(inliner, caller, call, callee))
+      continue;
+
+    scc_ir_inliner_inline(inliner, caller, call, callee);
+
+    // Account for the clone, including any calls it makes.
+    inliner->sizes[index] += inliner->sizes[callee];
+    inliner->call_sites[callee] -= 1;
+
+    const scc_ir_function_t *cloned = inliner->module->functions[callee];
+
+    for (scc_uint32_t i = 0; i < cloned->num_of_instructions; ++i) {
+      if (!scc_ir_instruction_is_live(&cloned->instructions[i]))
+        continue;
+
+      const scc_uint32_t nested = scc_ir_inliner_callee(inliner, cloned, &cloned->instructions[i]);
+
+      if (nested != SCC_IR_NONE)
+        inliner->call_sites[nested] += 1;
+    }
+
+    changed = SCC_TRUE;
+  }
+
+  return changed;
+}
+
+static scc_bool_t scc_ir_inline_run(scc_ir_pass_context_t *context,
+                                    scc_ir_module_t *module) {
+  scc_allocator_t *scratch = context->scratch;
+
+  const scc_uint32_t num_of_functions = module->num_of_functions;
+
+  scc_ir_inliner_t inliner;
+
+  inliner.module = module;
+  inliner.scratch = scratch;
+
+  inliner.threshold = context->options->inline_threshold ? context->options->inline_threshold
+                                                         : SCC_IR_DEFAULT_INLINE_THRESHOLD;
+
+  inliner.sizes = (scc_uint32_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  inliner.call_sites = (scc_uint32_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  inliner.components = (scc_uint32_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  inliner.order = (scc_uint32_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  inliner.num_of_ordered = 0;
+
+  inliner.indices = (scc_uint32_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  inliner.lowest = (scc_uint32_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  inliner.on_stack = (scc_bool_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_bool_t), 16);
+  inliner.stack = (scc_uint32_t *)scratch->allocate(scratch, (num_of_functions + 1) * sizeof(scc_uint32_t), 16);
+  inliner.num_of_stacked = 0;
+  inliner.num_of_indices = 0;
+  inliner.num_of_components = 0;
+
+  memset(inliner.indices, 0xff, (num_of_functions + 1) * sizeof(scc_uint32_t));
+
+  scc_ir_inliner_measure(&inliner);
+
+  // PERF(mtwilliams): Recurses as deep as the call graph. Shaders rarely have
+  // deep call graphs, but make this iterative if that proves otherwise.
+  for (scc_uint32_t index = 0; index < num_of_functions; ++index)
+    if (!module->functions[index]->removed && (inliner.indices[index] == SCC_IR_NONE))
+      scc_ir_inliner_connect(&inliner, index);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  // Bottom up, so callees have had calls inlined into them before they're
+  // inlined themselves.
+  for (scc_uint32_t position = 0; position < inliner.num_of_ordered; ++position)
+    changed |= scc_ir_inliner_run_on(&inliner, inliner.order[position]);
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_INLINE_PASS = {
+  "inline",
+  SCC_IR_MODULE_PASS,
+  SCC_IR_PRESERVES_NOTHING,
+  NULL,
+  &scc_ir_inline_run
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,299 @@
+//===-- scc/ir/passes/layout.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_layer {
+  scc_ir_module_t *module;
+  scc_ir_packing_t packing;
+
+  scc_allocator_t *scratch;
+
+  // Indexed by structure. Structures that are referenced other than by loads
+  // of their members from constants keep their layout, as do those nested in
+  // others, or used by inputs and outputs.
+  scc_bool_t *pinned;
+
+  // Indexed by structure. Whether it's the type of a constant buffer.
+  scc_bool_t *buffer;
+} scc_ir_layer_t;
+
+// Something to be placed in a constant buffer.
+typedef struct scc_ir_layer_item {
+  scc_ir_type_t type;
+
+  scc_uint32_t alignment;
+  scc_uint32_t size;
+
+  scc_uint32_t offset;
+} scc_ir_layer_item_t;
+
+static void scc_ir_layer_pin(scc_ir_layer_t *layer,
+                             scc_ir_type_t type) {
+  if (type.scalar == SCC_IR_STRUCTURE)
+    layer->pinned[type.structure] = SCC_TRUE;
+}
+
+// Pins structures that functions refer to other than by loads of members.
+static void scc_ir_layer_survey(scc_ir_layer_t *layer,
+                                const scc_ir_function_t *function) {
+  const scc_ir_module_t *module = layer->module;
+
+  scc_ir_layer_pin(layer, function->return_type);
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument)
+    scc_ir_layer_pin(layer, function->arguments[argument].type);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    scc_ir_layer_pin(layer, instruction->type);
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_GLOBAL)
+        continue;
+
+      const scc_ir_type_t type = module->globals[SCC_IR_VALUE_INDEX(operands[operand])].type;
+
+      if ((instruction->op == SCC_IR_OPERATION_LOAD)
+       && (operand == 0)
+       && (instruction->num_of_operands >= 2)
+       && (SCC_IR_VALUE_KIND(operands[1]) == SCC_IR_VALUE_MEMBER))
+        continue;
+
+      scc_ir_layer_pin(layer, type);
+    }
+  }
+}
+
+// Places `items` as tightly as `scc_ir_layer_t::packing` permits. Those
+// aligned most strictly, then largest, are placed first, each at the first
+// offset it fits at, so that smaller ones fill whatever gaps they leave.
+// Returns the order of items by offset.
+static scc_uint32_t *scc_ir_layer_pack(scc_ir_layer_t *layer,
+                                       scc_ir_layer_item_t *items,
+                                       scc_uint32_t count) {
+  scc_allocator_t *scratch = layer->scratch;
+
+  scc_uint32_t *order =
+    (scc_uint32_t *)scratch->allocate(scratch, (count + 1) * sizeof(scc_uint32_t), 16);
+
+  // Insertion sort, as buffers are small. Stable, so ties keep their order.
+  for (scc_uint32_t item = 0; item < count; ++item) {
+    scc_uint32_t position = item;
+
+    for (; position > 0; --position) {
+      const scc_ir_layer_item_t *before = &items[order[position - 1]];
+
+      if ((before->alignment > items[item].alignment)
+       || ((before->alignment == items[item].alignment) && (before->size >= items[item].size)))
+        break;
+
+      order[position] = order[position - 1];
+    }
+
+    order[position] = item;
+  }
+
+  // Placed so far, by offset.
+  scc_uint32_t *placed =
+    (scc_uint32_t *)scratch->allocate(scratch, (count + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t num_of_placed = 0; num_of_placed < count; ++num_of_placed) {
+    scc_ir_layer_item_t *placing = &items[order[num_of_placed]];
+
+    // Try every gap before trying the end.
+    scc_uint32_t end = 0;
+    scc_uint32_t position = 0;
+
+    for (; position < num_of_placed; ++position) {
+      const scc_ir_layer_item_t *next = &items[placed[position]];
+
+      const scc_uint32_t offset = scc_ir_layout_place(layer->module, layer->packing, placing->type, end);
+
+      if (offset + placing->size <= next->offset)
+        break;
+
+      end = SCC_MAX(end, next->offset + next->size);
+    }
+
+    placing->offset = scc_ir_layout_place(layer->module, layer->packing, placing->type, end);
+
+    memmove(&placed[position + 1], &placed[position], (num_of_placed - position) * sizeof(scc_uint32_t));
+    placed[position] = order[num_of_placed];
+  }
+
+  return placed;
+}
+
+// Lays out members of `structure` anew, in order of offset. Returns true if
+// anything moved.
+static scc_bool_t scc_ir_layer_structure(scc_ir_layer_t *layer,
+                                         scc_uint32_t structure) {
+  scc_ir_module_t *module = layer->module;
+  scc_allocator_t *scratch = layer->scratch;
+
+  const scc_uint32_t first = module->structures[structure].first_member;
+  const scc_uint32_t count = module->structures[structure].num_of_members;
+
+  scc_ir_layer_item_t *items =
+    (scc_ir_layer_item_t *)scratch->allocate(scratch, (count + 1) * sizeof(scc_ir_layer_item_t), 16);
+
+  for (scc_uint32_t member = 0; member < count; ++member) {
+    const scc_ir_type_t type = module->members[first + member].type;
+
+    items[member].type = type;
+    items[member].alignment = scc_ir_layout_alignment(module, layer->packing, type);
+    items[member].size = scc_ir_layout_size(module, layer->packing, type);
+  }
+
+  const scc_uint32_t *order = scc_ir_layer_pack(layer, items, count);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t member = 0; member < count; ++member) {
+    changed |= (module->members[first + member].offset != items[member].offset);
+    changed |= (order[member] != member);
+
+    module->members[first + member].offset = items[member].offset;
+  }
+
+  if (changed)
+    scc_ir_module_reorder_members(module, structure, order);
+
+  return changed;
+}
+
+// Lays out loose constants anew, renumbering them in order of offset among
+// the indices they had. Returns true if anything moved.
+static scc_bool_t scc_ir_layer_loose(scc_ir_layer_t *layer) {
+  scc_ir_module_t *module = layer->module;
+  scc_allocator_t *scratch = layer->scratch;
+
+  scc_uint32_t *loose =
+    (scc_uint32_t *)scratch->allocate(scratch, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  scc_ir_layer_item_t *items =
+    (scc_ir_layer_item_t *)scratch->allocate(scratch, (module->num_of_globals + 1) * sizeof(scc_ir_layer_item_t), 16);
+
+  scc_uint32_t count = 0;
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global) {
+    const scc_ir_global_t *g = &module->globals[global];
+
+    if ((g->storage != SCC_IR_CONSTANT) || (g->type.scalar == SCC_IR_STRUCTURE))
+      continue;
+
+    loose[count] = global;
+
+    items[count].type = g->type;
+    items[count].alignment = scc_ir_layout_alignment(module, layer->packing, g->type);
+    items[count].size = scc_ir_layout_size(module, layer->packing, g->type);
+
+    count += 1;
+  }
+
+  if (count == 0)
+    return SCC_FALSE;
+
+  const scc_uint32_t *order = scc_ir_layer_pack(layer, items, count);
+
+  scc_uint32_t *reordering =
+    (scc_uint32_t *)scratch->allocate(scratch, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+    reordering[global] = global;
+
+  scc_bool_t changed = SCC_FALSE;
+  scc_bool_t reordered = SCC_FALSE;
+
+  for (scc_uint32_t item = 0; item < count; ++item) {
+    changed |= (module->globals[loose[item]].offset != items[item].offset);
+    reordered |= (order[item] != item);
+
+    module->globals[loose[item]].offset = items[item].offset;
+
+    reordering[loose[item]] = loose[order[item]];
+  }
+
+  if (reordered)
+    scc_ir_module_reorder_globals(module, reordering);
+
+  return changed || reordered;
+}
+
+static scc_bool_t scc_ir_layout_run(scc_ir_pass_context_t *context,
+                                    scc_ir_module_t *module) {
+  scc_allocator_t *scratch = context->scratch;
+
+  scc_ir_layer_t layer;
+
+  layer.module = module;
+  layer.scratch = scratch;
+
+  layer.packing = context->options->packing;
+
+  if (layer.packing == SCC_IR_PACKING_TARGET)
+    layer.packing = scc_ir_packing_of(context->options->target);
+
+  layer.pinned =
+    (scc_bool_t *)scratch->allocate(scratch, (module->num_of_structures + 1) * sizeof(scc_bool_t), 16);
+  layer.buffer =
+    (scc_bool_t *)scratch->allocate(scratch, (module->num_of_structures + 1) * sizeof(scc_bool_t), 16);
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global) {
+    const scc_ir_global_t *g = &module->globals[global];
+
+    if (g->type.scalar != SCC_IR_STRUCTURE)
+      continue;
+
+    if (g->storage == SCC_IR_CONSTANT)
+      layer.buffer[g->type.structure] = SCC_TRUE;
+    else
+      layer.pinned[g->type.structure] = SCC_TRUE;
+  }
+
+  for (scc_uint32_t member = 0; member < module->num_of_members; ++member)
+    scc_ir_layer_pin(&layer, module->members[member].type);
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function)
+    if (!module->functions[function]->removed)
+      scc_ir_layer_survey(&layer, module->functions[function]);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t structure = 0; structure < module->num_of_structures; ++structure)
+    if (layer.buffer[structure] && !layer.pinned[structure])
+      changed |= scc_ir_layer_structure(&layer, structure);
+
+  // Globals are renumbered last, as everything above is indexed by global.
+  changed |= scc_ir_layer_loose(&layer);
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_LAYOUT_PASS = {
+  "layout",
+  SCC_IR_MODULE_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  NULL,
+  &scc_ir_layout_run
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,120 @@
+//===-- scc/ir/passes/licm.cc ---------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Determines if `instruction` can be executed before its loop without
+// changing results, even if the loop wouldn't have executed it.
+static scc_bool_t scc_ir_licm_is_hoistable(const scc_ir_function_t *function,
+                                           const scc_ir_instruction_t *instruction) {
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_LOAD: {
+      // Outputs can be stored to in the loop.
+      const scc_ir_value_t pointer = scc_ir_operand(function, instruction, 0);
+
+      if (SCC_IR_VALUE_KIND(pointer) != SCC_IR_VALUE_GLOBAL)
+        return SCC_FALSE;
+
+      return (function->module->globals[SCC_IR_VALUE_INDEX(pointer)].storage != SCC_IR_OUTPUT);
+    }
+
+    // Textures are read-only.
+    case SCC_IR_OPERATION_FETCH:
+    case SCC_IR_OPERATION_GATHER:
+      return SCC_TRUE;
+
+    // Integer division by zero traps on the host, so it's only done where the
+    // shader would have done it.
+    case SCC_IR_OPERATION_DIVIDE:
+      if (!scc_ir_type_is_floating_point(instruction->type))
+        return SCC_FALSE;
+      break;
+  }
+
+  return scc_ir_operation_is(instruction->op, SCC_IR_FOLDABLE);
+}
+
+// Determines if every operand of `instruction` is defined outside `loop`.
+static scc_bool_t scc_ir_licm_is_invariant(const scc_ir_function_t *function,
+                                           const scc_ir_loops_t *loops,
+                                           scc_uint32_t loop,
+                                           const scc_ir_instruction_t *instruction) {
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+      continue;
+
+    const scc_uint32_t defined = function->instructions[SCC_IR_VALUE_INDEX(operands[operand])].block;
+
+    if (scc_ir_loop_contains(loops, loop, defined))
+      return SCC_FALSE;
+  }
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_licm_run(scc_ir_pass_context_t *context,
+                                  scc_ir_function_t *function) {
+  if (function->num_of_blocks == 0)
+    return SCC_FALSE;
+
+  const scc_ir_loops_t *loops = scc_ir_get_loops(context, function);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  // Innermost loops first, so what they hoist into their preheaders is
+  // considered again for the loops enclosing them.
+  for (scc_uint32_t loop = loops->num_of_loops; loop-- > 0; ) {
+    const scc_uint32_t preheader = loops->loops[loop].preheader;
+
+    if (preheader == SCC_IR_NONE)
+      continue;
+
+    const scc_uint32_t *blocks = scc_ir_loop_blocks(loops, loop);
+    const scc_uint32_t num_of_blocks = loops->loops[loop].num_of_blocks;
+
+    // Blocks are in reverse post-order, so an instruction's operands are
+    // visited, and hoisted if they can be, before it is.
+    for (scc_uint32_t block = 0; block < num_of_blocks; ++block) {
+      scc_uint32_t i = function->blocks[blocks[block]].first;
+
+      while (i != SCC_IR_NONE) {
+        const scc_ir_instruction_t *instruction = &function->instructions[i];
+        const scc_uint32_t next = instruction->next;
+
+        if (scc_ir_licm_is_hoistable(function, instruction))
+          if (scc_ir_licm_is_invariant(function, loops, loop, instruction)) {
+            scc_ir_function_move(function, i, preheader, function->blocks[preheader].last);
+            changed = SCC_TRUE;
+          }
+
+        i = next;
+      }
+    }
+  }
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_LICM_PASS = {
+  "licm",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW | SCC_IR_PRESERVES(SCC_IR_ANALYSIS_USES) | SCC_IR_PRESERVES(SCC_IR_ANALYSIS_UNIFORMITY),
+  &scc_ir_licm_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,349 @@
+//===-- scc/ir/passes/prune_interface.cc ----------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_pruner {
+  scc_ir_module_t *module;
+
+  // Indexed by global. Components demanded of loads of globals that aren't
+  // structures, and the width they're to be narrowed to, or zero.
+  scc_ir_components_t *globals;
+  scc_uint32_t *narrowing_globals;
+
+  // Indexed by member, in `scc_ir_module_t::members`. Whether each member is
+  // loaded at all, components demanded of those loads, and the width they're
+  // to be narrowed to, or zero.
+  scc_bool_t *loaded;
+  scc_ir_components_t *members;
+  scc_uint32_t *narrowing_members;
+
+  // Indexed by structure. Structures that are referenced other than by loads
+  // of their members, or are part of outputs, are left as they are.
+  scc_bool_t *pinned;
+
+  // Indexed by global. Outputs that are read back can't be narrowed.
+  scc_bool_t *read;
+} scc_ir_pruner_t;
+
+static scc_bool_t scc_ir_pruner_is_structure(const scc_ir_pruner_t *pruner,
+                                             scc_uint32_t global) {
+  return (pruner->module->globals[global].type.scalar == SCC_IR_STRUCTURE);
+}
+
+// Accumulates what `function` loads and how much of it is demanded.
+static void scc_ir_pruner_survey(scc_ir_pruner_t *pruner,
+                                 const scc_ir_function_t *function,
+                                 const scc_ir_demanded_t *demanded) {
+  const scc_ir_module_t *module = pruner->module;
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_GLOBAL)
+        continue;
+
+      const scc_uint32_t global = SCC_IR_VALUE_INDEX(operands[operand]);
+      const scc_ir_type_t type = module->globals[global].type;
+
+      const scc_bool_t load = (instruction->op == SCC_IR_OPERATION_LOAD) && (operand == 0);
+
+      if (load && (module->globals[global].storage == SCC_IR_OUTPUT))
+        pruner->read[global] = SCC_TRUE;
+
+      const scc_ir_components_t components =
+        scc_ir_demanded_components(demanded, SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, i));
+
+      if (!scc_ir_pruner_is_structure(pruner, global)) {
+        if (load)
+          pruner->globals[global] |= components;
+        continue;
+      }
+
+      if (!load
+       || (instruction->num_of_operands < 2)
+       || (SCC_IR_VALUE_KIND(operands[1]) != SCC_IR_VALUE_MEMBER)) {
+        pruner->pinned[type.structure] = SCC_TRUE;
+        continue;
+      }
+
+      const scc_uint32_t member = module->structures[type.structure].first_member + SCC_IR_VALUE_INDEX(operands[1]);
+
+      pruner->loaded[member] = SCC_TRUE;
+      pruner->members[member] |= components;
+    }
+  }
+}
+
+// Returns the width a vector of `type` can be narrowed to when only
+// `components` of it are demanded, or zero if it can't be narrowed.
+static scc_uint32_t scc_ir_pruner_extent(scc_ir_type_t type,
+                                         scc_ir_components_t components) {
+  if (!scc_ir_type_is_vector(type))
+    return 0;
+
+  const scc_uint32_t extent = scc_ir_components_extent(components);
+
+  return ((extent > 0) && (extent < type.rows)) ? extent : 0;
+}
+
+// Decides what to narrow, returning true if anything is.
+static scc_bool_t scc_ir_pruner_plan(scc_ir_pruner_t *pruner) {
+  scc_ir_module_t *module = pruner->module;
+
+  scc_bool_t narrowing = SCC_FALSE;
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global) {
+    const scc_ir_global_t *g = &module->globals[global];
+
+    if (scc_ir_pruner_is_structure(pruner, global)) {
+      if ((g->storage != SCC_IR_INPUT) && (g->storage != SCC_IR_CONSTANT))
+        pruner->pinned[g->type.structure] = SCC_TRUE;
+      continue;
+    }
+
+    switch (g->storage) {
+      case SCC_IR_INPUT:
+      case SCC_IR_CONSTANT:
+        pruner->narrowing_globals[global] = scc_ir_pruner_extent(g->type, pruner->globals[global]);
+        break;
+
+      // Builtins have fixed types, and the next stage decides what else is
+      // read.
+      case SCC_IR_OUTPUT:
+        if ((g->builtin == SCC_IR_BUILTIN_NONE) && !pruner->read[global])
+          pruner->narrowing_globals[global] = scc_ir_pruner_extent(g->type, (scc_ir_components_t)g->consumed);
+        break;
+
+      default:
+        break;
+    }
+
+    narrowing |= (pruner->narrowing_globals[global] != 0);
+  }
+
+  for (scc_uint32_t structure = 0; structure < module->num_of_structures; ++structure) {
+    if (pruner->pinned[structure])
+      continue;
+
+    const scc_uint32_t first = module->structures[structure].first_member;
+    const scc_uint32_t count = module->structures[structure].num_of_members;
+
+    for (scc_uint32_t member = first; member < first + count; ++member) {
+      pruner->narrowing_members[member] = scc_ir_pruner_extent(module->members[member].type, pruner->members[member]);
+      narrowing |= (pruner->narrowing_members[member] != 0);
+    }
+  }
+
+  return narrowing;
+}
+
+// Returns the width `instruction`, a load or store, should narrow to, if it
+// refers to something being narrowed, or zero.
+static scc_uint32_t scc_ir_pruner_narrowing(const scc_ir_pruner_t *pruner,
+                                            const scc_ir_function_t *function,
+                                            const scc_ir_instruction_t *instruction) {
+  if ((instruction->op != SCC_IR_OPERATION_LOAD) && (instruction->op != SCC_IR_OPERATION_STORE))
+    return 0;
+
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  if (SCC_IR_VALUE_KIND(operands[0]) != SCC_IR_VALUE_GLOBAL)
+    return 0;
+
+  const scc_uint32_t global = SCC_IR_VALUE_INDEX(operands[0]);
+
+  if (!scc_ir_pruner_is_structure(pruner, global))
+    return pruner->narrowing_globals[global];
+
+  if ((instruction->op != SCC_IR_OPERATION_LOAD)
+   || (instruction->num_of_operands < 2)
+   || (SCC_IR_VALUE_KIND(operands[1]) != SCC_IR_VALUE_MEMBER))
+    return 0;
+
+  const scc_uint32_t structure = pruner->module->globals[global].type.structure;
+
+  if (pruner->pinned[structure])
+    return 0;
+
+  return pruner->narrowing_members[pruner->module->structures[structure].first_member + SCC_IR_VALUE_INDEX(operands[1])];
+}
+
+// Loads are narrowed then padded back to their original width by a swizzle,
+// and values stored are narrowed by one, leaving `SCC_IR_SHRINK_PASS` and
+// `SCC_IR_SWIZZLE_PASS` to narrow whatever computes or uses them.
+static void scc_ir_pruner_rewrite(const scc_ir_pruner_t *pruner,
+                                  scc_ir_function_t *function) {
+  const scc_uint32_t n = function->num_of_instructions;
+
+  for (scc_uint32_t i = 0; i < n; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    const scc_uint32_t width = scc_ir_pruner_narrowing(pruner, function, instruction);
+
+    if (width == 0)
+      continue;
+
+    if (instruction->op == SCC_IR_OPERATION_STORE) {
+      const scc_ir_value_t stored = scc_ir_operand(function, instruction, 1);
+      const scc_ir_type_t type = scc_ir_value_type(function, stored);
+
+      const scc_ir_value_t operands[2] = { stored, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_IDENTITY_SWIZZLE) };
+
+      const scc_ir_value_t narrowed =
+        scc_ir_function_insert(function, i, SCC_IR_OPERATION_SWIZZLE, scc_ir_type_reshape(type, width, 1), operands, 2);
+
+      scc_ir_operands(function, &function->instructions[i])[1] = narrowed;
+
+      continue;
+    }
+
+    scc_ir_value_t operands[2];
+
+    const scc_uint32_t num_of_operands = instruction->num_of_operands;
+    memcpy(operands, scc_ir_operands(function, instruction), num_of_operands * sizeof(scc_ir_value_t));
+
+    const scc_ir_type_t type = scc_ir_type_reshape(instruction->type, width, 1);
+
+    const scc_ir_value_t narrowed =
+      scc_ir_function_insert(function, i, SCC_IR_OPERATION_LOAD, type, operands, num_of_operands);
+
+    // Components beyond those loaded aren't demanded.
+    scc_uint32_t mask = 0;
+
+    for (scc_uint32_t lane = 0; lane < width; ++lane)
+      mask |= lane << (lane * 2);
+
+    const scc_ir_value_t padding[2] = { narrowed, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, mask) };
+
+    function->instructions[i].op = SCC_IR_OPERATION_SWIZZLE;
+    scc_ir_function_set_operands(function, i, padding, 2);
+  }
+}
+
+// Removes members of structures that nothing loads, returning true if any
+// are removed.
+static scc_bool_t scc_ir_pruner_remove_unloaded(scc_ir_pruner_t *pruner,
+                                                scc_allocator_t *scratch) {
+  scc_ir_module_t *module = pruner->module;
+
+  scc_bool_t changed = SCC_FALSE;
+
+  // Last to first, as removing members only moves those of later structures,
+  // so `loaded` still lines up with those yet to be visited.
+  for (scc_uint32_t structure = module->num_of_structures; structure-- > 0; ) {
+    if (pruner->pinned[structure])
+      continue;
+
+    const scc_uint32_t first = module->structures[structure].first_member;
+    const scc_uint32_t count = module->structures[structure].num_of_members;
+
+    scc_bool_t *removing = (scc_bool_t *)scratch->allocate(scratch, (count + 1) * sizeof(scc_bool_t), 16);
+
+    scc_uint32_t num_of_removing = 0;
+
+    for (scc_uint32_t member = 0; member < count; ++member) {
+      removing[member] = !pruner->loaded[first + member];
+      num_of_removing += removing[member] ? 1 : 0;
+    }
+
+    // Structures that nothing loads from are left for `SCC_IR_DCE_PASS`.
+    if ((num_of_removing == 0) || (num_of_removing == count))
+      continue;
+
+    scc_ir_module_remove_members(module, structure, removing);
+
+    changed = SCC_TRUE;
+  }
+
+  return changed;
+}
+
+static scc_bool_t scc_ir_prune_interface_run(scc_ir_pass_context_t *context,
+                                             scc_ir_module_t *module) {
+  scc_allocator_t *scratch = context->scratch;
+
+  scc_ir_pruner_t pruner;
+
+  pruner.module = module;
+
+  pruner.globals =
+    (scc_ir_components_t *)scratch->allocate(scratch, (module->num_of_globals + 1) * sizeof(scc_ir_components_t), 16);
+  pruner.narrowing_globals =
+    (scc_uint32_t *)scratch->allocate(scratch, (module->num_of_globals + 1) * sizeof(scc_uint32_t), 16);
+  pruner.read =
+    (scc_bool_t *)scratch->allocate(scratch, (module->num_of_globals + 1) * sizeof(scc_bool_t), 16);
+
+  pruner.loaded =
+    (scc_bool_t *)scratch->allocate(scratch, (module->num_of_members + 1) * sizeof(scc_bool_t), 16);
+  pruner.members =
+    (scc_ir_components_t *)scratch->allocate(scratch, (module->num_of_members + 1) * sizeof(scc_ir_components_t), 16);
+  pruner.narrowing_members =
+    (scc_uint32_t *)scratch->allocate(scratch, (module->num_of_members + 1) * sizeof(scc_uint32_t), 16);
+
+  pruner.pinned =
+    (scc_bool_t *)scratch->allocate(scratch, (module->num_of_structures + 1) * sizeof(scc_bool_t), 16);
+
+  for (scc_uint32_t function = 0; function < module->num_of_functions; ++function) {
+    scc_ir_function_t *surveying = module->functions[function];
+
+    if (surveying->removed || (surveying->num_of_blocks == 0))
+      continue;
+
+    scc_ir_pruner_survey(&pruner, surveying, scc_ir_get_demanded(context, surveying));
+  }
+
+  scc_bool_t changed = SCC_FALSE;
+
+  if (scc_ir_pruner_plan(&pruner)) {
+    for (scc_uint32_t function = 0; function < module->num_of_functions; ++function)
+      if (!module->functions[function]->removed)
+        scc_ir_pruner_rewrite(&pruner, module->functions[function]);
+
+    for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+      if (pruner.narrowing_globals[global])
+        module->globals[global].type = scc_ir_type_reshape(module->globals[global].type, pruner.narrowing_globals[global], 1);
+
+    for (scc_uint32_t member = 0; member < module->num_of_members; ++member)
+      if (pruner.narrowing_members[member])
+        module->members[member].type = scc_ir_type_reshape(module->members[member].type, pruner.narrowing_members[member], 1);
+
+    changed = SCC_TRUE;
+  }
+
+  // Members are renumbered last, as everything above is indexed by member.
+  changed |= scc_ir_pruner_remove_unloaded(&pruner, scratch);
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_PRUNE_INTERFACE_PASS = {
+  "prune-interface",
+  SCC_IR_MODULE_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  NULL,
+  &scc_ir_prune_interface_run
+};
+
+SCC_END_EXTERN_C
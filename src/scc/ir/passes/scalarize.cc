@@ -0,0 +1,208 @@
+//===-- scc/ir/passes/scalarize.cc ----------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Returns component `lane` of `value` as a scalar, looking through
+// compositions and swizzles so that each lane depends only on what computes
+// it. Otherwise extracts it with a swizzle inserted before `before`.
+static scc_ir_value_t scc_ir_scalarize_lane(scc_ir_function_t *function,
+                                            scc_ir_value_t value,
+                                            scc_uint32_t lane,
+                                            scc_uint32_t before) {
+  const scc_ir_type_t type = scc_ir_value_type(function, value);
+
+  // Scalars are broadcast, constants included.
+  if (scc_ir_type_num_of_components(type) == 1)
+    return value;
+
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_UNDEFINED:
+      return value;
+
+    case SCC_IR_VALUE_CONSTANT: {
+      // Copied as interning may move the pool.
+      const scc_ir_constant_t vector = *scc_ir_value_constant(function, value);
+
+      scc_ir_constant_t scalar;
+
+      memset(&scalar, 0, sizeof(scalar));
+
+      scalar.type = scc_ir_type(vector.type.scalar, 1, 1);
+      scalar.components[0] = vector.components[lane];
+
+      return scc_ir_function_constant(function, &scalar);
+    }
+
+    default:
+      break;
+  }
+
+  if (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION) {
+    const scc_ir_instruction_t *producer = &function->instructions[SCC_IR_VALUE_INDEX(value)];
+
+    if (producer->op == SCC_IR_OPERATION_COMPOSE) {
+      scc_uint32_t first = 0;
+
+      for (scc_uint32_t operand = 0; operand < producer->num_of_operands; ++operand) {
+        const scc_ir_value_t component = scc_ir_operand(function, producer, operand);
+        const scc_uint32_t width = scc_ir_type_num_of_components(scc_ir_value_type(function, component));
+
+        if (lane < first + width)
+          return scc_ir_scalarize_lane(function, component, lane - first, before);
+
+        first += width;
+      }
+    }
+
+    if (producer->op == SCC_IR_OPERATION_SWIZZLE) {
+      const scc_ir_value_t input = scc_ir_operand(function, producer, 0);
+      const scc_uint32_t mask = SCC_IR_VALUE_INDEX(scc_ir_operand(function, producer, 1));
+
+      return scc_ir_scalarize_lane(function, input, SCC_IR_SWIZZLE_LANE(mask, lane), before);
+    }
+  }
+
+  const scc_ir_value_t operands[2] = {
+    value,
+    SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(lane, 0, 0, 0))
+  };
+
+  return scc_ir_function_insert(function,
+                                before,
+                                SCC_IR_OPERATION_SWIZZLE,
+                                scc_ir_type(type.scalar, 1, 1),
+                                operands,
+                                2);
+}
+
+// Determines if `instruction` should be split into an operation per
+// component on a target that operates on `width` components at once.
+static scc_bool_t scc_ir_scalarize_is_splittable(const scc_ir_function_t *function,
+                                                 const scc_ir_instruction_t *instruction,
+                                                 scc_uint32_t width) {
+  if (!scc_ir_type_is_vector(instruction->type))
+    return SCC_FALSE;
+
+  if (instruction->type.rows <= width)
+    return SCC_FALSE;
+
+  // Swizzles are split so lanes can be traced through them.
+  if (instruction->op == SCC_IR_OPERATION_SWIZZLE)
+    return SCC_TRUE;
+
+  if (!scc_ir_instruction_is_component_wise(function, instruction))
+    return SCC_FALSE;
+
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    const scc_ir_type_t type = scc_ir_value_type(function, operands[operand]);
+
+    if (scc_ir_type_is_matrix(type))
+      return SCC_FALSE;
+
+    // Anything else is broadcast, or of a mismatched width.
+    if (scc_ir_type_is_vector(type) && (type.rows != instruction->type.rows))
+      return SCC_FALSE;
+  }
+
+  return SCC_TRUE;
+}
+
+// Replaces `i` with an operation per component, composed back into a vector
+// for anything that still wants one.
+static void scc_ir_scalarize_split(scc_ir_function_t *function,
+                                   scc_uint32_t i) {
+  const scc_ir_operation_t op = (scc_ir_operation_t)function->instructions[i].op;
+  const scc_ir_type_t type = function->instructions[i].type;
+  const scc_uint32_t num_of_operands = function->instructions[i].num_of_operands;
+
+  scc_assert_debug(type.rows <= 4);
+  scc_assert_debug(num_of_operands <= 4);
+
+  scc_ir_value_t vectors[4];
+  memcpy(vectors, scc_ir_operands(function, &function->instructions[i]), num_of_operands * sizeof(scc_ir_value_t));
+
+  scc_ir_value_t lanes[4];
+
+  for (scc_uint32_t lane = 0; lane < type.rows; ++lane) {
+    if (op == SCC_IR_OPERATION_SWIZZLE) {
+      const scc_uint32_t mask = SCC_IR_VALUE_INDEX(vectors[1]);
+      lanes[lane] = scc_ir_scalarize_lane(function, vectors[0], SCC_IR_SWIZZLE_LANE(mask, lane), i);
+      continue;
+    }
+
+    scc_ir_value_t scalars[4];
+
+    for (scc_uint32_t operand = 0; operand < num_of_operands; ++operand)
+      scalars[operand] = scc_ir_scalarize_lane(function, vectors[operand], lane, i);
+
+    lanes[lane] = scc_ir_function_insert(function,
+                                         i,
+                                         op,
+                                         scc_ir_type(type.scalar, 1, 1),
+                                         scalars,
+                                         num_of_operands);
+  }
+
+  // Uses are left as they are, and will look through this if they're split
+  // too. If nothing still wants the vector, it's left for `SCC_IR_DCE_PASS`,
+  // along with the lanes nothing wants.
+  function->instructions[i].op = SCC_IR_OPERATION_COMPOSE;
+  scc_ir_function_set_operands(function, i, lanes, type.rows);
+}
+
+static scc_bool_t scc_ir_scalarize_run(scc_ir_pass_context_t *context,
+                                       scc_ir_function_t *function) {
+  if (function->num_of_blocks == 0)
+    return SCC_FALSE;
+
+  const scc_ir_pass_options_t *options = context->options;
+
+  scc_assert_paranoid(options->target < SCC_NUM_OF_TARGETS);
+
+  const scc_uint32_t width = SCC_TARGETS[options->target].vector_width;
+
+  const scc_ir_cfg_t *cfg = scc_ir_get_cfg(context, function);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  // Definitions are split before their uses, other than through a `phi`.
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      if (!scc_ir_scalarize_is_splittable(function, &function->instructions[i], width))
+        continue;
+
+      scc_ir_scalarize_split(function, i);
+
+      changed = SCC_TRUE;
+    }
+  }
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_SCALARIZE_PASS = {
+  "scalarize",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  &scc_ir_scalarize_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,434 @@
+//===-- scc/ir/passes/sccp.cc ---------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+#include "scc/ir/fold.h"
+
+SCC_BEGIN_EXTERN_C
+
+// See Wegman and Zadeck, "Constant Propagation with Conditional Branches".
+
+typedef enum scc_ir_sccp_lattice {
+  // Not yet known; might still turn out to be constant.
+  SCC_IR_SCCP_UNKNOWN  = 0,
+
+  // Known to be a particular constant.
+  SCC_IR_SCCP_CONSTANT = 1,
+
+  // Known to vary.
+  SCC_IR_SCCP_VARYING  = 2
+} scc_ir_sccp_lattice_t;
+
+typedef struct scc_ir_sccp {
+  scc_ir_function_t *function;
+  const scc_ir_uses_t *uses;
+
+  // Indexed by instruction.
+  scc_uint8_t *lattice;
+  scc_ir_constant_t *constants;
+
+  // Indexed by block.
+  scc_bool_t *executable;
+
+  // Indexed by block then successor, where the successor is the first or
+  // second target of its terminator.
+  scc_bool_t *edges;
+
+  // Instructions whose operands changed, and edges that became executable.
+  scc_uint32_t *instructions;
+  scc_uint32_t num_of_instructions;
+  scc_uint32_t *flows;
+  scc_uint32_t num_of_flows;
+
+  // Set for instructions in `instructions`, to avoid duplicates.
+  scc_bool_t *queued;
+} scc_ir_sccp_t;
+
+// Lattice value of an operand, along with its constant if it has one.
+static scc_ir_sccp_lattice_t scc_ir_sccp_value(const scc_ir_sccp_t *sccp,
+                                               scc_ir_value_t value,
+                                               const scc_ir_constant_t **constant) {
+  *constant = NULL;
+
+  switch (SCC_IR_VALUE_KIND(value)) {
+    case SCC_IR_VALUE_INSTRUCTION: {
+      const scc_uint32_t index = SCC_IR_VALUE_INDEX(value);
+      if (sccp->lattice[index] == SCC_IR_SCCP_CONSTANT)
+        *constant = &sccp->constants[index];
+      return (scc_ir_sccp_lattice_t)sccp->lattice[index];
+    }
+
+    case SCC_IR_VALUE_CONSTANT:
+      *constant = scc_ir_value_constant(sccp->function, value);
+      return SCC_IR_SCCP_CONSTANT;
+
+    // Masks and the like are read by folding directly.
+    case SCC_IR_VALUE_IMMEDIATE:
+    case SCC_IR_VALUE_MEMBER:
+    case SCC_IR_VALUE_BLOCK:
+    case SCC_IR_VALUE_FUNCTION:
+      return SCC_IR_SCCP_CONSTANT;
+
+    default:
+      return SCC_IR_SCCP_VARYING;
+  }
+}
+
+static void scc_ir_sccp_queue_users(scc_ir_sccp_t *sccp,
+                                    scc_uint32_t instruction) {
+  const scc_uint32_t *users = scc_ir_users(sccp->uses, instruction);
+  const scc_uint32_t num_of_users = sccp->uses->counts[instruction];
+
+  for (scc_uint32_t user = 0; user < num_of_users; ++user) {
+    if (sccp->queued[users[user]])
+      continue;
+
+    sccp->queued[users[user]] = SCC_TRUE;
+    sccp->instructions[sccp->num_of_instructions++] = users[user];
+  }
+}
+
+static void scc_ir_sccp_lower_to(scc_ir_sccp_t *sccp,
+                                 scc_uint32_t instruction,
+                                 scc_ir_sccp_lattice_t lattice,
+                                 const scc_ir_constant_t *constant) {
+  // Values only ever move down the lattice.
+  if (sccp->lattice[instruction] >= lattice)
+    return;
+
+  sccp->lattice[instruction] = (scc_uint8_t)lattice;
+
+  if (constant)
+    sccp->constants[instruction] = *constant;
+
+  scc_ir_sccp_queue_users(sccp, instruction);
+}
+
+static void scc_ir_sccp_mark_edge(scc_ir_sccp_t *sccp,
+                                  scc_uint32_t block,
+                                  scc_uint32_t successor) {
+  const scc_uint32_t edge = block * 2 + successor;
+
+  if (sccp->edges[edge])
+    return;
+
+  sccp->edges[edge] = SCC_TRUE;
+  sccp->flows[sccp->num_of_flows++] = edge;
+}
+
+// Target of a successor of `block`, which must end with a terminator.
+static scc_uint32_t scc_ir_sccp_target(const scc_ir_function_t *function,
+                                       scc_uint32_t block,
+                                       scc_uint32_t successor) {
+  const scc_ir_instruction_t *terminator =
+    &function->instructions[scc_ir_block_terminator(function, block)];
+
+  if (terminator->op == SCC_IR_OPERATION_JUMP)
+    return SCC_IR_VALUE_INDEX(scc_ir_operand(function, terminator, 0));
+
+  return SCC_IR_VALUE_INDEX(scc_ir_operand(function, terminator, 1 + successor));
+}
+
+static scc_bool_t scc_ir_sccp_flows(const scc_ir_sccp_t *sccp,
+                                    scc_uint32_t from,
+                                    scc_uint32_t to) {
+  const scc_uint32_t terminator = scc_ir_block_terminator(sccp->function, from);
+
+  if (terminator == SCC_IR_NONE)
+    return SCC_FALSE;
+
+  for (scc_uint32_t successor = 0; successor < 2; ++successor)
+    if (sccp->edges[from * 2 + successor] && (scc_ir_sccp_target(sccp->function, from, successor) == to))
+      return SCC_TRUE;
+
+  return SCC_FALSE;
+}
+
+static scc_bool_t scc_ir_sccp_taken(const void *user,
+                                    scc_uint32_t from,
+                                    scc_uint32_t to) {
+  return scc_ir_sccp_flows((const scc_ir_sccp_t *)user, from, to);
+}
+
+static void scc_ir_sccp_visit_phi(scc_ir_sccp_t *sccp,
+                                  scc_uint32_t instruction) {
+  const scc_ir_instruction_t *phi = &sccp->function->instructions[instruction];
+  const scc_ir_value_t *operands = scc_ir_operands(sccp->function, phi);
+
+  const scc_ir_constant_t *agreed = NULL;
+
+  for (scc_uint32_t operand = 0; operand + 1 < phi->num_of_operands; operand += 2) {
+    const scc_uint32_t from = SCC_IR_VALUE_INDEX(operands[operand]);
+
+    if (!scc_ir_sccp_flows(sccp, from, phi->block))
+      continue;
+
+    const scc_ir_constant_t *constant;
+
+    switch (scc_ir_sccp_value(sccp, operands[operand + 1], &constant)) {
+      case SCC_IR_SCCP_UNKNOWN:
+        break;
+
+      case SCC_IR_SCCP_CONSTANT:
+        if (!agreed) {
+          agreed = constant;
+        } else if (memcmp(&agreed->components[0], &constant->components[0], sizeof(agreed->components)) != 0) {
+          scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_VARYING, NULL);
+          return;
+        }
+        break;
+
+      case SCC_IR_SCCP_VARYING:
+        scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_VARYING, NULL);
+        return;
+    }
+  }
+
+  if (agreed) {
+    scc_ir_constant_t constant = *agreed;
+    constant.type = scc_ir_type(phi->type.scalar, phi->type.rows, phi->type.columns);
+    scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_CONSTANT, &constant);
+  }
+}
+
+static void scc_ir_sccp_visit_terminator(scc_ir_sccp_t *sccp,
+                                         scc_uint32_t instruction) {
+  const scc_ir_instruction_t *terminator = &sccp->function->instructions[instruction];
+
+  switch (terminator->op) {
+    case SCC_IR_OPERATION_JUMP:
+      scc_ir_sccp_mark_edge(sccp, terminator->block, 0);
+      break;
+
+    case SCC_IR_OPERATION_BRANCH: {
+      const scc_ir_constant_t *condition;
+
+      switch (scc_ir_sccp_value(sccp, scc_ir_operand(sccp->function, terminator, 0), &condition)) {
+        case SCC_IR_SCCP_UNKNOWN:
+          break;
+
+        case SCC_IR_SCCP_CONSTANT:
+          scc_ir_sccp_mark_edge(sccp, terminator->block, scc_ir_constant_is_true(condition) ? 0 : 1);
+          break;
+
+        case SCC_IR_SCCP_VARYING:
+          scc_ir_sccp_mark_edge(sccp, terminator->block, 0);
+          scc_ir_sccp_mark_edge(sccp, terminator->block, 1);
+          break;
+      }
+    } break;
+  }
+}
+
+static void scc_ir_sccp_visit(scc_ir_sccp_t *sccp,
+                              scc_uint32_t instruction) {
+  const scc_ir_instruction_t *visiting = &sccp->function->instructions[instruction];
+
+  if (visiting->op == SCC_IR_OPERATION_PHI)
+    return scc_ir_sccp_visit_phi(sccp, instruction);
+
+  if (scc_ir_operation_is(visiting->op, SCC_IR_TERMINATOR))
+    return scc_ir_sccp_visit_terminator(sccp, instruction);
+
+  if (!scc_ir_operation_is(visiting->op, SCC_IR_FOLDABLE)) {
+    if (SCC_IR_OPERATIONS[visiting->op].returns)
+      scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_VARYING, NULL);
+    return;
+  }
+
+  const scc_ir_value_t *operands = scc_ir_operands(sccp->function, visiting);
+
+  const scc_ir_constant_t *inputs[16];
+
+  if (visiting->num_of_operands > 16)
+    return scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_VARYING, NULL);
+
+  for (scc_uint32_t operand = 0; operand < visiting->num_of_operands; ++operand) {
+    switch (scc_ir_sccp_value(sccp, operands[operand], &inputs[operand])) {
+      case SCC_IR_SCCP_UNKNOWN:
+        return;
+      case SCC_IR_SCCP_CONSTANT:
+        break;
+      case SCC_IR_SCCP_VARYING:
+        return scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_VARYING, NULL);
+    }
+  }
+
+  scc_ir_constant_t result;
+
+  if (scc_ir_fold(sccp->function, visiting, inputs, &result))
+    scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_CONSTANT, &result);
+  else
+    scc_ir_sccp_lower_to(sccp, instruction, SCC_IR_SCCP_VARYING, NULL);
+}
+
+// Marks both ways out of executable branches on a condition that never became
+// known, so that a branch is never left without a target.
+static scc_bool_t scc_ir_sccp_settle(scc_ir_sccp_t *sccp) {
+  scc_ir_function_t *function = sccp->function;
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    if (!sccp->executable[block] || sccp->edges[block * 2] || sccp->edges[block * 2 + 1])
+      continue;
+
+    const scc_uint32_t terminator = scc_ir_block_terminator(function, block);
+
+    if ((terminator == SCC_IR_NONE) || (function->instructions[terminator].op != SCC_IR_OPERATION_BRANCH))
+      continue;
+
+    scc_ir_sccp_mark_edge(sccp, block, 0);
+    scc_ir_sccp_mark_edge(sccp, block, 1);
+  }
+
+  return (sccp->num_of_flows > 0);
+}
+
+static void scc_ir_sccp_solve(scc_ir_sccp_t *sccp) {
+  scc_ir_function_t *function = sccp->function;
+
+  // Entry is always executed. Pretend there's an edge into it.
+  sccp->executable[0] = SCC_TRUE;
+
+  for (scc_uint32_t i = function->blocks[0].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+    scc_ir_sccp_visit(sccp, i);
+
+  while (sccp->num_of_flows || sccp->num_of_instructions || scc_ir_sccp_settle(sccp)) {
+    while (sccp->num_of_flows) {
+      const scc_uint32_t edge = sccp->flows[--sccp->num_of_flows];
+      const scc_uint32_t target = scc_ir_sccp_target(function, edge / 2, edge % 2);
+
+      if (sccp->executable[target]) {
+        // Only phis care about new ways in.
+        for (scc_uint32_t i = function->blocks[target].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+          if (function->instructions[i].op != SCC_IR_OPERATION_PHI)
+            break;
+          scc_ir_sccp_visit_phi(sccp, i);
+        }
+      } else {
+        sccp->executable[target] = SCC_TRUE;
+
+        for (scc_uint32_t i = function->blocks[target].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+          scc_ir_sccp_visit(sccp, i);
+      }
+    }
+
+    while (sccp->num_of_instructions) {
+      const scc_uint32_t instruction = sccp->instructions[--sccp->num_of_instructions];
+
+      sccp->queued[instruction] = SCC_FALSE;
+
+      if (sccp->executable[function->instructions[instruction].block])
+        scc_ir_sccp_visit(sccp, instruction);
+    }
+  }
+}
+
+// Rewrites `function` given the solution. Returns true if anything changed.
+static scc_bool_t scc_ir_sccp_rewrite(scc_ir_sccp_t *sccp,
+                                      scc_allocator_t *scratch) {
+  scc_ir_function_t *function = sccp->function;
+
+  scc_bool_t changed = SCC_FALSE;
+
+  // Zero is `SCC_IR_NO_VALUE`, i.e. not forwarded.
+  scc_ir_value_t *forwarding =
+    (scc_ir_value_t *)scratch->allocate(scratch, (function->num_of_instructions + 1) * sizeof(scc_ir_value_t), 16);
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    if (!sccp->executable[block])
+      continue;
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+      const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+      if (sccp->lattice[i] == SCC_IR_SCCP_CONSTANT && !scc_ir_operation_is(instruction->op, SCC_IR_SIDE_EFFECTS))
+        forwarding[i] = scc_ir_function_constant(function, &sccp->constants[i]);
+    }
+  }
+
+  // Drop incoming values from paths never taken.
+  changed |= scc_ir_function_prune_phis(function, &scc_ir_sccp_taken, sccp, forwarding);
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    if (function->blocks[block].removed)
+      continue;
+
+    if (!sccp->executable[block]) {
+      scc_ir_function_remove_block(function, block);
+      changed = SCC_TRUE;
+      continue;
+    }
+
+    const scc_uint32_t terminator = scc_ir_block_terminator(function, block);
+
+    if ((terminator == SCC_IR_NONE) || (function->instructions[terminator].op != SCC_IR_OPERATION_BRANCH))
+      continue;
+
+    if (sccp->edges[block * 2] && sccp->edges[block * 2 + 1])
+      continue;
+
+    const scc_ir_value_t target =
+      SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, scc_ir_sccp_target(function, block, sccp->edges[block * 2] ? 0 : 1));
+
+    function->instructions[terminator].op = SCC_IR_OPERATION_JUMP;
+    scc_ir_function_set_operands(function, terminator, &target, 1);
+
+    changed = SCC_TRUE;
+  }
+
+  return changed;
+}
+
+static scc_bool_t scc_ir_sccp_run(scc_ir_pass_context_t *context,
+                                  scc_ir_function_t *function) {
+  scc_allocator_t *scratch = context->scratch;
+
+  if (function->num_of_blocks == 0)
+    return SCC_FALSE;
+
+  const scc_uint32_t num_of_instructions = function->num_of_instructions;
+  const scc_uint32_t num_of_blocks = function->num_of_blocks;
+
+  scc_ir_sccp_t sccp;
+
+  sccp.function = function;
+  sccp.uses = scc_ir_get_uses(context, function);
+
+  sccp.lattice = (scc_uint8_t *)scratch->allocate(scratch, num_of_instructions + 1, 16);
+  sccp.constants = (scc_ir_constant_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_ir_constant_t), 16);
+  sccp.executable = (scc_bool_t *)scratch->allocate(scratch, (num_of_blocks + 1) * sizeof(scc_bool_t), 16);
+  sccp.edges = (scc_bool_t *)scratch->allocate(scratch, 2 * (num_of_blocks + 1) * sizeof(scc_bool_t), 16);
+  sccp.queued = (scc_bool_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_bool_t), 16);
+
+  // Each instruction is queued at most once at a time, and each edge only
+  // ever becomes executable once.
+  sccp.instructions = (scc_uint32_t *)scratch->allocate(scratch, (num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  sccp.flows = (scc_uint32_t *)scratch->allocate(scratch, 2 * (num_of_blocks + 1) * sizeof(scc_uint32_t), 16);
+
+  sccp.num_of_instructions = 0;
+  sccp.num_of_flows = 0;
+
+  scc_ir_sccp_solve(&sccp);
+
+  return scc_ir_sccp_rewrite(&sccp, scratch);
+}
+
+const scc_ir_pass_t SCC_IR_SCCP_PASS = {
+  "sccp",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_NOTHING,
+  &scc_ir_sccp_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,532 @@
+//===-- scc/ir/passes/schedule.cc -----------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Used when `scc_ir_pass_options_t::register_budget` is zero.
+static const scc_uint32_t SCC_IR_DEFAULT_REGISTER_BUDGET = 32;
+
+// Rough number of cycles before a result can be used.
+//
+// PERF(mtwilliams): Make these per-target. Texture latency in particular
+// varies wildly, but any figure far above arithmetic gets fetches hoisted.
+static scc_uint32_t scc_ir_schedule_latency(const scc_ir_instruction_t *instruction) {
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_FETCH:
+    case SCC_IR_OPERATION_GATHER:
+      return 32;
+
+    case SCC_IR_OPERATION_LOAD:
+      return 8;
+
+    case SCC_IR_OPERATION_DIVIDE:
+    case SCC_IR_OPERATION_SQRT:
+    case SCC_IR_OPERATION_RSQRT:
+    case SCC_IR_OPERATION_SIN:
+    case SCC_IR_OPERATION_COS:
+    case SCC_IR_OPERATION_TAN:
+    case SCC_IR_OPERATION_POW:
+    case SCC_IR_OPERATION_EXP:
+    case SCC_IR_OPERATION_EXP2:
+    case SCC_IR_OPERATION_EXP10:
+    case SCC_IR_OPERATION_LOG:
+    case SCC_IR_OPERATION_LOG2:
+    case SCC_IR_OPERATION_LOG10:
+      return 4;
+  }
+
+  return 1;
+}
+
+// Instructions of a block between any phis and the terminator are nodes of a
+// graph, with edges from each to those that must follow it. Nodes are
+// numbered in their original order, so every edge goes forward.
+typedef struct scc_ir_scheduler {
+  scc_ir_function_t *function;
+
+  const scc_ir_liveness_t *liveness;
+
+  scc_allocator_t *scratch;
+
+  scc_uint32_t budget;
+
+  // Indexed by value, as indexed by liveness.
+  scc_uint32_t *registers;
+  scc_uint32_t *remaining;
+  scc_bool_t *outlives;
+
+  // Indexed by node.
+  scc_uint32_t *nodes;
+  scc_uint32_t *heights;
+  scc_uint32_t *earliest;
+  scc_uint32_t *unscheduled;
+  scc_uint32_t *successors;
+  scc_uint32_t *first_successor;
+  scc_uint32_t num_of_nodes;
+
+  // Registers occupied by values live at the current point.
+  scc_uint32_t pressure;
+} scc_ir_scheduler_t;
+
+// Change in pressure from scheduling `node` now, split into what its result
+// occupies and what is freed by its operands dying.
+static void scc_ir_scheduler_effect(const scc_ir_scheduler_t *scheduler,
+                                    scc_uint32_t node,
+                                    scc_uint32_t *defined,
+                                    scc_uint32_t *freed) {
+  const scc_ir_function_t *function = scheduler->function;
+
+  const scc_uint32_t i = scheduler->nodes[node];
+  const scc_ir_instruction_t *instruction = &function->instructions[i];
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  *defined = scheduler->registers[i];
+  *freed = 0;
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    const scc_uint32_t index = scc_ir_liveness_index(function, operands[operand]);
+
+    if ((index == SCC_IR_NONE) || scheduler->outlives[index])
+      continue;
+
+    // Count each value once, with however many times it's used here.
+    scc_uint32_t occurrences = 1;
+    scc_bool_t repeated = SCC_FALSE;
+
+    for (scc_uint32_t other = 0; other < instruction->num_of_operands; ++other) {
+      if (other == operand || operands[other] != operands[operand])
+        continue;
+      if (other < operand)
+        repeated = SCC_TRUE;
+      occurrences += 1;
+    }
+
+    if (!repeated && (scheduler->remaining[index] == occurrences))
+      *freed += scheduler->registers[index];
+  }
+}
+
+// Accounts for scheduling `node`.
+static void scc_ir_scheduler_retire(scc_ir_scheduler_t *scheduler,
+                                    scc_uint32_t node) {
+  const scc_ir_function_t *function = scheduler->function;
+
+  const scc_uint32_t i = scheduler->nodes[node];
+  const scc_ir_instruction_t *instruction = &function->instructions[i];
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  scc_uint32_t defined, freed;
+  scc_ir_scheduler_effect(scheduler, node, &defined, &freed);
+
+  scheduler->pressure -= freed;
+
+  // Results never used die immediately.
+  if (scheduler->remaining[i] || scheduler->outlives[i])
+    scheduler->pressure += defined;
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    const scc_uint32_t index = scc_ir_liveness_index(function, operands[operand]);
+    if (index != SCC_IR_NONE)
+      scheduler->remaining[index] -= 1;
+  }
+}
+
+// Determines if `candidate` should be scheduled before `incumbent`.
+static scc_bool_t scc_ir_scheduler_prefer(const scc_ir_scheduler_t *scheduler,
+                                          scc_uint32_t cycle,
+                                          scc_uint32_t candidate,
+                                          scc_uint32_t incumbent) {
+  scc_uint32_t candidate_defined, candidate_freed;
+  scc_uint32_t incumbent_defined, incumbent_freed;
+
+  scc_ir_scheduler_effect(scheduler, candidate, &candidate_defined, &candidate_freed);
+  scc_ir_scheduler_effect(scheduler, incumbent, &incumbent_defined, &incumbent_freed);
+
+  const scc_uint32_t candidate_pressure = scheduler->pressure + candidate_defined - candidate_freed;
+  const scc_uint32_t incumbent_pressure = scheduler->pressure + incumbent_defined - incumbent_freed;
+
+  const scc_bool_t candidate_fits = (candidate_pressure <= scheduler->budget);
+  const scc_bool_t incumbent_fits = (incumbent_pressure <= scheduler->budget);
+
+  // Stay within budget if at all possible, and otherwise get back within it
+  // as quickly as possible.
+  if (candidate_fits != incumbent_fits)
+    return candidate_fits;
+
+  if (!candidate_fits && (candidate_pressure != incumbent_pressure))
+    return (candidate_pressure < incumbent_pressure);
+
+  // Prefer what can issue without stalling, then whatever is on the longest
+  // path to the end of the block.
+  const scc_bool_t candidate_ready = (scheduler->earliest[candidate] <= cycle);
+  const scc_bool_t incumbent_ready = (scheduler->earliest[incumbent] <= cycle);
+
+  if (candidate_ready != incumbent_ready)
+    return candidate_ready;
+
+  if (scheduler->heights[candidate] != scheduler->heights[incumbent])
+    return (scheduler->heights[candidate] > scheduler->heights[incumbent]);
+
+  return (candidate < incumbent);
+}
+
+// Counts uses of each value by nodes.
+static void scc_ir_scheduler_count(scc_ir_scheduler_t *scheduler) {
+  const scc_ir_function_t *function = scheduler->function;
+
+  for (scc_uint32_t node = 0; node < scheduler->num_of_nodes; ++node) {
+    const scc_ir_instruction_t *instruction = &function->instructions[scheduler->nodes[node]];
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      const scc_uint32_t index = scc_ir_liveness_index(function, operands[operand]);
+      if (index != SCC_IR_NONE)
+        scheduler->remaining[index] += 1;
+    }
+  }
+}
+
+// Finds the edges between nodes, compressed like `scc_ir_cfg_t`.
+static void scc_ir_scheduler_link(scc_ir_scheduler_t *scheduler,
+                                  const scc_uint32_t *node_of) {
+  const scc_ir_function_t *function = scheduler->function;
+  const scc_ir_module_t *module = function->module;
+
+  scc_allocator_t *scratch = scheduler->scratch;
+
+  const scc_uint32_t n = scheduler->num_of_nodes;
+
+  scc_uint32_t capacity = 3 * n;
+
+  for (scc_uint32_t node = 0; node < n; ++node)
+    capacity += function->instructions[scheduler->nodes[node]].num_of_operands;
+
+  scc_uint32_t *from = (scc_uint32_t *)scratch->allocate(scratch, (capacity + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t *to = (scc_uint32_t *)scratch->allocate(scratch, (capacity + 1) * sizeof(scc_uint32_t), 16);
+
+  scc_uint32_t num_of_edges = 0;
+
+  // Effects keep their order, and reads of outputs stay on the same side of
+  // anything that may write them. Everything else only reads what can't be
+  // written, so can move freely.
+  scc_uint32_t last_effect = SCC_IR_NONE;
+  scc_uint32_t first_read = 0;
+
+  scc_uint32_t *reads = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t num_of_reads = 0;
+
+  for (scc_uint32_t node = 0; node < n; ++node) {
+    const scc_ir_instruction_t *instruction = &function->instructions[scheduler->nodes[node]];
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      if (SCC_IR_VALUE_KIND(operands[operand]) != SCC_IR_VALUE_INSTRUCTION)
+        continue;
+
+      const scc_uint32_t producer = node_of[SCC_IR_VALUE_INDEX(operands[operand])];
+
+      if (producer == SCC_IR_NONE)
+        // Defined in another block, or by a phi.
+        continue;
+
+      from[num_of_edges] = producer;
+      to[num_of_edges++] = node;
+    }
+
+    const scc_bool_t effect = scc_ir_operation_is(instruction->op, SCC_IR_SIDE_EFFECTS);
+
+    const scc_bool_t read = (instruction->op == SCC_IR_OPERATION_LOAD)
+                         && (SCC_IR_VALUE_KIND(operands[0]) == SCC_IR_VALUE_GLOBAL)
+                         && (module->globals[SCC_IR_VALUE_INDEX(operands[0])].storage == SCC_IR_OUTPUT);
+
+    if (effect || read) {
+      if (last_effect != SCC_IR_NONE) {
+        from[num_of_edges] = last_effect;
+        to[num_of_edges++] = node;
+      }
+    }
+
+    if (effect) {
+      for (scc_uint32_t r = first_read; r < num_of_reads; ++r) {
+        from[num_of_edges] = reads[r];
+        to[num_of_edges++] = node;
+      }
+
+      last_effect = node;
+      first_read = num_of_reads;
+    }
+
+    if (read)
+      reads[num_of_reads++] = node;
+  }
+
+  scheduler->first_successor = (scc_uint32_t *)scratch->allocate(scratch, (n + 2) * sizeof(scc_uint32_t), 16);
+  scheduler->successors = (scc_uint32_t *)scratch->allocate(scratch, (num_of_edges + 1) * sizeof(scc_uint32_t), 16);
+
+  for (scc_uint32_t edge = 0; edge < num_of_edges; ++edge) {
+    scheduler->first_successor[from[edge] + 1] += 1;
+    scheduler->unscheduled[to[edge]] += 1;
+  }
+
+  for (scc_uint32_t node = 0; node < n; ++node)
+    scheduler->first_successor[node + 1] += scheduler->first_successor[node];
+
+  scc_uint32_t *cursor = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  memcpy(cursor, scheduler->first_successor, n * sizeof(scc_uint32_t));
+
+  for (scc_uint32_t edge = 0; edge < num_of_edges; ++edge)
+    scheduler->successors[cursor[from[edge]]++] = to[edge];
+}
+
+static scc_bool_t scc_ir_scheduler_schedule(scc_ir_scheduler_t *scheduler,
+                                            scc_uint32_t block,
+                                            scc_uint32_t *node_of) {
+  scc_ir_function_t *function = scheduler->function;
+  const scc_ir_liveness_t *liveness = scheduler->liveness;
+
+  scc_allocator_t *scratch = scheduler->scratch;
+
+  const scc_uint32_t terminator = function->blocks[block].last;
+
+  if (terminator == SCC_IR_NONE)
+    return SCC_FALSE;
+
+  scc_uint32_t first = function->blocks[block].first;
+
+  while (function->instructions[first].op == SCC_IR_OPERATION_PHI)
+    first = function->instructions[first].next;
+
+  scc_uint32_t n = 0;
+
+  for (scc_uint32_t i = first; i != terminator; i = function->instructions[i].next)
+    n += 1;
+
+  if (n < 2)
+    return SCC_FALSE;
+
+  scheduler->nodes = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scheduler->heights = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scheduler->earliest = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scheduler->unscheduled = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scheduler->num_of_nodes = n;
+
+  n = 0;
+
+  for (scc_uint32_t i = first; i != terminator; i = function->instructions[i].next) {
+    node_of[i] = n;
+    scheduler->nodes[n++] = i;
+  }
+
+  scc_ir_scheduler_link(scheduler, node_of);
+
+  // Length of the longest path from each node to the end of the block.
+  for (scc_uint32_t node = n; node-- > 0; ) {
+    scc_uint32_t height = 0;
+
+    for (scc_uint32_t edge = scheduler->first_successor[node]; edge < scheduler->first_successor[node + 1]; ++edge)
+      height = SCC_MAX(height, scheduler->heights[scheduler->successors[edge]]);
+
+    scheduler->heights[node] = height + scc_ir_schedule_latency(&function->instructions[scheduler->nodes[node]]);
+  }
+
+  // Uses remaining in the block, and what must survive it regardless.
+  const scc_uint64_t *in = scc_ir_live_in(liveness, block);
+  const scc_uint64_t *out = scc_ir_live_out(liveness, block);
+
+  for (scc_uint32_t word = 0; word < liveness->num_of_words; ++word)
+    for (scc_uint64_t bits = out[word]; bits; bits &= bits - 1)
+      scheduler->outlives[word * 64 + scc_ctzull(bits)] = SCC_TRUE;
+
+  scc_ir_scheduler_count(scheduler);
+
+  {
+    const scc_ir_instruction_t *instruction = &function->instructions[terminator];
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      const scc_uint32_t index = scc_ir_liveness_index(function, operands[operand]);
+      if (index != SCC_IR_NONE)
+        scheduler->outlives[index] = SCC_TRUE;
+    }
+  }
+
+  scc_uint32_t entry_pressure = 0;
+
+  for (scc_uint32_t word = 0; word < liveness->num_of_words; ++word)
+    for (scc_uint64_t bits = in[word]; bits; bits &= bits - 1)
+      entry_pressure += scheduler->registers[word * 64 + scc_ctzull(bits)];
+
+  for (scc_uint32_t i = function->blocks[block].first; i != first; i = function->instructions[i].next)
+    if (scheduler->remaining[i] || scheduler->outlives[i])
+      entry_pressure += scheduler->registers[i];
+
+  // Never needs more than the original order did, even if that exceeds the
+  // budget. Pressure is measured after each node, with its result written
+  // and operands that die released.
+  scc_uint32_t original = entry_pressure;
+
+  scheduler->pressure = entry_pressure;
+
+  for (scc_uint32_t node = 0; node < n; ++node) {
+    scc_uint32_t defined, freed;
+    scc_ir_scheduler_effect(scheduler, node, &defined, &freed);
+    original = SCC_MAX(original, scheduler->pressure + defined - freed);
+    scc_ir_scheduler_retire(scheduler, node);
+  }
+
+  // Every use was retired, so counts are back to zero.
+  scc_ir_scheduler_count(scheduler);
+
+  const scc_uint32_t budget = scheduler->budget;
+  scheduler->budget = SCC_MAX(budget, original);
+
+  scheduler->pressure = entry_pressure;
+
+  // Top down, cycle by cycle, picking from whatever has its predecessors
+  // scheduled.
+  scc_uint32_t *ready = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t num_of_ready = 0;
+
+  scc_uint32_t *order = (scc_uint32_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_uint32_t), 16);
+  scc_uint32_t num_of_ordered = 0;
+
+  for (scc_uint32_t node = 0; node < n; ++node)
+    if (scheduler->unscheduled[node] == 0)
+      ready[num_of_ready++] = node;
+
+  scc_uint32_t cycle = 0;
+
+  while (num_of_ready) {
+    scc_uint32_t best = 0;
+
+    for (scc_uint32_t candidate = 1; candidate < num_of_ready; ++candidate)
+      if (scc_ir_scheduler_prefer(scheduler, cycle, ready[candidate], ready[best]))
+        best = candidate;
+
+    const scc_uint32_t node = ready[best];
+    ready[best] = ready[--num_of_ready];
+
+    const scc_uint32_t issued = SCC_MAX(cycle, scheduler->earliest[node]);
+    const scc_uint32_t latency = scc_ir_schedule_latency(&function->instructions[scheduler->nodes[node]]);
+
+    cycle = issued + 1;
+
+    scc_ir_scheduler_retire(scheduler, node);
+
+    order[num_of_ordered++] = node;
+
+    for (scc_uint32_t edge = scheduler->first_successor[node]; edge < scheduler->first_successor[node + 1]; ++edge) {
+      const scc_uint32_t successor = scheduler->successors[edge];
+
+      scheduler->earliest[successor] = SCC_MAX(scheduler->earliest[successor], issued + latency);
+
+      if (--scheduler->unscheduled[successor] == 0)
+        ready[num_of_ready++] = successor;
+    }
+  }
+
+  scc_assert_debug(num_of_ordered == n);
+
+  scheduler->budget = budget;
+
+  // Reset for the next block.
+  for (scc_uint32_t word = 0; word < liveness->num_of_words; ++word)
+    for (scc_uint64_t bits = out[word]; bits; bits &= bits - 1)
+      scheduler->outlives[word * 64 + scc_ctzull(bits)] = SCC_FALSE;
+
+  for (scc_uint32_t node = 0; node < n; ++node)
+    node_of[scheduler->nodes[node]] = SCC_IR_NONE;
+
+  {
+    const scc_ir_instruction_t *instruction = &function->instructions[terminator];
+    const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+    for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+      const scc_uint32_t index = scc_ir_liveness_index(function, operands[operand]);
+      if (index != SCC_IR_NONE)
+        scheduler->outlives[index] = SCC_FALSE;
+    }
+  }
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t position = 0; position < n; ++position)
+    changed |= (order[position] != position);
+
+  if (!changed)
+    return SCC_FALSE;
+
+  for (scc_uint32_t position = 0; position < n; ++position)
+    scc_ir_function_move(function, scheduler->nodes[order[position]], block, terminator);
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_schedule_run(scc_ir_pass_context_t *context,
+                                      scc_ir_function_t *function) {
+  if (function->num_of_blocks == 0)
+    return SCC_FALSE;
+
+  const scc_ir_cfg_t *cfg = scc_ir_get_cfg(context, function);
+  const scc_ir_liveness_t *liveness = scc_ir_get_liveness(context, function);
+
+  scc_allocator_t *scratch = context->scratch;
+
+  const scc_uint32_t num_of_values = liveness->num_of_values;
+
+  scc_ir_scheduler_t scheduler;
+
+  scheduler.function = function;
+  scheduler.liveness = liveness;
+  scheduler.scratch = scratch;
+
+  scheduler.budget = context->options->register_budget ? context->options->register_budget
+                                                       : SCC_IR_DEFAULT_REGISTER_BUDGET;
+
+  scheduler.registers = (scc_uint32_t *)scratch->allocate(scratch, (num_of_values + 1) * sizeof(scc_uint32_t), 16);
+  scheduler.remaining = (scc_uint32_t *)scratch->allocate(scratch, (num_of_values + 1) * sizeof(scc_uint32_t), 16);
+  scheduler.outlives = (scc_bool_t *)scratch->allocate(scratch, (num_of_values + 1) * sizeof(scc_bool_t), 16);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    scc_uint32_t components;
+    scc_ir_liveness_weigh(function->instructions[i].type, &components, &scheduler.registers[i]);
+  }
+
+  for (scc_uint32_t argument = 0; argument < function->num_of_arguments; ++argument) {
+    scc_uint32_t components;
+    scc_ir_liveness_weigh(function->arguments[argument].type, &components, &scheduler.registers[function->num_of_instructions + argument]);
+  }
+
+  scc_uint32_t *node_of = (scc_uint32_t *)scratch->allocate(scratch, (function->num_of_instructions + 1) * sizeof(scc_uint32_t), 16);
+  memset(node_of, 0xff, (function->num_of_instructions + 1) * sizeof(scc_uint32_t));
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position)
+    changed |= scc_ir_scheduler_schedule(&scheduler, cfg->order[position], node_of);
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_SCHEDULE_PASS = {
+  "schedule",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW | SCC_IR_PRESERVES(SCC_IR_ANALYSIS_USES)
+                                | SCC_IR_PRESERVES(SCC_IR_ANALYSIS_LIVENESS),
+  &scc_ir_schedule_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
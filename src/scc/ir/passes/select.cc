@@ -0,0 +1,424 @@
+//===-- scc/ir/passes/select.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+//===----------------------------------------------------------------------===//
+// Patterns
+//===----------------------------------------------------------------------===//
+
+typedef enum scc_ir_pattern_kind {
+  SCC_IR_PATTERN_END       = 0,
+
+  // An instruction with a specific operation, followed by patterns for each
+  // of its inputs. Nested instructions must have no other use, as they're
+  // subsumed.
+  SCC_IR_PATTERN_OPERATION = 1,
+
+  // Any value, captured in a slot. A slot captured more than once must be
+  // the same value each time.
+  SCC_IR_PATTERN_CAPTURE   = 2,
+
+  // A floating-point constant with every component equal to `value`.
+  SCC_IR_PATTERN_SPLAT     = 3
+} scc_ir_pattern_kind_t;
+
+typedef struct scc_ir_pattern_node {
+  scc_ir_pattern_kind_t kind;
+
+  // Operation, or slot.
+  scc_uint32_t what;
+
+  scc_float64_t value;
+} scc_ir_pattern_node_t;
+
+typedef enum scc_ir_pattern_flags {
+  // May change results slightly, so only applied with `fast_math`.
+  SCC_IR_PATTERN_INEXACT        = (1 << 0),
+
+  // Only applies to floating-point results.
+  SCC_IR_PATTERN_FLOATING_POINT = (1 << 1),
+
+  // Only applies if every capture has the same type as the result.
+  SCC_IR_PATTERN_UNIFORM        = (1 << 2)
+} scc_ir_pattern_flags_t;
+
+/// Rewrites an instruction matching `match` to `selected`, with operands
+/// taken from captures or, for splats, made to the type of the result.
+typedef struct scc_ir_pattern {
+  const char *name;
+
+  scc_uint32_t flags;
+
+  // In prefix order, with operations followed by their inputs.
+  scc_ir_pattern_node_t match[8];
+
+  scc_ir_operation_t selected;
+  scc_ir_pattern_node_t operands[4];
+} scc_ir_pattern_t;
+
+#define SCC_IR_MATCH(Operation) { SCC_IR_PATTERN_OPERATION, SCC_IR_OPERATION_##Operation, 0.0 }
+#define SCC_IR_CAPTURE(Slot)    { SCC_IR_PATTERN_CAPTURE, Slot, 0.0 }
+#define SCC_IR_SPLAT(Value)     { SCC_IR_PATTERN_SPLAT, 0, Value }
+
+// Fusing rounds once rather than twice.
+static const scc_ir_pattern_t SCC_IR_FUSE_MULTIPLY_ADD = {
+  "fuse-multiply-add",
+  SCC_IR_PATTERN_INEXACT | SCC_IR_PATTERN_FLOATING_POINT | SCC_IR_PATTERN_UNIFORM,
+  { SCC_IR_MATCH(ADD), SCC_IR_MATCH(MULTIPLY), SCC_IR_CAPTURE(0), SCC_IR_CAPTURE(1), SCC_IR_CAPTURE(2) },
+  SCC_IR_OPERATION_FMA,
+  { SCC_IR_CAPTURE(0), SCC_IR_CAPTURE(1), SCC_IR_CAPTURE(2) }
+};
+
+static const scc_ir_pattern_t SCC_IR_MIN_OF_MAX_TO_SATURATE = {
+  "min-of-max-to-saturate",
+  SCC_IR_PATTERN_FLOATING_POINT | SCC_IR_PATTERN_UNIFORM,
+  { SCC_IR_MATCH(MIN), SCC_IR_MATCH(MAX), SCC_IR_CAPTURE(0), SCC_IR_SPLAT(0.0), SCC_IR_SPLAT(1.0) },
+  SCC_IR_OPERATION_SATURATE,
+  { SCC_IR_CAPTURE(0) }
+};
+
+static const scc_ir_pattern_t SCC_IR_MAX_OF_MIN_TO_SATURATE = {
+  "max-of-min-to-saturate",
+  SCC_IR_PATTERN_FLOATING_POINT | SCC_IR_PATTERN_UNIFORM,
+  { SCC_IR_MATCH(MAX), SCC_IR_MATCH(MIN), SCC_IR_CAPTURE(0), SCC_IR_SPLAT(1.0), SCC_IR_SPLAT(0.0) },
+  SCC_IR_OPERATION_SATURATE,
+  { SCC_IR_CAPTURE(0) }
+};
+
+static const scc_ir_pattern_t SCC_IR_CLAMP_TO_SATURATE = {
+  "clamp-to-saturate",
+  SCC_IR_PATTERN_FLOATING_POINT | SCC_IR_PATTERN_UNIFORM,
+  { SCC_IR_MATCH(CLAMP), SCC_IR_CAPTURE(0), SCC_IR_SPLAT(0.0), SCC_IR_SPLAT(1.0) },
+  SCC_IR_OPERATION_SATURATE,
+  { SCC_IR_CAPTURE(0) }
+};
+
+// For targets without saturate, a clamp is still one operation rather than
+// two.
+static const scc_ir_pattern_t SCC_IR_MIN_OF_MAX_TO_CLAMP = {
+  "min-of-max-to-clamp",
+  SCC_IR_PATTERN_FLOATING_POINT | SCC_IR_PATTERN_UNIFORM,
+  { SCC_IR_MATCH(MIN), SCC_IR_MATCH(MAX), SCC_IR_CAPTURE(0), SCC_IR_SPLAT(0.0), SCC_IR_SPLAT(1.0) },
+  SCC_IR_OPERATION_CLAMP,
+  { SCC_IR_CAPTURE(0), SCC_IR_SPLAT(0.0), SCC_IR_SPLAT(1.0) }
+};
+
+static const scc_ir_pattern_t SCC_IR_MAX_OF_MIN_TO_CLAMP = {
+  "max-of-min-to-clamp",
+  SCC_IR_PATTERN_FLOATING_POINT | SCC_IR_PATTERN_UNIFORM,
+  { SCC_IR_MATCH(MAX), SCC_IR_MATCH(MIN), SCC_IR_CAPTURE(0), SCC_IR_SPLAT(1.0), SCC_IR_SPLAT(0.0) },
+  SCC_IR_OPERATION_CLAMP,
+  { SCC_IR_CAPTURE(0), SCC_IR_SPLAT(0.0), SCC_IR_SPLAT(1.0) }
+};
+
+static const scc_ir_pattern_t SCC_IR_DOT_OF_SELF_TO_LENGTH_SQUARED = {
+  "dot-of-self-to-length-squared",
+  SCC_IR_PATTERN_FLOATING_POINT,
+  { SCC_IR_MATCH(DOT), SCC_IR_CAPTURE(0), SCC_IR_CAPTURE(0) },
+  SCC_IR_OPERATION_LENGTH_SQUARED,
+  { SCC_IR_CAPTURE(0) }
+};
+
+#undef SCC_IR_MATCH
+#undef SCC_IR_CAPTURE
+#undef SCC_IR_SPLAT
+
+//===----------------------------------------------------------------------===//
+// Targets
+//===----------------------------------------------------------------------===//
+
+// Patterns applied for each target, in order of preference. Each is limited
+// to what the target has a direct equivalent for.
+
+static const scc_ir_pattern_t *const SCC_IR_HOST_PATTERNS[] = {
+  &SCC_IR_FUSE_MULTIPLY_ADD,
+  NULL
+};
+
+static const scc_ir_pattern_t *const SCC_IR_GLSL_PATTERNS[] = {
+  &SCC_IR_FUSE_MULTIPLY_ADD,
+  &SCC_IR_MIN_OF_MAX_TO_CLAMP,
+  &SCC_IR_MAX_OF_MIN_TO_CLAMP,
+  NULL
+};
+
+// HLSL has `mad` and `saturate`, the latter being a free modifier on most
+// hardware.
+static const scc_ir_pattern_t *const SCC_IR_HLSL_PATTERNS[] = {
+  &SCC_IR_FUSE_MULTIPLY_ADD,
+  &SCC_IR_MIN_OF_MAX_TO_SATURATE,
+  &SCC_IR_MAX_OF_MIN_TO_SATURATE,
+  &SCC_IR_CLAMP_TO_SATURATE,
+  NULL
+};
+
+// Through `GLSL.std.450`, which has `Fma` and `FClamp` but no saturate.
+static const scc_ir_pattern_t *const SCC_IR_SPIRV_PATTERNS[] = {
+  &SCC_IR_FUSE_MULTIPLY_ADD,
+  &SCC_IR_MIN_OF_MAX_TO_CLAMP,
+  &SCC_IR_MAX_OF_MIN_TO_CLAMP,
+  NULL
+};
+
+// Metal has `fma`, `saturate`, and `length_squared`.
+static const scc_ir_pattern_t *const SCC_IR_MSL_PATTERNS[] = {
+  &SCC_IR_FUSE_MULTIPLY_ADD,
+  &SCC_IR_MIN_OF_MAX_TO_SATURATE,
+  &SCC_IR_MAX_OF_MIN_TO_SATURATE,
+  &SCC_IR_CLAMP_TO_SATURATE,
+  &SCC_IR_DOT_OF_SELF_TO_LENGTH_SQUARED,
+  NULL
+};
+
+static const scc_ir_pattern_t *const *const PATTERNS[SCC_NUM_OF_TARGETS] = {
+  SCC_IR_HOST_PATTERNS,
+  SCC_IR_GLSL_PATTERNS,
+  SCC_IR_HLSL_PATTERNS,
+  SCC_IR_SPIRV_PATTERNS,
+  SCC_IR_MSL_PATTERNS
+};
+
+//===----------------------------------------------------------------------===//
+// Matching
+//===----------------------------------------------------------------------===//
+
+// Patterns are at most a couple of levels deep.
+#define SCC_IR_SELECTOR_MAX_CAPTURES 4
+#define SCC_IR_SELECTOR_MAX_SUBSUMED 4
+
+typedef struct scc_ir_selector {
+  scc_ir_function_t *function;
+
+  const scc_ir_uses_t *uses;
+
+  // State of the current match.
+  scc_ir_value_t captures[SCC_IR_SELECTOR_MAX_CAPTURES];
+  scc_uint32_t subsumed[SCC_IR_SELECTOR_MAX_SUBSUMED];
+  scc_uint32_t num_of_subsumed;
+} scc_ir_selector_t;
+
+static scc_bool_t scc_ir_selector_is_splat_of(const scc_ir_selector_t *selector,
+                                              scc_ir_value_t value,
+                                              scc_float64_t expected) {
+  const scc_ir_constant_t *constant = scc_ir_value_constant(selector->function, value);
+
+  if (!constant || !scc_ir_type_is_floating_point(constant->type))
+    return SCC_FALSE;
+
+  const scc_uint32_t components = scc_ir_type_num_of_components(constant->type);
+
+  for (scc_uint32_t component = 0; component < components; ++component)
+    if (constant->components[component].f != expected)
+      return SCC_FALSE;
+
+  return SCC_TRUE;
+}
+
+// Matches `value` against the pattern starting at `node`, returning the node
+// after it, or `SCC_IR_NONE` if it doesn't match.
+static scc_uint32_t scc_ir_selector_match(scc_ir_selector_t *selector,
+                                          const scc_ir_pattern_node_t *match,
+                                          scc_uint32_t node,
+                                          scc_ir_value_t value,
+                                          scc_bool_t root) {
+  const scc_ir_function_t *function = selector->function;
+
+  switch (match[node].kind) {
+    case SCC_IR_PATTERN_CAPTURE: {
+      scc_ir_value_t *capture = &selector->captures[match[node].what];
+
+      if (*capture == SCC_IR_NO_VALUE)
+        *capture = value;
+      else if (*capture != value)
+        return SCC_IR_NONE;
+
+      return node + 1;
+    }
+
+    case SCC_IR_PATTERN_SPLAT:
+      if (!scc_ir_selector_is_splat_of(selector, value, match[node].value))
+        return SCC_IR_NONE;
+      return node + 1;
+
+    case SCC_IR_PATTERN_OPERATION:
+      break;
+
+    default:
+      return SCC_IR_NONE;
+  }
+
+  if (SCC_IR_VALUE_KIND(value) != SCC_IR_VALUE_INSTRUCTION)
+    return SCC_IR_NONE;
+
+  const scc_uint32_t i = SCC_IR_VALUE_INDEX(value);
+  const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+  if (instruction->op != match[node].what)
+    return SCC_IR_NONE;
+
+  if (!root) {
+    // Instructions added since uses were counted are never subsumed.
+    if ((i >= selector->uses->num_of_instructions) || (selector->uses->counts[i] != 1))
+      return SCC_IR_NONE;
+
+    if (selector->num_of_subsumed == SCC_IR_SELECTOR_MAX_SUBSUMED)
+      return SCC_IR_NONE;
+
+    selector->subsumed[selector->num_of_subsumed++] = i;
+  }
+
+  const scc_uint32_t num_of_inputs = SCC_IR_OPERATIONS[instruction->op].inputs;
+
+  if (instruction->num_of_operands != num_of_inputs)
+    return SCC_IR_NONE;
+
+  const scc_ir_value_t *operands = scc_ir_operands(function, instruction);
+
+  // Try inputs in order, then swapped if that's equivalent.
+  const scc_bool_t swappable = (num_of_inputs == 2)
+                            && scc_ir_instruction_is_commutative(function, instruction);
+
+  scc_ir_value_t captures[SCC_IR_SELECTOR_MAX_CAPTURES];
+  memcpy(captures, selector->captures, sizeof(captures));
+
+  const scc_uint32_t num_of_subsumed = selector->num_of_subsumed;
+
+  for (scc_uint32_t attempt = 0; attempt < (swappable ? 2u : 1u); ++attempt) {
+    scc_uint32_t next = node + 1;
+
+    for (scc_uint32_t input = 0; (input < num_of_inputs) && (next != SCC_IR_NONE); ++input) {
+      const scc_uint32_t operand = attempt ? (num_of_inputs - 1 - input) : input;
+      next = scc_ir_selector_match(selector, match, next, operands[operand], SCC_FALSE);
+    }
+
+    if (next != SCC_IR_NONE)
+      return next;
+
+    memcpy(selector->captures, captures, sizeof(captures));
+    selector->num_of_subsumed = num_of_subsumed;
+  }
+
+  return SCC_IR_NONE;
+}
+
+// Rewrites `instruction` if it matches `pattern`.
+static scc_bool_t scc_ir_selector_select(scc_ir_selector_t *selector,
+                                         scc_uint32_t instruction,
+                                         const scc_ir_pattern_t *pattern) {
+  scc_ir_function_t *function = selector->function;
+
+  const scc_ir_type_t type = function->instructions[instruction].type;
+
+  if ((pattern->flags & SCC_IR_PATTERN_FLOATING_POINT) && !scc_ir_type_is_floating_point(type))
+    return SCC_FALSE;
+
+  for (scc_uint32_t capture = 0; capture < SCC_IR_SELECTOR_MAX_CAPTURES; ++capture)
+    selector->captures[capture] = SCC_IR_NO_VALUE;
+
+  selector->num_of_subsumed = 0;
+
+  const scc_uint32_t end =
+    scc_ir_selector_match(selector, pattern->match, 0, SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, instruction), SCC_TRUE);
+
+  if ((end == SCC_IR_NONE) || (pattern->match[end].kind != SCC_IR_PATTERN_END))
+    return SCC_FALSE;
+
+  if (pattern->flags & SCC_IR_PATTERN_UNIFORM)
+    for (scc_uint32_t capture = 0; capture < SCC_IR_SELECTOR_MAX_CAPTURES; ++capture)
+      if (selector->captures[capture] != SCC_IR_NO_VALUE)
+        if (!scc_ir_type_is_equal(scc_ir_value_type(function, selector->captures[capture]), type))
+          return SCC_FALSE;
+
+  scc_ir_value_t operands[4];
+  scc_uint32_t num_of_operands = 0;
+
+  for (; num_of_operands < 4; ++num_of_operands) {
+    const scc_ir_pattern_node_t *operand = &pattern->operands[num_of_operands];
+
+    if (operand->kind == SCC_IR_PATTERN_CAPTURE)
+      operands[num_of_operands] = selector->captures[operand->what];
+    else if (operand->kind == SCC_IR_PATTERN_SPLAT)
+      operands[num_of_operands] = scc_ir_function_splat(function, type, operand->value);
+    else
+      break;
+  }
+
+  function->instructions[instruction].op = pattern->selected;
+  scc_ir_function_set_operands(function, instruction, operands, num_of_operands);
+
+  // Their only use was just replaced.
+  for (scc_uint32_t subsumed = 0; subsumed < selector->num_of_subsumed; ++subsumed)
+    scc_ir_function_remove(function, selector->subsumed[subsumed]);
+
+  return SCC_TRUE;
+}
+
+//===----------------------------------------------------------------------===//
+// Pass
+//===----------------------------------------------------------------------===//
+
+static scc_bool_t scc_ir_select_run(scc_ir_pass_context_t *context,
+                                    scc_ir_function_t *function) {
+  const scc_ir_pass_options_t *options = context->options;
+
+  scc_assert_paranoid(options->target < SCC_NUM_OF_TARGETS);
+
+  const scc_ir_pattern_t *const *patterns = PATTERNS[options->target];
+
+  scc_ir_selector_t selector;
+
+  selector.function = function;
+  selector.uses = scc_ir_get_uses(context, function);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  // Roots come after what they subsume, so walking forward never visits a
+  // subsumed instruction after it's removed.
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    scc_uint32_t i = function->blocks[block].first;
+
+    while (i != SCC_IR_NONE) {
+      const scc_uint32_t next = function->instructions[i].next;
+
+      for (const scc_ir_pattern_t *const *pattern = patterns; *pattern; ++pattern) {
+        if (((*pattern)->flags & SCC_IR_PATTERN_INEXACT) && !options->fast_math)
+          continue;
+
+        if (function->instructions[i].op != (*pattern)->match[0].what)
+          continue;
+
+        if (scc_ir_selector_select(&selector, i, *pattern)) {
+          changed = SCC_TRUE;
+          break;
+        }
+      }
+
+      i = next;
+    }
+  }
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_SELECT_PASS = {
+  "select",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  &scc_ir_select_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
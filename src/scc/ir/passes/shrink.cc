@@ -0,0 +1,243 @@
+//===-- scc/ir/passes/shrink.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Returns the number of components `i` can be narrowed to, or zero if it
+// can't be narrowed.
+static scc_uint32_t scc_ir_shrink_extent(const scc_ir_function_t *function,
+                                         const scc_ir_demanded_t *demanded,
+                                         const scc_bool_t *pinned,
+                                         scc_uint32_t i) {
+  const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+  if (!scc_ir_instruction_is_live(instruction) || !scc_ir_type_is_vector(instruction->type))
+    return 0;
+
+  // Incoming values of a `phi` must match it.
+  if (pinned[i])
+    return 0;
+
+  switch (instruction->op) {
+    case SCC_IR_OPERATION_SWIZZLE:
+    case SCC_IR_OPERATION_COMPOSE:
+      break;
+
+    default:
+      if (!scc_ir_instruction_is_component_wise(function, instruction))
+        return 0;
+  }
+
+  // Nothing demanded is left for `SCC_IR_DCE_PASS` instead.
+  const scc_uint32_t extent = scc_ir_components_extent(demanded->components[i]);
+
+  if ((extent == 0) || (extent >= instruction->type.rows))
+    return 0;
+
+  if (instruction->op != SCC_IR_OPERATION_COMPOSE)
+    return extent;
+
+  // Only whole inputs can be dropped from compositions.
+  scc_uint32_t covered = 0;
+
+  for (scc_uint32_t operand = 0; operand < instruction->num_of_operands; ++operand) {
+    covered += scc_ir_type_num_of_components(scc_ir_value_type(function, scc_ir_operand(function, instruction, operand)));
+
+    if (covered >= extent)
+      return (covered < instruction->type.rows) ? covered : 0;
+  }
+
+  return 0;
+}
+
+// Returns `value` with `width` components for use by `before`. Components
+// beyond those of `value` are filled with its first, which is fine as only
+// components that aren't demanded are ever filled.
+static scc_ir_value_t scc_ir_shrink_adapt(scc_ir_function_t *function,
+                                          scc_uint32_t before,
+                                          scc_ir_value_t value,
+                                          scc_uint32_t width) {
+  const scc_ir_type_t type = scc_ir_value_type(function, value);
+
+  if (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_CONSTANT) {
+    // Copied as interning may move the pool.
+    scc_ir_constant_t narrowed = *scc_ir_value_constant(function, value);
+
+    scc_assert_debug(width < type.rows);
+
+    narrowed.type = scc_ir_type_reshape(type, width, 1);
+
+    memset(&narrowed.components[width], 0, (16 - width) * sizeof(scc_ir_component_t));
+
+    return scc_ir_function_constant(function, &narrowed);
+  }
+
+  scc_uint32_t mask = 0;
+
+  for (scc_uint32_t lane = 0; lane < width; ++lane)
+    mask |= ((lane < type.rows) ? lane : 0) << (lane * 2);
+
+  const scc_ir_value_t operands[2] = { value, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, mask) };
+
+  return scc_ir_function_insert(function,
+                                before,
+                                SCC_IR_OPERATION_SWIZZLE,
+                                scc_ir_type_reshape(type, width, 1),
+                                operands,
+                                2);
+}
+
+// Returns the number of components `user` expects of its `operand`, given the
+// original width of everything narrowed, or zero if it takes it as it is.
+static scc_uint32_t scc_ir_shrink_expected(const scc_ir_function_t *function,
+                                           const scc_uint8_t *narrowed,
+                                           const scc_ir_instruction_t *user,
+                                           scc_uint32_t operand) {
+  const scc_ir_value_t value = scc_ir_operand(function, user, operand);
+  const scc_ir_type_t type = scc_ir_value_type(function, value);
+
+  // Narrowing one of these couldn't change a constant.
+  const scc_uint8_t original =
+    (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION) ? narrowed[SCC_IR_VALUE_INDEX(value)] : 0;
+
+  if (!scc_ir_type_is_vector(type))
+    return 0;
+
+  if (user->op == SCC_IR_OPERATION_COMPOSE)
+    return original;
+
+  if (scc_ir_instruction_is_component_wise(function, user))
+    return scc_ir_type_is_vector(user->type) ? user->type.rows : 0;
+
+  return original;
+}
+
+static scc_bool_t scc_ir_shrink_run(scc_ir_pass_context_t *context,
+                                    scc_ir_function_t *function) {
+  if (function->num_of_blocks == 0)
+    return SCC_FALSE;
+
+  const scc_ir_demanded_t *demanded = scc_ir_get_demanded(context, function);
+
+  scc_allocator_t *scratch = context->scratch;
+
+  const scc_uint32_t n = function->num_of_instructions;
+
+  scc_bool_t *pinned = (scc_bool_t *)scratch->allocate(scratch, (n + 1) * sizeof(scc_bool_t), 16);
+
+  // Original width of each instruction narrowed, or zero.
+  scc_uint8_t *narrowed = (scc_uint8_t *)scratch->allocate(scratch, n + 1, 16);
+
+  for (scc_uint32_t i = 0; i < n; ++i) {
+    const scc_ir_instruction_t *phi = &function->instructions[i];
+
+    if ((phi->op != SCC_IR_OPERATION_PHI) || !scc_ir_instruction_is_live(phi))
+      continue;
+
+    const scc_ir_value_t *operands = scc_ir_operands(function, phi);
+
+    for (scc_uint32_t operand = 1; operand < phi->num_of_operands; operand += 2)
+      if (SCC_IR_VALUE_KIND(operands[operand]) == SCC_IR_VALUE_INSTRUCTION)
+        pinned[SCC_IR_VALUE_INDEX(operands[operand])] = SCC_TRUE;
+  }
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t i = 0; i < n; ++i) {
+    const scc_uint32_t extent = scc_ir_shrink_extent(function, demanded, pinned, i);
+
+    if (extent == 0)
+      continue;
+
+    scc_ir_instruction_t *narrowing = &function->instructions[i];
+
+    narrowed[i] = narrowing->type.rows;
+    narrowing->type = scc_ir_type_reshape(narrowing->type, extent, 1);
+
+    // Drops inputs to compositions that are no longer needed.
+    if (narrowing->op == SCC_IR_OPERATION_COMPOSE) {
+      scc_ir_value_t operands[16];
+      scc_uint32_t num_of_operands = 0;
+
+      for (scc_uint32_t covered = 0; covered < extent; ++num_of_operands) {
+        operands[num_of_operands] = scc_ir_operand(function, narrowing, num_of_operands);
+        covered += scc_ir_type_num_of_components(scc_ir_value_type(function, operands[num_of_operands]));
+      }
+
+      scc_ir_function_set_operands(function, i, operands, num_of_operands);
+    }
+
+    changed = SCC_TRUE;
+  }
+
+  if (!changed)
+    return SCC_FALSE;
+
+  // Reconciles operands with what uses them, now that either may be narrower.
+  // Instructions inserted along the way are made to match already.
+  for (scc_uint32_t i = 0; i < n; ++i) {
+    const scc_ir_instruction_t *user = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(user) || (user->op == SCC_IR_OPERATION_PHI))
+      continue;
+
+    if (user->op == SCC_IR_OPERATION_SWIZZLE) {
+      const scc_ir_value_t source = scc_ir_operand(function, user, 0);
+      const scc_uint32_t width = scc_ir_value_type(function, source).rows;
+
+      // Components selected beyond those left aren't demanded.
+      scc_uint32_t mask = SCC_IR_VALUE_INDEX(scc_ir_operand(function, user, 1));
+
+      for (scc_uint32_t lane = 0; lane < SCC_MIN(user->type.rows, 4); ++lane)
+        if (SCC_IR_SWIZZLE_LANE(mask, lane) >= width)
+          mask &= ~(3u << (lane * 2));
+
+      scc_ir_operands(function, user)[1] = SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, mask);
+
+      continue;
+    }
+
+    for (scc_uint32_t operand = 0; operand < function->instructions[i].num_of_operands; ++operand) {
+      const scc_uint32_t expected =
+        scc_ir_shrink_expected(function, narrowed, &function->instructions[i], operand);
+
+      const scc_ir_value_t value = scc_ir_operand(function, &function->instructions[i], operand);
+
+      if ((expected == 0) || (expected == scc_ir_value_type(function, value).rows))
+        continue;
+
+      // Constants are only ever wider than needed.
+      if ((SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_CONSTANT) && (expected > scc_ir_value_type(function, value).rows))
+        continue;
+
+      const scc_ir_value_t adapted = scc_ir_shrink_adapt(function, i, value, expected);
+
+      // Inserting may have moved operands.
+      scc_ir_operands(function, &function->instructions[i])[operand] = adapted;
+    }
+  }
+
+  return SCC_TRUE;
+}
+
+const scc_ir_pass_t SCC_IR_SHRINK_PASS = {
+  "shrink",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  &scc_ir_shrink_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,547 @@
+//===-- scc/ir/passes/strength_reduction.cc -------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+#include <math.h>
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_reducer {
+  scc_ir_function_t *function;
+
+  scc_allocator_t *scratch;
+
+  const scc_ir_uses_t *uses;
+
+  // Indexed by instruction. Grown as instructions are added.
+  scc_ir_value_t *forwarding;
+  scc_uint32_t capacity;
+} scc_ir_reducer_t;
+
+/// Reduces `instruction`, returning the value to replace it with, itself if
+/// it was rewritten in place, or `SCC_IR_NO_VALUE` if the rule doesn't apply.
+typedef scc_ir_value_t (*scc_ir_reduction_fn)(scc_ir_reducer_t *reducer,
+                                              scc_uint32_t instruction);
+
+typedef struct scc_ir_reduction {
+  scc_ir_operation_t op;
+
+  // Only applied if `scc_ir_pass_options_t::fast_math` is set.
+  scc_bool_t inexact;
+
+  scc_ir_reduction_fn reduce;
+} scc_ir_reduction_t;
+
+//===----------------------------------------------------------------------===//
+// Helpers
+//===----------------------------------------------------------------------===//
+
+static void scc_ir_reducer_reserve(scc_ir_reducer_t *reducer) {
+  const scc_uint32_t needed = reducer->function->num_of_instructions;
+
+  if (needed <= reducer->capacity)
+    return;
+
+  const scc_uint32_t capacity = SCC_MAX(needed, reducer->capacity * 2);
+
+  scc_ir_value_t *forwarding =
+    (scc_ir_value_t *)reducer->scratch->allocate(reducer->scratch, capacity * sizeof(scc_ir_value_t), 16);
+
+  if (reducer->capacity)
+    memcpy(forwarding, reducer->forwarding, reducer->capacity * sizeof(scc_ir_value_t));
+
+  reducer->forwarding = forwarding;
+  reducer->capacity = capacity;
+}
+
+static scc_ir_value_t scc_ir_reducer_resolve(const scc_ir_reducer_t *reducer,
+                                             scc_ir_value_t value) {
+  while ((SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION)
+      && (reducer->forwarding[SCC_IR_VALUE_INDEX(value)] != SCC_IR_NO_VALUE))
+    value = reducer->forwarding[SCC_IR_VALUE_INDEX(value)];
+  return value;
+}
+
+static scc_ir_value_t scc_ir_reducer_operand(const scc_ir_reducer_t *reducer,
+                                             scc_uint32_t instruction,
+                                             scc_uint32_t operand) {
+  const scc_ir_function_t *function = reducer->function;
+  return scc_ir_reducer_resolve(reducer, scc_ir_operand(function, &function->instructions[instruction], operand));
+}
+
+// Returns the instruction that produces `value` if it's `op`, or `SCC_IR_NONE`.
+static scc_uint32_t scc_ir_reducer_defined_by(const scc_ir_reducer_t *reducer,
+                                              scc_ir_value_t value,
+                                              scc_ir_operation_t op) {
+  if (SCC_IR_VALUE_KIND(value) != SCC_IR_VALUE_INSTRUCTION)
+    return SCC_IR_NONE;
+
+  if (reducer->function->instructions[SCC_IR_VALUE_INDEX(value)].op != op)
+    return SCC_IR_NONE;
+
+  return SCC_IR_VALUE_INDEX(value);
+}
+
+// Determines if `value` is a floating-point constant with every component
+// the same, and if so, what that is.
+static scc_bool_t scc_ir_reducer_is_splat(const scc_ir_reducer_t *reducer,
+                                          scc_ir_value_t value,
+                                          scc_float64_t *splat) {
+  const scc_ir_constant_t *constant = scc_ir_value_constant(reducer->function, value);
+
+  if (!constant || !scc_ir_type_is_floating_point(constant->type))
+    return SCC_FALSE;
+
+  const scc_uint32_t components = scc_ir_type_num_of_components(constant->type);
+
+  for (scc_uint32_t component = 1; component < components; ++component)
+    if (constant->components[component].f != constant->components[0].f)
+      return SCC_FALSE;
+
+  *splat = constant->components[0].f;
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_reducer_is_splat_of(const scc_ir_reducer_t *reducer,
+                                             scc_ir_value_t value,
+                                             scc_float64_t expected) {
+  scc_float64_t splat;
+  return scc_ir_reducer_is_splat(reducer, value, &splat) && (splat == expected);
+}
+
+static scc_bool_t scc_ir_reducer_has_type_of(const scc_ir_reducer_t *reducer,
+                                             scc_ir_value_t value,
+                                             scc_uint32_t instruction) {
+  return scc_ir_type_is_equal(scc_ir_value_type(reducer->function, value),
+                              reducer->function->instructions[instruction].type);
+}
+
+// Determines if `instruction` is the only user of its result, erring on the
+// side of no for anything added since uses were counted.
+static scc_bool_t scc_ir_reducer_has_one_use(const scc_ir_reducer_t *reducer,
+                                             scc_uint32_t instruction) {
+  if (instruction >= reducer->uses->num_of_instructions)
+    return SCC_FALSE;
+  return (reducer->uses->counts[instruction] == 1);
+}
+
+static scc_ir_value_t scc_ir_reducer_emit(scc_ir_reducer_t *reducer,
+                                          scc_uint32_t before,
+                                          scc_ir_operation_t op,
+                                          scc_ir_type_t type,
+                                          const scc_ir_value_t *operands,
+                                          scc_uint32_t num_of_operands) {
+  const scc_ir_value_t emitted =
+    scc_ir_function_insert(reducer->function, before, op, type, operands, num_of_operands);
+
+  scc_ir_reducer_reserve(reducer);
+
+  return emitted;
+}
+
+static scc_ir_value_t scc_ir_reducer_rewrite(scc_ir_reducer_t *reducer,
+                                             scc_uint32_t instruction,
+                                             scc_ir_operation_t op,
+                                             const scc_ir_value_t *operands,
+                                             scc_uint32_t num_of_operands) {
+  reducer->function->instructions[instruction].op = (scc_uint16_t)op;
+  scc_ir_function_set_operands(reducer->function, instruction, operands, num_of_operands);
+  return SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, instruction);
+}
+
+// Rounds like a value of `type` would be.
+static scc_float64_t scc_ir_reducer_round(scc_ir_type_t type,
+                                          scc_float64_t value) {
+  return (type.scalar == SCC_IR_F32) ? (scc_float64_t)(scc_float32_t)value : value;
+}
+
+// Determines if `value` is Euler's number, either exactly or as precisely as
+// its type allows.
+static scc_bool_t scc_ir_reducer_is_e(const scc_ir_reducer_t *reducer,
+                                      scc_ir_value_t value) {
+  static const scc_float64_t E = 2.71828182845904523536;
+
+  scc_float64_t splat;
+
+  if (!scc_ir_reducer_is_splat(reducer, value, &splat))
+    return SCC_FALSE;
+
+  const scc_ir_type_t type = scc_ir_value_type(reducer->function, value);
+
+  return (splat == E) || (splat == scc_ir_reducer_round(type, E));
+}
+
+//===----------------------------------------------------------------------===//
+// Rules
+//===----------------------------------------------------------------------===//
+
+// pow %x, 0 => 1
+// pow %x, 1 => %x
+// pow %x, 2 => mul %x, %x
+static scc_ir_value_t scc_ir_reduce_pow_by_integer(scc_ir_reducer_t *reducer,
+                                                   scc_uint32_t pow) {
+  const scc_ir_value_t x = scc_ir_reducer_operand(reducer, pow, 0);
+  const scc_ir_value_t exponent = scc_ir_reducer_operand(reducer, pow, 1);
+
+  if (!scc_ir_reducer_has_type_of(reducer, x, pow))
+    return SCC_IR_NO_VALUE;
+
+  if (scc_ir_reducer_is_splat_of(reducer, exponent, 0.0))
+    return scc_ir_function_splat(reducer->function, reducer->function->instructions[pow].type, 1.0);
+
+  if (scc_ir_reducer_is_splat_of(reducer, exponent, 1.0))
+    return x;
+
+  if (scc_ir_reducer_is_splat_of(reducer, exponent, 2.0)) {
+    const scc_ir_value_t operands[2] = { x, x };
+    return scc_ir_reducer_rewrite(reducer, pow, SCC_IR_OPERATION_MULTIPLY, operands, 2);
+  }
+
+  return SCC_IR_NO_VALUE;
+}
+
+// pow %x, 0.5 => sqrt %x
+// pow %x, -0.5 => rsqrt %x
+static scc_ir_value_t scc_ir_reduce_pow_by_half(scc_ir_reducer_t *reducer,
+                                                scc_uint32_t pow) {
+  const scc_ir_value_t x = scc_ir_reducer_operand(reducer, pow, 0);
+  const scc_ir_value_t exponent = scc_ir_reducer_operand(reducer, pow, 1);
+
+  if (!scc_ir_reducer_has_type_of(reducer, x, pow))
+    return SCC_IR_NO_VALUE;
+
+  if (scc_ir_reducer_is_splat_of(reducer, exponent, 0.5))
+    return scc_ir_reducer_rewrite(reducer, pow, SCC_IR_OPERATION_SQRT, &x, 1);
+
+  if (scc_ir_reducer_is_splat_of(reducer, exponent, -0.5))
+    return scc_ir_reducer_rewrite(reducer, pow, SCC_IR_OPERATION_RSQRT, &x, 1);
+
+  return SCC_IR_NO_VALUE;
+}
+
+// Reciprocal of `divisor`, if it's a floating-point constant. If `exact`,
+// only if the reciprocal of every component is exact, i.e. is a power of two.
+static scc_ir_value_t scc_ir_reducer_reciprocal(scc_ir_reducer_t *reducer,
+                                                scc_ir_value_t divisor,
+                                                scc_bool_t exact) {
+  const scc_ir_constant_t *constant = scc_ir_value_constant(reducer->function, divisor);
+
+  if (!constant || !scc_ir_type_is_floating_point(constant->type))
+    return SCC_IR_NO_VALUE;
+
+  scc_ir_constant_t reciprocal = *constant;
+
+  const scc_uint32_t components = scc_ir_type_num_of_components(constant->type);
+
+  for (scc_uint32_t component = 0; component < components; ++component) {
+    const scc_float64_t value = constant->components[component].f;
+
+    if ((value == 0.0) || !isfinite(value))
+      return SCC_IR_NO_VALUE;
+
+    const scc_float64_t inverted = scc_ir_reducer_round(constant->type, 1.0 / value);
+
+    // Guard against overflow and loss of precision in subnormals.
+    if (!isnormal(inverted) || ((constant->type.scalar == SCC_IR_F32) && !isnormal((scc_float32_t)inverted)))
+      return SCC_IR_NO_VALUE;
+
+    if (exact) {
+      int exponent;
+      if (fabs(frexp(value, &exponent)) != 0.5)
+        return SCC_IR_NO_VALUE;
+    }
+
+    reciprocal.components[component].f = inverted;
+  }
+
+  return scc_ir_function_constant(reducer->function, &reciprocal);
+}
+
+// div %x, 4 => mul %x, 0.25
+static scc_ir_value_t scc_ir_reduce_div_by_power_of_two(scc_ir_reducer_t *reducer,
+                                                        scc_uint32_t div) {
+  const scc_ir_value_t reciprocal =
+    scc_ir_reducer_reciprocal(reducer, scc_ir_reducer_operand(reducer, div, 1), SCC_TRUE);
+
+  if (reciprocal == SCC_IR_NO_VALUE)
+    return SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t operands[2] = { scc_ir_reducer_operand(reducer, div, 0), reciprocal };
+  return scc_ir_reducer_rewrite(reducer, div, SCC_IR_OPERATION_MULTIPLY, operands, 2);
+}
+
+// div %x, 3 => mul %x, 0.333...
+static scc_ir_value_t scc_ir_reduce_div_by_constant(scc_ir_reducer_t *reducer,
+                                                    scc_uint32_t div) {
+  const scc_ir_value_t reciprocal =
+    scc_ir_reducer_reciprocal(reducer, scc_ir_reducer_operand(reducer, div, 1), SCC_FALSE);
+
+  if (reciprocal == SCC_IR_NO_VALUE)
+    return SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t operands[2] = { scc_ir_reducer_operand(reducer, div, 0), reciprocal };
+  return scc_ir_reducer_rewrite(reducer, div, SCC_IR_OPERATION_MULTIPLY, operands, 2);
+}
+
+// div 1, (sqrt %y) => rsqrt %y
+// div %x, (sqrt %y) => mul %x, (rsqrt %y)
+static scc_ir_value_t scc_ir_reduce_div_by_sqrt(scc_ir_reducer_t *reducer,
+                                                scc_uint32_t div) {
+  const scc_ir_value_t x = scc_ir_reducer_operand(reducer, div, 0);
+
+  const scc_uint32_t sqrt =
+    scc_ir_reducer_defined_by(reducer, scc_ir_reducer_operand(reducer, div, 1), SCC_IR_OPERATION_SQRT);
+
+  if (sqrt == SCC_IR_NONE)
+    return SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t y = scc_ir_reducer_operand(reducer, sqrt, 0);
+
+  if (scc_ir_reducer_is_splat_of(reducer, x, 1.0) && scc_ir_reducer_has_type_of(reducer, y, div))
+    return scc_ir_reducer_rewrite(reducer, div, SCC_IR_OPERATION_RSQRT, &y, 1);
+
+  const scc_ir_value_t rsqrt =
+    scc_ir_reducer_emit(reducer, div, SCC_IR_OPERATION_RSQRT, reducer->function->instructions[sqrt].type, &y, 1);
+
+  const scc_ir_value_t operands[2] = { x, rsqrt };
+  return scc_ir_reducer_rewrite(reducer, div, SCC_IR_OPERATION_MULTIPLY, operands, 2);
+}
+
+// Operand of `instruction` if it's the inverse of `op`, or `SCC_IR_NO_VALUE`.
+static scc_ir_value_t scc_ir_reducer_inverted(const scc_ir_reducer_t *reducer,
+                                              scc_ir_value_t value,
+                                              scc_ir_operation_t op) {
+  if (SCC_IR_VALUE_KIND(value) != SCC_IR_VALUE_INSTRUCTION)
+    return SCC_IR_NO_VALUE;
+
+  const scc_uint32_t inverse = SCC_IR_VALUE_INDEX(value);
+
+  switch (reducer->function->instructions[inverse].op) {
+    case SCC_IR_OPERATION_EXP:
+      if (op == SCC_IR_OPERATION_LOG)
+        return scc_ir_reducer_operand(reducer, inverse, 0);
+      break;
+    case SCC_IR_OPERATION_EXP2:
+      if (op == SCC_IR_OPERATION_LOG2)
+        return scc_ir_reducer_operand(reducer, inverse, 0);
+      break;
+    case SCC_IR_OPERATION_EXP10:
+      if (op == SCC_IR_OPERATION_LOG10)
+        return scc_ir_reducer_operand(reducer, inverse, 0);
+      break;
+    case SCC_IR_OPERATION_LOG:
+      // Only natural logarithms.
+      if (op == SCC_IR_OPERATION_EXP)
+        if (scc_ir_reducer_is_e(reducer, scc_ir_reducer_operand(reducer, inverse, 0)))
+          return scc_ir_reducer_operand(reducer, inverse, 1);
+      break;
+    case SCC_IR_OPERATION_LOG2:
+      if (op == SCC_IR_OPERATION_EXP2)
+        return scc_ir_reducer_operand(reducer, inverse, 0);
+      break;
+    case SCC_IR_OPERATION_LOG10:
+      if (op == SCC_IR_OPERATION_EXP10)
+        return scc_ir_reducer_operand(reducer, inverse, 0);
+      break;
+  }
+
+  return SCC_IR_NO_VALUE;
+}
+
+// exp2 (log2 %x) => %x
+// log2 (exp2 %x) => %x
+//
+// And likewise for base 10 and natural logarithms.
+static scc_ir_value_t scc_ir_reduce_exp_of_log(scc_ir_reducer_t *reducer,
+                                               scc_uint32_t outer) {
+  const scc_ir_operation_t op = (scc_ir_operation_t)reducer->function->instructions[outer].op;
+
+  scc_ir_value_t inner;
+
+  if (op == SCC_IR_OPERATION_LOG) {
+    // Only natural logarithms.
+    if (!scc_ir_reducer_is_e(reducer, scc_ir_reducer_operand(reducer, outer, 0)))
+      return SCC_IR_NO_VALUE;
+    inner = scc_ir_reducer_operand(reducer, outer, 1);
+  } else {
+    inner = scc_ir_reducer_operand(reducer, outer, 0);
+  }
+
+  const scc_ir_value_t x = scc_ir_reducer_inverted(reducer, inner, op);
+
+  if ((x == SCC_IR_NO_VALUE) || !scc_ir_reducer_has_type_of(reducer, x, outer))
+    return SCC_IR_NO_VALUE;
+
+  return x;
+}
+
+// lt (length %v), 2 => lt (dot %v, %v), 4
+//
+// And likewise for other orderings and with operands exchanged.
+static scc_ir_value_t scc_ir_reduce_length_comparison(scc_ir_reducer_t *reducer,
+                                                      scc_uint32_t comparison) {
+  for (scc_uint32_t side = 0; side < 2; ++side) {
+    const scc_ir_value_t measured = scc_ir_reducer_operand(reducer, comparison, side);
+    const scc_ir_value_t limit = scc_ir_reducer_operand(reducer, comparison, side ^ 1);
+
+    scc_uint32_t length = scc_ir_reducer_defined_by(reducer, measured, SCC_IR_OPERATION_LENGTH);
+
+    if (length == SCC_IR_NONE)
+      length = scc_ir_reducer_defined_by(reducer, measured, SCC_IR_OPERATION_MAGNITUDE);
+
+    if (length == SCC_IR_NONE)
+      continue;
+
+    // Otherwise the length is still computed, and this only adds work.
+    if (!scc_ir_reducer_has_one_use(reducer, length))
+      continue;
+
+    scc_float64_t bound;
+
+    // Squaring preserves order only if non-negative.
+    if (!scc_ir_reducer_is_splat(reducer, limit, &bound) || !(bound >= 0.0))
+      continue;
+
+    const scc_ir_type_t type = scc_ir_value_type(reducer->function, limit);
+
+    if (!scc_ir_type_is_scalar(type))
+      continue;
+
+    const scc_ir_value_t v = scc_ir_reducer_operand(reducer, length, 0);
+
+    const scc_ir_value_t operands[2] = { v, v };
+
+    const scc_ir_value_t dot =
+      scc_ir_reducer_emit(reducer, comparison, SCC_IR_OPERATION_DOT, reducer->function->instructions[length].type, operands, 2);
+
+    const scc_ir_value_t squared =
+      scc_ir_function_splat(reducer->function, type, scc_ir_reducer_round(type, bound * bound));
+
+    const scc_ir_value_t compared[2] = { side ? squared : dot, side ? dot : squared };
+
+    return scc_ir_reducer_rewrite(reducer,
+                                  comparison,
+                                  (scc_ir_operation_t)reducer->function->instructions[comparison].op,
+                                  compared, 2);
+  }
+
+  return SCC_IR_NO_VALUE;
+}
+
+// Tried in order, until one applies.
+static const scc_ir_reduction_t REDUCTIONS[] = {
+  { SCC_IR_OPERATION_POW,              SCC_FALSE, &scc_ir_reduce_pow_by_integer },
+  { SCC_IR_OPERATION_POW,              SCC_TRUE,  &scc_ir_reduce_pow_by_half },
+
+  { SCC_IR_OPERATION_DIVIDE,           SCC_FALSE, &scc_ir_reduce_div_by_power_of_two },
+  { SCC_IR_OPERATION_DIVIDE,           SCC_TRUE,  &scc_ir_reduce_div_by_constant },
+  { SCC_IR_OPERATION_DIVIDE,           SCC_TRUE,  &scc_ir_reduce_div_by_sqrt },
+
+  { SCC_IR_OPERATION_EXP,              SCC_TRUE,  &scc_ir_reduce_exp_of_log },
+  { SCC_IR_OPERATION_EXP2,             SCC_TRUE,  &scc_ir_reduce_exp_of_log },
+  { SCC_IR_OPERATION_EXP10,            SCC_TRUE,  &scc_ir_reduce_exp_of_log },
+  { SCC_IR_OPERATION_LOG,              SCC_TRUE,  &scc_ir_reduce_exp_of_log },
+  { SCC_IR_OPERATION_LOG2,             SCC_TRUE,  &scc_ir_reduce_exp_of_log },
+  { SCC_IR_OPERATION_LOG10,            SCC_TRUE,  &scc_ir_reduce_exp_of_log },
+
+  { SCC_IR_OPERATION_LESS,             SCC_TRUE,  &scc_ir_reduce_length_comparison },
+  { SCC_IR_OPERATION_LESS_OR_EQUAL,    SCC_TRUE,  &scc_ir_reduce_length_comparison },
+  { SCC_IR_OPERATION_GREATER,          SCC_TRUE,  &scc_ir_reduce_length_comparison },
+  { SCC_IR_OPERATION_GREATER_OR_EQUAL, SCC_TRUE,  &scc_ir_reduce_length_comparison }
+};
+
+static const scc_uint32_t NUM_OF_REDUCTIONS = sizeof(REDUCTIONS) / sizeof(REDUCTIONS[0]);
+
+//===----------------------------------------------------------------------===//
+// Pass
+//===----------------------------------------------------------------------===//
+
+// Applies rules to `instruction` until none do. Returns true if any did.
+static scc_bool_t scc_ir_reducer_reduce(scc_ir_reducer_t *reducer,
+                                        scc_uint32_t instruction,
+                                        scc_bool_t fast_math) {
+  // Bounded in case rules undo each other.
+  for (scc_uint32_t attempt = 0; attempt < 8; ++attempt) {
+    const scc_uint32_t op = reducer->function->instructions[instruction].op;
+
+    scc_ir_value_t reduced = SCC_IR_NO_VALUE;
+
+    for (scc_uint32_t reduction = 0; reduction < NUM_OF_REDUCTIONS; ++reduction) {
+      if (REDUCTIONS[reduction].op != op)
+        continue;
+      if (REDUCTIONS[reduction].inexact && !fast_math)
+        continue;
+
+      reduced = REDUCTIONS[reduction].reduce(reducer, instruction);
+
+      if (reduced != SCC_IR_NO_VALUE)
+        break;
+    }
+
+    if (reduced == SCC_IR_NO_VALUE)
+      return (attempt > 0);
+
+    if (reduced != SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, instruction)) {
+      reducer->forwarding[instruction] = reduced;
+      return SCC_TRUE;
+    }
+  }
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_strength_reduction_run(scc_ir_pass_context_t *context,
+                                                scc_ir_function_t *function) {
+  scc_ir_reducer_t reducer;
+
+  reducer.function = function;
+  reducer.scratch = context->scratch;
+  reducer.uses = scc_ir_get_uses(context, function);
+  reducer.forwarding = NULL;
+  reducer.capacity = 0;
+
+  scc_ir_reducer_reserve(&reducer);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  for (scc_uint32_t block = 0; block < function->num_of_blocks; ++block) {
+    if (function->blocks[block].removed)
+      continue;
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+      changed |= scc_ir_reducer_reduce(&reducer, i, context->options->fast_math);
+  }
+
+  if (!changed)
+    return SCC_FALSE;
+
+  scc_ir_function_forward(function, reducer.forwarding);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+    if (reducer.forwarding[i] != SCC_IR_NO_VALUE)
+      scc_ir_function_remove(function, i);
+
+  return SCC_TRUE;
+}
+
+const scc_ir_pass_t SCC_IR_STRENGTH_REDUCTION_PASS = {
+  "strength-reduction",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  &scc_ir_strength_reduction_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
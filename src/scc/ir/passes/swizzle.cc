@@ -0,0 +1,366 @@
+//===-- scc/ir/passes/swizzle.cc ------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+#include "scc/ir/fold.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_ir_swizzles {
+  scc_ir_function_t *function;
+
+  scc_allocator_t *scratch;
+
+  // Indexed by instruction. Grown as instructions are added.
+  scc_uint32_t *counts;
+  scc_ir_value_t *forwarding;
+  scc_uint32_t capacity;
+
+  scc_bool_t changed;
+} scc_ir_swizzles_t;
+
+static void scc_ir_swizzles_reserve(scc_ir_swizzles_t *swizzles) {
+  const scc_uint32_t needed = swizzles->function->num_of_instructions;
+
+  if (needed <= swizzles->capacity)
+    return;
+
+  const scc_uint32_t capacity = SCC_MAX(needed, swizzles->capacity * 2);
+
+  scc_uint32_t *counts =
+    (scc_uint32_t *)swizzles->scratch->allocate(swizzles->scratch, capacity * sizeof(scc_uint32_t), 16);
+  scc_ir_value_t *forwarding =
+    (scc_ir_value_t *)swizzles->scratch->allocate(swizzles->scratch, capacity * sizeof(scc_ir_value_t), 16);
+
+  if (swizzles->capacity) {
+    memcpy(counts, swizzles->counts, swizzles->capacity * sizeof(scc_uint32_t));
+    memcpy(forwarding, swizzles->forwarding, swizzles->capacity * sizeof(scc_ir_value_t));
+  }
+
+  swizzles->counts = counts;
+  swizzles->forwarding = forwarding;
+  swizzles->capacity = capacity;
+}
+
+static scc_ir_value_t scc_ir_swizzles_resolve(const scc_ir_swizzles_t *swizzles,
+                                              scc_ir_value_t value) {
+  while ((SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION)
+      && (swizzles->forwarding[SCC_IR_VALUE_INDEX(value)] != SCC_IR_NO_VALUE))
+    value = swizzles->forwarding[SCC_IR_VALUE_INDEX(value)];
+  return value;
+}
+
+static void scc_ir_swizzles_use(scc_ir_swizzles_t *swizzles,
+                                scc_ir_value_t value,
+                                scc_int32_t delta) {
+  if (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_INSTRUCTION)
+    swizzles->counts[SCC_IR_VALUE_INDEX(value)] += delta;
+}
+
+// Removes `instruction` if nothing uses it, and whatever that leaves unused.
+static void scc_ir_swizzles_release(scc_ir_swizzles_t *swizzles,
+                                    scc_uint32_t instruction) {
+  scc_ir_function_t *function = swizzles->function;
+  const scc_ir_instruction_t *releasing = &function->instructions[instruction];
+
+  if (swizzles->counts[instruction] != 0)
+    return;
+
+  if (!scc_ir_instruction_is_live(releasing) || (swizzles->forwarding[instruction] != SCC_IR_NO_VALUE))
+    return;
+
+  if (!scc_ir_operation_is(releasing->op, SCC_IR_FOLDABLE))
+    return;
+
+  const scc_ir_value_t *operands = scc_ir_operands(function, releasing);
+
+  scc_ir_value_t released[16];
+  const scc_uint32_t num_of_released = SCC_MIN(releasing->num_of_operands, 16);
+
+  for (scc_uint32_t operand = 0; operand < num_of_released; ++operand)
+    released[operand] = scc_ir_swizzles_resolve(swizzles, operands[operand]);
+
+  scc_ir_function_remove(function, instruction);
+
+  for (scc_uint32_t operand = 0; operand < num_of_released; ++operand) {
+    if (SCC_IR_VALUE_KIND(released[operand]) != SCC_IR_VALUE_INSTRUCTION)
+      continue;
+    scc_ir_swizzles_use(swizzles, released[operand], -1);
+    scc_ir_swizzles_release(swizzles, SCC_IR_VALUE_INDEX(released[operand]));
+  }
+}
+
+// Replaces uses of `instruction` with `value`.
+static void scc_ir_swizzles_forward(scc_ir_swizzles_t *swizzles,
+                                    scc_uint32_t instruction,
+                                    scc_ir_value_t value) {
+  const scc_ir_instruction_t *forwarding = &swizzles->function->instructions[instruction];
+
+  // It no longer uses its source...
+  scc_ir_swizzles_use(swizzles,
+                      scc_ir_swizzles_resolve(swizzles, scc_ir_operand(swizzles->function, forwarding, 0)),
+                      -1);
+
+  // ...but its users now do.
+  scc_ir_swizzles_use(swizzles, value, swizzles->counts[instruction]);
+
+  swizzles->forwarding[instruction] = value;
+  swizzles->counts[instruction] = 0;
+
+  swizzles->changed = SCC_TRUE;
+}
+
+static scc_uint32_t scc_ir_swizzle_mask(const scc_ir_function_t *function,
+                                        const scc_ir_instruction_t *swizzle) {
+  return SCC_IR_VALUE_INDEX(scc_ir_operand(function, swizzle, 1));
+}
+
+static scc_bool_t scc_ir_swizzle_is_identity(scc_uint32_t mask,
+                                             scc_uint32_t width) {
+  for (scc_uint32_t lane = 0; lane < width; ++lane)
+    if (SCC_IR_SWIZZLE_LANE(mask, lane) != lane)
+      return SCC_FALSE;
+  return SCC_TRUE;
+}
+
+static void scc_ir_swizzles_simplify(scc_ir_swizzles_t *swizzles,
+                                     scc_uint32_t swizzle);
+
+// Creates `swizzle value, mask` before `before` and simplifies it.
+static scc_ir_value_t scc_ir_swizzles_create(scc_ir_swizzles_t *swizzles,
+                                             scc_uint32_t before,
+                                             scc_ir_value_t value,
+                                             scc_uint32_t mask,
+                                             scc_uint32_t width) {
+  scc_ir_function_t *function = swizzles->function;
+
+  const scc_ir_type_t type = scc_ir_type_reshape(scc_ir_value_type(function, value), width, 1);
+
+  const scc_ir_value_t operands[2] = { value, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, mask) };
+
+  const scc_ir_value_t created =
+    scc_ir_function_insert(function, before, SCC_IR_OPERATION_SWIZZLE, type, operands, 2);
+
+  scc_ir_swizzles_reserve(swizzles);
+
+  // Counts the use about to be made of it.
+  scc_ir_swizzles_use(swizzles, value, +1);
+  swizzles->counts[SCC_IR_VALUE_INDEX(created)] = 1;
+
+  scc_ir_swizzles_simplify(swizzles, SCC_IR_VALUE_INDEX(created));
+
+  return scc_ir_swizzles_resolve(swizzles, created);
+}
+
+// Determines if `swizzle` can be pushed through `source`, a component-wise
+// operation, without adding instructions. It can if at most one input would
+// need a swizzle of its own, as that replaces the swizzle being pushed.
+static scc_bool_t scc_ir_swizzles_should_push(const scc_ir_swizzles_t *swizzles,
+                                              const scc_ir_instruction_t *source) {
+  const scc_ir_function_t *function = swizzles->function;
+
+  scc_uint32_t needed = 0;
+
+  for (scc_uint32_t operand = 0; operand < source->num_of_operands; ++operand) {
+    const scc_ir_value_t input =
+      scc_ir_swizzles_resolve(swizzles, scc_ir_operand(function, source, operand));
+
+    // Scalars are broadcast, and constants are swizzled at compile time.
+    if (scc_ir_type_is_scalar(scc_ir_value_type(function, input)))
+      continue;
+    if (SCC_IR_VALUE_KIND(input) == SCC_IR_VALUE_CONSTANT)
+      continue;
+
+    // Composes with a swizzle that then dies.
+    if (SCC_IR_VALUE_KIND(input) == SCC_IR_VALUE_INSTRUCTION) {
+      const scc_uint32_t index = SCC_IR_VALUE_INDEX(input);
+      if ((function->instructions[index].op == SCC_IR_OPERATION_SWIZZLE) && (swizzles->counts[index] == 1))
+        continue;
+    }
+
+    needed += 1;
+  }
+
+  return (needed <= 1);
+}
+
+static void scc_ir_swizzles_push(scc_ir_swizzles_t *swizzles,
+                                 scc_uint32_t swizzle,
+                                 scc_uint32_t source) {
+  scc_ir_function_t *function = swizzles->function;
+
+  const scc_uint32_t mask = scc_ir_swizzle_mask(function, &function->instructions[swizzle]);
+  const scc_uint32_t width = function->instructions[swizzle].type.rows;
+
+  const scc_uint32_t num_of_operands = function->instructions[source].num_of_operands;
+
+  scc_ir_value_t operands[3];
+
+  for (scc_uint32_t operand = 0; operand < num_of_operands; ++operand) {
+    const scc_ir_value_t input =
+      scc_ir_swizzles_resolve(swizzles, scc_ir_operand(function, &function->instructions[source], operand));
+
+    if (scc_ir_type_is_scalar(scc_ir_value_type(function, input))) {
+      operands[operand] = input;
+      continue;
+    }
+
+    // Used by the new swizzle instead, which is counted before it's created
+    // so that it can be pushed further when this was the only other use.
+    scc_ir_swizzles_use(swizzles, input, -1);
+
+    operands[operand] = scc_ir_swizzles_create(swizzles, source, input, mask, width);
+
+    if (SCC_IR_VALUE_KIND(input) == SCC_IR_VALUE_INSTRUCTION)
+      scc_ir_swizzles_release(swizzles, SCC_IR_VALUE_INDEX(input));
+  }
+
+  scc_ir_function_set_operands(function, source, operands, num_of_operands);
+
+  // Only the swizzle used it, so it can be narrowed in place.
+  scc_ir_instruction_t *narrowing = &function->instructions[source];
+  narrowing->type = scc_ir_type_reshape(narrowing->type, width, 1);
+
+  scc_ir_swizzles_forward(swizzles, swizzle, SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, source));
+}
+
+static void scc_ir_swizzles_simplify(scc_ir_swizzles_t *swizzles,
+                                     scc_uint32_t swizzle) {
+  scc_ir_function_t *function = swizzles->function;
+
+  for (;;) {
+    const scc_ir_instruction_t *simplifying = &function->instructions[swizzle];
+
+    const scc_ir_value_t source = scc_ir_swizzles_resolve(swizzles, scc_ir_operand(function, simplifying, 0));
+    const scc_ir_type_t type = scc_ir_value_type(function, source);
+
+    const scc_uint32_t mask = scc_ir_swizzle_mask(function, simplifying);
+    const scc_uint32_t width = simplifying->type.rows;
+
+    // Leave anything malformed alone.
+    if ((simplifying->type.columns != 1) || (type.columns != 1) || (width > 4) || (type.rows > 4))
+      return;
+
+    for (scc_uint32_t lane = 0; lane < width; ++lane)
+      if (SCC_IR_SWIZZLE_LANE(mask, lane) >= type.rows)
+        return;
+
+    if ((width == type.rows) && scc_ir_swizzle_is_identity(mask, width))
+      return scc_ir_swizzles_forward(swizzles, swizzle, source);
+
+    if (SCC_IR_VALUE_KIND(source) == SCC_IR_VALUE_CONSTANT) {
+      const scc_ir_constant_t *inputs[2] = { scc_ir_value_constant(function, source), NULL };
+
+      scc_ir_constant_t swizzled;
+
+      if (scc_ir_fold(function, simplifying, inputs, &swizzled))
+        scc_ir_swizzles_forward(swizzles, swizzle, scc_ir_function_constant(function, &swizzled));
+
+      return;
+    }
+
+    if (SCC_IR_VALUE_KIND(source) != SCC_IR_VALUE_INSTRUCTION)
+      return;
+
+    const scc_uint32_t index = SCC_IR_VALUE_INDEX(source);
+    const scc_ir_instruction_t *producer = &function->instructions[index];
+
+    if (producer->op == SCC_IR_OPERATION_SWIZZLE) {
+      // Select through both masks at once.
+      const scc_uint32_t inner = scc_ir_swizzle_mask(function, producer);
+
+      scc_uint32_t composed = 0;
+
+      for (scc_uint32_t lane = 0; lane < width; ++lane)
+        composed |= SCC_IR_SWIZZLE_LANE(inner, SCC_IR_SWIZZLE_LANE(mask, lane)) << (lane * 2);
+
+      const scc_ir_value_t operands[2] = {
+        scc_ir_swizzles_resolve(swizzles, scc_ir_operand(function, producer, 0)),
+        SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, composed)
+      };
+
+      scc_ir_function_set_operands(function, swizzle, operands, 2);
+
+      scc_ir_swizzles_use(swizzles, operands[0], +1);
+      scc_ir_swizzles_use(swizzles, source, -1);
+      scc_ir_swizzles_release(swizzles, index);
+
+      swizzles->changed = SCC_TRUE;
+
+      continue;
+    }
+
+    // Scalar results aren't widened, as not every target broadcasts, nor are
+    // vectors, which would undo `SCC_IR_SHRINK_PASS`.
+    if (scc_ir_instruction_is_component_wise(function, producer)
+     && (producer->type.rows > 1)
+     && (width <= producer->type.rows)
+     && (swizzles->counts[index] == 1)
+     && (producer->num_of_operands <= 3)
+     && scc_ir_swizzles_should_push(swizzles, producer))
+      return scc_ir_swizzles_push(swizzles, swizzle, index);
+
+    return;
+  }
+}
+
+static scc_bool_t scc_ir_swizzles_run(scc_ir_pass_context_t *context,
+                                      scc_ir_function_t *function) {
+  const scc_ir_cfg_t *cfg = scc_ir_get_cfg(context, function);
+  const scc_ir_uses_t *uses = scc_ir_get_uses(context, function);
+
+  scc_ir_swizzles_t swizzles;
+
+  swizzles.function = function;
+  swizzles.scratch = context->scratch;
+  swizzles.counts = NULL;
+  swizzles.forwarding = NULL;
+  swizzles.capacity = 0;
+  swizzles.changed = SCC_FALSE;
+
+  scc_ir_swizzles_reserve(&swizzles);
+
+  memcpy(swizzles.counts, uses->counts, function->num_of_instructions * sizeof(scc_uint32_t));
+
+  // Definitions are visited before uses, so sources are already as simple as
+  // they'll get by the time a swizzle of them is.
+  for (scc_uint32_t position = 0; position < cfg->num_of_reachable; ++position) {
+    const scc_uint32_t block = cfg->order[position];
+
+    for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next)
+      if (function->instructions[i].op == SCC_IR_OPERATION_SWIZZLE)
+        if (swizzles.forwarding[i] == SCC_IR_NO_VALUE)
+          scc_ir_swizzles_simplify(&swizzles, i);
+  }
+
+  if (!swizzles.changed)
+    return SCC_FALSE;
+
+  scc_ir_function_forward(function, swizzles.forwarding);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+    if (swizzles.forwarding[i] != SCC_IR_NO_VALUE)
+      scc_ir_function_remove(function, i);
+
+  return SCC_TRUE;
+}
+
+const scc_ir_pass_t SCC_IR_SWIZZLE_PASS = {
+  "swizzle",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  &scc_ir_swizzles_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
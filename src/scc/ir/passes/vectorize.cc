@@ -0,0 +1,351 @@
+//===-- scc/ir/passes/vectorize.cc ----------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Vectors are packed bottom-up from where scalars are composed into one,
+// like what `SCC_IR_SCALARIZE_PASS` leaves behind. When every component is
+// the same component-wise operation, the composition is replaced by that
+// operation on compositions of its operands, which are then packed in turn.
+typedef struct scc_ir_vectorizer {
+  scc_ir_function_t *function;
+
+  const scc_ir_uses_t *uses;
+} scc_ir_vectorizer_t;
+
+// Determines if `lanes` can be replaced by a single operation on vectors
+// placed at `root`. If `exclusive`, lanes are known to be used by nothing
+// else, regardless of what uses were counted.
+static scc_bool_t scc_ir_vectorizer_is_packable(const scc_ir_vectorizer_t *vectorizer,
+                                                scc_uint32_t root,
+                                                const scc_ir_value_t *lanes,
+                                                scc_uint32_t num_of_lanes,
+                                                scc_bool_t exclusive) {
+  const scc_ir_function_t *function = vectorizer->function;
+  const scc_ir_uses_t *uses = vectorizer->uses;
+
+  const scc_uint32_t block = function->instructions[root].block;
+
+  const scc_ir_instruction_t *first = NULL;
+
+  for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane) {
+    if (SCC_IR_VALUE_KIND(lanes[lane]) != SCC_IR_VALUE_INSTRUCTION)
+      return SCC_FALSE;
+
+    const scc_uint32_t i = SCC_IR_VALUE_INDEX(lanes[lane]);
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    // Otherwise work would be duplicated, or moved into a loop.
+    if (!exclusive && ((i >= uses->num_of_instructions) || (uses->counts[i] != 1)))
+      return SCC_FALSE;
+    if (instruction->block != block)
+      return SCC_FALSE;
+
+    if (scc_ir_type_num_of_components(instruction->type) != 1)
+      return SCC_FALSE;
+
+    if (!scc_ir_instruction_is_component_wise(function, instruction))
+      return SCC_FALSE;
+
+    if (!first) {
+      first = instruction;
+      continue;
+    }
+
+    if (instruction->op != first->op)
+      return SCC_FALSE;
+    if (!scc_ir_type_is_equal(instruction->type, first->type))
+      return SCC_FALSE;
+    if (instruction->num_of_operands != first->num_of_operands)
+      return SCC_FALSE;
+
+    // Distinct, as each is used once.
+  }
+
+  // Operands must agree on type across lanes, so they can be packed.
+  for (scc_uint32_t operand = 0; operand < first->num_of_operands; ++operand) {
+    const scc_ir_type_t type = scc_ir_value_type(function, scc_ir_operand(function, first, operand));
+
+    if (scc_ir_type_num_of_components(type) != 1)
+      return SCC_FALSE;
+
+    for (scc_uint32_t lane = 1; lane < num_of_lanes; ++lane) {
+      const scc_ir_instruction_t *instruction = &function->instructions[SCC_IR_VALUE_INDEX(lanes[lane])];
+      const scc_ir_value_t value = scc_ir_operand(function, instruction, operand);
+
+      if (SCC_IR_VALUE_KIND(value) == SCC_IR_VALUE_UNDEFINED)
+        continue;
+
+      if (!scc_ir_type_is_equal(scc_ir_value_type(function, value), type))
+        return SCC_FALSE;
+    }
+  }
+
+  return SCC_TRUE;
+}
+
+// Packs scalars into a vector, inserted before `before` if need be.
+static scc_ir_value_t scc_ir_vectorizer_pack(scc_ir_vectorizer_t *vectorizer,
+                                             const scc_ir_value_t *scalars,
+                                             scc_uint32_t num_of_lanes,
+                                             scc_ir_type_t type,
+                                             scc_uint32_t before) {
+  scc_ir_function_t *function = vectorizer->function;
+
+  // The same scalar in every lane is broadcast.
+  scc_bool_t same = SCC_TRUE;
+
+  for (scc_uint32_t lane = 1; lane < num_of_lanes; ++lane)
+    same &= (scalars[lane] == scalars[0]);
+
+  if (same)
+    return scalars[0];
+
+  // Constants are packed into a constant.
+  scc_bool_t constant = SCC_TRUE;
+
+  for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane)
+    constant &= (SCC_IR_VALUE_KIND(scalars[lane]) == SCC_IR_VALUE_CONSTANT);
+
+  if (constant) {
+    scc_ir_constant_t vector;
+
+    memset(&vector, 0, sizeof(vector));
+
+    vector.type = type;
+
+    for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane)
+      vector.components[lane] = scc_ir_value_constant(function, scalars[lane])->components[0];
+
+    return scc_ir_function_constant(function, &vector);
+  }
+
+  // Components extracted from the same vector are swizzled out of it, or are
+  // just it.
+  scc_ir_value_t source = SCC_IR_NO_VALUE;
+  scc_uint32_t mask = 0;
+
+  for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane) {
+    if (SCC_IR_VALUE_KIND(scalars[lane]) != SCC_IR_VALUE_INSTRUCTION) {
+      source = SCC_IR_NO_VALUE;
+      break;
+    }
+
+    const scc_ir_instruction_t *extract = &function->instructions[SCC_IR_VALUE_INDEX(scalars[lane])];
+
+    if (extract->op != SCC_IR_OPERATION_SWIZZLE) {
+      source = SCC_IR_NO_VALUE;
+      break;
+    }
+
+    const scc_ir_value_t input = scc_ir_operand(function, extract, 0);
+
+    if ((lane > 0) && (input != source)) {
+      source = SCC_IR_NO_VALUE;
+      break;
+    }
+
+    source = input;
+    mask |= SCC_IR_SWIZZLE_LANE(SCC_IR_VALUE_INDEX(scc_ir_operand(function, extract, 1)), 0) << (lane * 2);
+  }
+
+  if (source != SCC_IR_NO_VALUE) {
+    const scc_ir_type_t vector = scc_ir_value_type(function, source);
+
+    if (scc_ir_type_is_vector(vector) && (vector.rows == num_of_lanes)) {
+      scc_bool_t identity = SCC_TRUE;
+
+      for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane)
+        identity &= (SCC_IR_SWIZZLE_LANE(mask, lane) == lane);
+
+      if (identity)
+        return source;
+    }
+
+    const scc_ir_value_t operands[2] = { source, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, mask) };
+    return scc_ir_function_insert(function, before, SCC_IR_OPERATION_SWIZZLE, type, operands, 2);
+  }
+
+  return scc_ir_function_insert(function, before, SCC_IR_OPERATION_COMPOSE, type, scalars, num_of_lanes);
+}
+
+static scc_bool_t scc_ir_vectorizer_vectorize(scc_ir_vectorizer_t *vectorizer,
+                                              scc_uint32_t root,
+                                              scc_bool_t exclusive);
+
+// Replaces a composition of `lanes` where some are repeated with a swizzle of
+// a composition of those that are distinct, so the latter can be packed.
+static scc_bool_t scc_ir_vectorizer_deduplicate(scc_ir_vectorizer_t *vectorizer,
+                                                scc_uint32_t root,
+                                                const scc_ir_value_t *lanes,
+                                                scc_uint32_t num_of_lanes) {
+  scc_ir_function_t *function = vectorizer->function;
+  const scc_ir_uses_t *uses = vectorizer->uses;
+
+  scc_ir_value_t distinct[4];
+  scc_uint32_t num_of_distinct = 0;
+
+  scc_uint32_t mask = 0;
+
+  for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane) {
+    scc_uint32_t index = 0;
+
+    while ((index < num_of_distinct) && (distinct[index] != lanes[lane]))
+      index += 1;
+
+    if (index == num_of_distinct)
+      distinct[num_of_distinct++] = lanes[lane];
+
+    mask |= index << (lane * 2);
+  }
+
+  if (num_of_distinct == num_of_lanes)
+    return SCC_FALSE;
+
+  // Only worthwhile if the repeats are the only uses, so the distinct can be
+  // packed in turn.
+  for (scc_uint32_t index = 0; index < num_of_distinct; ++index) {
+    if (SCC_IR_VALUE_KIND(distinct[index]) != SCC_IR_VALUE_INSTRUCTION)
+      return SCC_FALSE;
+
+    const scc_uint32_t i = SCC_IR_VALUE_INDEX(distinct[index]);
+
+    scc_uint32_t repeats = 0;
+
+    for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane)
+      repeats += (lanes[lane] == distinct[index]) ? 1 : 0;
+
+    if ((i >= uses->num_of_instructions) || (uses->counts[i] != repeats))
+      return SCC_FALSE;
+  }
+
+  const scc_ir_type_t type = function->instructions[root].type;
+
+  scc_ir_value_t operands[2];
+
+  operands[0] = (num_of_distinct > 1)
+              ? scc_ir_function_insert(function, root, SCC_IR_OPERATION_COMPOSE, scc_ir_type(type.scalar, num_of_distinct, 1), distinct, num_of_distinct)
+              : distinct[0];
+  operands[1] = SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, mask);
+
+  function->instructions[root].op = SCC_IR_OPERATION_SWIZZLE;
+  scc_ir_function_set_operands(function, root, operands, 2);
+
+  // Counted uses include the repeats, which are now gone.
+  if (num_of_distinct > 1)
+    scc_ir_vectorizer_vectorize(vectorizer, SCC_IR_VALUE_INDEX(operands[0]), SCC_TRUE);
+
+  return SCC_TRUE;
+}
+
+// Replaces the composition `root` with an operation on vectors if possible.
+static scc_bool_t scc_ir_vectorizer_vectorize(scc_ir_vectorizer_t *vectorizer,
+                                              scc_uint32_t root,
+                                              scc_bool_t exclusive) {
+  scc_ir_function_t *function = vectorizer->function;
+
+  const scc_uint32_t num_of_lanes = function->instructions[root].num_of_operands;
+
+  if ((num_of_lanes < 2) || (num_of_lanes > 4))
+    return SCC_FALSE;
+
+  scc_ir_value_t lanes[4];
+  memcpy(lanes, scc_ir_operands(function, &function->instructions[root]), num_of_lanes * sizeof(scc_ir_value_t));
+
+  if (scc_ir_vectorizer_deduplicate(vectorizer, root, lanes, num_of_lanes))
+    return SCC_TRUE;
+
+  if (!scc_ir_vectorizer_is_packable(vectorizer, root, lanes, num_of_lanes, exclusive))
+    return SCC_FALSE;
+
+  const scc_ir_instruction_t *first = &function->instructions[SCC_IR_VALUE_INDEX(lanes[0])];
+
+  const scc_ir_operation_t op = (scc_ir_operation_t)first->op;
+  const scc_uint32_t num_of_operands = first->num_of_operands;
+
+  scc_ir_value_t operands[4];
+
+  for (scc_uint32_t operand = 0; operand < num_of_operands; ++operand) {
+    scc_ir_value_t scalars[4];
+
+    for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane)
+      scalars[lane] = scc_ir_operand(function, &function->instructions[SCC_IR_VALUE_INDEX(lanes[lane])], operand);
+
+    const scc_ir_type_t scalar = scc_ir_value_type(function, scalars[0]);
+
+    operands[operand] = scc_ir_vectorizer_pack(vectorizer,
+                                               scalars,
+                                               num_of_lanes,
+                                               scc_ir_type(scalar.scalar, num_of_lanes, 1),
+                                               root);
+  }
+
+  function->instructions[root].op = op;
+  scc_ir_function_set_operands(function, root, operands, num_of_operands);
+
+  // Each was only used by the composition.
+  for (scc_uint32_t lane = 0; lane < num_of_lanes; ++lane)
+    scc_ir_function_remove(function, SCC_IR_VALUE_INDEX(lanes[lane]));
+
+  return SCC_TRUE;
+}
+
+static scc_bool_t scc_ir_vectorize_run(scc_ir_pass_context_t *context,
+                                       scc_ir_function_t *function) {
+  const scc_ir_pass_options_t *options = context->options;
+
+  scc_assert_paranoid(options->target < SCC_NUM_OF_TARGETS);
+
+  const scc_uint32_t width = SCC_TARGETS[options->target].vector_width;
+
+  // Scalars are preferred.
+  if (width < 2)
+    return SCC_FALSE;
+
+  scc_ir_vectorizer_t vectorizer;
+
+  vectorizer.function = function;
+  vectorizer.uses = scc_ir_get_uses(context, function);
+
+  scc_bool_t changed = SCC_FALSE;
+
+  // Compositions of operands are added as packing goes, and visited in turn.
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction))
+      continue;
+
+    if (instruction->op != SCC_IR_OPERATION_COMPOSE)
+      continue;
+
+    if (instruction->num_of_operands > width)
+      continue;
+
+    changed |= scc_ir_vectorizer_vectorize(&vectorizer, i, SCC_FALSE);
+  }
+
+  return changed;
+}
+
+const scc_ir_pass_t SCC_IR_VECTORIZE_PASS = {
+  "vectorize",
+  SCC_IR_FUNCTION_PASS,
+  SCC_IR_PRESERVES_CONTROL_FLOW,
+  &scc_ir_vectorize_run,
+  NULL
+};
+
+SCC_END_EXTERN_C
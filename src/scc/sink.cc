@@ -0,0 +1,71 @@
+//===-- scc/sink.cc -------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/sink.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_sink_to_file {
+  scc_sink_t sink;
+  FILE *file;
+
+  // Whether the file was opened by us, and so is closed by us.
+  scc_bool_t owned;
+} scc_sink_to_file_t;
+
+static scc_size_t scc_write_to_file(scc_sink_to_file_t *sink,
+                                    const char *buffer,
+                                    scc_size_t count) {
+  return fwrite((const void *)buffer, 1, count, sink->file);
+}
+
+static void scc_close_file(scc_sink_to_file_t *sink) {
+  if (sink->owned)
+    fclose(sink->file);
+  else
+    fflush(sink->file);
+
+  free((void *)sink);
+}
+
+scc_sink_t *scc_sink_to_path(const char *path) {
+  scc_assert_paranoid(path != NULL);
+
+  if (FILE *file = fopen(path, "wb")) {
+    scc_sink_t *sink = scc_sink_to_file(file);
+    ((scc_sink_to_file_t *)sink)->owned = SCC_TRUE;
+    return sink;
+  }
+
+  return NULL;
+}
+
+scc_sink_t *scc_sink_to_file(FILE *file) {
+  scc_assert_paranoid(file != NULL);
+
+  scc_sink_to_file_t *sink =
+    (scc_sink_to_file_t *)calloc(sizeof(scc_sink_to_file_t), 1);
+
+  sink->sink.write = (scc_sink_write_fn)&scc_write_to_file;
+  sink->sink.close = (scc_sink_close_fn)&scc_close_file;
+  sink->file = file;
+  sink->owned = SCC_FALSE;
+
+  return &sink->sink;
+}
+
+void scc_sink_close(scc_sink_t *sink) {
+  sink->close(sink);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,26 @@
+//===-- scc/target.cc -----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "scc/target.h"
+
+SCC_BEGIN_EXTERN_C
+
+const scc_target_info_t SCC_TARGETS[SCC_NUM_OF_TARGETS] = {
+  { "host",  1 },
+  { "glsl",  4 },
+  { "hlsl",  4 },
+  { "spirv", 4 },
+  { "msl",   4 }
+};
+
+SCC_END_EXTERN_C
@@ -0,0 +1,182 @@
+//===-- tests/bytecode.cc -------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/ir/bytecode.h"
+
+SCC_BEGIN_EXTERN_C
+
+enum {
+  SCC_TEST_ENTRY  = 0,
+  SCC_TEST_LEFT   = 1,
+  SCC_TEST_RIGHT  = 2,
+  SCC_TEST_ORPHAN = 3,
+  SCC_TEST_JOIN   = 4
+};
+
+// Values whose slots are checked.
+typedef struct scc_test_bytecode_values {
+  scc_ir_value_t x, s, sum, scaled, first, negative, floored, joined, threshold;
+} scc_test_bytecode_values_t;
+
+// Doubles `x` then scales it by `s`, flooring the result if its first
+// component is below a threshold, with a block nothing branches to.
+static scc_ir_module_t *scc_test_bytecode_module(scc_test_bytecode_values_t *values) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "f", f32x4);
+
+  scc_ir_function_add_block(function, "entry");
+  scc_ir_function_add_block(function, "left");
+  scc_ir_function_add_block(function, "right");
+  scc_ir_function_add_block(function, "orphan");
+  scc_ir_function_add_block(function, "join");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  values->x = scc_ir_function_add_argument(function, "x", f32x4);
+  values->s = scc_ir_function_add_argument(function, "s", f32);
+  values->threshold = scc_ir_function_splat(function, f32, -1.5);
+
+  values->sum = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_ADD, f32x4, values->x, values->x, nothing);
+  values->scaled = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_MULTIPLY, f32x4, values->sum, values->s, nothing);
+  values->first = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_SWIZZLE, f32, values->sum, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 0, 0, 0)), nothing);
+  values->negative = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_LESS, boolean, values->first, values->threshold, nothing);
+  scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_BRANCH, none, values->negative, scc_test_block(SCC_TEST_LEFT), scc_test_block(SCC_TEST_RIGHT));
+
+  values->floored = scc_test_append(function, SCC_TEST_LEFT, SCC_IR_OPERATION_FLOOR, f32x4, values->scaled, nothing, nothing);
+  scc_test_append(function, SCC_TEST_LEFT, SCC_IR_OPERATION_JUMP, none, scc_test_block(SCC_TEST_JOIN), nothing, nothing);
+
+  scc_test_append(function, SCC_TEST_RIGHT, SCC_IR_OPERATION_JUMP, none, scc_test_block(SCC_TEST_JOIN), nothing, nothing);
+
+  scc_test_append(function, SCC_TEST_ORPHAN, SCC_IR_OPERATION_JUMP, none, scc_test_block(SCC_TEST_JOIN), nothing, nothing);
+
+  const scc_ir_value_t incoming[6] = {
+    scc_test_block(SCC_TEST_LEFT), values->floored,
+    scc_test_block(SCC_TEST_RIGHT), values->scaled,
+    scc_test_block(SCC_TEST_ORPHAN), values->x
+  };
+
+  values->joined = scc_ir_function_append(function, SCC_TEST_JOIN, SCC_IR_OPERATION_PHI, f32x4, incoming, 6);
+
+  scc_test_append(function, SCC_TEST_JOIN, SCC_IR_OPERATION_RETURN, none, values->joined, nothing, nothing);
+
+  return module;
+}
+
+// Checks that `count` words at `pc` are `expected`, then steps over them.
+static const scc_uint32_t *scc_test_bytecode_expect(const scc_uint32_t *pc,
+                                                    const scc_uint32_t *expected,
+                                                    scc_uint32_t count) {
+  SCC_TEST_CHECK(scc_ir_bytecode_length(pc) == count);
+  SCC_TEST_CHECK(memcmp(pc, expected, count * sizeof(scc_uint32_t)) == 0);
+  return pc + count;
+}
+
+void scc_test_bytecode(void) {
+  scc_test_bytecode_values_t values;
+
+  scc_ir_module_t *module = scc_test_bytecode_module(&values);
+
+  const scc_ir_function_t *function = module->functions[0];
+
+  scc_ir_bytecode_t *bytecode = scc_ir_bytecode_lower(function);
+
+  SCC_TEST_CHECK(bytecode != NULL);
+
+  if (bytecode) {
+    #define SCC_TEST_SLOT(Value) scc_ir_bytecode_slot(bytecode, values.Value)
+
+    // Entry first and the join last, leaving out what can't be reached.
+    SCC_TEST_CHECK(bytecode->num_of_reachable == 4);
+    SCC_TEST_CHECK(bytecode->order[0] == SCC_TEST_ENTRY);
+    SCC_TEST_CHECK(bytecode->order[3] == SCC_TEST_JOIN);
+    SCC_TEST_CHECK(bytecode->blocks[SCC_TEST_ORPHAN] == SCC_IR_NONE);
+
+    // Broadcasting a scalar splats it to scratch first.
+    const scc_uint32_t splatted = bytecode->scratch + 4 * SCC_IR_LANES;
+
+    const scc_uint32_t entry[] = {
+      SCC_IR_OPCODE_ADD_F32X4, SCC_TEST_SLOT(sum), SCC_TEST_SLOT(x), SCC_TEST_SLOT(x),
+      SCC_IR_OPCODE_SPLAT_X4, splatted, SCC_TEST_SLOT(s),
+      SCC_IR_OPCODE_MUL_F32X4, SCC_TEST_SLOT(scaled), SCC_TEST_SLOT(sum), splatted,
+      SCC_IR_OPCODE_SHUFFLE, SCC_TEST_SLOT(first), 1, SCC_TEST_SLOT(sum),
+      SCC_IR_OPCODE_LT_F32X1, SCC_TEST_SLOT(negative), SCC_TEST_SLOT(first), SCC_TEST_SLOT(threshold),
+      SCC_IR_OPCODE_BRANCH, SCC_TEST_SLOT(negative), 0, SCC_TEST_LEFT, 0, SCC_TEST_RIGHT, 0
+    };
+
+    const scc_uint32_t *pc = &bytecode->code[bytecode->blocks[SCC_TEST_ENTRY]];
+
+    pc = scc_test_bytecode_expect(pc, &entry[0], 4);
+    pc = scc_test_bytecode_expect(pc, &entry[4], 3);
+    pc = scc_test_bytecode_expect(pc, &entry[7], 4);
+    pc = scc_test_bytecode_expect(pc, &entry[11], 4);
+    pc = scc_test_bytecode_expect(pc, &entry[15], 4);
+    pc = scc_test_bytecode_expect(pc, &entry[19], 7);
+
+    // Edges copy to the phi of the block they enter.
+    const scc_uint32_t left[] = {
+      SCC_IR_OPCODE_FLOOR_F32X4, SCC_TEST_SLOT(floored), SCC_TEST_SLOT(scaled),
+      SCC_IR_OPCODE_JUMP, SCC_TEST_JOIN, 1, SCC_TEST_SLOT(joined), SCC_TEST_SLOT(floored), 4
+    };
+
+    pc = &bytecode->code[bytecode->blocks[SCC_TEST_LEFT]];
+
+    pc = scc_test_bytecode_expect(pc, &left[0], 3);
+    pc = scc_test_bytecode_expect(pc, &left[3], 6);
+
+    const scc_uint32_t right[] = {
+      SCC_IR_OPCODE_JUMP, SCC_TEST_JOIN, 1, SCC_TEST_SLOT(joined), SCC_TEST_SLOT(scaled), 4
+    };
+
+    scc_test_bytecode_expect(&bytecode->code[bytecode->blocks[SCC_TEST_RIGHT]], right, 6);
+
+    const scc_uint32_t join[] = {
+      SCC_IR_OPCODE_RETURN, SCC_TEST_SLOT(joined), 4
+    };
+
+    scc_test_bytecode_expect(&bytecode->code[bytecode->blocks[SCC_TEST_JOIN]], join, 3);
+
+    // Constants are in the image, a word per lane.
+    const scc_uint32_t threshold = SCC_TEST_SLOT(threshold);
+
+    SCC_TEST_CHECK(threshold + SCC_IR_LANES <= bytecode->size_of_image);
+
+    for (scc_uint32_t lane = 0; (lane < SCC_IR_LANES) && (threshold + lane < bytecode->size_of_image); ++lane)
+      SCC_TEST_CHECK(bytecode->image[threshold + lane].f == -1.5f);
+
+    #undef SCC_TEST_SLOT
+
+    scc_ir_bytecode_destroy(bytecode);
+  }
+
+  // Doubles can't be given a slot.
+  scc_ir_function_t *wide = scc_ir_module_add_function(module, "wide", scc_ir_type(SCC_IR_F64, 1, 1));
+
+  const scc_uint32_t entry = scc_ir_function_add_block(wide, "entry");
+  const scc_ir_value_t argument = scc_ir_function_add_argument(wide, "x", scc_ir_type(SCC_IR_F64, 1, 1));
+
+  scc_test_append(wide, entry, SCC_IR_OPERATION_RETURN, scc_ir_void(), argument, SCC_IR_NO_VALUE, SCC_IR_NO_VALUE);
+
+  SCC_TEST_CHECK(scc_ir_bytecode_lower(wide) == NULL);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,116 @@
+//===-- tests/dce.cc ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Doubles `a`, after loading `b` and scaling it for nothing. There's also a
+// block nothing branches to and a function nothing calls.
+static scc_ir_module_t *scc_test_dce_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in_a = scc_ir_module_add_global(module, "a", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_b = scc_ir_module_add_global(module, "b", SCC_IR_INPUT, f32x4, 1);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  scc_ir_function_t *unused = scc_ir_module_add_function(module, "unused", f32x4);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(unused, "entry");
+
+    const scc_ir_value_t x = scc_ir_function_add_argument(unused, "x", f32x4);
+    const scc_ir_value_t halved = scc_test_append(unused, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, x, scc_ir_function_splat(unused, f32, 0.5), nothing);
+
+    scc_test_append(unused, entry, SCC_IR_OPERATION_RETURN, none, halved, nothing, nothing);
+  }
+
+  scc_ir_function_t *main = scc_ir_module_add_function(module, "main", none);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(main, "entry");
+    const scc_uint32_t orphan = scc_ir_function_add_block(main, "orphan");
+    const scc_uint32_t body = scc_ir_function_add_block(main, "body");
+
+    const scc_ir_value_t a = scc_test_append(main, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_a), nothing, nothing);
+    const scc_ir_value_t b = scc_test_append(main, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_b), nothing, nothing);
+    scc_test_append(main, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, b, scc_ir_function_splat(main, f32, 4.0), nothing);
+    scc_test_append(main, entry, SCC_IR_OPERATION_JUMP, none, scc_test_block(body), nothing, nothing);
+
+    scc_test_append(main, orphan, SCC_IR_OPERATION_DISCARD, none, nothing, nothing, nothing);
+    scc_test_append(main, orphan, SCC_IR_OPERATION_JUMP, none, scc_test_block(body), nothing, nothing);
+
+    const scc_ir_value_t doubled = scc_test_append(main, body, SCC_IR_OPERATION_ADD, f32x4, a, a, nothing);
+
+    scc_test_append(main, body, SCC_IR_OPERATION_STORE, none, scc_test_global(out), doubled, nothing);
+    scc_test_append(main, body, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+  }
+
+  module->entry = main->index;
+
+  return module;
+}
+
+void scc_test_dce(void) {
+  scc_ir_module_t *module = scc_test_dce_module();
+
+  float a[4 * SCC_TEST_INVOCATIONS];
+  float b[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word) {
+    a[word] = 0.5f * (float)word - 3.0f;
+    b[word] = (float)word;
+  }
+
+  float before[4 * SCC_TEST_INVOCATIONS];
+  float after[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[3] = { a, b, before };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_DCE_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 1);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  SCC_TEST_CHECK(module->functions[0]->removed);
+  SCC_TEST_CHECK(function->blocks[1].removed);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_MULTIPLY) == 0);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_DISCARD) == 0);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_LOAD) == 1);
+
+  // With nothing loading it, `b` goes, and `o` takes its place.
+  SCC_TEST_CHECK(module->num_of_globals == 2);
+  SCC_TEST_CHECK(module->globals[1].storage == SCC_IR_OUTPUT);
+
+  globals[1] = after;
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word) {
+    SCC_TEST_CHECK(before[word] == 2.0f * a[word]);
+    SCC_TEST_CHECK(after[word] == before[word]);
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,138 @@
+//===-- tests/dominators.cc -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/ir/cfg.h"
+#include "scc/ir/dominators.h"
+#include "scc/ir/loops.h"
+
+SCC_BEGIN_EXTERN_C
+
+enum {
+  SCC_TEST_ENTRY = 0,
+  SCC_TEST_OUTER = 1,
+  SCC_TEST_INNER = 2,
+  SCC_TEST_LATCH = 3,
+  SCC_TEST_EXIT  = 4
+};
+
+// A loop nested in another, where the inner one branches back to itself and
+// the outer one is closed by a block of its own. Only control flow matters,
+// so branches are on an argument.
+static scc_ir_module_t *scc_test_dominators_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_ir_value_t again = scc_ir_function_add_argument(function, "again", boolean);
+
+  scc_ir_function_add_block(function, "entry");
+  scc_ir_function_add_block(function, "outer");
+  scc_ir_function_add_block(function, "inner");
+  scc_ir_function_add_block(function, "latch");
+  scc_ir_function_add_block(function, "exit");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_JUMP, none, scc_test_block(SCC_TEST_OUTER), nothing, nothing);
+  scc_test_append(function, SCC_TEST_OUTER, SCC_IR_OPERATION_JUMP, none, scc_test_block(SCC_TEST_INNER), nothing, nothing);
+  scc_test_append(function, SCC_TEST_INNER, SCC_IR_OPERATION_BRANCH, none, again, scc_test_block(SCC_TEST_INNER), scc_test_block(SCC_TEST_LATCH));
+  scc_test_append(function, SCC_TEST_LATCH, SCC_IR_OPERATION_BRANCH, none, again, scc_test_block(SCC_TEST_OUTER), scc_test_block(SCC_TEST_EXIT));
+  scc_test_append(function, SCC_TEST_EXIT, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+void scc_test_dominators(void) {
+  scc_ir_module_t *module = scc_test_dominators_module();
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  scc_ir_cfg_t *cfg = scc_ir_cfg_compute(function);
+
+  scc_ir_dominators_t *dominators = scc_ir_dominators_compute(function, cfg);
+
+  // Every block is dominated by the one before it.
+  SCC_TEST_CHECK(dominators->idom[SCC_TEST_ENTRY] == SCC_IR_NONE);
+
+  for (scc_uint32_t block = SCC_TEST_OUTER; block <= SCC_TEST_EXIT; ++block)
+    SCC_TEST_CHECK(dominators->idom[block] == block - 1);
+
+  SCC_TEST_CHECK(dominators->num_of_roots == 1);
+  SCC_TEST_CHECK(scc_ir_dominates(dominators, SCC_TEST_ENTRY, SCC_TEST_EXIT));
+  SCC_TEST_CHECK(scc_ir_dominates(dominators, SCC_TEST_OUTER, SCC_TEST_LATCH));
+  SCC_TEST_CHECK(scc_ir_dominates(dominators, SCC_TEST_INNER, SCC_TEST_INNER));
+  SCC_TEST_CHECK(!scc_ir_dominates(dominators, SCC_TEST_LATCH, SCC_TEST_OUTER));
+  SCC_TEST_CHECK(!scc_ir_dominates(dominators, SCC_TEST_EXIT, SCC_TEST_ENTRY));
+
+  scc_ir_dominators_t *post_dominators = scc_ir_post_dominators_compute(function, cfg);
+
+  // Every block is post-dominated by the one after it.
+  for (scc_uint32_t block = SCC_TEST_ENTRY; block < SCC_TEST_EXIT; ++block)
+    SCC_TEST_CHECK(post_dominators->idom[block] == block + 1);
+
+  SCC_TEST_CHECK(scc_ir_dominates(post_dominators, SCC_TEST_EXIT, SCC_TEST_ENTRY));
+  SCC_TEST_CHECK(scc_ir_dominates(post_dominators, SCC_TEST_LATCH, SCC_TEST_INNER));
+  SCC_TEST_CHECK(!scc_ir_dominates(post_dominators, SCC_TEST_INNER, SCC_TEST_LATCH));
+
+  scc_ir_loops_t *loops = scc_ir_loops_compute(function, cfg, dominators);
+
+  // Outer loop comes first.
+  SCC_TEST_CHECK(loops->num_of_loops == 2);
+
+  if (loops->num_of_loops == 2) {
+    const scc_ir_loop_t *outer = &loops->loops[0];
+    const scc_ir_loop_t *inner = &loops->loops[1];
+
+    SCC_TEST_CHECK(outer->header == SCC_TEST_OUTER);
+    SCC_TEST_CHECK(outer->preheader == SCC_TEST_ENTRY);
+    SCC_TEST_CHECK(outer->parent == SCC_IR_NONE);
+    SCC_TEST_CHECK(outer->depth == 1);
+    SCC_TEST_CHECK(outer->num_of_blocks == 3);
+    SCC_TEST_CHECK(outer->num_of_latches == 1);
+    SCC_TEST_CHECK(scc_ir_loop_latches(loops, 0)[0] == SCC_TEST_LATCH);
+
+    SCC_TEST_CHECK(inner->header == SCC_TEST_INNER);
+    SCC_TEST_CHECK(inner->preheader == SCC_TEST_OUTER);
+    SCC_TEST_CHECK(inner->parent == 0);
+    SCC_TEST_CHECK(inner->depth == 2);
+    SCC_TEST_CHECK(inner->num_of_blocks == 1);
+    SCC_TEST_CHECK(inner->num_of_latches == 1);
+    SCC_TEST_CHECK(scc_ir_loop_latches(loops, 1)[0] == SCC_TEST_INNER);
+
+    SCC_TEST_CHECK(scc_ir_loop_contains(loops, 0, SCC_TEST_INNER));
+    SCC_TEST_CHECK(!scc_ir_loop_contains(loops, 1, SCC_TEST_LATCH));
+    SCC_TEST_CHECK(!scc_ir_loop_contains(loops, 0, SCC_TEST_EXIT));
+  }
+
+  SCC_TEST_CHECK(scc_ir_loop_depth(loops, SCC_TEST_ENTRY) == 0);
+  SCC_TEST_CHECK(scc_ir_loop_depth(loops, SCC_TEST_OUTER) == 1);
+  SCC_TEST_CHECK(scc_ir_loop_depth(loops, SCC_TEST_INNER) == 2);
+  SCC_TEST_CHECK(scc_ir_loop_depth(loops, SCC_TEST_LATCH) == 1);
+  SCC_TEST_CHECK(scc_ir_loop_depth(loops, SCC_TEST_EXIT) == 0);
+
+  scc_ir_loops_destroy(loops);
+  scc_ir_dominators_destroy(post_dominators);
+  scc_ir_dominators_destroy(dominators);
+  scc_ir_cfg_destroy(cfg);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
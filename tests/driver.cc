@@ -0,0 +1,174 @@
+//===-- tests/driver.cc ---------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/driver.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Every target but the host, twice over, so that threads contend.
+static const scc_target_t SCC_TEST_TARGETS[] = {
+  SCC_TARGET_GLSL, SCC_TARGET_HLSL, SCC_TARGET_SPIRV, SCC_TARGET_MSL,
+  SCC_TARGET_MSL, SCC_TARGET_SPIRV, SCC_TARGET_HLSL, SCC_TARGET_GLSL
+};
+
+#define SCC_TEST_NUM_OF_OUTPUTS (sizeof(SCC_TEST_TARGETS) / sizeof(SCC_TEST_TARGETS[0]))
+
+// Tints `v` by a loose constant and a member of a constant buffer, through a
+// call, so there's something for each stage to do.
+static scc_ir_module_t *scc_test_driver_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t material = scc_ir_module_add_structure(module, "material");
+  scc_ir_module_add_member(module, material, "roughness", f32, 0);
+  const scc_uint32_t tint = scc_ir_module_add_member(module, material, "tint", f32x4, 16);
+
+  scc_ir_type_t material_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  material_type.structure = material;
+
+  const scc_uint32_t exposure = scc_ir_module_add_global(module, "exposure", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t buffer = scc_ir_module_add_global(module, "material", SCC_IR_CONSTANT, material_type, 0);
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  scc_ir_function_t *scale = scc_ir_module_add_function(module, "scale", f32x4);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(scale, "entry");
+
+    const scc_ir_value_t x = scc_ir_function_add_argument(scale, "x", f32x4);
+    const scc_ir_value_t by = scc_ir_function_add_argument(scale, "by", f32);
+
+    const scc_ir_value_t scaled = scc_test_append(scale, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, x, by, nothing);
+
+    scc_test_append(scale, entry, SCC_IR_OPERATION_RETURN, none, scaled, nothing, nothing);
+  }
+
+  scc_ir_function_t *main = scc_ir_module_add_function(module, "main", none);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(main, "entry");
+
+    const scc_ir_value_t v = scc_test_append(main, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), nothing, nothing);
+    const scc_ir_value_t t = scc_test_append(main, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(buffer), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, tint), nothing);
+    const scc_ir_value_t e = scc_test_append(main, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(exposure), nothing, nothing);
+    const scc_ir_value_t tinted = scc_test_append(main, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, v, t, nothing);
+
+    const scc_ir_value_t call[3] = { SCC_IR_VALUE(SCC_IR_VALUE_FUNCTION, scale->index), tinted, e };
+    const scc_ir_value_t exposed = scc_ir_function_append(main, entry, SCC_IR_OPERATION_CALL, f32x4, call, 3);
+
+    scc_test_append(main, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out), exposed, nothing);
+    scc_test_append(main, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+  }
+
+  module->entry = main->index;
+
+  return module;
+}
+
+// Emits `module` for every target on `threads` threads, to `outputs`.
+static scc_bool_t scc_test_driver_emit(const scc_ir_module_t *module,
+                                       scc_uint32_t threads,
+                                       scc_driver_output_t *outputs) {
+  scc_ir_pass_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.threads = threads;
+
+  for (scc_uint32_t output = 0; output < SCC_TEST_NUM_OF_OUTPUTS; ++output) {
+    memset(&outputs[output], 0, sizeof(scc_driver_output_t));
+
+    outputs[output].target = SCC_TEST_TARGETS[output];
+    outputs[output].writer = scc_writer_create(NULL, 4096);
+    outputs[output].reflection = scc_writer_create(NULL, 4096);
+    outputs[output].lay_out = (output % 2) == 1;
+  }
+
+  return scc_driver_emit(module, &options, outputs, SCC_TEST_NUM_OF_OUTPUTS);
+}
+
+// Determines if `a` and `b` kept the same bytes.
+static scc_bool_t scc_test_driver_same(const scc_writer_t *a,
+                                       const scc_writer_t *b) {
+  const scc_size_t size = scc_writer_size(a);
+
+  if (scc_writer_size(b) != size)
+    return SCC_FALSE;
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  char *x = (char *)heap->allocate(heap, size + 1, 16);
+  char *y = (char *)heap->allocate(heap, size + 1, 16);
+
+  scc_writer_copy(a, x);
+  scc_writer_copy(b, y);
+
+  const scc_bool_t same = (memcmp(x, y, size) == 0);
+
+  heap->free(heap, (void *)x);
+  heap->free(heap, (void *)y);
+
+  return same;
+}
+
+static void scc_test_driver_release(scc_driver_output_t *outputs) {
+  for (scc_uint32_t output = 0; output < SCC_TEST_NUM_OF_OUTPUTS; ++output) {
+    scc_writer_destroy(outputs[output].writer);
+    scc_writer_destroy(outputs[output].reflection);
+  }
+}
+
+void scc_test_driver(void) {
+  scc_ir_module_t *module = scc_test_driver_module();
+
+  scc_ir_pass_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.threads = 1;
+
+  scc_driver_optimize(module, &options);
+
+  scc_driver_output_t serial[SCC_TEST_NUM_OF_OUTPUTS];
+
+  SCC_TEST_CHECK(scc_test_driver_emit(module, 1, serial));
+
+  // Again and again, to give races a chance to show.
+  for (scc_uint32_t attempt = 0; attempt < 8; ++attempt) {
+    scc_driver_output_t parallel[SCC_TEST_NUM_OF_OUTPUTS];
+
+    SCC_TEST_CHECK(scc_test_driver_emit(module, 4, parallel));
+
+    // Output doesn't depend on the number of threads.
+    for (scc_uint32_t output = 0; output < SCC_TEST_NUM_OF_OUTPUTS; ++output) {
+      SCC_TEST_CHECK(parallel[output].emitted);
+      SCC_TEST_CHECK(scc_writer_size(parallel[output].writer) > 0);
+      SCC_TEST_CHECK(scc_test_driver_same(parallel[output].writer, serial[output].writer));
+      SCC_TEST_CHECK(scc_test_driver_same(parallel[output].reflection, serial[output].reflection));
+    }
+
+    scc_test_driver_release(parallel);
+  }
+
+  scc_test_driver_release(serial);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,252 @@
+//===-- tests/glsl.cc -----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/backend/glsl.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Samples a texture at `uv`, tints it by a member of a constant buffer
+// through a call, and exposes it by a loose constant, discarding where the
+// first coordinate is below a half. Also passes an integer through, which
+// can't be interpolated.
+static scc_ir_module_t *scc_test_glsl_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x2 = scc_ir_type(SCC_IR_F32, 2, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t i32 = scc_ir_type(SCC_IR_I32, 1, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t material = scc_ir_module_add_structure(module, "material");
+  scc_ir_module_add_member(module, material, "roughness", f32, 0);
+  const scc_uint32_t tint = scc_ir_module_add_member(module, material, "tint", f32x4, 16);
+
+  scc_ir_type_t material_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  material_type.structure = material;
+
+  const scc_uint32_t exposure = scc_ir_module_add_global(module, "exposure", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t buffer = scc_ir_module_add_global(module, "material", SCC_IR_CONSTANT, material_type, 0);
+  const scc_uint32_t texture = scc_ir_module_add_global(module, "albedo", SCC_IR_TEXTURE, f32x4, 0);
+  const scc_uint32_t in_uv = scc_ir_module_add_global(module, "uv", SCC_IR_INPUT, f32x2, 0);
+  const scc_uint32_t in_id = scc_ir_module_add_global(module, "id", SCC_IR_INPUT, i32, 1);
+  const scc_uint32_t out_color = scc_ir_module_add_global(module, "color", SCC_IR_OUTPUT, f32x4, 0);
+  const scc_uint32_t out_id = scc_ir_module_add_global(module, "tag", SCC_IR_OUTPUT, i32, 1);
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  scc_ir_function_t *scale = scc_ir_module_add_function(module, "scale", f32x4);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(scale, "entry");
+
+    const scc_ir_value_t x = scc_ir_function_add_argument(scale, "x", f32x4);
+    const scc_ir_value_t by = scc_ir_function_add_argument(scale, "by", f32);
+
+    const scc_ir_value_t scaled = scc_test_append(scale, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, x, by, nothing);
+
+    scc_test_append(scale, entry, SCC_IR_OPERATION_RETURN, none, scaled, nothing, nothing);
+  }
+
+  scc_ir_function_t *main = scc_ir_module_add_function(module, "main", none);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(main, "entry");
+    const scc_uint32_t kill = scc_ir_function_add_block(main, "kill");
+    const scc_uint32_t exit = scc_ir_function_add_block(main, "exit");
+
+    const scc_ir_value_t uv = scc_test_append(main, entry, SCC_IR_OPERATION_LOAD, f32x2, scc_test_global(in_uv), nothing, nothing);
+    const scc_ir_value_t u = scc_test_append(main, entry, SCC_IR_OPERATION_SWIZZLE, f32, uv, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 0, 0, 0)), nothing);
+    const scc_ir_value_t below = scc_test_append(main, entry, SCC_IR_OPERATION_LESS, boolean, u, scc_ir_function_splat(main, f32, 0.5), nothing);
+    scc_test_append(main, entry, SCC_IR_OPERATION_BRANCH, none, below, scc_test_block(kill), scc_test_block(exit));
+
+    scc_test_append(main, kill, SCC_IR_OPERATION_DISCARD, none, nothing, nothing, nothing);
+    scc_test_append(main, kill, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), nothing, nothing);
+
+    const scc_ir_value_t texel = scc_test_append(main, exit, SCC_IR_OPERATION_FETCH, f32x4, scc_test_global(texture), uv, nothing);
+    const scc_ir_value_t t = scc_test_append(main, exit, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(buffer), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, tint), nothing);
+    const scc_ir_value_t e = scc_test_append(main, exit, SCC_IR_OPERATION_LOAD, f32, scc_test_global(exposure), nothing, nothing);
+    const scc_ir_value_t tinted = scc_test_append(main, exit, SCC_IR_OPERATION_MULTIPLY, f32x4, texel, t, nothing);
+
+    const scc_ir_value_t call[3] = { SCC_IR_VALUE(SCC_IR_VALUE_FUNCTION, scale->index), tinted, e };
+    const scc_ir_value_t exposed = scc_ir_function_append(main, exit, SCC_IR_OPERATION_CALL, f32x4, call, 3);
+
+    const scc_ir_value_t id = scc_test_append(main, exit, SCC_IR_OPERATION_LOAD, i32, scc_test_global(in_id), nothing, nothing);
+
+    scc_test_append(main, exit, SCC_IR_OPERATION_STORE, none, scc_test_global(out_color), exposed, nothing);
+    scc_test_append(main, exit, SCC_IR_OPERATION_STORE, none, scc_test_global(out_id), id, nothing);
+    scc_test_append(main, exit, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+  }
+
+  module->entry = main->index;
+
+  return module;
+}
+
+// Most bytes emitted for the module above, with room to spare.
+#define SCC_TEST_MOST_BYTES 4096
+
+// Keeps whatever is written to it, up to `limit` bytes, after which it comes
+// up short.
+typedef struct scc_test_sink {
+  scc_sink_t sink;
+  char bytes[SCC_TEST_MOST_BYTES];
+  scc_size_t size;
+  scc_size_t limit;
+} scc_test_sink_t;
+
+static scc_size_t scc_test_sink_write(scc_sink_t *sink,
+                                      const char *buffer,
+                                      scc_size_t count) {
+  scc_test_sink_t *kept = (scc_test_sink_t *)sink;
+
+  if (count > kept->limit - kept->size)
+    count = kept->limit - kept->size;
+
+  memcpy(&kept->bytes[kept->size], buffer, count);
+  kept->size += count;
+
+  return count;
+}
+
+static void scc_test_sink_close(scc_sink_t *sink) {
+  (void)sink;
+}
+
+static void scc_test_sink_init(scc_test_sink_t *sink, scc_size_t limit) {
+  sink->sink.write = &scc_test_sink_write;
+  sink->sink.close = &scc_test_sink_close;
+  sink->size = 0;
+  sink->limit = limit;
+}
+
+// Emits `module` to a writer of `granularity` bytes that keeps everything,
+// to `text`, which is terminated. Returns the number of bytes emitted.
+static scc_size_t scc_test_glsl_emit(const scc_ir_module_t *module,
+                                     const scc_glsl_options_t *options,
+                                     scc_size_t granularity,
+                                     char *text) {
+  scc_writer_t *writer = scc_writer_create(NULL, granularity);
+
+  SCC_TEST_CHECK(scc_glsl_emit(module, options, writer));
+
+  const scc_size_t size = scc_writer_size(writer);
+
+  SCC_TEST_CHECK(size < SCC_TEST_MOST_BYTES);
+
+  if (size < SCC_TEST_MOST_BYTES) {
+    scc_writer_copy(writer, text);
+    text[size] = '\0';
+  } else {
+    text[0] = '\0';
+  }
+
+  scc_writer_destroy(writer);
+
+  return size;
+}
+
+void scc_test_glsl(void) {
+  scc_ir_module_t *module = scc_test_glsl_module();
+
+  char text[SCC_TEST_MOST_BYTES];
+
+  const scc_size_t size = scc_test_glsl_emit(module, NULL, 4096, text);
+
+  SCC_TEST_CHECK(strstr(text, "#version 450\n") == text);
+
+  // Integers aren't interpolated, while everything else is.
+  SCC_TEST_CHECK(strstr(text, "layout(location = 0) in vec2 uv;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "layout(location = 1) flat in int id;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "layout(location = 0) out vec4 color;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "layout(location = 1) out int tag;") != NULL);
+
+  // Loose constants take the first slot not taken by a buffer.
+  SCC_TEST_CHECK(strstr(text, "layout(std140, binding = 0) uniform _Bmaterial {") != NULL);
+  SCC_TEST_CHECK(strstr(text, "layout(offset = 16) vec4 tint;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "layout(std140, binding = 1) uniform _constants {") != NULL);
+  SCC_TEST_CHECK(strstr(text, "layout(offset = 0) float exposure;") != NULL);
+
+  SCC_TEST_CHECK(strstr(text, "layout(binding = 0) uniform sampler2D albedo;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "texture(albedo, ") != NULL);
+
+  SCC_TEST_CHECK(strstr(text, "vec4 scale(vec4 x, float by) {") != NULL);
+  SCC_TEST_CHECK(strstr(text, "void main() {") != NULL);
+  SCC_TEST_CHECK(strstr(text, "discard;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "material.tint") != NULL);
+
+  // Options are respected.
+  scc_glsl_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.version = 460;
+
+  char versioned[SCC_TEST_MOST_BYTES];
+
+  scc_test_glsl_emit(module, &options, 4096, versioned);
+
+  SCC_TEST_CHECK(strstr(versioned, "#version 460\n") == versioned);
+  SCC_TEST_CHECK(strcmp(strchr(versioned, '\n'), strchr(text, '\n')) == 0);
+
+  // Output doesn't depend on how it's chunked.
+  static const scc_size_t granularities[3] = { 1, 7, 16 };
+
+  for (scc_uint32_t granularity = 0; granularity < 3; ++granularity) {
+    char chunked[SCC_TEST_MOST_BYTES];
+
+    SCC_TEST_CHECK(scc_test_glsl_emit(module, NULL, granularities[granularity], chunked) == size);
+    SCC_TEST_CHECK(strcmp(chunked, text) == 0);
+  }
+
+  // Nor on whether it's handed to a sink as it's written.
+  scc_test_sink_t sink;
+
+  scc_test_sink_init(&sink, SCC_TEST_MOST_BYTES);
+
+  scc_writer_t *writer = scc_writer_create(&sink.sink, 16);
+
+  SCC_TEST_CHECK(scc_glsl_emit(module, NULL, writer));
+  SCC_TEST_CHECK(sink.size > 0);
+  SCC_TEST_CHECK(scc_writer_flush(writer));
+  SCC_TEST_CHECK(sink.size == size);
+  SCC_TEST_CHECK(memcmp(sink.bytes, text, size) == 0);
+
+  scc_writer_destroy(writer);
+
+  // A sink that comes up short is reported.
+  scc_test_sink_init(&sink, size / 2);
+
+  writer = scc_writer_create(&sink.sink, 16);
+
+  scc_glsl_emit(module, NULL, writer);
+
+  SCC_TEST_CHECK(!scc_writer_flush(writer));
+  SCC_TEST_CHECK(memcmp(sink.bytes, text, size / 2) == 0);
+
+  scc_writer_destroy(writer);
+
+  // Nothing is emitted without an entry point.
+  module->entry = SCC_IR_NONE;
+
+  writer = scc_writer_create(NULL, 4096);
+
+  SCC_TEST_CHECK(!scc_glsl_emit(module, NULL, writer));
+
+  scc_writer_destroy(writer);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
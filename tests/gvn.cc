@@ -0,0 +1,102 @@
+//===-- tests/gvn.cc ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Sums `a * b` and `b * a`, the latter computed in a block dominated by the
+// former's, along with `a - b` and `b - a`, which aren't the same.
+static scc_ir_module_t *scc_test_gvn_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in_a = scc_ir_module_add_global(module, "a", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_b = scc_ir_module_add_global(module, "b", SCC_IR_INPUT, f32x4, 1);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+  const scc_uint32_t exit = scc_ir_function_add_block(function, "exit");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t a = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_a), nothing, nothing);
+  const scc_ir_value_t b = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_b), nothing, nothing);
+  const scc_ir_value_t ab = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, a, b, nothing);
+  const scc_ir_value_t a_b = scc_test_append(function, entry, SCC_IR_OPERATION_SUB, f32x4, a, b, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), nothing, nothing);
+
+  // Loaded again, which is the same as long as nothing can store to it.
+  const scc_ir_value_t again = scc_test_append(function, exit, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_a), nothing, nothing);
+  const scc_ir_value_t ba = scc_test_append(function, exit, SCC_IR_OPERATION_MULTIPLY, f32x4, b, again, nothing);
+  const scc_ir_value_t b_a = scc_test_append(function, exit, SCC_IR_OPERATION_SUB, f32x4, b, again, nothing);
+  const scc_ir_value_t products = scc_test_append(function, exit, SCC_IR_OPERATION_ADD, f32x4, ab, ba, nothing);
+  const scc_ir_value_t differences = scc_test_append(function, exit, SCC_IR_OPERATION_MULTIPLY, f32x4, a_b, b_a, nothing);
+  const scc_ir_value_t sum = scc_test_append(function, exit, SCC_IR_OPERATION_ADD, f32x4, products, differences, nothing);
+
+  scc_test_append(function, exit, SCC_IR_OPERATION_STORE, none, scc_test_global(out), sum, nothing);
+  scc_test_append(function, exit, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+void scc_test_gvn(void) {
+  scc_ir_module_t *module = scc_test_gvn_module();
+
+  float a[4 * SCC_TEST_INVOCATIONS];
+  float b[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word) {
+    a[word] = 0.25f * (float)word - 1.0f;
+    b[word] = 3.0f - 0.5f * (float)word;
+  }
+
+  float before[4 * SCC_TEST_INVOCATIONS];
+  float after[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[3] = { a, b, before };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_GVN_PASS, &SCC_IR_DCE_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 2);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  // Products merge, as does the second load, but differences don't.
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_LOAD) == 2);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_MULTIPLY) == 2);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_SUB) == 2);
+
+  globals[2] = after;
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word) {
+    SCC_TEST_CHECK(before[word] == (a[word] * b[word] + b[word] * a[word]) + (a[word] - b[word]) * (b[word] - a[word]));
+    SCC_TEST_CHECK(after[word] == before[word]);
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,128 @@
+//===-- tests/hoist_uniforms.cc -------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 4;
+
+// Computes `(scale * scale + 1) * v + time`, where all but `v` is constant.
+static scc_ir_module_t *scc_test_hoist_uniforms_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+
+  const scc_uint32_t time = scc_ir_module_add_global(module, "time", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t scale = scc_ir_module_add_global(module, "scale", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32, 0);
+
+  module->globals[time].offset = 0;
+  module->globals[scale].offset = 4;
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", scc_ir_void());
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t none = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t s = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(scale), none, none);
+  const scc_ir_value_t squared = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32, s, s, none);
+  const scc_ir_value_t factor = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32, squared, scc_ir_function_splat(function, f32, 1.0), none);
+  const scc_ir_value_t v = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(in), none, none);
+  const scc_ir_value_t scaled = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32, factor, v, none);
+  const scc_ir_value_t t = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(time), none, none);
+  const scc_ir_value_t result = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32, scaled, t, none);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, scc_ir_void(), scc_test_global(out), result, none);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, scc_ir_void(), none, none, none);
+
+  module->entry = 0;
+
+  return module;
+}
+
+// Checks that no two loose constants of `module` overlap when laid out by
+// `packing`.
+static void scc_test_hoist_uniforms_check_overlap(const scc_ir_module_t *module,
+                                                  scc_ir_packing_t packing) {
+  for (scc_uint32_t a = 0; a < module->num_of_globals; ++a) {
+    for (scc_uint32_t b = a + 1; b < module->num_of_globals; ++b) {
+      const scc_ir_global_t *x = &module->globals[a];
+      const scc_ir_global_t *y = &module->globals[b];
+
+      if ((x->storage != SCC_IR_CONSTANT) || (y->storage != SCC_IR_CONSTANT))
+        continue;
+
+      SCC_TEST_CHECK((x->offset + scc_ir_layout_size(module, packing, x->type) <= y->offset)
+                  || (y->offset + scc_ir_layout_size(module, packing, y->type) <= x->offset));
+    }
+  }
+}
+
+void scc_test_hoist_uniforms(void) {
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_HOIST_UNIFORMS_PASS, &SCC_IR_DCE_PASS };
+
+  // Placement follows the rules of the target.
+  static const scc_target_t targets[] = { SCC_TARGET_GLSL, SCC_TARGET_HLSL };
+
+  for (scc_uint32_t target = 0; target < sizeof(targets) / sizeof(targets[0]); ++target) {
+    scc_ir_module_t *module = scc_test_hoist_uniforms_module();
+
+    scc_test_optimize(module, targets[target], passes, 2);
+
+    scc_test_hoist_uniforms_check_overlap(module, scc_ir_packing_of(targets[target]));
+
+    scc_ir_module_destroy(module);
+  }
+
+  scc_ir_module_t *module = scc_test_hoist_uniforms_module();
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 2);
+
+  SCC_TEST_CHECK(module->precompute != SCC_IR_NONE);
+  SCC_TEST_CHECK(module->num_of_globals == 5);
+
+  if ((module->precompute == SCC_IR_NONE) || (module->num_of_globals != 5)) {
+    scc_ir_module_destroy(module);
+    return;
+  }
+
+  const scc_ir_global_t *derived = &module->globals[4];
+
+  SCC_TEST_CHECK(strcmp(scc_ir_module_string(module, derived->name), "scale.add") == 0);
+  SCC_TEST_CHECK(derived->offset == 8);
+
+  scc_test_hoist_uniforms_check_overlap(module, SCC_IR_PACKING_TIGHT);
+
+  // Loose constants share a buffer.
+  float constants[4] = { 100.0f, 3.0f, 0.0f, 0.0f };
+  float in[SCC_TEST_INVOCATIONS] = { 1.0f, 2.0f, 3.0f, 4.0f };
+  float out[SCC_TEST_INVOCATIONS];
+
+  void *globals[5] = { constants, constants, in, out, constants };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->precompute, globals, 1));
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  SCC_TEST_CHECK(constants[0] == 100.0f);
+  SCC_TEST_CHECK(constants[1] == 3.0f);
+
+  for (scc_uint32_t invocation = 0; invocation < SCC_TEST_INVOCATIONS; ++invocation)
+    SCC_TEST_CHECK(out[invocation] == 10.0f * in[invocation] + 100.0f);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,119 @@
+//===-- tests/inline.cc ---------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 6;
+
+// Calls a function that returns early, negating `x` if its first component
+// is negative and doubling it otherwise, so that inlining has to join two
+// returns.
+static scc_ir_module_t *scc_test_inline_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  scc_ir_function_t *pick = scc_ir_module_add_function(module, "pick", f32x4);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(pick, "entry");
+    const scc_uint32_t negative = scc_ir_function_add_block(pick, "negative");
+    const scc_uint32_t positive = scc_ir_function_add_block(pick, "positive");
+
+    const scc_ir_value_t x = scc_ir_function_add_argument(pick, "x", f32x4);
+
+    const scc_ir_value_t first = scc_test_append(pick, entry, SCC_IR_OPERATION_SWIZZLE, f32, x, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 0, 0, 0)), nothing);
+    const scc_ir_value_t below = scc_test_append(pick, entry, SCC_IR_OPERATION_LESS, boolean, first, scc_ir_function_splat(pick, f32, 0.0), nothing);
+    scc_test_append(pick, entry, SCC_IR_OPERATION_BRANCH, none, below, scc_test_block(negative), scc_test_block(positive));
+
+    const scc_ir_value_t negated = scc_test_append(pick, negative, SCC_IR_OPERATION_SUB, f32x4, scc_ir_function_splat(pick, f32x4, 0.0), x, nothing);
+    scc_test_append(pick, negative, SCC_IR_OPERATION_RETURN, none, negated, nothing, nothing);
+
+    const scc_ir_value_t doubled = scc_test_append(pick, positive, SCC_IR_OPERATION_ADD, f32x4, x, x, nothing);
+    scc_test_append(pick, positive, SCC_IR_OPERATION_RETURN, none, doubled, nothing, nothing);
+  }
+
+  scc_ir_function_t *main = scc_ir_module_add_function(module, "main", none);
+  {
+    const scc_uint32_t entry = scc_ir_function_add_block(main, "entry");
+
+    const scc_ir_value_t v = scc_test_append(main, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), nothing, nothing);
+
+    const scc_ir_value_t call[2] = { SCC_IR_VALUE(SCC_IR_VALUE_FUNCTION, pick->index), v };
+    const scc_ir_value_t picked = scc_ir_function_append(main, entry, SCC_IR_OPERATION_CALL, f32x4, call, 2);
+
+    scc_test_append(main, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out), picked, nothing);
+    scc_test_append(main, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+  }
+
+  module->entry = main->index;
+
+  return module;
+}
+
+void scc_test_inline(void) {
+  scc_ir_module_t *module = scc_test_inline_module();
+
+  // First components alternate in sign, so both returns are taken.
+  float in[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word)
+    in[word] = (float)word * ((word % 2) ? 1.0f : -1.0f) - 0.5f;
+
+  float before[4 * SCC_TEST_INVOCATIONS];
+  float after[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[2] = { in, before };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_INLINE_PASS, &SCC_IR_DCE_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 2);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  // Called once, so inlined, with what each return gave joined by a phi.
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_CALL) == 0);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_PHI) == 1);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_RETURN) == 1);
+  SCC_TEST_CHECK(module->functions[0]->removed);
+
+  globals[1] = after;
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  for (scc_uint32_t component = 0; component < 4; ++component) {
+    for (scc_uint32_t invocation = 0; invocation < SCC_TEST_INVOCATIONS; ++invocation) {
+      const scc_uint32_t word = component * SCC_TEST_INVOCATIONS + invocation;
+
+      const scc_bool_t negative = (in[invocation] < 0.0f);
+
+      SCC_TEST_CHECK(before[word] == (negative ? (0.0f - in[word]) : (in[word] + in[word])));
+      SCC_TEST_CHECK(after[word] == before[word]);
+    }
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
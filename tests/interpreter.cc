@@ -0,0 +1,204 @@
+//===-- tests/interpreter.cc ----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Two full batches and a partial one.
+#define SCC_TEST_INVOCATIONS (2 * SCC_IR_LANES + 3)
+
+// Loose constant each iteration scales by.
+static const float SCC_TEST_SCALE = 0.5f;
+
+// Repeatedly scales `v` by a loose constant and adds one, as many times as
+// `n` says, then discards if the first component of `v` is far below zero,
+// and otherwise adds a texel sampled at the first two.
+static scc_ir_module_t *scc_test_interpreter_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x2 = scc_ir_type(SCC_IR_F32, 2, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t scale = scc_ir_module_add_global(module, "scale", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t texture = scc_ir_module_add_global(module, "albedo", SCC_IR_TEXTURE, f32x4, 0);
+  const scc_uint32_t in_v = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_n = scc_ir_module_add_global(module, "n", SCC_IR_INPUT, f32, 1);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  module->globals[scale].offset = 0;
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+  const scc_uint32_t header = scc_ir_function_add_block(function, "header");
+  const scc_uint32_t body = scc_ir_function_add_block(function, "body");
+  const scc_uint32_t after = scc_ir_function_add_block(function, "after");
+  const scc_uint32_t kill = scc_ir_function_add_block(function, "kill");
+  const scc_uint32_t exit = scc_ir_function_add_block(function, "exit");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t v = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_v), nothing, nothing);
+  const scc_ir_value_t n = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(in_n), nothing, nothing);
+  const scc_ir_value_t s = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(scale), nothing, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_JUMP, none, scc_test_block(header), nothing, nothing);
+
+  // Incoming values from the body stand in for themselves until they exist.
+  const scc_ir_value_t zero = scc_ir_function_splat(function, f32, 0.0);
+
+  const scc_ir_value_t counters[4] = { scc_test_block(entry), zero, scc_test_block(body), zero };
+  const scc_ir_value_t accumulators[4] = { scc_test_block(entry), v, scc_test_block(body), v };
+
+  const scc_ir_value_t i = scc_ir_function_append(function, header, SCC_IR_OPERATION_PHI, f32, counters, 4);
+  const scc_ir_value_t accumulated = scc_ir_function_append(function, header, SCC_IR_OPERATION_PHI, f32x4, accumulators, 4);
+  const scc_ir_value_t more = scc_test_append(function, header, SCC_IR_OPERATION_LESS, boolean, i, n, nothing);
+  scc_test_append(function, header, SCC_IR_OPERATION_BRANCH, none, more, scc_test_block(body), scc_test_block(after));
+
+  const scc_ir_value_t scaled = scc_test_append(function, body, SCC_IR_OPERATION_MULTIPLY, f32x4, accumulated, s, nothing);
+  const scc_ir_value_t stepped = scc_test_append(function, body, SCC_IR_OPERATION_ADD, f32x4, scaled, scc_ir_function_splat(function, f32, 1.0), nothing);
+  const scc_ir_value_t next = scc_test_append(function, body, SCC_IR_OPERATION_ADD, f32, i, scc_ir_function_splat(function, f32, 1.0), nothing);
+  scc_test_append(function, body, SCC_IR_OPERATION_JUMP, none, scc_test_block(header), nothing, nothing);
+
+  const scc_ir_value_t counted[4] = { counters[0], counters[1], counters[2], next };
+  const scc_ir_value_t stepping[4] = { accumulators[0], accumulators[1], accumulators[2], stepped };
+
+  scc_ir_function_set_operands(function, SCC_IR_VALUE_INDEX(i), counted, 4);
+  scc_ir_function_set_operands(function, SCC_IR_VALUE_INDEX(accumulated), stepping, 4);
+
+  const scc_ir_value_t x = scc_test_append(function, after, SCC_IR_OPERATION_SWIZZLE, f32, v, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 0, 0, 0)), nothing);
+  const scc_ir_value_t far = scc_test_append(function, after, SCC_IR_OPERATION_LESS, boolean, x, scc_ir_function_splat(function, f32, -3.0), nothing);
+  scc_test_append(function, after, SCC_IR_OPERATION_BRANCH, none, far, scc_test_block(kill), scc_test_block(exit));
+
+  scc_test_append(function, kill, SCC_IR_OPERATION_DISCARD, none, nothing, nothing, nothing);
+  scc_test_append(function, kill, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), nothing, nothing);
+
+  const scc_ir_value_t uv = scc_test_append(function, exit, SCC_IR_OPERATION_SWIZZLE, f32x2, v, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 1, 0, 0)), nothing);
+  const scc_ir_value_t texel = scc_test_append(function, exit, SCC_IR_OPERATION_FETCH, f32x4, scc_test_global(texture), uv, nothing);
+  const scc_ir_value_t lit = scc_test_append(function, exit, SCC_IR_OPERATION_ADD, f32x4, accumulated, texel, nothing);
+
+  scc_test_append(function, exit, SCC_IR_OPERATION_STORE, none, scc_test_global(out), lit, nothing);
+  scc_test_append(function, exit, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Texel `k` of coordinates `u` and `v` is `u * (k + 1) + v`.
+static float scc_test_interpreter_texel(float u,
+                                        float v,
+                                        scc_uint32_t k) {
+  return u * (float)(k + 1) + v;
+}
+
+static void scc_test_interpreter_sample(void *user,
+                                        scc_uint32_t texture,
+                                        scc_uint32_t component,
+                                        const scc_ir_word_t *coordinates,
+                                        scc_uint32_t num_of_coordinates,
+                                        scc_uint32_t mask,
+                                        scc_ir_word_t *texels) {
+  scc_uint32_t *samples = (scc_uint32_t *)user;
+
+  SCC_TEST_CHECK(texture == 0);
+  SCC_TEST_CHECK(component == SCC_IR_NONE);
+  SCC_TEST_CHECK(num_of_coordinates == 2);
+
+  for (scc_uint32_t lane = 0; lane < SCC_IR_LANES; ++lane) {
+    if (!(mask & (1u << lane)))
+      continue;
+
+    for (scc_uint32_t k = 0; k < 4; ++k)
+      texels[k * SCC_IR_LANES + lane].f = scc_test_interpreter_texel(coordinates[lane].f, coordinates[SCC_IR_LANES + lane].f, k);
+
+    *samples += 1;
+  }
+}
+
+void scc_test_interpreter(void) {
+  scc_ir_module_t *module = scc_test_interpreter_module();
+
+  float v[4 * SCC_TEST_INVOCATIONS];
+  float n[SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t invocation = 0; invocation < SCC_TEST_INVOCATIONS; ++invocation) {
+    n[invocation] = (float)((invocation * 5) % 4);
+
+    for (scc_uint32_t component = 0; component < 4; ++component)
+      v[component * SCC_TEST_INVOCATIONS + invocation] = (float)((invocation * 3 + component) % 9) - 4.0f;
+  }
+
+  float constants[1] = { SCC_TEST_SCALE };
+
+  float o[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[5] = { constants, NULL, v, n, o };
+
+  scc_bool_t discarded[SCC_TEST_INVOCATIONS];
+  scc_uint32_t samples = 0;
+
+  scc_ir_bindings_t bindings;
+
+  memset(&bindings, 0, sizeof(bindings));
+
+  bindings.globals = globals;
+  bindings.sample = &scc_test_interpreter_sample;
+  bindings.user = (void *)&samples;
+  bindings.discarded = discarded;
+
+  scc_ir_interpreter_t *interpreter = scc_ir_interpreter_create(module);
+
+  SCC_TEST_CHECK(scc_ir_interpreter_supports(interpreter, module->entry));
+  SCC_TEST_CHECK(scc_ir_interpreter_run(interpreter, module->entry, &bindings, SCC_TEST_INVOCATIONS));
+
+  scc_ir_interpreter_destroy(interpreter);
+
+  // Only invocations that didn't discard sample.
+  scc_uint32_t kept = 0;
+
+  for (scc_uint32_t invocation = 0; invocation < SCC_TEST_INVOCATIONS; ++invocation) {
+    const float x = v[invocation];
+    const float y = v[SCC_TEST_INVOCATIONS + invocation];
+
+    SCC_TEST_CHECK(discarded[invocation] == (x < -3.0f));
+
+    if (discarded[invocation])
+      continue;
+
+    kept += 1;
+
+    for (scc_uint32_t component = 0; component < 4; ++component) {
+      const scc_uint32_t word = component * SCC_TEST_INVOCATIONS + invocation;
+
+      float expected = v[word];
+
+      for (float i = 0.0f; i < n[invocation]; i += 1.0f)
+        expected = expected * SCC_TEST_SCALE + 1.0f;
+
+      expected += scc_test_interpreter_texel(x, y, component);
+
+      SCC_TEST_CHECK(o[word] == expected);
+    }
+  }
+
+  SCC_TEST_CHECK((kept > 0) && (kept < SCC_TEST_INVOCATIONS));
+  SCC_TEST_CHECK(samples == kept);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
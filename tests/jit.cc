@@ -0,0 +1,160 @@
+//===-- tests/jit.cc ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Vectors computed before any are summed, so that all are live at once.
+static const scc_uint32_t SCC_TEST_TERMS = 12;
+
+// Invocations run, covering partial batches, which are interpreted, on either
+// side of full ones.
+static const scc_uint32_t SCC_TEST_COUNTS[] = {
+  1, SCC_IR_LANES - 1, SCC_IR_LANES, SCC_IR_LANES + 1, 3 * SCC_IR_LANES, 5 * SCC_IR_LANES + 3
+};
+
+#define SCC_TEST_MOST_INVOCATIONS (5 * SCC_IR_LANES + 3)
+
+// Sums terms of `a` and `b` that keep far more components live than there
+// are registers, then takes one of two paths depending on the sign of the
+// first component of the sum.
+static scc_ir_module_t *scc_test_jit_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in_a = scc_ir_module_add_global(module, "a", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_b = scc_ir_module_add_global(module, "b", SCC_IR_INPUT, f32x4, 1);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+  const scc_uint32_t negative = scc_ir_function_add_block(function, "negative");
+  const scc_uint32_t positive = scc_ir_function_add_block(function, "positive");
+  const scc_uint32_t exit = scc_ir_function_add_block(function, "exit");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t a = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_a), nothing, nothing);
+  const scc_ir_value_t b = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_b), nothing, nothing);
+
+  scc_ir_value_t terms[SCC_TEST_TERMS];
+
+  for (scc_uint32_t term = 0; term < SCC_TEST_TERMS; ++term) {
+    const scc_ir_value_t c = scc_ir_function_splat(function, f32, 0.25 * (term + 1));
+
+    switch (term % 4) {
+      case 0: {
+        const scc_ir_value_t operands[3] = { a, c, b };
+        terms[term] = scc_ir_function_append(function, entry, SCC_IR_OPERATION_FMA, f32x4, operands, 3);
+      } break;
+
+      case 1: {
+        const scc_ir_value_t scaled = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, b, c, nothing);
+        terms[term] = scc_test_append(function, entry, SCC_IR_OPERATION_SUB, f32x4, scaled, a, nothing);
+      } break;
+
+      case 2: {
+        const scc_ir_value_t magnitude = scc_test_append(function, entry, SCC_IR_OPERATION_ABS, f32x4, a, nothing, nothing);
+        const scc_ir_value_t root = scc_test_append(function, entry, SCC_IR_OPERATION_SQRT, f32x4, magnitude, nothing, nothing);
+        terms[term] = scc_test_append(function, entry, SCC_IR_OPERATION_MAX, f32x4, root, c, nothing);
+      } break;
+
+      case 3: {
+        const scc_ir_value_t lesser = scc_test_append(function, entry, SCC_IR_OPERATION_MIN, f32x4, a, b, nothing);
+        terms[term] = scc_test_append(function, entry, SCC_IR_OPERATION_DIVIDE, f32x4, lesser, c, nothing);
+      } break;
+    }
+  }
+
+  scc_ir_value_t sum = terms[0];
+
+  for (scc_uint32_t term = 1; term < SCC_TEST_TERMS; ++term)
+    sum = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4, sum, terms[term], nothing);
+
+  const scc_ir_value_t first = scc_test_append(function, entry, SCC_IR_OPERATION_SWIZZLE, f32, sum, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 0, 0, 0)), nothing);
+  const scc_ir_value_t below = scc_test_append(function, entry, SCC_IR_OPERATION_LESS, boolean, first, scc_ir_function_splat(function, f32, 0.0), nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_BRANCH, none, below, scc_test_block(negative), scc_test_block(positive));
+
+  const scc_ir_value_t doubled = scc_test_append(function, negative, SCC_IR_OPERATION_MULTIPLY, f32x4, sum, scc_ir_function_splat(function, f32, 2.0), nothing);
+  const scc_ir_value_t shifted = scc_test_append(function, negative, SCC_IR_OPERATION_ADD, f32x4, doubled, a, nothing);
+  scc_test_append(function, negative, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), nothing, nothing);
+
+  const scc_ir_value_t floored = scc_test_append(function, positive, SCC_IR_OPERATION_FLOOR, f32x4, sum, nothing, nothing);
+  const scc_ir_value_t reduced = scc_test_append(function, positive, SCC_IR_OPERATION_SUB, f32x4, floored, b, nothing);
+  scc_test_append(function, positive, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), nothing, nothing);
+
+  const scc_ir_value_t incoming[4] = { scc_test_block(negative), shifted, scc_test_block(positive), reduced };
+  const scc_ir_value_t chosen = scc_ir_function_append(function, exit, SCC_IR_OPERATION_PHI, f32x4, incoming, 4);
+
+  scc_test_append(function, exit, SCC_IR_OPERATION_STORE, none, scc_test_global(out), chosen, nothing);
+  scc_test_append(function, exit, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+void scc_test_jit(void) {
+  if (!scc_ir_jit_is_available()) {
+    scc_test_skip("native code can't be generated for this host");
+    return;
+  }
+
+  if (!(scc_ir_jit_features() & SCC_IR_JIT_FEATURE_FMA))
+    scc_test_skip("fused multiply-add isn't supported, so is always interpreted");
+
+  scc_ir_module_t *module = scc_test_jit_module();
+
+  static const scc_uint32_t features[2] = { 0, SCC_IR_JIT_FEATURE_FMA };
+
+  // Signs alternate irregularly, so batches diverge.
+  float a[4 * SCC_TEST_MOST_INVOCATIONS];
+  float b[4 * SCC_TEST_MOST_INVOCATIONS];
+
+  for (scc_uint32_t count = 0; count < sizeof(SCC_TEST_COUNTS) / sizeof(SCC_TEST_COUNTS[0]); ++count) {
+    const scc_uint32_t invocations = SCC_TEST_COUNTS[count];
+
+    for (scc_uint32_t word = 0; word < 4 * invocations; ++word) {
+      a[word] = (float)((word * 7) % 11) * (((word * 5) % 3) ? 1.0f : -1.0f) + 0.125f;
+      b[word] = (float)((word * 3) % 13) * 0.5f - 2.0f;
+    }
+
+    float expected[4 * SCC_TEST_MOST_INVOCATIONS];
+
+    void *globals[3] = { a, b, expected };
+
+    SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, invocations));
+
+    for (scc_uint32_t feature = 0; feature < 2; ++feature) {
+      float actual[4 * SCC_TEST_MOST_INVOCATIONS];
+
+      globals[2] = actual;
+
+      SCC_TEST_CHECK(scc_test_run_native(module, module->entry, globals, invocations, features[feature]));
+
+      for (scc_uint32_t word = 0; word < 4 * invocations; ++word)
+        SCC_TEST_CHECK(memcmp(&actual[word], &expected[word], sizeof(float)) == 0);
+    }
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
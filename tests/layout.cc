@@ -0,0 +1,349 @@
+//===-- tests/layout.cc ---------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/ir/layout.h"
+#include "scc/backend/reflection.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Bytes of each constant buffer, and of loose constants, with room to spare.
+#define SCC_TEST_BUFFER_SIZE 256
+
+// What each constant, or member of one, is given, by name.
+typedef struct scc_test_layout_value {
+  const char *name;
+  float components[4];
+} scc_test_layout_value_t;
+
+static const scc_test_layout_value_t SCC_TEST_VALUES[] = {
+  { "gloss",     {  0.5f } },
+  { "normal",    {  1.0f,   2.0f, 3.0f } },
+  { "scale",     {  2.0f,  -1.0f } },
+  { "tint",      {  0.25f,  0.5f, 0.75f, 1.0f } },
+  { "bias",      { -0.125f } },
+  { "uv",        {  3.0f,   4.0f } },
+  { "time",      {  2.0f } },
+  { "wind",      {  0.5f,  -0.5f, 1.5f } },
+  { "speed",     {  0.25f,  8.0f } },
+  { "direction", {  0.0f,   1.0f, 0.0f } },
+  { "intensity", {  3.0f } }
+};
+
+#define SCC_TEST_NUM_OF_VALUES (sizeof(SCC_TEST_VALUES) / sizeof(SCC_TEST_VALUES[0]))
+
+// Where members of `material` are expected to be placed, in order, by each
+// of the rules below.
+typedef struct scc_test_layout_case {
+  scc_target_t target;
+  scc_ir_packing_t packing;
+
+  const char *order[7];
+  scc_uint32_t offsets[7];
+  scc_uint32_t size;
+
+  // Loose constants, likewise.
+  const char *loose[3];
+  scc_uint32_t loose_offsets[3];
+} scc_test_layout_case_t;
+
+static const scc_test_layout_case_t SCC_TEST_CASES[] = {
+  { SCC_TARGET_GLSL, SCC_IR_PACKING_STD140,
+    { "world", "tint", "normal", "gloss", "scale", "uv", "bias" }, { 0, 32, 48, 60, 64, 72, 80 }, 96,
+    { "wind", "time", "speed" }, { 0, 12, 16 } },
+
+  { SCC_TARGET_SPIRV, SCC_IR_PACKING_STD430,
+    { "tint", "normal", "gloss", "world", "scale", "uv", "bias" }, { 0, 16, 28, 32, 48, 56, 64 }, 80,
+    { "wind", "time", "speed" }, { 0, 12, 16 } },
+
+  // Nothing straddles registers, and the target decides.
+  { SCC_TARGET_HLSL, SCC_IR_PACKING_TARGET,
+    { "world", "scale", "tint", "normal", "gloss", "uv", "bias" }, { 0, 24, 32, 48, 60, 64, 72 }, 76,
+    { "wind", "time", "speed" }, { 0, 12, 16 } },
+
+  // Vectors of three are aligned to their components.
+  { SCC_TARGET_MSL, SCC_IR_PACKING_MSL,
+    { "tint", "world", "scale", "uv", "normal", "gloss", "bias" }, { 0, 16, 32, 40, 48, 60, 64 }, 80,
+    { "speed", "wind", "time" }, { 0, 8, 20 } }
+};
+
+#define SCC_TEST_NUM_OF_CASES (sizeof(SCC_TEST_CASES) / sizeof(SCC_TEST_CASES[0]))
+
+// Combines every member of a constant buffer laid out as it's declared, with
+// gaps to spare, loose constants likewise, and members of another buffer
+// whose structure is nested in a third, so keeps its layout.
+static scc_ir_module_t *scc_test_layout_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x2 = scc_ir_type(SCC_IR_F32, 2, 1);
+  const scc_ir_type_t f32x3 = scc_ir_type(SCC_IR_F32, 3, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t f32x2x2 = scc_ir_type(SCC_IR_F32, 2, 2);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t material = scc_ir_module_add_structure(module, "material");
+  const scc_uint32_t gloss = scc_ir_module_add_member(module, material, "gloss", f32, 0);
+  const scc_uint32_t normal = scc_ir_module_add_member(module, material, "normal", f32x3, 16);
+  const scc_uint32_t scale = scc_ir_module_add_member(module, material, "scale", f32x2, 32);
+  const scc_uint32_t tint = scc_ir_module_add_member(module, material, "tint", f32x4, 48);
+  const scc_uint32_t bias = scc_ir_module_add_member(module, material, "bias", f32, 64);
+  const scc_uint32_t uv = scc_ir_module_add_member(module, material, "uv", f32x2, 72);
+  scc_ir_module_add_member(module, material, "world", f32x2x2, 80);
+
+  const scc_uint32_t light = scc_ir_module_add_structure(module, "light");
+  const scc_uint32_t direction = scc_ir_module_add_member(module, light, "direction", f32x3, 0);
+  const scc_uint32_t intensity = scc_ir_module_add_member(module, light, "intensity", f32, 16);
+
+  scc_ir_type_t material_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  material_type.structure = material;
+
+  scc_ir_type_t light_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  light_type.structure = light;
+
+  const scc_uint32_t scene = scc_ir_module_add_structure(module, "scene");
+  scc_ir_module_add_member(module, scene, "sun", light_type, 0);
+
+  const scc_uint32_t in_material = scc_ir_module_add_global(module, "material", SCC_IR_CONSTANT, material_type, 0);
+  const scc_uint32_t in_sun = scc_ir_module_add_global(module, "sun", SCC_IR_CONSTANT, light_type, 1);
+  const scc_uint32_t in_time = scc_ir_module_add_global(module, "time", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t in_wind = scc_ir_module_add_global(module, "wind", SCC_IR_CONSTANT, f32x3, SCC_IR_NONE);
+  const scc_uint32_t in_speed = scc_ir_module_add_global(module, "speed", SCC_IR_CONSTANT, f32x2, SCC_IR_NONE);
+  const scc_uint32_t out_color = scc_ir_module_add_global(module, "color", SCC_IR_OUTPUT, f32x4, 0);
+  const scc_uint32_t out_shade = scc_ir_module_add_global(module, "shade", SCC_IR_OUTPUT, f32x3, 1);
+  const scc_uint32_t out_coords = scc_ir_module_add_global(module, "coords", SCC_IR_OUTPUT, f32x2, 2);
+
+  module->globals[in_time].offset = 0;
+  module->globals[in_wind].offset = 16;
+  module->globals[in_speed].offset = 32;
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+#define SCC_TEST_MEMBER(Global, Member, Type) \
+  scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, Type, scc_test_global(Global), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, Member), nothing)
+
+#define SCC_TEST_LOOSE(Global, Type) \
+  scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, Type, scc_test_global(Global), nothing, nothing)
+
+  // color = tint * gloss + bias
+  const scc_ir_value_t tinted = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, SCC_TEST_MEMBER(in_material, tint, f32x4), SCC_TEST_MEMBER(in_material, gloss, f32), nothing);
+  const scc_ir_value_t color = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4, tinted, SCC_TEST_MEMBER(in_material, bias, f32), nothing);
+
+  // shade = ((normal * wind) * time + direction) * intensity
+  const scc_ir_value_t blown = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x3, SCC_TEST_MEMBER(in_material, normal, f32x3), SCC_TEST_LOOSE(in_wind, f32x3), nothing);
+  const scc_ir_value_t timed = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x3, blown, SCC_TEST_LOOSE(in_time, f32), nothing);
+  const scc_ir_value_t lit = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x3, timed, SCC_TEST_MEMBER(in_sun, direction, f32x3), nothing);
+  const scc_ir_value_t shade = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x3, lit, SCC_TEST_MEMBER(in_sun, intensity, f32), nothing);
+
+  // coords = scale * uv + speed
+  const scc_ir_value_t scaled = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x2, SCC_TEST_MEMBER(in_material, scale, f32x2), SCC_TEST_MEMBER(in_material, uv, f32x2), nothing);
+  const scc_ir_value_t coords = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x2, scaled, SCC_TEST_LOOSE(in_speed, f32x2), nothing);
+
+#undef SCC_TEST_MEMBER
+#undef SCC_TEST_LOOSE
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_color), color, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_shade), shade, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_coords), coords, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Copies what `name` is given, as many components as `type` has, to `offset`
+// bytes into `buffer`.
+static void scc_test_layout_put(char *buffer,
+                                scc_uint32_t offset,
+                                scc_ir_type_t type,
+                                const char *name) {
+  for (scc_uint32_t value = 0; value < SCC_TEST_NUM_OF_VALUES; ++value)
+    if (strcmp(SCC_TEST_VALUES[value].name, name) == 0)
+      memcpy(&buffer[offset], SCC_TEST_VALUES[value].components, type.rows * sizeof(float));
+}
+
+// Interprets `module` after filling constant buffers by where it says their
+// members are, to `outputs`, which hold a vector of four apiece.
+static void scc_test_layout_run(const scc_ir_module_t *module,
+                                float outputs[3][4]) {
+  scc_uint32_t buffers[3][SCC_TEST_BUFFER_SIZE / 4];
+
+  memset(buffers, 0, sizeof(buffers));
+  memset(outputs, 0, 3 * sizeof(outputs[0]));
+
+  void *globals[8];
+
+  scc_uint32_t num_of_buffers = 0;
+  scc_uint32_t num_of_outputs = 0;
+
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global) {
+    const scc_ir_global_t *g = &module->globals[global];
+    const char *name = &module->strings[g->name];
+
+    if (g->storage == SCC_IR_OUTPUT) {
+      globals[global] = outputs[num_of_outputs++];
+    } else if (g->type.scalar != SCC_IR_STRUCTURE) {
+      // Loose constants share a buffer.
+      globals[global] = buffers[2];
+      scc_test_layout_put((char *)buffers[2], g->offset, g->type, name);
+    } else {
+      char *buffer = (char *)buffers[num_of_buffers++];
+
+      const scc_ir_structure_t *structure = &module->structures[g->type.structure];
+
+      for (scc_uint32_t member = 0; member < structure->num_of_members; ++member) {
+        const scc_ir_member_t *def = &module->members[structure->first_member + member];
+        scc_test_layout_put(buffer, def->offset, def->type, &module->strings[def->name]);
+      }
+
+      globals[global] = buffer;
+    }
+  }
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, 1));
+}
+
+// Returns the global named `name`.
+static const scc_ir_global_t *scc_test_layout_global(const scc_ir_module_t *module,
+                                                     const char *name) {
+  for (scc_uint32_t global = 0; global < module->num_of_globals; ++global)
+    if (strcmp(&module->strings[module->globals[global].name], name) == 0)
+      return &module->globals[global];
+
+  return NULL;
+}
+
+static void scc_test_layout_for(scc_ir_module_t *module,
+                                scc_target_t target,
+                                scc_ir_packing_t packing) {
+  scc_ir_pass_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.target = target;
+  options.packing = packing;
+  options.threads = 1;
+
+  scc_ir_pass_manager_t *manager = scc_ir_pass_manager_create(&options);
+
+  scc_ir_pass_manager_add(manager, &SCC_IR_LAYOUT_PASS);
+
+  scc_ir_pass_manager_run(manager, module);
+
+  scc_ir_pass_manager_destroy(manager);
+}
+
+void scc_test_layout(void) {
+  scc_ir_module_t *module = scc_test_layout_module();
+
+  float before[3][4];
+
+  scc_test_layout_run(module, before);
+
+  SCC_TEST_CHECK(before[0][3] == 1.0f * 0.5f - 0.125f);
+  SCC_TEST_CHECK(before[1][1] == (2.0f * -0.5f * 2.0f + 1.0f) * 3.0f);
+  SCC_TEST_CHECK((before[2][0] == 2.0f * 3.0f + 0.25f) && (before[2][1] == -1.0f * 4.0f + 8.0f));
+
+  for (scc_uint32_t index = 0; index < SCC_TEST_NUM_OF_CASES; ++index) {
+    const scc_test_layout_case_t *test = &SCC_TEST_CASES[index];
+
+    const scc_ir_packing_t packing = (test->packing == SCC_IR_PACKING_TARGET) ? scc_ir_packing_of(test->target) : test->packing;
+
+    scc_ir_module_t *laid_out = scc_ir_module_clone(module);
+
+    const scc_ir_type_t material = scc_test_layout_global(laid_out, "material")->type;
+
+    const scc_uint32_t size = scc_ir_layout_size(laid_out, packing, material);
+
+    scc_test_layout_for(laid_out, test->target, test->packing);
+
+    // Members are placed as tightly as the rules allow, then renumbered in
+    // order of offset, taking fewer registers than before.
+    const scc_ir_structure_t *structure = &laid_out->structures[material.structure];
+
+    SCC_TEST_CHECK(structure->num_of_members == 7);
+
+    for (scc_uint32_t member = 0; member < 7; ++member) {
+      const scc_ir_member_t *def = &laid_out->members[structure->first_member + member];
+
+      SCC_TEST_CHECK(strcmp(&laid_out->strings[def->name], test->order[member]) == 0);
+      SCC_TEST_CHECK(def->offset == test->offsets[member]);
+    }
+
+    SCC_TEST_CHECK(scc_ir_layout_size(laid_out, packing, material) == test->size);
+    SCC_TEST_CHECK((test->size + 15) / 16 < (size + 15) / 16);
+
+    // Loose constants likewise, among the indices they had.
+    for (scc_uint32_t constant = 0; constant < 3; ++constant) {
+      const scc_ir_global_t *global = scc_test_layout_global(laid_out, test->loose[constant]);
+
+      SCC_TEST_CHECK(global == &laid_out->globals[2 + constant]);
+      SCC_TEST_CHECK(global->offset == test->loose_offsets[constant]);
+    }
+
+    // Nested structures keep their layout.
+    const scc_ir_type_t light = scc_test_layout_global(laid_out, "sun")->type;
+
+    SCC_TEST_CHECK(laid_out->members[laid_out->structures[light.structure].first_member + 1].offset == 16);
+
+    // And reflection says where everything went.
+    scc_writer_t *writer = scc_writer_create(NULL, 4096);
+
+    scc_reflection_emit(laid_out, packing, writer);
+
+    scc_uint32_t blob[1024];
+
+    const scc_size_t size_of_blob = scc_writer_size(writer);
+
+    SCC_TEST_CHECK(size_of_blob <= sizeof(blob));
+
+    if (size_of_blob <= sizeof(blob)) {
+      scc_writer_copy(writer, (char *)blob);
+
+      const scc_reflection_header_t *header = scc_reflection_open(blob, size_of_blob);
+
+      SCC_TEST_CHECK(header != NULL);
+
+      if (header != NULL) {
+        const scc_reflection_resource_t *resource = scc_reflection_find(header, "material");
+        const scc_reflection_field_t *fields = scc_reflection_fields(header);
+
+        for (scc_uint32_t member = 0; member < 7; ++member)
+          SCC_TEST_CHECK(fields[resource->first_field + member].offset == test->offsets[member]);
+
+        SCC_TEST_CHECK(scc_reflection_find(header, test->loose[2])->offset == test->loose_offsets[2]);
+      }
+    }
+
+    scc_writer_destroy(writer);
+
+    // Nothing reads anything else.
+    float after[3][4];
+
+    scc_test_layout_run(laid_out, after);
+
+    SCC_TEST_CHECK(memcmp(after, before, sizeof(before)) == 0);
+
+    scc_ir_module_destroy(laid_out);
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
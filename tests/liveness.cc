@@ -0,0 +1,143 @@
+//===-- tests/liveness.cc -------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/ir/cfg.h"
+#include "scc/ir/liveness.h"
+
+SCC_BEGIN_EXTERN_C
+
+enum {
+  SCC_TEST_ENTRY = 0,
+  SCC_TEST_LEFT  = 1,
+  SCC_TEST_RIGHT = 2,
+  SCC_TEST_EXIT  = 3
+};
+
+// Instructions whose liveness is checked.
+typedef struct scc_test_liveness_values {
+  scc_uint32_t a, b, sign, left, right, joined;
+} scc_test_liveness_values_t;
+
+// Doubles `a` on one side of a diamond and squares `b` on the other, then
+// joins the results with a phi.
+static scc_ir_module_t *scc_test_liveness_module(scc_test_liveness_values_t *values) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in_a = scc_ir_module_add_global(module, "a", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_b = scc_ir_module_add_global(module, "b", SCC_IR_INPUT, f32x4, 1);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  scc_ir_function_add_block(function, "entry");
+  scc_ir_function_add_block(function, "left");
+  scc_ir_function_add_block(function, "right");
+  scc_ir_function_add_block(function, "exit");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t a = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_a), nothing, nothing);
+  const scc_ir_value_t b = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_b), nothing, nothing);
+  const scc_ir_value_t first = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_SWIZZLE, f32, a, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 0, 0, 0)), nothing);
+  const scc_ir_value_t sign = scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_LESS, boolean, first, scc_ir_function_splat(function, f32, 0.0), nothing);
+  scc_test_append(function, SCC_TEST_ENTRY, SCC_IR_OPERATION_BRANCH, none, sign, scc_test_block(SCC_TEST_LEFT), scc_test_block(SCC_TEST_RIGHT));
+
+  const scc_ir_value_t left = scc_test_append(function, SCC_TEST_LEFT, SCC_IR_OPERATION_ADD, f32x4, a, a, nothing);
+  scc_test_append(function, SCC_TEST_LEFT, SCC_IR_OPERATION_JUMP, none, scc_test_block(SCC_TEST_EXIT), nothing, nothing);
+
+  const scc_ir_value_t right = scc_test_append(function, SCC_TEST_RIGHT, SCC_IR_OPERATION_MULTIPLY, f32x4, b, b, nothing);
+  scc_test_append(function, SCC_TEST_RIGHT, SCC_IR_OPERATION_JUMP, none, scc_test_block(SCC_TEST_EXIT), nothing, nothing);
+
+  const scc_ir_value_t incoming[4] = { scc_test_block(SCC_TEST_LEFT), left, scc_test_block(SCC_TEST_RIGHT), right };
+  const scc_ir_value_t joined = scc_ir_function_append(function, SCC_TEST_EXIT, SCC_IR_OPERATION_PHI, f32x4, incoming, 4);
+
+  scc_test_append(function, SCC_TEST_EXIT, SCC_IR_OPERATION_STORE, none, scc_test_global(out), joined, nothing);
+  scc_test_append(function, SCC_TEST_EXIT, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  values->a = scc_ir_liveness_index(function, a);
+  values->b = scc_ir_liveness_index(function, b);
+  values->sign = scc_ir_liveness_index(function, sign);
+  values->left = scc_ir_liveness_index(function, left);
+  values->right = scc_ir_liveness_index(function, right);
+  values->joined = scc_ir_liveness_index(function, joined);
+
+  return module;
+}
+
+void scc_test_liveness(void) {
+  scc_test_liveness_values_t values;
+
+  scc_ir_module_t *module = scc_test_liveness_module(&values);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  scc_ir_cfg_t *cfg = scc_ir_cfg_compute(function);
+
+  scc_ir_liveness_t *liveness = scc_ir_liveness_compute(function, cfg);
+
+  // Each side only keeps what it uses alive.
+  SCC_TEST_CHECK(scc_ir_liveness_contains(scc_ir_live_out(liveness, SCC_TEST_ENTRY), values.a));
+  SCC_TEST_CHECK(scc_ir_liveness_contains(scc_ir_live_out(liveness, SCC_TEST_ENTRY), values.b));
+  SCC_TEST_CHECK(!scc_ir_liveness_contains(scc_ir_live_out(liveness, SCC_TEST_ENTRY), values.sign));
+
+  SCC_TEST_CHECK(scc_ir_liveness_contains(scc_ir_live_in(liveness, SCC_TEST_LEFT), values.a));
+  SCC_TEST_CHECK(!scc_ir_liveness_contains(scc_ir_live_in(liveness, SCC_TEST_LEFT), values.b));
+  SCC_TEST_CHECK(scc_ir_liveness_contains(scc_ir_live_in(liveness, SCC_TEST_RIGHT), values.b));
+  SCC_TEST_CHECK(!scc_ir_liveness_contains(scc_ir_live_in(liveness, SCC_TEST_RIGHT), values.a));
+
+  // Operands of the phi are live out of their own side, not into its block.
+  SCC_TEST_CHECK(scc_ir_liveness_contains(scc_ir_live_out(liveness, SCC_TEST_LEFT), values.left));
+  SCC_TEST_CHECK(!scc_ir_liveness_contains(scc_ir_live_out(liveness, SCC_TEST_LEFT), values.right));
+  SCC_TEST_CHECK(scc_ir_liveness_contains(scc_ir_live_out(liveness, SCC_TEST_RIGHT), values.right));
+  SCC_TEST_CHECK(!scc_ir_liveness_contains(scc_ir_live_in(liveness, SCC_TEST_EXIT), values.left));
+  SCC_TEST_CHECK(!scc_ir_liveness_contains(scc_ir_live_in(liveness, SCC_TEST_EXIT), values.right));
+  SCC_TEST_CHECK(!scc_ir_liveness_contains(scc_ir_live_out(liveness, SCC_TEST_EXIT), values.joined));
+
+  for (scc_uint32_t word = 0; word < liveness->num_of_words; ++word)
+    SCC_TEST_CHECK(scc_ir_live_in(liveness, SCC_TEST_ENTRY)[word] == 0);
+
+  // At worst `a`, `b`, and the first component of `a` are held in entry.
+  scc_ir_pressure_t pressure;
+
+  scc_ir_liveness_pressure(function, cfg, liveness, &pressure);
+
+  SCC_TEST_CHECK(pressure.values == 3);
+  SCC_TEST_CHECK(pressure.components == 9);
+  SCC_TEST_CHECK(pressure.registers == 3);
+
+  scc_uint32_t components, registers;
+
+  scc_ir_liveness_weigh(scc_ir_type(SCC_IR_F32, 4, 4), &components, &registers);
+
+  SCC_TEST_CHECK((components == 16) && (registers == 4));
+
+  scc_ir_liveness_weigh(scc_ir_type(SCC_IR_F32, 3, 1), &components, &registers);
+
+  SCC_TEST_CHECK((components == 3) && (registers == 1));
+
+  scc_ir_liveness_destroy(liveness);
+  scc_ir_cfg_destroy(cfg);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
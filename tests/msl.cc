@@ -0,0 +1,247 @@
+//===-- tests/msl.cc ------------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/backend/hlsl.h"
+#include "scc/backend/msl.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Most bytes emitted for either module below, with room to spare.
+#define SCC_TEST_MOST_BYTES 8192
+
+// Transforms `position` by a loose matrix and its inverse, and passes an
+// integer and a saturated weight on. The loose vector of three isn't aligned
+// as Metal would align it.
+static scc_ir_module_t *scc_test_msl_vertex_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_VERTEX_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x3 = scc_ir_type(SCC_IR_F32, 3, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t f32x4x4 = scc_ir_type(SCC_IR_F32, 4, 4);
+  const scc_ir_type_t i32 = scc_ir_type(SCC_IR_I32, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t transform = scc_ir_module_add_global(module, "transform", SCC_IR_CONSTANT, f32x4x4, SCC_IR_NONE);
+  const scc_uint32_t shift = scc_ir_module_add_global(module, "shift", SCC_IR_CONSTANT, f32x3, SCC_IR_NONE);
+  const scc_uint32_t bias = scc_ir_module_add_global(module, "bias", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t in_position = scc_ir_module_add_global(module, "position", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_id = scc_ir_module_add_global(module, "id", SCC_IR_INPUT, i32, 1);
+  const scc_uint32_t out_position = scc_ir_module_add_global(module, "clip", SCC_IR_OUTPUT, f32x4, SCC_IR_NONE);
+  const scc_uint32_t out_id = scc_ir_module_add_global(module, "tag", SCC_IR_OUTPUT, i32, 0);
+  const scc_uint32_t out_weight = scc_ir_module_add_global(module, "weight", SCC_IR_OUTPUT, f32, 1);
+
+  module->globals[transform].offset = 0;
+  module->globals[shift].offset = 64;
+  module->globals[bias].offset = 76;
+
+  module->globals[out_position].builtin = SCC_IR_BUILTIN_POSITION;
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t p = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_position), nothing, nothing);
+  const scc_ir_value_t m = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4x4, scc_test_global(transform), nothing, nothing);
+  const scc_ir_value_t inverse = scc_test_append(function, entry, SCC_IR_OPERATION_INVERSE, f32x4x4, m, nothing, nothing);
+  const scc_ir_value_t sum = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4x4, m, inverse, nothing);
+  const scc_ir_value_t clip = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, sum, p, nothing);
+
+  const scc_ir_value_t s = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x3, scc_test_global(shift), nothing, nothing);
+  const scc_ir_value_t b = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(bias), nothing, nothing);
+  const scc_ir_value_t shifted = scc_test_append(function, entry, SCC_IR_OPERATION_DOT, f32, s, s, nothing);
+  const scc_ir_value_t biased = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32, shifted, b, nothing);
+  const scc_ir_value_t weight = scc_test_append(function, entry, SCC_IR_OPERATION_SATURATE, f32, biased, nothing, nothing);
+
+  const scc_ir_value_t id = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, i32, scc_test_global(in_id), nothing, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_position), clip, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_id), id, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_weight), weight, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Receives what the module above passes on, writing the integer through, and
+// a texel scaled by the weight and a depth.
+static scc_ir_module_t *scc_test_msl_pixel_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x2 = scc_ir_type(SCC_IR_F32, 2, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t i32 = scc_ir_type(SCC_IR_I32, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t texture = scc_ir_module_add_global(module, "albedo", SCC_IR_TEXTURE, f32x4, 0);
+  const scc_uint32_t in_id = scc_ir_module_add_global(module, "tag", SCC_IR_INPUT, i32, 0);
+  const scc_uint32_t in_weight = scc_ir_module_add_global(module, "weight", SCC_IR_INPUT, f32, 1);
+  const scc_uint32_t out_color = scc_ir_module_add_global(module, "color", SCC_IR_OUTPUT, f32x4, 0);
+  const scc_uint32_t out_id = scc_ir_module_add_global(module, "object", SCC_IR_OUTPUT, i32, 1);
+  const scc_uint32_t out_depth = scc_ir_module_add_global(module, "depth", SCC_IR_OUTPUT, f32, SCC_IR_NONE);
+
+  module->globals[out_depth].builtin = SCC_IR_BUILTIN_DEPTH;
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t id = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, i32, scc_test_global(in_id), nothing, nothing);
+  const scc_ir_value_t w = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(in_weight), nothing, nothing);
+  const scc_ir_value_t uv = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x2, scc_ir_function_splat(function, f32x2, 0.5), w, nothing);
+  const scc_ir_value_t texel = scc_test_append(function, entry, SCC_IR_OPERATION_FETCH, f32x4, scc_test_global(texture), uv, nothing);
+  const scc_ir_value_t color = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, texel, w, nothing);
+  const scc_ir_value_t depth = scc_test_append(function, entry, SCC_IR_OPERATION_SATURATE, f32, w, nothing, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_color), color, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_id), id, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_depth), depth, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Emits `module` to `text`, which is terminated, as MSL, or as HLSL if
+// `hlsl`. Returns false if it couldn't be.
+static scc_bool_t scc_test_msl_emit(const scc_ir_module_t *module,
+                                    const scc_msl_options_t *options,
+                                    scc_bool_t hlsl,
+                                    char *text) {
+  scc_writer_t *writer = scc_writer_create(NULL, 4096);
+
+  const scc_bool_t emitted = hlsl ? scc_hlsl_emit(module, NULL, writer)
+                                  : scc_msl_emit(module, options, writer);
+
+  const scc_size_t size = scc_writer_size(writer);
+
+  SCC_TEST_CHECK(size < SCC_TEST_MOST_BYTES);
+
+  if (emitted && (size < SCC_TEST_MOST_BYTES)) {
+    scc_writer_copy(writer, text);
+    text[size] = '\0';
+  } else {
+    text[0] = '\0';
+  }
+
+  scc_writer_destroy(writer);
+
+  return emitted;
+}
+
+void scc_test_msl(void) {
+  char text[SCC_TEST_MOST_BYTES];
+
+  scc_ir_module_t *vertex = scc_test_msl_vertex_module();
+
+  SCC_TEST_CHECK(scc_test_msl_emit(vertex, NULL, SCC_FALSE, text));
+
+  SCC_TEST_CHECK(strstr(text, "#include <metal_stdlib>\n") == text);
+  SCC_TEST_CHECK(strstr(text, "vertex _Output main0(_Input _input [[stage_in]], constant _Buffers &_buffers [[buffer(0)]])") != NULL);
+
+  // Inputs are attributes, and only the receiving side says how outputs are
+  // interpolated.
+  SCC_TEST_CHECK(strstr(text, "float4 position [[attribute(0)]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "int id [[attribute(1)]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "float4 clip [[position]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "int tag [[user(locn0)]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "float weight [[user(locn1)]];") != NULL);
+
+  // Loose constants are laid out as given, which takes packing a vector of
+  // three, and are renamed where they clash with the language.
+  SCC_TEST_CHECK(strstr(text, "struct _Constants {\n  float4x4 transform;\n  packed_float3 shift;\n  float bias_;\n};") != NULL);
+  SCC_TEST_CHECK(strstr(text, "constant _Constants *_constants [[id(0)]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "_g._b->_constants->bias_") != NULL);
+
+  // Metal has no inverse, so one is provided.
+  SCC_TEST_CHECK(strstr(text, "float4x4 _inverse4(float4x4 m) {") != NULL);
+  SCC_TEST_CHECK(strstr(text, "_inverse2(") == NULL);
+  SCC_TEST_CHECK(strstr(text, "_inverse4(_") != NULL);
+  SCC_TEST_CHECK(strstr(text, "saturate(") != NULL);
+
+  // Argument buffers go where asked.
+  scc_msl_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.version = 20;
+  options.buffer = 3;
+
+  SCC_TEST_CHECK(scc_test_msl_emit(vertex, &options, SCC_FALSE, text));
+  SCC_TEST_CHECK(strstr(text, "constant _Buffers &_buffers [[buffer(3)]]") != NULL);
+
+  // But not without support for them.
+  options.version = 12;
+
+  SCC_TEST_CHECK(!scc_test_msl_emit(vertex, &options, SCC_FALSE, text));
+
+  scc_ir_module_destroy(vertex);
+
+  scc_ir_module_t *pixel = scc_test_msl_pixel_module();
+
+  SCC_TEST_CHECK(scc_test_msl_emit(pixel, NULL, SCC_FALSE, text));
+
+  SCC_TEST_CHECK(strstr(text, "fragment _Output main0(_Input _input [[stage_in]], constant _Textures &_textures [[buffer(1)]])") != NULL);
+
+  // Integers aren't interpolated, while everything else is.
+  SCC_TEST_CHECK(strstr(text, "int tag [[user(locn0), flat]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "float weight [[user(locn1)]];") != NULL);
+
+  SCC_TEST_CHECK(strstr(text, "float4 color [[color(0)]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "int object [[color(1)]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "float depth [[depth(any)]];") != NULL);
+
+  // Textures are followed by their samplers.
+  SCC_TEST_CHECK(strstr(text, "texture2d<float> albedo [[id(0)]];\n  sampler _Salbedo [[id(1)]];") != NULL);
+  SCC_TEST_CHECK(strstr(text, "_g._t->albedo.sample(_g._t->_Salbedo, ") != NULL);
+  SCC_TEST_CHECK(strstr(text, "level(") == NULL);
+  SCC_TEST_CHECK(strstr(text, "discard_fragment") == NULL);
+
+  // As in HLSL, by the same walk over the interface.
+  SCC_TEST_CHECK(scc_test_msl_emit(pixel, NULL, SCC_TRUE, text));
+
+  SCC_TEST_CHECK(strstr(text, "nointerpolation int tag : TEXCOORD0;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "  float weight : TEXCOORD1;") != NULL);
+  SCC_TEST_CHECK(strstr(text, "float depth : SV_Depth;") != NULL);
+
+  scc_ir_module_destroy(pixel);
+
+  // Metal has no 64-bit floats.
+  scc_ir_module_t *wide = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  scc_ir_module_add_global(wide, "scale", SCC_IR_CONSTANT, scc_ir_type(SCC_IR_F64, 1, 1), SCC_IR_NONE);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(wide, "main", scc_ir_void());
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, scc_ir_void(), SCC_IR_NO_VALUE, SCC_IR_NO_VALUE, SCC_IR_NO_VALUE);
+
+  wide->entry = function->index;
+
+  SCC_TEST_CHECK(!scc_test_msl_emit(wide, NULL, SCC_FALSE, text));
+
+  scc_ir_module_destroy(wide);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,132 @@
+//===-- tests/prune_interface.cc ------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/ir/demanded.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Tints `v` by a member of a constant buffer that has another nothing loads,
+// for a next stage that only reads the first two components.
+static scc_ir_module_t *scc_test_prune_interface_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_VERTEX_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t material = scc_ir_module_add_structure(module, "material");
+  const scc_uint32_t tint = scc_ir_module_add_member(module, material, "tint", f32x4, 0);
+  scc_ir_module_add_member(module, material, "unused", f32, 16);
+
+  scc_ir_type_t material_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  material_type.structure = material;
+
+  const scc_uint32_t buffer = scc_ir_module_add_global(module, "material", SCC_IR_CONSTANT, material_type, 0);
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  module->globals[out].consumed = 0x3;
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t v = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), nothing, nothing);
+  const scc_ir_value_t t = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(buffer), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, tint), nothing);
+  const scc_ir_value_t tinted = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, v, t, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out), tinted, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+void scc_test_prune_interface(void) {
+  scc_ir_module_t *module = scc_test_prune_interface_module();
+
+  // Only what ends up in `o.xy` is demanded, all the way back.
+  {
+    const scc_ir_function_t *function = module->functions[module->entry];
+
+    scc_ir_demanded_t *demanded = scc_ir_demanded_compute(function);
+
+    for (scc_uint32_t i = 0; i < 3; ++i)
+      SCC_TEST_CHECK(scc_ir_demanded_components(demanded, SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, i)) == 0x3);
+
+    scc_ir_demanded_destroy(demanded);
+  }
+
+  float constants[8] = { 0.5f, 2.0f, -1.0f, 4.0f, 100.0f, 0.0f, 0.0f, 0.0f };
+
+  float in[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word)
+    in[word] = (float)word - 3.0f;
+
+  float before[4 * SCC_TEST_INVOCATIONS];
+  float after[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[3] = { constants, in, before };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_SHRINK_PASS, &SCC_IR_PRUNE_INTERFACE_PASS, &SCC_IR_SWIZZLE_PASS, &SCC_IR_DCE_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 4);
+
+  // The member nothing loads goes, and what's left is narrowed, keeping its
+  // offset.
+  const scc_ir_structure_t *structure = &module->structures[0];
+
+  SCC_TEST_CHECK(structure->num_of_members == 1);
+  SCC_TEST_CHECK(module->members[structure->first_member].type.rows == 2);
+  SCC_TEST_CHECK(module->members[structure->first_member].offset == 0);
+
+  SCC_TEST_CHECK(module->num_of_globals == 3);
+  SCC_TEST_CHECK(module->globals[1].type.rows == 2);
+  SCC_TEST_CHECK(module->globals[2].type.rows == 2);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  // So is the multiply, leaving nothing to swizzle.
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (scc_ir_instruction_is_live(instruction) && (instruction->op == SCC_IR_OPERATION_MULTIPLY))
+      SCC_TEST_CHECK(instruction->type.rows == 2);
+  }
+
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_SWIZZLE) == 0);
+
+  // Narrowed inputs and outputs are just their first components.
+  globals[2] = after;
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  for (scc_uint32_t word = 0; word < 2 * SCC_TEST_INVOCATIONS; ++word) {
+    SCC_TEST_CHECK(before[word] == in[word] * constants[word / SCC_TEST_INVOCATIONS]);
+    SCC_TEST_CHECK(after[word] == before[word]);
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,269 @@
+//===-- tests/reflection.cc -----------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+#include "scc/backend/reflection.h"
+
+SCC_BEGIN_EXTERN_C
+
+// Most bytes reflected for the module below, with room to spare.
+#define SCC_TEST_MOST_BYTES 4096
+
+// Declares a little of everything: a constant buffer with a matrix and a
+// nested structure, loose constants, a member sharing a name with one of
+// them, an input structure with a matrix among its members, textures sampled
+// in one and two dimensions, and a builtin output.
+static scc_ir_module_t *scc_test_reflection_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x2 = scc_ir_type(SCC_IR_F32, 2, 1);
+  const scc_ir_type_t f32x3 = scc_ir_type(SCC_IR_F32, 3, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t f32x3x3 = scc_ir_type(SCC_IR_F32, 3, 3);
+  const scc_ir_type_t f32x4x4 = scc_ir_type(SCC_IR_F32, 4, 4);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t light = scc_ir_module_add_structure(module, "light");
+  scc_ir_module_add_member(module, light, "direction", f32x3, 0);
+  scc_ir_module_add_member(module, light, "tint", f32, 12);
+
+  scc_ir_type_t light_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  light_type.structure = light;
+
+  const scc_uint32_t frame = scc_ir_module_add_structure(module, "frame");
+  scc_ir_module_add_member(module, frame, "world", f32x4x4, 0);
+  scc_ir_module_add_member(module, frame, "sun", light_type, 64);
+
+  scc_ir_type_t frame_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  frame_type.structure = frame;
+
+  const scc_uint32_t vertex = scc_ir_module_add_structure(module, "vertex");
+  scc_ir_module_add_member(module, vertex, "uv", f32x2, 0);
+  scc_ir_module_add_member(module, vertex, "basis", f32x3x3, 0);
+  scc_ir_module_add_member(module, vertex, "normal", f32x3, 0);
+
+  scc_ir_type_t vertex_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  vertex_type.structure = vertex;
+
+  scc_ir_module_add_global(module, "frame", SCC_IR_CONSTANT, frame_type, 0);
+  const scc_uint32_t time = scc_ir_module_add_global(module, "time", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t tint = scc_ir_module_add_global(module, "tint", SCC_IR_CONSTANT, f32x3, SCC_IR_NONE);
+  const scc_uint32_t ramp = scc_ir_module_add_global(module, "ramp", SCC_IR_TEXTURE, f32x4, 1);
+  const scc_uint32_t albedo = scc_ir_module_add_global(module, "albedo", SCC_IR_TEXTURE, f32x4, 2);
+  scc_ir_module_add_global(module, "in", SCC_IR_INPUT, vertex_type, 0);
+  const scc_uint32_t out_color = scc_ir_module_add_global(module, "color", SCC_IR_OUTPUT, f32x4, 0);
+  const scc_uint32_t out_depth = scc_ir_module_add_global(module, "depth", SCC_IR_OUTPUT, f32, SCC_IR_NONE);
+
+  module->globals[time].offset = 0;
+  module->globals[tint].offset = 16;
+
+  module->globals[out_depth].builtin = SCC_IR_BUILTIN_DEPTH;
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t t = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(time), nothing, nothing);
+  const scc_ir_value_t graded = scc_test_append(function, entry, SCC_IR_OPERATION_FETCH, f32x4, scc_test_global(ramp), t, nothing);
+  const scc_ir_value_t uv = scc_ir_function_splat(function, f32x2, 0.5);
+  const scc_ir_value_t texel = scc_test_append(function, entry, SCC_IR_OPERATION_FETCH, f32x4, scc_test_global(albedo), uv, nothing);
+  const scc_ir_value_t color = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, graded, texel, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_color), color, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_depth), t, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Reflects `module` as laid out by `packing` to `blob`, returning its size.
+static scc_size_t scc_test_reflection_emit(const scc_ir_module_t *module,
+                                           scc_ir_packing_t packing,
+                                           scc_uint32_t *blob) {
+  scc_writer_t *writer = scc_writer_create(NULL, 4096);
+
+  SCC_TEST_CHECK(scc_reflection_emit(module, packing, writer));
+
+  const scc_size_t size = scc_writer_size(writer);
+
+  SCC_TEST_CHECK(size <= SCC_TEST_MOST_BYTES);
+
+  if (size <= SCC_TEST_MOST_BYTES)
+    scc_writer_copy(writer, (char *)blob);
+
+  scc_writer_destroy(writer);
+
+  return (size <= SCC_TEST_MOST_BYTES) ? size : 0;
+}
+
+// Checks that `field` is named `name` and placed at `offset`, taking `size`
+// bytes with columns `stride` bytes apart.
+static void scc_test_reflection_field(const scc_reflection_header_t *header,
+                                      const scc_reflection_field_t *field,
+                                      const char *name,
+                                      scc_uint32_t offset,
+                                      scc_uint32_t size,
+                                      scc_uint32_t stride) {
+  SCC_TEST_CHECK(strcmp(scc_reflection_string(header, field->name), name) == 0);
+  SCC_TEST_CHECK(field->offset == offset);
+  SCC_TEST_CHECK(field->size == size);
+  SCC_TEST_CHECK(field->stride == stride);
+}
+
+void scc_test_reflection(void) {
+  scc_ir_module_t *module = scc_test_reflection_module();
+
+  scc_uint32_t blob[SCC_TEST_MOST_BYTES / 4];
+
+  const scc_size_t size = scc_test_reflection_emit(module, SCC_IR_PACKING_STD140, blob);
+
+  const scc_reflection_header_t *header = scc_reflection_open(blob, size);
+
+  SCC_TEST_CHECK(header != NULL);
+
+  if (header == NULL) {
+    scc_ir_module_destroy(module);
+    return;
+  }
+
+  SCC_TEST_CHECK(header->size == size);
+  SCC_TEST_CHECK(header->type == SCC_PIXEL_SHADER);
+  SCC_TEST_CHECK(header->packing == SCC_IR_PACKING_STD140);
+  SCC_TEST_CHECK(header->num_of_resources == module->num_of_globals);
+
+  // Loose constants are gathered in the first slot not taken by a buffer,
+  // rounded up to a whole register.
+  SCC_TEST_CHECK(header->constants == 1);
+  SCC_TEST_CHECK(header->size_of_constants == 32);
+
+  // Names are interned, so the member and constant share one.
+  const scc_reflection_resource_t *tint = scc_reflection_find(header, "tint");
+
+  SCC_TEST_CHECK(tint != NULL);
+  SCC_TEST_CHECK(tint->storage == SCC_IR_CONSTANT);
+  SCC_TEST_CHECK(tint->binding == 1);
+  SCC_TEST_CHECK(tint->offset == 16);
+  SCC_TEST_CHECK(tint->size == 12);
+  SCC_TEST_CHECK(tint->type.scalar == SCC_IR_F32);
+  SCC_TEST_CHECK(tint->type.rows == 3);
+
+  const scc_reflection_resource_t *frame = scc_reflection_find(header, "frame");
+
+  SCC_TEST_CHECK(frame != NULL);
+  SCC_TEST_CHECK(frame->binding == 0);
+  SCC_TEST_CHECK(frame->size == 80);
+  SCC_TEST_CHECK(frame->num_of_fields == 2);
+
+  const scc_reflection_field_t *fields = scc_reflection_fields(header);
+
+  scc_test_reflection_field(header, &fields[frame->first_field + 0], "world", 0, 64, 16);
+  scc_test_reflection_field(header, &fields[frame->first_field + 1], "sun", 64, 16, 0);
+
+  const scc_reflection_field_t *sun = &fields[frame->first_field + 1];
+
+  SCC_TEST_CHECK(sun->type.scalar == SCC_IR_STRUCTURE);
+  SCC_TEST_CHECK(sun->num_of_fields == 2);
+
+  scc_test_reflection_field(header, &fields[sun->first_field + 0], "direction", 0, 12, 0);
+  scc_test_reflection_field(header, &fields[sun->first_field + 1], "tint", 12, 4, 0);
+
+  SCC_TEST_CHECK(fields[sun->first_field + 1].name == tint->name);
+
+  // Members of inputs take a location per column.
+  const scc_reflection_resource_t *in = scc_reflection_find(header, "in");
+
+  SCC_TEST_CHECK(in != NULL);
+  SCC_TEST_CHECK(in->storage == SCC_IR_INPUT);
+  SCC_TEST_CHECK(in->num_of_fields == 3);
+
+  scc_test_reflection_field(header, &fields[in->first_field + 0], "uv", 0, 0, 0);
+  scc_test_reflection_field(header, &fields[in->first_field + 1], "basis", 1, 0, 0);
+  scc_test_reflection_field(header, &fields[in->first_field + 2], "normal", 4, 0, 0);
+
+  // Textures by how they're sampled.
+  const scc_reflection_resource_t *ramp = scc_reflection_find(header, "ramp");
+  const scc_reflection_resource_t *albedo = scc_reflection_find(header, "albedo");
+
+  SCC_TEST_CHECK((ramp != NULL) && (ramp->binding == 1) && (ramp->dimensions == 1));
+  SCC_TEST_CHECK((albedo != NULL) && (albedo->binding == 2) && (albedo->dimensions == 2));
+
+  const scc_reflection_resource_t *depth = scc_reflection_find(header, "depth");
+
+  SCC_TEST_CHECK((depth != NULL) && (depth->storage == SCC_IR_OUTPUT) && (depth->builtin == SCC_IR_BUILTIN_DEPTH));
+
+  SCC_TEST_CHECK(scc_reflection_find(header, "sun") == NULL);
+  SCC_TEST_CHECK(scc_reflection_find(header, "") == NULL);
+
+  // Other rules lay constants out otherwise, and nothing is rounded up when
+  // packed tightly.
+  scc_uint32_t tight[SCC_TEST_MOST_BYTES / 4];
+
+  const scc_size_t size_of_tight = scc_test_reflection_emit(module, SCC_IR_PACKING_TIGHT, tight);
+
+  const scc_reflection_header_t *packed = scc_reflection_open(tight, size_of_tight);
+
+  SCC_TEST_CHECK(packed != NULL);
+
+  if (packed != NULL) {
+    SCC_TEST_CHECK(packed->size_of_constants == 28);
+    SCC_TEST_CHECK(scc_reflection_find(packed, "frame")->size == 80);
+  }
+
+  // Anything truncated, misaligned, or damaged is refused rather than read.
+  SCC_TEST_CHECK(scc_reflection_open(blob, size - 1) == NULL);
+  SCC_TEST_CHECK(scc_reflection_open((const char *)blob + 1, size - 1) == NULL);
+  SCC_TEST_CHECK(scc_reflection_open(NULL, size) == NULL);
+
+  scc_reflection_header_t *damaged = (scc_reflection_header_t *)tight;
+
+  memcpy(tight, blob, size);
+  damaged->magic = 0x53434352u;
+  SCC_TEST_CHECK(scc_reflection_open(tight, size) == NULL);
+
+  memcpy(tight, blob, size);
+  damaged->version += 1;
+  SCC_TEST_CHECK(scc_reflection_open(tight, size) == NULL);
+
+  memcpy(tight, blob, size);
+  damaged->num_of_resources += 1000;
+  SCC_TEST_CHECK(scc_reflection_open(tight, size) == NULL);
+
+  memcpy(tight, blob, size);
+  ((scc_reflection_resource_t *)((char *)tight + damaged->resources))[0].name = damaged->size_of_names;
+  SCC_TEST_CHECK(scc_reflection_open(tight, size) == NULL);
+
+  memcpy(tight, blob, size);
+  ((scc_reflection_field_t *)((char *)tight + damaged->fields))[0].first_field = damaged->num_of_fields;
+  ((scc_reflection_field_t *)((char *)tight + damaged->fields))[0].num_of_fields = 1;
+  SCC_TEST_CHECK(scc_reflection_open(tight, size) == NULL);
+
+  // Lookups wouldn't end without an empty bucket.
+  memcpy(tight, blob, size);
+  memset((char *)tight + damaged->buckets, 0, damaged->num_of_buckets * sizeof(scc_uint32_t));
+  SCC_TEST_CHECK(scc_reflection_open(tight, size) == NULL);
+
+  // Nor would names.
+  memcpy(tight, blob, size);
+  ((char *)tight)[damaged->names + damaged->size_of_names - 1] = 'x';
+  SCC_TEST_CHECK(scc_reflection_open(tight, size) == NULL);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,107 @@
+//===-- tests/scalarize.cc ------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Scales a vector by scalar constants, on either side, then offsets it by a
+// vector constant, so that splitting has to broadcast the former and pick
+// lanes of the latter.
+static scc_ir_module_t *scc_test_scalarize_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", scc_ir_void());
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  scc_ir_constant_t offsets;
+
+  memset(&offsets, 0, sizeof(offsets));
+
+  offsets.type = f32x4;
+
+  for (scc_uint32_t lane = 0; lane < 4; ++lane)
+    offsets.components[lane].f = 1.0 + lane;
+
+  const scc_ir_value_t v =
+    scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), SCC_IR_NO_VALUE, SCC_IR_NO_VALUE);
+  const scc_ir_value_t halved =
+    scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, v, scc_ir_function_splat(function, f32, 0.5), SCC_IR_NO_VALUE);
+  const scc_ir_value_t quartered =
+    scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, scc_ir_function_splat(function, f32, 0.5), halved, SCC_IR_NO_VALUE);
+  const scc_ir_value_t offset =
+    scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4, quartered, scc_ir_function_constant(function, &offsets), SCC_IR_NO_VALUE);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, scc_ir_void(), scc_test_global(out), offset, SCC_IR_NO_VALUE);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, scc_ir_void(), SCC_IR_NO_VALUE, SCC_IR_NO_VALUE, SCC_IR_NO_VALUE);
+
+  module->entry = 0;
+
+  return module;
+}
+
+void scc_test_scalarize(void) {
+  scc_ir_module_t *module = scc_test_scalarize_module();
+
+  float in[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word)
+    in[word] = 4.0f * (float)word - 8.0f;
+
+  float before[4 * SCC_TEST_INVOCATIONS];
+  float after[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[2] = { in, before };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  // The host operates on a component at a time, so splits everything.
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_SCALARIZE_PASS, &SCC_IR_DCE_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 2);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (scc_ir_instruction_is_live(instruction) && (instruction->op == SCC_IR_OPERATION_MULTIPLY))
+      SCC_TEST_CHECK(scc_ir_type_num_of_components(instruction->type) == 1);
+  }
+
+  globals[1] = after;
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  for (scc_uint32_t component = 0; component < 4; ++component) {
+    for (scc_uint32_t invocation = 0; invocation < SCC_TEST_INVOCATIONS; ++invocation) {
+      const scc_uint32_t word = component * SCC_TEST_INVOCATIONS + invocation;
+
+      SCC_TEST_CHECK(before[word] == in[word] * 0.25f + (float)(component + 1));
+      SCC_TEST_CHECK(after[word] == before[word]);
+    }
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,106 @@
+//===-- tests/sccp.cc -----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Scales `v` by one of two factors, chosen by comparing constants, so that
+// the branch, the path not taken, and the phi joining them all fold away.
+static scc_ir_module_t *scc_test_sccp_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+  const scc_uint32_t taken = scc_ir_function_add_block(function, "taken");
+  const scc_uint32_t untaken = scc_ir_function_add_block(function, "untaken");
+  const scc_uint32_t exit = scc_ir_function_add_block(function, "exit");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t v = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), nothing, nothing);
+  const scc_ir_value_t three = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32, scc_ir_function_splat(function, f32, 1.0), scc_ir_function_splat(function, f32, 2.0), nothing);
+  const scc_ir_value_t below = scc_test_append(function, entry, SCC_IR_OPERATION_LESS, boolean, scc_ir_function_splat(function, f32, 0.0), three, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_BRANCH, none, below, scc_test_block(taken), scc_test_block(untaken));
+
+  const scc_ir_value_t scaled = scc_test_append(function, taken, SCC_IR_OPERATION_MULTIPLY, f32x4, v, three, nothing);
+  scc_test_append(function, taken, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), nothing, nothing);
+
+  const scc_ir_value_t negated = scc_test_append(function, untaken, SCC_IR_OPERATION_SUB, f32x4, scc_ir_function_splat(function, f32x4, 0.0), v, nothing);
+  scc_test_append(function, untaken, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), nothing, nothing);
+
+  const scc_ir_value_t incoming[4] = { scc_test_block(taken), scaled, scc_test_block(untaken), negated };
+  const scc_ir_value_t chosen = scc_ir_function_append(function, exit, SCC_IR_OPERATION_PHI, f32x4, incoming, 4);
+
+  scc_test_append(function, exit, SCC_IR_OPERATION_STORE, none, scc_test_global(out), chosen, nothing);
+  scc_test_append(function, exit, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+void scc_test_sccp(void) {
+  scc_ir_module_t *module = scc_test_sccp_module();
+
+  float in[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word)
+    in[word] = 1.5f * (float)word - 6.0f;
+
+  float before[4 * SCC_TEST_INVOCATIONS];
+  float after[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[2] = { in, before };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_SCCP_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 1);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  // Only the path taken is left, scaling by the folded sum.
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_BRANCH) == 0);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_PHI) == 0);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_LESS) == 0);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_ADD) == 0);
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_SUB) == 0);
+  SCC_TEST_CHECK(function->blocks[2].removed);
+
+  globals[1] = after;
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word) {
+    SCC_TEST_CHECK(before[word] == in[word] * 3.0f);
+    SCC_TEST_CHECK(after[word] == before[word]);
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
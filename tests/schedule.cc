@@ -0,0 +1,131 @@
+//===-- tests/schedule.cc -------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Does arithmetic on `v` before sampling at `uv`, then adds the texel, so
+// the fetch has to move up for its latency to be hidden. Two stores at the
+// end have to keep their order.
+static scc_ir_module_t *scc_test_schedule_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32x2 = scc_ir_type(SCC_IR_F32, 2, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t texture = scc_ir_module_add_global(module, "albedo", SCC_IR_TEXTURE, f32x4, 0);
+  const scc_uint32_t in_v = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_uv = scc_ir_module_add_global(module, "uv", SCC_IR_INPUT, f32x2, 1);
+  const scc_uint32_t out_a = scc_ir_module_add_global(module, "a", SCC_IR_OUTPUT, f32x4, 0);
+  const scc_uint32_t out_b = scc_ir_module_add_global(module, "b", SCC_IR_OUTPUT, f32x4, 1);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t v = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_v), nothing, nothing);
+  const scc_ir_value_t squared = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, v, v, nothing);
+  const scc_ir_value_t summed = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4, squared, v, nothing);
+  const scc_ir_value_t uv = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x2, scc_test_global(in_uv), nothing, nothing);
+  const scc_ir_value_t texel = scc_test_append(function, entry, SCC_IR_OPERATION_FETCH, f32x4, scc_test_global(texture), uv, nothing);
+  const scc_ir_value_t lit = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4, summed, texel, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_a), lit, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_b), squared, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Position of the first instruction doing `op` in `block`, counting from its
+// start, or `SCC_IR_NONE` if there isn't one.
+static scc_uint32_t scc_test_schedule_position(const scc_ir_function_t *function,
+                                               scc_uint32_t block,
+                                               scc_ir_operation_t op) {
+  scc_uint32_t position = 0;
+
+  for (scc_uint32_t i = function->blocks[block].first; i != SCC_IR_NONE; i = function->instructions[i].next, ++position)
+    if (function->instructions[i].op == op)
+      return position;
+
+  return SCC_IR_NONE;
+}
+
+void scc_test_schedule(void) {
+  scc_ir_module_t *module = scc_test_schedule_module();
+
+  float v[4 * SCC_TEST_INVOCATIONS];
+  float uv[2 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word)
+    v[word] = 0.5f * (float)word - 2.0f;
+  for (scc_uint32_t word = 0; word < 2 * SCC_TEST_INVOCATIONS; ++word)
+    uv[word] = 0.125f * (float)word;
+
+  float before[2][4 * SCC_TEST_INVOCATIONS];
+  float after[2][4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[5] = { NULL, v, uv, before[0], before[1] };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_SCHEDULE_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 1);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  // Sampling is issued before any arithmetic.
+  const scc_uint32_t fetch = scc_test_schedule_position(function, 0, SCC_IR_OPERATION_FETCH);
+  const scc_uint32_t multiply = scc_test_schedule_position(function, 0, SCC_IR_OPERATION_MULTIPLY);
+
+  SCC_TEST_CHECK(fetch < multiply);
+
+  // Stores are in their original order, at the end.
+  scc_uint32_t stored = 0;
+
+  for (scc_uint32_t i = function->blocks[0].first; i != SCC_IR_NONE; i = function->instructions[i].next) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (instruction->op != SCC_IR_OPERATION_STORE)
+      continue;
+
+    const scc_uint32_t global = SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 0));
+
+    SCC_TEST_CHECK(global == ((stored == 0) ? 3u : 4u));
+
+    stored += 1;
+  }
+
+  SCC_TEST_CHECK(stored == 2);
+  SCC_TEST_CHECK(function->instructions[function->blocks[0].last].op == SCC_IR_OPERATION_RETURN);
+
+  globals[3] = after[0];
+  globals[4] = after[1];
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  SCC_TEST_CHECK(memcmp(before, after, sizeof(before)) == 0);
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
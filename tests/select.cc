@@ -0,0 +1,142 @@
+//===-- tests/select.cc ---------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Clamps `a` to the unit interval with a minimum of a maximum, and computes
+// `a * b + c` with a separate multiply and add.
+static scc_ir_module_t *scc_test_select_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in_a = scc_ir_module_add_global(module, "a", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t in_b = scc_ir_module_add_global(module, "b", SCC_IR_INPUT, f32x4, 1);
+  const scc_uint32_t in_c = scc_ir_module_add_global(module, "c", SCC_IR_INPUT, f32x4, 2);
+  const scc_uint32_t out_clamped = scc_ir_module_add_global(module, "clamped", SCC_IR_OUTPUT, f32x4, 0);
+  const scc_uint32_t out_fused = scc_ir_module_add_global(module, "fused", SCC_IR_OUTPUT, f32x4, 1);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t a = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_a), nothing, nothing);
+  const scc_ir_value_t b = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_b), nothing, nothing);
+  const scc_ir_value_t c = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in_c), nothing, nothing);
+
+  const scc_ir_value_t above = scc_test_append(function, entry, SCC_IR_OPERATION_MAX, f32x4, a, scc_ir_function_splat(function, f32x4, 0.0), nothing);
+  const scc_ir_value_t clamped = scc_test_append(function, entry, SCC_IR_OPERATION_MIN, f32x4, above, scc_ir_function_splat(function, f32x4, 1.0), nothing);
+
+  const scc_ir_value_t product = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x4, a, b, nothing);
+  const scc_ir_value_t fused = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4, product, c, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_clamped), clamped, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out_fused), fused, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Selects instructions of `module` for `target`.
+static void scc_test_select_for(scc_ir_module_t *module,
+                                scc_target_t target,
+                                scc_bool_t fast_math) {
+  scc_ir_pass_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.target = target;
+  options.fast_math = fast_math;
+  options.threads = 1;
+
+  scc_ir_pass_manager_t *manager = scc_ir_pass_manager_create(&options);
+
+  scc_ir_pass_manager_add(manager, &SCC_IR_SELECT_PASS);
+  scc_ir_pass_manager_add(manager, &SCC_IR_DCE_PASS);
+
+  scc_ir_pass_manager_run(manager, module);
+
+  scc_ir_pass_manager_destroy(manager);
+}
+
+void scc_test_select(void) {
+  scc_ir_module_t *module = scc_test_select_module();
+
+  float a[4 * SCC_TEST_INVOCATIONS];
+  float b[4 * SCC_TEST_INVOCATIONS];
+  float c[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word) {
+    a[word] = 0.25f * (float)word - 1.5f;
+    b[word] = 1.0f - 0.125f * (float)word;
+    c[word] = (float)(word % 3);
+  }
+
+  float clamped[4 * SCC_TEST_INVOCATIONS];
+  float fused[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[5] = { a, b, c, clamped, fused };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  for (scc_uint32_t target = 0; target < SCC_NUM_OF_TARGETS; ++target) {
+    // Those with a saturate use it, and the rest a clamp, other than the host,
+    // which has neither.
+    const scc_bool_t saturates = (target == SCC_TARGET_HLSL) || (target == SCC_TARGET_MSL);
+    const scc_bool_t clamps = (target == SCC_TARGET_GLSL) || (target == SCC_TARGET_SPIRV);
+
+    for (scc_uint32_t fast_math = 0; fast_math < 2; ++fast_math) {
+      scc_ir_module_t *selected = scc_ir_module_clone(module);
+
+      scc_test_select_for(selected, (scc_target_t)target, fast_math ? SCC_TRUE : SCC_FALSE);
+
+      const scc_ir_function_t *function = selected->functions[selected->entry];
+
+      SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_SATURATE) == (saturates ? 1u : 0u));
+      SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_CLAMP) == (clamps ? 1u : 0u));
+      SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_MIN) == ((saturates || clamps) ? 0u : 1u));
+      SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_MAX) == ((saturates || clamps) ? 0u : 1u));
+
+      // Fusing rounds differently, so it has to be asked for.
+      SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_FMA) == (fast_math ? 1u : 0u));
+      SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_ADD) == (fast_math ? 0u : 1u));
+
+      float selected_clamped[4 * SCC_TEST_INVOCATIONS];
+      float selected_fused[4 * SCC_TEST_INVOCATIONS];
+
+      void *selected_globals[5] = { a, b, c, selected_clamped, selected_fused };
+
+      SCC_TEST_CHECK(scc_test_run(selected, selected->entry, selected_globals, SCC_TEST_INVOCATIONS));
+
+      SCC_TEST_CHECK(memcmp(selected_clamped, clamped, sizeof(clamped)) == 0);
+
+      if (!fast_math)
+        SCC_TEST_CHECK(memcmp(selected_fused, fused, sizeof(fused)) == 0);
+
+      scc_ir_module_destroy(selected);
+    }
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
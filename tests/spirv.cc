@@ -0,0 +1,365 @@
+//===-- tests/spirv.cc ----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdlib.h>
+
+#include "tests.h"
+
+#include "scc/backend/spirv.h"
+
+SCC_BEGIN_EXTERN_C
+
+#if SCC_PLATFORM == SCC_PLATFORM_WINDOWS
+  #define SCC_TEST_QUIETLY " > NUL 2>&1"
+#else
+  #define SCC_TEST_QUIETLY " > /dev/null 2>&1"
+#endif
+
+static const scc_ir_value_t SCC_TEST_NONE = SCC_IR_NO_VALUE;
+
+//===----------------------------------------------------------------------===//
+// Modules
+//===----------------------------------------------------------------------===//
+
+// Appends a function of `a`, `b` and `t` returning a vector of four floats,
+// with `entry` set to its first block.
+static scc_ir_function_t *scc_test_spirv_interpolator(scc_ir_module_t *module,
+                                                      const char *name,
+                                                      scc_uint32_t *entry) {
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, name, f32x4);
+
+  scc_ir_function_add_argument(function, "a", f32x4);
+  scc_ir_function_add_argument(function, "b", f32x4);
+  scc_ir_function_add_argument(function, "t", f32);
+
+  *entry = scc_ir_function_add_block(function, "entry");
+
+  return function;
+}
+
+static scc_ir_value_t scc_test_spirv_argument(scc_uint32_t argument) {
+  return SCC_IR_VALUE(SCC_IR_VALUE_ARGUMENT, argument);
+}
+
+// Mirrors `tests/basic_vertex_shader.ir`, which the parser can't build yet.
+static scc_ir_module_t *scc_test_spirv_basic_vertex_shader(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_VERTEX_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t f32x3 = scc_ir_type(SCC_IR_F32, 3, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t f32x4x4 = scc_ir_type(SCC_IR_F32, 4, 4);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t vertex = scc_ir_module_add_structure(module, "vertex");
+  const scc_uint32_t position = scc_ir_module_add_member(module, vertex, "position", f32x3, 0);
+  const scc_uint32_t color_1 = scc_ir_module_add_member(module, vertex, "color_1", f32x4, 16);
+  const scc_uint32_t color_2 = scc_ir_module_add_member(module, vertex, "color_2", f32x4, 32);
+
+  const scc_uint32_t frame = scc_ir_module_add_structure(module, "frame");
+  scc_ir_module_add_member(module, frame, "world_to_view", f32x4x4, 0);
+  scc_ir_module_add_member(module, frame, "view_to_screen", f32x4x4, 64);
+  const scc_uint32_t world_to_screen = scc_ir_module_add_member(module, frame, "world_to_screen", f32x4x4, 128);
+
+  scc_ir_type_t vertex_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  vertex_type.structure = vertex;
+
+  scc_ir_type_t frame_type = scc_ir_type(SCC_IR_STRUCTURE, 1, 1);
+  frame_type.structure = frame;
+
+  const scc_uint32_t time = scc_ir_module_add_global(module, "time", SCC_IR_CONSTANT, f32, SCC_IR_NONE);
+  const scc_uint32_t frame_buffer = scc_ir_module_add_global(module, "frame", SCC_IR_CONSTANT, frame_type, 0);
+  const scc_uint32_t in = scc_ir_module_add_global(module, "in", SCC_IR_INPUT, vertex_type, 0);
+  const scc_uint32_t out_position = scc_ir_module_add_global(module, "position", SCC_IR_OUTPUT, f32x4, SCC_IR_NONE);
+  const scc_uint32_t out_color = scc_ir_module_add_global(module, "color", SCC_IR_OUTPUT, f32x4, 1);
+
+  module->globals[out_position].builtin = SCC_IR_BUILTIN_POSITION;
+
+  scc_uint32_t block;
+
+  // def f32<4x1> @lerp(f32<4x1> %a, f32<4x1> %b, f32 %t)
+  scc_ir_function_t *lerp = scc_test_spirv_interpolator(module, "lerp", &block);
+  {
+    const scc_ir_value_t a = scc_test_spirv_argument(0);
+    const scc_ir_value_t b = scc_test_spirv_argument(1);
+    const scc_ir_value_t t = scc_test_spirv_argument(2);
+
+    const scc_ir_value_t difference = scc_test_append(lerp, block, SCC_IR_OPERATION_SUB, f32x4, b, a, SCC_TEST_NONE);
+    const scc_ir_value_t scaled = scc_test_append(lerp, block, SCC_IR_OPERATION_MULTIPLY, f32x4, t, difference, SCC_TEST_NONE);
+    const scc_ir_value_t sum = scc_test_append(lerp, block, SCC_IR_OPERATION_ADD, f32x4, a, scaled, SCC_TEST_NONE);
+
+    scc_test_append(lerp, block, SCC_IR_OPERATION_RETURN, none, sum, SCC_TEST_NONE, SCC_TEST_NONE);
+  }
+
+  // def f32<4x1> @branching(f32<4x1> %a, f32<4x1> %b, f32 %t)
+  scc_ir_function_t *branching = scc_test_spirv_interpolator(module, "branching", &block);
+  {
+    const scc_uint32_t lesser = scc_ir_function_add_block(branching, "lesser");
+    const scc_uint32_t greater_or_equal = scc_ir_function_add_block(branching, "greater_or_equal");
+    const scc_uint32_t exit = scc_ir_function_add_block(branching, "exit");
+
+    const scc_ir_value_t half = scc_ir_function_splat(branching, f32, 0.5);
+    const scc_ir_value_t comparison = scc_test_append(branching, block, SCC_IR_OPERATION_GREATER_OR_EQUAL, boolean, scc_test_spirv_argument(2), half, SCC_TEST_NONE);
+
+    scc_test_append(branching, block, SCC_IR_OPERATION_BRANCH, none, comparison, scc_test_block(greater_or_equal), scc_test_block(lesser));
+    scc_test_append(branching, lesser, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), SCC_TEST_NONE, SCC_TEST_NONE);
+    scc_test_append(branching, greater_or_equal, SCC_IR_OPERATION_JUMP, none, scc_test_block(exit), SCC_TEST_NONE, SCC_TEST_NONE);
+
+    const scc_ir_value_t incoming[4] = {
+      scc_test_block(lesser), scc_test_spirv_argument(0),
+      scc_test_block(greater_or_equal), scc_test_spirv_argument(1)
+    };
+
+    const scc_ir_value_t chosen = scc_ir_function_append(branching, exit, SCC_IR_OPERATION_PHI, f32x4, incoming, 4);
+
+    scc_test_append(branching, exit, SCC_IR_OPERATION_RETURN, none, chosen, SCC_TEST_NONE, SCC_TEST_NONE);
+  }
+
+  // def f32<4x1> @branchless(f32<4x1> %a, f32<4x1> %b, f32 %t)
+  scc_ir_function_t *branchless = scc_test_spirv_interpolator(module, "branchless", &block);
+  {
+    const scc_ir_value_t a = scc_test_spirv_argument(0);
+    const scc_ir_value_t b = scc_test_spirv_argument(1);
+
+    // No `step` yet, so `sat(floor(t + 0.5))` stands in.
+    const scc_ir_value_t rounded = scc_test_append(branchless, block, SCC_IR_OPERATION_ADD, f32, scc_test_spirv_argument(2), scc_ir_function_splat(branchless, f32, 0.5), SCC_TEST_NONE);
+    const scc_ir_value_t floored = scc_test_append(branchless, block, SCC_IR_OPERATION_FLOOR, f32, rounded, SCC_TEST_NONE, SCC_TEST_NONE);
+    const scc_ir_value_t stepped = scc_test_append(branchless, block, SCC_IR_OPERATION_SATURATE, f32, floored, SCC_TEST_NONE, SCC_TEST_NONE);
+    const scc_ir_value_t difference = scc_test_append(branchless, block, SCC_IR_OPERATION_SUB, f32x4, b, a, SCC_TEST_NONE);
+    const scc_ir_value_t step = scc_test_append(branchless, block, SCC_IR_OPERATION_MULTIPLY, f32x4, stepped, difference, SCC_TEST_NONE);
+    const scc_ir_value_t sum = scc_test_append(branchless, block, SCC_IR_OPERATION_ADD, f32x4, a, step, SCC_TEST_NONE);
+
+    scc_test_append(branchless, block, SCC_IR_OPERATION_RETURN, none, sum, SCC_TEST_NONE, SCC_TEST_NONE);
+  }
+
+  // def void @entry()
+  scc_ir_function_t *entry = scc_ir_module_add_function(module, "entry", none);
+  {
+    block = scc_ir_function_add_block(entry, "entry");
+
+    const scc_ir_value_t p = scc_test_append(entry, block, SCC_IR_OPERATION_LOAD, f32x3, scc_test_global(in), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, position), SCC_TEST_NONE);
+    const scc_ir_value_t m = scc_test_append(entry, block, SCC_IR_OPERATION_LOAD, f32x4x4, scc_test_global(frame_buffer), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, world_to_screen), SCC_TEST_NONE);
+    const scc_ir_value_t homogeneous = scc_test_append(entry, block, SCC_IR_OPERATION_COMPOSE, f32x4, p, scc_ir_function_splat(entry, f32, 1.0), SCC_TEST_NONE);
+    const scc_ir_value_t projected = scc_test_append(entry, block, SCC_IR_OPERATION_MULTIPLY, f32x4, m, homogeneous, SCC_TEST_NONE);
+
+    scc_test_append(entry, block, SCC_IR_OPERATION_STORE, none, scc_test_global(out_position), projected, SCC_TEST_NONE);
+
+    const scc_ir_value_t c1 = scc_test_append(entry, block, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, color_1), SCC_TEST_NONE);
+    const scc_ir_value_t c2 = scc_test_append(entry, block, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), SCC_IR_VALUE(SCC_IR_VALUE_MEMBER, color_2), SCC_TEST_NONE);
+    const scc_ir_value_t t = scc_test_append(entry, block, SCC_IR_OPERATION_LOAD, f32, scc_test_global(time), SCC_TEST_NONE, SCC_TEST_NONE);
+
+    const scc_ir_value_t calls[3][4] = {
+      { SCC_IR_VALUE(SCC_IR_VALUE_FUNCTION, lerp->index), c1, c2, t },
+      { SCC_IR_VALUE(SCC_IR_VALUE_FUNCTION, branching->index), c1, c2, t },
+      { SCC_IR_VALUE(SCC_IR_VALUE_FUNCTION, branchless->index), c1, c2, t }
+    };
+
+    const scc_ir_value_t lerped = scc_ir_function_append(entry, block, SCC_IR_OPERATION_CALL, f32x4, calls[0], 4);
+    const scc_ir_value_t branched = scc_ir_function_append(entry, block, SCC_IR_OPERATION_CALL, f32x4, calls[1], 4);
+    const scc_ir_value_t unbranched = scc_ir_function_append(entry, block, SCC_IR_OPERATION_CALL, f32x4, calls[2], 4);
+
+    // Redundant swizzles, as squashing them is left to passes.
+    const scc_ir_value_t reversal = SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(3, 2, 1, 0));
+    const scc_ir_value_t reversed = scc_test_append(entry, block, SCC_IR_OPERATION_SWIZZLE, f32x4, lerped, reversal, SCC_TEST_NONE);
+    const scc_ir_value_t restored = scc_test_append(entry, block, SCC_IR_OPERATION_SWIZZLE, f32x4, reversed, reversal, SCC_TEST_NONE);
+
+    const scc_ir_value_t both = scc_test_append(entry, block, SCC_IR_OPERATION_ADD, f32x4, branched, unbranched, SCC_TEST_NONE);
+    const scc_ir_value_t color = scc_test_append(entry, block, SCC_IR_OPERATION_ADD, f32x4, restored, both, SCC_TEST_NONE);
+
+    scc_test_append(entry, block, SCC_IR_OPERATION_STORE, none, scc_test_global(out_color), color, SCC_TEST_NONE);
+    scc_test_append(entry, block, SCC_IR_OPERATION_RETURN, none, SCC_TEST_NONE, SCC_TEST_NONE, SCC_TEST_NONE);
+  }
+
+  module->entry = entry->index;
+
+  return module;
+}
+
+// A pixel shader that sums over a loop, then over a loop that leaves from
+// its body to one of two places, which structured control flow can't express
+// directly.
+static scc_ir_module_t *scc_test_spirv_loops(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32 = scc_ir_type(SCC_IR_F32, 1, 1);
+  const scc_ir_type_t boolean = scc_ir_type(SCC_IR_BOOL, 1, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in = scc_ir_module_add_global(module, "x", SCC_IR_INPUT, f32, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "y", SCC_IR_OUTPUT, f32, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+  const scc_uint32_t header = scc_ir_function_add_block(function, "header");
+  const scc_uint32_t body = scc_ir_function_add_block(function, "body");
+  const scc_uint32_t between = scc_ir_function_add_block(function, "between");
+  const scc_uint32_t search = scc_ir_function_add_block(function, "search");
+  const scc_uint32_t next = scc_ir_function_add_block(function, "next");
+  const scc_uint32_t found = scc_ir_function_add_block(function, "found");
+  const scc_uint32_t exhausted = scc_ir_function_add_block(function, "exhausted");
+
+  const scc_ir_value_t zero = scc_ir_function_splat(function, f32, 0.0);
+  const scc_ir_value_t one = scc_ir_function_splat(function, f32, 1.0);
+  const scc_ir_value_t four = scc_ir_function_splat(function, f32, 4.0);
+
+  const scc_ir_value_t x = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32, scc_test_global(in), SCC_TEST_NONE, SCC_TEST_NONE);
+  scc_test_append(function, entry, SCC_IR_OPERATION_JUMP, none, scc_test_block(header), SCC_TEST_NONE, SCC_TEST_NONE);
+
+  // for (i = 0, sum = 0; i < 4; i += 1) sum += x * i;
+  const scc_uint32_t i = function->num_of_instructions;
+  const scc_uint32_t sum = i + 1;
+
+  const scc_ir_value_t incoming_i[4] = { scc_test_block(entry), zero, scc_test_block(body), SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, sum + 5) };
+  const scc_ir_value_t incoming_sum[4] = { scc_test_block(entry), zero, scc_test_block(body), SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, sum + 4) };
+
+  scc_ir_function_append(function, header, SCC_IR_OPERATION_PHI, f32, incoming_i, 4);
+  scc_ir_function_append(function, header, SCC_IR_OPERATION_PHI, f32, incoming_sum, 4);
+
+  const scc_ir_value_t counter = SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, i);
+  const scc_ir_value_t total = SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, sum);
+
+  const scc_ir_value_t more = scc_test_append(function, header, SCC_IR_OPERATION_LESS, boolean, counter, four, SCC_TEST_NONE);
+  scc_test_append(function, header, SCC_IR_OPERATION_BRANCH, none, more, scc_test_block(body), scc_test_block(between));
+
+  const scc_ir_value_t term = scc_test_append(function, body, SCC_IR_OPERATION_MULTIPLY, f32, x, counter, SCC_TEST_NONE);
+  const scc_ir_value_t summed = scc_test_append(function, body, SCC_IR_OPERATION_ADD, f32, total, term, SCC_TEST_NONE);
+  const scc_ir_value_t incremented = scc_test_append(function, body, SCC_IR_OPERATION_ADD, f32, counter, one, SCC_TEST_NONE);
+  scc_test_append(function, body, SCC_IR_OPERATION_JUMP, none, scc_test_block(header), SCC_TEST_NONE, SCC_TEST_NONE);
+
+  SCC_TEST_CHECK(summed == SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, sum + 4));
+  SCC_TEST_CHECK(incremented == SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, sum + 5));
+
+  scc_test_append(function, between, SCC_IR_OPERATION_JUMP, none, scc_test_block(search), SCC_TEST_NONE, SCC_TEST_NONE);
+
+  // for (j = sum; ; j -= 1) { if (j < x) goto found; if (j < 0) goto exhausted; }
+  const scc_uint32_t j = function->num_of_instructions;
+
+  const scc_ir_value_t incoming_j[4] = { scc_test_block(between), total, scc_test_block(next), SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, j + 4) };
+
+  scc_ir_function_append(function, search, SCC_IR_OPERATION_PHI, f32, incoming_j, 4);
+
+  const scc_ir_value_t candidate = SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, j);
+
+  const scc_ir_value_t hit = scc_test_append(function, search, SCC_IR_OPERATION_LESS, boolean, candidate, x, SCC_TEST_NONE);
+  scc_test_append(function, search, SCC_IR_OPERATION_BRANCH, none, hit, scc_test_block(found), scc_test_block(next));
+
+  const scc_ir_value_t negative = scc_test_append(function, next, SCC_IR_OPERATION_LESS, boolean, candidate, zero, SCC_TEST_NONE);
+  const scc_ir_value_t decremented = scc_test_append(function, next, SCC_IR_OPERATION_SUB, f32, candidate, one, SCC_TEST_NONE);
+  scc_test_append(function, next, SCC_IR_OPERATION_BRANCH, none, negative, scc_test_block(exhausted), scc_test_block(search));
+
+  SCC_TEST_CHECK(decremented == SCC_IR_VALUE(SCC_IR_VALUE_INSTRUCTION, j + 4));
+
+  scc_test_append(function, found, SCC_IR_OPERATION_STORE, none, scc_test_global(out), candidate, SCC_TEST_NONE);
+  scc_test_append(function, found, SCC_IR_OPERATION_RETURN, none, SCC_TEST_NONE, SCC_TEST_NONE, SCC_TEST_NONE);
+
+  scc_test_append(function, exhausted, SCC_IR_OPERATION_STORE, none, scc_test_global(out), x, SCC_TEST_NONE);
+  scc_test_append(function, exhausted, SCC_IR_OPERATION_RETURN, none, SCC_TEST_NONE, SCC_TEST_NONE, SCC_TEST_NONE);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+//===----------------------------------------------------------------------===//
+// Validation
+//===----------------------------------------------------------------------===//
+
+// Emits `module` for `version` of SPIR-V, checks the header, then has
+// `spirv-val` validate it for `environment` if `validate`.
+static void scc_test_spirv_emit(const scc_ir_module_t *module,
+                                const char *name,
+                                scc_uint32_t version,
+                                const char *environment,
+                                scc_bool_t validate) {
+  scc_spirv_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.version = version;
+  options.packing = SCC_IR_PACKING_STD140;
+
+  scc_writer_t *writer = scc_writer_create(NULL, 4096);
+
+  SCC_TEST_CHECK(scc_spirv_emit(module, &options, writer));
+
+  const scc_size_t size = scc_writer_size(writer);
+
+  SCC_TEST_CHECK((size >= 20) && (size % 4 == 0));
+
+  scc_allocator_t *heap = scc_get_global_heap_allocator();
+
+  scc_uint32_t *words = (scc_uint32_t *)heap->allocate(heap, size + 4, 16);
+
+  scc_writer_copy(writer, (char *)words);
+  scc_writer_destroy(writer);
+
+  SCC_TEST_CHECK(words[0] == 0x07230203u);
+  SCC_TEST_CHECK(words[1] == version);
+  SCC_TEST_CHECK(words[3] > 1);
+
+  if (validate) {
+    char path[256];
+    snprintf(path, sizeof(path), "scc_tests_%s.spv", name);
+
+    FILE *file = fopen(path, "wb");
+
+    SCC_TEST_CHECK(file != NULL);
+
+    if (file) {
+      fwrite(words, 1, size, file);
+      fclose(file);
+
+      char command[512];
+      snprintf(command, sizeof(command), "spirv-val --target-env %s %s", environment, path);
+
+      if (system(command) != 0) {
+        fprintf(stderr, "%s for %s failed validation, kept as %s\n", name, environment, path);
+        SCC_TEST_CHECK(!"spirv-val rejected output");
+      } else {
+        remove(path);
+      }
+    }
+  }
+
+  heap->free(heap, (void *)words);
+}
+
+void scc_test_spirv(void) {
+  const scc_bool_t validate = (system("spirv-val --version" SCC_TEST_QUIETLY) == 0);
+
+  if (!validate)
+    scc_test_skip("spirv-val isn't on the path; only headers are checked");
+
+  scc_ir_module_t *modules[2] = {
+    scc_test_spirv_basic_vertex_shader(),
+    scc_test_spirv_loops()
+  };
+
+  static const char *names[2] = { "basic_vertex_shader", "loops" };
+
+  for (scc_uint32_t module = 0; module < 2; ++module) {
+    scc_test_spirv_emit(modules[module], names[module], 0x00010000, "vulkan1.0", validate);
+
+    // Interfaces list every global from 1.4 on.
+    scc_test_spirv_emit(modules[module], names[module], 0x00010400, "vulkan1.2", validate);
+
+    scc_ir_module_destroy(modules[module]);
+  }
+}
+
+SCC_END_EXTERN_C
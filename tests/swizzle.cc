@@ -0,0 +1,151 @@
+//===-- tests/swizzle.cc --------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+static const scc_uint32_t SCC_TEST_INVOCATIONS = 5;
+
+// Sums a swizzle of a swizzle of `v` and an identity swizzle of it, so that
+// the former composes into one and the latter goes.
+static scc_ir_module_t *scc_test_swizzle_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t v = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), nothing, nothing);
+  const scc_ir_value_t reversed = scc_test_append(function, entry, SCC_IR_OPERATION_SWIZZLE, f32x4, v, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(3, 2, 1, 0)), nothing);
+  const scc_ir_value_t shuffled = scc_test_append(function, entry, SCC_IR_OPERATION_SWIZZLE, f32x4, reversed, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(1, 1, 0, 3)), nothing);
+  const scc_ir_value_t same = scc_test_append(function, entry, SCC_IR_OPERATION_SWIZZLE, f32x4, v, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 1, 2, 3)), nothing);
+  const scc_ir_value_t sum = scc_test_append(function, entry, SCC_IR_OPERATION_ADD, f32x4, shuffled, same, nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out), sum, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+// Doubles the first two components of `v`, then widens the result, which
+// mustn't widen the multiply instead.
+static scc_ir_module_t *scc_test_swizzle_widening_module(void) {
+  scc_ir_module_t *module = scc_ir_module_create(SCC_PIXEL_SHADER);
+
+  const scc_ir_type_t f32x2 = scc_ir_type(SCC_IR_F32, 2, 1);
+  const scc_ir_type_t f32x4 = scc_ir_type(SCC_IR_F32, 4, 1);
+  const scc_ir_type_t none = scc_ir_void();
+
+  const scc_uint32_t in = scc_ir_module_add_global(module, "v", SCC_IR_INPUT, f32x4, 0);
+  const scc_uint32_t out = scc_ir_module_add_global(module, "o", SCC_IR_OUTPUT, f32x4, 0);
+
+  scc_ir_function_t *function = scc_ir_module_add_function(module, "main", none);
+
+  const scc_uint32_t entry = scc_ir_function_add_block(function, "entry");
+
+  const scc_ir_value_t nothing = SCC_IR_NO_VALUE;
+
+  const scc_ir_value_t v = scc_test_append(function, entry, SCC_IR_OPERATION_LOAD, f32x4, scc_test_global(in), nothing, nothing);
+  const scc_ir_value_t xy = scc_test_append(function, entry, SCC_IR_OPERATION_SWIZZLE, f32x2, v, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 1, 0, 0)), nothing);
+  const scc_ir_value_t doubled = scc_test_append(function, entry, SCC_IR_OPERATION_MULTIPLY, f32x2, xy, scc_ir_function_splat(function, scc_ir_type(SCC_IR_F32, 1, 1), 2.0), nothing);
+  const scc_ir_value_t widened = scc_test_append(function, entry, SCC_IR_OPERATION_SWIZZLE, f32x4, doubled, SCC_IR_VALUE(SCC_IR_VALUE_IMMEDIATE, SCC_IR_SWIZZLE(0, 1, 0, 0)), nothing);
+
+  scc_test_append(function, entry, SCC_IR_OPERATION_STORE, none, scc_test_global(out), widened, nothing);
+  scc_test_append(function, entry, SCC_IR_OPERATION_RETURN, none, nothing, nothing, nothing);
+
+  module->entry = function->index;
+
+  return module;
+}
+
+void scc_test_swizzle(void) {
+  scc_ir_module_t *module = scc_test_swizzle_module();
+
+  float in[4 * SCC_TEST_INVOCATIONS];
+
+  for (scc_uint32_t word = 0; word < 4 * SCC_TEST_INVOCATIONS; ++word)
+    in[word] = 2.0f * (float)word + 1.0f;
+
+  float before[4 * SCC_TEST_INVOCATIONS];
+  float after[4 * SCC_TEST_INVOCATIONS];
+
+  void *globals[2] = { in, before };
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_ir_pass_t *const passes[] = { &SCC_IR_SWIZZLE_PASS, &SCC_IR_DCE_PASS };
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 2);
+
+  const scc_ir_function_t *function = module->functions[module->entry];
+
+  // One swizzle is left, picking `zzwx` of `v` directly.
+  SCC_TEST_CHECK(scc_test_count(function, SCC_IR_OPERATION_SWIZZLE) == 1);
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (!scc_ir_instruction_is_live(instruction) || (instruction->op != SCC_IR_OPERATION_SWIZZLE))
+      continue;
+
+    const scc_ir_value_t source = scc_ir_operand(function, instruction, 0);
+
+    SCC_TEST_CHECK(function->instructions[SCC_IR_VALUE_INDEX(source)].op == SCC_IR_OPERATION_LOAD);
+    SCC_TEST_CHECK(SCC_IR_VALUE_INDEX(scc_ir_operand(function, instruction, 1)) == SCC_IR_SWIZZLE(2, 2, 3, 0));
+  }
+
+  globals[1] = after;
+
+  SCC_TEST_CHECK(scc_test_run(module, module->entry, globals, SCC_TEST_INVOCATIONS));
+
+  static const scc_uint32_t picked[4] = { 2, 2, 3, 0 };
+
+  for (scc_uint32_t component = 0; component < 4; ++component) {
+    for (scc_uint32_t invocation = 0; invocation < SCC_TEST_INVOCATIONS; ++invocation) {
+      const scc_uint32_t word = component * SCC_TEST_INVOCATIONS + invocation;
+
+      SCC_TEST_CHECK(before[word] == in[picked[component] * SCC_TEST_INVOCATIONS + invocation] + in[word]);
+      SCC_TEST_CHECK(after[word] == before[word]);
+    }
+  }
+
+  scc_ir_module_destroy(module);
+
+  module = scc_test_swizzle_widening_module();
+
+  scc_test_optimize(module, SCC_TARGET_HOST, passes, 2);
+
+  function = module->functions[module->entry];
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i) {
+    const scc_ir_instruction_t *instruction = &function->instructions[i];
+
+    if (scc_ir_instruction_is_live(instruction) && (instruction->op == SCC_IR_OPERATION_MULTIPLY))
+      SCC_TEST_CHECK(instruction->type.rows == 2);
+  }
+
+  scc_ir_module_destroy(module);
+}
+
+SCC_END_EXTERN_C
@@ -0,0 +1,188 @@
+//===-- tests/tests.cc ----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+
+#include <stdlib.h>
+
+#include "tests.h"
+
+SCC_BEGIN_EXTERN_C
+
+typedef struct scc_test_suite {
+  const char *name;
+  void (*run)(void);
+} scc_test_suite_t;
+
+static const scc_test_suite_t SCC_TEST_SUITES[] = {
+  { "bytecode", &scc_test_bytecode },
+  { "dce", &scc_test_dce },
+  { "driver", &scc_test_driver },
+  { "dominators", &scc_test_dominators },
+  { "glsl", &scc_test_glsl },
+  { "gvn", &scc_test_gvn },
+  { "hoist_uniforms", &scc_test_hoist_uniforms },
+  { "inline", &scc_test_inline },
+  { "interpreter", &scc_test_interpreter },
+  { "jit", &scc_test_jit },
+  { "layout", &scc_test_layout },
+  { "liveness", &scc_test_liveness },
+  { "msl", &scc_test_msl },
+  { "prune_interface", &scc_test_prune_interface },
+  { "reflection", &scc_test_reflection },
+  { "scalarize", &scc_test_scalarize },
+  { "sccp", &scc_test_sccp },
+  { "schedule", &scc_test_schedule },
+  { "select", &scc_test_select },
+  { "spirv", &scc_test_spirv },
+  { "swizzle", &scc_test_swizzle }
+};
+
+static const char *scc_test_suite_ = NULL;
+static scc_uint32_t scc_test_failures_ = 0;
+static scc_uint32_t scc_test_skips_ = 0;
+
+void scc_test_fail(const char *file,
+                   int line,
+                   const char *expression) {
+  fprintf(stderr, "%s:%d: %s: check failed: %s\n", file, line, scc_test_suite_, expression);
+  scc_test_failures_ += 1;
+}
+
+void scc_test_skip(const char *reason) {
+  fprintf(stderr, "%s: skipped: %s\n", scc_test_suite_, reason);
+  scc_test_skips_ += 1;
+}
+
+//===----------------------------------------------------------------------===//
+// Helpers
+//===----------------------------------------------------------------------===//
+
+scc_ir_value_t scc_test_append(scc_ir_function_t *function,
+                               scc_uint32_t block,
+                               scc_ir_operation_t op,
+                               scc_ir_type_t type,
+                               scc_ir_value_t a,
+                               scc_ir_value_t b,
+                               scc_ir_value_t c) {
+  const scc_ir_value_t operands[3] = { a, b, c };
+
+  scc_uint32_t num_of_operands = 0;
+
+  while ((num_of_operands < 3) && (operands[num_of_operands] != SCC_IR_NO_VALUE))
+    num_of_operands += 1;
+
+  return scc_ir_function_append(function, block, op, type, operands, num_of_operands);
+}
+
+scc_uint32_t scc_test_count(const scc_ir_function_t *function,
+                            scc_ir_operation_t op) {
+  scc_uint32_t count = 0;
+
+  for (scc_uint32_t i = 0; i < function->num_of_instructions; ++i)
+    if (scc_ir_instruction_is_live(&function->instructions[i]) && (function->instructions[i].op == op))
+      count += 1;
+
+  return count;
+}
+
+void scc_test_optimize(scc_ir_module_t *module,
+                       scc_target_t target,
+                       const scc_ir_pass_t *const *passes,
+                       scc_uint32_t num_of_passes) {
+  scc_ir_pass_options_t options;
+
+  memset(&options, 0, sizeof(options));
+
+  options.target = target;
+  options.threads = 1;
+
+  scc_ir_pass_manager_t *manager = scc_ir_pass_manager_create(&options);
+
+  for (scc_uint32_t pass = 0; pass < num_of_passes; ++pass)
+    scc_ir_pass_manager_add(manager, passes[pass]);
+
+  scc_ir_pass_manager_run(manager, module);
+
+  scc_ir_pass_manager_destroy(manager);
+}
+
+// Runs `function` of `module` for `count` invocations, first compiling what
+// it can to native code using `features` if `native`.
+static scc_bool_t scc_test_interpret(const scc_ir_module_t *module,
+                                     scc_uint32_t function,
+                                     void **globals,
+                                     scc_uint32_t count,
+                                     scc_bool_t native,
+                                     scc_uint32_t features) {
+  scc_ir_bindings_t bindings;
+
+  memset(&bindings, 0, sizeof(bindings));
+
+  bindings.globals = globals;
+
+  scc_ir_interpreter_t *interpreter = scc_ir_interpreter_create(module);
+
+  scc_bool_t ran = SCC_TRUE;
+
+  if (native)
+    ran = scc_ir_interpreter_compile(interpreter, features);
+
+  if (ran)
+    ran = scc_ir_interpreter_run(interpreter, function, &bindings, count);
+
+  scc_ir_interpreter_destroy(interpreter);
+
+  return ran;
+}
+
+scc_bool_t scc_test_run(const scc_ir_module_t *module,
+                        scc_uint32_t function,
+                        void **globals,
+                        scc_uint32_t count) {
+  return scc_test_interpret(module, function, globals, count, SCC_FALSE, 0);
+}
+
+scc_bool_t scc_test_run_native(const scc_ir_module_t *module,
+                               scc_uint32_t function,
+                               void **globals,
+                               scc_uint32_t count,
+                               scc_uint32_t features) {
+  return scc_test_interpret(module, function, globals, count, SCC_TRUE, features);
+}
+
+SCC_END_EXTERN_C
+
+int main(int argc, const char *argv[]) {
+  // Suites named on the command line, or all of them.
+  for (scc_uint32_t suite = 0; suite < sizeof(SCC_TEST_SUITES) / sizeof(SCC_TEST_SUITES[0]); ++suite) {
+    scc_bool_t selected = (argc <= 1);
+
+    for (int arg = 1; arg < argc; ++arg)
+      selected |= (strcmp(argv[arg], SCC_TEST_SUITES[suite].name) == 0);
+
+    if (!selected)
+      continue;
+
+    const scc_uint32_t failures = scc_test_failures_;
+    const scc_uint32_t skips = scc_test_skips_;
+
+    scc_test_suite_ = SCC_TEST_SUITES[suite].name;
+    SCC_TEST_SUITES[suite].run();
+
+    // Suites that couldn't check everything don't claim to have passed.
+    printf("%s: %s\n", scc_test_suite_, (scc_test_failures_ != failures) ? "FAILED"
+                                      : (scc_test_skips_ != skips) ? "skipped"
+                                      : "passed");
+  }
+
+  return scc_test_failures_ ? EXIT_FAILURE : EXIT_SUCCESS;
+}
@@ -0,0 +1,128 @@
+//===-- tests/tests.h -----------------------------------*- mode: C++11 -*-===//
+//
+//                             _____ _____ _____
+//                            |   __|     |     |
+//                            |__   |   --|   --|
+//                            |_____|_____|_____|
+//
+//                           Shader Cross Compiler
+//
+//       This file is distributed under the terms described in LICENSE.
+//
+//===----------------------------------------------------------------------===//
+///
+/// \file
+/// \brief Checks and helpers shared by the test suite.
+///
+/// Each suite is a function that builds whatever it needs and checks it,
+/// carrying on past failures so that one run reports all of them. Modules are
+/// built by hand rather than parsed, as the parser doesn't produce them yet.
+///
+//===----------------------------------------------------------------------===//
+
+#ifndef _SCC_TESTS_H_
+#define _SCC_TESTS_H_
+
+#include <stdio.h>
+
+#include "scc/foundation.h"
+#include "scc/target.h"
+
+#include "scc/ir.h"
+#include "scc/ir/interpreter.h"
+#include "scc/ir/jit.h"
+#include "scc/ir/pass_manager.h"
+#include "scc/ir/passes.h"
+
+SCC_BEGIN_EXTERN_C
+
+/// Records a failure of `Condition`, if it doesn't hold.
+#define SCC_TEST_CHECK(Condition) \
+  do { if (!(Condition)) scc_test_fail(__FILE__, __LINE__, #Condition); } while (0)
+
+extern void scc_test_fail(const char *file,
+                          int line,
+                          const char *expression);
+
+/// Notes that what follows of the running suite can't be checked here, so
+/// it's reported as skipped rather than passed.
+extern void scc_test_skip(const char *reason);
+
+//===----------------------------------------------------------------------===//
+// Suites
+//===----------------------------------------------------------------------===//
+
+extern void scc_test_bytecode(void);
+extern void scc_test_dce(void);
+extern void scc_test_driver(void);
+extern void scc_test_dominators(void);
+extern void scc_test_glsl(void);
+extern void scc_test_gvn(void);
+extern void scc_test_hoist_uniforms(void);
+extern void scc_test_inline(void);
+extern void scc_test_interpreter(void);
+extern void scc_test_jit(void);
+extern void scc_test_layout(void);
+extern void scc_test_liveness(void);
+extern void scc_test_msl(void);
+extern void scc_test_prune_interface(void);
+extern void scc_test_reflection(void);
+extern void scc_test_scalarize(void);
+extern void scc_test_sccp(void);
+extern void scc_test_schedule(void);
+extern void scc_test_select(void);
+extern void scc_test_spirv(void);
+extern void scc_test_swizzle(void);
+
+//===----------------------------------------------------------------------===//
+// Helpers
+//===----------------------------------------------------------------------===//
+
+static SCC_INLINE scc_ir_value_t scc_test_block(scc_uint32_t block) {
+  return SCC_IR_VALUE(SCC_IR_VALUE_BLOCK, block);
+}
+
+static SCC_INLINE scc_ir_value_t scc_test_global(scc_uint32_t global) {
+  return SCC_IR_VALUE(SCC_IR_VALUE_GLOBAL, global);
+}
+
+/// Appends an instruction of up to three operands, ignoring any given as
+/// `SCC_IR_NO_VALUE`.
+extern scc_ir_value_t scc_test_append(scc_ir_function_t *function,
+                                      scc_uint32_t block,
+                                      scc_ir_operation_t op,
+                                      scc_ir_type_t type,
+                                      scc_ir_value_t a,
+                                      scc_ir_value_t b,
+                                      scc_ir_value_t c);
+
+/// Counts the instructions of `function` that do `op` and haven't been
+/// removed.
+extern scc_uint32_t scc_test_count(const scc_ir_function_t *function,
+                                   scc_ir_operation_t op);
+
+/// Runs `passes` over `module` for `target`, on the calling thread.
+extern void scc_test_optimize(scc_ir_module_t *module,
+                              scc_target_t target,
+                              const scc_ir_pass_t *const *passes,
+                              scc_uint32_t num_of_passes);
+
+/// Interprets `function` of `module` for `count` invocations, returning
+/// false if it's not supported.
+extern scc_bool_t scc_test_run(const scc_ir_module_t *module,
+                               scc_uint32_t function,
+                               void **globals,
+                               scc_uint32_t count);
+
+/// As `scc_test_run`, but compiles what it can to native code using those of
+/// `features` the host supports first. Returns false if native code can't be
+/// generated for the host.
+extern scc_bool_t scc_test_run_native(const scc_ir_module_t *module,
+                                      scc_uint32_t function,
+                                      void **globals,
+                                      scc_uint32_t count,
+                                      scc_uint32_t features);
+
+SCC_END_EXTERN_C
+
+#endif // _SCC_TESTS_H_